@@ -6,6 +6,8 @@ from .sources.file_live_source import FILE_LIVE_SOURCE_PROGRAM_NAME, \
     FILE_LIVE_SOURCE_TYPE_NAME, FileLiveSourceStream
 from .sources.ffmpeg_source import FFMPEG_SOURCE_PROGRAM_NAME, \
     FFMPEG_SOURCE_TYPE_NAME, FFmpegSourceStream
+from .sources.transcode_source import TRANSCODE_SOURCE_PROGRAM_NAME, \
+    TRANSCODE_SOURCE_TYPE_NAME, TranscodeSourceStream
 
 from .senders import TEXT_SINK_SENDER_TYPE, FFMPEG_SENDER_TYPE
 from .senders.native_ffmpeg_sender import NATIVE_FFMPEG_PROGRAM_NAME, \
@@ -25,6 +27,8 @@ def _register_builtin_source_type():
         register_source_type(FILE_LIVE_SOURCE_TYPE_NAME, FileLiveSourceStream)
     if find_executable(FFMPEG_SOURCE_PROGRAM_NAME):
         register_source_type(FFMPEG_SOURCE_TYPE_NAME, FFmpegSourceStream)
+    if find_executable(TRANSCODE_SOURCE_PROGRAM_NAME):
+        register_source_type(TRANSCODE_SOURCE_TYPE_NAME, TranscodeSourceStream)
 
 def _register_builtin_sender_type():
     if find_executable(TEXT_SINK_SENDER_TYPE):
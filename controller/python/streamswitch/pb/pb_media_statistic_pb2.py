@@ -19,7 +19,7 @@ import pb_metadata_pb2
 DESCRIPTOR = _descriptor.FileDescriptor(
   name='pb_media_statistic.proto',
   package='stream_switch',
-  serialized_pb=_b('\n\x18pb_media_statistic.proto\x12\rstream_switch\x1a\x11pb_metadata.proto\"\x18\n\x16ProtoMediaStatisticReq\"\xeb\x01\n\x1cProtoSubStreamMediaStatistic\x12\x18\n\x10sub_stream_index\x18\x01 \x01(\x05\x12:\n\nmedia_type\x18\x02 \x01(\x0e\x32&.stream_switch.ProtoSubStreamMediaType\x12\x12\n\ndata_bytes\x18\x14 \x01(\x04\x12\x11\n\tkey_bytes\x18\x15 \x01(\x04\x12\x13\n\x0blost_frames\x18\x1e \x01(\x04\x12\x13\n\x0b\x64\x61ta_frames\x18\x1f \x01(\x04\x12\x12\n\nkey_frames\x18  \x01(\x04\x12\x10\n\x08last_gov\x18! \x01(\x04\"\x93\x01\n\x16ProtoMediaStatisticRep\x12\x0c\n\x04ssrc\x18\x01 \x01(\r\x12\x11\n\ttimestamp\x18\x02 \x01(\x03\x12\x11\n\tsum_bytes\x18\x03 \x01(\x04\x12\x45\n\x10sub_stream_stats\x18@ \x03(\x0b\x32+.stream_switch.ProtoSubStreamMediaStatistic')
+  serialized_pb=_b('\n\x18pb_media_statistic.proto\x12\rstream_switch\x1a\x11pb_metadata.proto\"\x18\n\x16ProtoMediaStatisticReq\"\xf0\x04\n\x1cProtoSubStreamMediaStatistic\x12\x18\n\x10sub_stream_index\x18\x01 \x01(\x05\x12:\n\nmedia_type\x18\x02 \x01(\x0e\x32&.stream_switch.ProtoSubStreamMediaType\x12\x12\n\ndata_bytes\x18\x14 \x01(\x04\x12\x11\n\tkey_bytes\x18\x15 \x01(\x04\x12\x13\n\x0blost_frames\x18\x1e \x01(\x04\x12\x13\n\x0b\x64\x61ta_frames\x18\x1f \x01(\x04\x12\x12\n\nkey_frames\x18  \x01(\x04\x12\x10\n\x08last_gov\x18! \x01(\x04\x12\x14\n\x0clost_packets\x18( \x01(\x04\x12\x19\n\x11reordered_packets\x18) \x01(\x04\x12\x14\n\x0clate_packets\x18* \x01(\x04\x12\x16\n\x0e\x64\x61maged_frames\x18+ \x01(\x04\x12\x0e\n\x06jitter\x18, \x01(\r\x12\x19\n\x11reorder_threshold\x18- \x01(\r\x12\x15\n\rreorder_delay\x18. \x01(\r\x12\x15\n\rreorder_depth\x18/ \x01(\r\x12\x12\n\npts_offset\x18\x30 \x01(\x05\x12\x11\n\tpts_drift\x18\x31 \x01(\x05\x12\x14\n\x0cpaced_frames\x18\x32 \x01(\x04\x12\x1d\n\x15pacing_dropped_frames\x18\x33 \x01(\x04\x12\x1a\n\x12pacing_late_frames\x18\x34 \x01(\x04\x12\x19\n\x11pacing_mean_error\x18\x35 \x01(\r\x12\x18\n\x10pacing_max_error\x18\x36 \x01(\r\x12\x1e\n\x16pacing_error_histogram\x18\x37 \x03(\x04\"\xfd\x02\n\x16ProtoMediaStatisticRep\x12\x0c\n\x04ssrc\x18\x01 \x01(\r\x12\x11\n\ttimestamp\x18\x02 \x01(\x03\x12\x11\n\tsum_bytes\x18\x03 \x01(\x04\x12\x17\n\x0fread_ahead_fill\x18\x04 \x01(\x03\x12\x1a\n\x12read_ahead_packets\x18\x05 \x01(\r\x12\x1b\n\x13read_ahead_capacity\x18\x06 \x01(\x03\x12\x1c\n\x14read_ahead_underruns\x18\x07 \x01(\x04\x12\x14\n\x0cread_packets\x18\x08 \x01(\x04\x12\x16\n\x0epacing_stretch\x18\t \x01(\x03\x12\x15\n\topen_time\x18\n \x01(\x03:\x02-1\x12\x15\n\tmeta_time\x18\x0b \x01(\x03:\x02-1\x12\x1c\n\x10\x66irst_frame_time\x18\x0c \x01(\x03:\x02-1\x12\x45\n\x10sub_stream_stats\x18@ \x03(\x0b\x32+.stream_switch.ProtoSubStreamMediaStatistic')
   ,
   dependencies=[pb_metadata_pb2.DESCRIPTOR,])
 _sym_db.RegisterFileDescriptor(DESCRIPTOR)
@@ -113,6 +113,118 @@ _PROTOSUBSTREAMMEDIASTATISTIC = _descriptor.Descriptor(
       message_type=None, enum_type=None, containing_type=None,
       is_extension=False, extension_scope=None,
       options=None),
+    _descriptor.FieldDescriptor(
+      name='lost_packets', full_name='stream_switch.ProtoSubStreamMediaStatistic.lost_packets', index=8,
+      number=40, type=4, cpp_type=4, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='reordered_packets', full_name='stream_switch.ProtoSubStreamMediaStatistic.reordered_packets', index=9,
+      number=41, type=4, cpp_type=4, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='late_packets', full_name='stream_switch.ProtoSubStreamMediaStatistic.late_packets', index=10,
+      number=42, type=4, cpp_type=4, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='damaged_frames', full_name='stream_switch.ProtoSubStreamMediaStatistic.damaged_frames', index=11,
+      number=43, type=4, cpp_type=4, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='jitter', full_name='stream_switch.ProtoSubStreamMediaStatistic.jitter', index=12,
+      number=44, type=13, cpp_type=3, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='reorder_threshold', full_name='stream_switch.ProtoSubStreamMediaStatistic.reorder_threshold', index=13,
+      number=45, type=13, cpp_type=3, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='reorder_delay', full_name='stream_switch.ProtoSubStreamMediaStatistic.reorder_delay', index=14,
+      number=46, type=13, cpp_type=3, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='reorder_depth', full_name='stream_switch.ProtoSubStreamMediaStatistic.reorder_depth', index=15,
+      number=47, type=13, cpp_type=3, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='pts_offset', full_name='stream_switch.ProtoSubStreamMediaStatistic.pts_offset', index=16,
+      number=48, type=5, cpp_type=1, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='pts_drift', full_name='stream_switch.ProtoSubStreamMediaStatistic.pts_drift', index=17,
+      number=49, type=5, cpp_type=1, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='paced_frames', full_name='stream_switch.ProtoSubStreamMediaStatistic.paced_frames', index=18,
+      number=50, type=4, cpp_type=4, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='pacing_dropped_frames', full_name='stream_switch.ProtoSubStreamMediaStatistic.pacing_dropped_frames', index=19,
+      number=51, type=4, cpp_type=4, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='pacing_late_frames', full_name='stream_switch.ProtoSubStreamMediaStatistic.pacing_late_frames', index=20,
+      number=52, type=4, cpp_type=4, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='pacing_mean_error', full_name='stream_switch.ProtoSubStreamMediaStatistic.pacing_mean_error', index=21,
+      number=53, type=13, cpp_type=3, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='pacing_max_error', full_name='stream_switch.ProtoSubStreamMediaStatistic.pacing_max_error', index=22,
+      number=54, type=13, cpp_type=3, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='pacing_error_histogram', full_name='stream_switch.ProtoSubStreamMediaStatistic.pacing_error_histogram', index=23,
+      number=55, type=4, cpp_type=4, label=3,
+      has_default_value=False, default_value=[],
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
   ],
   extensions=[
   ],
@@ -125,7 +237,7 @@ _PROTOSUBSTREAMMEDIASTATISTIC = _descriptor.Descriptor(
   oneofs=[
   ],
   serialized_start=89,
-  serialized_end=324,
+  serialized_end=713,
 )
 
 
@@ -158,7 +270,70 @@ _PROTOMEDIASTATISTICREP = _descriptor.Descriptor(
       is_extension=False, extension_scope=None,
       options=None),
     _descriptor.FieldDescriptor(
-      name='sub_stream_stats', full_name='stream_switch.ProtoMediaStatisticRep.sub_stream_stats', index=3,
+      name='read_ahead_fill', full_name='stream_switch.ProtoMediaStatisticRep.read_ahead_fill', index=3,
+      number=4, type=3, cpp_type=2, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='read_ahead_packets', full_name='stream_switch.ProtoMediaStatisticRep.read_ahead_packets', index=4,
+      number=5, type=13, cpp_type=3, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='read_ahead_capacity', full_name='stream_switch.ProtoMediaStatisticRep.read_ahead_capacity', index=5,
+      number=6, type=3, cpp_type=2, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='read_ahead_underruns', full_name='stream_switch.ProtoMediaStatisticRep.read_ahead_underruns', index=6,
+      number=7, type=4, cpp_type=4, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='read_packets', full_name='stream_switch.ProtoMediaStatisticRep.read_packets', index=7,
+      number=8, type=4, cpp_type=4, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='pacing_stretch', full_name='stream_switch.ProtoMediaStatisticRep.pacing_stretch', index=8,
+      number=9, type=3, cpp_type=2, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='open_time', full_name='stream_switch.ProtoMediaStatisticRep.open_time', index=9,
+      number=10, type=3, cpp_type=2, label=1,
+      has_default_value=True, default_value=-1,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='meta_time', full_name='stream_switch.ProtoMediaStatisticRep.meta_time', index=10,
+      number=11, type=3, cpp_type=2, label=1,
+      has_default_value=True, default_value=-1,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='first_frame_time', full_name='stream_switch.ProtoMediaStatisticRep.first_frame_time', index=11,
+      number=12, type=3, cpp_type=2, label=1,
+      has_default_value=True, default_value=-1,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='sub_stream_stats', full_name='stream_switch.ProtoMediaStatisticRep.sub_stream_stats', index=12,
       number=64, type=11, cpp_type=10, label=3,
       has_default_value=False, default_value=[],
       message_type=None, enum_type=None, containing_type=None,
@@ -175,8 +350,8 @@ _PROTOMEDIASTATISTICREP = _descriptor.Descriptor(
   extension_ranges=[],
   oneofs=[
   ],
-  serialized_start=327,
-  serialized_end=474,
+  serialized_start=716,
+  serialized_end=1097,
 )
 
 _PROTOSUBSTREAMMEDIASTATISTIC.fields_by_name['media_type'].enum_type = pb_metadata_pb2._PROTOSUBSTREAMMEDIATYPE
@@ -0,0 +1,24 @@
+"""
+streamswitch.sources.transcode_source
+~~~~~~~~~~~~~~~~~~~~~~~
+
+This module implements the stream factory of the transcode source type
+
+:copyright: (c) 2016 by OpenSight (www.opensight.cn).
+:license: AGPLv3, see LICENSE for more details.
+
+"""
+
+from __future__ import unicode_literals, division
+from ..stream_mngr import register_source_type, SourceProcessStream
+from ..exceptions import ExecutableNotFoundError
+from ..utils import find_executable
+from ..process_mngr import kill_all
+
+TRANSCODE_SOURCE_PROGRAM_NAME = "stsw_transcode_filter"
+TRANSCODE_SOURCE_TYPE_NAME = "transcode"
+
+class TranscodeSourceStream(SourceProcessStream):
+    _executable = TRANSCODE_SOURCE_PROGRAM_NAME
+
+
@@ -17,6 +17,7 @@ from ...process_mngr import kill_all
 from ...sources.file_live_source import FILE_LIVE_SOURCE_PROGRAM_NAME
 from ...sources.proxy_source import PROXY_SOURCE_PROGRAM_NAME
 from ...sources.rtsp_source import RTSP_SOURCE_PROGRAM_NAME
+from ...sources.transcode_source import TRANSCODE_SOURCE_PROGRAM_NAME
 from ..models import StreamConf
 
 
@@ -64,6 +65,7 @@ class StreamService(object):
         kill_all(RTSP_SOURCE_PROGRAM_NAME)
         kill_all(PROXY_SOURCE_PROGRAM_NAME)
         kill_all(FILE_LIVE_SOURCE_PROGRAM_NAME)
+        kill_all(TRANSCODE_SOURCE_PROGRAM_NAME)
         self.load()
 
     def load(self):
@@ -0,0 +1,273 @@
+/**
+ * This file is part of stsw_transcode_filter, which belongs to StreamSwitch
+ * project. 
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_annexb_filter.cc
+ *      AnnexbFilter class implementation file, define its methods
+ *
+ * author: OpenSight Team
+ * date: 2016-4-23
+**/
+
+#include "stsw_annexb_filter.h"
+
+#include <strings.h>
+
+#include "stsw_transcode_stream.h"
+#include "stsw_log.h"
+
+extern "C"{
+
+#include <libavcodec/avcodec.h>
+
+}
+
+
+static const char start_code[4] = {0, 0, 0, 1};
+
+
+static bool HasStartCode(const uint8_t * data, size_t size)
+{
+    if(size >= 3 && data[0] == 0 && data[1] == 0 && data[2] == 1){
+        return true;
+    }
+    if(size >= 4 && data[0] == 0 && data[1] == 0 && data[2] == 0 && data[3] == 1){
+        return true;
+    }
+    return false;
+}
+
+// append the NAL with a 2-byte length prefix at data[*pos] as Annex-B
+static int AppendNal16(const uint8_t * data, size_t size, size_t *pos,
+                       std::string *out)
+{
+    size_t nal_size;
+    if((*pos) + 2 > size){
+        return TRANSCODE_FILTER_ERR_INVALID_FRAME;
+    }
+    nal_size = (data[*pos] << 8) | data[(*pos) + 1];
+    (*pos) += 2;
+    if(nal_size > size - (*pos)){
+        return TRANSCODE_FILTER_ERR_INVALID_FRAME;
+    }
+    out->append(start_code, 4);
+    out->append((const char *)(data + (*pos)), nal_size);
+    (*pos) += nal_size;
+    return 0;
+}
+
+
+AnnexbFilter::AnnexbFilter()
+:SubStreamFilter(), is_h265_(false), nal_length_size_(4)
+{
+
+}
+AnnexbFilter::~AnnexbFilter()
+{
+
+}
+
+int AnnexbFilter::Init(TranscodeStream * stream,
+                       const stream_switch::SubStreamMetadata &in_metadata,
+                       const TranscodeOptions &options,
+                       stream_switch::SubStreamMetadata *out_metadata)
+{
+    using namespace stream_switch;
+    int ret;
+
+    if(is_init_){
+        return 0;
+    }
+
+    is_h265_ = (CodecIdFromName(in_metadata.codec_name) == AV_CODEC_ID_H265);
+    ret = ParseExtraData(in_metadata.extra_data);
+    if(ret){
+        STDERR_LOG(LOG_LEVEL_ERR,
+                   "The extra data of sub stream %d (%s) is invalid\n",
+                   (int)in_metadata.sub_stream_index,
+                   in_metadata.codec_name.c_str());
+        return ret;
+    }
+
+    stream_ = stream;
+    (*out_metadata) = in_metadata;
+    out_metadata->extra_data = param_sets_;
+    is_init_ = true;
+    return 0;
+}
+
+void AnnexbFilter::Uninit()
+{
+    if(!is_init_){
+        return;
+    }
+    is_init_ = false;
+    stream_ = NULL;
+    param_sets_.clear();
+    buf_.clear();
+}
+
+int AnnexbFilter::Filter(const stream_switch::MediaFrameInfo &frame_info,
+                         const char * frame_data,
+                         size_t frame_size)
+{
+    const uint8_t * data = (const uint8_t *)frame_data;
+    size_t pos = 0;
+    size_t prefix_size = 0;
+    bool has_param_sets = false;
+
+    if(!is_init_){
+        return TRANSCODE_FILTER_ERR_GENERAL;
+    }
+    if(HasStartCode(data, frame_size)){
+        return stream_->SendFrame(frame_info, frame_data, frame_size);
+    }
+
+    buf_.clear();
+    if(frame_info.frame_type == stream_switch::MEDIA_FRAME_TYPE_KEY_FRAME){
+        buf_.append(param_sets_);
+        prefix_size = param_sets_.size();
+    }
+
+    while(pos < frame_size){
+        size_t nal_size = 0;
+        int i;
+        if(pos + nal_length_size_ > frame_size){
+            return TRANSCODE_FILTER_ERR_INVALID_FRAME;
+        }
+        for(i = 0; i < nal_length_size_; i++){
+            nal_size = (nal_size << 8) | data[pos + i];
+        }
+        pos += nal_length_size_;
+        if(nal_size > frame_size - pos){
+            return TRANSCODE_FILTER_ERR_INVALID_FRAME;
+        }
+        if(nal_size == 0){
+            continue;
+        }
+        if(IsParamSet(data[pos])){
+            has_param_sets = true;
+        }
+        buf_.append(start_code, 4);
+        buf_.append((const char *)(data + pos), nal_size);
+        pos += nal_size;
+    }
+
+    if(has_param_sets && prefix_size != 0){
+        // the key frame carries its own parameter sets
+        buf_.erase(0, prefix_size);
+    }
+    if(buf_.size() == prefix_size){
+        return 0;   // no NAL in it
+    }
+
+    return stream_->SendFrame(frame_info, buf_.data(), buf_.size());
+}
+
+int AnnexbFilter::ParseExtraData(const std::string &extra_data)
+{
+    const uint8_t * data = (const uint8_t *)extra_data.data();
+    size_t size = extra_data.size();
+    size_t pos;
+    int ret;
+
+    param_sets_.clear();
+    nal_length_size_ = 4;
+
+    if(size == 0){
+        return 0;
+    }
+    if(HasStartCode(data, size)){
+        param_sets_ = extra_data;
+        return 0;
+    }
+    if(data[0] != 1){
+        // neither Annex-B nor the version 1 of avcC/hvcC
+        return TRANSCODE_FILTER_ERR_INVALID_FRAME;
+    }
+
+    if(!is_h265_){
+        // avcC: version, profile, compatibility, level, length size,
+        // SPS number + SPSs, PPS number + PPSs
+        int sps_num, pps_num, i;
+        if(size < 7){
+            return TRANSCODE_FILTER_ERR_INVALID_FRAME;
+        }
+        nal_length_size_ = (data[4] & 0x3) + 1;
+        sps_num = data[5] & 0x1f;
+        pos = 6;
+        for(i = 0; i < sps_num; i++){
+            ret = AppendNal16(data, size, &pos, &param_sets_);
+            if(ret){
+                return ret;
+            }
+        }
+        if(pos >= size){
+            return TRANSCODE_FILTER_ERR_INVALID_FRAME;
+        }
+        pps_num = data[pos];
+        pos++;
+        for(i = 0; i < pps_num; i++){
+            ret = AppendNal16(data, size, &pos, &param_sets_);
+            if(ret){
+                return ret;
+            }
+        }
+    }else{
+        // hvcC: 22 bytes of the general fields, the length size in the
+        // last one, then the arrays of (type, NAL number, NALs)
+        int array_num, nal_num, i, j;
+        if(size < 23){
+            return TRANSCODE_FILTER_ERR_INVALID_FRAME;
+        }
+        nal_length_size_ = (data[21] & 0x3) + 1;
+        array_num = data[22];
+        pos = 23;
+        for(i = 0; i < array_num; i++){
+            if(pos + 3 > size){
+                return TRANSCODE_FILTER_ERR_INVALID_FRAME;
+            }
+            nal_num = (data[pos + 1] << 8) | data[pos + 2];
+            pos += 3;
+            for(j = 0; j < nal_num; j++){
+                ret = AppendNal16(data, size, &pos, &param_sets_);
+                if(ret){
+                    return ret;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+bool AnnexbFilter::IsParamSet(uint8_t nal_header)
+{
+    if(!is_h265_){
+        int nal_type = nal_header & 0x1f;
+        return nal_type == 7 || nal_type == 8;      // SPS, PPS
+    }else{
+        int nal_type = (nal_header >> 1) & 0x3f;
+        return nal_type >= 32 && nal_type <= 34;    // VPS, SPS, PPS
+    }
+}
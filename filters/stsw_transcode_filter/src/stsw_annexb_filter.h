@@ -0,0 +1,82 @@
+/**
+ * This file is part of stsw_transcode_filter, which belongs to StreamSwitch
+ * project. 
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_annexb_filter.h
+ *      AnnexbFilter class header file, define intefaces of the
+ * AnnexbFilter class.
+ *      AnnexbFilter is sub class of SubStreamFilter, which normalizes the
+ * H264/H265 sub stream into the Annex-B byte stream format
+ *
+ * author: OpenSight Team
+ * date: 2016-4-23
+**/
+
+#ifndef STSW_ANNEXB_FILTER_H
+#define STSW_ANNEXB_FILTER_H
+
+#include <stdint.h>
+#include <string>
+
+#include "stsw_sub_stream_filter.h"
+
+
+// AnnexbFilter
+//    Some sources publish H264/H265 in the length-prefixed format of the
+// MP4/FLV file (AVCC/HVCC), with the parameter sets only in the
+// avcC/hvcC box of the metadata extra data. This filter converts such
+// frames into Annex-B with 4-byte start codes once, and repeats the
+// parameter sets before each key frame which has none, so the consumers
+// need not do it for every output. The frames already in Annex-B are
+// passed through untouched.
+class AnnexbFilter:public SubStreamFilter{
+
+public:
+    AnnexbFilter();
+    virtual ~AnnexbFilter();
+
+    virtual int Init(TranscodeStream * stream,
+                     const stream_switch::SubStreamMetadata &in_metadata,
+                     const TranscodeOptions &options,
+                     stream_switch::SubStreamMetadata *out_metadata);
+    virtual void Uninit();
+
+    virtual int Filter(const stream_switch::MediaFrameInfo &frame_info,
+                       const char * frame_data,
+                       size_t frame_size);
+
+protected:
+    // ParseExtraData()
+    // convert the avcC/hvcC box into the Annex-B parameter sets, and get
+    // the NAL length size from it
+    virtual int ParseExtraData(const std::string &extra_data);
+
+    virtual bool IsParamSet(uint8_t nal_header);
+
+    bool is_h265_;
+    int nal_length_size_;
+    std::string param_sets_;   // in Annex-B
+    std::string buf_;          // the output frame, reused for each frame
+};
+
+#endif
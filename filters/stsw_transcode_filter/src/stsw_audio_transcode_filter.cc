@@ -0,0 +1,586 @@
+/**
+ * This file is part of stsw_transcode_filter, which belongs to StreamSwitch
+ * project. 
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_audio_transcode_filter.cc
+ *      AudioTranscodeFilter class implementation file, define its methods
+ *
+ * author: OpenSight Team
+ * date: 2016-4-23
+**/
+
+#include "stsw_audio_transcode_filter.h"
+
+#include <string.h>
+
+#include "stsw_transcode_stream.h"
+#include "stsw_log.h"
+
+extern "C"{
+
+#include <libavutil/avutil.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/frame.h>
+#include <libavutil/samplefmt.h>
+
+}
+
+
+AudioTranscodeFilter::AudioTranscodeFilter()
+:SubStreamFilter(), in_codec_context_(NULL), out_codec_context_(NULL),
+resample_context_(NULL), fifo_(NULL), fifo_pts_(AV_NOPTS_VALUE),
+frame_samples_(0), converted_samples_(NULL), converted_capacity_(0),
+sub_stream_index_(0), has_base_(false)
+{
+    input_frame_ = av_frame_alloc();
+    output_frame_ = av_frame_alloc();
+    base_timestamp_.tv_sec = 0;
+    base_timestamp_.tv_usec = 0;
+}
+AudioTranscodeFilter::~AudioTranscodeFilter()
+{
+    Uninit();
+    av_frame_free(&input_frame_);
+    av_frame_free(&output_frame_);
+}
+
+int AudioTranscodeFilter::Init(TranscodeStream * stream,
+                               const stream_switch::SubStreamMetadata &in_metadata,
+                               const TranscodeOptions &options,
+                               stream_switch::SubStreamMetadata *out_metadata)
+{
+    using namespace stream_switch;
+    int ret = 0;
+
+    if(is_init_){
+        return 0;
+    }
+
+    ret = InitInputContext(in_metadata);
+    if(ret){
+        goto error_1;
+    }
+    ret = InitOutputContext(options);
+    if(ret){
+        goto error_2;
+    }
+    ret = InitResampler();
+    if(ret){
+        goto error_3;
+    }
+    ret = InitAudioFifo();
+    if(ret){
+        goto error_4;
+    }
+    ret = InitOutputFrame();
+    if(ret){
+        goto error_5;
+    }
+
+    (*out_metadata) = in_metadata;
+    out_metadata->codec_name = CodecNameFromId(out_codec_context_->codec_id);
+    out_metadata->extra_data.clear();
+    if(out_codec_context_->extradata != NULL &&
+       out_codec_context_->extradata_size > 0){
+        out_metadata->extra_data.assign(
+            (const char *)out_codec_context_->extradata,
+            out_codec_context_->extradata_size);
+    }
+    out_metadata->media_param.audio.samples_per_second =
+        out_codec_context_->sample_rate;
+    out_metadata->media_param.audio.channels = out_codec_context_->channels;
+    out_metadata->media_param.audio.bits_per_sample =
+        av_get_bits_per_sample(out_codec_context_->codec_id);
+    out_metadata->media_param.audio.sampele_per_frame = frame_samples_;
+
+    stream_ = stream;
+    sub_stream_index_ = in_metadata.sub_stream_index;
+    fifo_pts_ = AV_NOPTS_VALUE;
+    has_base_ = false;
+    is_init_ = true;
+
+    {
+        char buf[256];
+        avcodec_string(buf, sizeof(buf), in_codec_context_, 0);
+        STDERR_LOG(LOG_LEVEL_INFO,
+                   "Sub stream %d is transcoded from the codec context (%s) to %s\n",
+                   (int)in_metadata.sub_stream_index, buf,
+                   out_metadata->codec_name.c_str());
+    }
+
+    return 0;
+
+error_5:
+    av_audio_fifo_free(fifo_);
+    fifo_ = NULL;
+
+error_4:
+    swr_free(&resample_context_);
+
+error_3:
+    avcodec_close(out_codec_context_);
+    avcodec_free_context(&out_codec_context_);
+
+error_2:
+    avcodec_close(in_codec_context_);
+    avcodec_free_context(&in_codec_context_);
+
+error_1:
+    return ret;
+}
+
+void AudioTranscodeFilter::Uninit()
+{
+    if(!is_init_){
+        return;
+    }
+    is_init_ = false;
+    stream_ = NULL;
+
+    if(converted_samples_ != NULL){
+        av_freep(&converted_samples_[0]);
+        av_freep(&converted_samples_);
+    }
+    converted_capacity_ = 0;
+
+    av_frame_unref(input_frame_);
+    av_frame_unref(output_frame_);
+
+    if(fifo_ != NULL){
+        av_audio_fifo_free(fifo_);
+        fifo_ = NULL;
+    }
+    if(resample_context_ != NULL){
+        swr_free(&resample_context_);
+    }
+    if(out_codec_context_ != NULL){
+        avcodec_close(out_codec_context_);
+        avcodec_free_context(&out_codec_context_);
+    }
+    if(in_codec_context_ != NULL){
+        avcodec_close(in_codec_context_);
+        avcodec_free_context(&in_codec_context_);
+    }
+}
+
+int AudioTranscodeFilter::Filter(const stream_switch::MediaFrameInfo &frame_info,
+                                 const char * frame_data,
+                                 size_t frame_size)
+{
+    using namespace stream_switch;
+    AVPacket input_pkt;
+    int data_present = 0;
+    int error;
+    int64_t pts;
+
+    if(!is_init_){
+        return TRANSCODE_FILTER_ERR_GENERAL;
+    }
+
+    if(!has_base_){
+        base_timestamp_ = frame_info.timestamp;
+        has_base_ = true;
+    }
+    pts = TimeToPts(frame_info.timestamp);
+
+    av_init_packet(&input_pkt);
+    input_pkt.data = (uint8_t *)frame_data;
+    input_pkt.size = frame_size;
+
+    error = avcodec_decode_audio4(in_codec_context_, input_frame_,
+                                  &data_present, &input_pkt);
+    if(error < 0){
+        char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
+        STDERR_LOG(LOG_LEVEL_ERR, "Could not decode frame (error '%s')\n",
+                   av_make_error_string(errbuf, AV_ERROR_MAX_STRING_SIZE, error));
+        return TRANSCODE_FILTER_ERR_CODEC;
+    }
+    if(!data_present){
+        return 0;
+    }
+
+    error = ConvertSamples(pts);
+    av_frame_unref(input_frame_);
+    if(error){
+        return error;
+    }
+
+    return EncodeAudioFifo();
+}
+
+int AudioTranscodeFilter::InitInputContext(const stream_switch::SubStreamMetadata &in_metadata)
+{
+    using namespace stream_switch;
+    AVCodec *input_codec = NULL;
+    enum AVCodecID codec_id;
+    int i;
+    int ret;
+
+    codec_id = (enum AVCodecID)CodecIdFromName(in_metadata.codec_name);
+    if(codec_id == AV_CODEC_ID_NONE){
+        STDERR_LOG(LOG_LEVEL_ERR, "decoder for %s not support\n",
+                   in_metadata.codec_name.c_str());
+        return TRANSCODE_FILTER_ERR_NOT_SUPPORT;
+    }
+    input_codec = avcodec_find_decoder(codec_id);
+    if(input_codec == NULL){
+        STDERR_LOG(LOG_LEVEL_ERR, "Could not find decoder for '%s'\n",
+                   in_metadata.codec_name.c_str());
+        return TRANSCODE_FILTER_ERR_NOT_SUPPORT;
+    }
+    in_codec_context_ = avcodec_alloc_context3(input_codec);
+    if(in_codec_context_ == NULL){
+        STDERR_LOG(LOG_LEVEL_ERR, "Could not allocate audio codec context for '%s'\n",
+                   input_codec->name);
+        return TRANSCODE_FILTER_ERR_GENERAL;
+    }
+
+    if(in_metadata.media_param.audio.samples_per_second != 0){
+        in_codec_context_->sample_rate =
+            in_metadata.media_param.audio.samples_per_second;
+    }else{
+        in_codec_context_->sample_rate = 8000; //the lowest rate
+        if(input_codec->supported_samplerates){
+            in_codec_context_->sample_rate = input_codec->supported_samplerates[0];
+            for(i = 0; input_codec->supported_samplerates[i]; i++){
+                if(input_codec->supported_samplerates[i] == 8000)
+                    in_codec_context_->sample_rate = 8000;
+            }
+        }
+    }
+    if(in_metadata.media_param.audio.channels != 0){
+        in_codec_context_->channels = in_metadata.media_param.audio.channels;
+    }else{
+        in_codec_context_->channels = 1;
+    }
+    in_codec_context_->channel_layout =
+        av_get_default_channel_layout(in_codec_context_->channels);
+    in_codec_context_->time_base.num = 1;
+    in_codec_context_->time_base.den = in_codec_context_->sample_rate;
+
+    if(in_metadata.extra_data.size() != 0){
+        in_codec_context_->extradata_size = in_metadata.extra_data.size();
+        in_codec_context_->extradata =
+            (uint8_t *)av_mallocz(in_codec_context_->extradata_size +
+                                  FF_INPUT_BUFFER_PADDING_SIZE);
+        memcpy(in_codec_context_->extradata, in_metadata.extra_data.data(),
+               in_codec_context_->extradata_size);
+    }
+
+    ret = avcodec_open2(in_codec_context_, input_codec, NULL);
+    if(ret < 0){
+        char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
+        STDERR_LOG(LOG_LEVEL_ERR, "Could not open input codec (%s) context: %s\n",
+                   in_metadata.codec_name.c_str(),
+                   av_make_error_string(errbuf, AV_ERROR_MAX_STRING_SIZE, ret));
+        avcodec_free_context(&in_codec_context_);
+        return TRANSCODE_FILTER_ERR_CODEC;
+    }
+
+    return 0;
+}
+
+int AudioTranscodeFilter::InitOutputContext(const TranscodeOptions &options)
+{
+    using namespace stream_switch;
+    AVCodec *codec = NULL;
+    enum AVCodecID codec_id;
+    int sample_rate;
+    int i;
+    int ret;
+
+    codec_id = (enum AVCodecID)CodecIdFromName(options.audio_codec);
+    if(codec_id == AV_CODEC_ID_NONE){
+        STDERR_LOG(LOG_LEVEL_ERR, "encoder for %s not support\n",
+                   options.audio_codec.c_str());
+        return TRANSCODE_FILTER_ERR_NOT_SUPPORT;
+    }
+    codec = avcodec_find_encoder(codec_id);
+    if(codec == NULL){
+        STDERR_LOG(LOG_LEVEL_ERR, "Could not find encoder for '%s'\n",
+                   avcodec_get_name(codec_id));
+        return TRANSCODE_FILTER_ERR_NOT_SUPPORT;
+    }
+    out_codec_context_ = avcodec_alloc_context3(codec);
+    if(out_codec_context_ == NULL){
+        STDERR_LOG(LOG_LEVEL_ERR, "Could not allocate audio codec context for '%s'\n",
+                   codec->name);
+        return TRANSCODE_FILTER_ERR_GENERAL;
+    }
+
+    // keep the input sample rate if the encoder supports it, otherwise
+    // pick the lowest supported one above it
+    sample_rate = in_codec_context_->sample_rate;
+    if(codec->supported_samplerates){
+        int best = 0;
+        for(i = 0; codec->supported_samplerates[i]; i++){
+            int rate = codec->supported_samplerates[i];
+            if(rate == sample_rate){
+                best = rate;
+                break;
+            }
+            if(rate > sample_rate){
+                if(best < sample_rate || rate < best){
+                    best = rate;
+                }
+            }else if(best < sample_rate && rate > best){
+                best = rate;   // the highest one, while none is above
+            }
+        }
+        sample_rate = best;
+    }
+
+    out_codec_context_->channels       = in_codec_context_->channels;
+    out_codec_context_->channel_layout =
+        av_get_default_channel_layout(in_codec_context_->channels);
+    out_codec_context_->sample_rate    = sample_rate;
+    out_codec_context_->sample_fmt     = (codec->sample_fmts)?
+                                         codec->sample_fmts[0] : AV_SAMPLE_FMT_FLTP;
+    out_codec_context_->time_base.num  = 1;
+    out_codec_context_->time_base.den  = sample_rate;
+    if(options.audio_bitrate > 0){
+        out_codec_context_->bit_rate = options.audio_bitrate;
+    }
+
+    /** Allow the use of the experimental AAC encoder */
+    out_codec_context_->strict_std_compliance = FF_COMPLIANCE_EXPERIMENTAL;
+
+    // the codec config (e.g. AudioSpecificConfig of AAC) goes into the
+    // metadata extra data, and the frames are raw
+    out_codec_context_->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+    ret = avcodec_open2(out_codec_context_, codec, NULL);
+    if(ret < 0){
+        char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
+        STDERR_LOG(LOG_LEVEL_ERR, "Could not open output codec (%s) context: %s\n",
+                   avcodec_get_name(codec_id),
+                   av_make_error_string(errbuf, AV_ERROR_MAX_STRING_SIZE, ret));
+        avcodec_free_context(&out_codec_context_);
+        return TRANSCODE_FILTER_ERR_CODEC;
+    }
+
+    // the encoders of variable frame size (e.g. PCM) output 20ms per frame
+    frame_samples_ = out_codec_context_->frame_size;
+    if(frame_samples_ <= 0){
+        frame_samples_ = sample_rate / 50;
+    }
+
+    return 0;
+}
+
+int AudioTranscodeFilter::InitResampler()
+{
+    using namespace stream_switch;
+    int ret;
+
+    resample_context_ =
+        swr_alloc_set_opts(NULL,
+                           out_codec_context_->channel_layout,
+                           out_codec_context_->sample_fmt,
+                           out_codec_context_->sample_rate,
+                           in_codec_context_->channel_layout,
+                           in_codec_context_->sample_fmt,
+                           in_codec_context_->sample_rate,
+                           0, NULL);
+    if(resample_context_ == NULL){
+        STDERR_LOG(LOG_LEVEL_ERR, "Could not allocate resample context\n");
+        return TRANSCODE_FILTER_ERR_GENERAL;
+    }
+
+    ret = swr_init(resample_context_);
+    if(ret < 0){
+        char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
+        swr_free(&resample_context_);
+        STDERR_LOG(LOG_LEVEL_ERR, "Could not open resample context: %s\n",
+                   av_make_error_string(errbuf, AV_ERROR_MAX_STRING_SIZE, ret));
+        return TRANSCODE_FILTER_ERR_GENERAL;
+    }
+    return 0;
+}
+
+int AudioTranscodeFilter::InitAudioFifo()
+{
+    using namespace stream_switch;
+    fifo_ = av_audio_fifo_alloc(out_codec_context_->sample_fmt,
+                                out_codec_context_->channels,
+                                frame_samples_ * 2);
+    if(fifo_ == NULL){
+        STDERR_LOG(LOG_LEVEL_ERR, "Could not allocate audio FIFO\n");
+        return TRANSCODE_FILTER_ERR_GENERAL;
+    }
+    return 0;
+}
+
+int AudioTranscodeFilter::InitOutputFrame()
+{
+    using namespace stream_switch;
+    int error;
+
+    av_frame_unref(output_frame_);
+    output_frame_->nb_samples     = frame_samples_;
+    output_frame_->channel_layout = out_codec_context_->channel_layout;
+    output_frame_->format         = out_codec_context_->sample_fmt;
+    output_frame_->sample_rate    = out_codec_context_->sample_rate;
+
+    if((error = av_frame_get_buffer(output_frame_, 0)) < 0){
+        char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
+        STDERR_LOG(LOG_LEVEL_ERR,
+                   "Could allocate output frame samples (error '%s')\n",
+                   av_make_error_string(errbuf, AV_ERROR_MAX_STRING_SIZE, error));
+        return TRANSCODE_FILTER_ERR_GENERAL;
+    }
+    return 0;
+}
+
+int AudioTranscodeFilter::ConvertSamples(int64_t pts)
+{
+    using namespace stream_switch;
+    int out_samples;
+    int error;
+
+    // follow the frame time if the samples drift away from it, e.g. the
+    // input lost some frames
+    if(fifo_pts_ != AV_NOPTS_VALUE){
+        int64_t last_pts = fifo_pts_ + av_audio_fifo_size(fifo_);
+        int64_t delta_pts = (pts >= last_pts)?(pts - last_pts):(last_pts - pts);
+        if(delta_pts * 1000 / out_codec_context_->sample_rate > AUDIO_FIFO_MAX_OFFSET){
+            STDERR_LOG(LOG_LEVEL_WARNING,
+                       "Audio fifo pts of sub stream %d inconsistent, cleanup Fifo\n",
+                       (int)sub_stream_index_);
+            av_audio_fifo_reset(fifo_);
+            fifo_pts_ = AV_NOPTS_VALUE;
+        }
+    }
+
+    // the converted samples buffer is reused across the frames, and only
+    // grows when a larger frame comes
+    out_samples = swr_get_out_samples(resample_context_, input_frame_->nb_samples);
+    if(out_samples > converted_capacity_){
+        if(converted_samples_ != NULL){
+            av_freep(&converted_samples_[0]);
+            av_freep(&converted_samples_);
+        }
+        converted_capacity_ = 0;
+        error = av_samples_alloc_array_and_samples(&converted_samples_, NULL,
+                                                   out_codec_context_->channels,
+                                                   out_samples,
+                                                   out_codec_context_->sample_fmt, 0);
+        if(error < 0){
+            char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
+            STDERR_LOG(LOG_LEVEL_ERR,
+                       "Could not allocate converted input samples (error '%s')\n",
+                       av_make_error_string(errbuf, AV_ERROR_MAX_STRING_SIZE, error));
+            converted_samples_ = NULL;
+            return TRANSCODE_FILTER_ERR_GENERAL;
+        }
+        converted_capacity_ = out_samples;
+    }
+
+    out_samples = swr_convert(resample_context_,
+                              converted_samples_, converted_capacity_,
+                              (const uint8_t**)input_frame_->extended_data,
+                              input_frame_->nb_samples);
+    if(out_samples < 0){
+        char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
+        STDERR_LOG(LOG_LEVEL_ERR, "Could not convert input samples (error '%s')\n",
+                   av_make_error_string(errbuf, AV_ERROR_MAX_STRING_SIZE, out_samples));
+        return TRANSCODE_FILTER_ERR_CODEC;
+    }
+
+    if(av_audio_fifo_write(fifo_, (void **)converted_samples_, out_samples) < out_samples){
+        STDERR_LOG(LOG_LEVEL_ERR, "Could not write data to FIFO\n");
+        return TRANSCODE_FILTER_ERR_GENERAL;
+    }
+    if(fifo_pts_ == AV_NOPTS_VALUE){
+        fifo_pts_ = pts;
+    }
+    return 0;
+}
+
+int AudioTranscodeFilter::EncodeAudioFifo()
+{
+    using namespace stream_switch;
+    int ret = 0;
+
+    while(av_audio_fifo_size(fifo_) >= frame_samples_){
+        AVPacket output_packet;
+        int data_present = 0;
+        int error;
+
+        error = av_frame_make_writable(output_frame_);
+        if(error < 0){
+            return TRANSCODE_FILTER_ERR_GENERAL;
+        }
+        if(av_audio_fifo_read(fifo_, (void **)output_frame_->data,
+                              frame_samples_) < frame_samples_){
+            STDERR_LOG(LOG_LEVEL_ERR, "Could not read data from FIFO\n");
+            return TRANSCODE_FILTER_ERR_GENERAL;
+        }
+        output_frame_->pts = fifo_pts_;
+        fifo_pts_ += frame_samples_;
+
+        av_init_packet(&output_packet);
+        output_packet.data = NULL;
+        output_packet.size = 0;
+        error = avcodec_encode_audio2(out_codec_context_, &output_packet,
+                                      output_frame_, &data_present);
+        if(error < 0){
+            char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
+            STDERR_LOG(LOG_LEVEL_ERR, "Could not encode frame (error '%s')\n",
+                       av_make_error_string(errbuf, AV_ERROR_MAX_STRING_SIZE, error));
+            return TRANSCODE_FILTER_ERR_CODEC;
+        }
+
+        if(data_present){
+            MediaFrameInfo frame_info;
+            frame_info.sub_stream_index = sub_stream_index_;
+            frame_info.frame_type = MEDIA_FRAME_TYPE_KEY_FRAME;
+            PtsToTime(output_packet.pts, &frame_info.timestamp);
+            ret = stream_->SendFrame(frame_info,
+                                     (const char *)output_packet.data,
+                                     output_packet.size);
+            av_free_packet(&output_packet);
+            if(ret){
+                return ret;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int64_t AudioTranscodeFilter::TimeToPts(const struct timeval &timestamp)
+{
+    int64_t delta = (int64_t)(timestamp.tv_sec - base_timestamp_.tv_sec) * 1000000 +
+                    (timestamp.tv_usec - base_timestamp_.tv_usec);
+    return av_rescale(delta, out_codec_context_->sample_rate, 1000000);
+}
+
+void AudioTranscodeFilter::PtsToTime(int64_t pts, struct timeval *timestamp)
+{
+    int64_t time = (int64_t)base_timestamp_.tv_sec * 1000000 +
+                   base_timestamp_.tv_usec +
+                   av_rescale(pts, 1000000, out_codec_context_->sample_rate);
+    timestamp->tv_sec = time / 1000000;
+    timestamp->tv_usec = time % 1000000;
+}
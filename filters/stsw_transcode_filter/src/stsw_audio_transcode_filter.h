@@ -0,0 +1,117 @@
+/**
+ * This file is part of stsw_transcode_filter, which belongs to StreamSwitch
+ * project. 
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_audio_transcode_filter.h
+ *      AudioTranscodeFilter class header file, define intefaces of the
+ * AudioTranscodeFilter class.
+ *      AudioTranscodeFilter is sub class of SubStreamFilter, which
+ * transcodes the audio sub stream into another codec, e.g. G.711 to AAC
+ *
+ * author: OpenSight Team
+ * date: 2016-4-23
+**/
+
+#ifndef STSW_AUDIO_TRANSCODE_FILTER_H
+#define STSW_AUDIO_TRANSCODE_FILTER_H
+
+#include <stdint.h>
+#include <sys/time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <libavutil/opt.h>
+#include <libavcodec/avcodec.h>
+#include <libswresample/swresample.h>
+#include <libavutil/audio_fifo.h>
+#ifdef __cplusplus
+}
+#endif
+
+#include "stsw_sub_stream_filter.h"
+
+
+// the max offset between the frame time and the samples in the fifo, over
+// which the fifo is reset to follow the frame time
+#define AUDIO_FIFO_MAX_OFFSET    300    // in ms
+
+
+// AudioTranscodeFilter
+//    Decode the input frames, resample them to the sample format of the
+// encoder, and re-encode them in the frame size of the encoder through an
+// audio fifo. The time of the output frames is counted by the samples
+// from the first input frame, so that it's continuous, unless the input
+// frame time drifts away from it over AUDIO_FIFO_MAX_OFFSET.
+class AudioTranscodeFilter:public SubStreamFilter{
+
+public:
+    AudioTranscodeFilter();
+    virtual ~AudioTranscodeFilter();
+
+    virtual int Init(TranscodeStream * stream,
+                     const stream_switch::SubStreamMetadata &in_metadata,
+                     const TranscodeOptions &options,
+                     stream_switch::SubStreamMetadata *out_metadata);
+    virtual void Uninit();
+
+    virtual int Filter(const stream_switch::MediaFrameInfo &frame_info,
+                       const char * frame_data,
+                       size_t frame_size);
+
+protected:
+    virtual int InitInputContext(const stream_switch::SubStreamMetadata &in_metadata);
+    virtual int InitOutputContext(const TranscodeOptions &options);
+    virtual int InitResampler();
+    virtual int InitAudioFifo();
+    virtual int InitOutputFrame();
+
+    // ConvertSamples()
+    // resample the decoded input_frame_ into the fifo
+    virtual int ConvertSamples(int64_t pts);
+
+    // EncodeAudioFifo()
+    // encode and send the samples in the fifo frame by frame
+    virtual int EncodeAudioFifo();
+
+    virtual int64_t TimeToPts(const struct timeval &timestamp);
+    virtual void PtsToTime(int64_t pts, struct timeval *timestamp);
+
+    AVCodecContext *in_codec_context_;
+    AVCodecContext *out_codec_context_;
+    SwrContext *resample_context_;
+    AVAudioFifo *fifo_;
+    int64_t fifo_pts_;          // the pts of the first sample in fifo
+    int frame_samples_;         // the samples of each output frame
+    AVFrame *input_frame_;
+    AVFrame *output_frame_;
+    uint8_t **converted_samples_;
+    int converted_capacity_;    // in samples
+
+    int32_t sub_stream_index_;
+    struct timeval base_timestamp_;   // the time of pts 0
+    bool has_base_;
+};
+
+#endif
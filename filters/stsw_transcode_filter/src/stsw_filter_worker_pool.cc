@@ -0,0 +1,149 @@
+/**
+ * This file is part of stsw_transcode_filter, which belongs to StreamSwitch
+ * project. 
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_filter_worker_pool.cc
+ *      FilterWorkerPool class implementation file, define its methods
+ *
+ * author: OpenSight Team
+ * date: 2016-4-23
+**/
+
+#include "stsw_filter_worker_pool.h"
+
+#include <stdio.h>
+
+#include <stream_switch.h>
+
+#include "stsw_transcode_stream.h"
+#include "stsw_transcode_filter_global.h"
+#include "stsw_log.h"
+
+
+FilterWorkerPool::FilterWorkerPool()
+:is_started_(false), is_stopping_(false)
+{
+    pthread_mutex_init(&lock_, NULL);
+    pthread_cond_init(&ready_cond_, NULL);
+}
+
+FilterWorkerPool::~FilterWorkerPool()
+{
+    Stop();
+    pthread_cond_destroy(&ready_cond_);
+    pthread_mutex_destroy(&lock_);
+}
+
+int FilterWorkerPool::Start(int worker_num)
+{
+    int ret;
+    int i;
+
+    if(is_started_){
+        return 0;
+    }
+    if(worker_num <= 0 || worker_num > FILTER_MAX_WORKERS){
+        STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                   "The worker number must be in 1 ~ %d\n", FILTER_MAX_WORKERS);
+        return TRANSCODE_FILTER_ERR_GENERAL;
+    }
+
+    is_stopping_ = false;
+    is_started_ = true;
+    for(i = 0; i < worker_num; i++){
+        pthread_t worker;
+        ret = pthread_create(&worker, NULL, StaticWorkerRoutine, this);
+        if(ret){
+            perror("Create filter worker thread failed");
+            Stop();
+            return TRANSCODE_FILTER_ERR_GENERAL;
+        }
+        workers_.push_back(worker);
+    }
+
+    STDERR_LOG(stream_switch::LOG_LEVEL_INFO,
+               "FilterWorkerPool started with %d workers\n", worker_num);
+    return 0;
+}
+
+void FilterWorkerPool::Stop()
+{
+    std::vector<pthread_t>::iterator it;
+
+    if(!is_started_){
+        return;
+    }
+
+    pthread_mutex_lock(&lock_);
+    is_stopping_ = true;
+    pthread_cond_broadcast(&ready_cond_);
+    pthread_mutex_unlock(&lock_);
+
+    for(it = workers_.begin(); it != workers_.end(); it++){
+        pthread_join(*it, NULL);
+    }
+    workers_.clear();
+    ready_streams_.clear();
+    is_started_ = false;
+}
+
+void FilterWorkerPool::Schedule(TranscodeStream * stream)
+{
+    pthread_mutex_lock(&lock_);
+    ready_streams_.push_back(stream);
+    pthread_cond_signal(&ready_cond_);
+    pthread_mutex_unlock(&lock_);
+}
+
+void * FilterWorkerPool::StaticWorkerRoutine(void *arg)
+{
+    FilterWorkerPool * pool = (FilterWorkerPool *)arg;
+    pool->InternalWorkerRoutine();
+    return NULL;
+}
+
+void FilterWorkerPool::InternalWorkerRoutine()
+{
+    TranscodeStream * stream;
+
+    pthread_mutex_lock(&lock_);
+    while(1){
+        while(!is_stopping_ && ready_streams_.empty()){
+            pthread_cond_wait(&ready_cond_, &lock_);
+        }
+        if(is_stopping_){
+            break;
+        }
+        stream = ready_streams_.front();
+        ready_streams_.pop_front();
+        pthread_mutex_unlock(&lock_);
+
+        if(stream->ProcessPendingFrames()){
+            // more frames pending, go back to the tail for fairness
+            Schedule(stream);
+        }
+
+        pthread_mutex_lock(&lock_);
+    }
+    pthread_mutex_unlock(&lock_);
+}
@@ -0,0 +1,87 @@
+/**
+ * This file is part of stsw_transcode_filter, which belongs to StreamSwitch
+ * project. 
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_filter_worker_pool.h
+ *      FilterWorkerPool class header file, define intefaces of the
+ * FilterWorkerPool class.
+ *      FilterWorkerPool runs the filtering of all the streams of the
+ * process on a fixed number of worker threads
+ *
+ * author: OpenSight Team
+ * date: 2016-4-23
+**/
+
+#ifndef STSW_FILTER_WORKER_POOL_H
+#define STSW_FILTER_WORKER_POOL_H
+
+#include <pthread.h>
+#include <list>
+#include <vector>
+
+
+#define FILTER_MAX_WORKERS  64
+
+
+class TranscodeStream;
+typedef std::list<TranscodeStream *> TranscodeStreamList;
+
+// FilterWorkerPool
+//    The receiving thread of each stream just queues the frames and
+// schedules the stream into the ready list, from which the idle workers
+// pick the streams in turn. A stream is in the ready list at most once,
+// so its frames are filtered by only one worker at a time, in order.
+// After a batch of frames, a stream with more pending frames goes back to
+// the tail of the list, so the busy streams cannot starve the others.
+class FilterWorkerPool{
+public:
+    FilterWorkerPool();
+    virtual ~FilterWorkerPool();
+
+    // Start()
+    // start worker_num worker threads
+    virtual int Start(int worker_num);
+
+    // Stop()
+    // stop and join all the workers, the streams must have been stopped
+    // before, since a stream waits for its scheduled work in Stop()
+    virtual void Stop();
+
+    // Schedule()
+    // queue the stream to be processed by a worker, it's the stream's
+    // responsibility not to schedule itself twice
+    virtual void Schedule(TranscodeStream * stream);
+
+protected:
+    static void * StaticWorkerRoutine(void *arg);
+    virtual void InternalWorkerRoutine();
+
+    pthread_mutex_t lock_;
+    pthread_cond_t ready_cond_;
+    TranscodeStreamList ready_streams_;
+    std::vector<pthread_t> workers_;
+    bool is_started_;
+    bool is_stopping_;
+};
+
+#endif
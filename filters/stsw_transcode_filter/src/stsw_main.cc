@@ -0,0 +1,462 @@
+/**
+ * This file is part of stsw_transcode_filter, which belongs to StreamSwitch
+ * project. 
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_main.cc
+ *      stsw_transcode_filter program main entry file
+ *
+ * author: OpenSight Team
+ * date: 2016-4-23
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+
+#include <stream_switch.h>
+
+extern "C"{
+
+#include <libavcodec/avcodec.h>
+
+}
+
+#include "stsw_transcode_stream.h"
+#include "stsw_sub_stream_filter.h"
+#include "stsw_filter_worker_pool.h"
+#include "stsw_transcode_filter_global.h"
+#include "stsw_log.h"
+
+
+///////////////////////////////////////////////////////////////
+//Type
+
+struct TranscodeJob{
+    std::string stream_name;
+    std::string input;
+    int port;
+};
+typedef std::vector<TranscodeJob> TranscodeJobVector;
+
+
+///////////////////////////////////////////////////////////////
+//macro
+
+// the max number of the streams served by one process
+#define TRANSCODE_MAX_STREAMS  256
+
+// a failed stream of the job file is set up again after this interval
+#define TRANSCODE_RETRY_INTERVAL  5     // in sec
+#define TRANSCODE_RETRY_TIMEOUT  1000   // in ms
+
+
+///////////////////////////////////////////////////////////////
+//functions
+
+// ParseJobFile()
+// each line of the job file is "<stream_name> <input> [<port>]", the
+// empty lines and the lines beginning with '#' are ignored
+static int ParseJobFile(const std::string &file_name, TranscodeJobVector *jobs)
+{
+    std::ifstream job_file(file_name.c_str());
+    std::string line;
+    int line_num = 0;
+
+    if(!job_file.is_open()){
+        fprintf(stderr, "Cannot open the job file %s\n", file_name.c_str());
+        return -1;
+    }
+
+    while(std::getline(job_file, line)){
+        std::istringstream line_stream(line);
+        TranscodeJob job;
+        std::string port_str;
+
+        line_num++;
+        if(!(line_stream >> job.stream_name) || job.stream_name[0] == '#'){
+            continue;
+        }
+        if(!(line_stream >> job.input)){
+            fprintf(stderr, "The job file line %d has no input\n", line_num);
+            return -1;
+        }
+        job.port = 0;
+        if(line_stream >> port_str){
+            job.port = (int)strtol(port_str.c_str(), NULL, 0);
+        }
+        jobs->push_back(job);
+    }
+
+    if(jobs->size() == 0){
+        fprintf(stderr, "No job found in %s\n", file_name.c_str());
+        return -1;
+    }else if(jobs->size() > TRANSCODE_MAX_STREAMS){
+        fprintf(stderr, "At most %d jobs for one process\n", TRANSCODE_MAX_STREAMS);
+        return -1;
+    }
+    return 0;
+}
+
+static int DefaultWorkerNum()
+{
+    long cpu_num = sysconf(_SC_NPROCESSORS_ONLN);
+    if(cpu_num <= 0){
+        return 1;
+    }else if(cpu_num > FILTER_MAX_WORKERS){
+        return FILTER_MAX_WORKERS;
+    }
+    return (int)cpu_num;
+}
+
+void ParseArgv(int argc, char *argv[],
+               stream_switch::ArgParser *parser)
+{
+    int ret = 0;
+    std::string err_info;
+    parser->RegisterBasicOptions();
+    parser->RegisterSourceOptions();
+    parser->UnregisterOption("queue-size");
+
+    // with a job file, the streams are not given by -s/-u
+    parser->UnregisterOption("stream-name");
+    parser->UnregisterOption("url");
+    parser->RegisterOption("stream-name", 's', OPTION_FLAG_WITH_ARG,
+                   "STREAM",
+                   "the name of the stream output by this filter, "
+                   "required if no job file is given", NULL, NULL);
+    parser->RegisterOption("url", 'u', OPTION_FLAG_WITH_ARG,
+                   "URL",
+                   "URL is the stsw url (begin with stsw://) of the back-end source to read from, "
+                   "or the name of a local stream. Required if no job file is given", NULL, NULL);
+
+    parser->RegisterOption("jobs", 'j', OPTION_FLAG_WITH_ARG,
+                   "FILE",
+                   "the job file to run many streams in this process, each line "
+                   "of which is \"<stream_name> <input> [<port>]\"", NULL, NULL);
+
+    parser->RegisterOption("acodec", 0, OPTION_FLAG_WITH_ARG,
+                   "CODEC",
+                   "transcode the audio sub streams into this codec, e.g. AAC. "
+                   "Default is not to transcode", NULL, NULL);
+
+    parser->RegisterOption("abitrate", 0, OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG,
+                   "BPS",
+                   "the bitrate of the audio encoder. "
+                   "Default is determined by the encoder", NULL, NULL);
+
+    parser->RegisterOption("annexb", 0, 0, NULL,
+                   "normalize the H264/H265 sub streams into Annex-B with "
+                   "the parameter sets before each key frame", NULL, NULL);
+
+    parser->RegisterOption("workers", 'w', OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG,
+                   "NUM",
+                   "the number of the worker threads filtering the streams. "
+                   "Default is the number of CPUs", NULL, NULL);
+
+    parser->RegisterOption("pub-queue-size", 0, OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG,
+                   "NUM",
+                   "the size of the message queue for Publisher, 0 means no limit."
+                   "Default is an internal value determined when compiling", NULL, NULL);
+
+    parser->RegisterOption("sub-queue-size", 0, OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG,
+                   "NUM",
+                   "the size of the message queue for Subscriber, 0 means no limit."
+                   "Default is an internal value determined when compiling", NULL, NULL);
+
+    parser->RegisterOption("debug-flags", 'd',
+                    OPTION_FLAG_LONG | OPTION_FLAG_WITH_ARG,  "FLAG",
+                    "debug flag for stream_switch core library. "
+                    "Default is 0, means no debug dump" ,
+                    NULL, NULL);
+
+    ret = parser->Parse(argc, argv, &err_info);//parse the cmd args
+    if(ret){
+        fprintf(stderr, "Option Parsing Error:%s\n", err_info.c_str());
+        exit(-1);
+    }
+
+    //check options correct
+
+    if(parser->CheckOption("help")){
+        std::string option_help;
+        option_help = parser->GetOptionsHelp();
+        fprintf(stderr,
+        "A filter which transcodes or repacketizes the sub streams of the live streams once, "
+        "and republishes the results as new streams\n"
+        "Usange: %s [options]\n"
+        "\n"
+        "Option list:\n"
+        "%s"
+        "\n"
+        "User can send SIGINT/SIGTERM signal to terminate this filter\n"
+        "\n", "stsw_transcode_filter", option_help.c_str());
+        exit(0);
+    }else if(parser->CheckOption("version")){
+
+        fprintf(stderr, PACKAGE_VERSION"\n");
+        exit(0);
+    }
+
+    if(!parser->CheckOption("jobs")){
+        if(!parser->CheckOption("stream-name") || !parser->CheckOption("url")){
+            fprintf(stderr, "stream-name and url must be set if no job file is given\n");
+            exit(-1);
+        }
+    }else if(parser->CheckOption("stream-name") || parser->CheckOption("url")){
+        fprintf(stderr, "stream-name and url cannot be set with a job file\n");
+        exit(-1);
+    }
+
+    if(parser->CheckOption("workers")){
+        int workers = (int)strtol(parser->OptionValue("workers", "0").c_str(), NULL, 0);
+        if(workers <= 0 || workers > FILTER_MAX_WORKERS){
+            fprintf(stderr, "workers must be in 1 ~ %d\n", FILTER_MAX_WORKERS);
+            exit(-1);
+        }
+    }
+
+    if(parser->CheckOption("log-file")){
+        if(!parser->CheckOption("log-size")){
+            fprintf(stderr, "log-size must be set if log-file is enabled\n");
+            exit(-1);
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////
+//main entry
+int main(int argc, char *argv[])
+{
+    using namespace stream_switch;
+    int ret = 0;
+    TranscodeJobVector jobs;
+    TranscodeStreamVector streams;
+    std::vector<time_t> retry_times;
+    FilterWorkerPool pool;
+    TranscodeOptions options;
+    bool is_single = false;
+    int pub_queue_size = STSW_PUBLISH_SOCKET_HWM;
+    int sub_queue_size = STSW_SUBSCRIBE_SOCKET_HWM;
+    int worker_num;
+    int debug_flags;
+    int log_level;
+    size_t i;
+
+    GlobalInit();
+
+    //parse the cmd line
+    ArgParser parser;
+    ParseArgv(argc, argv, &parser); // parse the cmd line
+
+    if(parser.CheckOption("jobs")){
+        ret = ParseJobFile(parser.OptionValue("jobs", ""), &jobs);
+        if(ret){
+            goto exit_1;
+        }
+    }else{
+        TranscodeJob job;
+        job.stream_name = parser.OptionValue("stream-name", "");
+        job.input = parser.OptionValue("url", "");
+        job.port = (int)strtol(parser.OptionValue("port", "0").c_str(), NULL, 0);
+        jobs.push_back(job);
+        is_single = true;
+    }
+
+    //
+    // init global logger
+    log_level =
+        strtol(parser.OptionValue("log-level", "6").c_str(), NULL, 0);
+    if(parser.CheckOption(std::string("log-file"))){
+        //init the global logger
+        std::string log_file =
+            parser.OptionValue("log-file", "");
+        int log_size =
+            strtol(parser.OptionValue("log-size", "0").c_str(), NULL, 0);
+        int rotate_num =
+            strtol(parser.OptionValue("log-rotate", "0").c_str(), NULL, 0);
+
+        ret = InitGlobalLogger(log_file, log_size, rotate_num, log_level);
+        if(ret){
+            fprintf(stderr, "Init Logger failed, exit\n");
+            goto exit_1;
+        }
+    }else{
+        SetLogLevel(log_level);
+    }
+
+    /* register all codecs */
+    avcodec_register_all();
+
+    options.audio_codec = parser.OptionValue("acodec", "");
+    options.audio_bitrate =
+        (int)strtol(parser.OptionValue("abitrate", "0").c_str(), NULL, 0);
+    options.annexb = parser.CheckOption("annexb");
+    if(options.audio_codec.size() != 0 &&
+       avcodec_find_encoder((enum AVCodecID)CodecIdFromName(options.audio_codec)) == NULL){
+        STDERR_LOG(LOG_LEVEL_ERR,
+                   "No encoder found for %s, exit\n", options.audio_codec.c_str());
+        ret = -1;
+        goto exit_2;
+    }
+
+    if(parser.CheckOption("pub-queue-size")){
+        pub_queue_size = (int)strtol(parser.OptionValue("pub-queue-size", "60").c_str(), NULL, 0);
+    }
+    if(parser.CheckOption("sub-queue-size")){
+        sub_queue_size = (int)strtol(parser.OptionValue("sub-queue-size", "120").c_str(), NULL, 0);
+    }
+    debug_flags = (int)strtol(parser.OptionValue("debug-flags", "0").c_str(), NULL, 0);
+
+    worker_num = DefaultWorkerNum();
+    if(parser.CheckOption("workers")){
+        worker_num = (int)strtol(parser.OptionValue("workers", "1").c_str(), NULL, 0);
+    }
+    if(worker_num > (int)jobs.size()){
+        worker_num = (int)jobs.size();  // no use for more workers than streams
+    }
+    ret = pool.Start(worker_num);
+    if(ret){
+        goto exit_2;
+    }
+
+    //
+    //init streams
+    for(i = 0; i < jobs.size(); i++){
+        TranscodeStream * stream = new TranscodeStream();
+        streams.push_back(stream);
+        retry_times.push_back(0);
+        ret = stream->Init(jobs[i].input,
+                           jobs[i].stream_name,
+                           jobs[i].port,
+                           sub_queue_size,
+                           pub_queue_size,
+                           options,
+                           &pool,
+                           debug_flags);
+        if(ret){
+            STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                        "Stream %s init error, exit\n", jobs[i].stream_name.c_str());
+            goto exit_3;
+        }
+    }
+
+    //setup metadata and start, for the job file, a failed stream is left
+    // to the retry in the heartbeat loop
+    for(i = 0; i < streams.size(); i++){
+        ret = streams[i]->UpdateStreamMetaData(5000);
+        if(ret == 0){
+            ret = streams[i]->Start();
+        }
+        if(ret){
+            STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                        "Stream %s start error\n", jobs[i].stream_name.c_str());
+            if(is_single){
+                goto exit_3;
+            }
+            retry_times[i] = time(NULL) + TRANSCODE_RETRY_INTERVAL;
+        }
+    }
+    ret = 0;
+
+    //drive the streams heartbeat
+    while(1){
+
+        if(isGlobalInterrupt()){
+            STDERR_LOG(stream_switch::LOG_LEVEL_INFO,
+                      "Receive Terminate Signal, exit\n");
+            ret = 0;
+            break;
+        }
+
+        time_t now = time(NULL);
+        for(i = 0; i < streams.size(); i++){
+            TranscodeStream * stream = streams[i];
+            if(stream->IsStarted()){
+                ret = stream->Hearbeat();
+                if(ret == 0){
+                    continue;
+                }
+                STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                          "Stream %s hearbeat error\n",
+                          stream->stream_name().c_str());
+                if(is_single){
+                    break;
+                }
+                stream->Stop();
+                retry_times[i] = now + TRANSCODE_RETRY_INTERVAL;
+            }else if(!is_single && now >= retry_times[i]){
+                ret = stream->UpdateStreamMetaData(TRANSCODE_RETRY_TIMEOUT);
+                if(ret == 0){
+                    ret = stream->Start();
+                }
+                if(ret){
+                    retry_times[i] = now + TRANSCODE_RETRY_INTERVAL;
+                }else{
+                    STDERR_LOG(stream_switch::LOG_LEVEL_INFO,
+                              "Stream %s restarted\n",
+                              stream->stream_name().c_str());
+                }
+            }
+        }
+        if(is_single && ret){
+            break;
+        }
+        ret = 0;
+
+        {
+            struct timespec req;
+            req.tv_sec = 0;
+            req.tv_nsec = 100000000; //100ms
+            nanosleep(&req, NULL);
+        }
+    }
+
+exit_3:
+    //stop all the streams before the workers, which they wait for
+    for(i = 0; i < streams.size(); i++){
+        streams[i]->Stop();
+    }
+    pool.Stop();
+    for(i = 0; i < streams.size(); i++){
+        streams[i]->Uninit();
+        delete streams[i];
+    }
+    streams.clear();
+
+exit_2:
+    //uninit logger
+    UninitGlobalLogger();
+exit_1:
+
+    //streamswitch library uninit
+    GlobalUninit();
+
+    return ret;
+}
@@ -0,0 +1,165 @@
+/**
+ * This file is part of stsw_transcode_filter, which belongs to StreamSwitch
+ * project. 
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_sub_stream_filter.cc
+ *      SubStreamFilter class implementation file, define its methods
+ *
+ * author: OpenSight Team
+ * date: 2016-4-23
+**/
+
+#include "stsw_sub_stream_filter.h"
+
+#include <strings.h>
+#include <ctype.h>
+
+#include "stsw_transcode_stream.h"
+#include "stsw_annexb_filter.h"
+#include "stsw_audio_transcode_filter.h"
+#include "stsw_log.h"
+
+extern "C"{
+
+#include <libavcodec/avcodec.h>
+
+}
+
+
+SubStreamFilter::SubStreamFilter()
+:stream_(NULL), is_init_(false)
+{
+
+}
+SubStreamFilter::~SubStreamFilter()
+{
+
+}
+
+int SubStreamFilter::Init(TranscodeStream * stream,
+                          const stream_switch::SubStreamMetadata &in_metadata,
+                          const TranscodeOptions &options,
+                          stream_switch::SubStreamMetadata *out_metadata)
+{
+    if(is_init_){
+        return 0;
+    }
+    stream_ = stream;
+    (*out_metadata) = in_metadata;
+    is_init_ = true;
+    return 0;
+}
+
+void SubStreamFilter::Uninit()
+{
+    if(!is_init_){
+        return;
+    }
+    is_init_ = false;
+    stream_ = NULL;
+}
+
+int SubStreamFilter::Filter(const stream_switch::MediaFrameInfo &frame_info,
+                            const char * frame_data,
+                            size_t frame_size)
+{
+    if(!is_init_){
+        return TRANSCODE_FILTER_ERR_GENERAL;
+    }
+    return stream_->SendFrame(frame_info, frame_data, frame_size);
+}
+
+
+/////////////////////////////////////////////////////////////
+//filter factory
+
+struct CodecNameInfo {
+    enum AVCodecID codec_id;
+    const char codec_name[32];
+};
+
+static const CodecNameInfo codec_name_infos[] = {
+   { AV_CODEC_ID_H264, "H264" },
+   { AV_CODEC_ID_H265, "H265" },
+   { AV_CODEC_ID_MPEG4, "MP4V-ES" },
+   { AV_CODEC_ID_AAC, "AAC" },
+   { AV_CODEC_ID_AMR_NB, "AMR" },
+   { AV_CODEC_ID_PCM_MULAW, "PCMU"},
+   { AV_CODEC_ID_PCM_ALAW, "PCMA"},
+   { AV_CODEC_ID_NONE, "NONE"}
+};
+
+
+int CodecIdFromName(const std::string &codec_name)
+{
+    const CodecNameInfo *info = codec_name_infos;
+    while (info->codec_id != AV_CODEC_ID_NONE) {
+        if (strcasecmp(codec_name.c_str(), info->codec_name) == 0){
+            return info->codec_id;
+        }
+        info++;
+    }
+    AVCodec *c = NULL;
+    while ((c = av_codec_next(c))) {
+        if(strcasecmp(codec_name.c_str(),c->name) == 0){
+            return c->id;
+        }
+    }
+    return AV_CODEC_ID_NONE;
+}
+
+std::string CodecNameFromId(int codec_id)
+{
+    const CodecNameInfo *info = codec_name_infos;
+    while (info->codec_id != AV_CODEC_ID_NONE) {
+        if (info->codec_id == codec_id){
+            return std::string(info->codec_name);
+        }
+        info++;
+    }
+    std::string name(avcodec_get_name((enum AVCodecID)codec_id));
+    for(size_t i = 0; i < name.size(); i++){
+        name[i] = toupper(name[i]);
+    }
+    return name;
+}
+
+
+SubStreamFilter * NewSubStreamFilter(const stream_switch::SubStreamMetadata &in_metadata,
+                                     const TranscodeOptions &options)
+{
+    using namespace stream_switch;
+    int codec_id = CodecIdFromName(in_metadata.codec_name);
+
+    if(in_metadata.media_type == SUB_STREAM_MEIDA_TYPE_AUDIO &&
+       options.audio_codec.size() != 0 &&
+       codec_id != CodecIdFromName(options.audio_codec)){
+        return new AudioTranscodeFilter();
+    }else if(in_metadata.media_type == SUB_STREAM_MEIDA_TYPE_VIDEO &&
+             options.annexb &&
+             (codec_id == AV_CODEC_ID_H264 || codec_id == AV_CODEC_ID_H265)){
+        return new AnnexbFilter();
+    }
+
+    return new SubStreamFilter();
+}
@@ -0,0 +1,92 @@
+/**
+ * This file is part of stsw_transcode_filter, which belongs to StreamSwitch
+ * project. 
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_sub_stream_filter.h
+ *      SubStreamFilter class header file, define intefaces of the
+ * SubStreamFilter class.
+ *      SubStreamFilter is the base class of the filters which process the
+ * frames of one sub stream, itself just passes the frames through
+ *
+ * author: OpenSight Team
+ * date: 2016-4-23
+**/
+
+#ifndef STSW_SUB_STREAM_FILTER_H
+#define STSW_SUB_STREAM_FILTER_H
+
+#include <stream_switch.h>
+#include <string>
+
+#include "stsw_transcode_filter_global.h"
+
+
+class TranscodeStream;
+
+///////////////////////////////////////////////////////////////
+//Type
+
+
+class SubStreamFilter{
+
+public:
+    SubStreamFilter();
+    virtual ~SubStreamFilter();
+
+    // Init()
+    // prepare the filter for the input sub stream, and fill out_metadata
+    // with the metadata of the sub stream it outputs
+    virtual int Init(TranscodeStream * stream,
+                     const stream_switch::SubStreamMetadata &in_metadata,
+                     const TranscodeOptions &options,
+                     stream_switch::SubStreamMetadata *out_metadata);
+    virtual void Uninit();
+
+    // Filter()
+    // process one input frame of this sub stream, the output frames (none,
+    // one or more) are sent by the stream's SendFrame() at once
+    virtual int Filter(const stream_switch::MediaFrameInfo &frame_info,
+                       const char * frame_data,
+                       size_t frame_size);
+
+protected:
+    TranscodeStream * stream_;
+    bool is_init_;
+};
+
+// NewSubStreamFilter()
+// create the filter for the given input sub stream according to the
+// options, the pass-through one if it needs no processing
+SubStreamFilter * NewSubStreamFilter(const stream_switch::SubStreamMetadata &in_metadata,
+                                     const TranscodeOptions &options);
+
+// CodecIdFromName()
+// the codec name in the StreamSwitch metadata to the ffmpeg codec id
+int CodecIdFromName(const std::string &codec_name);
+
+// CodecNameFromId()
+// the inverse of CodecIdFromName(), return the StreamSwitch name if it has
+// one, otherwise the ffmpeg codec name in upper case
+std::string CodecNameFromId(int codec_id);
+
+#endif
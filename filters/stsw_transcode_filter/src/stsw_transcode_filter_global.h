@@ -0,0 +1,66 @@
+/**
+ * This file is part of stsw_transcode_filter, which belongs to StreamSwitch
+ * project. 
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_transcode_filter_global.h
+ *      The header file includes some global definitions and declarations
+ * used by other parts of stsw_transcode_filter
+ * 
+ * author: OpenSight Team
+ * date: 2016-4-23
+**/ 
+
+#ifndef STSW_TRANSCODE_FILTER_GLOBAL_H
+#define STSW_TRANSCODE_FILTER_GLOBAL_H
+
+#include <string>
+
+
+enum TranscodeFilterErrCode{    
+    TRANSCODE_FILTER_ERR_OK = 0, 
+    TRANSCODE_FILTER_ERR_GENERAL = -1, // general error
+    TRANSCODE_FILTER_ERR_TIMEOUT = -2, // timout
+    
+    TRANSCODE_FILTER_ERR_NOT_SUPPORT = -67,  // codec not support     
+    TRANSCODE_FILTER_ERR_CODEC = -68,  // encode/decode error             
+    TRANSCODE_FILTER_ERR_INVALID_FRAME = -69,  // malformed input frame
+};
+
+
+// the transcoding options shared by all the streams of one process
+struct TranscodeOptions{
+    std::string audio_codec;  // transcode the audio sub streams into this codec, 
+                              // empty means no audio transcoding
+    int audio_bitrate;        // the bitrate of the audio encoder in bps, 
+                              // 0 means the encoder's default
+    bool annexb;              // normalize the H264/H265 sub streams into Annex-B
+
+    TranscodeOptions()
+    :audio_bitrate(0), annexb(false)
+    {
+    }
+};
+
+    
+
+#endif
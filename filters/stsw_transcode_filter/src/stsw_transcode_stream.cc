@@ -0,0 +1,701 @@
+/**
+ * This file is part of stsw_transcode_filter, which belongs to StreamSwitch
+ * project. 
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_transcode_stream.cc
+ *      the implementation of TranscodeStream class, includes
+ * all the definition of its methods.
+ *
+ * author: OpenSight Team
+ * date: 2016-4-23
+**/
+
+#include "stsw_transcode_stream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sstream>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include "url.h"
+#include "stsw_sub_stream_filter.h"
+#include "stsw_filter_worker_pool.h"
+#include "stsw_log.h"
+
+
+///////////////////////////////////////////////////////////////
+//macro
+
+#define MAX_FRAME_INTERVAL_SEC    10
+#define DEFAULT_TIMEOUT_MSEC     5000
+
+
+///////////////////////////////////////////////////////////////
+//functions
+
+static int GetOutIp4(const char * dest_ip, uint16_t dest_port, char* buffer, size_t buflen)
+{
+    if(dest_ip == NULL || buffer == NULL || buflen < 16){
+        return -1;
+    }
+
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if(sock < 0){
+        perror("GetOutIp4 create socket failed");
+        return -1;
+    }
+
+    struct sockaddr_in serv;
+    memset(&serv, 0, sizeof(serv));
+    serv.sin_family = AF_INET;
+    serv.sin_addr.s_addr = inet_addr(dest_ip);
+    serv.sin_port = htons(dest_port);
+
+    int err = connect(sock, (const sockaddr*) &serv, sizeof(serv));
+    if(err){
+        perror("GetOutIp4 connect failed");
+        close(sock);
+        return -1;
+    }
+
+    sockaddr_in name;
+    socklen_t namelen = sizeof(name);
+    err = getsockname(sock, (sockaddr*) &name, &namelen);
+    if(err){
+        perror("GetOutIp4 getsocknameq failed");
+        close(sock);
+        return -1;
+    }
+
+    const char* p = inet_ntop(AF_INET, &name.sin_addr, buffer, buflen);
+    if(p == NULL){
+        perror("GetOutIp4 inet_ntop failed");
+        close(sock);
+        return -1;
+    }
+
+    close(sock);
+    return 0;
+}
+
+static std::string int2str(int int_value)
+{
+    std::stringstream stream;
+    stream<<int_value;
+    return stream.str();
+}
+
+
+////////////////////////////////////////////////////////////////
+//class implementation
+
+TranscodeStream::TranscodeStream()
+:pool_(NULL), out_ssrc_(0), pending_num_(0), is_scheduled_(false),
+need_key_frame_(false), need_update_metadata_(false),
+last_frame_recv_(0), flags_(0)
+{
+    source_ = new stream_switch::StreamSource();
+    sink_ = new stream_switch::StreamSink();
+}
+TranscodeStream::~TranscodeStream()
+{
+    Uninit();
+
+    delete sink_;
+
+    delete source_;
+}
+
+bool TranscodeStream::IsInit()
+{
+    return (flags_ & TRANSCODE_STREAM_FLAG_INIT) != 0;
+}
+
+bool TranscodeStream::IsStarted()
+{
+    return (flags_ & TRANSCODE_STREAM_FLAG_STARTED) != 0;
+}
+bool TranscodeStream::IsMetaReady()
+{
+    return (flags_ & TRANSCODE_STREAM_FLAG_META_READY) != 0;
+}
+
+
+int TranscodeStream::Init(const std::string &input,
+                          const std::string &stream_name,
+                          int source_tcp_port,
+                          int sub_queue_size,
+                          int pub_queue_size,
+                          const TranscodeOptions &options,
+                          FilterWorkerPool * pool,
+                          int debug_flags)
+{
+    using namespace stream_switch;
+    int ret;
+    std::string err_info;
+    UrlParser url;
+    StreamClientInfo client_info;
+    bool is_remote = false;
+
+    if(input.size() == 0){
+        STDERR_LOG(LOG_LEVEL_ERR, "input cannot be empty\n");
+        return -1;
+    }else if(sub_queue_size == 0 || pub_queue_size == 0){
+        STDERR_LOG(LOG_LEVEL_ERR, "sub_queue_size/pub_queue_size cannot be 0\n");
+        return -1;
+    }else if(pool == NULL){
+        return -1;
+    }
+
+    // the input is either a stsw url of a remote source, or the name of
+    // a local stream
+    if(input.compare(0, 7, "stsw://") == 0){
+        url.Parse(input.c_str());
+        if(url.host_name_.size() == 0){
+            STDERR_LOG(LOG_LEVEL_ERR, "URL invalid: host absent\n");
+            return -1;
+        }
+        if(url.port_ == 0){
+            STDERR_LOG(LOG_LEVEL_ERR, "URL invalid: port must be given\n");
+            return -1;
+        }
+        is_remote = true;
+    }
+
+    if(IsInit()){
+        return -1;
+    }
+
+    if(is_remote){
+        char self_ip[32];
+        if(GetOutIp4(url.host_name_.c_str(), url.port_, self_ip, 32) == 0){
+            //successful get ip
+            client_info.client_ip.assign(self_ip);
+        }
+    }
+    client_info.client_port = source_tcp_port;
+    client_info.client_protocol = "stsw";
+    pid_t pid = getpid() ;
+    client_info.client_token = int2str(pid % 0xffffff);
+    client_info.client_text = "stsw_transcode_filter";
+
+    ret = pthread_mutex_init(&lock_, NULL);
+    if(ret){
+        ret = ERROR_CODE_SYSTEM;
+        perror("pthread_mutex_init failed");
+        goto error_0;
+    }
+    ret = pthread_cond_init(&idle_cond_, NULL);
+    if(ret){
+        ret = ERROR_CODE_SYSTEM;
+        perror("pthread_cond_init failed");
+        goto error_1;
+    }
+
+    if(is_remote){
+        ret = sink_->InitRemote(url.host_name_,
+                                url.port_,
+                                client_info,
+                                sub_queue_size,
+                                this,
+                                debug_flags,
+                                &err_info);
+    }else{
+        ret = sink_->InitLocal(input,
+                               client_info,
+                               sub_queue_size,
+                               this,
+                               debug_flags,
+                               &err_info);
+    }
+    if(ret){
+        STDERR_LOG(LOG_LEVEL_ERR, "Init sink failed: %s\n",
+                   err_info.c_str());
+        goto error_2;
+    }
+
+    ret = source_->Init(stream_name,
+                        source_tcp_port,
+                        pub_queue_size,
+                        this,
+                        debug_flags,
+                        &err_info);
+    if(ret){
+        STDERR_LOG(LOG_LEVEL_ERR, "Init source failed: %s\n",
+                   err_info.c_str());
+        goto error_3;
+    }
+
+    source_->set_stream_state(SOURCE_STREAM_STATE_CONNECTING);
+
+    pool_ = pool;
+    options_ = options;
+    stream_name_ = stream_name;
+    input_ = input;
+    pending_num_ = 0;
+    is_scheduled_ = false;
+
+    flags_ |= TRANSCODE_STREAM_FLAG_INIT;
+
+    STDERR_LOG(stream_switch::LOG_LEVEL_INFO,
+              "TranscodeStream Init successful (input:%s, stream_name:%s)\n",
+              input.c_str(), stream_name.c_str());
+
+    return 0;
+
+error_3:
+    sink_->Uninit();
+
+error_2:
+    pthread_cond_destroy(&idle_cond_);
+
+error_1:
+    pthread_mutex_destroy(&lock_);
+
+error_0:
+    return ret;
+}
+
+void TranscodeStream::Uninit()
+{
+    if(!IsInit()){
+        return;
+    }
+
+    Stop();
+
+    flags_ &= ~(TRANSCODE_STREAM_FLAG_INIT);
+
+    source_->Uninit();
+
+    sink_->Uninit();
+
+    UninitFilters();
+    pending_frames_.clear();
+    free_frames_.clear();
+    pool_ = NULL;
+
+    pthread_cond_destroy(&idle_cond_);
+    pthread_mutex_destroy(&lock_);
+}
+
+
+int TranscodeStream::UpdateStreamMetaData(int timeout)
+{
+    stream_switch::StreamMetadata in_metadata;
+    stream_switch::StreamMetadata out_metadata;
+    int ret;
+    std::string err_info;
+    size_t sub_stream_num;
+    size_t i;
+
+    if(!IsInit()){
+        return -1;
+    }
+    if(IsStarted()){
+        return -1;
+    }
+    ret = sink_->UpdateStreamMetaData(timeout, &in_metadata, &err_info);
+    if(ret){
+        STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                   "Get metadata of %s from back-end source failed: %s\n",
+                   input_.c_str(), err_info.c_str());
+        source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_ERR_CONNECT_FAIL);
+        return ret;
+    }
+
+    if(in_metadata.play_type != stream_switch::STREAM_PLAY_TYPE_LIVE){
+        STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                   "stsw_transcode_filter only support live stream\n");
+        source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_ERR);
+        return -1;
+    }
+
+    flags_ &= ~(TRANSCODE_STREAM_FLAG_META_READY);
+    UninitFilters();
+    ret = InitFilters(in_metadata, &out_metadata);
+    if(ret){
+        source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_ERR);
+        return ret;
+    }
+    out_metadata.source_proto = "STSW";
+    source_->set_stream_meta(out_metadata);
+    out_ssrc_ = out_metadata.ssrc;
+
+    sub_stream_num = out_metadata.sub_streams.size();
+    pthread_mutex_lock(&lock_);
+    waiting_key_.assign(sub_stream_num, false);
+    dropped_frames_.assign(sub_stream_num, 0);
+    key_required_.assign(sub_stream_num, false);
+    for(i = 0; i < sub_stream_num; i++){
+        key_required_[i] = (out_metadata.sub_streams[i].media_type ==
+                            stream_switch::SUB_STREAM_MEIDA_TYPE_VIDEO);
+    }
+    pthread_mutex_unlock(&lock_);
+
+    flags_ |= TRANSCODE_STREAM_FLAG_META_READY;
+
+    STDERR_LOG(stream_switch::LOG_LEVEL_INFO,
+              "TranscodeStream metadata updated (input:%s, stream_name:%s)\n",
+              input_.c_str(), stream_name_.c_str());
+
+    return 0;
+}
+
+
+int TranscodeStream::Start()
+{
+    int ret;
+    std::string err_info;
+
+    if(!IsInit()){
+        return -1;
+    }
+    if(!IsMetaReady()){
+        return -1;
+    }
+
+    if(IsStarted()){
+        return 0;
+    }
+
+    pthread_mutex_lock(&lock_);
+    last_frame_recv_ = time(NULL);
+    waiting_key_.assign(waiting_key_.size(), false);
+    pthread_mutex_unlock(&lock_);
+
+    ret = source_->Start(&err_info);
+    if(ret){
+        STDERR_LOG(stream_switch::LOG_LEVEL_ERR, "Start internal source failed: %s\n",
+                   err_info.c_str());
+        source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_ERR);
+        return ret;
+    }
+
+    ret = sink_->Start(&err_info);
+    if(ret){
+        STDERR_LOG(stream_switch::LOG_LEVEL_ERR, "Start internal sink failed: %s\n",
+                   err_info.c_str());
+        source_->Stop();
+        source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_ERR);
+        return ret;
+    }
+
+    //change source state
+    source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_OK);
+
+    flags_ |= TRANSCODE_STREAM_FLAG_STARTED;
+
+    return 0;
+}
+
+void TranscodeStream::Stop()
+{
+    if(!IsInit()){
+        return;
+    }
+    if(!IsStarted()){
+        return;
+    }
+
+    flags_ &= ~(TRANSCODE_STREAM_FLAG_STARTED);
+
+    // no more frames after the sink stops, then wait for the worker
+    sink_->Stop();
+    FlushPendingFrames();
+    source_->Stop();
+}
+
+int TranscodeStream::Hearbeat()
+{
+    bool need_key_frame;
+    bool need_update_metadata;
+    time_t last_frame_recv;
+    int ret = 0;
+    std::string err_info;
+
+    if(!IsInit()){
+        return -1;
+    }
+    if(!IsStarted()){
+        return -1;
+    }
+
+    //Get and reset the state data
+    pthread_mutex_lock(&lock_);
+    need_key_frame = need_key_frame_;
+    need_key_frame_ = false;
+    need_update_metadata = need_update_metadata_;
+    need_update_metadata_ = false;
+    last_frame_recv = last_frame_recv_;
+    pthread_mutex_unlock(&lock_);
+
+    time_t now = time(NULL);
+
+    if((now - last_frame_recv) >= MAX_FRAME_INTERVAL_SEC){
+        source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_ERR_MEIDA_STOP);
+        STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                   "Stream %s stop receiving media data\n", stream_name_.c_str());
+        return stream_switch::ERROR_CODE_GENERAL;
+    }
+
+    if(need_key_frame){
+        ret = sink_->KeyFrame(DEFAULT_TIMEOUT_MSEC, &err_info);
+        if(ret){
+            source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_ERR);
+            STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                       "Request key frame from back-end source failed:%s\n",
+                       err_info.c_str());
+            return ret;
+        }
+    }
+
+    if(need_update_metadata){
+        Stop();
+        ret = UpdateStreamMetaData(DEFAULT_TIMEOUT_MSEC);
+        if(ret){
+            return ret;
+        }
+        ret = Start();
+        if(ret){
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+int TranscodeStream::SendFrame(const stream_switch::MediaFrameInfo &frame_info,
+                               const char * frame_data,
+                               size_t frame_size)
+{
+    stream_switch::MediaFrameInfo out_frame_info = frame_info;
+    out_frame_info.ssrc = out_ssrc_;
+    return source_->SendLiveMediaFrame(out_frame_info, frame_data, frame_size, NULL);
+}
+
+bool TranscodeStream::ProcessPendingFrames()
+{
+    PendingFrameList work_frames;
+    bool has_more;
+    int i;
+    int ret;
+
+    for(i = 0; i < TRANSCODE_WORK_BATCH; i++){
+        pthread_mutex_lock(&lock_);
+        free_frames_.splice(free_frames_.end(), work_frames);
+        if(pending_frames_.empty()){
+            break;
+        }
+        work_frames.splice(work_frames.end(), pending_frames_,
+                           pending_frames_.begin());
+        pending_num_--;
+        pthread_mutex_unlock(&lock_);
+
+        PendingFrame & frame = work_frames.front();
+        int index = frame.frame_info.sub_stream_index;
+        if(index < 0 || index >= (int)filters_.size() || filters_[index] == NULL){
+            continue;
+        }
+        ret = filters_[index]->Filter(frame.frame_info,
+                                      frame.data.data(), frame.data.size());
+        if(ret){
+            STDERR_LOG(stream_switch::LOG_LEVEL_DEBUG,
+                       "Stream %s failed to filter a frame of sub stream %d: %d\n",
+                       stream_name_.c_str(), index, ret);
+        }
+    }
+    if(i == TRANSCODE_WORK_BATCH){
+        pthread_mutex_lock(&lock_);
+        free_frames_.splice(free_frames_.end(), work_frames);
+    }
+
+    // the lock is held here
+    has_more = !pending_frames_.empty();
+    if(!has_more){
+        is_scheduled_ = false;
+        pthread_cond_broadcast(&idle_cond_);
+    }
+    pthread_mutex_unlock(&lock_);
+
+    return has_more;
+}
+
+
+void TranscodeStream::OnKeyFrame(void)
+{
+    pthread_mutex_lock(&lock_);
+    need_key_frame_ = true;
+    pthread_mutex_unlock(&lock_);
+}
+void TranscodeStream::OnMediaStatistic(stream_switch::MediaStatisticInfo *statistic)
+{
+    //use the default statistic info
+    stream_switch::MediaStatisticInfo  sink_statistic;
+
+    sink_->ReceiverStatistic(&sink_statistic);
+
+    if(statistic->ssrc == sink_statistic.ssrc &&
+       statistic->sub_streams.size() == sink_statistic.sub_streams.size()){
+
+        //set the lost frame, including the ones dropped before filtering
+        stream_switch::SubStreamMediaStatisticVector::iterator ita, itb;
+        size_t i;
+        pthread_mutex_lock(&lock_);
+        for(ita = statistic->sub_streams.begin(),
+            itb = sink_statistic.sub_streams.begin(), i = 0;
+            ita != statistic->sub_streams.end();
+            ita++, itb++, i++){
+            ita->lost_frames = itb->lost_frames;
+            if(i < dropped_frames_.size()){
+                ita->lost_frames += dropped_frames_[i];
+            }
+        }
+        pthread_mutex_unlock(&lock_);
+    }
+}
+
+void TranscodeStream::OnLiveMediaFrame(const stream_switch::MediaFrameInfo &frame_info,
+                                       const char * frame_data,
+                                       size_t frame_size)
+{
+    int index = frame_info.sub_stream_index;
+    bool need_schedule = false;
+
+    pthread_mutex_lock(&lock_);
+    last_frame_recv_ = time(NULL);
+
+    if(index < 0 || index >= (int)waiting_key_.size()){
+        pthread_mutex_unlock(&lock_);
+        return;
+    }
+    if(waiting_key_[index]){
+        if(frame_info.frame_type != stream_switch::MEDIA_FRAME_TYPE_KEY_FRAME){
+            dropped_frames_[index]++;
+            pthread_mutex_unlock(&lock_);
+            return;
+        }
+        waiting_key_[index] = false;
+    }
+    if(pending_num_ >= TRANSCODE_MAX_PENDING_FRAMES){
+        // the workers cannot keep up, drop it, and the following frames of
+        // the video sub stream until the next key frame
+        dropped_frames_[index]++;
+        waiting_key_[index] = key_required_[index];
+        pthread_mutex_unlock(&lock_);
+        return;
+    }
+
+    if(free_frames_.empty()){
+        free_frames_.push_back(PendingFrame());
+    }
+    pending_frames_.splice(pending_frames_.end(), free_frames_,
+                           free_frames_.begin());
+    PendingFrame & frame = pending_frames_.back();
+    frame.frame_info = frame_info;
+    frame.data.assign(frame_data, frame_size);
+    pending_num_++;
+
+    if(!is_scheduled_){
+        is_scheduled_ = true;
+        need_schedule = true;
+    }
+    pthread_mutex_unlock(&lock_);
+
+    if(need_schedule){
+        pool_->Schedule(this);
+    }
+}
+
+void TranscodeStream::OnMetadataMismatch(uint32_t mismatch_ssrc)
+{
+    pthread_mutex_lock(&lock_);
+    need_update_metadata_ = true;
+    pthread_mutex_unlock(&lock_);
+}
+
+
+int TranscodeStream::InitFilters(const stream_switch::StreamMetadata &in_metadata,
+                                 stream_switch::StreamMetadata *out_metadata)
+{
+    using namespace stream_switch;
+    SubStreamMetadataVector::const_iterator it;
+    int ret;
+
+    (*out_metadata) = in_metadata;
+    out_metadata->sub_streams.clear();
+
+    for(it = in_metadata.sub_streams.begin();
+        it != in_metadata.sub_streams.end();
+        it++){
+        SubStreamMetadata out_sub_metadata;
+        SubStreamFilter * filter = NewSubStreamFilter(*it, options_);
+
+        ret = filter->Init(this, *it, options_, &out_sub_metadata);
+        if(ret){
+            // better to relay the sub stream as is than to lose it
+            STDERR_LOG(LOG_LEVEL_WARNING,
+                       "Stream %s cannot filter sub stream %d (%s), pass it through\n",
+                       stream_name_.c_str(), (int)it->sub_stream_index,
+                       it->codec_name.c_str());
+            delete filter;
+            filter = new SubStreamFilter();
+            ret = filter->Init(this, *it, options_, &out_sub_metadata);
+            if(ret){
+                delete filter;
+                UninitFilters();
+                return ret;
+            }
+        }
+        filters_.push_back(filter);
+        out_metadata->sub_streams.push_back(out_sub_metadata);
+    }
+
+    return 0;
+}
+
+void TranscodeStream::UninitFilters()
+{
+    std::vector<SubStreamFilter *>::iterator it;
+    for(it = filters_.begin(); it != filters_.end(); it++){
+        (*it)->Uninit();
+        delete (*it);
+    }
+    filters_.clear();
+}
+
+void TranscodeStream::FlushPendingFrames()
+{
+    pthread_mutex_lock(&lock_);
+    free_frames_.splice(free_frames_.end(), pending_frames_);
+    pending_num_ = 0;
+    while(is_scheduled_){
+        pthread_cond_wait(&idle_cond_, &lock_);
+    }
+    pthread_mutex_unlock(&lock_);
+}
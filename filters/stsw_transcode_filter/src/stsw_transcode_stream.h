@@ -0,0 +1,198 @@
+/**
+ * This file is part of stsw_transcode_filter, which belongs to StreamSwitch
+ * project. 
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_transcode_stream.h
+ *      the header file of TranscodeStream class.
+ *
+ * author: OpenSight Team
+ * date: 2016-4-23
+**/
+
+#ifndef STSW_TRANSCODE_STREAM_H
+#define STSW_TRANSCODE_STREAM_H
+
+#include <stream_switch.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+#include <string>
+#include <list>
+#include <vector>
+
+#include "stsw_transcode_filter_global.h"
+
+
+// the max number of the frames pending for the workers of one stream,
+// over which the incoming frames are dropped
+#define TRANSCODE_MAX_PENDING_FRAMES  256
+
+// the max number of the frames filtered by a worker for one stream at a
+// time, before it turns to the other streams
+#define TRANSCODE_WORK_BATCH  16
+
+
+class SubStreamFilter;
+class FilterWorkerPool;
+
+// the transcode stream class
+//     A transcode stream receives the stream from a source like
+// StreamProxySource, processes its sub streams through the sub stream
+// filters, and republishes the result as a new stream. The frames are
+// copied into the pending queue in the receiving thread, and filtered in
+// the worker pool, so one process can serve many streams on a few
+// threads.
+// Thread safety:
+//     The control methods (Init/Start/Stop/Hearbeat...) must be called
+// in one thread, the others are called internally by the receiving
+// thread and the workers.
+class TranscodeStream
+:public stream_switch::SourceListener, public stream_switch::SinkListener{
+
+public:
+    TranscodeStream();
+    virtual ~TranscodeStream();
+
+    /**
+     * @brief Init this transcode stream
+     *
+     * @param input  The stsw url of the back-end source, or the name of a local stream
+     * @param stream_name  The sting name of the stream output by this source
+     * @param source_tcp_port The tcp port of this stream, 0 means no tcp port
+     * @param sub_queue_size  The max size of the queue for subscriber to the back-end source
+     * @param pub_queue_size  The max size of the queue for the publisher of this source
+     * @param options  The transcoding options
+     * @param pool  The worker pool where the frames are filtered
+     * @param debug_flags  StreamSwitch source debug flags
+     * @return 0 if sucessful, or other code of ErrorCode if failed
+     */
+    virtual int Init(const std::string &input,
+                     const std::string &stream_name,
+                     int source_tcp_port,
+                     int sub_queue_size,
+                     int pub_queue_size,
+                     const TranscodeOptions &options,
+                     FilterWorkerPool * pool,
+                     int debug_flags);
+
+    virtual void Uninit();
+
+    virtual bool IsInit();
+    virtual bool IsStarted();
+    virtual bool IsMetaReady();
+
+    /**
+     * @brief Get the metadata from the backend source, and setup the
+     * filters and the metadata of the output stream by it. The stream
+     * must be stopped.
+     * @param timeout   in milli-second
+     * @return 0 if sucessful, or other code of ErrorCode if failed
+     */
+    virtual int UpdateStreamMetaData(int timeout);
+
+    virtual int Start();
+
+    virtual void Stop();
+
+    virtual int Hearbeat();
+
+    const std::string & stream_name() const { return stream_name_; }
+
+
+    // SendFrame()
+    // send a filtered frame to the output stream, called by the filters
+    virtual int SendFrame(const stream_switch::MediaFrameInfo &frame_info,
+                          const char * frame_data,
+                          size_t frame_size);
+
+    // ProcessPendingFrames()
+    // filter a batch of the pending frames, called by the worker pool.
+    // Return true if there are still frames pending, in which case the
+    // stream keeps scheduled and is to be queued again by the pool.
+    virtual bool ProcessPendingFrames();
+
+
+    ///////////////////////////////////
+    // SourceListener methods
+    virtual void OnKeyFrame(void);
+    virtual void OnMediaStatistic(stream_switch::MediaStatisticInfo *statistic);
+
+
+    ///////////////////////////////////
+    // SinkListener methods
+    virtual void OnLiveMediaFrame(const stream_switch::MediaFrameInfo &frame_info,
+                                  const char * frame_data,
+                                  size_t frame_size);
+    virtual void OnMetadataMismatch(uint32_t mismatch_ssrc);
+
+protected:
+    struct PendingFrame{
+        stream_switch::MediaFrameInfo frame_info;
+        std::string data;
+    };
+    // the list nodes are recycled through free_frames_, so that queuing a
+    // frame is just a splice and a copy into an allocated buffer
+    typedef std::list<PendingFrame> PendingFrameList;
+
+    virtual int InitFilters(const stream_switch::StreamMetadata &in_metadata,
+                            stream_switch::StreamMetadata *out_metadata);
+    virtual void UninitFilters();
+
+    // FlushPendingFrames()
+    // drop the pending frames, and wait for the worker processing this
+    // stream if any
+    virtual void FlushPendingFrames();
+
+    stream_switch::StreamSource * source_;
+    stream_switch::StreamSink * sink_;
+    FilterWorkerPool * pool_;
+    TranscodeOptions options_;
+    std::string stream_name_;
+    std::string input_;
+
+    std::vector<SubStreamFilter *> filters_;
+    uint32_t out_ssrc_;
+
+    pthread_mutex_t lock_;
+    pthread_cond_t idle_cond_;
+    PendingFrameList pending_frames_;
+    PendingFrameList free_frames_;
+    size_t pending_num_;
+    bool is_scheduled_;
+    std::vector<bool> waiting_key_;           // per sub stream, after dropping
+    std::vector<bool> key_required_;          // per sub stream, true for video
+    std::vector<uint64_t> dropped_frames_;    // per sub stream
+
+    bool need_key_frame_;
+    bool need_update_metadata_;
+    time_t last_frame_recv_;
+
+#define TRANSCODE_STREAM_FLAG_INIT 1
+#define TRANSCODE_STREAM_FLAG_STARTED 2
+#define TRANSCODE_STREAM_FLAG_META_READY 4
+    volatile uint32_t flags_;
+};
+
+typedef std::vector<TranscodeStream *> TranscodeStreamVector;
+
+#endif
@@ -33,5 +33,6 @@
 #include <stsw_rotate_logger.h>
 #include <stsw_arg_parser.h>
 #include <stsw_global.h>
+#include <stsw_nal_scanner.h>
 
 #endif
\ No newline at end of file
@@ -264,6 +264,28 @@ struct StreamMetadata{
     uint64_t key_frames;   // the count of the key frames handled
     uint64_t last_gov;           //last gov  
     
+    //about transport, only reported by the sources which know them (e.g. RTP)
+    uint64_t lost_packets;       // the packets never received
+    uint64_t reordered_packets;  // the packets arrived out of order
+    uint64_t late_packets;       // the packets arrived too late to be reordered
+    uint64_t damaged_frames;     // the frames partially received
+    uint32_t jitter;             // the interarrival jitter, in us
+    uint32_t reorder_threshold;  // the reordering threshold in use, in us
+    uint32_t reorder_delay;      // the estimated reordering delay, in us
+    uint32_t reorder_depth;      // the reordering depth, in packets
+    int32_t pts_offset;          // the correction for the remote clock drift, in us
+    int32_t pts_drift;           // the drift rate of the remote clock, in ppm
+    
+    //about pacing, only reported by the sources which pace the frames at their native rate
+    uint64_t paced_frames;           // the frames released at their deadline
+    uint64_t pacing_dropped_frames;  // the frames dropped for lateness
+    uint64_t pacing_late_frames;     // the frames over the max late time
+    uint32_t pacing_mean_error;      // the mean of the release time minus the deadline, in us
+    uint32_t pacing_max_error;       // in us
+    std::vector<uint64_t> pacing_error_histogram; // the frames per error bucket, the bounds are 
+                                                  // 100, 500, 1000, 2000, 5000, 10000, 50000 us
+                                                  // and unbounded
+    
     uint64_t cur_gov;            //current calculating gov, internal used by StreamSource
     uint64_t last_seq;     //the last frame's seq number, internal used by StreamSource
     
@@ -276,6 +298,21 @@ struct StreamMetadata{
         data_frames = 0;
         key_frames = 0;
         last_gov = 0;
+        lost_packets = 0;
+        reordered_packets = 0;
+        late_packets = 0;
+        damaged_frames = 0;
+        jitter = 0;
+        reorder_threshold = 0;
+        reorder_delay = 0;
+        reorder_depth = 0;
+        pts_offset = 0;
+        pts_drift = 0;
+        paced_frames = 0;
+        pacing_dropped_frames = 0;
+        pacing_late_frames = 0;
+        pacing_mean_error = 0;
+        pacing_max_error = 0;
         cur_gov = 0;
         last_seq = 0;
     }
@@ -290,7 +327,34 @@ struct MediaStatisticInfo{
     uint32_t ssrc;
     int64_t timestamp;   //the statistic generation time, in milliseconds
     uint64_t sum_bytes;  //the sum bytes received of all sub streams    
+    
+    //about input, only reported by the sources which read ahead or measure the startup
+    int64_t read_ahead_fill;       // the media time span read ahead, in us
+    uint32_t read_ahead_packets;   // the packets read ahead
+    int64_t read_ahead_capacity;   // in us
+    uint64_t read_ahead_underruns; // the times the publisher found nothing read ahead
+    uint64_t read_packets;         // the packets read from the input
+    int64_t pacing_stretch;        // the timeline shift of pacing for the input stall, in us
+    int64_t open_time;             // from the source start to the input opened, in ms, -1 if not yet
+    int64_t meta_time;             // from the source start to the metadata ready, in ms, -1 if not yet
+    int64_t first_frame_time;      // from the source start to the first frame published, in ms, -1 if not yet
+    
     SubStreamMediaStatisticVector sub_streams;
+    
+    MediaStatisticInfo(){
+        ssrc = 0;
+        timestamp = 0;
+        sum_bytes = 0;
+        read_ahead_fill = 0;
+        read_ahead_packets = 0;
+        read_ahead_capacity = 0;
+        read_ahead_underruns = 0;
+        read_packets = 0;
+        pacing_stretch = 0;
+        open_time = -1;
+        meta_time = -1;
+        first_frame_time = -1;
+    }
 };
        
     
@@ -334,6 +398,22 @@ struct MediaFrameInfo{
     } 
 };
 
+// one segment of a media frame, which is used to send a frame whose data 
+// is not contiguous in memory without assembling it into one buffer first
+struct MediaFrameSegment{
+    const char * data;
+    size_t size;
+
+    MediaFrameSegment()
+    :data(NULL), size(0)
+    {
+    }
+    MediaFrameSegment(const char * seg_data, size_t seg_size)
+    :data(seg_data), size(seg_size)
+    {
+    }
+};
+
 
 enum StreamClientIPVersion {
     STREAM_IP_VERSION_V4 = 0,
@@ -0,0 +1,107 @@
+/**
+ * This file is part of libstreamswtich, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_nal_scanner.h
+ *      Annex-B start code and NAL unit scanner for H264/H265 byte stream,
+ * shared by all the components handling H264/H265.
+ *      These functions have C linkage, so that they can be used by the C
+ * code of the ports as well.
+ *
+ * author: OpenSight Team
+ * date: 2016-3-8
+**/
+
+#ifndef STSW_NAL_SCANNER_H
+#define STSW_NAL_SCANNER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// NAL unit found in an Annex-B byte stream
+typedef struct StswNalUnit{
+    const uint8_t *start;  // begin of the start code (including the zero
+                           // bytes ahead of it), equal to data if the NAL
+                           // has no start code
+    const uint8_t *data;   // the first byte of the NAL header
+    size_t size;           // size of the NAL, excluding the start code and
+                           // the trailing zero bytes
+    uint8_t type;          // nal_unit_type, 0xff if unknown
+} StswNalUnit;
+
+
+// stsw_find_start_code()
+// Find the first 3-byte start code (00 00 01) in the given range.
+// A SIMD kernel (AVX2 / SSE2) is selected at runtime if the CPU supports it,
+// otherwise a scalar one is used
+//
+// Params:
+//        start - begin of the range to search
+//        end - end of the range to search
+// Return:
+//        the pointer to the first zero byte of the found start code, or end
+//        if not found. If the start code is a 4-byte one (00 00 00 01), the
+//        pointer is the one after its first zero byte
+const uint8_t *stsw_find_start_code(const uint8_t *start, const uint8_t *end);
+
+// stsw_next_nal_unit()
+// Get the next NAL unit from an Annex-B byte stream, the bytes before the
+// first start code (if not all zero) are considered as a NAL without start
+// code, so that a single NAL without start code can be handled as well.
+//
+// Params:
+//        pos - in/out, the position to search from, it should be initialized
+//              with the begin of the byte stream and would be updated to
+//              the end of the returned NAL unit
+//        end - end of the byte stream
+//        h_number - 264 or 265 to get the nal_unit_type for H264 or H265,
+//                   other value leave the type unknown (0xff)
+//        nal - output, the NAL unit found
+// Return:
+//        1 if a NAL unit is found, 0 if no more NAL unit in the stream
+int stsw_next_nal_unit(const uint8_t **pos, const uint8_t *end,
+                       int h_number, StswNalUnit *nal);
+
+// stsw_nal_scanner_kernel()
+// Get the name of the scanner kernel selected for this CPU
+// Return:
+//        "avx2", "sse2" or "scalar"
+const char *stsw_nal_scanner_kernel(void);
+
+// stsw_nal_scanner_select_kernel()
+// Override the kernel selected for this CPU, for testing and benchmark
+// only. It's not thread-safe, so call it before any scanning
+// Params:
+//        name - "avx2", "sse2" or "scalar"
+// Return:
+//        0 if successful, -1 if the kernel is not supported by this CPU
+int stsw_nal_scanner_select_kernel(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
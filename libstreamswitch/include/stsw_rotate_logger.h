@@ -40,6 +40,11 @@
 
 namespace stream_switch {
 
+// the default number of records in the ring of the asynchronous mode
+#define ROTATE_LOGGER_DEFAULT_RING_SIZE  4096
+
+struct AsyncLogRecord;
+
 // the Rotate logger class
 //     A  Rotate logger is used to log the output message to a specified on-disk file with rotate function. 
 // When the log file reach the specified size, it would be automatic rotates and keep the fix number rotate 
@@ -49,6 +54,16 @@ namespace stream_switch {
 //     most of methods(excepts for init/uninit) are thread safe, which means
 // multi threads can invoke its methods on the same instance of this class 
 // simultaneously without additional lock mechanism
+// Asynchronous mode: 
+//     After StartAsync(), Log() only formats the message into a slot of a 
+// lock-free ring on the caller's thread, and a background thread writes 
+// the records to the file and rotates it. The caller never blocks, if the 
+// ring is full the record is dropped and counted. The records still in 
+// the ring are lost if the process crashes. A slot claimed but not 
+// published in time (e.g. the caller thread is cancelled) is skipped and 
+// counted as dropped as well. A child process forked in the asynchronous 
+// mode has no write thread, so it is switched back to the synchronous 
+// mode by the fork handler
 // Note: 
 //     Only work for linux filesystem
 
@@ -67,6 +82,26 @@ public:
     //flag check methods
     virtual bool IsInit();
     
+    // IsLevelEnabled()
+    // check it before preparing any argument of a log record, it's cheap 
+    // enough to be called on the hot path
+    bool IsLevelEnabled(int level);
+    
+    // StartAsync()
+    // switch to the asynchronous mode, ring_size (rounded up to power of 2) 
+    // is the number of the records buffered. Should be called after Init()
+    virtual int StartAsync(int ring_size);
+    
+    // StopAsync()
+    // write all the buffered records and switch back to the synchronous 
+    // mode. Uninit() invokes it as well
+    virtual void StopAsync();
+    
+    virtual bool IsAsync();
+    
+    // the number of the records dropped for the full ring
+    virtual uint64_t dropped_records();
+    
     //accessors
     virtual void set_log_level(int log_level);
     virtual int log_level();
@@ -86,6 +121,33 @@ protected:
     virtual bool CheckFork();
     virtual void CheckRotateInternal();
     
+    virtual void LogAsync(int level, const char * filename, int line, 
+                          const char * fmt, va_list args);
+    
+    static void * StaticWriteThreadRoutine(void *arg);
+    virtual void InternalWriteRoutine();
+    
+    // WriteRing()
+    // write all the records published in the ring, return the number of 
+    // them. A claimed slot not published in claim_timeout (in ms) is 
+    // skipped, 0 means skipping it at once
+    virtual int WriteRing(int64_t claim_timeout);
+    virtual bool IsClaimStalled(int64_t claim_timeout);
+    
+    // BatchLimit()
+    // the max size of the next batch written by the write thread, which is 
+    // no more than the room left in the log file, so that the file is 
+    // rotated at about the same size as in the synchronous mode
+    virtual size_t BatchLimit();
+    
+    // the fork handlers, which keep the loggers in the asynchronous mode 
+    // locked during fork(), and reset them in the child
+    static void InstallAtFork();
+    static void AtForkPrepare();
+    static void AtForkParent();
+    static void AtForkChild();
+    virtual void ResetAsyncInChild();
+    
 private:
     std::string prog_name_;
     std::string base_name_;
@@ -104,6 +166,30 @@ private:
     volatile uint32_t flags_;   
 
     pid_t pid_;
+    
+    // the bounded multi-producer / single-consumer ring of the asynchronous 
+    // mode, each slot has a sequence number to tell whether it's free or 
+    // published, so that the producers only contend on enqueue_pos_. 
+    // enqueue_pos_, dropped_, write_running_ and async_writers_ are shared 
+    // by the callers and the write thread, they are only accessed by the 
+    // __atomic builtins. dequeue_pos_ is only used by the write thread, or 
+    // by StopAsync() after the write thread is joined
+    AsyncLogRecord * ring_;
+    uint64_t ring_mask_;
+    uint64_t enqueue_pos_;
+    uint64_t dequeue_pos_;
+    uint64_t dropped_;
+    uint64_t reported_dropped_;
+    pthread_t write_thread_id_;
+    bool write_running_;
+    
+    // the number of the callers inside LogAsync(), the ring is only freed 
+    // when none is left
+    uint32_t async_writers_;
+    
+    // the claimed slot the write thread is waiting for, and since when (in ms)
+    uint64_t stall_pos_;
+    int64_t stall_since_;
 
 };
 
@@ -113,12 +199,18 @@ inline bool RotateLogger::IsInit()
 }  
 
 
+inline bool RotateLogger::IsLevelEnabled(int level)
+{
+    return level <= log_level_;        
+}  
+
+
 }
 
 
 #define ROTATE_LOG(logger, level, fmt, ...)  \
 do {         \
-    if(logger){                  \
+    if(logger && (logger)->IsLevelEnabled(level)){                  \
         logger->Log(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__);   \
     }                            \
 }while(0)
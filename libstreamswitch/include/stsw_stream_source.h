@@ -125,6 +125,20 @@ public:
                                     const char * frame_data, 
                                     size_t frame_size, 
                                     std::string *err_info);
+
+    // send out a live media frame in scatter-gather way
+    // the same as SendLiveMediaFrame(), except that the frame data is 
+    // made up of the given segments in order, which are copied into the 
+    // outgoing message directly.
+    // Args:
+    //     media_frame MediaFrameInfo in : info of the media frame to send
+    //     segments : the segment array of the frame data
+    //     segment_num : the number of the segments in the array
+    //     err_info string out: the error info if failed
+    virtual int SendLiveMediaFrameV(const MediaFrameInfo &frame_info, 
+                                    const MediaFrameSegment * segments, 
+                                    int segment_num, 
+                                    std::string *err_info);
     
 
     
@@ -199,6 +213,10 @@ protected:
     // The caller must get the internal lock before invoke this method
     virtual void SendPublishMsg(char * channel_name, const ProtoCommonPacket &msg, 
                                 const char * extra_blob, size_t blob_size);
+    // the same as SendPublishMsg(), but the blob is made up of the segments
+    virtual void SendPublishMsgV(char * channel_name, const ProtoCommonPacket &msg, 
+                                 const MediaFrameSegment * segments, 
+                                 int segment_num);
     
     
     pthread_mutex_t& lock(){
@@ -0,0 +1,365 @@
+/**
+ * This file is part of libstreamswtich, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * nal_scanner_test.cc
+ *      a sample to test the NAL scanner: the fuzz mode compares every
+ * kernel supported by this CPU with a byte-by-byte reference on random
+ * byte streams, and the benchmark mode measures the scan throughput of
+ * each kernel
+ *
+ * author: OpenSight Team
+ * date: 2016-3-8
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include <stream_switch.h>
+
+
+
+///////////////////////////////////////////////////////////////
+//macro
+
+#define FUZZ_MAX_BUF_SIZE 4096
+#define BENCH_NAL_SIZE 1400  // a RTP payload sized slice
+
+///////////////////////////////////////////////////////////////
+//global variables
+
+static const char * kernels[] = {"scalar", "sse2", "avx2", NULL};
+
+
+///////////////////////////////////////////////////////////////
+//functions
+
+static long long MonotonicNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// the obvious byte-by-byte version of stsw_find_start_code()
+static const uint8_t *RefFindStartCode(const uint8_t *p, const uint8_t *end)
+{
+    for(; p + 2 < end; p++){
+        if(p[0] == 0 && p[1] == 0 && p[2] == 1){
+            return p;
+        }
+    }
+    return end;
+}
+
+// the obvious version of splitting the byte stream by stsw_next_nal_unit()
+static void RefSplitNalUnits(const uint8_t *buf, size_t size, int h_number,
+                             std::vector<StswNalUnit> *nals)
+{
+    const uint8_t *end = buf + size;
+    const uint8_t *prefix = buf;
+    const uint8_t *data = buf;
+
+    nals->clear();
+    while(data < end){
+        const uint8_t *next = RefFindStartCode(data, end);
+        const uint8_t *nal_end = next;
+        while(nal_end > data && nal_end[-1] == 0){
+            nal_end--;
+        }
+        if(nal_end > data){
+            StswNalUnit nal;
+            nal.start = prefix;
+            nal.data = data;
+            nal.size = nal_end - data;
+            if(h_number == 264){
+                nal.type = data[0] & 0x1f;
+            }else if(h_number == 265 && nal.size >= 2){
+                nal.type = (data[0] & 0x7e) >> 1;
+            }else{
+                nal.type = 0xff;
+            }
+            nals->push_back(nal);
+            prefix = nal_end;
+        }
+        if(next >= end){
+            break;
+        }
+        data = next + 3;
+    }
+}
+
+// random byte stream, biased to zeros and start codes so that the corner
+// cases (start codes at the buffer edges, 4-byte start codes, trailing
+// zeros, empty NAL) are hit often
+static void FillFuzzBuffer(uint8_t *buf, size_t size, unsigned int *seed)
+{
+    size_t i = 0;
+    while(i < size){
+        int r = rand_r(seed) % 16;
+        if(r == 0 && i + 3 <= size){
+            buf[i++] = 0; buf[i++] = 0; buf[i++] = 1;
+        }else if(r == 1 && i + 4 <= size){
+            buf[i++] = 0; buf[i++] = 0; buf[i++] = 0; buf[i++] = 1;
+        }else if(r < 6){
+            buf[i++] = 0;
+        }else if(r < 8){
+            buf[i++] = 1;
+        }else{
+            buf[i++] = (uint8_t)rand_r(seed);
+        }
+    }
+}
+
+static int FuzzKernel(const char *kernel, int rounds, unsigned int seed)
+{
+    std::vector<uint8_t> storage(FUZZ_MAX_BUF_SIZE + 64);
+    std::vector<StswNalUnit> ref_nals;
+    int h_numbers[] = {264, 265, 0};
+
+    for(int round = 0; round < rounds; round++){
+        size_t size = rand_r(&seed) % FUZZ_MAX_BUF_SIZE;
+        // misalign the buffer for the unaligned loads
+        uint8_t *buf = &storage[rand_r(&seed) % 64];
+        const uint8_t *end = buf + size;
+        int h_number = h_numbers[rand_r(&seed) % 3];
+        const uint8_t *pos;
+        StswNalUnit nal;
+        size_t i;
+
+        FillFuzzBuffer(buf, size, &seed);
+
+        for(pos = buf; pos <= end; pos++){
+            const uint8_t *found = stsw_find_start_code(pos, end);
+            const uint8_t *expected = RefFindStartCode(pos, end);
+            if(found != expected){
+                fprintf(stderr, "%s: round %d, size %d, start code from %d "
+                        "found at %d, expected %d\n", kernel, round, (int)size,
+                        (int)(pos - buf), (int)(found - buf),
+                        (int)(expected - buf));
+                return -1;
+            }
+        }
+
+        RefSplitNalUnits(buf, size, h_number, &ref_nals);
+        pos = buf;
+        for(i = 0; stsw_next_nal_unit(&pos, end, h_number, &nal); i++){
+            if(i >= ref_nals.size() ||
+               nal.start != ref_nals[i].start ||
+               nal.data != ref_nals[i].data ||
+               nal.size != ref_nals[i].size ||
+               nal.type != ref_nals[i].type){
+                fprintf(stderr, "%s: round %d, size %d, NAL %d mismatch\n",
+                        kernel, round, (int)size, (int)i);
+                return -1;
+            }
+        }
+        if(i != ref_nals.size()){
+            fprintf(stderr, "%s: round %d, size %d, %d NALs found, expected %d\n",
+                    kernel, round, (int)size, (int)i, (int)ref_nals.size());
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+// an Annex-B H264 stream of BENCH_NAL_SIZE slices, whose payload has no
+// start code as the emulation prevention guarantees
+static void FillBenchBuffer(uint8_t *buf, size_t size)
+{
+    unsigned int seed = 1;
+    size_t i;
+
+    for(i = 0; i < size; i++){
+        if(i % BENCH_NAL_SIZE == 0 && i + 5 <= size){
+            buf[i++] = 0; buf[i++] = 0; buf[i++] = 0; buf[i++] = 1;
+            buf[i] = 0x41;
+        }else{
+            buf[i] = (uint8_t)rand_r(&seed);
+            if(i >= 2 && buf[i - 2] == 0 && buf[i - 1] == 0 && buf[i] <= 3){
+                buf[i] = 0x5a;
+            }
+        }
+    }
+}
+
+static void BenchKernel(const char *kernel, const uint8_t *buf, size_t size,
+                        int repeat)
+{
+    long long start, elapsed;
+    size_t nal_num = 0;
+    StswNalUnit nal;
+
+    start = MonotonicNs();
+    for(int i = 0; i < repeat; i++){
+        const uint8_t *pos = buf;
+        while(stsw_next_nal_unit(&pos, buf + size, 264, &nal)){
+            nal_num++;
+        }
+    }
+    elapsed = MonotonicNs() - start;
+
+    fprintf(stderr, "%-8s %8.1f MB/s  (%d x %d bytes, %lu NALs, %lld us)\n",
+            kernel,
+            (elapsed > 0) ? (double)size * repeat * 1000.0 / elapsed : 0.0,
+            repeat, (int)size, (unsigned long)nal_num, elapsed / 1000);
+}
+
+static void BenchReference(const uint8_t *buf, size_t size, int repeat)
+{
+    std::vector<StswNalUnit> nals;
+    long long start, elapsed;
+    size_t nal_num = 0;
+
+    start = MonotonicNs();
+    for(int i = 0; i < repeat; i++){
+        RefSplitNalUnits(buf, size, 264, &nals);
+        nal_num += nals.size();
+    }
+    elapsed = MonotonicNs() - start;
+
+    fprintf(stderr, "%-8s %8.1f MB/s  (%d x %d bytes, %lu NALs, %lld us)\n",
+            "bytewise",
+            (elapsed > 0) ? (double)size * repeat * 1000.0 / elapsed : 0.0,
+            repeat, (int)size, (unsigned long)nal_num, elapsed / 1000);
+}
+
+
+void ParseArgv(int argc, char *argv[],
+               stream_switch::ArgParser *parser)
+{
+    int ret;
+    std::string err_info;
+    parser->RegisterBasicOptions();
+
+    parser->RegisterOption("fuzz", 'f',
+                   OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG, "ROUNDS",
+                   "fuzz mode: compare each kernel with the byte-by-byte "
+                   "reference on ROUNDS random byte streams", NULL, NULL);
+    parser->RegisterOption("seed", 's',
+                   OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG, "NUM",
+                   "the random seed of the fuzz mode, Default is the current time",
+                   NULL, NULL);
+    parser->RegisterOption("bench", 'b',
+                   OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG, "SIZE",
+                   "benchmark mode: scan a SIZE bytes H264 byte stream "
+                   "with each kernel", NULL, NULL);
+    parser->RegisterOption("repeat", 'R',
+                   OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG, "NUM",
+                   "how many times the byte stream is scanned in the benchmark mode, "
+                   "Default is 100", NULL, NULL);
+
+    ret = parser->Parse(argc, argv, &err_info);//parse the cmd args
+    if(ret){
+        fprintf(stderr, "Option Parsing Error:%s\n", err_info.c_str());
+        exit(-1);
+    }
+
+    //check options correct
+
+    if(parser->CheckOption("help")){
+        std::string option_help;
+        option_help = parser->GetOptionsHelp();
+        fprintf(stderr,
+        "a test sample to fuzz and benchmark the NAL scanner kernels\n"
+        "Usange: %s [options]\n"
+        "\n"
+        "Option list:\n"
+        "%s"
+        "\n"
+        "\n", "nal_scanner_test", option_help.c_str());
+        exit(0);
+    }else if(parser->CheckOption("version")){
+
+        fprintf(stderr, PACKAGE_VERSION"\n");
+        exit(0);
+    }
+
+    if(!parser->CheckOption("fuzz") && !parser->CheckOption("bench")){
+        fprintf(stderr, "fuzz or bench must be given\n");
+        exit(-1);
+    }
+
+}
+
+
+///////////////////////////////////////////////////////////////
+//main entry
+int main(int argc, char *argv[])
+{
+    int ret = 0;
+    stream_switch::ArgParser parser;
+    const char * native_kernel;
+    int i;
+
+    //parse the cmd line
+    ParseArgv(argc, argv, &parser); // parse the cmd line
+
+    native_kernel = stsw_nal_scanner_kernel();
+    fprintf(stderr, "kernel selected for this CPU: %s\n", native_kernel);
+
+    if(parser.CheckOption("fuzz")){
+        int rounds =
+            strtol(parser.OptionValue("fuzz", "1000").c_str(), NULL, 0);
+        unsigned int seed =
+            strtoul(parser.OptionValue("seed", "0").c_str(), NULL, 0);
+        if(!parser.CheckOption("seed")){
+            seed = (unsigned int)time(NULL);
+        }
+        fprintf(stderr, "fuzz with seed %u\n", seed);
+
+        for(i = 0; kernels[i] != NULL; i++){
+            if(stsw_nal_scanner_select_kernel(kernels[i])){
+                fprintf(stderr, "%s: not supported, skipped\n", kernels[i]);
+                continue;
+            }
+            if(FuzzKernel(kernels[i], rounds, seed)){
+                ret = 1;
+                break;
+            }
+            fprintf(stderr, "%s: %d rounds passed\n", kernels[i], rounds);
+        }
+    }
+
+    if(ret == 0 && parser.CheckOption("bench")){
+        size_t size =
+            strtol(parser.OptionValue("bench", "1048576").c_str(), NULL, 0);
+        int repeat =
+            strtol(parser.OptionValue("repeat", "100").c_str(), NULL, 0);
+        std::vector<uint8_t> buf(size + 1);
+
+        FillBenchBuffer(&buf[0], size);
+        BenchReference(&buf[0], size, repeat);
+        for(i = 0; kernels[i] != NULL; i++){
+            if(stsw_nal_scanner_select_kernel(kernels[i]) == 0){
+                BenchKernel(kernels[i], &buf[0], size, repeat);
+            }
+        }
+    }
+
+    stsw_nal_scanner_select_kernel(native_kernel);
+    return ret;
+}
@@ -32,6 +32,8 @@
 #include <stdlib.h>
 #include <sstream>
 #include <unistd.h>
+#include <pthread.h>
+#include <time.h>
 
 #include <stream_switch.h>
 
@@ -55,12 +57,35 @@
 ///////////////////////////////////////////////////////////////
 //type class
 
-
+struct BenchThreadArg{
+    stream_switch::RotateLogger * logger;
+    const char * record;
+    int repeat;
+    long long elapsed;  // in nanosec
+};
 
 
 ///////////////////////////////////////////////////////////////
 //functions
     
+static long long MonotonicNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void * BenchThreadRoutine(void * arg)
+{
+    BenchThreadArg * bench_arg = (BenchThreadArg *)arg;
+    long long start = MonotonicNs();
+    for(int i = 0; i < bench_arg->repeat; i++){
+        ROTATE_LOG(bench_arg->logger, stream_switch::LOG_LEVEL_INFO, 
+                   "%s (%d)", bench_arg->record, i);
+    }
+    bench_arg->elapsed = MonotonicNs() - start;
+    return NULL;
+}
 
 
 
@@ -89,6 +114,16 @@ void ParseArgv(int argc, char *argv[],
                    "how many times the records to be written to the log file repeatly, "
                    "Default is 0, mean no repeat, only one record would be written" , 
                    NULL, NULL);    
+    parser->RegisterOption("async", 'a', 
+                   OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG, "SIZE", 
+                   "use the asynchronous mode of the logger with a ring of SIZE records", 
+                   NULL, NULL);    
+    parser->RegisterOption("threads", 't', 
+                   OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG, "NUM", 
+                   "benchmark mode: NUM threads write the record repeat times "
+                   "simultaneously without interval, and the average time of a log call "
+                   "is printed" , 
+                   NULL, NULL);    
 
     
     ret = parser->Parse(argc, argv, &err_info);//parse the cmd args
@@ -143,6 +178,7 @@ int main(int argc, char *argv[])
     std::string  record;
     ArgParser parser;
     int repeat = 0;
+    int thread_num = 0;
     
    
     GlobalInit();    
@@ -177,8 +213,44 @@ int main(int argc, char *argv[])
 
     }
         
+    if(parser.CheckOption("async")){
+        int ring_size = 
+            strtol(parser.OptionValue("async", "4096").c_str(), NULL, 0);
+        ret = test_logger->StartAsync(ring_size);
+        if(ret){
+            fprintf(stderr, "Start asynchronous logger failed\n");
+            ret = -1;
+            goto exit_3;
+        }
+    }
+        
     record = parser.non_options()[0];
     repeat = strtol(parser.OptionValue("repeat", "0").c_str(), NULL, 0);   
+    thread_num = strtol(parser.OptionValue("threads", "0").c_str(), NULL, 0);   
+    
+    if(thread_num > 0){
+        std::vector<pthread_t> thread_ids(thread_num);
+        std::vector<BenchThreadArg> bench_args(thread_num);
+        long long total_elapsed = 0;
+        
+        for(int i=0; i<thread_num; i++){
+            bench_args[i].logger = test_logger;
+            bench_args[i].record = record.c_str();
+            bench_args[i].repeat = repeat;
+            bench_args[i].elapsed = 0;
+            pthread_create(&thread_ids[i], NULL, BenchThreadRoutine, &bench_args[i]);
+        }
+        for(int i=0; i<thread_num; i++){
+            pthread_join(thread_ids[i], NULL);
+            total_elapsed += bench_args[i].elapsed;
+        }
+        fprintf(stderr, "%d threads x %d records: %lld ns per log call, "
+                "%llu records dropped\n", 
+                thread_num, repeat, 
+                (repeat > 0) ? total_elapsed / ((long long)thread_num * repeat) : 0LL, 
+                (unsigned long long)test_logger->dropped_records());
+        goto exit_3;
+    }
     
     
     fprintf(stderr, "Write the record to logger: %s\n", record.c_str());
@@ -197,6 +269,7 @@ int main(int argc, char *argv[])
     }
 
 
+exit_3:
     
     test_logger->Uninit();
     
@@ -54,7 +54,7 @@ void protobuf_AssignDesc_pb_5fmedia_5fstatistic_2eproto() {
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(ProtoMediaStatisticReq));
   ProtoSubStreamMediaStatistic_descriptor_ = file->message_type(1);
-  static const int ProtoSubStreamMediaStatistic_offsets_[8] = {
+  static const int ProtoSubStreamMediaStatistic_offsets_[24] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, sub_stream_index_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, media_type_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, data_bytes_),
@@ -63,6 +63,22 @@ void protobuf_AssignDesc_pb_5fmedia_5fstatistic_2eproto() {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, data_frames_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, key_frames_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, last_gov_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, lost_packets_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, reordered_packets_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, late_packets_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, damaged_frames_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, jitter_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, reorder_threshold_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, reorder_delay_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, reorder_depth_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, pts_offset_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, pts_drift_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, paced_frames_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, pacing_dropped_frames_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, pacing_late_frames_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, pacing_mean_error_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, pacing_max_error_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoSubStreamMediaStatistic, pacing_error_histogram_),
   };
   ProtoSubStreamMediaStatistic_reflection_ =
     new ::google::protobuf::internal::GeneratedMessageReflection(
@@ -76,10 +92,19 @@ void protobuf_AssignDesc_pb_5fmedia_5fstatistic_2eproto() {
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(ProtoSubStreamMediaStatistic));
   ProtoMediaStatisticRep_descriptor_ = file->message_type(2);
-  static const int ProtoMediaStatisticRep_offsets_[4] = {
+  static const int ProtoMediaStatisticRep_offsets_[13] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoMediaStatisticRep, ssrc_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoMediaStatisticRep, timestamp_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoMediaStatisticRep, sum_bytes_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoMediaStatisticRep, read_ahead_fill_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoMediaStatisticRep, read_ahead_packets_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoMediaStatisticRep, read_ahead_capacity_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoMediaStatisticRep, read_ahead_underruns_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoMediaStatisticRep, read_packets_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoMediaStatisticRep, pacing_stretch_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoMediaStatisticRep, open_time_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoMediaStatisticRep, meta_time_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoMediaStatisticRep, first_frame_time_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ProtoMediaStatisticRep, sub_stream_stats_),
   };
   ProtoMediaStatisticRep_reflection_ =
@@ -134,16 +159,32 @@ void protobuf_AddDesc_pb_5fmedia_5fstatistic_2eproto() {
   ::google::protobuf::DescriptorPool::InternalAddGeneratedFile(
     "\n\030pb_media_statistic.proto\022\rstream_switc"
     "h\032\021pb_metadata.proto\"\030\n\026ProtoMediaStatis"
-    "ticReq\"\353\001\n\034ProtoSubStreamMediaStatistic\022"
+    "ticReq\"\360\004\n\034ProtoSubStreamMediaStatistic\022"
     "\030\n\020sub_stream_index\030\001 \001(\005\022:\n\nmedia_type\030"
     "\002 \001(\0162&.stream_switch.ProtoSubStreamMedi"
     "aType\022\022\n\ndata_bytes\030\024 \001(\004\022\021\n\tkey_bytes\030\025"
     " \001(\004\022\023\n\013lost_frames\030\036 \001(\004\022\023\n\013data_frames"
     "\030\037 \001(\004\022\022\n\nkey_frames\030  \001(\004\022\020\n\010last_gov\030!"
-    " \001(\004\"\223\001\n\026ProtoMediaStatisticRep\022\014\n\004ssrc\030"
-    "\001 \001(\r\022\021\n\ttimestamp\030\002 \001(\003\022\021\n\tsum_bytes\030\003 "
-    "\001(\004\022E\n\020sub_stream_stats\030@ \003(\0132+.stream_s"
-    "witch.ProtoSubStreamMediaStatistic", 474);
+    " \001(\004\022\024\n\014lost_packets\030( \001(\004\022\031\n\021reordered_"
+    "packets\030) \001(\004\022\024\n\014late_packets\030* \001(\004\022\026\n\016d"
+    "amaged_frames\030+ \001(\004\022\016\n\006jitter\030, \001(\r\022\031\n\021r"
+    "eorder_threshold\030- \001(\r\022\025\n\rreorder_delay\030"
+    ". \001(\r\022\025\n\rreorder_depth\030/ \001(\r\022\022\n\npts_offs"
+    "et\0300 \001(\005\022\021\n\tpts_drift\0301 \001(\005\022\024\n\014paced_fra"
+    "mes\0302 \001(\004\022\035\n\025pacing_dropped_frames\0303 \001(\004"
+    "\022\032\n\022pacing_late_frames\0304 \001(\004\022\031\n\021pacing_m"
+    "ean_error\0305 \001(\r\022\030\n\020pacing_max_error\0306 \001("
+    "\r\022\036\n\026pacing_error_histogram\0307 \003(\004\"\375\002\n\026Pr"
+    "otoMediaStatisticRep\022\014\n\004ssrc\030\001 \001(\r\022\021\n\tti"
+    "mestamp\030\002 \001(\003\022\021\n\tsum_bytes\030\003 \001(\004\022\027\n\017read"
+    "_ahead_fill\030\004 \001(\003\022\032\n\022read_ahead_packets\030"
+    "\005 \001(\r\022\033\n\023read_ahead_capacity\030\006 \001(\003\022\034\n\024re"
+    "ad_ahead_underruns\030\007 \001(\004\022\024\n\014read_packets"
+    "\030\010 \001(\004\022\026\n\016pacing_stretch\030\t \001(\003\022\025\n\topen_t"
+    "ime\030\n \001(\003:\002-1\022\025\n\tmeta_time\030\013 \001(\003:\002-1\022\034\n\020"
+    "first_frame_time\030\014 \001(\003:\002-1\022E\n\020sub_stream"
+    "_stats\030@ \003(\0132+.stream_switch.ProtoSubStr"
+    "eamMediaStatistic", 1097);
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(
     "pb_media_statistic.proto", &protobuf_RegisterTypes);
   ProtoMediaStatisticReq::default_instance_ = new ProtoMediaStatisticReq();
@@ -347,6 +388,22 @@ const int ProtoSubStreamMediaStatistic::kLostFramesFieldNumber;
 const int ProtoSubStreamMediaStatistic::kDataFramesFieldNumber;
 const int ProtoSubStreamMediaStatistic::kKeyFramesFieldNumber;
 const int ProtoSubStreamMediaStatistic::kLastGovFieldNumber;
+const int ProtoSubStreamMediaStatistic::kLostPacketsFieldNumber;
+const int ProtoSubStreamMediaStatistic::kReorderedPacketsFieldNumber;
+const int ProtoSubStreamMediaStatistic::kLatePacketsFieldNumber;
+const int ProtoSubStreamMediaStatistic::kDamagedFramesFieldNumber;
+const int ProtoSubStreamMediaStatistic::kJitterFieldNumber;
+const int ProtoSubStreamMediaStatistic::kReorderThresholdFieldNumber;
+const int ProtoSubStreamMediaStatistic::kReorderDelayFieldNumber;
+const int ProtoSubStreamMediaStatistic::kReorderDepthFieldNumber;
+const int ProtoSubStreamMediaStatistic::kPtsOffsetFieldNumber;
+const int ProtoSubStreamMediaStatistic::kPtsDriftFieldNumber;
+const int ProtoSubStreamMediaStatistic::kPacedFramesFieldNumber;
+const int ProtoSubStreamMediaStatistic::kPacingDroppedFramesFieldNumber;
+const int ProtoSubStreamMediaStatistic::kPacingLateFramesFieldNumber;
+const int ProtoSubStreamMediaStatistic::kPacingMeanErrorFieldNumber;
+const int ProtoSubStreamMediaStatistic::kPacingMaxErrorFieldNumber;
+const int ProtoSubStreamMediaStatistic::kPacingErrorHistogramFieldNumber;
 #endif  // !_MSC_VER
 
 ProtoSubStreamMediaStatistic::ProtoSubStreamMediaStatistic()
@@ -375,6 +432,21 @@ void ProtoSubStreamMediaStatistic::SharedCtor() {
   data_frames_ = GOOGLE_ULONGLONG(0);
   key_frames_ = GOOGLE_ULONGLONG(0);
   last_gov_ = GOOGLE_ULONGLONG(0);
+  lost_packets_ = GOOGLE_ULONGLONG(0);
+  reordered_packets_ = GOOGLE_ULONGLONG(0);
+  late_packets_ = GOOGLE_ULONGLONG(0);
+  damaged_frames_ = GOOGLE_ULONGLONG(0);
+  jitter_ = 0u;
+  reorder_threshold_ = 0u;
+  reorder_delay_ = 0u;
+  reorder_depth_ = 0u;
+  pts_offset_ = 0;
+  pts_drift_ = 0;
+  paced_frames_ = GOOGLE_ULONGLONG(0);
+  pacing_dropped_frames_ = GOOGLE_ULONGLONG(0);
+  pacing_late_frames_ = GOOGLE_ULONGLONG(0);
+  pacing_mean_error_ = 0u;
+  pacing_max_error_ = 0u;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -423,10 +495,17 @@ void ProtoSubStreamMediaStatistic::Clear() {
   if (_has_bits_[0 / 32] & 255) {
     ZR_(sub_stream_index_, last_gov_);
   }
+  if (_has_bits_[8 / 32] & 65280) {
+    ZR_(lost_packets_, reorder_depth_);
+  }
+  if (_has_bits_[16 / 32] & 8323072) {
+    ZR_(pts_offset_, pacing_max_error_);
+  }
 
 #undef OFFSET_OF_FIELD_
 #undef ZR_
 
+  pacing_error_histogram_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
   mutable_unknown_fields()->Clear();
 }
@@ -561,6 +640,250 @@ bool ProtoSubStreamMediaStatistic::MergePartialFromCodedStream(
         } else {
           goto handle_unusual;
         }
+        if (input->ExpectTag(320)) goto parse_lost_packets;
+        break;
+      }
+
+      // optional uint64 lost_packets = 40;
+      case 40: {
+        if (tag == 320) {
+         parse_lost_packets:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &lost_packets_)));
+          set_has_lost_packets();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(328)) goto parse_reordered_packets;
+        break;
+      }
+
+      // optional uint64 reordered_packets = 41;
+      case 41: {
+        if (tag == 328) {
+         parse_reordered_packets:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &reordered_packets_)));
+          set_has_reordered_packets();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(336)) goto parse_late_packets;
+        break;
+      }
+
+      // optional uint64 late_packets = 42;
+      case 42: {
+        if (tag == 336) {
+         parse_late_packets:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &late_packets_)));
+          set_has_late_packets();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(344)) goto parse_damaged_frames;
+        break;
+      }
+
+      // optional uint64 damaged_frames = 43;
+      case 43: {
+        if (tag == 344) {
+         parse_damaged_frames:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &damaged_frames_)));
+          set_has_damaged_frames();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(352)) goto parse_jitter;
+        break;
+      }
+
+      // optional uint32 jitter = 44;
+      case 44: {
+        if (tag == 352) {
+         parse_jitter:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &jitter_)));
+          set_has_jitter();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(360)) goto parse_reorder_threshold;
+        break;
+      }
+
+      // optional uint32 reorder_threshold = 45;
+      case 45: {
+        if (tag == 360) {
+         parse_reorder_threshold:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &reorder_threshold_)));
+          set_has_reorder_threshold();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(368)) goto parse_reorder_delay;
+        break;
+      }
+
+      // optional uint32 reorder_delay = 46;
+      case 46: {
+        if (tag == 368) {
+         parse_reorder_delay:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &reorder_delay_)));
+          set_has_reorder_delay();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(376)) goto parse_reorder_depth;
+        break;
+      }
+
+      // optional uint32 reorder_depth = 47;
+      case 47: {
+        if (tag == 376) {
+         parse_reorder_depth:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &reorder_depth_)));
+          set_has_reorder_depth();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(384)) goto parse_pts_offset;
+        break;
+      }
+
+      // optional int32 pts_offset = 48;
+      case 48: {
+        if (tag == 384) {
+         parse_pts_offset:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, &pts_offset_)));
+          set_has_pts_offset();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(392)) goto parse_pts_drift;
+        break;
+      }
+
+      // optional int32 pts_drift = 49;
+      case 49: {
+        if (tag == 392) {
+         parse_pts_drift:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, &pts_drift_)));
+          set_has_pts_drift();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(400)) goto parse_paced_frames;
+        break;
+      }
+
+      // optional uint64 paced_frames = 50;
+      case 50: {
+        if (tag == 400) {
+         parse_paced_frames:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &paced_frames_)));
+          set_has_paced_frames();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(408)) goto parse_pacing_dropped_frames;
+        break;
+      }
+
+      // optional uint64 pacing_dropped_frames = 51;
+      case 51: {
+        if (tag == 408) {
+         parse_pacing_dropped_frames:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &pacing_dropped_frames_)));
+          set_has_pacing_dropped_frames();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(416)) goto parse_pacing_late_frames;
+        break;
+      }
+
+      // optional uint64 pacing_late_frames = 52;
+      case 52: {
+        if (tag == 416) {
+         parse_pacing_late_frames:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &pacing_late_frames_)));
+          set_has_pacing_late_frames();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(424)) goto parse_pacing_mean_error;
+        break;
+      }
+
+      // optional uint32 pacing_mean_error = 53;
+      case 53: {
+        if (tag == 424) {
+         parse_pacing_mean_error:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &pacing_mean_error_)));
+          set_has_pacing_mean_error();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(432)) goto parse_pacing_max_error;
+        break;
+      }
+
+      // optional uint32 pacing_max_error = 54;
+      case 54: {
+        if (tag == 432) {
+         parse_pacing_max_error:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &pacing_max_error_)));
+          set_has_pacing_max_error();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(440)) goto parse_pacing_error_histogram;
+        break;
+      }
+
+      // repeated uint64 pacing_error_histogram = 55;
+      case 55: {
+        if (tag == 440) {
+         parse_pacing_error_histogram:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadRepeatedPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 2, 440, input, this->mutable_pacing_error_histogram())));
+        } else if (tag == 442) {
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPackedPrimitiveNoInline<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, this->mutable_pacing_error_histogram())));
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(440)) goto parse_pacing_error_histogram;
         if (input->ExpectAtEnd()) goto success;
         break;
       }
@@ -631,6 +954,87 @@ void ProtoSubStreamMediaStatistic::SerializeWithCachedSizes(
     ::google::protobuf::internal::WireFormatLite::WriteUInt64(33, this->last_gov(), output);
   }
 
+  // optional uint64 lost_packets = 40;
+  if (has_lost_packets()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(40, this->lost_packets(), output);
+  }
+
+  // optional uint64 reordered_packets = 41;
+  if (has_reordered_packets()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(41, this->reordered_packets(), output);
+  }
+
+  // optional uint64 late_packets = 42;
+  if (has_late_packets()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(42, this->late_packets(), output);
+  }
+
+  // optional uint64 damaged_frames = 43;
+  if (has_damaged_frames()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(43, this->damaged_frames(), output);
+  }
+
+  // optional uint32 jitter = 44;
+  if (has_jitter()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(44, this->jitter(), output);
+  }
+
+  // optional uint32 reorder_threshold = 45;
+  if (has_reorder_threshold()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(45, this->reorder_threshold(), output);
+  }
+
+  // optional uint32 reorder_delay = 46;
+  if (has_reorder_delay()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(46, this->reorder_delay(), output);
+  }
+
+  // optional uint32 reorder_depth = 47;
+  if (has_reorder_depth()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(47, this->reorder_depth(), output);
+  }
+
+  // optional int32 pts_offset = 48;
+  if (has_pts_offset()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt32(48, this->pts_offset(), output);
+  }
+
+  // optional int32 pts_drift = 49;
+  if (has_pts_drift()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt32(49, this->pts_drift(), output);
+  }
+
+  // optional uint64 paced_frames = 50;
+  if (has_paced_frames()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(50, this->paced_frames(), output);
+  }
+
+  // optional uint64 pacing_dropped_frames = 51;
+  if (has_pacing_dropped_frames()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(51, this->pacing_dropped_frames(), output);
+  }
+
+  // optional uint64 pacing_late_frames = 52;
+  if (has_pacing_late_frames()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(52, this->pacing_late_frames(), output);
+  }
+
+  // optional uint32 pacing_mean_error = 53;
+  if (has_pacing_mean_error()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(53, this->pacing_mean_error(), output);
+  }
+
+  // optional uint32 pacing_max_error = 54;
+  if (has_pacing_max_error()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(54, this->pacing_max_error(), output);
+  }
+
+  // repeated uint64 pacing_error_histogram = 55;
+  for (int i = 0; i < this->pacing_error_histogram_size(); i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(
+      55, this->pacing_error_histogram(i), output);
+  }
+
   if (!unknown_fields().empty()) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         unknown_fields(), output);
@@ -682,6 +1086,87 @@ void ProtoSubStreamMediaStatistic::SerializeWithCachedSizes(
     target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(33, this->last_gov(), target);
   }
 
+  // optional uint64 lost_packets = 40;
+  if (has_lost_packets()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(40, this->lost_packets(), target);
+  }
+
+  // optional uint64 reordered_packets = 41;
+  if (has_reordered_packets()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(41, this->reordered_packets(), target);
+  }
+
+  // optional uint64 late_packets = 42;
+  if (has_late_packets()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(42, this->late_packets(), target);
+  }
+
+  // optional uint64 damaged_frames = 43;
+  if (has_damaged_frames()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(43, this->damaged_frames(), target);
+  }
+
+  // optional uint32 jitter = 44;
+  if (has_jitter()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(44, this->jitter(), target);
+  }
+
+  // optional uint32 reorder_threshold = 45;
+  if (has_reorder_threshold()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(45, this->reorder_threshold(), target);
+  }
+
+  // optional uint32 reorder_delay = 46;
+  if (has_reorder_delay()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(46, this->reorder_delay(), target);
+  }
+
+  // optional uint32 reorder_depth = 47;
+  if (has_reorder_depth()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(47, this->reorder_depth(), target);
+  }
+
+  // optional int32 pts_offset = 48;
+  if (has_pts_offset()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(48, this->pts_offset(), target);
+  }
+
+  // optional int32 pts_drift = 49;
+  if (has_pts_drift()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(49, this->pts_drift(), target);
+  }
+
+  // optional uint64 paced_frames = 50;
+  if (has_paced_frames()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(50, this->paced_frames(), target);
+  }
+
+  // optional uint64 pacing_dropped_frames = 51;
+  if (has_pacing_dropped_frames()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(51, this->pacing_dropped_frames(), target);
+  }
+
+  // optional uint64 pacing_late_frames = 52;
+  if (has_pacing_late_frames()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(52, this->pacing_late_frames(), target);
+  }
+
+  // optional uint32 pacing_mean_error = 53;
+  if (has_pacing_mean_error()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(53, this->pacing_mean_error(), target);
+  }
+
+  // optional uint32 pacing_max_error = 54;
+  if (has_pacing_max_error()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(54, this->pacing_max_error(), target);
+  }
+
+  // repeated uint64 pacing_error_histogram = 55;
+  for (int i = 0; i < this->pacing_error_histogram_size(); i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteUInt64ToArray(55, this->pacing_error_histogram(i), target);
+  }
+
   if (!unknown_fields().empty()) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         unknown_fields(), target);
@@ -750,6 +1235,125 @@ int ProtoSubStreamMediaStatistic::ByteSize() const {
     }
 
   }
+  if (_has_bits_[8 / 32] & (0xffu << (8 % 32))) {
+    // optional uint64 lost_packets = 40;
+    if (has_lost_packets()) {
+      total_size += 2 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->lost_packets());
+    }
+
+    // optional uint64 reordered_packets = 41;
+    if (has_reordered_packets()) {
+      total_size += 2 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->reordered_packets());
+    }
+
+    // optional uint64 late_packets = 42;
+    if (has_late_packets()) {
+      total_size += 2 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->late_packets());
+    }
+
+    // optional uint64 damaged_frames = 43;
+    if (has_damaged_frames()) {
+      total_size += 2 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->damaged_frames());
+    }
+
+    // optional uint32 jitter = 44;
+    if (has_jitter()) {
+      total_size += 2 +
+        ::google::protobuf::internal::WireFormatLite::UInt32Size(
+          this->jitter());
+    }
+
+    // optional uint32 reorder_threshold = 45;
+    if (has_reorder_threshold()) {
+      total_size += 2 +
+        ::google::protobuf::internal::WireFormatLite::UInt32Size(
+          this->reorder_threshold());
+    }
+
+    // optional uint32 reorder_delay = 46;
+    if (has_reorder_delay()) {
+      total_size += 2 +
+        ::google::protobuf::internal::WireFormatLite::UInt32Size(
+          this->reorder_delay());
+    }
+
+    // optional uint32 reorder_depth = 47;
+    if (has_reorder_depth()) {
+      total_size += 2 +
+        ::google::protobuf::internal::WireFormatLite::UInt32Size(
+          this->reorder_depth());
+    }
+
+  }
+  if (_has_bits_[16 / 32] & (0xffu << (16 % 32))) {
+    // optional int32 pts_offset = 48;
+    if (has_pts_offset()) {
+      total_size += 2 +
+        ::google::protobuf::internal::WireFormatLite::Int32Size(
+          this->pts_offset());
+    }
+
+    // optional int32 pts_drift = 49;
+    if (has_pts_drift()) {
+      total_size += 2 +
+        ::google::protobuf::internal::WireFormatLite::Int32Size(
+          this->pts_drift());
+    }
+
+    // optional uint64 paced_frames = 50;
+    if (has_paced_frames()) {
+      total_size += 2 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->paced_frames());
+    }
+
+    // optional uint64 pacing_dropped_frames = 51;
+    if (has_pacing_dropped_frames()) {
+      total_size += 2 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->pacing_dropped_frames());
+    }
+
+    // optional uint64 pacing_late_frames = 52;
+    if (has_pacing_late_frames()) {
+      total_size += 2 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->pacing_late_frames());
+    }
+
+    // optional uint32 pacing_mean_error = 53;
+    if (has_pacing_mean_error()) {
+      total_size += 2 +
+        ::google::protobuf::internal::WireFormatLite::UInt32Size(
+          this->pacing_mean_error());
+    }
+
+    // optional uint32 pacing_max_error = 54;
+    if (has_pacing_max_error()) {
+      total_size += 2 +
+        ::google::protobuf::internal::WireFormatLite::UInt32Size(
+          this->pacing_max_error());
+    }
+
+  }
+  // repeated uint64 pacing_error_histogram = 55;
+  {
+    int data_size = 0;
+    for (int i = 0; i < this->pacing_error_histogram_size(); i++) {
+      data_size += ::google::protobuf::internal::WireFormatLite::
+        UInt64Size(this->pacing_error_histogram(i));
+    }
+    total_size += 2 * this->pacing_error_histogram_size() + data_size;
+  }
+
   if (!unknown_fields().empty()) {
     total_size +=
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
@@ -775,6 +1379,7 @@ void ProtoSubStreamMediaStatistic::MergeFrom(const ::google::protobuf::Message&
 
 void ProtoSubStreamMediaStatistic::MergeFrom(const ProtoSubStreamMediaStatistic& from) {
   GOOGLE_CHECK_NE(&from, this);
+  pacing_error_histogram_.MergeFrom(from.pacing_error_histogram_);
   if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
     if (from.has_sub_stream_index()) {
       set_sub_stream_index(from.sub_stream_index());
@@ -801,6 +1406,55 @@ void ProtoSubStreamMediaStatistic::MergeFrom(const ProtoSubStreamMediaStatistic&
       set_last_gov(from.last_gov());
     }
   }
+  if (from._has_bits_[8 / 32] & (0xffu << (8 % 32))) {
+    if (from.has_lost_packets()) {
+      set_lost_packets(from.lost_packets());
+    }
+    if (from.has_reordered_packets()) {
+      set_reordered_packets(from.reordered_packets());
+    }
+    if (from.has_late_packets()) {
+      set_late_packets(from.late_packets());
+    }
+    if (from.has_damaged_frames()) {
+      set_damaged_frames(from.damaged_frames());
+    }
+    if (from.has_jitter()) {
+      set_jitter(from.jitter());
+    }
+    if (from.has_reorder_threshold()) {
+      set_reorder_threshold(from.reorder_threshold());
+    }
+    if (from.has_reorder_delay()) {
+      set_reorder_delay(from.reorder_delay());
+    }
+    if (from.has_reorder_depth()) {
+      set_reorder_depth(from.reorder_depth());
+    }
+  }
+  if (from._has_bits_[16 / 32] & (0xffu << (16 % 32))) {
+    if (from.has_pts_offset()) {
+      set_pts_offset(from.pts_offset());
+    }
+    if (from.has_pts_drift()) {
+      set_pts_drift(from.pts_drift());
+    }
+    if (from.has_paced_frames()) {
+      set_paced_frames(from.paced_frames());
+    }
+    if (from.has_pacing_dropped_frames()) {
+      set_pacing_dropped_frames(from.pacing_dropped_frames());
+    }
+    if (from.has_pacing_late_frames()) {
+      set_pacing_late_frames(from.pacing_late_frames());
+    }
+    if (from.has_pacing_mean_error()) {
+      set_pacing_mean_error(from.pacing_mean_error());
+    }
+    if (from.has_pacing_max_error()) {
+      set_pacing_max_error(from.pacing_max_error());
+    }
+  }
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
 }
 
@@ -831,6 +1485,22 @@ void ProtoSubStreamMediaStatistic::Swap(ProtoSubStreamMediaStatistic* other) {
     std::swap(data_frames_, other->data_frames_);
     std::swap(key_frames_, other->key_frames_);
     std::swap(last_gov_, other->last_gov_);
+    std::swap(lost_packets_, other->lost_packets_);
+    std::swap(reordered_packets_, other->reordered_packets_);
+    std::swap(late_packets_, other->late_packets_);
+    std::swap(damaged_frames_, other->damaged_frames_);
+    std::swap(jitter_, other->jitter_);
+    std::swap(reorder_threshold_, other->reorder_threshold_);
+    std::swap(reorder_delay_, other->reorder_delay_);
+    std::swap(reorder_depth_, other->reorder_depth_);
+    std::swap(pts_offset_, other->pts_offset_);
+    std::swap(pts_drift_, other->pts_drift_);
+    std::swap(paced_frames_, other->paced_frames_);
+    std::swap(pacing_dropped_frames_, other->pacing_dropped_frames_);
+    std::swap(pacing_late_frames_, other->pacing_late_frames_);
+    std::swap(pacing_mean_error_, other->pacing_mean_error_);
+    std::swap(pacing_max_error_, other->pacing_max_error_);
+    pacing_error_histogram_.Swap(&other->pacing_error_histogram_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
@@ -852,6 +1522,15 @@ void ProtoSubStreamMediaStatistic::Swap(ProtoSubStreamMediaStatistic* other) {
 const int ProtoMediaStatisticRep::kSsrcFieldNumber;
 const int ProtoMediaStatisticRep::kTimestampFieldNumber;
 const int ProtoMediaStatisticRep::kSumBytesFieldNumber;
+const int ProtoMediaStatisticRep::kReadAheadFillFieldNumber;
+const int ProtoMediaStatisticRep::kReadAheadPacketsFieldNumber;
+const int ProtoMediaStatisticRep::kReadAheadCapacityFieldNumber;
+const int ProtoMediaStatisticRep::kReadAheadUnderrunsFieldNumber;
+const int ProtoMediaStatisticRep::kReadPacketsFieldNumber;
+const int ProtoMediaStatisticRep::kPacingStretchFieldNumber;
+const int ProtoMediaStatisticRep::kOpenTimeFieldNumber;
+const int ProtoMediaStatisticRep::kMetaTimeFieldNumber;
+const int ProtoMediaStatisticRep::kFirstFrameTimeFieldNumber;
 const int ProtoMediaStatisticRep::kSubStreamStatsFieldNumber;
 #endif  // !_MSC_VER
 
@@ -876,6 +1555,15 @@ void ProtoMediaStatisticRep::SharedCtor() {
   ssrc_ = 0u;
   timestamp_ = GOOGLE_LONGLONG(0);
   sum_bytes_ = GOOGLE_ULONGLONG(0);
+  read_ahead_fill_ = GOOGLE_LONGLONG(0);
+  read_ahead_packets_ = 0u;
+  read_ahead_capacity_ = GOOGLE_LONGLONG(0);
+  read_ahead_underruns_ = GOOGLE_ULONGLONG(0);
+  read_packets_ = GOOGLE_ULONGLONG(0);
+  pacing_stretch_ = GOOGLE_LONGLONG(0);
+  open_time_ = GOOGLE_LONGLONG(-1);
+  meta_time_ = GOOGLE_LONGLONG(-1);
+  first_frame_time_ = GOOGLE_LONGLONG(-1);
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -921,9 +1609,14 @@ void ProtoMediaStatisticRep::Clear() {
     ::memset(&first, 0, n);                                \
   } while (0)
 
-  if (_has_bits_[0 / 32] & 7) {
-    ZR_(timestamp_, sum_bytes_);
-    ssrc_ = 0u;
+  if (_has_bits_[0 / 32] & 255) {
+    ZR_(timestamp_, read_packets_);
+  }
+  if (_has_bits_[8 / 32] & 3840) {
+    pacing_stretch_ = GOOGLE_LONGLONG(0);
+    open_time_ = GOOGLE_LONGLONG(-1);
+    meta_time_ = GOOGLE_LONGLONG(-1);
+    first_frame_time_ = GOOGLE_LONGLONG(-1);
   }
 
 #undef OFFSET_OF_FIELD_
@@ -984,6 +1677,141 @@ bool ProtoMediaStatisticRep::MergePartialFromCodedStream(
         } else {
           goto handle_unusual;
         }
+        if (input->ExpectTag(32)) goto parse_read_ahead_fill;
+        break;
+      }
+
+      // optional int64 read_ahead_fill = 4;
+      case 4: {
+        if (tag == 32) {
+         parse_read_ahead_fill:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int64, ::google::protobuf::internal::WireFormatLite::TYPE_INT64>(
+                 input, &read_ahead_fill_)));
+          set_has_read_ahead_fill();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(40)) goto parse_read_ahead_packets;
+        break;
+      }
+
+      // optional uint32 read_ahead_packets = 5;
+      case 5: {
+        if (tag == 40) {
+         parse_read_ahead_packets:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &read_ahead_packets_)));
+          set_has_read_ahead_packets();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(48)) goto parse_read_ahead_capacity;
+        break;
+      }
+
+      // optional int64 read_ahead_capacity = 6;
+      case 6: {
+        if (tag == 48) {
+         parse_read_ahead_capacity:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int64, ::google::protobuf::internal::WireFormatLite::TYPE_INT64>(
+                 input, &read_ahead_capacity_)));
+          set_has_read_ahead_capacity();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(56)) goto parse_read_ahead_underruns;
+        break;
+      }
+
+      // optional uint64 read_ahead_underruns = 7;
+      case 7: {
+        if (tag == 56) {
+         parse_read_ahead_underruns:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &read_ahead_underruns_)));
+          set_has_read_ahead_underruns();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(64)) goto parse_read_packets;
+        break;
+      }
+
+      // optional uint64 read_packets = 8;
+      case 8: {
+        if (tag == 64) {
+         parse_read_packets:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &read_packets_)));
+          set_has_read_packets();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(72)) goto parse_pacing_stretch;
+        break;
+      }
+
+      // optional int64 pacing_stretch = 9;
+      case 9: {
+        if (tag == 72) {
+         parse_pacing_stretch:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int64, ::google::protobuf::internal::WireFormatLite::TYPE_INT64>(
+                 input, &pacing_stretch_)));
+          set_has_pacing_stretch();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(80)) goto parse_open_time;
+        break;
+      }
+
+      // optional int64 open_time = 10 [default = -1];
+      case 10: {
+        if (tag == 80) {
+         parse_open_time:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int64, ::google::protobuf::internal::WireFormatLite::TYPE_INT64>(
+                 input, &open_time_)));
+          set_has_open_time();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(88)) goto parse_meta_time;
+        break;
+      }
+
+      // optional int64 meta_time = 11 [default = -1];
+      case 11: {
+        if (tag == 88) {
+         parse_meta_time:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int64, ::google::protobuf::internal::WireFormatLite::TYPE_INT64>(
+                 input, &meta_time_)));
+          set_has_meta_time();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(96)) goto parse_first_frame_time;
+        break;
+      }
+
+      // optional int64 first_frame_time = 12 [default = -1];
+      case 12: {
+        if (tag == 96) {
+         parse_first_frame_time:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int64, ::google::protobuf::internal::WireFormatLite::TYPE_INT64>(
+                 input, &first_frame_time_)));
+          set_has_first_frame_time();
+        } else {
+          goto handle_unusual;
+        }
         if (input->ExpectTag(514)) goto parse_sub_stream_stats;
         break;
       }
@@ -1042,6 +1870,51 @@ void ProtoMediaStatisticRep::SerializeWithCachedSizes(
     ::google::protobuf::internal::WireFormatLite::WriteUInt64(3, this->sum_bytes(), output);
   }
 
+  // optional int64 read_ahead_fill = 4;
+  if (has_read_ahead_fill()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt64(4, this->read_ahead_fill(), output);
+  }
+
+  // optional uint32 read_ahead_packets = 5;
+  if (has_read_ahead_packets()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(5, this->read_ahead_packets(), output);
+  }
+
+  // optional int64 read_ahead_capacity = 6;
+  if (has_read_ahead_capacity()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt64(6, this->read_ahead_capacity(), output);
+  }
+
+  // optional uint64 read_ahead_underruns = 7;
+  if (has_read_ahead_underruns()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(7, this->read_ahead_underruns(), output);
+  }
+
+  // optional uint64 read_packets = 8;
+  if (has_read_packets()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(8, this->read_packets(), output);
+  }
+
+  // optional int64 pacing_stretch = 9;
+  if (has_pacing_stretch()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt64(9, this->pacing_stretch(), output);
+  }
+
+  // optional int64 open_time = 10 [default = -1];
+  if (has_open_time()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt64(10, this->open_time(), output);
+  }
+
+  // optional int64 meta_time = 11 [default = -1];
+  if (has_meta_time()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt64(11, this->meta_time(), output);
+  }
+
+  // optional int64 first_frame_time = 12 [default = -1];
+  if (has_first_frame_time()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt64(12, this->first_frame_time(), output);
+  }
+
   // repeated .stream_switch.ProtoSubStreamMediaStatistic sub_stream_stats = 64;
   for (int i = 0; i < this->sub_stream_stats_size(); i++) {
     ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
@@ -1073,6 +1946,51 @@ void ProtoMediaStatisticRep::SerializeWithCachedSizes(
     target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(3, this->sum_bytes(), target);
   }
 
+  // optional int64 read_ahead_fill = 4;
+  if (has_read_ahead_fill()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(4, this->read_ahead_fill(), target);
+  }
+
+  // optional uint32 read_ahead_packets = 5;
+  if (has_read_ahead_packets()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(5, this->read_ahead_packets(), target);
+  }
+
+  // optional int64 read_ahead_capacity = 6;
+  if (has_read_ahead_capacity()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(6, this->read_ahead_capacity(), target);
+  }
+
+  // optional uint64 read_ahead_underruns = 7;
+  if (has_read_ahead_underruns()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(7, this->read_ahead_underruns(), target);
+  }
+
+  // optional uint64 read_packets = 8;
+  if (has_read_packets()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(8, this->read_packets(), target);
+  }
+
+  // optional int64 pacing_stretch = 9;
+  if (has_pacing_stretch()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(9, this->pacing_stretch(), target);
+  }
+
+  // optional int64 open_time = 10 [default = -1];
+  if (has_open_time()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(10, this->open_time(), target);
+  }
+
+  // optional int64 meta_time = 11 [default = -1];
+  if (has_meta_time()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(11, this->meta_time(), target);
+  }
+
+  // optional int64 first_frame_time = 12 [default = -1];
+  if (has_first_frame_time()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(12, this->first_frame_time(), target);
+  }
+
   // repeated .stream_switch.ProtoSubStreamMediaStatistic sub_stream_stats = 64;
   for (int i = 0; i < this->sub_stream_stats_size(); i++) {
     target = ::google::protobuf::internal::WireFormatLite::
@@ -1113,6 +2031,71 @@ int ProtoMediaStatisticRep::ByteSize() const {
           this->sum_bytes());
     }
 
+    // optional int64 read_ahead_fill = 4;
+    if (has_read_ahead_fill()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int64Size(
+          this->read_ahead_fill());
+    }
+
+    // optional uint32 read_ahead_packets = 5;
+    if (has_read_ahead_packets()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt32Size(
+          this->read_ahead_packets());
+    }
+
+    // optional int64 read_ahead_capacity = 6;
+    if (has_read_ahead_capacity()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int64Size(
+          this->read_ahead_capacity());
+    }
+
+    // optional uint64 read_ahead_underruns = 7;
+    if (has_read_ahead_underruns()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->read_ahead_underruns());
+    }
+
+    // optional uint64 read_packets = 8;
+    if (has_read_packets()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->read_packets());
+    }
+
+  }
+  if (_has_bits_[8 / 32] & (0xffu << (8 % 32))) {
+    // optional int64 pacing_stretch = 9;
+    if (has_pacing_stretch()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int64Size(
+          this->pacing_stretch());
+    }
+
+    // optional int64 open_time = 10 [default = -1];
+    if (has_open_time()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int64Size(
+          this->open_time());
+    }
+
+    // optional int64 meta_time = 11 [default = -1];
+    if (has_meta_time()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int64Size(
+          this->meta_time());
+    }
+
+    // optional int64 first_frame_time = 12 [default = -1];
+    if (has_first_frame_time()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int64Size(
+          this->first_frame_time());
+    }
+
   }
   // repeated .stream_switch.ProtoSubStreamMediaStatistic sub_stream_stats = 64;
   total_size += 2 * this->sub_stream_stats_size();
@@ -1158,6 +2141,35 @@ void ProtoMediaStatisticRep::MergeFrom(const ProtoMediaStatisticRep& from) {
     if (from.has_sum_bytes()) {
       set_sum_bytes(from.sum_bytes());
     }
+    if (from.has_read_ahead_fill()) {
+      set_read_ahead_fill(from.read_ahead_fill());
+    }
+    if (from.has_read_ahead_packets()) {
+      set_read_ahead_packets(from.read_ahead_packets());
+    }
+    if (from.has_read_ahead_capacity()) {
+      set_read_ahead_capacity(from.read_ahead_capacity());
+    }
+    if (from.has_read_ahead_underruns()) {
+      set_read_ahead_underruns(from.read_ahead_underruns());
+    }
+    if (from.has_read_packets()) {
+      set_read_packets(from.read_packets());
+    }
+  }
+  if (from._has_bits_[8 / 32] & (0xffu << (8 % 32))) {
+    if (from.has_pacing_stretch()) {
+      set_pacing_stretch(from.pacing_stretch());
+    }
+    if (from.has_open_time()) {
+      set_open_time(from.open_time());
+    }
+    if (from.has_meta_time()) {
+      set_meta_time(from.meta_time());
+    }
+    if (from.has_first_frame_time()) {
+      set_first_frame_time(from.first_frame_time());
+    }
   }
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
 }
@@ -1184,6 +2196,15 @@ void ProtoMediaStatisticRep::Swap(ProtoMediaStatisticRep* other) {
     std::swap(ssrc_, other->ssrc_);
     std::swap(timestamp_, other->timestamp_);
     std::swap(sum_bytes_, other->sum_bytes_);
+    std::swap(read_ahead_fill_, other->read_ahead_fill_);
+    std::swap(read_ahead_packets_, other->read_ahead_packets_);
+    std::swap(read_ahead_capacity_, other->read_ahead_capacity_);
+    std::swap(read_ahead_underruns_, other->read_ahead_underruns_);
+    std::swap(read_packets_, other->read_packets_);
+    std::swap(pacing_stretch_, other->pacing_stretch_);
+    std::swap(open_time_, other->open_time_);
+    std::swap(meta_time_, other->meta_time_);
+    std::swap(first_frame_time_, other->first_frame_time_);
     sub_stream_stats_.Swap(&other->sub_stream_stats_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
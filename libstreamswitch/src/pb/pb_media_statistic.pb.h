@@ -218,6 +218,123 @@ class ProtoSubStreamMediaStatistic : public ::google::protobuf::Message {
   inline ::google::protobuf::uint64 last_gov() const;
   inline void set_last_gov(::google::protobuf::uint64 value);
 
+  // optional uint64 lost_packets = 40;
+  inline bool has_lost_packets() const;
+  inline void clear_lost_packets();
+  static const int kLostPacketsFieldNumber = 40;
+  inline ::google::protobuf::uint64 lost_packets() const;
+  inline void set_lost_packets(::google::protobuf::uint64 value);
+
+  // optional uint64 reordered_packets = 41;
+  inline bool has_reordered_packets() const;
+  inline void clear_reordered_packets();
+  static const int kReorderedPacketsFieldNumber = 41;
+  inline ::google::protobuf::uint64 reordered_packets() const;
+  inline void set_reordered_packets(::google::protobuf::uint64 value);
+
+  // optional uint64 late_packets = 42;
+  inline bool has_late_packets() const;
+  inline void clear_late_packets();
+  static const int kLatePacketsFieldNumber = 42;
+  inline ::google::protobuf::uint64 late_packets() const;
+  inline void set_late_packets(::google::protobuf::uint64 value);
+
+  // optional uint64 damaged_frames = 43;
+  inline bool has_damaged_frames() const;
+  inline void clear_damaged_frames();
+  static const int kDamagedFramesFieldNumber = 43;
+  inline ::google::protobuf::uint64 damaged_frames() const;
+  inline void set_damaged_frames(::google::protobuf::uint64 value);
+
+  // optional uint32 jitter = 44;
+  inline bool has_jitter() const;
+  inline void clear_jitter();
+  static const int kJitterFieldNumber = 44;
+  inline ::google::protobuf::uint32 jitter() const;
+  inline void set_jitter(::google::protobuf::uint32 value);
+
+  // optional uint32 reorder_threshold = 45;
+  inline bool has_reorder_threshold() const;
+  inline void clear_reorder_threshold();
+  static const int kReorderThresholdFieldNumber = 45;
+  inline ::google::protobuf::uint32 reorder_threshold() const;
+  inline void set_reorder_threshold(::google::protobuf::uint32 value);
+
+  // optional uint32 reorder_delay = 46;
+  inline bool has_reorder_delay() const;
+  inline void clear_reorder_delay();
+  static const int kReorderDelayFieldNumber = 46;
+  inline ::google::protobuf::uint32 reorder_delay() const;
+  inline void set_reorder_delay(::google::protobuf::uint32 value);
+
+  // optional uint32 reorder_depth = 47;
+  inline bool has_reorder_depth() const;
+  inline void clear_reorder_depth();
+  static const int kReorderDepthFieldNumber = 47;
+  inline ::google::protobuf::uint32 reorder_depth() const;
+  inline void set_reorder_depth(::google::protobuf::uint32 value);
+
+  // optional int32 pts_offset = 48;
+  inline bool has_pts_offset() const;
+  inline void clear_pts_offset();
+  static const int kPtsOffsetFieldNumber = 48;
+  inline ::google::protobuf::int32 pts_offset() const;
+  inline void set_pts_offset(::google::protobuf::int32 value);
+
+  // optional int32 pts_drift = 49;
+  inline bool has_pts_drift() const;
+  inline void clear_pts_drift();
+  static const int kPtsDriftFieldNumber = 49;
+  inline ::google::protobuf::int32 pts_drift() const;
+  inline void set_pts_drift(::google::protobuf::int32 value);
+
+  // optional uint64 paced_frames = 50;
+  inline bool has_paced_frames() const;
+  inline void clear_paced_frames();
+  static const int kPacedFramesFieldNumber = 50;
+  inline ::google::protobuf::uint64 paced_frames() const;
+  inline void set_paced_frames(::google::protobuf::uint64 value);
+
+  // optional uint64 pacing_dropped_frames = 51;
+  inline bool has_pacing_dropped_frames() const;
+  inline void clear_pacing_dropped_frames();
+  static const int kPacingDroppedFramesFieldNumber = 51;
+  inline ::google::protobuf::uint64 pacing_dropped_frames() const;
+  inline void set_pacing_dropped_frames(::google::protobuf::uint64 value);
+
+  // optional uint64 pacing_late_frames = 52;
+  inline bool has_pacing_late_frames() const;
+  inline void clear_pacing_late_frames();
+  static const int kPacingLateFramesFieldNumber = 52;
+  inline ::google::protobuf::uint64 pacing_late_frames() const;
+  inline void set_pacing_late_frames(::google::protobuf::uint64 value);
+
+  // optional uint32 pacing_mean_error = 53;
+  inline bool has_pacing_mean_error() const;
+  inline void clear_pacing_mean_error();
+  static const int kPacingMeanErrorFieldNumber = 53;
+  inline ::google::protobuf::uint32 pacing_mean_error() const;
+  inline void set_pacing_mean_error(::google::protobuf::uint32 value);
+
+  // optional uint32 pacing_max_error = 54;
+  inline bool has_pacing_max_error() const;
+  inline void clear_pacing_max_error();
+  static const int kPacingMaxErrorFieldNumber = 54;
+  inline ::google::protobuf::uint32 pacing_max_error() const;
+  inline void set_pacing_max_error(::google::protobuf::uint32 value);
+
+  // repeated uint64 pacing_error_histogram = 55;
+  inline int pacing_error_histogram_size() const;
+  inline void clear_pacing_error_histogram();
+  static const int kPacingErrorHistogramFieldNumber = 55;
+  inline ::google::protobuf::uint64 pacing_error_histogram(int index) const;
+  inline void set_pacing_error_histogram(int index, ::google::protobuf::uint64 value);
+  inline void add_pacing_error_histogram(::google::protobuf::uint64 value);
+  inline const ::google::protobuf::RepeatedField< ::google::protobuf::uint64 >&
+      pacing_error_histogram() const;
+  inline ::google::protobuf::RepeatedField< ::google::protobuf::uint64 >*
+      mutable_pacing_error_histogram();
+
   // @@protoc_insertion_point(class_scope:stream_switch.ProtoSubStreamMediaStatistic)
  private:
   inline void set_has_sub_stream_index();
@@ -236,6 +353,36 @@ class ProtoSubStreamMediaStatistic : public ::google::protobuf::Message {
   inline void clear_has_key_frames();
   inline void set_has_last_gov();
   inline void clear_has_last_gov();
+  inline void set_has_lost_packets();
+  inline void clear_has_lost_packets();
+  inline void set_has_reordered_packets();
+  inline void clear_has_reordered_packets();
+  inline void set_has_late_packets();
+  inline void clear_has_late_packets();
+  inline void set_has_damaged_frames();
+  inline void clear_has_damaged_frames();
+  inline void set_has_jitter();
+  inline void clear_has_jitter();
+  inline void set_has_reorder_threshold();
+  inline void clear_has_reorder_threshold();
+  inline void set_has_reorder_delay();
+  inline void clear_has_reorder_delay();
+  inline void set_has_reorder_depth();
+  inline void clear_has_reorder_depth();
+  inline void set_has_pts_offset();
+  inline void clear_has_pts_offset();
+  inline void set_has_pts_drift();
+  inline void clear_has_pts_drift();
+  inline void set_has_paced_frames();
+  inline void clear_has_paced_frames();
+  inline void set_has_pacing_dropped_frames();
+  inline void clear_has_pacing_dropped_frames();
+  inline void set_has_pacing_late_frames();
+  inline void clear_has_pacing_late_frames();
+  inline void set_has_pacing_mean_error();
+  inline void clear_has_pacing_mean_error();
+  inline void set_has_pacing_max_error();
+  inline void clear_has_pacing_max_error();
 
   ::google::protobuf::UnknownFieldSet _unknown_fields_;
 
@@ -249,6 +396,22 @@ class ProtoSubStreamMediaStatistic : public ::google::protobuf::Message {
   ::google::protobuf::uint64 data_frames_;
   ::google::protobuf::uint64 key_frames_;
   ::google::protobuf::uint64 last_gov_;
+  ::google::protobuf::uint64 lost_packets_;
+  ::google::protobuf::uint64 reordered_packets_;
+  ::google::protobuf::uint64 late_packets_;
+  ::google::protobuf::uint64 damaged_frames_;
+  ::google::protobuf::uint32 jitter_;
+  ::google::protobuf::uint32 reorder_threshold_;
+  ::google::protobuf::uint32 reorder_delay_;
+  ::google::protobuf::uint32 reorder_depth_;
+  ::google::protobuf::int32 pts_offset_;
+  ::google::protobuf::int32 pts_drift_;
+  ::google::protobuf::uint64 paced_frames_;
+  ::google::protobuf::uint64 pacing_dropped_frames_;
+  ::google::protobuf::uint64 pacing_late_frames_;
+  ::google::protobuf::uint32 pacing_mean_error_;
+  ::google::protobuf::uint32 pacing_max_error_;
+  ::google::protobuf::RepeatedField< ::google::protobuf::uint64 > pacing_error_histogram_;
   friend void  protobuf_AddDesc_pb_5fmedia_5fstatistic_2eproto();
   friend void protobuf_AssignDesc_pb_5fmedia_5fstatistic_2eproto();
   friend void protobuf_ShutdownFile_pb_5fmedia_5fstatistic_2eproto();
@@ -332,6 +495,69 @@ class ProtoMediaStatisticRep : public ::google::protobuf::Message {
   inline ::google::protobuf::uint64 sum_bytes() const;
   inline void set_sum_bytes(::google::protobuf::uint64 value);
 
+  // optional int64 read_ahead_fill = 4;
+  inline bool has_read_ahead_fill() const;
+  inline void clear_read_ahead_fill();
+  static const int kReadAheadFillFieldNumber = 4;
+  inline ::google::protobuf::int64 read_ahead_fill() const;
+  inline void set_read_ahead_fill(::google::protobuf::int64 value);
+
+  // optional uint32 read_ahead_packets = 5;
+  inline bool has_read_ahead_packets() const;
+  inline void clear_read_ahead_packets();
+  static const int kReadAheadPacketsFieldNumber = 5;
+  inline ::google::protobuf::uint32 read_ahead_packets() const;
+  inline void set_read_ahead_packets(::google::protobuf::uint32 value);
+
+  // optional int64 read_ahead_capacity = 6;
+  inline bool has_read_ahead_capacity() const;
+  inline void clear_read_ahead_capacity();
+  static const int kReadAheadCapacityFieldNumber = 6;
+  inline ::google::protobuf::int64 read_ahead_capacity() const;
+  inline void set_read_ahead_capacity(::google::protobuf::int64 value);
+
+  // optional uint64 read_ahead_underruns = 7;
+  inline bool has_read_ahead_underruns() const;
+  inline void clear_read_ahead_underruns();
+  static const int kReadAheadUnderrunsFieldNumber = 7;
+  inline ::google::protobuf::uint64 read_ahead_underruns() const;
+  inline void set_read_ahead_underruns(::google::protobuf::uint64 value);
+
+  // optional uint64 read_packets = 8;
+  inline bool has_read_packets() const;
+  inline void clear_read_packets();
+  static const int kReadPacketsFieldNumber = 8;
+  inline ::google::protobuf::uint64 read_packets() const;
+  inline void set_read_packets(::google::protobuf::uint64 value);
+
+  // optional int64 pacing_stretch = 9;
+  inline bool has_pacing_stretch() const;
+  inline void clear_pacing_stretch();
+  static const int kPacingStretchFieldNumber = 9;
+  inline ::google::protobuf::int64 pacing_stretch() const;
+  inline void set_pacing_stretch(::google::protobuf::int64 value);
+
+  // optional int64 open_time = 10 [default = -1];
+  inline bool has_open_time() const;
+  inline void clear_open_time();
+  static const int kOpenTimeFieldNumber = 10;
+  inline ::google::protobuf::int64 open_time() const;
+  inline void set_open_time(::google::protobuf::int64 value);
+
+  // optional int64 meta_time = 11 [default = -1];
+  inline bool has_meta_time() const;
+  inline void clear_meta_time();
+  static const int kMetaTimeFieldNumber = 11;
+  inline ::google::protobuf::int64 meta_time() const;
+  inline void set_meta_time(::google::protobuf::int64 value);
+
+  // optional int64 first_frame_time = 12 [default = -1];
+  inline bool has_first_frame_time() const;
+  inline void clear_first_frame_time();
+  static const int kFirstFrameTimeFieldNumber = 12;
+  inline ::google::protobuf::int64 first_frame_time() const;
+  inline void set_first_frame_time(::google::protobuf::int64 value);
+
   // repeated .stream_switch.ProtoSubStreamMediaStatistic sub_stream_stats = 64;
   inline int sub_stream_stats_size() const;
   inline void clear_sub_stream_stats();
@@ -352,6 +578,24 @@ class ProtoMediaStatisticRep : public ::google::protobuf::Message {
   inline void clear_has_timestamp();
   inline void set_has_sum_bytes();
   inline void clear_has_sum_bytes();
+  inline void set_has_read_ahead_fill();
+  inline void clear_has_read_ahead_fill();
+  inline void set_has_read_ahead_packets();
+  inline void clear_has_read_ahead_packets();
+  inline void set_has_read_ahead_capacity();
+  inline void clear_has_read_ahead_capacity();
+  inline void set_has_read_ahead_underruns();
+  inline void clear_has_read_ahead_underruns();
+  inline void set_has_read_packets();
+  inline void clear_has_read_packets();
+  inline void set_has_pacing_stretch();
+  inline void clear_has_pacing_stretch();
+  inline void set_has_open_time();
+  inline void clear_has_open_time();
+  inline void set_has_meta_time();
+  inline void clear_has_meta_time();
+  inline void set_has_first_frame_time();
+  inline void clear_has_first_frame_time();
 
   ::google::protobuf::UnknownFieldSet _unknown_fields_;
 
@@ -359,8 +603,17 @@ class ProtoMediaStatisticRep : public ::google::protobuf::Message {
   mutable int _cached_size_;
   ::google::protobuf::int64 timestamp_;
   ::google::protobuf::uint64 sum_bytes_;
-  ::google::protobuf::RepeatedPtrField< ::stream_switch::ProtoSubStreamMediaStatistic > sub_stream_stats_;
   ::google::protobuf::uint32 ssrc_;
+  ::google::protobuf::uint32 read_ahead_packets_;
+  ::google::protobuf::int64 read_ahead_fill_;
+  ::google::protobuf::int64 read_ahead_capacity_;
+  ::google::protobuf::uint64 read_ahead_underruns_;
+  ::google::protobuf::uint64 read_packets_;
+  ::google::protobuf::int64 pacing_stretch_;
+  ::google::protobuf::int64 open_time_;
+  ::google::protobuf::int64 meta_time_;
+  ::google::protobuf::int64 first_frame_time_;
+  ::google::protobuf::RepeatedPtrField< ::stream_switch::ProtoSubStreamMediaStatistic > sub_stream_stats_;
   friend void  protobuf_AddDesc_pb_5fmedia_5fstatistic_2eproto();
   friend void protobuf_AssignDesc_pb_5fmedia_5fstatistic_2eproto();
   friend void protobuf_ShutdownFile_pb_5fmedia_5fstatistic_2eproto();
@@ -572,6 +825,396 @@ inline void ProtoSubStreamMediaStatistic::set_last_gov(::google::protobuf::uint6
   // @@protoc_insertion_point(field_set:stream_switch.ProtoSubStreamMediaStatistic.last_gov)
 }
 
+// optional uint64 lost_packets = 40;
+inline bool ProtoSubStreamMediaStatistic::has_lost_packets() const {
+  return (_has_bits_[0] & 0x00000100u) != 0;
+}
+inline void ProtoSubStreamMediaStatistic::set_has_lost_packets() {
+  _has_bits_[0] |= 0x00000100u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_has_lost_packets() {
+  _has_bits_[0] &= ~0x00000100u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_lost_packets() {
+  lost_packets_ = GOOGLE_ULONGLONG(0);
+  clear_has_lost_packets();
+}
+inline ::google::protobuf::uint64 ProtoSubStreamMediaStatistic::lost_packets() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoSubStreamMediaStatistic.lost_packets)
+  return lost_packets_;
+}
+inline void ProtoSubStreamMediaStatistic::set_lost_packets(::google::protobuf::uint64 value) {
+  set_has_lost_packets();
+  lost_packets_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoSubStreamMediaStatistic.lost_packets)
+}
+
+// optional uint64 reordered_packets = 41;
+inline bool ProtoSubStreamMediaStatistic::has_reordered_packets() const {
+  return (_has_bits_[0] & 0x00000200u) != 0;
+}
+inline void ProtoSubStreamMediaStatistic::set_has_reordered_packets() {
+  _has_bits_[0] |= 0x00000200u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_has_reordered_packets() {
+  _has_bits_[0] &= ~0x00000200u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_reordered_packets() {
+  reordered_packets_ = GOOGLE_ULONGLONG(0);
+  clear_has_reordered_packets();
+}
+inline ::google::protobuf::uint64 ProtoSubStreamMediaStatistic::reordered_packets() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoSubStreamMediaStatistic.reordered_packets)
+  return reordered_packets_;
+}
+inline void ProtoSubStreamMediaStatistic::set_reordered_packets(::google::protobuf::uint64 value) {
+  set_has_reordered_packets();
+  reordered_packets_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoSubStreamMediaStatistic.reordered_packets)
+}
+
+// optional uint64 late_packets = 42;
+inline bool ProtoSubStreamMediaStatistic::has_late_packets() const {
+  return (_has_bits_[0] & 0x00000400u) != 0;
+}
+inline void ProtoSubStreamMediaStatistic::set_has_late_packets() {
+  _has_bits_[0] |= 0x00000400u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_has_late_packets() {
+  _has_bits_[0] &= ~0x00000400u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_late_packets() {
+  late_packets_ = GOOGLE_ULONGLONG(0);
+  clear_has_late_packets();
+}
+inline ::google::protobuf::uint64 ProtoSubStreamMediaStatistic::late_packets() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoSubStreamMediaStatistic.late_packets)
+  return late_packets_;
+}
+inline void ProtoSubStreamMediaStatistic::set_late_packets(::google::protobuf::uint64 value) {
+  set_has_late_packets();
+  late_packets_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoSubStreamMediaStatistic.late_packets)
+}
+
+// optional uint64 damaged_frames = 43;
+inline bool ProtoSubStreamMediaStatistic::has_damaged_frames() const {
+  return (_has_bits_[0] & 0x00000800u) != 0;
+}
+inline void ProtoSubStreamMediaStatistic::set_has_damaged_frames() {
+  _has_bits_[0] |= 0x00000800u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_has_damaged_frames() {
+  _has_bits_[0] &= ~0x00000800u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_damaged_frames() {
+  damaged_frames_ = GOOGLE_ULONGLONG(0);
+  clear_has_damaged_frames();
+}
+inline ::google::protobuf::uint64 ProtoSubStreamMediaStatistic::damaged_frames() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoSubStreamMediaStatistic.damaged_frames)
+  return damaged_frames_;
+}
+inline void ProtoSubStreamMediaStatistic::set_damaged_frames(::google::protobuf::uint64 value) {
+  set_has_damaged_frames();
+  damaged_frames_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoSubStreamMediaStatistic.damaged_frames)
+}
+
+// optional uint32 jitter = 44;
+inline bool ProtoSubStreamMediaStatistic::has_jitter() const {
+  return (_has_bits_[0] & 0x00001000u) != 0;
+}
+inline void ProtoSubStreamMediaStatistic::set_has_jitter() {
+  _has_bits_[0] |= 0x00001000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_has_jitter() {
+  _has_bits_[0] &= ~0x00001000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_jitter() {
+  jitter_ = 0u;
+  clear_has_jitter();
+}
+inline ::google::protobuf::uint32 ProtoSubStreamMediaStatistic::jitter() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoSubStreamMediaStatistic.jitter)
+  return jitter_;
+}
+inline void ProtoSubStreamMediaStatistic::set_jitter(::google::protobuf::uint32 value) {
+  set_has_jitter();
+  jitter_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoSubStreamMediaStatistic.jitter)
+}
+
+// optional uint32 reorder_threshold = 45;
+inline bool ProtoSubStreamMediaStatistic::has_reorder_threshold() const {
+  return (_has_bits_[0] & 0x00002000u) != 0;
+}
+inline void ProtoSubStreamMediaStatistic::set_has_reorder_threshold() {
+  _has_bits_[0] |= 0x00002000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_has_reorder_threshold() {
+  _has_bits_[0] &= ~0x00002000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_reorder_threshold() {
+  reorder_threshold_ = 0u;
+  clear_has_reorder_threshold();
+}
+inline ::google::protobuf::uint32 ProtoSubStreamMediaStatistic::reorder_threshold() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoSubStreamMediaStatistic.reorder_threshold)
+  return reorder_threshold_;
+}
+inline void ProtoSubStreamMediaStatistic::set_reorder_threshold(::google::protobuf::uint32 value) {
+  set_has_reorder_threshold();
+  reorder_threshold_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoSubStreamMediaStatistic.reorder_threshold)
+}
+
+// optional uint32 reorder_delay = 46;
+inline bool ProtoSubStreamMediaStatistic::has_reorder_delay() const {
+  return (_has_bits_[0] & 0x00004000u) != 0;
+}
+inline void ProtoSubStreamMediaStatistic::set_has_reorder_delay() {
+  _has_bits_[0] |= 0x00004000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_has_reorder_delay() {
+  _has_bits_[0] &= ~0x00004000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_reorder_delay() {
+  reorder_delay_ = 0u;
+  clear_has_reorder_delay();
+}
+inline ::google::protobuf::uint32 ProtoSubStreamMediaStatistic::reorder_delay() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoSubStreamMediaStatistic.reorder_delay)
+  return reorder_delay_;
+}
+inline void ProtoSubStreamMediaStatistic::set_reorder_delay(::google::protobuf::uint32 value) {
+  set_has_reorder_delay();
+  reorder_delay_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoSubStreamMediaStatistic.reorder_delay)
+}
+
+// optional uint32 reorder_depth = 47;
+inline bool ProtoSubStreamMediaStatistic::has_reorder_depth() const {
+  return (_has_bits_[0] & 0x00008000u) != 0;
+}
+inline void ProtoSubStreamMediaStatistic::set_has_reorder_depth() {
+  _has_bits_[0] |= 0x00008000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_has_reorder_depth() {
+  _has_bits_[0] &= ~0x00008000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_reorder_depth() {
+  reorder_depth_ = 0u;
+  clear_has_reorder_depth();
+}
+inline ::google::protobuf::uint32 ProtoSubStreamMediaStatistic::reorder_depth() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoSubStreamMediaStatistic.reorder_depth)
+  return reorder_depth_;
+}
+inline void ProtoSubStreamMediaStatistic::set_reorder_depth(::google::protobuf::uint32 value) {
+  set_has_reorder_depth();
+  reorder_depth_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoSubStreamMediaStatistic.reorder_depth)
+}
+
+// optional int32 pts_offset = 48;
+inline bool ProtoSubStreamMediaStatistic::has_pts_offset() const {
+  return (_has_bits_[0] & 0x00010000u) != 0;
+}
+inline void ProtoSubStreamMediaStatistic::set_has_pts_offset() {
+  _has_bits_[0] |= 0x00010000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_has_pts_offset() {
+  _has_bits_[0] &= ~0x00010000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_pts_offset() {
+  pts_offset_ = 0;
+  clear_has_pts_offset();
+}
+inline ::google::protobuf::int32 ProtoSubStreamMediaStatistic::pts_offset() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoSubStreamMediaStatistic.pts_offset)
+  return pts_offset_;
+}
+inline void ProtoSubStreamMediaStatistic::set_pts_offset(::google::protobuf::int32 value) {
+  set_has_pts_offset();
+  pts_offset_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoSubStreamMediaStatistic.pts_offset)
+}
+
+// optional int32 pts_drift = 49;
+inline bool ProtoSubStreamMediaStatistic::has_pts_drift() const {
+  return (_has_bits_[0] & 0x00020000u) != 0;
+}
+inline void ProtoSubStreamMediaStatistic::set_has_pts_drift() {
+  _has_bits_[0] |= 0x00020000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_has_pts_drift() {
+  _has_bits_[0] &= ~0x00020000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_pts_drift() {
+  pts_drift_ = 0;
+  clear_has_pts_drift();
+}
+inline ::google::protobuf::int32 ProtoSubStreamMediaStatistic::pts_drift() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoSubStreamMediaStatistic.pts_drift)
+  return pts_drift_;
+}
+inline void ProtoSubStreamMediaStatistic::set_pts_drift(::google::protobuf::int32 value) {
+  set_has_pts_drift();
+  pts_drift_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoSubStreamMediaStatistic.pts_drift)
+}
+
+// optional uint64 paced_frames = 50;
+inline bool ProtoSubStreamMediaStatistic::has_paced_frames() const {
+  return (_has_bits_[0] & 0x00040000u) != 0;
+}
+inline void ProtoSubStreamMediaStatistic::set_has_paced_frames() {
+  _has_bits_[0] |= 0x00040000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_has_paced_frames() {
+  _has_bits_[0] &= ~0x00040000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_paced_frames() {
+  paced_frames_ = GOOGLE_ULONGLONG(0);
+  clear_has_paced_frames();
+}
+inline ::google::protobuf::uint64 ProtoSubStreamMediaStatistic::paced_frames() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoSubStreamMediaStatistic.paced_frames)
+  return paced_frames_;
+}
+inline void ProtoSubStreamMediaStatistic::set_paced_frames(::google::protobuf::uint64 value) {
+  set_has_paced_frames();
+  paced_frames_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoSubStreamMediaStatistic.paced_frames)
+}
+
+// optional uint64 pacing_dropped_frames = 51;
+inline bool ProtoSubStreamMediaStatistic::has_pacing_dropped_frames() const {
+  return (_has_bits_[0] & 0x00080000u) != 0;
+}
+inline void ProtoSubStreamMediaStatistic::set_has_pacing_dropped_frames() {
+  _has_bits_[0] |= 0x00080000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_has_pacing_dropped_frames() {
+  _has_bits_[0] &= ~0x00080000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_pacing_dropped_frames() {
+  pacing_dropped_frames_ = GOOGLE_ULONGLONG(0);
+  clear_has_pacing_dropped_frames();
+}
+inline ::google::protobuf::uint64 ProtoSubStreamMediaStatistic::pacing_dropped_frames() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoSubStreamMediaStatistic.pacing_dropped_frames)
+  return pacing_dropped_frames_;
+}
+inline void ProtoSubStreamMediaStatistic::set_pacing_dropped_frames(::google::protobuf::uint64 value) {
+  set_has_pacing_dropped_frames();
+  pacing_dropped_frames_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoSubStreamMediaStatistic.pacing_dropped_frames)
+}
+
+// optional uint64 pacing_late_frames = 52;
+inline bool ProtoSubStreamMediaStatistic::has_pacing_late_frames() const {
+  return (_has_bits_[0] & 0x00100000u) != 0;
+}
+inline void ProtoSubStreamMediaStatistic::set_has_pacing_late_frames() {
+  _has_bits_[0] |= 0x00100000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_has_pacing_late_frames() {
+  _has_bits_[0] &= ~0x00100000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_pacing_late_frames() {
+  pacing_late_frames_ = GOOGLE_ULONGLONG(0);
+  clear_has_pacing_late_frames();
+}
+inline ::google::protobuf::uint64 ProtoSubStreamMediaStatistic::pacing_late_frames() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoSubStreamMediaStatistic.pacing_late_frames)
+  return pacing_late_frames_;
+}
+inline void ProtoSubStreamMediaStatistic::set_pacing_late_frames(::google::protobuf::uint64 value) {
+  set_has_pacing_late_frames();
+  pacing_late_frames_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoSubStreamMediaStatistic.pacing_late_frames)
+}
+
+// optional uint32 pacing_mean_error = 53;
+inline bool ProtoSubStreamMediaStatistic::has_pacing_mean_error() const {
+  return (_has_bits_[0] & 0x00200000u) != 0;
+}
+inline void ProtoSubStreamMediaStatistic::set_has_pacing_mean_error() {
+  _has_bits_[0] |= 0x00200000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_has_pacing_mean_error() {
+  _has_bits_[0] &= ~0x00200000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_pacing_mean_error() {
+  pacing_mean_error_ = 0u;
+  clear_has_pacing_mean_error();
+}
+inline ::google::protobuf::uint32 ProtoSubStreamMediaStatistic::pacing_mean_error() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoSubStreamMediaStatistic.pacing_mean_error)
+  return pacing_mean_error_;
+}
+inline void ProtoSubStreamMediaStatistic::set_pacing_mean_error(::google::protobuf::uint32 value) {
+  set_has_pacing_mean_error();
+  pacing_mean_error_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoSubStreamMediaStatistic.pacing_mean_error)
+}
+
+// optional uint32 pacing_max_error = 54;
+inline bool ProtoSubStreamMediaStatistic::has_pacing_max_error() const {
+  return (_has_bits_[0] & 0x00400000u) != 0;
+}
+inline void ProtoSubStreamMediaStatistic::set_has_pacing_max_error() {
+  _has_bits_[0] |= 0x00400000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_has_pacing_max_error() {
+  _has_bits_[0] &= ~0x00400000u;
+}
+inline void ProtoSubStreamMediaStatistic::clear_pacing_max_error() {
+  pacing_max_error_ = 0u;
+  clear_has_pacing_max_error();
+}
+inline ::google::protobuf::uint32 ProtoSubStreamMediaStatistic::pacing_max_error() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoSubStreamMediaStatistic.pacing_max_error)
+  return pacing_max_error_;
+}
+inline void ProtoSubStreamMediaStatistic::set_pacing_max_error(::google::protobuf::uint32 value) {
+  set_has_pacing_max_error();
+  pacing_max_error_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoSubStreamMediaStatistic.pacing_max_error)
+}
+
+// repeated uint64 pacing_error_histogram = 55;
+inline int ProtoSubStreamMediaStatistic::pacing_error_histogram_size() const {
+  return pacing_error_histogram_.size();
+}
+inline void ProtoSubStreamMediaStatistic::clear_pacing_error_histogram() {
+  pacing_error_histogram_.Clear();
+}
+inline ::google::protobuf::uint64 ProtoSubStreamMediaStatistic::pacing_error_histogram(int index) const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoSubStreamMediaStatistic.pacing_error_histogram)
+  return pacing_error_histogram_.Get(index);
+}
+inline void ProtoSubStreamMediaStatistic::set_pacing_error_histogram(int index, ::google::protobuf::uint64 value) {
+  pacing_error_histogram_.Set(index, value);
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoSubStreamMediaStatistic.pacing_error_histogram)
+}
+inline void ProtoSubStreamMediaStatistic::add_pacing_error_histogram(::google::protobuf::uint64 value) {
+  pacing_error_histogram_.Add(value);
+  // @@protoc_insertion_point(field_add:stream_switch.ProtoSubStreamMediaStatistic.pacing_error_histogram)
+}
+inline const ::google::protobuf::RepeatedField< ::google::protobuf::uint64 >&
+ProtoSubStreamMediaStatistic::pacing_error_histogram() const {
+  // @@protoc_insertion_point(field_list:stream_switch.ProtoSubStreamMediaStatistic.pacing_error_histogram)
+  return pacing_error_histogram_;
+}
+inline ::google::protobuf::RepeatedField< ::google::protobuf::uint64 >*
+ProtoSubStreamMediaStatistic::mutable_pacing_error_histogram() {
+  // @@protoc_insertion_point(field_mutable_list:stream_switch.ProtoSubStreamMediaStatistic.pacing_error_histogram)
+  return &pacing_error_histogram_;
+}
+
 // -------------------------------------------------------------------
 
 // ProtoMediaStatisticRep
@@ -648,6 +1291,222 @@ inline void ProtoMediaStatisticRep::set_sum_bytes(::google::protobuf::uint64 val
   // @@protoc_insertion_point(field_set:stream_switch.ProtoMediaStatisticRep.sum_bytes)
 }
 
+// optional int64 read_ahead_fill = 4;
+inline bool ProtoMediaStatisticRep::has_read_ahead_fill() const {
+  return (_has_bits_[0] & 0x00000008u) != 0;
+}
+inline void ProtoMediaStatisticRep::set_has_read_ahead_fill() {
+  _has_bits_[0] |= 0x00000008u;
+}
+inline void ProtoMediaStatisticRep::clear_has_read_ahead_fill() {
+  _has_bits_[0] &= ~0x00000008u;
+}
+inline void ProtoMediaStatisticRep::clear_read_ahead_fill() {
+  read_ahead_fill_ = GOOGLE_LONGLONG(0);
+  clear_has_read_ahead_fill();
+}
+inline ::google::protobuf::int64 ProtoMediaStatisticRep::read_ahead_fill() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoMediaStatisticRep.read_ahead_fill)
+  return read_ahead_fill_;
+}
+inline void ProtoMediaStatisticRep::set_read_ahead_fill(::google::protobuf::int64 value) {
+  set_has_read_ahead_fill();
+  read_ahead_fill_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoMediaStatisticRep.read_ahead_fill)
+}
+
+// optional uint32 read_ahead_packets = 5;
+inline bool ProtoMediaStatisticRep::has_read_ahead_packets() const {
+  return (_has_bits_[0] & 0x00000010u) != 0;
+}
+inline void ProtoMediaStatisticRep::set_has_read_ahead_packets() {
+  _has_bits_[0] |= 0x00000010u;
+}
+inline void ProtoMediaStatisticRep::clear_has_read_ahead_packets() {
+  _has_bits_[0] &= ~0x00000010u;
+}
+inline void ProtoMediaStatisticRep::clear_read_ahead_packets() {
+  read_ahead_packets_ = 0u;
+  clear_has_read_ahead_packets();
+}
+inline ::google::protobuf::uint32 ProtoMediaStatisticRep::read_ahead_packets() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoMediaStatisticRep.read_ahead_packets)
+  return read_ahead_packets_;
+}
+inline void ProtoMediaStatisticRep::set_read_ahead_packets(::google::protobuf::uint32 value) {
+  set_has_read_ahead_packets();
+  read_ahead_packets_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoMediaStatisticRep.read_ahead_packets)
+}
+
+// optional int64 read_ahead_capacity = 6;
+inline bool ProtoMediaStatisticRep::has_read_ahead_capacity() const {
+  return (_has_bits_[0] & 0x00000020u) != 0;
+}
+inline void ProtoMediaStatisticRep::set_has_read_ahead_capacity() {
+  _has_bits_[0] |= 0x00000020u;
+}
+inline void ProtoMediaStatisticRep::clear_has_read_ahead_capacity() {
+  _has_bits_[0] &= ~0x00000020u;
+}
+inline void ProtoMediaStatisticRep::clear_read_ahead_capacity() {
+  read_ahead_capacity_ = GOOGLE_LONGLONG(0);
+  clear_has_read_ahead_capacity();
+}
+inline ::google::protobuf::int64 ProtoMediaStatisticRep::read_ahead_capacity() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoMediaStatisticRep.read_ahead_capacity)
+  return read_ahead_capacity_;
+}
+inline void ProtoMediaStatisticRep::set_read_ahead_capacity(::google::protobuf::int64 value) {
+  set_has_read_ahead_capacity();
+  read_ahead_capacity_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoMediaStatisticRep.read_ahead_capacity)
+}
+
+// optional uint64 read_ahead_underruns = 7;
+inline bool ProtoMediaStatisticRep::has_read_ahead_underruns() const {
+  return (_has_bits_[0] & 0x00000040u) != 0;
+}
+inline void ProtoMediaStatisticRep::set_has_read_ahead_underruns() {
+  _has_bits_[0] |= 0x00000040u;
+}
+inline void ProtoMediaStatisticRep::clear_has_read_ahead_underruns() {
+  _has_bits_[0] &= ~0x00000040u;
+}
+inline void ProtoMediaStatisticRep::clear_read_ahead_underruns() {
+  read_ahead_underruns_ = GOOGLE_ULONGLONG(0);
+  clear_has_read_ahead_underruns();
+}
+inline ::google::protobuf::uint64 ProtoMediaStatisticRep::read_ahead_underruns() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoMediaStatisticRep.read_ahead_underruns)
+  return read_ahead_underruns_;
+}
+inline void ProtoMediaStatisticRep::set_read_ahead_underruns(::google::protobuf::uint64 value) {
+  set_has_read_ahead_underruns();
+  read_ahead_underruns_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoMediaStatisticRep.read_ahead_underruns)
+}
+
+// optional uint64 read_packets = 8;
+inline bool ProtoMediaStatisticRep::has_read_packets() const {
+  return (_has_bits_[0] & 0x00000080u) != 0;
+}
+inline void ProtoMediaStatisticRep::set_has_read_packets() {
+  _has_bits_[0] |= 0x00000080u;
+}
+inline void ProtoMediaStatisticRep::clear_has_read_packets() {
+  _has_bits_[0] &= ~0x00000080u;
+}
+inline void ProtoMediaStatisticRep::clear_read_packets() {
+  read_packets_ = GOOGLE_ULONGLONG(0);
+  clear_has_read_packets();
+}
+inline ::google::protobuf::uint64 ProtoMediaStatisticRep::read_packets() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoMediaStatisticRep.read_packets)
+  return read_packets_;
+}
+inline void ProtoMediaStatisticRep::set_read_packets(::google::protobuf::uint64 value) {
+  set_has_read_packets();
+  read_packets_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoMediaStatisticRep.read_packets)
+}
+
+// optional int64 pacing_stretch = 9;
+inline bool ProtoMediaStatisticRep::has_pacing_stretch() const {
+  return (_has_bits_[0] & 0x00000100u) != 0;
+}
+inline void ProtoMediaStatisticRep::set_has_pacing_stretch() {
+  _has_bits_[0] |= 0x00000100u;
+}
+inline void ProtoMediaStatisticRep::clear_has_pacing_stretch() {
+  _has_bits_[0] &= ~0x00000100u;
+}
+inline void ProtoMediaStatisticRep::clear_pacing_stretch() {
+  pacing_stretch_ = GOOGLE_LONGLONG(0);
+  clear_has_pacing_stretch();
+}
+inline ::google::protobuf::int64 ProtoMediaStatisticRep::pacing_stretch() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoMediaStatisticRep.pacing_stretch)
+  return pacing_stretch_;
+}
+inline void ProtoMediaStatisticRep::set_pacing_stretch(::google::protobuf::int64 value) {
+  set_has_pacing_stretch();
+  pacing_stretch_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoMediaStatisticRep.pacing_stretch)
+}
+
+// optional int64 open_time = 10 [default = -1];
+inline bool ProtoMediaStatisticRep::has_open_time() const {
+  return (_has_bits_[0] & 0x00000200u) != 0;
+}
+inline void ProtoMediaStatisticRep::set_has_open_time() {
+  _has_bits_[0] |= 0x00000200u;
+}
+inline void ProtoMediaStatisticRep::clear_has_open_time() {
+  _has_bits_[0] &= ~0x00000200u;
+}
+inline void ProtoMediaStatisticRep::clear_open_time() {
+  open_time_ = GOOGLE_LONGLONG(-1);
+  clear_has_open_time();
+}
+inline ::google::protobuf::int64 ProtoMediaStatisticRep::open_time() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoMediaStatisticRep.open_time)
+  return open_time_;
+}
+inline void ProtoMediaStatisticRep::set_open_time(::google::protobuf::int64 value) {
+  set_has_open_time();
+  open_time_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoMediaStatisticRep.open_time)
+}
+
+// optional int64 meta_time = 11 [default = -1];
+inline bool ProtoMediaStatisticRep::has_meta_time() const {
+  return (_has_bits_[0] & 0x00000400u) != 0;
+}
+inline void ProtoMediaStatisticRep::set_has_meta_time() {
+  _has_bits_[0] |= 0x00000400u;
+}
+inline void ProtoMediaStatisticRep::clear_has_meta_time() {
+  _has_bits_[0] &= ~0x00000400u;
+}
+inline void ProtoMediaStatisticRep::clear_meta_time() {
+  meta_time_ = GOOGLE_LONGLONG(-1);
+  clear_has_meta_time();
+}
+inline ::google::protobuf::int64 ProtoMediaStatisticRep::meta_time() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoMediaStatisticRep.meta_time)
+  return meta_time_;
+}
+inline void ProtoMediaStatisticRep::set_meta_time(::google::protobuf::int64 value) {
+  set_has_meta_time();
+  meta_time_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoMediaStatisticRep.meta_time)
+}
+
+// optional int64 first_frame_time = 12 [default = -1];
+inline bool ProtoMediaStatisticRep::has_first_frame_time() const {
+  return (_has_bits_[0] & 0x00000800u) != 0;
+}
+inline void ProtoMediaStatisticRep::set_has_first_frame_time() {
+  _has_bits_[0] |= 0x00000800u;
+}
+inline void ProtoMediaStatisticRep::clear_has_first_frame_time() {
+  _has_bits_[0] &= ~0x00000800u;
+}
+inline void ProtoMediaStatisticRep::clear_first_frame_time() {
+  first_frame_time_ = GOOGLE_LONGLONG(-1);
+  clear_has_first_frame_time();
+}
+inline ::google::protobuf::int64 ProtoMediaStatisticRep::first_frame_time() const {
+  // @@protoc_insertion_point(field_get:stream_switch.ProtoMediaStatisticRep.first_frame_time)
+  return first_frame_time_;
+}
+inline void ProtoMediaStatisticRep::set_first_frame_time(::google::protobuf::int64 value) {
+  set_has_first_frame_time();
+  first_frame_time_ = value;
+  // @@protoc_insertion_point(field_set:stream_switch.ProtoMediaStatisticRep.first_frame_time)
+}
+
 // repeated .stream_switch.ProtoSubStreamMediaStatistic sub_stream_stats = 64;
 inline int ProtoMediaStatisticRep::sub_stream_stats_size() const {
   return sub_stream_stats_.size();
@@ -0,0 +1,220 @@
+/**
+ * This file is part of libstreamswtich, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_nal_scanner.cc
+ *      Annex-B start code and NAL unit scanner implementation, with
+ * SSE2/AVX2 kernels selected at runtime and a scalar fallback
+ *
+ * author: OpenSight Team
+ * date: 2016-3-8
+**/
+
+#include <string.h>
+#include <pthread.h>
+
+#include <stsw_nal_scanner.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STSW_NAL_SCANNER_X86
+#include <immintrin.h>
+#endif
+
+
+typedef const uint8_t *(*FindStartCodeFunc)(const uint8_t *start,
+                                            const uint8_t *end);
+
+static const uint8_t *FindStartCodeScalar(const uint8_t *p, const uint8_t *end)
+{
+    // check 3 bytes a time, skip as many bytes as possible according
+    // to the third one
+    while(p + 2 < end){
+        if(p[2] > 1){
+            p += 3;
+        }else if(p[1]){
+            p += 2;
+        }else if(p[0] || p[2] != 1){
+            p++;
+        }else{
+            return p;
+        }
+    }
+    return end;
+}
+
+#ifdef STSW_NAL_SCANNER_X86
+
+__attribute__((target("sse2")))
+static const uint8_t *FindStartCodeSse2(const uint8_t *p, const uint8_t *end)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+
+    // 16 candidate positions a time, each needs its 2 following bytes
+    while(end - p >= 18){
+        __m128i b0 = _mm_loadu_si128((const __m128i *)p);
+        __m128i b1 = _mm_loadu_si128((const __m128i *)(p + 1));
+        __m128i b2 = _mm_loadu_si128((const __m128i *)(p + 2));
+        __m128i hit = _mm_and_si128(
+            _mm_and_si128(_mm_cmpeq_epi8(b0, zero), _mm_cmpeq_epi8(b1, zero)),
+            _mm_cmpeq_epi8(b2, one));
+        int mask = _mm_movemask_epi8(hit);
+        if(mask){
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+    return FindStartCodeScalar(p, end);
+}
+
+__attribute__((target("avx2")))
+static const uint8_t *FindStartCodeAvx2(const uint8_t *p, const uint8_t *end)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8(1);
+
+    // 32 candidate positions a time, each needs its 2 following bytes
+    while(end - p >= 34){
+        __m256i b0 = _mm256_loadu_si256((const __m256i *)p);
+        __m256i b1 = _mm256_loadu_si256((const __m256i *)(p + 1));
+        __m256i b2 = _mm256_loadu_si256((const __m256i *)(p + 2));
+        __m256i hit = _mm256_and_si256(
+            _mm256_and_si256(_mm256_cmpeq_epi8(b0, zero),
+                             _mm256_cmpeq_epi8(b1, zero)),
+            _mm256_cmpeq_epi8(b2, one));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(hit);
+        if(mask){
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+    return FindStartCodeSse2(p, end);
+}
+
+#endif
+
+// the kernel is selected once on the first use, so that it's valid during
+// static initialization and safe when several threads scan at the first time
+static FindStartCodeFunc find_start_code_func = FindStartCodeScalar;
+static const char *kernel_name = "scalar";
+static pthread_once_t kernel_once = PTHREAD_ONCE_INIT;
+
+static void SelectFindStartCode()
+{
+#ifdef STSW_NAL_SCANNER_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")){
+        kernel_name = "avx2";
+        find_start_code_func = FindStartCodeAvx2;
+        return;
+    }
+    if(__builtin_cpu_supports("sse2")){
+        kernel_name = "sse2";
+        find_start_code_func = FindStartCodeSse2;
+        return;
+    }
+#endif
+    kernel_name = "scalar";
+    find_start_code_func = FindStartCodeScalar;
+}
+
+
+extern "C" {
+
+const uint8_t *stsw_find_start_code(const uint8_t *start, const uint8_t *end)
+{
+    if(start >= end){
+        return end;
+    }
+    pthread_once(&kernel_once, SelectFindStartCode);
+    return find_start_code_func(start, end);
+}
+
+int stsw_next_nal_unit(const uint8_t **pos, const uint8_t *end,
+                       int h_number, StswNalUnit *nal)
+{
+    const uint8_t *prefix = *pos;
+    const uint8_t *data = prefix;
+
+    while(data < end){
+        const uint8_t *next = stsw_find_start_code(data, end);
+        const uint8_t *nal_end = next;
+
+        // the zero bytes before the next start code is not a part of NAL
+        while(nal_end > data && nal_end[-1] == 0){
+            nal_end--;
+        }
+        if(nal_end > data){
+            nal->start = prefix;
+            nal->data = data;
+            nal->size = nal_end - data;
+            if(h_number == 264){
+                nal->type = data[0] & 0x1f;
+            }else if(h_number == 265 && nal->size >= 2){
+                nal->type = (data[0] & 0x7e) >> 1;
+            }else{
+                nal->type = 0xff;
+            }
+            *pos = nal_end;
+            return 1;
+        }
+        if(next >= end){
+            break;
+        }
+        data = next + 3;
+    }
+
+    *pos = end;
+    return 0;
+}
+
+const char *stsw_nal_scanner_kernel(void)
+{
+    pthread_once(&kernel_once, SelectFindStartCode);
+    return kernel_name;
+}
+
+int stsw_nal_scanner_select_kernel(const char *name)
+{
+    pthread_once(&kernel_once, SelectFindStartCode);
+
+    if(strcmp(name, "scalar") == 0){
+        find_start_code_func = FindStartCodeScalar;
+        kernel_name = "scalar";
+        return 0;
+    }
+#ifdef STSW_NAL_SCANNER_X86
+    if(strcmp(name, "sse2") == 0 && __builtin_cpu_supports("sse2")){
+        find_start_code_func = FindStartCodeSse2;
+        kernel_name = "sse2";
+        return 0;
+    }
+    if(strcmp(name, "avx2") == 0 && __builtin_cpu_supports("avx2")){
+        find_start_code_func = FindStartCodeAvx2;
+        kernel_name = "avx2";
+        return 0;
+    }
+#endif
+    return -1;
+}
+
+}
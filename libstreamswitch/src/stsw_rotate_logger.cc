@@ -39,11 +39,26 @@
 #include <fcntl.h>
 #include <stdarg.h>
 #include <fcntl.h>
+#include <time.h>
 
 #include <stsw_lock_guard.h>
 
 #define STDERR_FD   2 
 
+#define MAX_LOG_RECORD_SIZE 1024
+
+// the write thread collects the records into a batch up to this size for 
+// one write(), and sleeps this interval if the ring is empty
+#define ASYNC_WRITE_BATCH_SIZE  (64 * 1024)
+#define ASYNC_WRITE_IDLE_INTERVAL  10000000   // 10 ms, in nanosec
+
+// formatting a record takes microseconds, a slot claimed but not published 
+// after this time is regarded as abandoned by its caller
+#define ASYNC_CLAIM_TIMEOUT  1000   // in ms
+
+// the max time StopAsync() waits for the callers still writing the ring
+#define ASYNC_STOP_TIMEOUT  1000   // in ms
+
 namespace stream_switch {
  
 static const char *log_level_str[] = 
@@ -57,10 +72,56 @@ static const char *log_level_str[] =
     "INFO", 
     "DEBUG",
 };    
+
+struct AsyncLogRecord{
+    uint64_t seq;            // equal to the ring position if the slot is free 
+                             // or claimed, or the position + 1 if it's published. 
+                             // Stored with release after the other fields are 
+                             // written, and loaded with acquire before they are read
+    int level;
+    const char * filename;   // __FILE__, never freed
+    int line;
+    time_t time;
+    char text[MAX_LOG_RECORD_SIZE];
+};
+
+
+// the loggers in the asynchronous mode, for the fork handlers
+static pthread_mutex_t async_loggers_lock = PTHREAD_MUTEX_INITIALIZER;
+static std::list<RotateLogger *> async_loggers;
+static pthread_once_t atfork_once = PTHREAD_ONCE_INIT;
+
+
+static int64_t MonotonicMs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// the head of a record: [time][program][level][file:line]: 
+static int FormatRecordHead(char * buf, size_t size, time_t curtime, 
+                            const std::string &prog_name, 
+                            int level, const char * filename, int line)
+{
+    char time_str_buf[32];
+    ctime_r(&curtime, time_str_buf);    
+    time_str_buf[strlen(time_str_buf) - 1] = 0; //remove the end NEWLINE char
+    
+    return snprintf(buf, size, 
+                    "[%s][%s][%s][%s:%d]: ",
+                    time_str_buf, 
+                    prog_name.c_str(), 
+                    log_level_str[level], 
+                    filename, line);
+}
     
 RotateLogger::RotateLogger()
 :file_size_(0), rotate_num_(0), stderr_redirect_(false), 
-log_level_(0), fd_(-1), redirect_fd_old_(-1), flags_(0)
+log_level_(0), fd_(-1), redirect_fd_old_(-1), flags_(0), 
+ring_(NULL), ring_mask_(0), enqueue_pos_(0), dequeue_pos_(0), 
+dropped_(0), reported_dropped_(0), write_thread_id_(0), write_running_(false), 
+async_writers_(0), stall_pos_(0), stall_since_(0)
 {
     pid_ = getpid();    
 }
@@ -68,6 +129,10 @@ log_level_(0), fd_(-1), redirect_fd_old_(-1), flags_(0)
 RotateLogger::~RotateLogger()
 {
     Uninit();
+    if(ring_ != NULL){
+        delete[] ring_;
+        ring_ = NULL;
+    }
 }
     
 int RotateLogger::Init(std::string prog_name, std::string base_name, 
@@ -188,6 +253,8 @@ void RotateLogger::Uninit()
         return;
     }  
     
+    StopAsync();
+    
     CloseFile();
 
     pthread_mutex_destroy(&lock_);   
@@ -269,8 +336,6 @@ void RotateLogger::CheckRotateInternal()
     }
 }
 
-#define MAX_LOG_RECORD_SIZE 1024
-
 void RotateLogger::Log(int level, const char * filename, int line, const char * fmt, ...)
 {
     va_list vl;
@@ -286,28 +351,33 @@ void RotateLogger::LogV(int level, const char * filename, int line, const char *
         return;
     }   
     
-    if(level > log_level_){
+    if(level > log_level_ || level < LOG_LEVEL_EMERG){
         return; // level filter
     }
+    
+    if(__atomic_load_n(&write_running_, __ATOMIC_ACQUIRE)){
+        // count the caller in before checking the flag again, so that 
+        // StopAsync() cannot free the ring under it. Both sides use seq_cst 
+        // so that either the caller sees the flag cleared or StopAsync() 
+        // sees the caller counted
+        __atomic_fetch_add(&async_writers_, 1, __ATOMIC_SEQ_CST);
+        if(__atomic_load_n(&write_running_, __ATOMIC_SEQ_CST)){
+            LogAsync(level, filename, line, fmt, args);
+            __atomic_fetch_sub(&async_writers_, 1, __ATOMIC_RELEASE);
+            return;
+        }
+        __atomic_fetch_sub(&async_writers_, 1, __ATOMIC_RELEASE);
+    }
         
     ::std::string log_str;
     int ret;
-    char time_str_buf[32];
-    time_t curtime = time (NULL);
-    char *time_str;
-    time_str = ctime_r(&curtime, time_str_buf);    
-    time_str_buf[strlen(time_str_buf) - 1] = 0; //remove the end NEWLINE char
     
     //
     // make up the log record string
     char * tmp_buf = new char[MAX_LOG_RECORD_SIZE];
     tmp_buf[MAX_LOG_RECORD_SIZE - 1] = 0;
-    ret = snprintf(tmp_buf, MAX_LOG_RECORD_SIZE - 1, 
-             "[%s][%s][%s][%s:%d]: ",
-             time_str, 
-             prog_name_.c_str(), 
-             log_level_str[level], 
-             filename, line);
+    ret = FormatRecordHead(tmp_buf, MAX_LOG_RECORD_SIZE - 1, time(NULL), 
+                           prog_name_, level, filename, line);
     if(ret < 0){
         goto out;
     }
@@ -342,6 +412,369 @@ out:
     
 }
 
+
+int RotateLogger::StartAsync(int ring_size)
+{
+    int ret;
+    uint64_t size = 1;
+    
+    if(!IsInit()){
+        return ERROR_CODE_GENERAL;
+    }
+    if(__atomic_load_n(&write_running_, __ATOMIC_ACQUIRE)){
+        return 0; //already started
+    }
+    if(ring_size <= 0){
+        return ERROR_CODE_PARAM;
+    }
+    while(size < (uint64_t)ring_size){
+        size <<= 1;
+    }
+    
+    if(ring_ != NULL){
+        delete[] ring_;
+    }
+    ring_ = new AsyncLogRecord[size];
+    for(uint64_t i = 0; i < size; i++){
+        ring_[i].seq = i;
+    }
+    ring_mask_ = size - 1;
+    __atomic_store_n(&enqueue_pos_, 0, __ATOMIC_RELAXED);
+    dequeue_pos_ = 0;
+    __atomic_store_n(&dropped_, 0, __ATOMIC_RELAXED);
+    reported_dropped_ = 0;
+    __atomic_store_n(&async_writers_, 0, __ATOMIC_RELAXED);
+    stall_pos_ = ~(uint64_t)0;
+    stall_since_ = 0;
+    
+    pthread_once(&atfork_once, RotateLogger::InstallAtFork);
+    
+    // registered in the same critical section as the thread is created, 
+    // so that a concurrent fork() sees both or neither
+    // the ring is published to the callers by the release store
+    pthread_mutex_lock(&async_loggers_lock);
+    __atomic_store_n(&write_running_, true, __ATOMIC_RELEASE);
+    ret = pthread_create(&write_thread_id_, NULL, 
+                         RotateLogger::StaticWriteThreadRoutine, this);
+    if(ret){
+        pthread_mutex_unlock(&async_loggers_lock);
+        perror("pthread_create log write thread failed");
+        __atomic_store_n(&write_running_, false, __ATOMIC_SEQ_CST);
+        write_thread_id_ = 0;
+        delete[] ring_;
+        ring_ = NULL;
+        return ERROR_CODE_SYSTEM;
+    }
+    async_loggers.push_back(this);
+    pthread_mutex_unlock(&async_loggers_lock);
+    
+    return 0;
+}
+
+void RotateLogger::StopAsync()
+{
+    int64_t start_time;
+    
+    if(!__atomic_load_n(&write_running_, __ATOMIC_ACQUIRE)){
+        return;
+    }
+    
+    pthread_mutex_lock(&async_loggers_lock);
+    __atomic_store_n(&write_running_, false, __ATOMIC_SEQ_CST);
+    async_loggers.remove(this);
+    pthread_mutex_unlock(&async_loggers_lock);
+    
+    // wait for the callers which have seen write_running_ before it's 
+    // cleared, they are still writing the ring
+    start_time = MonotonicMs();
+    while(__atomic_load_n(&async_writers_, __ATOMIC_SEQ_CST) != 0 && 
+          MonotonicMs() - start_time < ASYNC_STOP_TIMEOUT){
+        struct timespec req;
+        req.tv_sec = 0;
+        req.tv_nsec = 1000000;
+        nanosleep(&req, NULL);
+    }
+    
+    pthread_join(write_thread_id_, NULL);
+    write_thread_id_ = 0;
+    
+    // write the records left, no more slot would be published
+    WriteRing(0);
+    
+    if(__atomic_load_n(&async_writers_, __ATOMIC_ACQUIRE) == 0){
+        delete[] ring_;
+    }
+    // otherwise a caller is stuck inside LogAsync(), the ring is leaked 
+    // rather than freed under it
+    ring_ = NULL;
+}
+
+bool RotateLogger::IsAsync()
+{
+    return __atomic_load_n(&write_running_, __ATOMIC_ACQUIRE);
+}
+
+uint64_t RotateLogger::dropped_records()
+{
+    return __atomic_load_n(&dropped_, __ATOMIC_RELAXED);
+}
+
+void RotateLogger::LogAsync(int level, const char * filename, int line, 
+                            const char * fmt, va_list args)
+{
+    AsyncLogRecord * record;
+    uint64_t pos = __atomic_load_n(&enqueue_pos_, __ATOMIC_RELAXED);
+    
+    // claim a free slot, the acquire load of seq pairs with the release 
+    // store of the write thread freeing it, so the record is not 
+    // overwritten before it's read
+    while(1){
+        record = &ring_[pos & ring_mask_];
+        int64_t diff = (int64_t)__atomic_load_n(&record->seq, __ATOMIC_ACQUIRE) - 
+                       (int64_t)pos;
+        if(diff == 0){
+            // pos is reloaded on failure
+            if(__atomic_compare_exchange_n(&enqueue_pos_, &pos, pos + 1, 
+                                           false, __ATOMIC_RELAXED, 
+                                           __ATOMIC_RELAXED)){
+                break;
+            }
+        }else if(diff < 0){
+            // the ring is full, never block the caller
+            __atomic_fetch_add(&dropped_, 1, __ATOMIC_RELAXED);
+            return;
+        }else{
+            // claimed by another thread, try again
+            pos = __atomic_load_n(&enqueue_pos_, __ATOMIC_RELAXED); 
+        }
+    }
+    
+    record->level = level;
+    record->filename = filename;
+    record->line = line;
+    record->time = time(NULL);
+    if(vsnprintf(record->text, MAX_LOG_RECORD_SIZE, fmt, args) < 0){
+        record->text[0] = 0;
+    }
+    
+    // publish it to the write thread, unless the write thread has given 
+    // up waiting for it and skipped the slot
+    uint64_t expected = pos;
+    if(!__atomic_compare_exchange_n(&record->seq, &expected, pos + 1, 
+                                    false, __ATOMIC_RELEASE, 
+                                    __ATOMIC_RELAXED)){
+        __atomic_fetch_add(&dropped_, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void * RotateLogger::StaticWriteThreadRoutine(void *arg)
+{
+    RotateLogger * logger = (RotateLogger *)arg;
+    logger->InternalWriteRoutine();
+    return NULL;
+}
+
+void RotateLogger::InternalWriteRoutine()
+{
+    while(__atomic_load_n(&write_running_, __ATOMIC_ACQUIRE)){
+        if(WriteRing(ASYNC_CLAIM_TIMEOUT) == 0){
+            struct timespec req;
+            req.tv_sec = 0;
+            req.tv_nsec = ASYNC_WRITE_IDLE_INTERVAL;
+            nanosleep(&req, NULL);
+        }
+    }
+}
+
+int RotateLogger::WriteRing(int64_t claim_timeout)
+{
+    ::std::string batch;
+    size_t batch_limit = ASYNC_WRITE_BATCH_SIZE;
+    char head[MAX_LOG_RECORD_SIZE];
+    int num = 0;
+    uint64_t dropped;
+    
+    if(ring_ == NULL){
+        return 0;
+    }
+    
+    batch.reserve(ASYNC_WRITE_BATCH_SIZE + 2 * MAX_LOG_RECORD_SIZE);
+    while(1){
+        AsyncLogRecord * record = &ring_[dequeue_pos_ & ring_mask_];
+        bool is_published = 
+            (__atomic_load_n(&record->seq, __ATOMIC_ACQUIRE) == dequeue_pos_ + 1);
+        
+        if(!is_published && 
+           dequeue_pos_ != __atomic_load_n(&enqueue_pos_, __ATOMIC_RELAXED) && 
+           IsClaimStalled(claim_timeout)){
+            // the slot is claimed but not published in time, skip it so 
+            // that the records after it are not blocked for ever. The CAS 
+            // fails if it's just published, then it's written as usual
+            uint64_t expected = dequeue_pos_;
+            if(__atomic_compare_exchange_n(&record->seq, &expected, 
+                                           dequeue_pos_ + ring_mask_ + 1, 
+                                           false, __ATOMIC_ACQ_REL, 
+                                           __ATOMIC_ACQUIRE)){
+                __atomic_fetch_add(&dropped_, 1, __ATOMIC_RELAXED);
+                dequeue_pos_++;
+            }
+            continue;
+        }
+        
+        if(is_published){
+            size_t text_len;
+            if(batch.empty()){
+                batch_limit = BatchLimit();
+            }
+            if(FormatRecordHead(head, sizeof(head), record->time, prog_name_, 
+                                record->level, record->filename, 
+                                record->line) > 0){
+                batch.append(head);
+            }
+            text_len = strlen(record->text);
+            batch.append(record->text, text_len);
+            if(text_len == 0 || record->text[text_len - 1] != '\n'){
+                batch.push_back('\n');
+            }
+            
+            // free the slot
+            __atomic_store_n(&record->seq, dequeue_pos_ + ring_mask_ + 1, 
+                             __ATOMIC_RELEASE);
+            dequeue_pos_++;
+            num++;
+        }
+        
+        if(batch.size() >= batch_limit || 
+           (!is_published && !batch.empty())){
+            LockGuard guard(&lock_);  
+            
+            //check if need rotate
+            CheckRotateInternal();  
+            if(fd_ >= 0){
+                write(fd_, batch.data(), batch.size());            
+            }
+            batch.clear();
+        }
+        if(!is_published){
+            break;
+        }
+    }
+    
+    dropped = __atomic_load_n(&dropped_, __ATOMIC_RELAXED);
+    if(dropped != reported_dropped_){
+        int len = FormatRecordHead(head, sizeof(head), time(NULL), prog_name_, 
+                                   LOG_LEVEL_WARNING, __FILE__, __LINE__);
+        if(len > 0 && len < (int)sizeof(head)){
+            snprintf(head + len, sizeof(head) - len, 
+                     "%llu log records dropped for the full ring or "
+                     "the unfinished callers\n", 
+                     (unsigned long long)(dropped - reported_dropped_));
+            LockGuard guard(&lock_);  
+            if(fd_ >= 0){
+                write(fd_, head, strlen(head));            
+            }
+        }
+        reported_dropped_ = dropped;
+    }
+    
+    return num;
+}
+
+bool RotateLogger::IsClaimStalled(int64_t claim_timeout)
+{
+    int64_t now;
+    
+    if(claim_timeout <= 0){
+        return true;
+    }
+    now = MonotonicMs();
+    if(stall_pos_ != dequeue_pos_){
+        // start to wait for this slot
+        stall_pos_ = dequeue_pos_;
+        stall_since_ = now;
+        return false;
+    }
+    return (now - stall_since_ >= claim_timeout);
+}
+
+size_t RotateLogger::BatchLimit()
+{
+    off_t len;
+    
+    LockGuard guard(&lock_);  
+    
+    // rotate first if the last batch has filled the file
+    CheckRotateInternal();
+    if(fd_ < 0){
+        return ASYNC_WRITE_BATCH_SIZE;
+    }
+    len = lseek(fd_, 0, SEEK_CUR);
+    if(len < 0 || len >= file_size_){
+        return 1;   // flush every record
+    }
+    if(file_size_ - len < ASYNC_WRITE_BATCH_SIZE){
+        return file_size_ - len;
+    }
+    return ASYNC_WRITE_BATCH_SIZE;
+}
+
+void RotateLogger::InstallAtFork()
+{
+    pthread_atfork(RotateLogger::AtForkPrepare, 
+                   RotateLogger::AtForkParent, 
+                   RotateLogger::AtForkChild);
+}
+
+void RotateLogger::AtForkPrepare()
+{
+    // no write thread holds the file lock at fork(), otherwise the child 
+    // would deadlock on it in the synchronous mode
+    pthread_mutex_lock(&async_loggers_lock);
+    std::list<RotateLogger *>::iterator it;
+    for(it = async_loggers.begin(); it != async_loggers.end(); it++){
+        pthread_mutex_lock(&((*it)->lock_));
+    }
+}
+
+void RotateLogger::AtForkParent()
+{
+    std::list<RotateLogger *>::iterator it;
+    for(it = async_loggers.begin(); it != async_loggers.end(); it++){
+        pthread_mutex_unlock(&((*it)->lock_));
+    }
+    pthread_mutex_unlock(&async_loggers_lock);
+}
+
+void RotateLogger::AtForkChild()
+{
+    std::list<RotateLogger *>::iterator it;
+    for(it = async_loggers.begin(); it != async_loggers.end(); it++){
+        (*it)->ResetAsyncInChild();
+    }
+    async_loggers.clear();
+    pthread_mutex_unlock(&async_loggers_lock);
+}
+
+void RotateLogger::ResetAsyncInChild()
+{
+    // only the forking thread exists in the child, so there is neither 
+    // the write thread nor any other caller of LogAsync(). The records in 
+    // the ring belong to the parent, which writes them, so the child just 
+    // switches back to the synchronous mode. The ring is freed on the next 
+    // StartAsync() or the destructor
+    __atomic_store_n(&write_running_, false, __ATOMIC_RELAXED);
+    write_thread_id_ = 0;
+    __atomic_store_n(&async_writers_, 0, __ATOMIC_RELAXED);
+    
+    // the recursive lock held by the parent thread cannot be unlocked in 
+    // the child, whose thread id differs, so it's initialized again
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&lock_, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
     
 bool RotateLogger::IsTooLarge()
 {
@@ -1359,6 +1359,15 @@ int StreamSink::SourceStatistic(int timeout, MediaStatisticInfo * statistic, std
     statistic->ssrc = statistic_rep.ssrc();
     statistic->timestamp = statistic_rep.timestamp();    
     statistic->sum_bytes = statistic_rep.sum_bytes();
+    statistic->read_ahead_fill = statistic_rep.read_ahead_fill();
+    statistic->read_ahead_packets = statistic_rep.read_ahead_packets();
+    statistic->read_ahead_capacity = statistic_rep.read_ahead_capacity();
+    statistic->read_ahead_underruns = statistic_rep.read_ahead_underruns();
+    statistic->read_packets = statistic_rep.read_packets();
+    statistic->pacing_stretch = statistic_rep.pacing_stretch();
+    statistic->open_time = statistic_rep.open_time();
+    statistic->meta_time = statistic_rep.meta_time();
+    statistic->first_frame_time = statistic_rep.first_frame_time();
     statistic->sub_streams.reserve(statistic_rep.sub_stream_stats_size());
 
     ::google::protobuf::RepeatedPtrField< ::stream_switch::ProtoSubStreamMediaStatistic >::const_iterator it;    
@@ -1374,6 +1383,24 @@ int StreamSink::SourceStatistic(int timeout, MediaStatisticInfo * statistic, std
         sub_stream.data_frames = it->data_frames();        
         sub_stream.key_frames = it->key_frames();
         sub_stream.last_gov = it->last_gov();
+        sub_stream.lost_packets = it->lost_packets();
+        sub_stream.reordered_packets = it->reordered_packets();
+        sub_stream.late_packets = it->late_packets();
+        sub_stream.damaged_frames = it->damaged_frames();
+        sub_stream.jitter = it->jitter();
+        sub_stream.reorder_threshold = it->reorder_threshold();
+        sub_stream.reorder_delay = it->reorder_delay();
+        sub_stream.reorder_depth = it->reorder_depth();
+        sub_stream.pts_offset = it->pts_offset();
+        sub_stream.pts_drift = it->pts_drift();
+        sub_stream.paced_frames = it->paced_frames();
+        sub_stream.pacing_dropped_frames = it->pacing_dropped_frames();
+        sub_stream.pacing_late_frames = it->pacing_late_frames();
+        sub_stream.pacing_mean_error = it->pacing_mean_error();
+        sub_stream.pacing_max_error = it->pacing_max_error();
+        sub_stream.pacing_error_histogram.assign(
+            it->pacing_error_histogram().begin(), 
+            it->pacing_error_histogram().end());
         statistic->sub_streams.push_back(sub_stream); 
     }
     
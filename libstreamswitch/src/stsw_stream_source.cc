@@ -502,8 +502,19 @@ int StreamSource::SendLiveMediaFrame(const MediaFrameInfo &frame_info,
                                     const char * frame_data, 
                                     size_t frame_size, 
                                     std::string *err_info)
+{
+    MediaFrameSegment segment(frame_data, frame_size);
+    return SendLiveMediaFrameV(frame_info, &segment, 1, err_info);
+}
+
+int StreamSource::SendLiveMediaFrameV(const MediaFrameInfo &frame_info, 
+                                      const MediaFrameSegment * segments, 
+                                      int segment_num, 
+                                      std::string *err_info)
 {
     uint64_t seq;
+    size_t frame_size = 0;
+    int i;
 
     if(!IsInit()){
         SET_ERR_INFO(err_info, "Source not init");        
@@ -525,6 +536,14 @@ int StreamSource::SendLiveMediaFrame(const MediaFrameInfo &frame_info,
         return ERROR_CODE_PARAM;        
     }
     
+    if(segments == NULL && segment_num != 0){
+        SET_ERR_INFO(err_info, "segments invalid");
+        return ERROR_CODE_PARAM;        
+    }
+    for(i = 0; i < segment_num; i++){
+        frame_size += segments[i].size;
+    }
+    
     //
     // update the statistic
     //
@@ -588,7 +607,8 @@ int StreamSource::SendLiveMediaFrame(const MediaFrameInfo &frame_info,
     //
     // send out from publish socket
     //
-    SendPublishMsg((char *)STSW_PUBLISH_MEDIA_CHANNEL, media_msg, frame_data, frame_size);
+    SendPublishMsgV((char *)STSW_PUBLISH_MEDIA_CHANNEL, media_msg, 
+                    segments, segment_num);
         
     return 0;
 }
@@ -888,6 +908,15 @@ int StreamSource::StatisticHandler(const ProtoCommonPacket &request,
     statistic.set_timestamp(local_statistic.timestamp);
     statistic.set_ssrc(local_statistic.ssrc);
     statistic.set_sum_bytes(local_statistic.sum_bytes); 
+    statistic.set_read_ahead_fill(local_statistic.read_ahead_fill);
+    statistic.set_read_ahead_packets(local_statistic.read_ahead_packets);
+    statistic.set_read_ahead_capacity(local_statistic.read_ahead_capacity);
+    statistic.set_read_ahead_underruns(local_statistic.read_ahead_underruns);
+    statistic.set_read_packets(local_statistic.read_packets);
+    statistic.set_pacing_stretch(local_statistic.pacing_stretch);
+    statistic.set_open_time(local_statistic.open_time);
+    statistic.set_meta_time(local_statistic.meta_time);
+    statistic.set_first_frame_time(local_statistic.first_frame_time);
     
     for(it = local_statistic.sub_streams.begin(); 
         it != local_statistic.sub_streams.end();
@@ -903,6 +932,27 @@ int StreamSource::StatisticHandler(const ProtoCommonPacket &request,
         sub_stream_stat->set_key_frames(it->key_frames);
         sub_stream_stat->set_lost_frames(it->lost_frames);
         sub_stream_stat->set_last_gov(it->last_gov);            
+        sub_stream_stat->set_lost_packets(it->lost_packets);
+        sub_stream_stat->set_reordered_packets(it->reordered_packets);
+        sub_stream_stat->set_late_packets(it->late_packets);
+        sub_stream_stat->set_damaged_frames(it->damaged_frames);
+        sub_stream_stat->set_jitter(it->jitter);
+        sub_stream_stat->set_reorder_threshold(it->reorder_threshold);
+        sub_stream_stat->set_reorder_delay(it->reorder_delay);
+        sub_stream_stat->set_reorder_depth(it->reorder_depth);
+        sub_stream_stat->set_pts_offset(it->pts_offset);
+        sub_stream_stat->set_pts_drift(it->pts_drift);
+        sub_stream_stat->set_paced_frames(it->paced_frames);
+        sub_stream_stat->set_pacing_dropped_frames(it->pacing_dropped_frames);
+        sub_stream_stat->set_pacing_late_frames(it->pacing_late_frames);
+        sub_stream_stat->set_pacing_mean_error(it->pacing_mean_error);
+        sub_stream_stat->set_pacing_max_error(it->pacing_max_error);
+        std::vector<uint64_t>::iterator bucket_it;
+        for(bucket_it = it->pacing_error_histogram.begin();
+            bucket_it != it->pacing_error_histogram.end();
+            bucket_it++){
+            sub_stream_stat->add_pacing_error_histogram(*bucket_it);
+        }
     }// for(it = stream_meta_.sub_streams.begin();  
 
     if(debug_flags() & DEBUG_FLAG_DUMP_API){
@@ -1335,6 +1385,25 @@ void StreamSource::SendStreamInfo(void)
 void StreamSource::SendPublishMsg(char * channel_name, const ProtoCommonPacket &msg, 
                                   const char * extra_blob, size_t blob_size)
 {
+    MediaFrameSegment segment(extra_blob, blob_size);
+    if(extra_blob == NULL || blob_size == 0){
+        SendPublishMsgV(channel_name, msg, NULL, 0);
+    }else{
+        SendPublishMsgV(channel_name, msg, &segment, 1);
+    }
+}
+
+//Before invoke SendPublishMsgV(), the internal lock must be hold first.
+void StreamSource::SendPublishMsgV(char * channel_name, const ProtoCommonPacket &msg, 
+                                   const MediaFrameSegment * segments, 
+                                   int segment_num)
+{
+    size_t blob_size = 0;
+    int i;
+    for(i = 0; i < segment_num; i++){
+        blob_size += segments[i].size;
+    }
+    
     if(channel_name == NULL || strlen(channel_name) == 0){
         //no channel, just ignore
         return;
@@ -1360,8 +1429,18 @@ void StreamSource::SendPublishMsg(char * channel_name, const ProtoCommonPacket &
     zmsg_t *zmsg = zmsg_new ();
     zmsg_addstr(zmsg, channel_name);
     zmsg_addmem(zmsg, packet_data.data(), packet_data.size());
-    if(extra_blob != NULL && blob_size != 0){
-        zmsg_addmem(zmsg, extra_blob, blob_size);
+    if(blob_size != 0){
+        // copy each segment into the blob frame at its offset, so that 
+        // the segments need not be assembled first
+        zframe_t * blob_frame = zframe_new(NULL, blob_size);
+        byte * pos = zframe_data(blob_frame);
+        for(i = 0; i < segment_num; i++){
+            if(segments[i].size != 0){
+                memcpy(pos, segments[i].data, segments[i].size);
+                pos += segments[i].size;
+            }
+        }
+        zmsg_append(zmsg, &blob_frame);
     }
     zmsg_send (&zmsg, publish_socket_);
     
@@ -0,0 +1,228 @@
+/**
+ * This file is part of stsw_rtsp_port, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2015  OpenSight team (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+/**
+ * mp2p_bench.cc
+ *      a sample to measure the throughput of the MP2P (PS over RTP)
+ * packetizer: a H264 + PCMA stream is opened as a mp2p stsw resource, and
+ * the synthetic frames are parsed into RTP packets as fast as possible.
+ * The packets are discarded from the track queue after each frame, like
+ * an RTP session consuming them.
+ *
+ * author: OpenSight Team
+ * date: 2016-04-23
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "feng.h"
+#include "fnc_log.h"
+#include "bufferqueue.h"
+#include "media/demuxer.h"
+#include "media/mediaparser.h"
+
+#include "stream_switch.h"
+
+extern "C" {
+void demuxer_stsw_global_init(void);
+void demuxer_stsw_global_uninit(void);
+}
+
+#define BENCH_STREAM_NAME "mp2p_bench"
+#define BENCH_GOP 30
+#define BENCH_KEY_FRAME_SIZE 120000
+#define BENCH_FRAME_SIZE 12000
+#define BENCH_AUDIO_FRAME_SIZE 320
+
+
+///////////////////////////////////////////////////////////////
+//Type
+
+class BenchSourceListener:public stream_switch::SourceListener{
+public:
+    virtual void OnKeyFrame(void){};
+    virtual void OnMediaStatistic(stream_switch::MediaStatisticInfo *statistic){};
+};
+
+
+///////////////////////////////////////////////////////////////
+//functions
+
+static long long MonotonicNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int InitBenchSource(stream_switch::StreamSource *source,
+                           BenchSourceListener *listener)
+{
+    using namespace stream_switch;
+    std::string err_info;
+    StreamMetadata metadata;
+    SubStreamMetadata video;
+    SubStreamMetadata audio;
+
+    if(source->Init(BENCH_STREAM_NAME, 0, 0, listener, 0, &err_info)){
+        fprintf(stderr, "Init stream source error: %s\n", err_info.c_str());
+        return -1;
+    }
+
+    metadata.bps = 0;
+    metadata.play_type = STREAM_PLAY_TYPE_LIVE;
+    metadata.source_proto = "Bench";
+    metadata.ssrc = 0x12345678;
+    video.codec_name = "H264";
+    video.media_type = SUB_STREAM_MEIDA_TYPE_VIDEO;
+    video.sub_stream_index = 0;
+    video.direction = SUB_STREAM_DIRECTION_OUTBOUND;
+    video.media_param.video.height = 1080;
+    video.media_param.video.width = 1920;
+    video.media_param.video.fps = 25;
+    video.media_param.video.gov = BENCH_GOP;
+    metadata.sub_streams.push_back(video);
+    audio.codec_name = "PCMA";
+    audio.media_type = SUB_STREAM_MEIDA_TYPE_AUDIO;
+    audio.sub_stream_index = 1;
+    audio.direction = SUB_STREAM_DIRECTION_OUTBOUND;
+    audio.media_param.audio.samples_per_second = 8000;
+    audio.media_param.audio.channels = 1;
+    audio.media_param.audio.bits_per_sample = 8;
+    audio.media_param.audio.sampele_per_frame = BENCH_AUDIO_FRAME_SIZE;
+    metadata.sub_streams.push_back(audio);
+    source->set_stream_meta(metadata);
+    source->set_stream_state(SOURCE_STREAM_STATE_OK);
+
+    if(source->Start(&err_info)){
+        fprintf(stderr, "Start stream source error: %s\n", err_info.c_str());
+        source->Uninit();
+        return -1;
+    }
+    return 0;
+}
+
+
+///////////////////////////////////////////////////////////////
+//main entry
+int main(int argc, char *argv[])
+{
+    stream_switch::StreamSource source;
+    BenchSourceListener listener;
+    feng *srv;
+    Resource *r;
+    Track *tr;
+    std::vector<uint8_t> frame(BENCH_KEY_FRAME_SIZE);
+    int frame_num = 20000;
+    unsigned long long bytes = 0, packets = 0;
+    long long start, elapsed;
+    unsigned int seed = 1;
+    size_t i;
+    int ret = 0;
+
+    if(argc > 1){
+        frame_num = strtol(argv[1], NULL, 0);
+    }
+    if(frame_num <= 0){
+        fprintf(stderr, "Usage: mp2p_bench [frame_number]\n");
+        return 1;
+    }
+
+    fnc_log_init((char *)"", FNC_LOG_OUT, FNC_LOG_ERR, (char *)"mp2p_bench");
+    bq_init();
+    demuxer_stsw_global_init();
+
+    if(InitBenchSource(&source, &listener)){
+        demuxer_stsw_global_uninit();
+        return 1;
+    }
+
+    srv = g_new0(feng, 1);
+    srv->srvconf.buffered_frames = 2048;
+    srv->srvconf.default_stream_type = MP2P_STREAM;
+    srv->config_storage.document_root = buffer_init();
+    buffer_copy_string(srv->config_storage.document_root, "");
+    srv->loop = ev_default_loop(0);
+    srv->lock = g_mutex_new();
+
+    r = r_open(srv, "stsw/stream/" BENCH_STREAM_NAME);
+    if(r == NULL || r->tracks == NULL){
+        fprintf(stderr, "open mp2p resource failed\n");
+        ret = 1;
+        goto exit_1;
+    }
+    tr = (Track *)g_list_first(r->tracks)->data;
+
+    for(i = 0; i < frame.size(); i++){
+        frame[i] = (uint8_t)rand_r(&seed);
+    }
+
+    start = MonotonicNs();
+    for(int n = 0; n < frame_num; n++){
+        size_t len = (n % BENCH_GOP == 0) ? BENCH_KEY_FRAME_SIZE : BENCH_FRAME_SIZE;
+
+        //video frame as a single NAL
+        frame[0] = (n % BENCH_GOP == 0) ? 0x65 : 0x41;
+        tr->info->id = 0;
+        tr->properties.pts = tr->properties.dts = n * 0.04;
+        tr->properties.frame_type =
+            (n % BENCH_GOP == 0) ? FT_KEY_FRAME : FT_DATA_FRAME;
+        tr->parser->parse(tr, &frame[0], len);
+        bytes += len;
+
+        //audio frame
+        if(n % 2 == 0){
+            tr->info->id = 1;
+            tr->properties.pts = tr->properties.dts = n * 0.04 + 0.01;
+            tr->properties.frame_type = FT_DATA_FRAME;
+            tr->parser->parse(tr, &frame[100], BENCH_AUDIO_FRAME_SIZE);
+            bytes += BENCH_AUDIO_FRAME_SIZE;
+        }
+
+        //consume the RTP packets
+        packets += bq_producer_queue_length(tr->producer);
+        bq_producer_reset_queue(tr->producer);
+    }
+    elapsed = MonotonicNs() - start;
+
+    fprintf(stderr, "%d frames, %llu bytes -> %llu RTP packets in %lld us: "
+            "%.1f MB/s, %.0f packets/s\n",
+            frame_num, bytes, packets, elapsed / 1000,
+            (elapsed > 0) ? (double)bytes * 1000.0 / elapsed : 0.0,
+            (elapsed > 0) ? (double)packets * 1e9 / elapsed : 0.0);
+
+    r_close(r);
+
+exit_1:
+    buffer_free(srv->config_storage.document_root);
+    g_mutex_free(srv->lock);
+    g_free(srv);
+    source.Uninit();
+    demuxer_stsw_global_uninit();
+    return ret;
+}
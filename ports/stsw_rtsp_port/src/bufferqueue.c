@@ -197,6 +197,29 @@ struct BufferQueue_Producer {
      * @todo switch to a numeric hash
      */
     gchar *key;
+
+    /**
+     * @brief Maximum number of elements retained for the last GOP
+     *
+     * When non-zero, the elements starting from the last sync point
+     * (see @ref bq_producer_put_sync) are kept in the queue even when
+     * all the consumers have seen them, so that a newly-created
+     * consumer can start from there. A GOP longer than this value
+     * is not retained. Zero disables the retention.
+     */
+    guint gop_max;
+
+    /**
+     * @brief Link to the last sync point in the queue
+     *
+     * NULL if no sync point is currently retained.
+     */
+    GList *gop_head;
+
+    /**
+     * @brief Serial number of the element at @ref gop_head
+     */
+    gulong gop_serial;
 };
 
 /**
@@ -245,6 +268,16 @@ struct BufferQueue_Consumer {
      * before time, a copy of it is kept here.
      */
     BufferQueue_Element *current_element_object;
+
+    /**
+     * @brief Serial of the next element to be seen
+     *
+     * This is the serial number following the last element the
+     * consumer has seen in the current queue; it is used to pick up
+     * the right element once the consumer has reached the end of the
+     * queue, and to start a new consumer from the retained GOP.
+     */
+    gulong next_serial;
 };
 
 /**
@@ -332,6 +365,43 @@ static void bq_element_free_internal(gpointer elem_generic,
     g_slice_free(BufferQueue_Element, element);
 }
 
+/**
+ * @brief Reset the seen count of an element
+ *
+ * @param elem_generic Element to reset
+ * @param unused Unused
+ */
+static void bq_element_reset_seen_internal(gpointer elem_generic,
+                                           gpointer unused) {
+    ((BufferQueue_Element*)elem_generic)->seen = 0;
+}
+
+/**
+ * @brief Free the elements that are no longer needed at the head of
+ *        the queue
+ *
+ * @param producer Producer to trim the queue of
+ *
+ * The elements seen by all the consumers are removed from the head
+ * of the queue, up to the retained GOP (if any).
+ *
+ * @note This function has to be called with the producer's lock held.
+ */
+static void bq_producer_trim_internal(BufferQueue_Producer *producer) {
+    GList *head;
+
+    while ( (head = producer->queue->head) != NULL &&
+            head != producer->gop_head ) {
+        BufferQueue_Element *elem = (BufferQueue_Element*)(head->data);
+
+        if ( elem->seen < producer->consumers )
+            break;
+
+        bq_element_free_internal(elem, producer->free_function);
+        g_queue_pop_head(producer->queue);
+    }
+}
+
 /**
  * @brief Destroy a producer
  *
@@ -428,6 +498,7 @@ void bq_producer_reset_queue(BufferQueue_Producer *producer) {
     producer->queue = g_queue_new();
     producer->queue_serial++;
     producer->next_serial = 0;
+    producer->gop_head = NULL;
 
     /* Leave the exclusive access */
     g_mutex_unlock(producer->lock);
@@ -449,6 +520,28 @@ void bq_producer_reset_queue(BufferQueue_Producer *producer) {
  *       considered used and should not be freed manually.
  */
 void bq_producer_put(BufferQueue_Producer *producer, gpointer payload) {
+    bq_producer_put_sync(producer, payload, false);
+}
+
+/**
+ * @brief Adds a new buffer to the producer, marking sync points
+ *
+ * @param producer The producer to add the element to
+ * @param payload The buffer to link in the element
+ * @param sync_point true if the buffer starts a new GOP, that is a
+ *                   consumer can start decoding from it
+ *
+ * @note This function will require exclusive access to the producer,
+ *       and will thus lock its mutex.
+ *
+ * When the GOP retention is enabled (see @ref
+ * bq_producer_set_gop_retention), the elements from the last sync
+ * point on are kept in the queue for the consumers created later.
+ *
+ * @see bq_producer_put
+ */
+void bq_producer_put_sync(BufferQueue_Producer *producer, gpointer payload,
+                          gboolean sync_point) {
     BufferQueue_Element *elem;
 
     g_assert(payload != NULL);
@@ -468,10 +561,58 @@ void bq_producer_put(BufferQueue_Producer *producer, gpointer payload) {
 
     g_queue_push_tail(producer->queue, elem);
 
+    if ( producer->gop_max ) {
+        if ( sync_point ) {
+            producer->gop_head = producer->queue->tail;
+            producer->gop_serial = elem->serial;
+        } else if ( producer->gop_head &&
+                    elem->serial - producer->gop_serial >= producer->gop_max ) {
+            /* GOP too long to be retained, wait for the next one */
+            producer->gop_head = NULL;
+        }
+
+        bq_producer_trim_internal(producer);
+    }
+
     /* Leave the exclusive access */
     g_mutex_unlock(producer->lock);
 }
 
+/**
+ * @brief Enable or disable the GOP retention of a producer
+ *
+ * @param producer The producer to configure
+ * @param max_elements The maximum number of elements a retained GOP
+ *                     can be made of, 0 to disable the retention.
+ *
+ * @note This function will require exclusive access to the producer,
+ *       and will thus lock its mutex.
+ */
+void bq_producer_set_gop_retention(BufferQueue_Producer *producer,
+                                   unsigned max_elements) {
+    g_mutex_lock(producer->lock);
+
+    producer->gop_max = max_elements;
+    if ( !max_elements ) {
+        producer->gop_head = NULL;
+        bq_producer_trim_internal(producer);
+    }
+
+    g_mutex_unlock(producer->lock);
+}
+
+/**
+ * @brief Get the GOP retention limit of a producer
+ *
+ * @param producer The producer to check
+ *
+ * @return The maximum number of elements of a retained GOP, 0 if the
+ *         retention is disabled.
+ */
+unsigned bq_producer_gop_retention(BufferQueue_Producer *producer) {
+    return producer->gop_max;
+}
+
 
 /**
  * @brief Get the queue size of a producer
@@ -527,6 +668,21 @@ BufferQueue_Consumer *bq_consumer_new(BufferQueue_Producer *producer) {
 
     ret->producer = producer;
 
+    /* Start from the retained GOP, if any: the elements before it are
+     * accounted as seen by the new consumer.
+     */
+    if ( producer->gop_head ) {
+        GList *it;
+
+        for ( it = producer->queue->head; it != producer->gop_head; it = it->next )
+            ((BufferQueue_Element*)(it->data))->seen++;
+
+        ret->queue_serial = producer->queue_serial;
+        ret->next_serial = producer->gop_serial;
+
+        bq_producer_trim_internal(producer);
+    }
+
     /* Leave the exclusive access */
     g_mutex_unlock(producer->lock);
 
@@ -556,11 +712,17 @@ static void bq_consumer_elem_unref(BufferQueue_Consumer *consumer) {
     if ( producer->queue_serial != consumer->queue_serial )
         return;
 
+    consumer->next_serial = elem->serial + 1;
+
     /* If we're the last one to see the element, we need to take care
      * of removing and freeing it. */
     if ( ++elem->seen < producer->consumers )
         return;
 
+    /* Elements of the retained GOP are kept for the new consumers */
+    if ( producer->gop_head && elem->serial >= producer->gop_serial )
+        return;
+
     bq_element_free_internal(elem, producer->free_function);
 
     /* Make sure to lose reference to it */
@@ -606,6 +768,14 @@ void bq_consumer_free(BufferQueue_Consumer *consumer) {
     if ( --producer->consumers == 0 ) {
         if ( producer->stopped ) {
             g_cond_signal(producer->last_consumer);
+        } else if ( producer->queue && producer->gop_max ) {
+            /* Keep the retained GOP for the next consumer, nobody
+             * has seen anything now.
+             */
+            g_queue_foreach(producer->queue,
+                            bq_element_reset_seen_internal,
+                            NULL);
+            bq_producer_trim_internal(producer);
         } else if ( producer->queue ) {
             /* Decrement consumers and check, if we're the latest consumer, we
              * want to clean the queue up entirely!
@@ -614,27 +784,33 @@ void bq_consumer_free(BufferQueue_Consumer *consumer) {
                             bq_element_free_internal,
                             producer->free_function);
             g_queue_clear(producer->queue);
+            producer->gop_head = NULL;
         }
-    } else if ( consumer->current_element_object != NULL ) {
-        /* If we haven't removed the current selected element, it
-         * means that we have to decrease the seen count for all the
-         * elements before it.
+    } else if ( consumer->queue_serial == producer->queue_serial ) {
+        /* Decrease the seen count for all the elements we have seen
+         * and that are still in the queue.
          */
+        GList *it;
 
-        GList *it = consumer->current_element_pointer;
-        do {
+        for ( it = producer->queue->head; it != NULL; it = it->next ) {
             BufferQueue_Element *elem = (BufferQueue_Element*)(it->data);
 
+            if ( elem->serial >= consumer->next_serial )
+                break;
+
             /* If we were the last one to see this we would have
-             * deleted it, since we haven't, we expect that there will
-             * be at least another consumer waiting on it.
+             * deleted it, unless it's retained; either way there
+             * is at least another consumer expected on it.
              *
              * But let's be safe and assert this.
              */
-            g_assert_cmpuint(elem->seen, <=, producer->consumers);
+            g_assert_cmpuint(elem->seen, <=, producer->consumers + 1);
 
             elem->seen--;
-        } while ( (it = it->prev) != NULL );
+        }
+
+        /* The remaining consumers may have seen everything now */
+        bq_producer_trim_internal(producer);
     }
 
     /* Leave the exclusive access */
@@ -655,8 +831,7 @@ static gboolean bq_consumer_move_internal(BufferQueue_Consumer *consumer) {
     BufferQueue_Producer *producer = consumer->producer;
     GList *expected_next = NULL;
 
-    if ( (producer->queue_serial != consumer->queue_serial) ||
-         (!consumer->current_element_pointer)  ) {
+    if ( producer->queue_serial != consumer->queue_serial ) {
         /* If the last used queue does not correspond to the current
          * producer's queue, we have to take the head of the new
          * queue.
@@ -666,7 +841,21 @@ static gboolean bq_consumer_move_internal(BufferQueue_Consumer *consumer) {
          * serial 1).
          */
         expected_next = producer->queue->head;
-    } else if ( consumer->current_element_pointer ) {
+        consumer->next_serial = 0;
+    } else if ( !consumer->current_element_pointer ) {
+        /* We reached the end of the queue before, or we were started
+         * from the retained GOP: pick up from the first element we
+         * haven't seen yet, looking from the tail since it's usually
+         * the closest one.
+         */
+        GList *it = producer->queue->tail;
+
+        while ( it != NULL &&
+                ((BufferQueue_Element*)(it->data))->serial >= consumer->next_serial ) {
+            expected_next = it;
+            it = it->prev;
+        }
+    } else {
         expected_next = consumer->current_element_pointer->next;
 
         /* If there is any element at all saved, we take care of marking
@@ -720,8 +909,8 @@ gulong bq_consumer_unseen(BufferQueue_Consumer *consumer) {
         if ( consumer->current_element_object != NULL ) {
             g_assert_cmpint(unseen, >, consumer->current_element_object->serial);
             unseen -= consumer->current_element_object->serial;
-        } else if (!producer->queue->head){
-            unseen = 0;
+        } else {
+            unseen -= consumer->next_serial;
         }
     }
 
@@ -39,6 +39,11 @@ typedef struct BufferQueue_Consumer BufferQueue_Consumer;
 
 BufferQueue_Producer *bq_producer_new(GDestroyNotify free_function, gchar *key);
 void bq_producer_put(BufferQueue_Producer *producer, gpointer payload);
+void bq_producer_put_sync(BufferQueue_Producer *producer, gpointer payload,
+                          gboolean sync_point);
+void bq_producer_set_gop_retention(BufferQueue_Producer *producer,
+                                   unsigned max_elements);
+unsigned bq_producer_gop_retention(BufferQueue_Producer *producer);
 void bq_producer_reset_queue(BufferQueue_Producer *producer);
 void bq_producer_unref(BufferQueue_Producer *producer);
 unsigned bq_producer_queue_length(BufferQueue_Producer *producer);
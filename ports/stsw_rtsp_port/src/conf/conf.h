@@ -91,6 +91,9 @@ typedef struct {
     unsigned short max_mbps;
     unsigned short rtcp_heartbeat;
     unsigned short default_stream_type;
+    unsigned short gop_cache;
+    unsigned short catchup_rate;
+    unsigned short edl_lookahead;
     
     unsigned int stsw_debug_flags;
 
@@ -231,6 +231,18 @@ static gboolean command_environment(feng *srv, int argc, char **argv)
     
     srv->srvconf.stsw_debug_flags = 
         strtol(parser.OptionValue("debug-flags", "0").c_str(), NULL, 0);
+        
+    srv->srvconf.gop_cache = 0;
+    if(parser.CheckOption("enable-gop-cache")){
+        srv->srvconf.gop_cache = 1;
+    }
+    srv->srvconf.catchup_rate = 
+        strtol(parser.OptionValue("catchup-rate", "125").c_str(), NULL, 0);
+    if(srv->srvconf.catchup_rate < 100){
+        srv->srvconf.catchup_rate = 100;
+    }
+    srv->srvconf.edl_lookahead = 
+        strtol(parser.OptionValue("edl-lookahead", "1").c_str(), NULL, 0);
     
     std::string stream_type = 
         parser.OptionValue("stream-type", "raw");
@@ -107,6 +107,7 @@ void reset_track(gpointer element, gpointer user_data)
     if(track->producer){
         bq_producer_reset_queue(track->producer);
     }
+    track->in_frame = FALSE;
     
     if(track->parser && track->parser->reset){
         track->parser->reset(track);
@@ -42,6 +42,7 @@ struct feng;
 #define RESOURCE_TRACK_NOT_FOUND -4
 #define RESOURCE_NOT_PARSEABLE -5
 #define RESOURCE_EOF -6
+#define RESOURCE_AGAIN -7   // no data ready yet, read again later
 
 #define MAX_TRACKS 20
 #define MAX_SEL_TRACKS 5
@@ -139,6 +140,8 @@ typedef struct Resource {
 
     void * rtsp_sess;
     double lastTimestamp;
+    /* the client wants key frames only (trick play), set on PLAY */
+    int only_key_frame;
 
     MediaReadModel model;
 } Resource;
@@ -198,6 +201,10 @@ typedef struct Track {
     uint32_t packetTotalNum;
     int producer_freed;
 
+    /** TRUE if the last buffer written to the producer was not the
+     *  end of a frame, used to find the start of the key frames */
+    gboolean in_frame;
+
     void *private_data; /* private data of media parser */
 
     GSList *sdp_fields;
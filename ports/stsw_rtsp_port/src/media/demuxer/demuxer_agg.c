@@ -46,6 +46,14 @@ static const DemuxerInfo info = {
     "",
     "db"
 };
+/* prefetch state of edl item */
+enum {
+    EDL_PREFETCH_NONE = 0,  /* not prefetched */
+    EDL_PREFETCH_PENDING,   /* the prefetch worker is opening it */
+    EDL_PREFETCH_CANCELLED, /* the worker is opening it, but it's not wanted */
+    EDL_PREFETCH_DONE       /* opened and seeked to file_start */
+};
+
 typedef struct edl_item_elems{
     Resource *r;
     double begin;	//from begin of list, in seconds
@@ -53,10 +61,20 @@ typedef struct edl_item_elems{
     double file_start;  // the offset of begin point within the file 
     char filename[FILE_PATHNAME_MAX_LEN]; //inner path name
     int index;
+    
+    /* prefetch, protected by edl_priv_datas::lock */
+    int prefetch_state;
+    Resource *prefetched;   // opened by the prefetch worker, not switched in yet
+    int prefetch_ret;       // the seek result of the prefetched resource
 }edl_item_elems;
 typedef struct edl_priv_datas{
     GList *head;
     GList *active;
+    
+    /* open the next items on a worker thread ahead of the boundary */
+    GThreadPool *prefetch_pool;
+    GMutex *lock;
+    int lookahead;          // how many items to prefetch, 0 means disabled
 }edl_priv_datas;
 typedef struct Filele {
     char filename[FILE_PATHNAME_MAX_LEN]; //inner path name
@@ -115,6 +133,8 @@ static void destroy_list_data(gpointer elem,
     {
        if(item->r)
        r_close(item->r);
+       if(item->prefetched)
+       r_close(item->prefetched);
     }
     g_free(elem);
 }
@@ -645,10 +665,170 @@ static void edl_buffer_switcher(edl_item_elems *new_item,edl_item_elems *old_ite
 
 }
 
-static int open_and_seek_file(GList *newActive, double seek_time,Resource * r)
+/**
+ * @brief Prefetch worker, open the item's resource and seek to its begin
+ *
+ * It runs in the prefetch pool thread and only touches the new resource, 
+ * which is not visible to the event loop until it's switched in.
+ */
+static void edl_prefetch_cb(gpointer item_p, gpointer r_p)
+{
+    edl_item_elems *item = (edl_item_elems *)item_p;
+    Resource *r = (Resource *)r_p;
+    edl_priv_datas *data = (edl_priv_datas *)r->private_data;
+    Resource *res;
+    int ret = RESOURCE_DAMAGED;
+    int cancelled = 0;
+
+    /* seek positions the demuxer to the key frame at file_start, 
+     * so that the first GOP is ready to read after switching */
+    if((res = r_open(r->srv, item->filename)) != NULL) {
+        ret = res->demuxer->seek(res, item->file_start);
+    }
+
+    g_mutex_lock(data->lock);
+    if(item->prefetch_state == EDL_PREFETCH_CANCELLED) {
+        item->prefetch_state = EDL_PREFETCH_NONE;
+        cancelled = 1;
+    }else{
+        item->prefetched = res;
+        item->prefetch_ret = ret;
+        item->prefetch_state = EDL_PREFETCH_DONE;
+    }
+    g_mutex_unlock(data->lock);
+
+    if(cancelled && res) {
+        r_close(res);
+    }
+
+    fnc_log(FNC_LOG_DEBUG, "[agg] prefetch %s %s\n", 
+            item->filename, 
+            cancelled ? "cancelled" : (res ? "done" : "failed"));
+}
+
+/**
+ * @brief Schedule prefetch for the items following the active one
+ *
+ * The prefetched resources which are out of the look-ahead window 
+ * (e.g. after seek) are released.
+ */
+static void edl_prefetch_update(Resource * r)
+{
+    edl_priv_datas *data = (edl_priv_datas *)r->private_data;
+    GList *node;
+    GSList *dropped = NULL, *it;
+    int distance = -1;  /* distance from the active item */
+
+    if(data->prefetch_pool == NULL || data->active == NULL) {
+        return;
+    }
+
+    g_mutex_lock(data->lock);
+    for(node = data->head; node != NULL; node = g_list_next(node)) {
+        edl_item_elems *item = (edl_item_elems *)node->data;
+
+        if(node == data->active) {
+            distance = 0;
+            continue;
+        }
+        if(distance >= 0) {
+            distance++;
+        }
+
+        if(distance > 0 && distance <= data->lookahead) {
+            if(item->r == NULL && 
+               item->prefetch_state == EDL_PREFETCH_NONE) {
+                item->prefetch_state = EDL_PREFETCH_PENDING;
+                g_thread_pool_push(data->prefetch_pool, item, NULL);
+            }else if(item->prefetch_state == EDL_PREFETCH_CANCELLED) {
+                /* wanted again before the worker finished */
+                item->prefetch_state = EDL_PREFETCH_PENDING;
+            }
+        }else if(item->prefetch_state == EDL_PREFETCH_PENDING) {
+            item->prefetch_state = EDL_PREFETCH_CANCELLED;
+        }else if(item->prefetch_state == EDL_PREFETCH_DONE) {
+            if(item->prefetched) {
+                dropped = g_slist_prepend(dropped, item->prefetched);
+                item->prefetched = NULL;
+            }
+            item->prefetch_state = EDL_PREFETCH_NONE;
+        }
+    }
+    g_mutex_unlock(data->lock);
+
+    /* closing a resource may take a while, not under the lock */
+    for(it = dropped; it != NULL; it = g_slist_next(it)) {
+        r_close((Resource *)it->data);
+    }
+    g_slist_free(dropped);
+}
+
+/**
+ * @brief Take the prefetched resource of the item
+ *
+ * Never waits for the worker, if the prefetch is on the way, 
+ * *pending is set and the caller should try again later. 
+ *
+ * @return the prefetched resource, NULL if the item is not prefetched
+ */
+static Resource *edl_prefetch_take(Resource * r, edl_item_elems *item, 
+                                   int *seek_ret, int *pending)
+{
+    edl_priv_datas *data = (edl_priv_datas *)r->private_data;
+    Resource *res = NULL;
+
+    *pending = 0;
+    if(data->prefetch_pool == NULL) {
+        return NULL;
+    }
+
+    g_mutex_lock(data->lock);
+    if(item->prefetch_state == EDL_PREFETCH_PENDING) {
+        *pending = 1;
+    }else if(item->prefetch_state == EDL_PREFETCH_DONE) {
+        res = item->prefetched;
+        *seek_ret = item->prefetch_ret;
+        item->prefetched = NULL;
+        item->prefetch_state = EDL_PREFETCH_NONE;
+    }
+    g_mutex_unlock(data->lock);
+
+    return res;
+}
+
+/**
+ * @brief Drop the on-going prefetch of the item
+ *
+ * The worker closes the resource when it's done.
+ */
+static void edl_prefetch_cancel(Resource * r, edl_item_elems *item)
+{
+    edl_priv_datas *data = (edl_priv_datas *)r->private_data;
+
+    if(data->prefetch_pool == NULL) {
+        return;
+    }
+
+    g_mutex_lock(data->lock);
+    if(item->prefetch_state == EDL_PREFETCH_PENDING) {
+        item->prefetch_state = EDL_PREFETCH_CANCELLED;
+    }
+    g_mutex_unlock(data->lock);
+}
+
+/**
+ * @brief Switch to the item and seek to seek_time
+ *
+ * @param may_retry if the item is still being prefetched, return 
+ *                  RESOURCE_AGAIN instead of opening it on the caller thread
+ */
+static int open_and_seek_file(GList *newActive, double seek_time,Resource * r,
+                              gboolean may_retry)
 {
     edl_item_elems *new_item = NULL, *old_item = NULL;
     int ret;
+    int seeked = 0;
+    int pending = 0;
     if(newActive == NULL){
         return RESOURCE_EOF;
     }
@@ -664,7 +844,17 @@ static int open_and_seek_file(GList *newActive, double seek_time,Resource * r)
      
         if(!(new_item->r))
         {
-            if(!(new_item->r = r_open(r->srv, new_item->filename)))
+            /* it's just a pointer swap if the item is prefetched */
+            new_item->r = edl_prefetch_take(r, new_item, &ret, &pending);
+            if(new_item->r != NULL && seek_time == new_item->file_start) {
+                seeked = 1;
+            }else if(pending) {
+                if(may_retry)
+                    return RESOURCE_AGAIN;
+                edl_prefetch_cancel(r, new_item);
+            }
+            if(!(new_item->r) && 
+               !(new_item->r = r_open(r->srv, new_item->filename)))
                 return RESOURCE_DAMAGED;
             new_item->r->timescaler = edl_timescalers;
             new_item->r->edl = r;
@@ -680,8 +870,10 @@ static int open_and_seek_file(GList *newActive, double seek_time,Resource * r)
         }        
     }
 
+    if(!seeked)
     ret = new_item->r->demuxer->seek(new_item->r,seek_time);
     ((edl_priv_datas *) r->private_data)->active = newActive;
+    edl_prefetch_update(r);
 
 	return ret;
 }
@@ -762,6 +954,16 @@ static int agg_init(Resource * r)
     r->info->duration = r_offset;
     ((edl_priv_datas *) r->private_data)->head = g_list_reverse(edl_head);
     ((edl_priv_datas *) r->private_data)->active = g_list_first(((edl_priv_datas *) r->private_data)->head);
+
+    /* prefetch the following items in background, --edl-lookahead */
+    ((edl_priv_datas *) r->private_data)->lookahead = srv->srvconf.edl_lookahead;
+    if(srv->srvconf.edl_lookahead > 0 && n > 1) {
+        edl_priv_datas *data = (edl_priv_datas *) r->private_data;
+        data->lock = g_mutex_new();
+        data->prefetch_pool = g_thread_pool_new(edl_prefetch_cb, r, 
+                                                1, FALSE, NULL);
+        edl_prefetch_update(r);
+    }
     free_temp_file_list(temp_list_head);
     temp_list_head = NULL;
     temp_node = NULL;
@@ -816,7 +1018,9 @@ static int agg_read_packet(Resource * r)
 		if(nextActive)
 		{
 			item = (edl_item_elems *)nextActive->data;
-			res = open_and_seek_file(nextActive,item->file_start,r);
+			/* the next item is still being opened in background, 
+			 * don't stall the event loop, read it next time */
+			res = open_and_seek_file(nextActive,item->file_start,r,TRUE);
 			if(res) {
 				return res;
 			}
@@ -850,7 +1054,7 @@ static int agg_seek(Resource * r, double time_sec)
 			{
 				seek_time = time_sec - res_item->begin + res_item->file_start;
 				fnc_log(FNC_LOG_DEBUG, "seek time %f\n",seek_time);
-                ret = open_and_seek_file(node,seek_time,r);
+                ret = open_and_seek_file(node,seek_time,r,FALSE);
                 if(ret == RESOURCE_OK)
                 {
                     r->lastTimestamp = time_sec;
@@ -867,6 +1071,15 @@ static void agg_uninit(gpointer rgen)
     Resource *r = rgen;
     GList *edl_head = NULL;
     if (r->private_data){
+        edl_priv_datas *data = (edl_priv_datas *) r->private_data;
+
+        /* drop the queued prefetch and wait for the running one */
+        if (data->prefetch_pool) {
+            g_thread_pool_free(data->prefetch_pool, TRUE, TRUE);
+            data->prefetch_pool = NULL;
+            g_mutex_free(data->lock);
+        }
+
         edl_head = ((edl_priv_datas *) r->private_data)->head;
     
         if (edl_head) {
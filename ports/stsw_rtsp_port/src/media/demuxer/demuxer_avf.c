@@ -24,6 +24,7 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <sys/stat.h>
 
 #include "feng_utils.h"
 #include "fnc_log.h"
@@ -31,6 +32,7 @@
 #include "feng.h"
 
 #include "media/demuxer_module.h"
+#include "media/key_index.h"
 
 #include <libavformat/avformat.h>
 
@@ -68,6 +70,9 @@ static const id_tag id_tags[] = {
    { CODEC_ID_NONE, 0, "NONE"}//XXX ...
 };
 
+/* max packets to read after a key frame jump to get the key frame */
+#define KIDX_MAX_JUMP_READ 64
+
 typedef struct lavf_priv{
 //    AVInputFormat *avif;
     AVFormatContext *avfc;
@@ -75,6 +80,21 @@ typedef struct lavf_priv{
 //    int audio_streams;
 //    int video_streams;
     int64_t last_pts; //Use it or not?
+    
+    /* key frame index of the video stream, NULL until it's available.
+     * If the container has no index and there is no sidecar file, 
+     * it's built by scanning the file on the index thread */
+    key_index *kidx;
+    GMutex *kidx_lock;
+    GThreadPool *kidx_pool;
+    volatile gint kidx_cancel;
+    gchar *mrl;
+    int video_index;
+
+    int next_key;           /* the key frame entry to read next in 
+                             * key frame only mode, -1 if unknown */
+    double last_video_time; /* time of the last video packet read, 
+                             * in seconds of the stream time */
 } lavf_priv_t;
 
 static const char *tag_from_id(int id)
@@ -99,6 +119,200 @@ static int pt_from_id(int id)
     return 0;
 }
 
+/* key frame index */
+
+/**
+ * @brief Get the key frame index from the index of the container
+ */
+static key_index *kidx_from_container(AVStream *st)
+{
+    key_index *kidx;
+    int i;
+
+    kidx = key_index_new(st->index, st->time_base.num, st->time_base.den);
+    for (i = 0; i < st->nb_index_entries; i++) {
+        AVIndexEntry *ie = &st->index_entries[i];
+        if (ie->flags & AVINDEX_KEYFRAME)
+            key_index_append(kidx, ie->pos, ie->timestamp);
+    }
+    if (kidx->num == 0) {
+        key_index_free(kidx);
+        return NULL;
+    }
+    return kidx;
+}
+
+/**
+ * @brief Build the key frame index by reading the whole file once
+ *
+ * It opens the file by itself, so that it can run out of the event loop
+ * while the demuxer is reading. 
+ *
+ * @return the index, NULL if cancelled or no key frame
+ */
+static key_index *kidx_scan(const char *mrl, int stream_index, 
+                            volatile gint *cancel)
+{
+    AVFormatContext *avfc = NULL;
+    key_index *kidx = NULL;
+    AVStream *st;
+    AVPacket pkt;
+
+    if (avformat_open_input(&avfc, mrl, NULL, NULL))
+        return NULL;
+    if (avformat_find_stream_info(avfc, NULL) < 0 ||
+        stream_index >= (int)avfc->nb_streams)
+        goto out;
+
+    st = avfc->streams[stream_index];
+    kidx = key_index_new(stream_index, st->time_base.num, st->time_base.den);
+
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+    while (!g_atomic_int_get(cancel) && av_read_frame(avfc, &pkt) >= 0) {
+        if (pkt.stream_index == stream_index &&
+            (pkt.flags & AV_PKT_FLAG_KEY)) {
+            int64_t ts = (pkt.pts != AV_NOPTS_VALUE) ? pkt.pts : pkt.dts;
+            if (ts != AV_NOPTS_VALUE)
+                key_index_append(kidx, pkt.pos, ts);
+        }
+        av_free_packet(&pkt);
+    }
+
+    if (g_atomic_int_get(cancel) || kidx->num == 0) {
+        key_index_free(kidx);
+        kidx = NULL;
+    }
+
+ out:
+    avformat_close_input(&avfc);
+    return kidx;
+}
+
+/**
+ * @brief Index thread, scan the file and save the sidecar file
+ */
+static void kidx_build_cb(ATTR_UNUSED gpointer mrl, gpointer priv_p)
+{
+    lavf_priv_t *priv = (lavf_priv_t *)priv_p;
+    key_index *kidx;
+    struct stat st;
+    gchar *path;
+
+    if (stat(priv->mrl, &st))
+        return;
+
+    kidx = kidx_scan(priv->mrl, priv->video_index, &priv->kidx_cancel);
+    if (kidx == NULL)
+        return;
+
+    fnc_log(FNC_LOG_DEBUG, "[avf] %u key frames indexed for %s",
+            kidx->num, priv->mrl);
+    path = g_strconcat(priv->mrl, KEY_INDEX_SUFFIX, NULL);
+    key_index_save(kidx, path, st.st_size, st.st_mtime);
+    g_free(path);
+
+    g_mutex_lock(priv->kidx_lock);
+    priv->kidx = kidx;
+    g_mutex_unlock(priv->kidx_lock);
+}
+
+/**
+ * @brief Get the key frame index of the video stream
+ *
+ * Try the index of the container, then the sidecar file. Otherwise the 
+ * file is scanned on the index thread, and the index is not available
+ * until it's done.
+ */
+static void kidx_open(lavf_priv_t *priv, const char *mrl)
+{
+    AVFormatContext *avfc = priv->avfc;
+    key_index *kidx;
+    struct stat st;
+    gchar *path;
+    unsigned int i;
+
+    priv->video_index = -1;
+    priv->kidx_lock = g_mutex_new();
+    for (i = 0; i < avfc->nb_streams; i++) {
+        if (avfc->streams[i]->codec->codec_type == AVMEDIA_TYPE_VIDEO) {
+            priv->video_index = i;
+            break;
+        }
+    }
+    if (priv->video_index < 0)
+        return;
+
+    if ((priv->kidx = kidx_from_container(avfc->streams[priv->video_index])))
+        return;
+
+    if (stat(mrl, &st) || !S_ISREG(st.st_mode))
+        return;
+
+    path = g_strconcat(mrl, KEY_INDEX_SUFFIX, NULL);
+    kidx = key_index_load(path, st.st_size, st.st_mtime);
+    g_free(path);
+    if (kidx != NULL) {
+        if (kidx->stream_index == priv->video_index) {
+            priv->kidx = kidx;
+            return;
+        }
+        key_index_free(kidx);
+    }
+
+    priv->mrl = g_strdup(mrl);
+    priv->kidx_pool = g_thread_pool_new(kidx_build_cb, priv, 1, FALSE, NULL);
+    if (priv->kidx_pool)
+        g_thread_pool_push(priv->kidx_pool, priv->mrl, NULL);
+}
+
+static key_index *kidx_get(lavf_priv_t *priv)
+{
+    key_index *kidx;
+
+    if (priv->kidx_lock == NULL)
+        return NULL;
+    g_mutex_lock(priv->kidx_lock);
+    kidx = priv->kidx;
+    g_mutex_unlock(priv->kidx_lock);
+    return kidx;
+}
+
+static void kidx_close(lavf_priv_t *priv)
+{
+    if (priv->kidx_pool) {
+        /* stop the scan and wait for the index thread */
+        g_atomic_int_set(&priv->kidx_cancel, 1);
+        g_thread_pool_free(priv->kidx_pool, TRUE, TRUE);
+        priv->kidx_pool = NULL;
+    }
+    key_index_free(priv->kidx);
+    priv->kidx = NULL;
+    if (priv->kidx_lock) {
+        g_mutex_free(priv->kidx_lock);
+        priv->kidx_lock = NULL;
+    }
+    g_free(priv->mrl);
+    priv->mrl = NULL;
+}
+
+/**
+ * @brief Position the demuxer at the given key frame directly
+ */
+static int kidx_seek_entry(AVFormatContext *avfc, const key_index *kidx,
+                           unsigned int i)
+{
+    const key_index_entry *e = &kidx->entries[i];
+
+    if (e->pos >= 0 && !(avfc->iformat->flags & AVFMT_NO_BYTE_SEEK))
+        return av_seek_frame(avfc, kidx->stream_index, e->pos, 
+                             AVSEEK_FLAG_BYTE);
+
+    return av_seek_frame(avfc, kidx->stream_index, e->ts, 
+                         AVSEEK_FLAG_BACKWARD);
+}
+
 #define PROBE_BUF_SIZE 2048
 
 static int avf_probe(const char *filename)
@@ -319,6 +533,9 @@ static int avf_init(Resource * r)
     if (track) {
 
         fnc_log(FNC_LOG_DEBUG, "[avf] duration %f", r->info->duration);
+        kidx_open(priv, r->info->mrl);
+        priv->next_key = -1;
+        priv->last_video_time = -1.0;
         r->private_data = priv;
         r->timescaler = avf_timescaler;
         return RESOURCE_OK;
@@ -340,6 +557,55 @@ err_alloc:
     return ERR_PARSE;
 }
 
+/**
+ * @brief Read the next packet
+ *
+ * In key frame only mode with the key frame index, jump to the next key
+ * frame directly instead of reading all the packets between them.
+ */
+static int avf_read_frame(lavf_priv_t *priv, int only_key_frame, 
+                          AVPacket *pkt)
+{
+    key_index *kidx = kidx_get(priv);
+    AVStream *st;
+    unsigned int i;
+    int n;
+
+    if (!only_key_frame || kidx == NULL) {
+        if (av_read_frame(priv->avfc, pkt) < 0)
+            return -1;
+        if (pkt->stream_index == priv->video_index &&
+            pkt->dts != AV_NOPTS_VALUE) {
+            st = priv->avfc->streams[pkt->stream_index];
+            priv->last_video_time = pkt->dts * av_q2d(st->time_base);
+            priv->next_key = -1;
+        }
+        return 0;
+    }
+
+    if (priv->next_key >= 0)
+        i = priv->next_key;
+    else
+        i = key_index_next(kidx, priv->last_video_time);
+    if (i >= kidx->num)
+        return -1;
+
+    if (kidx_seek_entry(priv->avfc, kidx, i) < 0)
+        return -1;
+    priv->next_key = i + 1;
+    priv->last_video_time = key_index_time(kidx, i);
+
+    /* the key frame is the first video packet after jump */
+    for (n = 0; n < KIDX_MAX_JUMP_READ; n++) {
+        if (av_read_frame(priv->avfc, pkt) < 0)
+            return -1;
+        if (pkt->stream_index == kidx->stream_index)
+            return 0;
+        av_free_packet(pkt);
+    }
+    return -1;
+}
+
 static int avf_read_packet(Resource * r)
 {
     int ret = RESOURCE_OK;
@@ -354,7 +620,7 @@ static int avf_read_packet(Resource * r)
     pkt.data = NULL;
     pkt.size = 0;
 
-    if(av_read_frame(priv->avfc, &pkt) < 0)
+    if(avf_read_frame(priv, r->only_key_frame, &pkt) < 0)
         return RESOURCE_EOF; //FIXME
     for (tr_it = g_list_first(r->tracks);
          tr_it !=NULL;
@@ -461,7 +727,9 @@ static int avf_seek(Resource * r, double time_sec)
     int flags = 0;
     int64_t time_msec = time_sec * AV_TIME_BASE;
     fnc_log(FNC_LOG_DEBUG, "Seeking to %f", time_sec);
-    AVFormatContext *fc = ((lavf_priv_t *)r->private_data)->avfc;
+    lavf_priv_t *priv = (lavf_priv_t *)r->private_data;
+    AVFormatContext *fc = priv->avfc;
+    key_index *kidx = kidx_get(priv);
     if (fc->start_time != AV_NOPTS_VALUE)
         time_msec += fc->start_time;
     if (time_msec < 0) flags = AVSEEK_FLAG_BACKWARD;
@@ -469,6 +737,20 @@ static int avf_seek(Resource * r, double time_sec)
     r->lastTimestamp = time_sec;
 #endif
 
+    /* resolve the seek with the key frame index, no scanning */
+    if (kidx) {
+        unsigned int i = key_index_lookup(kidx, 
+                                          (double)time_msec / AV_TIME_BASE);
+        int ret = kidx_seek_entry(fc, kidx, i);
+        if (ret >= 0) {
+            priv->next_key = i;
+            priv->last_video_time = key_index_time(kidx, i);
+            return ret;
+        }
+    }
+    priv->next_key = -1;
+    priv->last_video_time = -1.0;
+
     return av_seek_frame(fc, -1, time_msec, flags);
 }
 
@@ -479,6 +761,7 @@ static void avf_uninit(gpointer rgen)
 
 // avf stuff
     if (priv) {
+        kidx_close(priv);
         if (priv->avfc) {
             avformat_close_input(&(priv->avfc));
             priv->avfc = NULL;
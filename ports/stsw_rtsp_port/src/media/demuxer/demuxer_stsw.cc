@@ -33,6 +33,7 @@
 
 #include "media/demuxer.h"
 #include "media/demuxer_module.h"
+#include "media/demuxer/demuxer_stsw.h"
 #include "network/rtp.h"
 #include "network/rtsp.h"
 
@@ -57,48 +58,6 @@ void demuxer_stsw_global_uninit(void);
 #endif
 
 
-///////////////////////////////////////////////////
-// DemuxerStreamSink prototype
-
-class DemuxerSinkListener:public stream_switch::SinkListener{
-  
-public:
-    DemuxerSinkListener(std::string stream_name, Resource * resource);
-    virtual ~DemuxerSinkListener();
-
-
-    virtual void OnLiveMediaFrame(const stream_switch::MediaFrameInfo &frame_info, 
-                                  const char * frame_data, 
-                                  size_t frame_size);    
-                                  
-    virtual void OnMetadataMismatch(uint32_t mismatch_ssrc);    
-
-       
-private: 
-    std::string stream_name_;    
-    Resource * resource_;
-        
-};
-
-
-
-typedef struct stsw_priv_type{
-    stream_switch::StreamSink * sink;
-    DemuxerSinkListener *listener;
-
-    int stream_type;
-  
-    //for live stream time scaler
-    /** Real-time timestamp when to start the playback */
-    double playback_time;
-    int has_sync;
-    double delta_time;
-    
-    double init_time;
-    
-} stsw_priv_type;
-
-
 ///////////////////////////////////////////////////
 // DemuxerStreamSink Implementation
 DemuxerSinkListener::DemuxerSinkListener(std::string stream_name, Resource * resource)
@@ -184,6 +143,12 @@ void DemuxerSinkListener::OnLiveMediaFrame(const stream_switch::MediaFrameInfo &
                 tr->properties.frame_type = FT_UNKONW;
                 break;
             }
+            if(streamType != RAW_STREAM && 
+               frame_info.sub_stream_index != priv->key_stream_index &&
+               tr->properties.frame_type == FT_KEY_FRAME){
+                //for muxed stream, only the video key frame can start a GOP
+                tr->properties.frame_type = FT_DATA_FRAME;
+            }
             
             if(bq_producer_queue_length(tr->producer) >= 
                 (unsigned)resource_->srv->srvconf.buffered_frames){
@@ -367,6 +332,56 @@ static double stsw_timescaler (Resource *r, double res_time) {
     return res_time;
 }
 
+/**
+ * @brief Start the sink before PLAY to cache the latest GOP
+ *
+ * The track producers retain the buffers from the last key frame on, 
+ * so that the RTP sessions can start from there as soon as the client
+ * plays, instead of waiting for the next key frame.
+ */
+static int stsw_prime(Resource * r)
+{
+    std::string err_info;
+    stsw_priv_type *priv = (stsw_priv_type *)r->private_data;
+    TrackList tr_it;
+    int ret;
+    
+    for (tr_it = g_list_first(r->tracks);
+         tr_it !=NULL;
+         tr_it = g_list_next(tr_it)) {
+        Track *tr = (Track*)tr_it->data;
+        //keep the GOP below half of the buffer queue limit
+        bq_producer_set_gop_retention(tr->producer, 
+                                      r->srv->srvconf.buffered_frames / 2);
+    }
+    
+    //the frames is sync to the init time, and it keeps on for PLAY
+    priv->playback_time = priv->init_time;
+    priv->delta_time = 0;
+    priv->has_sync = 0;
+    priv->init_time = -1;
+
+    ret = priv->sink->Start(&err_info);
+    if(ret){
+        fnc_log(FNC_LOG_ERR, "[stsw] Fail to start the StreamSwitch Sink(%d): %s\n", 
+                ret, err_info.c_str());
+        return RESOURCE_DAMAGED;                
+    }
+    
+    ret = priv->sink->KeyFrame(DEMUXER_STSW_METADATA_TIMEOUT, 
+                               &err_info);
+    if(ret){
+        fnc_log(FNC_LOG_ERR, "[stsw] Fail to request the key frame(%d): %s\n", 
+                ret, err_info.c_str());
+        priv->sink->Stop();
+        return RESOURCE_DAMAGED;                
+    }
+    
+    fnc_log(FNC_LOG_DEBUG, "[stsw] sink started to prime the GOP cache\n");    
+    
+    return RESOURCE_OK;
+}
+
 static int stsw_init(Resource * r)
 {
     using namespace stream_switch;    
@@ -414,6 +429,7 @@ static int stsw_init(Resource * r)
     priv->sink = new StreamSink();
     priv->listener = new DemuxerSinkListener(stream_name, r);
     priv->stream_type = r->srv->srvconf.default_stream_type;
+    priv->key_stream_index = -1;
     priv->init_time = -1;
     it = params.find(std::string("stream_type"));
     if(it != params.end()){
@@ -526,6 +542,7 @@ static int stsw_init(Resource * r)
             }
         }
         if(videoAvailable != -1) {
+            priv->key_stream_index = videoAvailable;
             r->private_data = priv;
             if (!(track = add_track(r, &trackinfo, &props))){
                 goto error_1;
@@ -634,10 +651,20 @@ static int stsw_init(Resource * r)
     r->timescaler = stsw_timescaler;
     r->private_data = priv;
     
+    if(r->info->media_source == MS_live && r->srv->srvconf.gop_cache){
+        //GOP cache is enabled, start the sink right now to prime the 
+        //tracks with the latest GOP before PLAY
+        ret = stsw_prime(r);
+        if(ret){
+            goto error_1;
+        }
+    }
+    
     return RESOURCE_OK;
  
 error_1:
 
+    r->private_data = NULL;
     if(priv != NULL){
         if(priv->sink != NULL){
             priv->sink->Uninit();
@@ -726,6 +753,7 @@ static int stsw_start(Resource * r)
             priv->playback_time = range->playback_time;
             priv->delta_time = 0;
             priv->has_sync = 0;              
+            r->lastTimestamp = 0.0;
                     
             if(priv->init_time > 0){
                 // first play                    
@@ -0,0 +1,86 @@
+/**
+ * This file is part of stsw_rtsp_port, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2015  OpenSight team (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+/**
+ * @file demuxer_stsw.h
+ * private data of the stsw demuxer resource, which is shared with
+ * the parsers working on the stsw resource only (e.g. mp2p)
+ */
+
+#ifndef FN_DEMUXER_STSW_H
+#define FN_DEMUXER_STSW_H
+
+#include <string>
+
+#include "media/demuxer.h"
+
+#include "stream_switch.h"
+
+
+///////////////////////////////////////////////////
+// DemuxerStreamSink prototype
+
+class DemuxerSinkListener:public stream_switch::SinkListener{
+
+public:
+    DemuxerSinkListener(std::string stream_name, Resource * resource);
+    virtual ~DemuxerSinkListener();
+
+
+    virtual void OnLiveMediaFrame(const stream_switch::MediaFrameInfo &frame_info,
+                                  const char * frame_data,
+                                  size_t frame_size);
+
+    virtual void OnMetadataMismatch(uint32_t mismatch_ssrc);
+
+
+private:
+    std::string stream_name_;
+    Resource * resource_;
+
+};
+
+
+
+typedef struct stsw_priv_type{
+    stream_switch::StreamSink * sink;
+    DemuxerSinkListener *listener;
+
+    int stream_type;
+
+    //for live stream time scaler
+    /** Real-time timestamp when to start the playback */
+    double playback_time;
+    int has_sync;
+    double delta_time;
+
+    double init_time;
+
+    //the sub stream whose key frames start a GOP for a muxed stream
+    int key_stream_index;
+
+} stsw_priv_type;
+
+
+#endif // FN_DEMUXER_STSW_H
@@ -0,0 +1,239 @@
+/**
+ * This file is part of stsw_rtsp_port, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2015  OpenSight team (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <glib.h>
+
+#include "fnc_log.h"
+#include "media/key_index.h"
+
+/*
+ * sidecar file layout, all big-endian
+ *
+ *  0  magic "STSWKIDX"
+ *  8  u32 version
+ * 12  u32 entry number
+ * 16  i64 size of the media file
+ * 24  i64 mtime of the media file
+ * 32  i32 stream index
+ * 36  i32 time base numerator
+ * 40  i32 time base denominator
+ * 44  i32 reserved
+ * 48  entries: i64 pos, i64 ts
+ */
+#define KEY_INDEX_MAGIC "STSWKIDX"
+#define KEY_INDEX_VERSION 2
+#define KEY_INDEX_HEADER_SIZE 48
+#define KEY_INDEX_ENTRY_SIZE 16
+/* sanity limit of the entry number of a sidecar file */
+#define KEY_INDEX_MAX_NUM (16 * 1024 * 1024)
+
+static void put_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static void put_be64(uint8_t *p, uint64_t v)
+{
+    put_be32(p, (uint32_t)(v >> 32));
+    put_be32(p + 4, (uint32_t)v);
+}
+
+static uint32_t get_be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static uint64_t get_be64(const uint8_t *p)
+{
+    return ((uint64_t)get_be32(p) << 32) | get_be32(p + 4);
+}
+
+key_index *key_index_new(int stream_index, int tb_num, int tb_den)
+{
+    key_index *kidx = g_new0(key_index, 1);
+
+    kidx->stream_index = stream_index;
+    kidx->tb_num = tb_num;
+    kidx->tb_den = tb_den;
+    return kidx;
+}
+
+void key_index_free(key_index *kidx)
+{
+    if (kidx) {
+        g_free(kidx->entries);
+        g_free(kidx);
+    }
+}
+
+void key_index_append(key_index *kidx, int64_t pos, int64_t ts)
+{
+    if (kidx->num > 0 && ts <= kidx->entries[kidx->num - 1].ts)
+        return;
+
+    if (kidx->num >= kidx->alloc_num) {
+        kidx->alloc_num = kidx->alloc_num ? kidx->alloc_num * 2 : 256;
+        kidx->entries = g_renew(key_index_entry, kidx->entries,
+                                kidx->alloc_num);
+    }
+    kidx->entries[kidx->num].pos = pos;
+    kidx->entries[kidx->num].ts = ts;
+    kidx->num++;
+}
+
+double key_index_time(const key_index *kidx, unsigned int i)
+{
+    return (double)kidx->entries[i].ts * kidx->tb_num / kidx->tb_den;
+}
+
+unsigned int key_index_lookup(const key_index *kidx, double time_sec)
+{
+    unsigned int low = 0, high = kidx->num;
+
+    while (high - low > 1) {
+        unsigned int mid = (low + high) / 2;
+        if (key_index_time(kidx, mid) <= time_sec)
+            low = mid;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+unsigned int key_index_next(const key_index *kidx, double time_sec)
+{
+    unsigned int low = 0, high = kidx->num;
+
+    while (low < high) {
+        unsigned int mid = (low + high) / 2;
+        if (key_index_time(kidx, mid) <= time_sec)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+key_index *key_index_load(const char *path,
+                          int64_t file_size, int64_t file_mtime)
+{
+    uint8_t header[KEY_INDEX_HEADER_SIZE];
+    uint8_t *buf = NULL;
+    key_index *kidx = NULL;
+    uint32_t num, i;
+    int tb_num, tb_den;
+    FILE *fp = fopen(path, "rb");
+
+    if (!fp)
+        return NULL;
+
+    if (fread(header, sizeof(header), 1, fp) != 1 ||
+        memcmp(header, KEY_INDEX_MAGIC, 8) != 0 ||
+        get_be32(header + 8) != KEY_INDEX_VERSION ||
+        (int64_t)get_be64(header + 16) != file_size ||
+        (int64_t)get_be64(header + 24) != file_mtime)
+        goto out;
+
+    num = get_be32(header + 12);
+    tb_num = (int32_t)get_be32(header + 36);
+    tb_den = (int32_t)get_be32(header + 40);
+    if (num == 0 || num > KEY_INDEX_MAX_NUM || tb_den == 0)
+        goto out;
+
+    buf = g_malloc((gsize)num * KEY_INDEX_ENTRY_SIZE);
+    if (fread(buf, KEY_INDEX_ENTRY_SIZE, num, fp) != num)
+        goto out;
+
+    kidx = key_index_new((int32_t)get_be32(header + 32), tb_num, tb_den);
+    kidx->entries = g_new(key_index_entry, num);
+    kidx->alloc_num = num;
+    for (i = 0; i < num; i++) {
+        kidx->entries[i].pos = (int64_t)get_be64(buf + i * KEY_INDEX_ENTRY_SIZE);
+        kidx->entries[i].ts = (int64_t)get_be64(buf + i * KEY_INDEX_ENTRY_SIZE + 8);
+    }
+    kidx->num = num;
+
+ out:
+    g_free(buf);
+    fclose(fp);
+    return kidx;
+}
+
+int key_index_save(const key_index *kidx, const char *path,
+                   int64_t file_size, int64_t file_mtime)
+{
+    gsize size = KEY_INDEX_HEADER_SIZE +
+                 (gsize)kidx->num * KEY_INDEX_ENTRY_SIZE;
+    uint8_t *buf;
+    gchar *tmp_path;
+    FILE *fp;
+    unsigned int i;
+    int ret = -1;
+
+    buf = g_malloc0(size);
+    memcpy(buf, KEY_INDEX_MAGIC, 8);
+    put_be32(buf + 8, KEY_INDEX_VERSION);
+    put_be32(buf + 12, kidx->num);
+    put_be64(buf + 16, (uint64_t)file_size);
+    put_be64(buf + 24, (uint64_t)file_mtime);
+    put_be32(buf + 32, (uint32_t)kidx->stream_index);
+    put_be32(buf + 36, (uint32_t)kidx->tb_num);
+    put_be32(buf + 40, (uint32_t)kidx->tb_den);
+    for (i = 0; i < kidx->num; i++) {
+        uint8_t *p = buf + KEY_INDEX_HEADER_SIZE + i * KEY_INDEX_ENTRY_SIZE;
+        put_be64(p, (uint64_t)kidx->entries[i].pos);
+        put_be64(p + 8, (uint64_t)kidx->entries[i].ts);
+    }
+
+    tmp_path = g_strconcat(path, ".tmp", NULL);
+    if ((fp = fopen(tmp_path, "wb")) == NULL) {
+        /* the storage may be read-only */
+        fnc_log(FNC_LOG_DEBUG, "[kidx] Cannot write key frame index %s", path);
+        goto out;
+    }
+    if (fwrite(buf, size, 1, fp) != 1) {
+        fclose(fp);
+        unlink(tmp_path);
+        goto out;
+    }
+    fclose(fp);
+    /* replace it atomically, for the concurrent opens */
+    if (rename(tmp_path, path)) {
+        unlink(tmp_path);
+        goto out;
+    }
+    ret = 0;
+
+ out:
+    g_free(tmp_path);
+    g_free(buf);
+    return ret;
+}
@@ -0,0 +1,109 @@
+/**
+ * This file is part of stsw_rtsp_port, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2015  OpenSight team (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+/**
+ * @file key_index.h
+ * key frame index of a stored media file, used by the file demuxers
+ * to seek and to jump between key frames (trick play) without scanning.
+ *
+ * The index can be saved in a sidecar file next to the media file
+ * (mrl + KEY_INDEX_SUFFIX). All the fields of the sidecar file are
+ * big-endian, so that it can be shared between hosts.
+ */
+
+#ifndef FN_KEY_INDEX_H
+#define FN_KEY_INDEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define KEY_INDEX_SUFFIX ".kidx"
+
+typedef struct key_index_entry {
+    int64_t pos;    /* byte offset of the key frame packet, -1 if unknown */
+    int64_t ts;     /* timestamp in the time base of the stream */
+} key_index_entry;
+
+typedef struct key_index {
+    int stream_index;       /* the indexed (video) stream */
+    int tb_num;             /* time base of ts */
+    int tb_den;
+    unsigned int num;
+    unsigned int alloc_num;
+    key_index_entry *entries; /* in timestamp order */
+} key_index;
+
+key_index *key_index_new(int stream_index, int tb_num, int tb_den);
+
+void key_index_free(key_index *kidx);
+
+/**
+ * @brief Append a key frame, the ones not after the last entry are ignored
+ */
+void key_index_append(key_index *kidx, int64_t pos, int64_t ts);
+
+/**
+ * @brief Time of the entry in seconds
+ */
+double key_index_time(const key_index *kidx, unsigned int i);
+
+/**
+ * @brief Find the last key frame at or before the given time
+ *
+ * @return the entry index, or 0 if time is before the first one
+ */
+unsigned int key_index_lookup(const key_index *kidx, double time_sec);
+
+/**
+ * @brief Find the first key frame after the given time
+ *
+ * @return the entry index, or kidx->num if no more key frame
+ */
+unsigned int key_index_next(const key_index *kidx, double time_sec);
+
+/**
+ * @brief Load the index from the sidecar file at path
+ *
+ * @return the index, NULL if the file is missing, damaged or stale
+ *         (the size/mtime of the media file do not match)
+ */
+key_index *key_index_load(const char *path,
+                          int64_t file_size, int64_t file_mtime);
+
+/**
+ * @brief Save the index to the sidecar file at path atomically
+ *
+ * @return 0 on success, -1 on error (e.g. read-only storage)
+ */
+int key_index_save(const key_index *kidx, const char *path,
+                   int64_t file_size, int64_t file_mtime);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FN_KEY_INDEX_H
@@ -107,12 +107,39 @@ void mparser_buffer_write(Track *tr,
                           gboolean marker,
                           uint8_t *data, size_t data_size)
 {
+    struct iovec iov;
 
+    iov.iov_base = data;
+    iov.iov_len = data_size;
+    mparser_buffer_writev(tr, presentation, delivery, duration, marker,
+                          &iov, 1);
+}
+
+void mparser_buffer_writev(Track *tr,
+                           double presentation,
+                           double delivery,
+                           double duration,
+                           gboolean marker,
+                           const struct iovec *iov, int iovcnt)
+{
+    size_t data_size = 0;
+    uint8_t *p;
+    int i;
+
+    /* with GOP retention the last GOP is buffered even if 
+     * there is no consumer yet */
     if(tr != NULL && tr->producer != NULL &&
-       bq_producer_consumer_num(tr->producer) > 0) {
+       (bq_producer_consumer_num(tr->producer) > 0 || 
+        bq_producer_gop_retention(tr->producer) > 0)) {
  
 
+    for (i = 0; i < iovcnt; i++)
+        data_size += iov[i].iov_len;
+
     MParserBuffer *buffer = g_malloc(sizeof(MParserBuffer) + data_size);
+    /* the first buffer of a key frame is where a consumer can start */
+    gboolean sync_point = 
+        (tr->properties.frame_type == FT_KEY_FRAME && !tr->in_frame);
 
     buffer->timestamp = presentation;
     buffer->delivery = delivery;
@@ -120,9 +147,14 @@ void mparser_buffer_write(Track *tr,
     buffer->marker = marker;
     buffer->data_size = data_size;
 
-    memcpy(buffer->data, data, data_size);
+    p = buffer->data;
+    for (i = 0; i < iovcnt; i++) {
+        memcpy(p, iov[i].iov_base, iov[i].iov_len);
+        p += iov[i].iov_len;
+    }
 
-    bq_producer_put(tr->producer, buffer);
+    bq_producer_put_sync(tr->producer, buffer, sync_point);
+    tr->in_frame = !marker;
 
 
     tr->parent->lastTimestamp = presentation;
@@ -31,6 +31,7 @@ extern "C" {
 
 #include <glib.h>
 #include <stdint.h>
+#include <sys/uio.h>
 
 #include "demuxer.h"
 #include "feng_utils.h"
@@ -109,6 +110,20 @@ void mparser_buffer_write(struct Track *tr,
                           gboolean marker,
                           uint8_t *data, size_t data_size);
 
+/**
+ * @brief Write a packet gathered from several slices
+ *
+ * Same as mparser_buffer_write() but the packet data is made of the
+ * given slices, which are copied into the buffer once, so that the parser
+ * does not need to assemble them in an intermediate buffer.
+ */
+void mparser_buffer_writev(struct Track *tr,
+                           double presentation,
+                           double delivery,
+                           double duration,
+                           gboolean marker,
+                           const struct iovec *iov, int iovcnt);
+
 
 #define DEFAULT_MTU 1440
 
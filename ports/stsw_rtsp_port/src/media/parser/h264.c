@@ -29,6 +29,7 @@
 #include "media/mediaparser_module.h"
 
 #include "network/rtsp.h"
+#include "stsw_nal_scanner.h"
 
 
 static const MediaParserInfo info = {
@@ -156,16 +157,16 @@ static char *encode_avc1_header(uint8_t *p, unsigned int len, int packet_mode)
 
 static char *encode_header(uint8_t *data, unsigned int len, int packet_mode)
 {
-    uint8_t *q = NULL, *p = NULL;
+    uint8_t *p = NULL;
+    const uint8_t *pos = NULL;
+    StswNalUnit nal;
     char *sprop = NULL;
-    int nal_size = 0;
     uint8_t *sps = NULL;
     int sps_size = 0;    
     uint8_t *pps = NULL;
     int pps_size = 0;   
     char* sprop_sps = NULL;
     char* sprop_pps = NULL;   
-    uint8_t nal_unit_type;
     
 /*    
         fnc_log(FNC_LOG_DEBUG, "[h264] header len %d",
@@ -184,33 +185,18 @@ static char *encode_header(uint8_t *data, unsigned int len, int packet_mode)
     }
     
     //find sps, pps
-    while (p < (data + len - 4)) {
-        for (q = (p+4); q<(data+len-4);q++) {
-            if (q[0] == 0 && q[1] == 0 && q[2] == 0 && q[3] == 1) {
-                break;
-            }
-        }
-
-        if (q >= (data + len - 4)) {
-            /* no next start_code, this is the last nal */
-            nal_size = data + len - p - 4;
-        }else{
-            nal_size = q - p - 4;
-        }
-                
-        nal_unit_type = p[4]&0x1F;
-        
-        switch(nal_unit_type){
+    pos = data;
+    while (stsw_next_nal_unit(&pos, data + len, 264, &nal)) {
+        switch(nal.type){
         case 7:
-            sps = p + 4;
-            sps_size = nal_size;
+            sps = (uint8_t *)nal.data;
+            sps_size = nal.size;
             break;
         case 8:
-            pps = p + 4;
-            pps_size = nal_size;
+            pps = (uint8_t *)nal.data;
+            pps_size = nal.size;
             break;            
         }        
-        p = q;
     }//while
     
     if(sps == NULL ||pps == NULL){
@@ -429,7 +415,9 @@ static int h264_parse(Track *tr, uint8_t *data, size_t len)
     h264_priv *priv = tr->private_data;
 //    double nal_time; // see page 9 and 7.4.1.2
     size_t nalsize = 0, index = 0;
-    uint8_t *p, *q;
+    uint8_t *p;
+    const uint8_t *pos;
+    StswNalUnit nal;
 
     if (priv->is_avc) {
         while (1) {
@@ -460,27 +448,10 @@ static int h264_parse(Track *tr, uint8_t *data, size_t len)
         p = data;
         if(p[0] == 0 && p[1] == 0 && p[2] == 0 && p[3]  == 1){
             /*it's a ES stream of h264 */
-            while (1) {
-               //seek to the next startcode [0 0 0 1]
-                for (q = (p+4); q<(data+len-4);q++) {
-                    if (q[0] == 0 && q[1] == 0 && q[2] == 0 && q[3] == 1) {
-                        break;
-                    }
-                }
-
-                if (q >= data + len - 4) {
-                    /* no next start_code, this is the last nal */
-                    break;
-                }
-                
-                h264_send_nal(tr,  p + 4, (q - p - 4));
-                p = q;
-
+            pos = data;
+            while (stsw_next_nal_unit(&pos, data + len, 264, &nal)) {
+                h264_send_nal(tr, (uint8_t *)nal.data, nal.size);
             }
-            // last NAL
-            fnc_log(FNC_LOG_VERBOSE, "[h264] last NAL %d",p[0]&0x1f);
-            
-            h264_send_nal(tr,  p + 4, (data + len - p - 4));
             
         }else{
             /* this is directry a nal */      
@@ -28,6 +28,7 @@
 #include "media/mediaparser_module.h"
 
 #include "network/rtsp.h"
+#include "stsw_nal_scanner.h"
 
 
 static const MediaParserInfo info = {
@@ -101,17 +102,16 @@ static void frag_fu_a(uint8_t *nal, int fragsize, int mtu,
 
 static char *encode_header(uint8_t *data, unsigned int len)
 {
-    uint8_t *q = NULL;
     uint8_t *p = NULL;
+    const uint8_t *pos = NULL;
+    StswNalUnit nal;
     char *sprop = NULL;
-    uint8_t nal_unit_type;
     uint8_t *vps = NULL;
     int vps_size = 0;
     uint8_t *sps = NULL;
     int sps_size = 0;    
     uint8_t *pps = NULL;
     int pps_size = 0;   
-    int nal_size = 0;
     uint8_t* profileTierLevelHeaderBytes = NULL;
     unsigned profileSpace  = 0;
     unsigned profileId = 0;
@@ -138,39 +138,22 @@ static char *encode_header(uint8_t *data, unsigned int len)
     }
     
     //find vps, sps, pps
-    while (p < (data + len - 4)) {
-        for (q = (p+4); q<(data+len-4);q++) {
-            if (q[0] == 0 && q[1] == 0 && q[2] == 0 && q[3] == 1) {
-                break;
-            }
-        }
-
-        if (q >= (data + len - 4)) {
-            /* no next start_code, this is the last nal */
-            nal_size = data + len - p - 4;
-        }else{
-            nal_size = q - p - 4;
-        }
-                
-        //h264_send_nal(tr,  p + 4, (q - p - 4));
-        //get a nal(p+4, q - p -4);
-        nal_unit_type = (p[4] & 0x7E) >> 1;
-        
-        switch(nal_unit_type){
+    pos = data;
+    while (stsw_next_nal_unit(&pos, data + len, 265, &nal)) {
+        switch(nal.type){
         case 32:
-            vps = p + 4;
-            vps_size = nal_size;
+            vps = (uint8_t *)nal.data;
+            vps_size = nal.size;
             break;
         case 33:
-            sps = p + 4;
-            sps_size = nal_size;
+            sps = (uint8_t *)nal.data;
+            sps_size = nal.size;
             break;
         case 34:
-            pps = p + 4;
-            pps_size = nal_size;
+            pps = (uint8_t *)nal.data;
+            pps_size = nal.size;
             break;            
         }        
-        p = q;
     }//while
 
     if(vps == NULL || sps == NULL || pps == NULL){
@@ -326,33 +309,18 @@ static int h265_parse(Track *tr, uint8_t *data, size_t len)
 {
     h264_priv *priv = tr->private_data;
     size_t nalsize = 0, index = 0;
-    uint8_t *p, *q;
+    uint8_t *p;
+    const uint8_t *pos;
+    StswNalUnit nal;
 
 
     p = data;
     if(p[0] == 0 && p[1] == 0 && p[2] == 0 && p[3]  == 1){
         /* it's a ES stream of h264 with start_code */
-        while (1) {
-            //seek to the next startcode [0 0 0 1]
-            for (q = (p+4); q<(data+len-4);q++) {
-                if (q[0] == 0 && q[1] == 0 && q[2] == 0 && q[3] == 1) {
-                    break;
-                }
-            }
-
-            if (q >= data + len - 4) {
-                /* no next start_code, this is the last nal */
-                break;
-            }
-                
-            h265_send_nal(tr,  p + 4, (q - p - 4));
-            p = q;
-
+        pos = data;
+        while (stsw_next_nal_unit(&pos, data + len, 265, &nal)) {
+            h265_send_nal(tr, (uint8_t *)nal.data, nal.size);
         }
-        // last NAL
-        fnc_log(FNC_LOG_VERBOSE, "[h264] last NAL %d",p[0]&0x1f);
-            
-        h265_send_nal(tr,  p + 4, (data + len - p - 4));
             
     }else{
             /* this is directry a nal */      
@@ -29,6 +29,7 @@
 #include "media/demuxer.h"
 #include "media/mediaparser.h"
 #include "media/mediaparser_module.h"
+#include "media/demuxer/demuxer_stsw.h"
 #include "put_bits.h"
 #include "network/rtsp.h"
 
@@ -39,6 +40,11 @@
 #define MP2P_MAX_STREAM_NUM 8
 #define MP2P_MAX_PES_SIZE 8192
 
+#define MP2P_PACK_HEADER_SIZE 14
+#define MP2P_SYS_HEADERS_MAX_SIZE 256
+#define MP2P_PES_HEADER_MAX_SIZE 32
+#define MP2P_FRAG_MAX_SLICES 16
+#define MP2P_FRAG_HEADER_BUF_SIZE 512
 
 
 #define AUDIO_ID 0xc0
@@ -54,6 +60,8 @@
 
 
 
+class PsFragWriter;
+
 class StreamParser{
 public:
 
@@ -86,14 +94,20 @@ protected:
     StreamParser(const std::string &codec_name, uint8_t stream_id, uint8_t stream_type, 
                  int media_type, int max_buffer_size/* in bytes */);
     virtual int EncodePes(Track *track, uint8_t *data, size_t len, 
-                        bool is_key_frame,
-                       uint8_t *buf, size_t bufSize, size_t maxSize);
+                          bool is_key_frame, PsFragWriter *writer);
     
     std::string codec_name_;
     uint8_t stream_id_;
     uint8_t stream_type_;
     int media_type_;
     int max_buffer_size_;
+    
+    // PES header templates, only the length, stuffing and PTS fields 
+    // need to be patched for each PES
+    uint8_t pes_first_header_[MP2P_PES_HEADER_MAX_SIZE];
+    int pes_first_header_size_;
+    uint8_t pes_header_[MP2P_PES_HEADER_MAX_SIZE];
+    int pes_header_size_;
 };
 
 
@@ -116,29 +130,12 @@ typedef struct {
     int stream_num;
     StreamParser * streams[MP2P_MAX_STREAM_NUM];
     int gov_start; // if the parser has seen GOV start flag, gov_start would be set to 1
-} mp2p_priv;
-
-
-class DemuxerSinkListener;
-
-typedef struct stsw_priv_type{
-    stream_switch::StreamSink * sink;
-    DemuxerSinkListener *listener;
-
-    int stream_type;
-  
-    //for live stream time scaler
-    /** Real-time timestamp when to start the playback */
-    double playback_time;
-    int has_sync;
-    double delta_time;
     
-    
-} stsw_priv_type;
-
-
-
-static void mp2p_rtp_frag(Track *tr, uint8_t *data, size_t len);
+    /* header templates, which are built at init */
+    uint8_t pack_header[MP2P_PACK_HEADER_SIZE];
+    uint8_t sys_headers[MP2P_SYS_HEADERS_MAX_SIZE]; /* system header + map */
+    int sys_headers_size;
+} mp2p_priv;
 
 
 
@@ -560,6 +557,132 @@ static void put_word(uint32_t word, uint8_t *buf)
     buf[i++] = (word) & 0xff;
 }
 
+/* patch the SCR of the pack header template, SCR extension is 0 */
+static inline void patch_pack_scr(uint8_t *buf, int64_t timestamp)
+{
+    buf[4] = 0x44 | (uint8_t)(((timestamp >> 30) & 0x07) << 3) |
+             (uint8_t)((timestamp >> 28) & 0x03);
+    buf[5] = (uint8_t)((timestamp >> 20) & 0xff);
+    buf[6] = 0x04 | (uint8_t)(((timestamp >> 15) & 0x1f) << 3) |
+             (uint8_t)((timestamp >> 13) & 0x03);
+    buf[7] = (uint8_t)((timestamp >> 5) & 0xff);
+    buf[8] = 0x04 | (uint8_t)((timestamp & 0x1f) << 3);
+    buf[9] = 0x01;
+}
+
+/* patch the PTS field (PTS_DTS_flags == 10b) of the PES header template */
+static inline void patch_pes_pts(uint8_t *buf, int64_t pts)
+{
+    buf[0] = 0x21 | (uint8_t)(((pts >> 30) & 0x07) << 1);
+    buf[1] = (uint8_t)((pts >> 22) & 0xff);
+    buf[2] = 0x01 | (uint8_t)(((pts >> 15) & 0x7f) << 1);
+    buf[3] = (uint8_t)((pts >> 7) & 0xff);
+    buf[4] = 0x01 | (uint8_t)((pts & 0x7f) << 1);
+}
+
+
+/* PS fragment writer 
+ * 
+ * Assemble the PS stream of a frame into RTP fragments (DEFAULT_MTU each) 
+ * directly from the slices of the headers and the frame payload, so that 
+ * the payload is copied only once, into the RTP fragments
+ */
+class PsFragWriter{
+public:
+    PsFragWriter(Track *tr)
+    :tr_(tr), iovcnt_(0), frag_size_(0), total_size_(0), header_used_(0)
+    {
+    }
+    
+    /* the header would be copied */
+    void PutHeader(const uint8_t *header, size_t len)
+    {
+        while(len > 0) {
+            size_t n;
+            Reserve();
+            n = MIN(len, DEFAULT_MTU - frag_size_);
+            if(header_used_ + n > sizeof(header_buf_)) {
+                Flush(0);
+                continue;
+            }
+            memcpy(header_buf_ + header_used_, header, n);
+            AddSlice(header_buf_ + header_used_, n);
+            header_used_ += n;
+            header += n;
+            len -= n;
+        }
+    }
+    
+    /* the payload is only referenced until it's flushed */
+    void PutPayload(const uint8_t *data, size_t len)
+    {
+        while(len > 0) {
+            size_t n;
+            Reserve();
+            n = MIN(len, DEFAULT_MTU - frag_size_);
+            AddSlice(data, n);
+            data += n;
+            len -= n;
+        }
+    }
+    
+    /* flush the last fragment with marker */
+    void Finish()
+    {
+        if(frag_size_ > 0) {
+            Flush(1);
+        }
+    }
+    
+    size_t total_size()
+    {
+        return total_size_;
+    }
+    
+private:
+    /* a full fragment is flushed only when more data comes, 
+     * so that the last fragment of the frame always has the marker */
+    void Reserve()
+    {
+        if(frag_size_ >= DEFAULT_MTU || iovcnt_ >= MP2P_FRAG_MAX_SLICES) {
+            Flush(0);
+        }
+    }
+    
+    void AddSlice(const uint8_t *data, size_t len)
+    {
+        iov_[iovcnt_].iov_base = (void *)data;
+        iov_[iovcnt_].iov_len = len;
+        iovcnt_++;
+        frag_size_ += len;
+        total_size_ += len;
+    }
+    
+    void Flush(gboolean marker)
+    {
+        if(iovcnt_ == 0) {
+            return;
+        }
+        mparser_buffer_writev(tr_,
+                              tr_->properties.pts,
+                              tr_->properties.dts,
+                              tr_->properties.frame_duration,
+                              marker,
+                              iov_, iovcnt_);
+        iovcnt_ = 0;
+        frag_size_ = 0;
+        header_used_ = 0;
+    }
+    
+    Track *tr_;
+    struct iovec iov_[MP2P_FRAG_MAX_SLICES];
+    int iovcnt_;
+    size_t frag_size_;
+    size_t total_size_;
+    uint8_t header_buf_[MP2P_FRAG_HEADER_BUF_SIZE];
+    size_t header_used_;
+};
+
 static inline uint64_t pts2PSTimpstamp(Track *tr, 
                                        double pts)
 {
@@ -609,7 +732,16 @@ StreamParser::StreamParser(const std::string &codec_name,
 :codec_name_(codec_name), stream_id_(stream_id), stream_type_(stream_type),
 media_type_(media_type), max_buffer_size_(max_buffer_size)
 {
-    
+    /* the first PES of a frame has PTS and PES extension, 
+     * the following ones have none */
+    pes_first_header_size_ = 
+        put_pes_header(stream_id_, 0, 0, 1, 
+                       (media_type_ == stream_switch::SUB_STREAM_MEIDA_TYPE_VIDEO) ? 1 : 0, 
+                       2, 0, 0, max_buffer_size_, 
+                       pes_first_header_, sizeof(pes_first_header_));
+    pes_header_size_ = 
+        put_pes_header(stream_id_, 0, 0, 0, 0, 0, 0, 0, max_buffer_size_, 
+                       pes_header_, sizeof(pes_header_));
 }
 
 
@@ -617,181 +749,116 @@ int StreamParser::Parse(Track *tr, uint8_t *data, size_t len)
 {
     using namespace stream_switch;
     mp2p_priv * priv = NULL;
-    int ret;
-    uint8_t *buf;
-    size_t maxBufSize,bufSize;
     int64_t timestamp;
-    int retSize;
     bool is_key_frame;
+    int onlyKeyFrame = 0;
+    uint8_t pack_header[MP2P_PACK_HEADER_SIZE];
 
     priv = (mp2p_priv *)tr->private_data;
-   
-    
-    /* malloc space*/
-    maxBufSize = 0;
-    maxBufSize += 256; /* pack, system, map header size */
-    maxBufSize += ((len + priv->packet_size -100 -1)/ (priv->packet_size -100)) * 256; /* pes headers */
-    maxBufSize += len;
-    maxBufSize += 1024; /* add 1 K extraly */
-    buf = (uint8_t *)g_malloc(maxBufSize);
-    if(buf == NULL) {
-        fnc_log(FNC_LOG_ERR, "[mp2p] StreamParser.parse() malloc failed");
-        ret = RESOURCE_DAMAGED;
-        goto error1;
-    }
-    memset(buf, 0, maxBufSize);
-    bufSize = 0;
-
-    timestamp = pts2PSTimpstamp(tr, tr->properties.pts);
 
-    
-    /* add pack header for only video, 
-     * audio sub stream should not contais the pack header*/
-    if(media_type_ == SUB_STREAM_MEIDA_TYPE_VIDEO){
-        retSize = put_pack_header(priv, buf+bufSize, maxBufSize - bufSize, timestamp);
-        bufSize += retSize;        
+    if(tr->parent != NULL && tr->parent->rtsp_sess != NULL) {
+        onlyKeyFrame = ((RTSP_session *)tr->parent->rtsp_sess)->onlyKeyFrame;
     }
 
     /* check if key frame, then add system header and map header */
     is_key_frame = IsKeyFrame(data, len);
     if(is_key_frame && media_type_ == SUB_STREAM_MEIDA_TYPE_VIDEO) {
-        
-        retSize = put_system_header(priv, buf+bufSize, maxBufSize - bufSize);
-        bufSize += retSize;        
-
-        retSize = put_system_map_header(priv,buf+bufSize, maxBufSize - bufSize);
-        bufSize += retSize;
-        
         //key frame start a new gov
         priv->gov_start = 1;
     }
 
-    retSize = EncodePes(tr, data, len, is_key_frame, buf, bufSize, maxBufSize );
-    if(retSize < 0 ) {
-        fnc_log(FNC_LOG_VERBOSE, "[mp2p] Encode Pes error");
-        ret = RESOURCE_NOT_PARSEABLE;
-        goto error2;
+    /* nothing would be sent for this frame */
+    if(len == 0 || priv->gov_start == 0 ||
+       (onlyKeyFrame != 0 && 
+        !is_key_frame && 
+        media_type_ != SUB_STREAM_MEIDA_TYPE_AUDIO)) {
+        return ERR_NOERROR;
     }
-    bufSize += retSize;
 
+    PsFragWriter writer(tr);
+    
+    /* add pack header for only video, 
+     * audio sub stream should not contais the pack header*/
+    if(media_type_ == SUB_STREAM_MEIDA_TYPE_VIDEO){
+        timestamp = pts2PSTimpstamp(tr, tr->properties.pts);
+        memcpy(pack_header, priv->pack_header, MP2P_PACK_HEADER_SIZE);
+        patch_pack_scr(pack_header, timestamp);
+        writer.PutHeader(pack_header, MP2P_PACK_HEADER_SIZE);
+    }
 
-    /* frags */
-    if(retSize > 0 && priv->gov_start != 0) { /* means some data is added */
-        mp2p_rtp_frag(tr,buf,bufSize);
-        fnc_log(FNC_LOG_VERBOSE, "[mp2p] Frame completed");
+    if(is_key_frame && media_type_ == SUB_STREAM_MEIDA_TYPE_VIDEO) {
+        writer.PutHeader(priv->sys_headers, priv->sys_headers_size);
     }
 
-    g_free(buf);
+    EncodePes(tr, data, len, is_key_frame, &writer);
 
+    /* the last frag */
+    writer.Finish();
+    fnc_log(FNC_LOG_VERBOSE, "[mp2p] Frame completed");
 
     return ERR_NOERROR;
-
-error2:
-    
-    g_free(buf);
-error1:
-    return ret;    
 }
 
+
 int StreamParser::EncodePes(Track *track, uint8_t *data, size_t len, 
-                       bool is_key_frame, 
-                       uint8_t *buf, size_t bufSize, size_t maxSize)
+                            bool is_key_frame, PsFragWriter *writer)
 {
-    using namespace stream_switch;
-    int64_t pts, dts;
+    int64_t pts;
     mp2p_priv * priv = (mp2p_priv * )track->private_data;
-    size_t orgBufSize = bufSize;
-    int onlyKeyFrame = 0;
-    uint8_t dwPtsDtsFlag;
-
-
-    if(track->parent != NULL && track->parent->rtsp_sess != NULL) {
-        onlyKeyFrame = ((RTSP_session *)track->parent->rtsp_sess)->onlyKeyFrame;
-    }
+    size_t orgSize = writer->total_size();
+    uint8_t header[MP2P_PES_HEADER_MAX_SIZE];
+    uint8_t first_PES_frag = 1;
+    size_t index = 0;
 
     pts = pts2PSTimpstamp(track, track->properties.pts);
-    dts = pts2PSTimpstamp(track, track->properties.dts);
-
-    dwPtsDtsFlag = 2;
-    
 
-    if(onlyKeyFrame == 0 ||
-       is_key_frame ||
-       media_type_ == SUB_STREAM_MEIDA_TYPE_AUDIO) {
-        /* frame: (data), size: len */
-
-        uint8_t first_PES_frag = 1;
-        size_t index = 0;
-
-        while(index < len) {
-
-            int pes_header_size = 0;
-            uint32_t stuffSize = 0;
-            size_t partial_size = 0;
-            size_t pes_size = 0;
-            uint8_t data_alignment_indicator = 0;
-            
+    /* frame: (data), size: len */
+    while(index < len) {
 
-            pes_size = 0;
-            partial_size = 0;
-            pes_header_size = 0;
-            stuffSize = 0;
+        int pes_header_size = 0;
+        int template_size = 0;
+        uint32_t stuffSize = 0;
+        size_t partial_size = 0;
+        size_t pes_size = 0;
 
+        /* calulate PES size, only the first pes has pts */
+        pes_header_size = get_pes_header_size(writer->total_size(), 
+                                              first_PES_frag ? 2 : 0, 
+                                              first_PES_frag, &stuffSize);
+        pes_size += pes_header_size;
 
-            /* calulate PES size */
-            pes_header_size = get_pes_header_size(bufSize,dwPtsDtsFlag, first_PES_frag, &stuffSize);
-            pes_size += pes_header_size;
-
-            if(pes_size + (len - index) > priv->packet_size) {
-                partial_size = priv->packet_size - pes_size;
-            }else{
-                partial_size = len - index;
-
-            }
-
-            pes_size += partial_size;
+        if(pes_size + (len - index) > priv->packet_size) {
+            partial_size = priv->packet_size - pes_size;
+        }else{
+            partial_size = len - index;
+        }
 
+        pes_size += partial_size;
 
-            /* check overflow */
-            if(pes_size + bufSize > maxSize) {
-                /* error, not enough space */
-                fnc_log(FNC_LOG_ERR, "[mp2p] StreamParser::EncodePes(): not enough space to hold pes (%d/%d)", 
-                        (int)pes_size + bufSize, (int)maxSize);
-                return -1;
-            }
-            
-            
-            if(media_type_ == SUB_STREAM_MEIDA_TYPE_VIDEO){
-                data_alignment_indicator = first_PES_frag;
-            }else{
-                data_alignment_indicator = 0;
-            }
-            /* fill in PES header */
-            pes_header_size = put_pes_header(stream_id(), 
-                                             pes_size - 6, stuffSize, 
-                                             first_PES_frag,
-                                             data_alignment_indicator, 
-                                             dwPtsDtsFlag, pts, dts, 
-                                             max_buffer_size(),
-                                             buf + bufSize, maxSize - bufSize);
-            bufSize += pes_header_size;
-                
-
-            /* fill in frame */
-            memcpy(buf + bufSize, (data + index), partial_size);
-            bufSize += partial_size;
-
-            /* clean up */
-            first_PES_frag = 0; /* the first pes of the NALU has data_alignment_indicator*/
-            dwPtsDtsFlag = 0; /* only the first pes has pts */
-            index += partial_size;
-                
+        /* fill in PES header from the template */
+        if(first_PES_frag) {
+            template_size = pes_first_header_size_;
+            memcpy(header, pes_first_header_, template_size);
+            patch_pes_pts(header + 9, pts);
+        }else{
+            template_size = pes_header_size_;
+            memcpy(header, pes_header_, template_size);
         }
-
+        header[4] = ((pes_size - 6) >> 8) & 0xff;
+        header[5] = (pes_size - 6) & 0xff;
+        header[8] += stuffSize; /* PES_header_data_length */
+        memset(header + template_size, 0xff, stuffSize);
+        writer->PutHeader(header, pes_header_size);
+
+        /* fill in frame */
+        writer->PutPayload(data + index, partial_size);
+
+        /* clean up */
+        first_PES_frag = 0; /* the first pes of the NALU has data_alignment_indicator*/
+        index += partial_size;
     }
 
-    return (int)(bufSize - orgBufSize);
-                           
+    return (int)(writer->total_size() - orgSize);
 }
 
 
@@ -1166,6 +1233,15 @@ static int mp2p_init(Track *track)
     bitrate += 10000;
     priv->mux_rate = (bitrate + (8 * 50) - 1) / (8 * 50);
     
+    /* build the header templates, only the timestamp would be 
+     * patched for each frame */
+    put_pack_header(priv, priv->pack_header, MP2P_PACK_HEADER_SIZE, 0);
+    priv->sys_headers_size = 
+        put_system_header(priv, priv->sys_headers, MP2P_SYS_HEADERS_MAX_SIZE);
+    priv->sys_headers_size += 
+        put_system_map_header(priv, priv->sys_headers + priv->sys_headers_size, 
+                              MP2P_SYS_HEADERS_MAX_SIZE - priv->sys_headers_size);
+    
 
     /* add rtp encoder map */
     encoder = "MP2P";
@@ -1199,40 +1275,6 @@ error1:
     return ret;
 }
 
-static void mp2p_rtp_frag(Track *tr, uint8_t *data, size_t len)
-{
-    int32_t offset, rem = len;
-    int i;
-
-    if (DEFAULT_MTU >= len) {
-        mparser_buffer_write(tr,
-                             tr->properties.pts,
-                             tr->properties.dts,
-                             tr->properties.frame_duration,
-                             1,
-                             data, len);
-        fnc_log(FNC_LOG_VERBOSE, "[mp2p] no frags");
-    } else {
-        i = 0;
-        do {
-            offset = len - rem;
-            mparser_buffer_write(tr,
-                                 tr->properties.pts,
-                                 tr->properties.dts,
-                                 tr->properties.frame_duration,
-                                 (rem <= DEFAULT_MTU),
-                                 data + offset, MIN(rem, DEFAULT_MTU));
-            rem -= DEFAULT_MTU;
-            fnc_log(FNC_LOG_VERBOSE, "[mp2p] frags %d", i);
-            i++;
-        } while (rem >= 0);
-    }
-
-    return;
-} 
-
-
-
 static int mp2p_parse(Track *tr, uint8_t *data, size_t len)
 {
     int index;
@@ -353,6 +353,8 @@ int r_read(Resource *resource)
                     resource->info->mrl);
             resource->eor = true;
             break;
+        case RESOURCE_AGAIN:
+            break;
         default:
             fnc_log(FNC_LOG_FATAL,
                     "r_read_unlocked: %s read_packet() error.",
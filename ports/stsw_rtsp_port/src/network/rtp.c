@@ -244,6 +244,76 @@ int all_rtp_session_end(RTSP_session *session) {
 
 }
 
+/**
+ * @brief Rebase a media time for a session primed by the GOP cache
+ *
+ * @param session The RTP session
+ * @param timestamp The media time to rebase
+ *
+ * @return The media time to use for the RTP timestamp
+ *
+ * The cached key frame is mapped to the range begin, then the media
+ * time flows at 1/@ref RTP_session::prime_rate speed until the live
+ * edge is reached, and at the normal speed since then.
+ */
+static double rtp_session_rebase(RTP_session *session, double timestamp)
+{
+    double delay, live_delay;
+
+    if(session->prime_rate <= 0){
+        return timestamp;
+    }
+    delay = (timestamp - session->prime_start) / session->prime_rate;
+    live_delay = timestamp - session->prime_live;
+    
+    return session->range->begin_time + 
+           MAX(0.0, MAX(delay, live_delay));
+}
+
+/**
+ * @brief Check if a primed session is still catching up the live edge
+ *
+ * @param session The RTP session
+ * @param timestamp The media time of the next packet
+ */
+static gboolean rtp_session_catching_up(RTP_session *session, double timestamp)
+{
+    return session->prime_rate > 0 &&
+           (timestamp - session->prime_start) / session->prime_rate > 
+           timestamp - session->prime_live;
+}
+
+/**
+ * @brief Setup the rebase of a live session started from the GOP cache
+ *
+ * @param session The RTP session to setup
+ *
+ * All the sessions of the resource are rebased to the same live edge,
+ * so that they are kept in sync whether a GOP is cached for them or not.
+ */
+static void rtp_session_prime(RTP_session *session)
+{
+    Resource *resource = session->track->parent;
+    MParserBuffer *buffer;
+
+    g_mutex_lock(resource->lock);
+    session->prime_live = resource->lastTimestamp;
+    g_mutex_unlock(resource->lock);
+
+    session->prime_start = session->prime_live;
+    session->prime_rate = ((double)session->srv->srvconf.catchup_rate) / 100.0;
+
+    if ( (buffer = bq_consumer_get(session->consumer)) != NULL &&
+         buffer->timestamp < session->prime_live ) {
+        session->prime_start = buffer->timestamp;
+    }
+
+    fnc_log(FNC_LOG_DEBUG, "[rtp] session %p primed with %f seconds of GOP, "
+            "catching up at rate %f\n", 
+            session, session->prime_live - session->prime_start, 
+            session->prime_rate);
+}
+
 /**
  * @brief Resume (or start) an RTP session
  *
@@ -282,6 +352,12 @@ static void rtp_session_resume(gpointer session_gen, gpointer range_gen) {
     session->send_time = 0.0;
     session->last_packet_send_time = time(NULL);
 
+    session->prime_rate = 0.0;
+    if (session->track->properties.media_source == MS_live &&
+        session->srv->srvconf.gop_cache) {
+        rtp_session_prime(session);
+    }
+
 
     /* Create the new thread pool for the read requests */
     /* Jmkn: fill_pool has been moved to rtsp session */
@@ -363,7 +439,8 @@ static inline uint32_t RTP_calc_rtptime(RTP_session *session,
                                         MParserBuffer *buffer)
 {
     uint32_t calc_rtptime =
-        rtp_scaler(session, buffer->timestamp - session->range->begin_time) * clock_rate;
+        rtp_scaler(session, rtp_session_rebase(session, buffer->timestamp) - 
+                   session->range->begin_time) * clock_rate;
 
     return session->start_rtptime + calc_rtptime;
 }
@@ -450,7 +527,7 @@ static void rtp_packet_send(RTP_session *session, MParserBuffer *buffer)
 
         fnc_log(FNC_LOG_DEBUG, "RTP Packet Lost\n");
     } else {
-        session->last_timestamp = buffer->timestamp;
+        session->last_timestamp = rtp_session_rebase(session, buffer->timestamp);
 
         session->last_rtptimestamp = timestamp;
 
@@ -605,6 +682,15 @@ static void rtp_write_cb(struct ev_loop *loop, ev_periodic *w,
                         /* Jmkn: for live stream ,deliver as soon as possible */
 
                         next_time += 0.001; 
+                        
+                        /* but pace the cached GOP at the catch-up rate */
+                        if (rtp_session_catching_up(session, next->delivery)) {
+                            double due = session->range->playback_time +
+                                rtp_session_rebase(session, next->delivery) -
+                                session->range->begin_time;
+                            if (next_time < due)
+                                next_time = due;
+                        }
                     } else {
 
                         next_time = (session->range->playback_time +
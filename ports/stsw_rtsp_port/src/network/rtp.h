@@ -114,6 +114,18 @@ typedef struct RTP_session {
 
     uint32_t last_rtptimestamp;   
 
+    /**
+     * @brief Rebase of the media time for a session primed by the GOP cache
+     *
+     * The session starts from the cached key frame at @ref prime_start,
+     * and plays at @ref prime_rate until it catches up the live edge
+     * at @ref prime_live (the latest buffered time when resumed).
+     * prime_rate is zero if no rebasing is done.
+     */
+    double prime_start;
+    double prime_live;
+    double prime_rate;
+
 
     /** URI of the resouce for RTP-Info */
     char *uri;
@@ -667,6 +667,9 @@ void RTSP_play(RTSP_Client * rtsp, RTSP_Request *req)
         }
     }
 
+    /* let the demuxer jump between the key frames */
+    if ( rtsp_sess->resource )
+        rtsp_sess->resource->only_key_frame = rtsp_sess->onlyKeyFrame;
 
     if ( rtsp_sess->cur_state != RTSP_SERVER_PLAYING &&
          (error = do_play(rtsp_sess)) != RTSP_Ok )
@@ -72,6 +72,21 @@ void ParseArgv(int argc, char *argv[],
                    NULL, NULL);  
     parser->RegisterOption("stream-type", 's', OPTION_FLAG_WITH_ARG,  "[raw|mp2p]",
                    "default stream type for this port, default is raw", NULL, NULL);                    
+    parser->RegisterOption("enable-gop-cache", 0, 0, NULL, 
+                   "enable caching the latest GOP of live stream, "
+                   "so that the playback starts from a key frame immediately, "
+                   "default is disabled", 
+                   NULL, NULL);  
+    parser->RegisterOption("catchup-rate", 0, 
+                   OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG, "NUM", 
+                   "the play rate (in percent) for the cached GOP to catch up "
+                   "the live stream, 100 means no catching up, default is 125", 
+                   NULL, NULL);  
+    parser->RegisterOption("edl-lookahead", 0, 
+                   OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG, "NUM", 
+                   "the number of the following files to open in background "
+                   "for aggregated replay, 0 means disabled, default is 1", 
+                   NULL, NULL);  
                    
     
     ret = parser->Parse(argc, argv, &err_info);//parse the cmd args
@@ -0,0 +1,366 @@
+/**
+ * This file is part of stsw_rtsp_port, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2015  OpenSight team (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+/**
+ * gop_cache_test.cc
+ *      check that the stsw demuxer subscribes the stream at DESCRIBE time
+ * (resource open) when the GOP cache is enabled, so that the track keeps
+ * the latest GOP from a key frame before any PLAY, and that it does not
+ * subscribe the stream before PLAY when the GOP cache is disabled.
+ *
+ *      The stream is published by an in-process H264 source, no RTSP
+ * client is involved.
+ *
+ * author: OpenSight Team
+ * date: 2016-04-23
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "feng.h"
+#include "fnc_log.h"
+#include "bufferqueue.h"
+#include "media/demuxer.h"
+#include "media/mediaparser.h"
+
+#include "stream_switch.h"
+
+extern "C" {
+void demuxer_stsw_global_init(void);
+void demuxer_stsw_global_uninit(void);
+}
+
+#define TEST_STREAM_NAME "gop_cache_test"
+#define TEST_FPS 25
+#define TEST_GOP 10
+#define TEST_PRIME_WAIT 1500000  // in us
+
+
+///////////////////////////////////////////////////////////////
+//Type
+
+class TestH264Source:public stream_switch::SourceListener{
+
+public:
+    TestH264Source();
+    virtual ~TestH264Source();
+    int Init(const std::string &stream_name);
+    void Uninit();
+
+    virtual void OnKeyFrame(void);
+    virtual void OnMediaStatistic(stream_switch::MediaStatisticInfo *statistic){};
+
+    int key_frame_requests() { return key_frame_requests_; }
+
+private:
+    static void * StaticPublishRoutine(void *arg);
+    void PublishRoutine();
+
+    stream_switch::StreamSource source_;
+    uint32_t ssrc_;
+    pthread_t publish_thread_id_;
+    volatile int running_;
+    volatile int key_frame_requests_;
+    volatile int force_key_frame_;
+};
+
+///////////////////////////////////////////////////////////////
+//global variables
+
+static const uint8_t test_sps[] = {
+    0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0xc0, 0x1e,
+    0xda, 0x02, 0x80, 0xbf, 0xe5, 0x84, 0x00, 0x00,
+    0x03, 0x00, 0x04, 0x00, 0x00, 0x03, 0x00, 0xca,
+    0x3c, 0x58, 0xba, 0x80
+};
+static const uint8_t test_pps[] = {
+    0x00, 0x00, 0x00, 0x01, 0x68, 0xce, 0x3c, 0x80
+};
+
+
+///////////////////////////////////////////////////////////////
+//functions
+
+TestH264Source::TestH264Source()
+:ssrc_(0), running_(0), key_frame_requests_(0), force_key_frame_(0)
+{
+
+}
+
+TestH264Source::~TestH264Source()
+{
+
+}
+
+int TestH264Source::Init(const std::string &stream_name)
+{
+    using namespace stream_switch;
+    int ret;
+    std::string err_info;
+    StreamMetadata metadata;
+    SubStreamMetadata sub_metadata;
+
+    ret = source_.Init(stream_name, 0, 0, this, 0, &err_info);
+    if(ret){
+        fprintf(stderr, "Init stream source error: %s\n", err_info.c_str());
+        return -1;
+    }
+
+    metadata.bps = 0;
+    metadata.play_type = STREAM_PLAY_TYPE_LIVE;
+    metadata.source_proto = "Test";
+    ssrc_ = 0x12345678;
+    metadata.ssrc = ssrc_;
+    sub_metadata.codec_name = "H264";
+    sub_metadata.media_type = SUB_STREAM_MEIDA_TYPE_VIDEO;
+    sub_metadata.sub_stream_index = 0;
+    sub_metadata.direction = SUB_STREAM_DIRECTION_OUTBOUND;
+    sub_metadata.media_param.video.height = 360;
+    sub_metadata.media_param.video.width = 640;
+    sub_metadata.media_param.video.fps = TEST_FPS;
+    sub_metadata.media_param.video.gov = TEST_GOP;
+    sub_metadata.extra_data.assign((const char *)test_sps, sizeof(test_sps));
+    sub_metadata.extra_data.append((const char *)test_pps, sizeof(test_pps));
+    metadata.sub_streams.push_back(sub_metadata);
+    source_.set_stream_meta(metadata);
+    source_.set_stream_state(SOURCE_STREAM_STATE_OK);
+
+    ret = source_.Start(&err_info);
+    if(ret){
+        fprintf(stderr, "Start stream source error: %s\n", err_info.c_str());
+        source_.Uninit();
+        return -1;
+    }
+
+    running_ = 1;
+    ret = pthread_create(&publish_thread_id_, NULL, StaticPublishRoutine, this);
+    if(ret){
+        running_ = 0;
+        source_.Uninit();
+        return -1;
+    }
+
+    return 0;
+}
+
+void TestH264Source::Uninit()
+{
+    if(running_){
+        running_ = 0;
+        pthread_join(publish_thread_id_, NULL);
+    }
+    source_.Uninit();
+}
+
+void TestH264Source::OnKeyFrame(void)
+{
+    key_frame_requests_++;
+    force_key_frame_ = 1;
+}
+
+void * TestH264Source::StaticPublishRoutine(void *arg)
+{
+    ((TestH264Source *)arg)->PublishRoutine();
+    return NULL;
+}
+
+void TestH264Source::PublishRoutine()
+{
+    using namespace stream_switch;
+    uint8_t frame[2048];
+    size_t frame_size;
+    int frame_num = 0;
+    MediaFrameInfo frame_info;
+
+    while(running_){
+        frame_size = 0;
+        frame_info.sub_stream_index = 0;
+        frame_info.ssrc = ssrc_;
+        gettimeofday(&frame_info.timestamp, NULL);
+
+        if(frame_num % TEST_GOP == 0 || force_key_frame_){
+            //SPS + PPS + IDR slice
+            force_key_frame_ = 0;
+            frame_num = 0;
+            frame_info.frame_type = MEDIA_FRAME_TYPE_KEY_FRAME;
+            memcpy(frame, test_sps, sizeof(test_sps));
+            frame_size += sizeof(test_sps);
+            memcpy(frame + frame_size, test_pps, sizeof(test_pps));
+            frame_size += sizeof(test_pps);
+            memcpy(frame + frame_size, "\x00\x00\x00\x01\x65", 5);
+        }else{
+            frame_info.frame_type = MEDIA_FRAME_TYPE_DATA_FRAME;
+            memcpy(frame + frame_size, "\x00\x00\x00\x01\x41", 5);
+        }
+        frame_size += 5;
+        memset(frame + frame_size, 0x5a, 200);
+        frame_size += 200;
+
+        source_.SendLiveMediaFrame(frame_info, (const char *)frame, frame_size, NULL);
+        frame_num++;
+
+        usleep(1000000 / TEST_FPS);
+    }
+}
+
+
+static feng * test_feng_alloc(int gop_cache)
+{
+    feng *srv = g_new0(feng, 1);
+
+    srv->srvconf.buffered_frames = 2048;
+    srv->srvconf.gop_cache = gop_cache;
+    srv->srvconf.catchup_rate = 125;
+    srv->srvconf.default_stream_type = RAW_STREAM;
+    srv->srvconf.stsw_debug_flags = 0;
+    srv->config_storage.document_root = buffer_init();
+    buffer_copy_string(srv->config_storage.document_root, "");
+    srv->loop = ev_default_loop(0);
+    srv->lock = g_mutex_new();
+
+    return srv;
+}
+
+static void test_feng_free(feng *srv)
+{
+    buffer_free(srv->config_storage.document_root);
+    g_mutex_free(srv->lock);
+    g_free(srv);
+}
+
+// the first buffer of a GOP is the SPS, PPS or (the first fragment of)
+// the IDR slice
+static int is_gop_start(MParserBuffer *buffer)
+{
+    uint8_t nal_type;
+
+    if(buffer == NULL || buffer->data_size < 2){
+        return 0;
+    }
+    nal_type = buffer->data[0] & 0x1f;
+    if(nal_type == 28){
+        //FU-A
+        return (buffer->data[1] & 0x80) && (buffer->data[1] & 0x1f) == 5;
+    }
+    return nal_type == 5 || nal_type == 7 || nal_type == 8;
+}
+
+static int test_describe(int gop_cache)
+{
+    feng *srv = test_feng_alloc(gop_cache);
+    Resource *r;
+    Track *tr;
+    BufferQueue_Consumer *consumer;
+    unsigned queue_len;
+    gulong unseen;
+    int failed = 0;
+
+    //r_open is what DESCRIBE does to the stream
+    r = r_open(srv, "stsw/stream/" TEST_STREAM_NAME);
+    if(r == NULL || r->tracks == NULL){
+        fprintf(stderr, "gop_cache=%d: open resource failed\n", gop_cache);
+        test_feng_free(srv);
+        return 1;
+    }
+    tr = (Track *)g_list_first(r->tracks)->data;
+
+    usleep(TEST_PRIME_WAIT);
+
+    queue_len = bq_producer_queue_length(tr->producer);
+    if(!gop_cache){
+        if(queue_len != 0){
+            fprintf(stderr, "gop_cache=0: %u buffers queued before PLAY\n",
+                    queue_len);
+            failed = 1;
+        }
+    }else if(queue_len == 0){
+        fprintf(stderr, "gop_cache=1: no buffer queued at DESCRIBE time\n");
+        failed = 1;
+    }else{
+        //a new consumer starts from the retained GOP, which is no more
+        //than one GOP (plus the buffers queued while checking)
+        consumer = bq_consumer_new(tr->producer);
+        unseen = bq_consumer_unseen(consumer);
+        if(unseen == 0 || unseen > 2 * (TEST_GOP + 2)){
+            fprintf(stderr, "gop_cache=1: %lu buffers retained, "
+                    "expect one GOP\n", unseen);
+            failed = 1;
+        }else if(!is_gop_start((MParserBuffer *)bq_consumer_get(consumer))){
+            fprintf(stderr, "gop_cache=1: "
+                    "the retained buffers do not start on a key frame\n");
+            failed = 1;
+        }
+        bq_consumer_free(consumer);
+    }
+
+    r_close(r);
+    test_feng_free(srv);
+
+    fprintf(stderr, "gop_cache=%d: %s (%u buffers queued before PLAY)\n",
+            gop_cache, failed ? "FAIL" : "OK", queue_len);
+    return failed;
+}
+
+
+///////////////////////////////////////////////////////////////
+//main entry
+int main(int argc, char *argv[])
+{
+    TestH264Source source;
+    int key_frame_requests;
+    int failed = 0;
+
+    fnc_log_init((char *)"", FNC_LOG_OUT, FNC_LOG_ERR, (char *)"gop_cache_test");
+    bq_init();
+    demuxer_stsw_global_init();
+
+    if(source.Init(TEST_STREAM_NAME)){
+        demuxer_stsw_global_uninit();
+        return 1;
+    }
+
+    failed |= test_describe(0);
+    if(source.key_frame_requests() != 0){
+        fprintf(stderr, "gop_cache=0: key frame requested before PLAY\n");
+        failed = 1;
+    }
+
+    key_frame_requests = source.key_frame_requests();
+    failed |= test_describe(1);
+    if(source.key_frame_requests() == key_frame_requests){
+        fprintf(stderr, "gop_cache=1: no key frame requested at DESCRIBE time\n");
+        failed = 1;
+    }
+
+    source.Uninit();
+    demuxer_stsw_global_uninit();
+
+    fprintf(stderr, "%s\n", failed ? "FAILED" : "PASSED");
+    return failed;
+}
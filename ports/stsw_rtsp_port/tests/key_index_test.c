@@ -0,0 +1,191 @@
+/**
+ * This file is part of stsw_rtsp_port, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2015  OpenSight team (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+/**
+ * key_index_test.c
+ *      check the key frame index lookup, and that the sidecar file is
+ * big-endian, loads back the same index and is rejected when stale or
+ * damaged.
+ *
+ * author: OpenSight Team
+ * date: 2016-04-23
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "media/key_index.h"
+
+#define TEST_KEY_NUM 1000
+#define TEST_FILE_SIZE 123456789012LL
+#define TEST_FILE_MTIME 1461369600LL
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", \
+                __FILE__, __LINE__, #cond); \
+        failed = 1; \
+    } \
+} while (0)
+
+static int failed = 0;
+
+/* key frame i at i seconds, in 1/90000 time base */
+static key_index *build_index(void)
+{
+    key_index *kidx = key_index_new(1, 1, 90000);
+    int i;
+
+    for (i = 0; i < TEST_KEY_NUM; i++) {
+        key_index_append(kidx, 4096LL * i + 0x0102030405LL, 90000LL * i);
+        /* not after the last one, ignored */
+        key_index_append(kidx, 0, 90000LL * i);
+    }
+    return kidx;
+}
+
+static void test_lookup(void)
+{
+    key_index *kidx = build_index();
+
+    CHECK(kidx->num == TEST_KEY_NUM);
+    CHECK(key_index_time(kidx, 10) == 10.0);
+
+    CHECK(key_index_lookup(kidx, -1.0) == 0);
+    CHECK(key_index_lookup(kidx, 0.0) == 0);
+    CHECK(key_index_lookup(kidx, 10.0) == 10);
+    CHECK(key_index_lookup(kidx, 10.5) == 10);
+    CHECK(key_index_lookup(kidx, 1e9) == TEST_KEY_NUM - 1);
+
+    CHECK(key_index_next(kidx, -1.0) == 0);
+    CHECK(key_index_next(kidx, 10.0) == 11);
+    CHECK(key_index_next(kidx, 10.5) == 11);
+    CHECK(key_index_next(kidx, 1e9) == TEST_KEY_NUM);
+
+    key_index_free(kidx);
+}
+
+static int read_file(const char *path, unsigned char *buf, size_t size)
+{
+    FILE *fp = fopen(path, "rb");
+    size_t n;
+
+    if (fp == NULL)
+        return -1;
+    n = fread(buf, 1, size, fp);
+    fclose(fp);
+    return (int)n;
+}
+
+static void patch_file(const char *path, long offset, unsigned char value)
+{
+    FILE *fp = fopen(path, "r+b");
+
+    if (fp == NULL)
+        return;
+    fseek(fp, offset, SEEK_SET);
+    fputc(value, fp);
+    fclose(fp);
+}
+
+static void test_sidecar(void)
+{
+    char path[] = "/tmp/key_index_test.XXXXXX";
+    unsigned char buf[64];
+    key_index *kidx = build_index();
+    key_index *loaded;
+    unsigned int i;
+    int fd;
+
+    fd = mkstemp(path);
+    if (fd < 0) {
+        fprintf(stderr, "cannot create the temp file\n");
+        failed = 1;
+        key_index_free(kidx);
+        return;
+    }
+    close(fd);
+
+    CHECK(key_index_save(kidx, path, TEST_FILE_SIZE, TEST_FILE_MTIME) == 0);
+
+    /* fixed big-endian layout */
+    CHECK(read_file(path, buf, sizeof(buf)) == (int)sizeof(buf));
+    CHECK(memcmp(buf, "STSWKIDX", 8) == 0);
+    CHECK(memcmp(buf + 8, "\x00\x00\x00\x02", 4) == 0);         /* version */
+    CHECK(memcmp(buf + 12, "\x00\x00\x03\xe8", 4) == 0);        /* 1000 */
+    CHECK(memcmp(buf + 16, "\x00\x00\x00\x1c\xbe\x99\x1a\x14", 8) == 0);
+    CHECK(memcmp(buf + 32, "\x00\x00\x00\x01", 4) == 0);        /* stream */
+    CHECK(memcmp(buf + 40, "\x00\x01\x5f\x90", 4) == 0);        /* 90000 */
+    CHECK(memcmp(buf + 48, "\x00\x00\x00\x01\x02\x03\x04\x05", 8) == 0);
+    CHECK(memcmp(buf + 56, "\x00\x00\x00\x00\x00\x00\x00\x00", 8) == 0);
+
+    /* load back */
+    loaded = key_index_load(path, TEST_FILE_SIZE, TEST_FILE_MTIME);
+    CHECK(loaded != NULL);
+    if (loaded != NULL) {
+        CHECK(loaded->stream_index == 1);
+        CHECK(loaded->tb_num == 1 && loaded->tb_den == 90000);
+        CHECK(loaded->num == kidx->num);
+        for (i = 0; i < loaded->num && i < kidx->num; i++) {
+            if (loaded->entries[i].pos != kidx->entries[i].pos ||
+                loaded->entries[i].ts != kidx->entries[i].ts) {
+                fprintf(stderr, "entry %u mismatch\n", i);
+                failed = 1;
+                break;
+            }
+        }
+        key_index_free(loaded);
+    }
+
+    /* stale, the media file is changed */
+    CHECK(key_index_load(path, TEST_FILE_SIZE + 1, TEST_FILE_MTIME) == NULL);
+    CHECK(key_index_load(path, TEST_FILE_SIZE, TEST_FILE_MTIME + 1) == NULL);
+
+    /* truncated */
+    CHECK(truncate(path, 48 + 16 * 10) == 0);
+    CHECK(key_index_load(path, TEST_FILE_SIZE, TEST_FILE_MTIME) == NULL);
+
+    /* other version, e.g. the host-endian version 1 */
+    CHECK(key_index_save(kidx, path, TEST_FILE_SIZE, TEST_FILE_MTIME) == 0);
+    patch_file(path, 11, 0x01);
+    CHECK(key_index_load(path, TEST_FILE_SIZE, TEST_FILE_MTIME) == NULL);
+
+    /* missing */
+    unlink(path);
+    CHECK(key_index_load(path, TEST_FILE_SIZE, TEST_FILE_MTIME) == NULL);
+
+    key_index_free(kidx);
+}
+
+
+int main(int argc, char *argv[])
+{
+    test_lookup();
+    test_sidecar();
+
+    fprintf(stderr, "%s\n", failed ? "FAILED" : "PASSED");
+    return failed;
+}
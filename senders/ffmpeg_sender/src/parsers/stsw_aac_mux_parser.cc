@@ -896,14 +896,10 @@ int AacMuxParser::EncodeAudioFrame(AVFrame *frame,
         av_packet_rescale_ts(&output_packet,
                              out_codec_context_->time_base,
                              stream_->time_base);           
-        muxer_->StartIO();
-        error = av_interleaved_write_frame(fmt_ctx_, &output_packet);
-        muxer_->StopIO();
-        if (error < 0) {
-            char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
-            STDERR_LOG(LOG_LEVEL_ERR, 
-                "Could not write frame (error '%s')\n", 
-                av_make_error_string(errbuf, AV_ERROR_MAX_STRING_SIZE, error));             
+        // go through the muxer, which may dispatch it to several outputs
+        error = muxer_->WriteParsedPacket(&output_packet);
+        if (error) {
+            STDERR_LOG(LOG_LEVEL_ERR, "Could not write frame\n");             
             return FFMPEG_SENDER_ERR_IO;             
         }
     }
@@ -52,6 +52,25 @@ H264or5MuxParser::H264or5MuxParser()
 
 }
 
+bool H264or5MuxParser::FindSps(const std::string &extra_data, 
+                               const uint8_t **sps, size_t *sps_size)
+{
+    const uint8_t *pos = (const uint8_t *)extra_data.data();
+    const uint8_t *end = pos + extra_data.size();
+    StswNalUnit nal;
+    uint8_t sps_type = (h_number_ == 264) ? 7 : 33;
+    
+    while(stsw_next_nal_unit(&pos, end, h_number_, &nal)){
+        if(nal.type == sps_type && nal.start != nal.data){
+            //the sps decoder requires the start code ahead
+            *sps = nal.start;
+            *sps_size = nal.data + nal.size - nal.start;
+            return true;
+        }
+    }
+    return false;
+}
+
 int H264or5MuxParser::DoExtraDataInit(FFmpegMuxer * muxer, 
                           const stream_switch::SubStreamMetadata &sub_metadata, 
                           AVFormatContext *fmt_ctx, 
@@ -60,15 +79,17 @@ int H264or5MuxParser::DoExtraDataInit(FFmpegMuxer * muxer,
     using namespace stream_switch; 
     AVCodecContext *c = stream->codec;
     int ret = 0;
+    const uint8_t *sps = NULL;
+    size_t sps_size = 0;
 
 
     if(strcasecmp(sub_metadata.codec_name.c_str(), "H264") == 0){
+        h_number_ = 264;
          // get width/height from sps
-        if(sub_metadata.extra_data.size() != 0){
+        if(FindSps(sub_metadata.extra_data, &sps, &sps_size)){
             unsigned int width = 0;
             unsigned int height = 0;
-            ret = decsps((unsigned char *)sub_metadata.extra_data.data(), 
-                         sub_metadata.extra_data.size(), 
+            ret = decsps((unsigned char *)sps, sps_size, 
                          &width, &height);
             if(ret==0 && width !=0 && height !=0){
                 //successful decode sps
@@ -76,14 +97,13 @@ int H264or5MuxParser::DoExtraDataInit(FFmpegMuxer * muxer,
                 c->height   = height; 
             }
         }       
-        h_number_ = 264;
     }else if(strcasecmp(sub_metadata.codec_name.c_str(), "H265") == 0){
+        h_number_ = 265;
          // get width/height from sps
-        if(sub_metadata.extra_data.size() != 0){
+        if(FindSps(sub_metadata.extra_data, &sps, &sps_size)){
             unsigned int width = 0;
             unsigned int height = 0;
-            ret = decsps_265((unsigned char *)sub_metadata.extra_data.data(), 
-                         sub_metadata.extra_data.size(), 
+            ret = decsps_265((unsigned char *)sps, sps_size, 
                          &width, &height);
             if(ret==0 && width !=0 && height !=0){
                 //successful decode sps
@@ -91,7 +111,6 @@ int H264or5MuxParser::DoExtraDataInit(FFmpegMuxer * muxer,
                 c->height   = height; 
             }
         }           
-        h_number_ = 265;
     }else{
         STDERR_LOG(LOG_LEVEL_ERR, "Could not support codec:%s\n",
                     sub_metadata.codec_name.c_str());        
@@ -58,6 +58,10 @@ public:
 
 protected:
     
+    // find the sps NAL (with its start code) in the extra data
+    bool FindSps(const std::string &extra_data, 
+                 const uint8_t **sps, size_t *sps_size);
+    
     int h_number_; 
 
 
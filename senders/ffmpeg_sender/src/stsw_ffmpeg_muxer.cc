@@ -76,9 +76,6 @@ int FFmpegMuxer::Open(const std::string &dest_url,
     using namespace stream_switch; 
     int ret = 0;
     AVDictionary *format_opts = NULL;
-    const char * format_name = NULL;
-    
-    SubStreamMetadataVector::const_iterator meta_it;
     
     
     //printf("ffmpeg_options_str:%s\n", ffmpeg_options_str.c_str());
@@ -98,21 +95,180 @@ int FFmpegMuxer::Open(const std::string &dest_url,
     //av_dict_set(&format_opts, "rtsp_transport", "tcp", 0);
     //printf("option dict count:%d\n", av_dict_count(format_opts));
 
+    ret = InitParseContext(dest_url, format, metadata, acodec, io_timeout);
+    if(ret){
+        goto err_out1;
+    }
+
+#define DUMP_AVFORMAT
+#ifdef DUMP_AVFORMAT
+    STDERR_LOG(stream_switch::LOG_LEVEL_INFO,  
+            "FFmpegMuxer::Open(): avformat context is dumped below\n");    
+    av_dump_format(fmt_ctx_, 0, dest_url.c_str(), 1);
+#endif  
+
+    ret = OpenIO(dest_url, &format_opts);
+    if(ret){
+        goto err_out2;
+    }
+  
+    if(format_opts != NULL){
+        av_dict_free(&format_opts);
+        format_opts = NULL;
+    }        
+    base_timestamp_.tv_sec = 0;
+    base_timestamp_.tv_usec = 0;
+    frame_num_ = 0;
+    
+   
+    return 0;
+    
+err_out2:
+    UninitParseContext();
+    
+err_out1:
+    if(format_opts != NULL){
+        av_dict_free(&format_opts);
+        format_opts = NULL;
+    }
+
+    return ret;
+}
+
+int FFmpegMuxer::OpenMirror(const std::string &dest_url, 
+                            const std::string &format,
+                            const std::string &ffmpeg_options_str, 
+                            AVFormatContext *src_ctx, 
+                            unsigned long io_timeout)
+{
+    using namespace stream_switch; 
+    int ret = 0;
+    AVDictionary *format_opts = NULL;
+    const char * format_name = NULL;
+    unsigned int i;
+    
+    if(src_ctx == NULL){
+        return FFMPEG_SENDER_ERR_GENERAL;
+    }
+    
+    ret = av_dict_parse_string(&format_opts, 
+                               ffmpeg_options_str.c_str(),
+                               "=", ",", 0);
+    if(ret){
+        STDERR_LOG(LOG_LEVEL_ERR, 
+                   "Failed to parse the ffmpeg_options_str:%s to av_dict(ret:%d)\n", 
+                   ffmpeg_options_str.c_str(), ret);    
+        ret = FFMPEG_SENDER_ERR_GENERAL;                   
+        goto err_out1;
+    }
     
-    //allocate the format context
     if(format.size() != 0){
         format_name = format.c_str();
     }    
     ret = avformat_alloc_output_context2(&fmt_ctx_, NULL, format_name, dest_url.c_str());    
     if(fmt_ctx_ == NULL){
         char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
-        //log        
         STDERR_LOG(LOG_LEVEL_ERR, 
                    "Failed to allocate AVFormatContext structure:%s\n", 
                    av_make_error_string(errbuf, AV_ERROR_MAX_STRING_SIZE, ret));           
         ret = FFMPEG_SENDER_ERR_GENERAL;
         goto err_out1;        
     }
+    fmt_ctx_->interrupt_callback.callback = FFmpegMuxer::StaticIOInterruptCB;
+    fmt_ctx_->interrupt_callback.opaque = this;
+    io_timeout_ = io_timeout;
+    
+    //copy the streams, which keep the same index as the ones of src_ctx
+    for(i = 0; i < src_ctx->nb_streams; i++){
+        AVStream * src_stream = src_ctx->streams[i];
+        AVStream * stream = NULL;
+        
+        stream = avformat_new_stream(fmt_ctx_, NULL);
+        if (!stream) {
+            STDERR_LOG(LOG_LEVEL_ERR, "Could not allocate stream\n");
+            ret = FFMPEG_SENDER_ERR_GENERAL;
+            goto err_out2;
+        }
+        stream->id = stream->index;
+        ret = avcodec_copy_context(stream->codec, src_stream->codec);
+        if(ret < 0){
+            char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
+            STDERR_LOG(LOG_LEVEL_ERR, 
+                       "Failed to copy the codec context of stream %u:%s\n", 
+                       i, av_make_error_string(errbuf, AV_ERROR_MAX_STRING_SIZE, ret));
+            ret = FFMPEG_SENDER_ERR_GENERAL;
+            goto err_out2;            
+        }
+        //the tag chosen for the format of src_ctx may be invalid for this one
+        stream->codec->codec_tag = 0;
+        if (fmt_ctx_->oformat->flags & AVFMT_GLOBALHEADER){
+            stream->codec->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;  
+        }else{
+            stream->codec->flags &= ~AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+        stream->time_base = src_stream->time_base;
+        stream->avg_frame_rate = src_stream->avg_frame_rate;
+    }
+
+#ifdef DUMP_AVFORMAT
+    STDERR_LOG(stream_switch::LOG_LEVEL_INFO,  
+            "FFmpegMuxer::OpenMirror(): avformat context is dumped below\n");    
+    av_dump_format(fmt_ctx_, 0, dest_url.c_str(), 1);
+#endif  
+    
+    ret = OpenIO(dest_url, &format_opts);
+    if(ret){
+        goto err_out2;
+    }
+    
+    if(format_opts != NULL){
+        av_dict_free(&format_opts);
+        format_opts = NULL;
+    }        
+    base_timestamp_.tv_sec = 0;
+    base_timestamp_.tv_usec = 0;
+    frame_num_ = 0;
+    
+    return 0;
+    
+err_out2:
+    avformat_free_context(fmt_ctx_);
+    fmt_ctx_ = NULL;
+    
+err_out1:
+    if(format_opts != NULL){
+        av_dict_free(&format_opts);
+        format_opts = NULL;
+    }
+
+    return ret;
+}
+
+int FFmpegMuxer::InitParseContext(const std::string &dest_url, 
+                                  const std::string &format,
+                                  const stream_switch::StreamMetadata &metadata, 
+                                  const std::string &acodec, 
+                                  unsigned long io_timeout)
+{
+    using namespace stream_switch; 
+    int ret = 0;
+    const char * format_name = NULL;
+    
+    SubStreamMetadataVector::const_iterator meta_it;
+    
+    //allocate the format context
+    if(format.size() != 0){
+        format_name = format.c_str();
+    }    
+    ret = avformat_alloc_output_context2(&fmt_ctx_, NULL, format_name, dest_url.c_str());    
+    if(fmt_ctx_ == NULL){
+        char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
+        //log        
+        STDERR_LOG(LOG_LEVEL_ERR, 
+                   "Failed to allocate AVFormatContext structure:%s\n", 
+                   av_make_error_string(errbuf, AV_ERROR_MAX_STRING_SIZE, ret));           
+        return FFMPEG_SENDER_ERR_GENERAL;
+    }
     //install the io interrupt callback function
     fmt_ctx_->interrupt_callback.callback = FFmpegMuxer::StaticIOInterruptCB;
     fmt_ctx_->interrupt_callback.opaque = this;
@@ -138,23 +294,46 @@ int FFmpegMuxer::Open(const std::string &dest_url,
                 "Parser for codec (name:%s) init failed\n", 
                 codec_name.c_str()); 
             delete parser;
-            ret = FFMPEG_SENDER_ERR_GENERAL;
-            goto err_out3;
+            UninitParseContext();
+            return FFMPEG_SENDER_ERR_GENERAL;
         }
         stream_mux_parsers_.push_back(parser);          
     }
-#define DUMP_AVFORMAT
-#ifdef DUMP_AVFORMAT
-    STDERR_LOG(stream_switch::LOG_LEVEL_INFO,  
-            "FFmpegMuxer::Open(): avformat context is dumped below\n");    
-    av_dump_format(fmt_ctx_, 0, dest_url.c_str(), 1);
-#endif  
+    
+    return 0;
+}
+
+void FFmpegMuxer::UninitParseContext()
+{
+    //uninit all parser
+    {
+        StreamMuxParserVector::iterator it;
+        for(it = stream_mux_parsers_.begin(); 
+            it != stream_mux_parsers_.end();
+            it++){
+            (*it)->Uninit();
+            delete (*it);
+            (*it) = NULL;
+        }
+        stream_mux_parsers_.clear();                
+    }
+    if(fmt_ctx_ != NULL){
+        avformat_free_context(fmt_ctx_);
+        fmt_ctx_ = NULL;
+    }
+}
+
+int FFmpegMuxer::OpenIO(const std::string &dest_url, AVDictionary **format_opts)
+{
+    using namespace stream_switch; 
+    int ret = 0;
+    
     // open output file
     if (fmt_ctx_->oformat && !(fmt_ctx_->oformat->flags & AVFMT_NOFILE)) {
         
         StartIO();
         ret = avio_open2(&(fmt_ctx_->pb), dest_url.c_str(), AVIO_FLAG_WRITE, 
-                         &(fmt_ctx_->interrupt_callback), &format_opts);
+                         &(fmt_ctx_->interrupt_callback), format_opts);
         StopIO();
         if (ret < 0) {
             char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
@@ -162,71 +341,33 @@ int FFmpegMuxer::Open(const std::string &dest_url,
                    "Could not open output file '%s':%s\n", 
                    dest_url.c_str(), 
                    av_make_error_string(errbuf, AV_ERROR_MAX_STRING_SIZE, ret));           
-            ret = FFMPEG_SENDER_ERR_GENERAL;
-            goto err_out3;             
+            return FFMPEG_SENDER_ERR_GENERAL;
         }
     }    
    
-    ret = avformat_write_header(fmt_ctx_, &format_opts);
+    ret = avformat_write_header(fmt_ctx_, format_opts);
     if (ret < 0) {
         char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
         STDERR_LOG(LOG_LEVEL_ERR, 
                    "Error occurred when write header to the output file: %s\n", 
                    av_make_error_string(errbuf, AV_ERROR_MAX_STRING_SIZE, ret));           
-        ret = FFMPEG_SENDER_ERR_GENERAL;
-        goto err_out4;         
+        if (fmt_ctx_->oformat && !(fmt_ctx_->oformat->flags & AVFMT_NOFILE))
+            avio_closep(&fmt_ctx_->pb);     
+        return FFMPEG_SENDER_ERR_GENERAL;
     }    
   
-    if(format_opts != NULL){
-        int no_parsed_option_num = av_dict_count(format_opts);
+    if((*format_opts) != NULL){
+        int no_parsed_option_num = av_dict_count(*format_opts);
         if(no_parsed_option_num){
             STDERR_LOG(stream_switch::LOG_LEVEL_WARNING,  
             "%d options cannot be parsed by ffmpeg avformat context\n", 
             no_parsed_option_num);            
         }
         //printf("after open, option dict count:%d\n", av_dict_count(format_opts));
-        av_dict_free(&format_opts);
-        format_opts = NULL;
     }        
-    base_timestamp_.tv_sec = 0;
-    base_timestamp_.tv_usec = 0;
-    frame_num_ = 0;
-    
-   
     return 0;
-    
-    
-err_out4:
-    if (fmt_ctx_->oformat && !(fmt_ctx_->oformat->flags & AVFMT_NOFILE))
-        avio_closep(&fmt_ctx_->pb);     
-
-err_out3:
-    
-    {
-        StreamMuxParserVector::iterator it;
-        for(it = stream_mux_parsers_.begin(); 
-            it != stream_mux_parsers_.end();
-            it++){
-            (*it)->Uninit();
-            delete (*it);
-            (*it) = NULL;
-        }
-        stream_mux_parsers_.clear();
-                
-    }
-    
-//err_out2:
-    avformat_free_context(fmt_ctx_);
-    fmt_ctx_ = NULL;
-    
-err_out1:
-    if(format_opts != NULL){
-        av_dict_free(&format_opts);
-        format_opts = NULL;
-    }
-
-    return ret;
 }
+
 void FFmpegMuxer::Flush()
 {
     if(fmt_ctx_ == NULL){
@@ -261,22 +402,7 @@ void FFmpegMuxer::Close()
     if (fmt_ctx_->oformat && !(fmt_ctx_->oformat->flags & AVFMT_NOFILE))
         avio_closep(&fmt_ctx_->pb);  
 
-         
-    //uninit all parser
-    {
-        StreamMuxParserVector::iterator it;
-        for(it = stream_mux_parsers_.begin(); 
-            it != stream_mux_parsers_.end();
-            it++){
-            (*it)->Uninit();
-            delete (*it);
-            (*it) = NULL;
-        }
-        stream_mux_parsers_.clear();                
-    }
-    avformat_free_context(fmt_ctx_);
-         
-    fmt_ctx_ = NULL;
+    UninitParseContext();
 }
 
 int FFmpegMuxer::WritePacket(const stream_switch::MediaFrameInfo &frame_info, 
@@ -308,7 +434,6 @@ int FFmpegMuxer::WritePacket(const stream_switch::MediaFrameInfo &frame_info,
         av_init_packet(&opkt);
         opkt.data = NULL;
         opkt.size = 0; 
-        struct timeval org_base_timestamp; 
         
         
         ret = parser->Parse(frame_info_p, frame_data, frame_size, &base_timestamp_, &opkt);
@@ -328,51 +453,84 @@ int FFmpegMuxer::WritePacket(const stream_switch::MediaFrameInfo &frame_info,
             break;
         }
                 
-//#define DUMP_PACKET    
-#ifdef DUMP_PACKET
-        {
-            STDERR_LOG(stream_switch::LOG_LEVEL_DEBUG,  
-                        "The following packet will be written to the output file\n");         
-            av_pkt_dump_log2(NULL, AV_LOG_DEBUG, &opkt, 0, 
-                         fmt_ctx_->streams[opkt.stream_index]);
-                         
-        }
-#endif          
-        if(frame_num_ == 0 && base_timestamp_.tv_sec > 0){
-            //first packet write
-            if(fmt_ctx_->oformat != NULL && 
-               av_match_name("cseg", fmt_ctx_->oformat->name) != 0 &&
-               fmt_ctx_->oformat->priv_class != NULL && 
-               fmt_ctx_->priv_data != NULL){
-                   
-                double start_ts = -1;                    
-                av_opt_get_double(fmt_ctx_->priv_data, "start_ts", 0, &start_ts);
-                if(start_ts <= 0.0){
-                    start_ts = (double)base_timestamp_.tv_sec + 
-                                (double)base_timestamp_.tv_usec / 1000000.0;
-                    av_opt_set_double(fmt_ctx_->priv_data, "start_ts", start_ts, 0); 
-                }//if(fmt_ctx_->oformat != NULL && 
-                
-            }//if(fmt_ctx_->oformat != NULL && 
-        }
-        StartIO();
-        ret = av_interleaved_write_frame(fmt_ctx_, &opkt);
-        StopIO();
+        ret = WriteParsedPacket(&opkt);
         if(ret){
-            char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
-            //some error ocurs in parse
-            STDERR_LOG(stream_switch::LOG_LEVEL_ERR,  
-                "Failed to write pkt to the output file:%s\n", 
-                av_make_error_string(errbuf, AV_ERROR_MAX_STRING_SIZE, ret));   
-            ret = FFMPEG_SENDER_ERR_IO;            
             break;  
         }
-        frame_num_++;
     }  
 
     return ret;
 }
 
+int FFmpegMuxer::WriteMirrorPacket(AVPacket *pkt, 
+                                   AVRational src_time_base, 
+                                   const struct timeval &base_timestamp)
+{
+    if(fmt_ctx_ == NULL){
+        STDERR_LOG(stream_switch::LOG_LEVEL_ERR,  
+                "FFmpegMuxer not open\n");
+        return -1;
+    } 
+    if(pkt->stream_index < 0 || 
+       (unsigned)pkt->stream_index >= fmt_ctx_->nb_streams){
+        STDERR_LOG(stream_switch::LOG_LEVEL_ERR,  
+                "stream_index is over the number of stream\n");
+        return -1;        
+    }
+    
+    base_timestamp_ = base_timestamp;
+    av_packet_rescale_ts(pkt, src_time_base, 
+                         fmt_ctx_->streams[pkt->stream_index]->time_base);
+    return WriteParsedPacket(pkt);
+}
+
+int FFmpegMuxer::WriteParsedPacket(AVPacket *opkt)
+{
+    int ret = 0;
+    
+//#define DUMP_PACKET    
+#ifdef DUMP_PACKET
+    {
+        STDERR_LOG(stream_switch::LOG_LEVEL_DEBUG,  
+                    "The following packet will be written to the output file\n");         
+        av_pkt_dump_log2(NULL, AV_LOG_DEBUG, opkt, 0, 
+                     fmt_ctx_->streams[opkt->stream_index]);
+                     
+    }
+#endif          
+    if(frame_num_ == 0 && base_timestamp_.tv_sec > 0){
+        //first packet write
+        if(fmt_ctx_->oformat != NULL && 
+           av_match_name("cseg", fmt_ctx_->oformat->name) != 0 &&
+           fmt_ctx_->oformat->priv_class != NULL && 
+           fmt_ctx_->priv_data != NULL){
+               
+            double start_ts = -1;                    
+            av_opt_get_double(fmt_ctx_->priv_data, "start_ts", 0, &start_ts);
+            if(start_ts <= 0.0){
+                start_ts = (double)base_timestamp_.tv_sec + 
+                            (double)base_timestamp_.tv_usec / 1000000.0;
+                av_opt_set_double(fmt_ctx_->priv_data, "start_ts", start_ts, 0); 
+            }//if(fmt_ctx_->oformat != NULL && 
+            
+        }//if(fmt_ctx_->oformat != NULL && 
+    }
+    StartIO();
+    ret = av_interleaved_write_frame(fmt_ctx_, opkt);
+    StopIO();
+    if(ret){
+        char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
+        //some error ocurs in parse
+        STDERR_LOG(stream_switch::LOG_LEVEL_ERR,  
+            "Failed to write pkt to the output file:%s\n", 
+            av_make_error_string(errbuf, AV_ERROR_MAX_STRING_SIZE, ret));   
+        return FFMPEG_SENDER_ERR_IO;            
+    }
+    frame_num_++;
+    
+    return 0;
+}
+
 uint32_t FFmpegMuxer::frame_num()
 {
     return frame_num_;
@@ -68,6 +68,23 @@ public:
     virtual int WritePacket(const stream_switch::MediaFrameInfo &frame_info, 
                             const char * frame_data, 
                             size_t frame_size);
+
+    // OpenMirror()
+    // Open the output with the same streams as src_ctx, whose packets have
+    // been parsed by another muxer. No parser is set up for this muxer, the
+    // packets are written by WriteMirrorPacket()
+    virtual int OpenMirror(const std::string &dest_url, 
+                           const std::string &format,
+                           const std::string &ffmpeg_options_str, 
+                           AVFormatContext *src_ctx, 
+                           unsigned long io_timeout);
+
+    // WriteMirrorPacket()
+    // write a packet parsed in the src_ctx of OpenMirror(), whose time
+    // is in src_time_base and starts from base_timestamp
+    virtual int WriteMirrorPacket(AVPacket *pkt, 
+                                  AVRational src_time_base, 
+                                  const struct timeval &base_timestamp);
                             
     virtual void Flush();
     virtual uint32_t frame_num();
@@ -85,6 +102,24 @@ protected:
     int IOInterruptCB();    
     virtual void StartIO();
     virtual void StopIO();
+
+    // InitParseContext()
+    // allocate fmt_ctx_ and set up the parsers (and the streams) for the
+    // sub streams of metadata, without opening the output
+    virtual int InitParseContext(const std::string &dest_url, 
+                                 const std::string &format,
+                                 const stream_switch::StreamMetadata &metadata, 
+                                 const std::string &acodec, 
+                                 unsigned long io_timeout);
+    virtual void UninitParseContext();
+
+    // OpenIO()
+    // open the output of fmt_ctx_ and write the header
+    virtual int OpenIO(const std::string &dest_url, AVDictionary **format_opts);
+
+    // WriteParsedPacket()
+    // write a packet returned by the parsers to the output
+    virtual int WriteParsedPacket(AVPacket *opkt);
     
     AVFormatContext *fmt_ctx_;    
     struct timespec io_start_ts_;
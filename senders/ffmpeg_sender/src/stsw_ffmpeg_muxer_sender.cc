@@ -43,6 +43,7 @@
 #include "stsw_ffmpeg_sender_global.h"
 #include "stsw_log.h"
 #include "stsw_ffmpeg_muxer.h"
+#include "stsw_ffmpeg_tee_muxer.h"
 
 
 FFmpegMuxerSender * FFmpegMuxerSender::s_instance = NULL;
@@ -52,8 +53,9 @@ FFmpegMuxerSender::FFmpegMuxerSender()
 :error_code_(0), is_started_(false)
 {
  
-    // create demuxer object for this input type
-    muxer_ = new FFmpegMuxer();
+    // all the outputs are written in the writer threads of the tee muxer,
+    // even if there is only one
+    muxer_ = new FFmpegTeeMuxer();
     sink_ = new stream_switch::StreamSink();
     last_stat_.ssrc = 0;
 }
@@ -77,10 +79,13 @@ FFmpegMuxerSender::~FFmpegMuxerSender()
 int FFmpegMuxerSender::Init(const std::string &dest_url, 
                             const std::string &format,
                             const std::string &ffmpeg_options_str,
+                            const MuxerOutputConfigVector &tee_outputs, 
                             const std::string &stream_name, 
                             const std::string &source_ip, int source_tcp_port, 
                             const std::string &acodec, 
                             unsigned long io_timeout,
+                            int64_t backlog, 
+                            int reconnect_count, 
                             //uint32_t muxer_retry_count, 
                             //uint32_t muxer_retry_interval, 
                             uint32_t sub_queue_size,              
@@ -149,13 +154,23 @@ int FFmpegMuxerSender::Init(const std::string &dest_url,
     
     clock_gettime(CLOCK_MONOTONIC, &sink_init_ts); 
     
-    //open the muxer
-    ret = muxer_->Open(dest_url, 
-                       format, 
-                       ffmpeg_options_str, 
-                       meta_, 
-                       acodec,
-                       io_timeout);
+    //open the muxer, dest_url is the first output of the tee
+    {
+        MuxerOutputConfigVector outputs;
+        MuxerOutputConfig config;
+        config.dest_url = dest_url;
+        config.format = format;
+        config.ffmpeg_options_str = ffmpeg_options_str;
+        outputs.push_back(config);
+        outputs.insert(outputs.end(), tee_outputs.begin(), tee_outputs.end());
+        
+        ret = muxer_->Open(outputs, 
+                           meta_, 
+                           acodec,
+                           io_timeout, 
+                           backlog, 
+                           reconnect_count);
+    }
     if(ret){
         STDERR_LOG(stream_switch::LOG_LEVEL_ERR, 
                    "Open muxer Failed (%d)\n", ret);  
@@ -295,6 +310,12 @@ void FFmpegMuxerSender::OnLiveMediaFrame(const stream_switch::MediaFrameInfo &fr
                                              
 }
     
+void FFmpegMuxerSender::LogOutputStatistic()
+{
+    STDERR_LOG(stream_switch::LOG_LEVEL_INFO, 
+               "Output statistic:\n%s", muxer_->FormatStatistic().c_str());
+}
+    
 void FFmpegMuxerSender::OnMetadataMismatch(uint32_t mismatch_ssrc)
 {
     error_code_ = FFMPEG_SENDER_ERR_EOF;
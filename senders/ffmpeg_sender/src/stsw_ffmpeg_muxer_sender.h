@@ -45,12 +45,14 @@
 
 #include <stream_switch.h>
 
+#include "stsw_muxer_output.h"
+
 
 
 ///////////////////////////////////////////////////////////////
 //Type
 
-class FFmpegMuxer;
+class FFmpegTeeMuxer;
 class FFmpegMuxerSender: public stream_switch::SinkListener{
   
 public:
@@ -78,10 +80,13 @@ public:
     int Init(const std::string &dest_url, 
              const std::string &format,
              const std::string &ffmpeg_options_str,
+             const MuxerOutputConfigVector &tee_outputs, 
              const std::string &stream_name, 
              const std::string &source_ip, int source_tcp_port, 
              const std::string &acodec, 
              unsigned long io_timeout,
+             int64_t backlog, 
+             int reconnect_count, 
              //uint32_t muxer_retry_count, 
              //uint32_t muxer_retry_interval, 
              
@@ -102,6 +107,11 @@ public:
     virtual void OnMetadataMismatch(uint32_t mismatch_ssrc);  
     
      void CheckFrameLost();
+     
+     // LogOutputStatistic()
+     // log the written/dropped packets, the backlog depth and the 
+     // reconnecting times of each output
+     void LogOutputStatistic();
        
 protected: 
     FFmpegMuxerSender();
@@ -110,7 +120,7 @@ protected:
 
 
     stream_switch::StreamSink *sink_; 
-    FFmpegMuxer * muxer_; 
+    FFmpegTeeMuxer * muxer_; 
     stream_switch::StreamMetadata meta_;
     int error_code_;
     
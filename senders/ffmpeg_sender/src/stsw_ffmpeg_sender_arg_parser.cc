@@ -87,6 +87,26 @@ void FFmpegSenderArgParser::RegisterSenderOptions()
                    "otherwise, the program would return error if the original codec differ "
                    "from CODEC_NAME",
                    NULL, NULL);                   
+    RegisterOption("backlog", 0, 
+                   OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG, "MS",
+                   "the max media time (in millisec) of the packets waiting to be written for each output. "
+                   "If an output is too slow to write and its backlog is full, the oldest GOP is dropped. "
+                   "Default is 5000 ms", NULL, NULL);
+    RegisterOption("reconnect-count", 0, 
+                   OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG, "NUM",
+                   "the max number of the consecutive attempts to reopen an output after it fails, "
+                   "the output resumes on the next key frame once reopened. "
+                   "A local file is never reopened. 0 means no reconnecting. Default is 5", NULL, NULL);
+    RegisterOption("tee", 0, 
+                   OPTION_FLAG_WITH_ARG, "OUTPUTS",
+                   "write the stream to the other outputs besides url, in the form of "
+                   "\"[f=FORMAT:NAME=VALUE]URL|[...]URL|...\". "
+                   "The options in the brackets are optional, f sets the output format, "
+                   "the others are passed to the ffmpeg muxing context of this output. "
+                   "The media frames are parsed (and transcoded) only once for all the outputs, "
+                   "and each output is written in its own thread, "
+                   "so a slow or failed output never blocks the others",
+                   NULL, NULL);
     RegisterOption("debug-flags", 'd', 
                     OPTION_FLAG_LONG | OPTION_FLAG_WITH_ARG,  "FLAG", 
                     "debug flag for stream_switch core library. "
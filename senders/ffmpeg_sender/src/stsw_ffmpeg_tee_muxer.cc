@@ -0,0 +1,183 @@
+/**
+ * This file is part of ffmpeg_sender, which belongs to StreamSwitch
+ * project.  
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/**
+ * stsw_ffmpeg_tee_muxer.cc
+ *      FFmpegTeeMuxer class implementation file, define its methods
+ * 
+ * author: OpenSight Team
+ * date: 2016-4-22
+**/ 
+
+#include "stsw_ffmpeg_tee_muxer.h"
+
+#include "stsw_ffmpeg_sender_global.h"
+#include "stsw_log.h"
+
+extern "C"{
+
+#include <libavcodec/avcodec.h>      
+}
+
+
+FFmpegTeeMuxer::FFmpegTeeMuxer()
+:FFmpegMuxer()
+{
+    
+}
+
+FFmpegTeeMuxer::~FFmpegTeeMuxer()
+{
+    Close();
+}
+
+int FFmpegTeeMuxer::Open(const MuxerOutputConfigVector &outputs, 
+                         const stream_switch::StreamMetadata &metadata, 
+                         const std::string &acodec, 
+                         unsigned long io_timeout, 
+                         int64_t backlog, 
+                         int reconnect_count)
+{
+    using namespace stream_switch; 
+    int ret = 0;
+    MuxerOutputConfigVector::const_iterator it;
+    
+    if(outputs.size() == 0){
+        STDERR_LOG(LOG_LEVEL_ERR, "No output for FFmpegTeeMuxer\n");  
+        return FFMPEG_SENDER_ERR_GENERAL;
+    }
+    
+    ret = InitParseContext(outputs[0].dest_url, outputs[0].format, 
+                           metadata, acodec, io_timeout);
+    if(ret){
+        return ret;
+    }
+    
+    for(it = outputs.begin(); it != outputs.end(); it++){
+        MuxerOutput *output = new MuxerOutput();
+        ret = output->Open(*it, fmt_ctx_, io_timeout, backlog, reconnect_count);
+        if(ret){
+            STDERR_LOG(LOG_LEVEL_ERR, 
+                       "The output %s cannot be opened (%d), skip it\n", 
+                       it->dest_url.c_str(), ret);  
+            delete output;
+            continue;
+        }
+        outputs_.push_back(output);
+    }
+    if(outputs_.size() == 0){
+        STDERR_LOG(LOG_LEVEL_ERR, "None of the outputs can be opened\n");  
+        UninitParseContext();
+        return FFMPEG_SENDER_ERR_GENERAL;
+    }
+    
+    base_timestamp_.tv_sec = 0;
+    base_timestamp_.tv_usec = 0;
+    frame_num_ = 0;
+    
+    return 0;
+}
+
+void FFmpegTeeMuxer::Close()
+{
+    MuxerOutputVector::iterator it;
+    
+    if(fmt_ctx_ == NULL){
+        return;
+    }
+    
+    for(it = outputs_.begin(); it != outputs_.end(); it++){
+        (*it)->Close();
+        STDERR_LOG(stream_switch::LOG_LEVEL_INFO, 
+                   "Output closed, %s", (*it)->FormatStatistic().c_str());
+        delete (*it);
+        (*it) = NULL;
+    }
+    outputs_.clear();
+    
+    // no IO is opened for the parsing context
+    UninitParseContext();
+}
+
+int FFmpegTeeMuxer::WritePacket(const stream_switch::MediaFrameInfo &frame_info, 
+                                const char * frame_data, 
+                                size_t frame_size)
+{
+    int ret;
+    
+    ret = FFmpegMuxer::WritePacket(frame_info, frame_data, frame_size);
+    if(ret == 0 && IsAllFailed()){
+        ret = FFMPEG_SENDER_ERR_IO;
+    }
+    return ret;
+}
+
+std::string FFmpegTeeMuxer::FormatStatistic()
+{
+    std::string text;
+    MuxerOutputVector::iterator it;
+    for(it = outputs_.begin(); it != outputs_.end(); it++){
+        text.append((*it)->FormatStatistic());
+    }
+    return text;
+}
+
+int FFmpegTeeMuxer::WriteParsedPacket(AVPacket *opkt)
+{
+    AVPacket shared_pkt;
+    MuxerOutputVector::iterator it;
+    
+    // make the packet reference counted, which copies the data only if it
+    // points to the received frame, then all the outputs share its data
+    // instead of copying it
+    av_init_packet(&shared_pkt);
+    shared_pkt.data = NULL;
+    shared_pkt.size = 0;
+    if(av_packet_ref(&shared_pkt, opkt) < 0){
+        STDERR_LOG(stream_switch::LOG_LEVEL_ERR,  
+                   "Failed to reference the packet of stream %d\n", 
+                   opkt->stream_index);   
+        av_free_packet(opkt);
+        return FFMPEG_SENDER_ERR_GENERAL;
+    }
+    av_free_packet(opkt);
+    
+    for(it = outputs_.begin(); it != outputs_.end(); it++){
+        (*it)->Push(&shared_pkt, base_timestamp_);
+    }
+    av_free_packet(&shared_pkt);
+    
+    frame_num_++;
+    return 0;
+}
+
+bool FFmpegTeeMuxer::IsAllFailed()
+{
+    MuxerOutputVector::iterator it;
+    for(it = outputs_.begin(); it != outputs_.end(); it++){
+        if(!(*it)->IsFailed()){
+            return false;
+        }
+    }
+    return true;
+}
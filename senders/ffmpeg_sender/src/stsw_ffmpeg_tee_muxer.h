@@ -0,0 +1,82 @@
+/**
+ * This file is part of ffmpeg_sender, which belongs to StreamSwitch
+ * project.  
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/**
+ * stsw_ffmpeg_tee_muxer.h
+ *      FFmpegTeeMuxer class header file, define intefaces of the 
+ * FFmpegTeeMuxer class. 
+ *      FFmpegTeeMuxer writes one stream to several destinations, parsing 
+ * (and transcoding) the media frames only once for all of them
+ * 
+ * author: OpenSight Team
+ * date: 2016-4-22
+**/ 
+
+#ifndef STSW_FFMPEG_TEE_MUXER_H
+#define STSW_FFMPEG_TEE_MUXER_H
+
+#include <string>
+#include <stream_switch.h>
+
+#include "stsw_ffmpeg_muxer.h"
+#include "stsw_muxer_output.h"
+
+
+// FFmpegTeeMuxer
+//    The parsers run in the format context of this muxer, which is never
+// opened for IO (its format is taken from the first output, to decide if
+// the global header is required). Every parsed packet is dispatched to
+// all the outputs by reference, each of which mirrors the streams of this
+// context and writes in its own thread with a backlog, so that a stalled
+// or failed destination never blocks the others.
+//    A failed output is reconnected in place by itself, WritePacket() only
+// fails when all the outputs have run out of the reconnecting attempts.
+class FFmpegTeeMuxer:public FFmpegMuxer{
+public:
+    FFmpegTeeMuxer();
+    virtual ~FFmpegTeeMuxer();
+    
+    // Open()
+    // open all the outputs, the ones which cannot be opened are skipped.
+    // Fail if none of them is opened. backlog is in ms
+    virtual int Open(const MuxerOutputConfigVector &outputs, 
+                     const stream_switch::StreamMetadata &metadata, 
+                     const std::string &acodec, 
+                     unsigned long io_timeout, 
+                     int64_t backlog, 
+                     int reconnect_count);
+    virtual void Close();
+    virtual int WritePacket(const stream_switch::MediaFrameInfo &frame_info, 
+                            const char * frame_data, 
+                            size_t frame_size);
+    
+    virtual std::string FormatStatistic();
+    
+protected:
+    virtual int WriteParsedPacket(AVPacket *opkt);
+    virtual bool IsAllFailed();
+    
+    MuxerOutputVector outputs_;
+};
+
+#endif
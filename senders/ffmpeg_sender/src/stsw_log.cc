@@ -90,6 +90,9 @@ static void AvlogCallback(void *avcl, int level, const char *fmt,
                      va_list vl)
 {
     static int print_prefix = 1;
+    if(level > av_log_get_level()){
+        return; // filter before formatting, like the default callback
+    }
     char * tmp_av_log_buf = new char[MAX_AV_LOG_SIZE + 1];
     tmp_av_log_buf[MAX_AV_LOG_SIZE] = 0;
     av_log_format_line(avcl, level, fmt, vl, 
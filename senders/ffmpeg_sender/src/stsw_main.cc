@@ -49,6 +49,7 @@ extern "C"{
 #include "stsw_ffmpeg_sender_arg_parser.h"
 #include "stsw_log.h"
 #include "stsw_ffmpeg_muxer_sender.h"
+#include "stsw_muxer_output.h"
 
 
 extern volatile bool global_persistence;
@@ -66,11 +67,65 @@ extern volatile bool global_persistence;
 
 #define FRAME_LOST_CHECK_INTERVAL  1
 
+#define OUTPUT_STATISTIC_INTERVAL  60
+
 
 
 ///////////////////////////////////////////////////////////////
 //functions
 
+// ParseTeeOutputs()
+// parse the tee option in the form of "[f=FORMAT:NAME=VALUE]URL|...",
+// return -1 if some output has no url
+int ParseTeeOutputs(const std::string &tee, MuxerOutputConfigVector *outputs)
+{
+    size_t start = 0;
+    
+    outputs->clear();
+    while(start <= tee.size()){
+        size_t end = tee.find('|', start);
+        if(end == std::string::npos){
+            end = tee.size();
+        }
+        std::string item = tee.substr(start, end - start);
+        MuxerOutputConfig config;
+        
+        if(item.size() != 0 && item[0] == '['){
+            size_t close = item.find(']');
+            if(close == std::string::npos){
+                return -1;
+            }
+            std::string opts = item.substr(1, close - 1);
+            size_t opt_start = 0;
+            while(opt_start < opts.size()){
+                size_t opt_end = opts.find(':', opt_start);
+                if(opt_end == std::string::npos){
+                    opt_end = opts.size();
+                }
+                std::string opt = opts.substr(opt_start, opt_end - opt_start);
+                if(opt.compare(0, 2, "f=") == 0){
+                    config.format = opt.substr(2);
+                }else if(opt.size() != 0){
+                    if(config.ffmpeg_options_str.size() != 0){
+                        config.ffmpeg_options_str.append(",");
+                    }
+                    config.ffmpeg_options_str.append(opt);
+                }
+                opt_start = opt_end + 1;
+            }
+            item = item.substr(close + 1);
+        }
+        if(item.size() == 0){
+            return -1;
+        }
+        config.dest_url = item;
+        outputs->push_back(config);
+        
+        start = end + 1;
+    }
+    return 0;
+}
+
 
 void ParseArgv(int argc, char *argv[], 
                FFmpegSenderArgParser *parser)
@@ -128,6 +183,13 @@ void ParseArgv(int argc, char *argv[],
         fprintf(stderr, "url cannot be empty string\n");
         exit(-1);        
     }
+    if(parser->CheckOption("tee")){
+        MuxerOutputConfigVector outputs;
+        if(ParseTeeOutputs(parser->OptionValue("tee", ""), &outputs)){
+            fprintf(stderr, "tee option is malformed, every output must have a URL\n");
+            exit(-1);
+        }
+    }
     if(parser->CheckOption("log-file")){
         if(!parser->CheckOption("log-size")){
             fprintf(stderr, "log-size must be set if log-file is enabled\n");
@@ -154,6 +216,8 @@ int main(int argc, char *argv[])
     struct timespec last_frame_ts;    
     uint32_t last_frame_num = 0;
     struct timespec lost_check_ts;
+    struct timespec statistic_ts;
+    MuxerOutputConfigVector tee_outputs;
     
     GlobalInit();
     
@@ -164,6 +228,9 @@ int main(int argc, char *argv[])
     max_duration = (uint64_t)strtoul(parser.OptionValue("duration", "0").c_str(), NULL, 0);
     max_frame_gap = (uint64_t)strtoul(parser.OptionValue("inter-frame-gap", "20000").c_str(), NULL, 0);
     sub_queue_size = (uint32_t)strtoul(parser.OptionValue("queue-size", "120").c_str(), NULL, 0);      
+    if(parser.CheckOption("tee")){
+        ParseTeeOutputs(parser.OptionValue("tee", ""), &tee_outputs);
+    }
     
     //
     // init global logger
@@ -203,10 +270,13 @@ int main(int argc, char *argv[])
         parser.OptionValue("url", ""), 
         parser.OptionValue("format", ""), 
         parser.ffmpeg_options(), 
+        tee_outputs, 
         parser.OptionValue("stream-name", ""), 
         parser.OptionValue("host", ""), (int)strtol(parser.OptionValue("port", "0").c_str(), NULL, 0), 
         parser.OptionValue("acodec", ""),
         strtoul(parser.OptionValue("io_timeout", "10000").c_str(), NULL, 0), 
+        (int64_t)strtoll(parser.OptionValue("backlog", "5000").c_str(), NULL, 0), 
+        (int)strtol(parser.OptionValue("reconnect-count", "5").c_str(), NULL, 0), 
         sub_queue_size, 
         (uint32_t)strtoul(parser.OptionValue("debug-flags", "0").c_str(), NULL, 0));
     if(ret){
@@ -230,7 +300,7 @@ int main(int argc, char *argv[])
     //from here, sender has started successful
     
     clock_gettime(CLOCK_MONOTONIC, &start_ts);  
-    cur_ts = last_frame_ts = lost_check_ts = start_ts;
+    cur_ts = last_frame_ts = lost_check_ts = statistic_ts = start_ts;
     
     //heartbeat check
     while(1){        
@@ -287,6 +357,13 @@ int main(int argc, char *argv[])
             lost_check_ts = cur_ts;
         }
         
+        // report the backlog and reconnecting of the outputs
+        if(cur_ts.tv_sec - statistic_ts.tv_sec >= 
+            OUTPUT_STATISTIC_INTERVAL){
+            sender->LogOutputStatistic();
+            statistic_ts = cur_ts;
+        }
+        
         
         // check signal
         if(isGlobalInterrupt()){
@@ -0,0 +1,473 @@
+/**
+ * This file is part of ffmpeg_sender, which belongs to StreamSwitch
+ * project.  
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/**
+ * stsw_muxer_output.cc
+ *      MuxerOutput class implementation file, define its methods
+ * 
+ * author: OpenSight Team
+ * date: 2016-4-22
+**/ 
+
+#include "stsw_muxer_output.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include "stsw_ffmpeg_muxer.h"
+#include "stsw_ffmpeg_sender_global.h"
+#include "stsw_log.h"
+
+extern "C"{
+
+#include <libavcodec/avcodec.h>      
+}
+
+
+MuxerOutput::MuxerOutput()
+:src_ctx_(NULL), io_timeout_(0), has_video_(false), is_reconnectable_(false), 
+reconnect_count_(0), packet_num_(0), 
+backlog_((int64_t)MUXER_OUTPUT_DEFAULT_BACKLOG * 1000), waiting_key_(false), 
+is_overflowed_(false), is_open_(false), is_stopping_(false), error_code_(0), 
+written_packets_(0), dropped_packets_(0), dropped_gops_(0), reconnects_(0)
+{
+    muxer_ = new FFmpegMuxer();
+    drain_deadline_.tv_sec = 0;
+    drain_deadline_.tv_nsec = 0;
+    pthread_mutex_init(&lock_, NULL);
+    pthread_cond_init(&not_empty_, NULL);
+}
+
+MuxerOutput::~MuxerOutput()
+{
+    Close();
+    pthread_cond_destroy(&not_empty_);
+    pthread_mutex_destroy(&lock_);
+    if(muxer_ != NULL){
+        delete muxer_;
+        muxer_ = NULL;
+    }
+}
+
+int MuxerOutput::Open(const MuxerOutputConfig &config, 
+                      AVFormatContext *src_ctx, 
+                      unsigned long io_timeout, 
+                      int64_t backlog, 
+                      int reconnect_count)
+{
+    int ret = 0;
+    unsigned int i;
+    const char * protocol_name = NULL;
+    
+    if(is_open_){
+        return 0;
+    }
+    
+    ret = muxer_->OpenMirror(config.dest_url, 
+                             config.format, 
+                             config.ffmpeg_options_str, 
+                             src_ctx, 
+                             io_timeout);
+    if(ret){
+        STDERR_LOG(stream_switch::LOG_LEVEL_ERR, 
+                   "Open muxer Failed (%d) for the output: %s\n", 
+                   ret, config.dest_url.c_str());  
+        return ret;
+    }
+    
+    src_ctx_ = src_ctx;
+    config_ = config;
+    io_timeout_ = io_timeout;
+    has_video_ = false;
+    for(i = 0; i < src_ctx->nb_streams; i++){
+        if(src_ctx->streams[i]->codec->codec_type == AVMEDIA_TYPE_VIDEO){
+            has_video_ = true;
+        }
+    }
+    protocol_name = avio_find_protocol_name(config.dest_url.c_str());
+    is_reconnectable_ = 
+        (protocol_name == NULL || strcmp(protocol_name, "file") != 0);
+    reconnect_count_ = (reconnect_count > 0) ? reconnect_count : 0;
+    
+    backlog_ = (backlog > 0) ? backlog * 1000 : 
+               (int64_t)MUXER_OUTPUT_DEFAULT_BACKLOG * 1000;
+    packet_num_ = 0;
+    waiting_key_ = false;
+    is_overflowed_ = false;
+    is_stopping_ = false;
+    error_code_ = 0;
+    written_packets_ = 0;
+    dropped_packets_ = 0;
+    dropped_gops_ = 0;
+    reconnects_ = 0;
+    
+    ret = pthread_create(&write_thread_id_, NULL, 
+                         MuxerOutput::StaticWriteThreadRoutine, this);
+    if(ret){
+        STDERR_LOG(stream_switch::LOG_LEVEL_ERR, 
+                   "pthread_create failed (%d) for the output: %s\n", 
+                   ret, config_.dest_url.c_str());  
+        muxer_->Close();
+        return FFMPEG_SENDER_ERR_GENERAL;
+    }
+    
+    is_open_ = true;
+    return 0;
+}
+
+void MuxerOutput::Close()
+{
+    if(!is_open_){
+        return;
+    }
+    
+    pthread_mutex_lock(&lock_);
+    is_stopping_ = true;
+    clock_gettime(CLOCK_MONOTONIC, &drain_deadline_);
+    drain_deadline_.tv_sec += MUXER_OUTPUT_CLOSE_TIMEOUT / 1000;
+    drain_deadline_.tv_nsec += 
+        (long)(MUXER_OUTPUT_CLOSE_TIMEOUT % 1000) * 1000000;
+    if(drain_deadline_.tv_nsec >= 1000000000){
+        drain_deadline_.tv_sec++;
+        drain_deadline_.tv_nsec -= 1000000000;
+    }
+    pthread_cond_signal(&not_empty_);
+    pthread_mutex_unlock(&lock_);
+    
+    pthread_join(write_thread_id_, NULL);
+    
+    pthread_mutex_lock(&lock_);
+    FlushQueue();
+    pthread_mutex_unlock(&lock_);
+    
+    muxer_->Close();
+    
+    is_open_ = false;
+}
+
+void MuxerOutput::Push(const AVPacket *pkt, const struct timeval &base_timestamp)
+{
+    MuxerOutputPacket node;
+    int64_t ts;
+    
+    pthread_mutex_lock(&lock_);
+    if(!is_open_ || is_stopping_ || error_code_ != 0){
+        pthread_mutex_unlock(&lock_);
+        return;
+    }
+    
+    node.is_gop_start = IsGopStart(pkt);
+    if(waiting_key_){
+        if(!node.is_gop_start){
+            dropped_packets_++;
+            pthread_mutex_unlock(&lock_);
+            return;
+        }
+        waiting_key_ = false;
+    }
+    
+    av_init_packet(&node.pkt);
+    node.pkt.data = NULL;
+    node.pkt.size = 0;
+    if(av_packet_ref(&node.pkt, pkt) < 0){
+        dropped_packets_++;
+        waiting_key_ = true;
+        pthread_mutex_unlock(&lock_);
+        return;
+    }
+    ts = (pkt->dts != AV_NOPTS_VALUE) ? pkt->dts : pkt->pts;
+    node.time = (ts != AV_NOPTS_VALUE) ? 
+        av_rescale_q(ts, src_ctx_->streams[pkt->stream_index]->time_base, 
+                     AV_TIME_BASE_Q) : 0;
+    node.base_timestamp = base_timestamp;
+    
+    packets_.push_back(node);
+    packet_num_++;
+    
+    if(IsFull()){
+        if(!is_overflowed_){
+            STDERR_LOG(stream_switch::LOG_LEVEL_WARNING, 
+                       "The backlog of the output %s is full, "
+                       "drop the oldest GOPs\n", 
+                       config_.dest_url.c_str());  
+            is_overflowed_ = true;
+        }
+        while(IsFull()){
+            DropHeadGop();
+        }
+        if(packets_.empty()){
+            // the backlog is shorter than the current GOP, which has
+            // been dropped together with this packet
+            waiting_key_ = true;
+        }
+    }
+    
+    pthread_cond_signal(&not_empty_);
+    pthread_mutex_unlock(&lock_);
+}
+
+bool MuxerOutput::IsFailed()
+{
+    bool is_failed;
+    pthread_mutex_lock(&lock_);
+    is_failed = (error_code_ != 0);
+    pthread_mutex_unlock(&lock_);
+    return is_failed;
+}
+
+void MuxerOutput::GetStatistic(MuxerOutputStatistic *statistic)
+{
+    if(statistic == NULL){
+        return;
+    }
+    pthread_mutex_lock(&lock_);
+    statistic->written_packets = written_packets_;
+    statistic->dropped_packets = dropped_packets_;
+    statistic->dropped_gops = dropped_gops_;
+    statistic->backlog_time = FillTime() / 1000;
+    statistic->backlog_packets = (uint32_t)packet_num_;
+    statistic->reconnects = reconnects_;
+    statistic->error_code = error_code_;
+    pthread_mutex_unlock(&lock_);
+}
+
+std::string MuxerOutput::FormatStatistic()
+{
+    MuxerOutputStatistic statistic;
+    char tmp[256];
+    
+    GetStatistic(&statistic);
+    snprintf(tmp, sizeof(tmp), 
+             "written_packets:%llu dropped_packets:%llu dropped_gops:%llu "
+             "backlog:%lld backlog_packets:%u reconnects:%u error:%d\n", 
+             (unsigned long long)statistic.written_packets, 
+             (unsigned long long)statistic.dropped_packets, 
+             (unsigned long long)statistic.dropped_gops, 
+             (long long)statistic.backlog_time, 
+             (unsigned)statistic.backlog_packets, 
+             (unsigned)statistic.reconnects, 
+             statistic.error_code);
+    return config_.dest_url + " " + tmp;
+}
+
+const std::string &MuxerOutput::dest_url()
+{
+    return config_.dest_url;
+}
+
+void * MuxerOutput::StaticWriteThreadRoutine(void *arg)
+{
+    MuxerOutput *output = (MuxerOutput *)arg;
+    output->InternalWriteRoutine();
+    return NULL;
+}
+
+void MuxerOutput::InternalWriteRoutine()
+{
+    int ret = 0;
+    MuxerOutputPacket node;
+    
+    pthread_mutex_lock(&lock_);
+    while(1){
+        while(packets_.empty() && !is_stopping_){
+            is_overflowed_ = false;
+            pthread_cond_wait(&not_empty_, &lock_);
+        }
+        if(packets_.empty()){
+            // stopping, and all the queued packets have been written
+            break;
+        }
+        if(is_stopping_ && IsDrainTimeout()){
+            // the destination cannot keep up, give up the rest
+            STDERR_LOG(stream_switch::LOG_LEVEL_WARNING, 
+                       "The output %s is not drained in %d ms on close, "
+                       "drop the %u packets left\n", 
+                       config_.dest_url.c_str(), MUXER_OUTPUT_CLOSE_TIMEOUT, 
+                       (unsigned)packet_num_);  
+            dropped_packets_ += packet_num_;
+            FlushQueue();
+            break;
+        }
+        node = packets_.front();
+        packets_.pop_front();
+        packet_num_--;
+        pthread_mutex_unlock(&lock_);
+        
+        // the stream time base of src_ctx_ never changes after opened
+        ret = muxer_->WriteMirrorPacket(&node.pkt, 
+            src_ctx_->streams[node.pkt.stream_index]->time_base, 
+            node.base_timestamp);
+        av_free_packet(&node.pkt);
+        
+        pthread_mutex_lock(&lock_);
+        if(ret){
+            if(Reconnect(ret)){
+                continue;
+            }
+            if(!is_stopping_){
+                STDERR_LOG(stream_switch::LOG_LEVEL_ERR, 
+                           "Write packet failed (ret: %d) for the output %s, "
+                           "which is stopped\n", 
+                           ret, config_.dest_url.c_str());  
+                error_code_ = ret;
+            }
+            FlushQueue();
+            break;
+        }
+        written_packets_++;
+    }
+    pthread_mutex_unlock(&lock_);
+}
+
+bool MuxerOutput::Reconnect(int err)
+{
+    int attempt;
+    int ret;
+    
+    // the packets queued are not decodable without the ones failed,
+    // resume on the next key frame
+    FlushQueue();
+    waiting_key_ = true;
+    
+    if(!is_reconnectable_ || reconnect_count_ <= 0){
+        return false;
+    }
+    
+    pthread_mutex_unlock(&lock_);
+    muxer_->Close();
+    pthread_mutex_lock(&lock_);
+    
+    for(attempt = 1; attempt <= reconnect_count_; attempt++){
+        if(!WaitReconnect(MUXER_OUTPUT_RECONNECT_INTERVAL)){
+            return false;
+        }
+        STDERR_LOG(stream_switch::LOG_LEVEL_WARNING, 
+                   "Reconnect the output %s after error %d (attempt %d/%d)\n", 
+                   config_.dest_url.c_str(), err, attempt, reconnect_count_);  
+        
+        pthread_mutex_unlock(&lock_);
+        ret = muxer_->OpenMirror(config_.dest_url, 
+                                 config_.format, 
+                                 config_.ffmpeg_options_str, 
+                                 src_ctx_, 
+                                 io_timeout_);
+        pthread_mutex_lock(&lock_);
+        if(ret == 0){
+            reconnects_++;
+            STDERR_LOG(stream_switch::LOG_LEVEL_INFO, 
+                       "The output %s is reconnected (%u times)\n", 
+                       config_.dest_url.c_str(), (unsigned)reconnects_);  
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MuxerOutput::WaitReconnect(int interval)
+{
+    // the caller should hold lock_
+    struct timespec deadline;
+    
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += interval / 1000;
+    deadline.tv_nsec += (long)(interval % 1000) * 1000000;
+    if(deadline.tv_nsec >= 1000000000){
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+    while(!is_stopping_){
+        if(pthread_cond_timedwait(&not_empty_, &lock_, &deadline) == ETIMEDOUT){
+            break;
+        }
+    }
+    return !is_stopping_;
+}
+
+bool MuxerOutput::IsDrainTimeout()
+{
+    // the caller should hold lock_
+    struct timespec cur_ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &cur_ts);
+    return cur_ts.tv_sec > drain_deadline_.tv_sec || 
+           (cur_ts.tv_sec == drain_deadline_.tv_sec && 
+            cur_ts.tv_nsec >= drain_deadline_.tv_nsec);
+}
+
+bool MuxerOutput::IsGopStart(const AVPacket *pkt)
+{
+    if(!(pkt->flags & AV_PKT_FLAG_KEY)){
+        return false;
+    }
+    if(!has_video_){
+        return true;
+    }
+    return src_ctx_->streams[pkt->stream_index]->codec->codec_type == 
+           AVMEDIA_TYPE_VIDEO;
+}
+
+bool MuxerOutput::IsFull()
+{
+    return packet_num_ >= MUXER_OUTPUT_MAX_PACKETS || 
+           FillTime() > backlog_;
+}
+
+int64_t MuxerOutput::FillTime()
+{
+    int64_t fill_time;
+    if(packet_num_ < 2){
+        return 0;
+    }
+    fill_time = packets_.back().time - packets_.front().time;
+    return (fill_time > 0) ? fill_time : 0;
+}
+
+void MuxerOutput::DropHeadGop()
+{
+    // the caller should hold lock_. Drop the head packet, and the ones 
+    // after it until the next GOP. If the writer has written a part of 
+    // the head GOP, the rest of it is dropped
+    if(packets_.empty()){
+        return;
+    }
+    do{
+        av_free_packet(&(packets_.front().pkt));
+        packets_.pop_front();
+        packet_num_--;
+        dropped_packets_++;
+    }while(!packets_.empty() && !packets_.front().is_gop_start);
+    dropped_gops_++;
+}
+
+void MuxerOutput::FlushQueue()
+{
+    // the caller should hold lock_
+    MuxerOutputPacketList::iterator it;
+    for(it = packets_.begin(); it != packets_.end(); it++){
+        av_free_packet(&(it->pkt));
+    }
+    packets_.clear();
+    packet_num_ = 0;
+}
@@ -0,0 +1,188 @@
+/**
+ * This file is part of ffmpeg_sender, which belongs to StreamSwitch
+ * project.  
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+/**
+ * stsw_muxer_output.h
+ *      MuxerOutput class header file, define intefaces of the MuxerOutput 
+ * class. 
+ *      MuxerOutput is one destination of FFmpegTeeMuxer, which writes the 
+ * parsed packets to its own FFmpegMuxer in a separate thread
+ * 
+ * author: OpenSight Team
+ * date: 2016-4-22
+**/ 
+
+#ifndef STSW_MUXER_OUTPUT_H
+#define STSW_MUXER_OUTPUT_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <string>
+#include <vector>
+#include <list>
+
+extern "C"{
+
+#include <libavutil/avutil.h>    
+#include <libavformat/avformat.h>      
+}
+
+// the default media time span of the packets waiting to be written
+#define MUXER_OUTPUT_DEFAULT_BACKLOG  5000     // in ms
+
+// bound the backlog by the packet number as well, in case the packets
+// have no valid timestamp
+#define MUXER_OUTPUT_MAX_PACKETS  8192
+
+// the default max number of the consecutive reconnecting attempts after 
+// a write error, 0 means the output stops at once
+#define MUXER_OUTPUT_DEFAULT_RECONNECT_COUNT  5
+
+#define MUXER_OUTPUT_RECONNECT_INTERVAL  1000   // in ms
+
+// the max time Close() waits for the backlog to be written, the rest
+// is dropped then. A write in progress is bounded by io_timeout
+#define MUXER_OUTPUT_CLOSE_TIMEOUT  3000   // in ms
+
+
+class FFmpegMuxer;
+
+struct MuxerOutputConfig{
+    std::string dest_url;
+    std::string format;
+    std::string ffmpeg_options_str;
+};
+typedef std::vector<MuxerOutputConfig> MuxerOutputConfigVector;
+
+struct MuxerOutputStatistic{
+    uint64_t written_packets;
+    uint64_t dropped_packets;   // dropped because the backlog is full or 
+                                // the output is reconnecting
+    uint64_t dropped_gops;
+    int64_t backlog_time;       // the media time span in the backlog, in ms
+    uint32_t backlog_packets;
+    uint32_t reconnects;        // the times the output has been reopened
+    int error_code;             // the write error which stops this output
+};
+
+struct MuxerOutputPacket{
+    AVPacket pkt;
+    int64_t time;               // the dts (or pts), in us
+    bool is_gop_start;
+    struct timeval base_timestamp;
+};
+typedef std::list<MuxerOutputPacket> MuxerOutputPacketList;
+
+
+// MuxerOutput
+//    Push() never blocks the caller: the packet is referenced (not copied)
+// into the backlog, and the writer thread of this output writes it to
+// the destination. The backlog is bounded by the media time span of its
+// packets. When the destination stalls and the backlog is full, the
+// oldest GOP is dropped as a whole, so the output always resumes from a 
+// key frame (the GOP starts at a video key frame, or any key frame if 
+// there is no video stream).
+//    If the writing fails, the destination is reopened in place with the
+// same streams, up to reconnect_count consecutive attempts, and the output 
+// resumes on the next key frame, without affecting the other outputs and 
+// the subscription. A local file is never reopened, which would truncate 
+// it. Once the attempts run out, this output stops and drops all the 
+// packets pushed afterwards.
+class MuxerOutput{
+public:
+    MuxerOutput();
+    virtual ~MuxerOutput();
+    
+    // Open()
+    // open the destination with the streams of src_ctx, in which the
+    // packets are parsed, and start the writer thread. backlog is in ms
+    virtual int Open(const MuxerOutputConfig &config, 
+                     AVFormatContext *src_ctx, 
+                     unsigned long io_timeout, 
+                     int64_t backlog, 
+                     int reconnect_count);
+    
+    // Close()
+    // stop the writer thread after the queued packets are written, or 
+    // drop the rest of them after MUXER_OUTPUT_CLOSE_TIMEOUT, then write 
+    // the trailer and close the destination
+    virtual void Close();
+    
+    // Push()
+    // queue a new reference to pkt, whose time starts from base_timestamp
+    virtual void Push(const AVPacket *pkt, const struct timeval &base_timestamp);
+    
+    virtual bool IsFailed();
+    virtual void GetStatistic(MuxerOutputStatistic *statistic);
+    virtual std::string FormatStatistic();
+    
+    const std::string &dest_url();
+    
+protected:
+    static void * StaticWriteThreadRoutine(void *arg);
+    virtual void InternalWriteRoutine();
+    
+    // Reconnect()
+    // reopen the destination after the write error err, called with 
+    // lock_ held. Return false if the attempts run out or stopping
+    virtual bool Reconnect(int err);
+    virtual bool WaitReconnect(int interval);
+    virtual bool IsDrainTimeout();
+    
+    virtual bool IsGopStart(const AVPacket *pkt);
+    virtual bool IsFull();
+    virtual int64_t FillTime();
+    virtual void DropHeadGop();
+    virtual void FlushQueue();
+    
+    FFmpegMuxer * muxer_;
+    AVFormatContext *src_ctx_;
+    MuxerOutputConfig config_;
+    unsigned long io_timeout_;
+    bool has_video_;
+    bool is_reconnectable_;
+    int reconnect_count_;
+    
+    pthread_mutex_t lock_;
+    pthread_cond_t not_empty_;
+    MuxerOutputPacketList packets_;
+    size_t packet_num_;
+    int64_t backlog_;           // in us
+    bool waiting_key_;
+    bool is_overflowed_;
+    
+    pthread_t write_thread_id_;
+    bool is_open_;
+    bool is_stopping_;
+    struct timespec drain_deadline_;    // CLOCK_MONOTONIC, set by Close()
+    int error_code_;
+    uint64_t written_packets_;
+    uint64_t dropped_packets_;
+    uint64_t dropped_gops_;
+    uint32_t reconnects_;
+};
+
+typedef std::vector<MuxerOutput *> MuxerOutputVector;
+
+#endif
@@ -0,0 +1,95 @@
+/**
+ * This file is part of libstreamswtich, which belongs to StreamSwitch
+ * project. 
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_aac_parser.cc
+ *      AacParser class implementation file, define methods of the AacParser 
+ * class. 
+ * 
+ * author: OpenSight Team
+ * date: 2016-4-21
+**/ 
+
+#include "stsw_aac_parser.h"
+#include "../stsw_ffmpeg_demuxer.h"
+#include "../stsw_ffmpeg_source_global.h"
+#include "../stsw_log.h"
+
+extern "C"{
+
+ 
+#include <libavcodec/avcodec.h>      
+}
+
+#define ADTS_HEADER_SIZE  7
+#define AAC_SAMPLES_PER_FRAME  1024
+
+static const uint32_t aac_sample_rates[16] = {
+    96000, 88200, 64000, 48000, 44100, 32000,
+    24000, 22050, 16000, 12000, 11025, 8000, 7350, 0, 0, 0
+};
+
+int AacParser::DoUpdateMeta(AVPacket *pkt, bool* is_meta_changed)
+{
+    bool meta_changed = false;
+    stream_switch::SubStreamMetadata & sub_stream = 
+        demuxer_->meta_.sub_streams[stream_index_];
+    const uint8_t *p = pkt->data;
+    
+    // Only for the input without AudioSpecificConfig (e.g. MPEG-TS), whose 
+    // packets carry the ADTS header, see 1.A.2.2 of ISO/IEC 14496-3
+    if(sub_stream.extra_data.empty() && 
+       pkt->size >= ADTS_HEADER_SIZE && 
+       p[0] == 0xff && (p[1] & 0xf0) == 0xf0){
+        uint8_t profile = p[2] >> 6;
+        uint8_t sample_rate_index = (p[2] >> 2) & 0x0f;
+        uint8_t channel_config = ((p[2] & 0x01) << 2) | (p[3] >> 6);
+        char config[2];
+        
+        if(aac_sample_rates[sample_rate_index] != 0){
+            // audioObjectType(5) + samplingFrequencyIndex(4) + 
+            // channelConfiguration(4) + GASpecificConfig(3, all zero)
+            config[0] = (char)(((profile + 1) << 3) | (sample_rate_index >> 1));
+            config[1] = (char)(((sample_rate_index & 0x01) << 7) | 
+                               (channel_config << 3));
+            sub_stream.extra_data.assign(config, 2);
+            
+            if(sub_stream.media_param.audio.samples_per_second == 0){
+                sub_stream.media_param.audio.samples_per_second = 
+                    aac_sample_rates[sample_rate_index];
+            }
+            if(sub_stream.media_param.audio.channels == 0 && channel_config != 0){
+                sub_stream.media_param.audio.channels = channel_config;
+            }
+            if(sub_stream.media_param.audio.sampele_per_frame == 0){
+                sub_stream.media_param.audio.sampele_per_frame = 
+                    AAC_SAMPLES_PER_FRAME;
+            }
+            meta_changed = true;
+        }
+    }
+    
+    if(is_meta_changed != NULL){
+        (*is_meta_changed) = meta_changed;
+    }
+    return 0;
+}
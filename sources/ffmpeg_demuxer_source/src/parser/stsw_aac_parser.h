@@ -0,0 +1,48 @@
+/**
+ * This file is part of libstreamswtich, which belongs to StreamSwitch
+ * project. 
+ * 
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ * 
+ * StreamSwitch is an extensible and scalable media stream server for 
+ * multi-protocol environment. 
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_aac_parser.h
+ *      AacParser class header file, define intefaces of the AacParser 
+ * class. 
+ *      AacParser is the child class of StreamParser, which builds the 
+ * AudioSpecificConfig of the metadata from the ADTS header if the input 
+ * does not provide it
+ * 
+ * author: OpenSight Team
+ * date: 2016-4-21
+**/ 
+
+#ifndef STSW_AAC_PARSER_H
+#define STSW_AAC_PARSER_H
+
+
+#include "stsw_stream_parser.h"
+
+class AacParser: public StreamParser{
+  
+protected:
+    virtual int DoUpdateMeta(AVPacket *pkt, bool* is_meta_changed);
+
+};
+
+#endif
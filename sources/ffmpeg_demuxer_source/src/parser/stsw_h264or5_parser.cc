@@ -57,6 +57,271 @@ H264or5Parser::~H264or5Parser()
 #define RB16(x) ((((uint8_t*)(x))[0] << 8) | ((uint8_t*)(x))[1])
 
 
+// bit reader over the RBSP of a NAL, the emulation prevention bytes 
+// (00 00 03) are removed when constructing
+class RbspBitReader{
+public:
+    RbspBitReader(const uint8_t *data, size_t size)
+    :pos_(0), overrun_(false)
+    {
+        int zeros = 0;
+        rbsp_.reserve(size);
+        for(size_t i = 0; i < size; i++){
+            if(zeros >= 2 && data[i] == 3){
+                zeros = 0;
+                continue;
+            }
+            zeros = (data[i] == 0) ? zeros + 1 : 0;
+            rbsp_.push_back((char)data[i]);
+        }
+    }
+    
+    uint32_t ReadBits(int n)
+    {
+        uint32_t value = 0;
+        for(int i = 0; i < n; i++){
+            if(pos_ >= rbsp_.size() * 8){
+                overrun_ = true;
+                return 0;
+            }
+            value = (value << 1) | 
+                (((uint8_t)rbsp_[pos_ / 8] >> (7 - pos_ % 8)) & 1);
+            pos_++;
+        }
+        return value;
+    }
+    
+    void SkipBits(int n)
+    {
+        pos_ += n;
+        if(pos_ > rbsp_.size() * 8){
+            overrun_ = true;
+        }
+    }
+    
+    // Exp-Golomb ue(v)
+    uint32_t ReadUE()
+    {
+        int leading_zeros = 0;
+        while(ReadBits(1) == 0){
+            if(overrun_ || leading_zeros >= 31){
+                overrun_ = true;
+                return 0;
+            }
+            leading_zeros++;
+        }
+        return ((1u << leading_zeros) - 1) + ReadBits(leading_zeros);
+    }
+    
+    // Exp-Golomb se(v)
+    int32_t ReadSE()
+    {
+        uint32_t code = ReadUE();
+        return (code & 1) ? (int32_t)((code + 1) / 2) : -(int32_t)(code / 2);
+    }
+    
+    bool overrun(){
+        return overrun_;
+    }
+    
+private:
+    std::string rbsp_;
+    size_t pos_;
+    bool overrun_;
+};
+
+struct SpsInfo{
+    uint32_t width;
+    uint32_t height;
+    uint32_t fps;     // 0 if no timing info
+};
+
+static void SkipH264ScalingList(RbspBitReader *reader, int size)
+{
+    int last_scale = 8, next_scale = 8;
+    for(int j = 0; j < size; j++){
+        if(next_scale != 0){
+            int delta_scale = reader->ReadSE();
+            next_scale = (last_scale + delta_scale + 256) % 256;
+        }
+        last_scale = (next_scale == 0) ? last_scale : next_scale;
+    }
+}
+
+// see 7.3.2.1.1 of ITU-T H.264
+static bool ParseH264Sps(const uint8_t *nal, size_t size, SpsInfo *info)
+{
+    RbspBitReader reader(nal + 1, size - 1); // skip the NAL header
+    uint32_t profile_idc, chroma_format_idc = 1, separate_colour_plane = 0;
+    uint32_t pic_order_cnt_type, frame_mbs_only;
+    uint32_t width_in_mbs, height_in_map_units;
+    uint32_t crop_left = 0, crop_right = 0, crop_top = 0, crop_bottom = 0;
+    uint32_t crop_unit_x, crop_unit_y;
+    
+    profile_idc = reader.ReadBits(8);
+    reader.SkipBits(16); // constraint flags and level_idc
+    reader.ReadUE(); // seq_parameter_set_id
+    if(profile_idc == 100 || profile_idc == 110 || profile_idc == 122 ||
+       profile_idc == 244 || profile_idc == 44 || profile_idc == 83 ||
+       profile_idc == 86 || profile_idc == 118 || profile_idc == 128 ||
+       profile_idc == 138 || profile_idc == 139 || profile_idc == 134 ||
+       profile_idc == 135){
+        chroma_format_idc = reader.ReadUE();
+        if(chroma_format_idc == 3){
+            separate_colour_plane = reader.ReadBits(1);
+        }
+        reader.ReadUE(); // bit_depth_luma_minus8
+        reader.ReadUE(); // bit_depth_chroma_minus8
+        reader.SkipBits(1); // qpprime_y_zero_transform_bypass_flag
+        if(reader.ReadBits(1)){ // seq_scaling_matrix_present_flag
+            int list_num = (chroma_format_idc != 3) ? 8 : 12;
+            for(int i = 0; i < list_num; i++){
+                if(reader.ReadBits(1)){
+                    SkipH264ScalingList(&reader, (i < 6) ? 16 : 64);
+                }
+            }
+        }
+    }
+    reader.ReadUE(); // log2_max_frame_num_minus4
+    pic_order_cnt_type = reader.ReadUE();
+    if(pic_order_cnt_type == 0){
+        reader.ReadUE(); // log2_max_pic_order_cnt_lsb_minus4
+    }else if(pic_order_cnt_type == 1){
+        uint32_t num_ref_frames_in_poc_cycle;
+        reader.SkipBits(1); // delta_pic_order_always_zero_flag
+        reader.ReadSE(); // offset_for_non_ref_pic
+        reader.ReadSE(); // offset_for_top_to_bottom_field
+        num_ref_frames_in_poc_cycle = reader.ReadUE();
+        for(uint32_t i = 0; i < num_ref_frames_in_poc_cycle && !reader.overrun(); i++){
+            reader.ReadSE();
+        }
+    }
+    reader.ReadUE(); // max_num_ref_frames
+    reader.SkipBits(1); // gaps_in_frame_num_value_allowed_flag
+    width_in_mbs = reader.ReadUE() + 1;
+    height_in_map_units = reader.ReadUE() + 1;
+    frame_mbs_only = reader.ReadBits(1);
+    if(!frame_mbs_only){
+        reader.SkipBits(1); // mb_adaptive_frame_field_flag
+    }
+    reader.SkipBits(1); // direct_8x8_inference_flag
+    if(reader.ReadBits(1)){ // frame_cropping_flag
+        crop_left = reader.ReadUE();
+        crop_right = reader.ReadUE();
+        crop_top = reader.ReadUE();
+        crop_bottom = reader.ReadUE();
+    }
+    if(reader.overrun()){
+        return false;
+    }
+    
+    if(separate_colour_plane || chroma_format_idc == 0){
+        crop_unit_x = 1;
+        crop_unit_y = 2 - frame_mbs_only;
+    }else{
+        crop_unit_x = (chroma_format_idc == 3) ? 1 : 2;
+        crop_unit_y = ((chroma_format_idc == 1) ? 2 : 1) * (2 - frame_mbs_only);
+    }
+    info->width = width_in_mbs * 16 - crop_unit_x * (crop_left + crop_right);
+    info->height = (2 - frame_mbs_only) * height_in_map_units * 16 - 
+                   crop_unit_y * (crop_top + crop_bottom);
+    info->fps = 0;
+    
+    // the frame rate from the timing info of VUI, if present
+    if(reader.ReadBits(1)){ // vui_parameters_present_flag
+        if(reader.ReadBits(1)){ // aspect_ratio_info_present_flag
+            if(reader.ReadBits(8) == 255){ // Extended_SAR
+                reader.SkipBits(32);
+            }
+        }
+        if(reader.ReadBits(1)){ // overscan_info_present_flag
+            reader.SkipBits(1);
+        }
+        if(reader.ReadBits(1)){ // video_signal_type_present_flag
+            reader.SkipBits(4);
+            if(reader.ReadBits(1)){ // colour_description_present_flag
+                reader.SkipBits(24);
+            }
+        }
+        if(reader.ReadBits(1)){ // chroma_loc_info_present_flag
+            reader.ReadUE();
+            reader.ReadUE();
+        }
+        if(reader.ReadBits(1)){ // timing_info_present_flag
+            uint32_t num_units_in_tick = reader.ReadBits(32);
+            uint32_t time_scale = reader.ReadBits(32);
+            if(!reader.overrun() && num_units_in_tick != 0){
+                info->fps = (uint32_t)(((uint64_t)time_scale + num_units_in_tick) / 
+                                       (2 * (uint64_t)num_units_in_tick));
+            }
+        }
+    }
+    
+    return (info->width != 0 && info->height != 0);
+}
+
+// see 7.3.2.2 of ITU-T H.265, the frame rate in VUI is not parsed
+static bool ParseH265Sps(const uint8_t *nal, size_t size, SpsInfo *info)
+{
+    RbspBitReader reader(nal + 2, size - 2); // skip the NAL header
+    uint32_t max_sub_layers_minus1, chroma_format_idc;
+    uint32_t width, height;
+    uint32_t sub_width_c, sub_height_c;
+    bool sub_layer_profile_present[8], sub_layer_level_present[8];
+    
+    reader.SkipBits(4); // sps_video_parameter_set_id
+    max_sub_layers_minus1 = reader.ReadBits(3);
+    reader.SkipBits(1); // sps_temporal_id_nesting_flag
+    
+    // profile_tier_level(1, sps_max_sub_layers_minus1)
+    reader.SkipBits(88); // general profile
+    reader.SkipBits(8); // general_level_idc
+    for(uint32_t i = 0; i < max_sub_layers_minus1; i++){
+        sub_layer_profile_present[i] = reader.ReadBits(1);
+        sub_layer_level_present[i] = reader.ReadBits(1);
+    }
+    if(max_sub_layers_minus1 > 0){
+        for(uint32_t i = max_sub_layers_minus1; i < 8; i++){
+            reader.SkipBits(2); // reserved_zero_2bits
+        }
+    }
+    for(uint32_t i = 0; i < max_sub_layers_minus1; i++){
+        if(sub_layer_profile_present[i]){
+            reader.SkipBits(88);
+        }
+        if(sub_layer_level_present[i]){
+            reader.SkipBits(8);
+        }
+    }
+    
+    reader.ReadUE(); // sps_seq_parameter_set_id
+    chroma_format_idc = reader.ReadUE();
+    if(chroma_format_idc == 3){
+        reader.SkipBits(1); // separate_colour_plane_flag
+    }
+    width = reader.ReadUE(); // pic_width_in_luma_samples
+    height = reader.ReadUE(); // pic_height_in_luma_samples
+    if(reader.ReadBits(1)){ // conformance_window_flag
+        uint32_t left = reader.ReadUE();
+        uint32_t right = reader.ReadUE();
+        uint32_t top = reader.ReadUE();
+        uint32_t bottom = reader.ReadUE();
+        sub_width_c = (chroma_format_idc == 1 || chroma_format_idc == 2) ? 2 : 1;
+        sub_height_c = (chroma_format_idc == 1) ? 2 : 1;
+        width -= sub_width_c * (left + right);
+        height -= sub_height_c * (top + bottom);
+    }
+    if(reader.overrun()){
+        return false;
+    }
+    info->width = width;
+    info->height = height;
+    info->fps = 0;
+    
+    return (info->width != 0 && info->height != 0);
+}
+
+
 int H264or5Parser::AvcCToAnnexB(std::string &extra_data)
 { 
     const uint8_t *p = (const uint8_t *)extra_data.data(); 
@@ -133,7 +398,12 @@ int H264or5Parser::Init(FFmpegDemuxer *demuxer, int stream_index)
     extradata_size_ = demuxer->meta_.sub_streams[stream_index].extra_data.size();
     key_frame_buf_ = demuxer->meta_.sub_streams[stream_index].extra_data;
     
-    return StreamParser::Init(demuxer, stream_index);
+    ret = StreamParser::Init(demuxer, stream_index);
+    if(ret){
+        return ret;
+    }
+    UpdateSpsParam();
+    return 0;
 }
 
 int H264or5Parser::Parse(stream_switch::MediaFrameInfo *frame_info, 
@@ -242,6 +512,10 @@ int H264or5Parser::DoUpdateMeta(AVPacket *pkt, bool* is_meta_changed)
             }//if(extra_size != 0){
         }
 //        }//if(demuxer_->meta_.sub_streams[stream_index_].extra_data.empty()){
+        
+        if(UpdateSpsParam()){
+            meta_changed = true;
+        }
     
     }
     
@@ -255,51 +529,25 @@ int H264or5Parser::DoUpdateMeta(AVPacket *pkt, bool* is_meta_changed)
 int H264or5Parser::GetExtraDataSize(AVPacket *pkt)
 {
     bool vps = false, sps = false, pps = false;
-    uint8_t *p, *end , *start;   
-    int extra_size = 0;
-    start = pkt->data;
+    const uint8_t *pos, *end;   
+    StswNalUnit nal;
+    int extra_size = pkt->size; //all is extra data if no VCL is found, 
+                                //should not happen
+    pos = pkt->data;
     end = pkt->data + pkt->size;
     
-#if 0    
-    int i;
-    for(p= start, i=1; p< end; p++, i++){
-        printf("%02hhx ", *p);
-        if(i % 32 == 0){
-            printf("\n");
-        }
-    }
-    printf("\n");
-#endif
-
-    for (p = start; p < end - 4; p++) {
-        if (p[0] == 0 && p[1] == 0 && p[2] == 0 && p[3] == 1) {
-            uint8_t nal_unit_type;
-            if (h_number_ == 264 && end - p >= 5) {
-                nal_unit_type = p[4]&0x1F;
-            } else if (h_number_ == 265 && (end - p) >= 6) {
-                nal_unit_type = (p[4]&0x7E)>>1;
-            } else {
-                nal_unit_type = 0xff;
-            }
-            
-            if(IsVPS(nal_unit_type)){
-                vps = true;
-            }else if(IsSPS(nal_unit_type)){
-                sps = true;
-            }else if(IsPPS(nal_unit_type)){
-                pps = true;
-            }else if (IsVCL(nal_unit_type)){
-                
-                extra_size = p - start;
-                break;
-            } 
-           
-        } // if (p[0] == 0 && q[1] == 0 && q[2] == 0 && q[3] == 1) {           
-    } // for (p = start; p < end - 4; p++) {   
-    if(p == end - 4){
-        extra_size = pkt->size; //all is extra data, 
-                                //should not arrive here
-    }
+    while(stsw_next_nal_unit(&pos, end, h_number_, &nal)){
+        if(IsVPS(nal.type)){
+            vps = true;
+        }else if(IsSPS(nal.type)){
+            sps = true;
+        }else if(IsPPS(nal.type)){
+            pps = true;
+        }else if (IsVCL(nal.type)){
+            extra_size = nal.start - pkt->data;
+            break;
+        } 
+    } // while(stsw_next_nal_unit(&pos, end, h_number_, &nal)){
         
     if(extra_size != 0){
         if (h_number_ == 264 && sps && pps){
@@ -330,3 +578,52 @@ bool H264or5Parser::IsVCL(uint8_t nal_unit_type) {
     ? (nal_unit_type <= 5 && nal_unit_type > 0)
     : (nal_unit_type <= 31);
 }
+
+bool H264or5Parser::UpdateSpsParam()
+{
+    stream_switch::VideoMediaParam & video = 
+        demuxer_->meta_.sub_streams[stream_index_].media_param.video;
+    const std::string & extra_data = 
+        demuxer_->meta_.sub_streams[stream_index_].extra_data;
+    const uint8_t *pos, *end;
+    StswNalUnit nal;
+    SpsInfo info;
+    bool changed = false;
+    
+    if(video.width != 0 && video.height != 0 && 
+       (video.fps != 0 || h_number_ == 265)){
+        return false; // all known, or cannot be found in SPS
+    }
+    
+    pos = (const uint8_t *)extra_data.data();
+    end = pos + extra_data.size();
+    while(stsw_next_nal_unit(&pos, end, h_number_, &nal)){
+        bool ret;
+        if(!IsSPS(nal.type)){
+            continue;
+        }
+        if(h_number_ == 264){
+            ret = (nal.size > 4) && ParseH264Sps(nal.data, nal.size, &info);
+        }else{
+            ret = (nal.size > 5) && ParseH265Sps(nal.data, nal.size, &info);
+        }
+        if(!ret){
+            STDERR_LOG(stream_switch::LOG_LEVEL_WARNING,  
+                "H264or5Parser cannot parse the SPS of sub stream %d\n", 
+                stream_index_);              
+            break;
+        }
+        if(video.width == 0 || video.height == 0){
+            video.width = info.width;
+            video.height = info.height;
+            changed = true;
+        }
+        if(video.fps == 0 && info.fps != 0){
+            video.fps = info.fps;
+            changed = true;
+        }
+        break;
+    }
+    
+    return changed;
+}
@@ -63,6 +63,12 @@ protected:
     virtual bool IsVCL(uint8_t nal_unit_type);
     
     virtual int AvcCToAnnexB(std::string &extra_data);
+    
+    // UpdateSpsParam()
+    // fill the absent video params (width, height, fps) of the metadata 
+    // from the SPS in extra_data, in case the probing of ffmpeg is too 
+    // short to find them, e.g. for fast start
+    virtual bool UpdateSpsParam();
 
     int h_number_; 
     
@@ -41,6 +41,7 @@
 #include "../stsw_ffmpeg_source_global.h"
 #include "stsw_h264or5_parser.h"
 #include "stsw_mpeg4_parser.h"
+#include "stsw_aac_parser.h"
 
 extern "C"{
 
@@ -310,7 +311,7 @@ static const ParserInfo parser_infos[] = {
    { AV_CODEC_ID_H264, StreamParserFatcory<H264or5Parser>, "H264" },
    { AV_CODEC_ID_H265, StreamParserFatcory<H264or5Parser>, "H265" }, 
    { AV_CODEC_ID_MPEG4, StreamParserFatcory<Mpeg4Parser>, "MP4V-ES" },
-   { AV_CODEC_ID_AAC, NULL, "AAC" },     
+   { AV_CODEC_ID_AAC, StreamParserFatcory<AacParser>, "AAC" },   
    { AV_CODEC_ID_AMR_NB, NULL, "AMR" },
    { AV_CODEC_ID_PCM_MULAW, NULL, "PCMU"},
    { AV_CODEC_ID_PCM_ALAW, NULL, "PCMA"},
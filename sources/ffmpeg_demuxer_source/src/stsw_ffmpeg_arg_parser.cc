@@ -73,6 +73,49 @@ void FFmpegArgParser::RegisterSourceOptions()
                    "Mainly used to simulate a live stream from a non-live input (like a media file). "
                    "Should not be used with the actual live input streams (where it can cause packet loss). ",
                     NULL, NULL);
+    RegisterOption("pacing-skew", 0, 
+                   OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG, "MODE",
+                   "how to pace the packets which are later than pacing-max-late for native-frame-rate, "
+                   "e.g. when the input IO stalls. "
+                   "\"catchup\" sends them at once until catch up with the timeline, "
+                   "\"drop\" drops them until the next key frame, "
+                   "\"stretch\" shifts the timeline (and the frame time) by the lateness. "
+                   "Default is catchup", NULL, NULL);
+    RegisterOption("pacing-max-late", 0, 
+                   OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG, "MSEC",
+                   "the max lateness (in millisec) of a packet for native-frame-rate, "
+                   "beyond which the packet is handled according to pacing-skew. "
+                   "Default is 100 ms", NULL, NULL);
+    RegisterOption("read-ahead", 0, 
+                   OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG, "MSEC",
+                   "the media time (in millisec) read ahead of publishing for native-frame-rate. "
+                   "The input is read by a separate thread into a queue of this size, "
+                   "so that a short IO stall of the input would not become an output gap. "
+                   "0 means reading in the publishing thread. "
+                   "Default is 1000 ms", NULL, NULL);
+    RegisterOption("fast-start", 0, 0, NULL,
+                   "minimize the probing of the input (unless probesize / analyzeduration "
+                   "are given by the ffmpeg options), the absent codec params are got "
+                   "from the first key frame instead. "
+                   "Mainly used to shorten the startup for the network input", NULL, NULL);
+    RegisterOption("meta-cache-dir", 0, 
+                   OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG, "DIR",
+                   "the directory to persist the metadata of the input, "
+                   "which is used to publish at once after restart "
+                   "without waiting for the codec config in the first key frame. "
+                   "Default is no cache", NULL, NULL);
+    RegisterOption("loop-streams", 0, 
+                   OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG, "NUM",
+                   "load-test mode: demux the input file once into memory, "
+                   "and publish it as NUM independent live streams looping forever, "
+                   "whose names are STREAM_NAME_0 ~ STREAM_NAME_(NUM-1) "
+                   "(or STREAM_NAME if NUM is 1) and whose ports are PORT + 2 * i if port is given. "
+                   "The frame time is rebased on the local clock continuously", NULL, NULL);
+    RegisterOption("loop-phase", 0, 
+                   OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG, "MSEC",
+                   "the phase offset (in millisec) between the streams of loop-streams, "
+                   "the stream i starts at the first key frame after i * MSEC into the input. "
+                   "Default is 0", NULL, NULL);
                    
     RegisterOption("ffmpeg-[NAME]", 0, 
                    OPTION_FLAG_WITH_ARG, "VALUE",
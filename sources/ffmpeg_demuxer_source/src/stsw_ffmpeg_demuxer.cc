@@ -67,7 +67,9 @@ FFmpegDemuxer::~FFmpegDemuxer()
 int FFmpegDemuxer::Open(const std::string &input, 
              const std::string &ffmpeg_options_str,
              unsigned long io_timeout, 
-             int play_mode)
+             int play_mode, 
+             bool fast_start, 
+             const stream_switch::StreamMetadata *cached_meta)
 {
     using namespace stream_switch; 
     int ret;
@@ -97,6 +99,15 @@ int FFmpegDemuxer::Open(const std::string &input,
         goto err_out1;
     }
 
+    if(fast_start){
+        // probe as little as possible, the absent codec params would be got 
+        // from the first key frame by the parsers
+        av_dict_set(&format_opts, "probesize", 
+                    FAST_START_PROBE_SIZE, AV_DICT_DONT_OVERWRITE);
+        av_dict_set(&format_opts, "analyzeduration", 
+                    FAST_START_ANALYZE_DURATION, AV_DICT_DONT_OVERWRITE);
+    }
+
     //av_dict_set(&format_opts, "rtsp_transport", "tcp", 0);
     //printf("option dict count:%d\n", av_dict_count(format_opts));
     
@@ -249,6 +260,11 @@ int FFmpegDemuxer::Open(const std::string &input,
         meta_.sub_streams.push_back(sub_metadata);        
     }    
     
+    if(cached_meta != NULL && ApplyCachedMeta(*cached_meta)){
+        STDERR_LOG(stream_switch::LOG_LEVEL_INFO,  
+            "FFmpegDemuxer::Open(): metadata is pre-filled from the cache\n");          
+    }
+    
     //setup the parsers
     for(int i=0; i<fmt_ctx_->nb_streams; i++) {
         AVStream *st= fmt_ctx_->streams[i];
@@ -383,7 +399,7 @@ read_again:
 
 #define DUMP_PACKET    
 #ifdef DUMP_PACKET
-    {
+    if(STDERR_LOG_ENABLED(stream_switch::LOG_LEVEL_DEBUG)){
         STDERR_LOG(stream_switch::LOG_LEVEL_DEBUG,  
                 "Read the following packet from input file\n");         
         av_pkt_dump_log2(NULL, AV_LOG_DEBUG, pkt, 0, 
@@ -485,7 +501,7 @@ read_again:
         }
     
 #ifdef DUMP_PACKET
-        {
+        if(STDERR_LOG_ENABLED(stream_switch::LOG_LEVEL_DEBUG)){
             STDERR_LOG(stream_switch::LOG_LEVEL_DEBUG,  
                        "Read the following packet from input file\n");         
             av_pkt_dump_log2(NULL, AV_LOG_DEBUG, &(pkt_node.pkt), 0, 
@@ -540,6 +556,55 @@ bool FFmpegDemuxer::IsMetaReady()
     return true;  
 }
 
+bool FFmpegDemuxer::ApplyCachedMeta(const stream_switch::StreamMetadata &cached_meta)
+{
+    using namespace stream_switch;
+    
+    if(cached_meta.sub_streams.size() != meta_.sub_streams.size()){
+        return false;
+    }
+    for(size_t i = 0; i < meta_.sub_streams.size(); i++){
+        if(cached_meta.sub_streams[i].media_type != meta_.sub_streams[i].media_type ||
+           cached_meta.sub_streams[i].codec_name != meta_.sub_streams[i].codec_name){
+            return false; // the input has changed
+        }
+    }
+    
+    // only the absent fields are filled, what the input provides always wins
+    for(size_t i = 0; i < meta_.sub_streams.size(); i++){
+        SubStreamMetadata & sub_stream = meta_.sub_streams[i];
+        const SubStreamMetadata & cached = cached_meta.sub_streams[i];
+        if(sub_stream.extra_data.empty()){
+            sub_stream.extra_data = cached.extra_data;
+        }
+        if(sub_stream.media_type == SUB_STREAM_MEIDA_TYPE_VIDEO){
+            VideoMediaParam & video = sub_stream.media_param.video;
+            if(video.width == 0 || video.height == 0){
+                video.width = cached.media_param.video.width;
+                video.height = cached.media_param.video.height;
+            }
+            if(video.fps == 0){
+                video.fps = cached.media_param.video.fps;
+            }
+        }else if(sub_stream.media_type == SUB_STREAM_MEIDA_TYPE_AUDIO){
+            AudioMediaParam & audio = sub_stream.media_param.audio;
+            if(audio.samples_per_second == 0){
+                audio.samples_per_second = cached.media_param.audio.samples_per_second;
+            }
+            if(audio.channels == 0){
+                audio.channels = cached.media_param.audio.channels;
+            }
+            if(audio.bits_per_sample == 0){
+                audio.bits_per_sample = cached.media_param.audio.bits_per_sample;
+            }
+            if(audio.sampele_per_frame == 0){
+                audio.sampele_per_frame = cached.media_param.audio.sampele_per_frame;
+            }
+        }
+    }
+    return true;
+}
+
     
 void FFmpegDemuxer::set_io_enabled(bool io_enabled)
 {
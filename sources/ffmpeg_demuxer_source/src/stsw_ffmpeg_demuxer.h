@@ -52,6 +52,7 @@ struct PktNode{
 class StreamParser;
 class H264or5Parser;
 class Mpeg4Parser;
+class AacParser;
 typedef std::vector<StreamParser *> StreamParserVector;
 typedef std::list<PktNode> PacketCachedList;
 
@@ -61,6 +62,11 @@ enum DemuxerPlayMode{
     PLAY_MODE_REPLAY = 2,   
 };
 
+// the probing limit of ffmpeg for fast start, unless the user gives 
+// them explicitly by the ffmpeg options
+#define FAST_START_PROBE_SIZE        "32768"    // in bytes
+#define FAST_START_ANALYZE_DURATION  "500000"   // in us
+
 
 class FFmpegDemuxer{
 public:
@@ -69,7 +75,9 @@ public:
     int Open(const std::string &input, 
              const std::string &ffmpeg_options_str,
              unsigned long io_timeout, 
-             int play_mode);
+             int play_mode, 
+             bool fast_start, 
+             const stream_switch::StreamMetadata *cached_meta);
     void Close();
     int ReadPacket(stream_switch::MediaFrameInfo *frame_info, 
                    AVPacket *pkt, 
@@ -84,9 +92,15 @@ protected:
     friend class StreamParser;
     friend class H264or5Parser;
     friend class Mpeg4Parser;
+    friend class AacParser;
     
     virtual bool IsMetaReady();
     
+    // ApplyCachedMeta()
+    // fill the absent fields of the sub streams with the cached metadata, 
+    // if the cache matches the sub streams of the input
+    virtual bool ApplyCachedMeta(const stream_switch::StreamMetadata &cached_meta);
+    
     static int StaticIOInterruptCB(void* user_data);
     int IOInterruptCB();    
     virtual void StartIO();
@@ -43,19 +43,33 @@
 #include "stsw_ffmpeg_source_global.h"
 #include "stsw_log.h"
 #include "stsw_ffmpeg_demuxer.h"
+#include "stsw_frame_pacer.h"
+#include "stsw_read_ahead_queue.h"
+#include "stsw_meta_cache.h"
 
 static void sigusr1_handler (int signal_value)
 {
     //nothig to do
 }
 
+static int64_t MonotonicNow()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
 
 FFmpegDemuxerSource * FFmpegDemuxerSource::s_instance = NULL;
 
 
 FFmpegDemuxerSource::FFmpegDemuxerSource()
-:live_thread_id_(0), io_timeout_(0), is_started_(false), 
-native_frame_rate_(false),local_gap_max_time_(0), 
+:live_thread_id_(0), read_thread_id_(0), io_timeout_(0), is_started_(false), 
+native_frame_rate_(false), pacing_skew_mode_(PACER_SKEW_CATCH_UP), 
+pacing_max_late_(PACER_DEFAULT_MAX_LATE / 1000), 
+read_ahead_(READ_AHEAD_DEFAULT_TIME), fast_start_(false), 
+start_time_(0), open_time_(-1), meta_time_(-1), first_frame_time_(-1), 
+local_gap_max_time_(0), 
 on_error_fun_(NULL), user_data_(NULL), default_stream_index_(0)
 {
     //init the sigusr1_oldact_ field
@@ -66,6 +80,9 @@ on_error_fun_(NULL), user_data_(NULL), default_stream_index_(0)
  
     // create demuxer object for this input type
     demuxer_ = new FFmpegDemuxer();
+    pacer_ = new FramePacer();
+    read_queue_ = new ReadAheadQueue();
+    meta_cache_ = new MetaCache();
     
     source_ = new stream_switch::StreamSource();
 }
@@ -78,6 +95,18 @@ FFmpegDemuxerSource::~FFmpegDemuxerSource()
         delete demuxer_;
         demuxer_ = NULL;
     }
+    if(pacer_ != NULL){
+        delete pacer_;
+        pacer_ = NULL;
+    }
+    if(read_queue_ != NULL){
+        delete read_queue_;
+        read_queue_ = NULL;
+    }
+    if(meta_cache_ != NULL){
+        delete meta_cache_;
+        meta_cache_ = NULL;
+    }
     
     if(source_ != NULL){
         delete source_;
@@ -92,6 +121,11 @@ int FFmpegDemuxerSource::Init(std::string input,
                               int local_gap_max_time, 
                               unsigned long io_timeout,
                               bool native_frame_rate, 
+                              int pacing_skew_mode, 
+                              int pacing_max_late, 
+                              int read_ahead, 
+                              bool fast_start, 
+                              std::string meta_cache_dir, 
                               int source_tcp_port, 
                               int queue_size, 
                               int debug_flags)
@@ -133,6 +167,11 @@ int FFmpegDemuxerSource::Init(std::string input,
     io_timeout_ = io_timeout;
     ffmpeg_options_str_ = ffmpeg_options_str;
     native_frame_rate_ = native_frame_rate;
+    pacing_skew_mode_ = pacing_skew_mode;
+    pacing_max_late_ = pacing_max_late;
+    read_ahead_ = read_ahead;
+    fast_start_ = fast_start;
+    meta_cache_->Init(meta_cache_dir, input);
     local_gap_max_time_ = local_gap_max_time;
     
     return 0;
@@ -152,6 +191,11 @@ void FFmpegDemuxerSource::Uninit()
     input_name_.clear();
     ffmpeg_options_str_.clear();
     native_frame_rate_ = false;
+    pacing_skew_mode_ = PACER_SKEW_CATCH_UP;
+    pacing_max_late_ = PACER_DEFAULT_MAX_LATE / 1000;
+    read_ahead_ = READ_AHEAD_DEFAULT_TIME;
+    fast_start_ = false;
+    meta_cache_->Init(std::string(), std::string());
     io_timeout_ = 0;
     local_gap_max_time_ = 0;
     
@@ -168,10 +212,16 @@ int FFmpegDemuxerSource::Start(OnErrorFun on_error_fun, void *user_data)
     int ret;
     std::string err_info;
     int play_mode = PLAY_MODE_AUTO;
+    stream_switch::StreamMetadata cached_meta;
+    bool has_cached_meta;
     
     if(is_started_){
         return 0; //already start
     }
+    start_time_ = MonotonicNow();
+    open_time_ = meta_time_ = first_frame_time_ = -1;
+    has_cached_meta = meta_cache_->Load(&cached_meta);
+    
     if(native_frame_rate_){
         play_mode = PLAY_MODE_LIVE; // for native_frame_rate enabled, force live mode
     }
@@ -182,7 +232,9 @@ int FFmpegDemuxerSource::Start(OnErrorFun on_error_fun, void *user_data)
     ret = demuxer_->Open(input_name_, 
                          ffmpeg_options_str_, 
                          io_timeout_, 
-                         play_mode);
+                         play_mode, 
+                         fast_start_, 
+                         has_cached_meta ? &cached_meta : NULL);
     if(ret){
         STDERR_LOG(stream_switch::LOG_LEVEL_ERR, 
                    "Demuxer open failed (ret: %d) for input: %s\n", 
@@ -191,6 +243,7 @@ int FFmpegDemuxerSource::Start(OnErrorFun on_error_fun, void *user_data)
         source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_ERR_CONNECT_FAIL);
         goto err_out1;
     }
+    open_time_ = MonotonicNow() - start_time_;
 
 #define META_READ_TIMEOUT 10
         
@@ -203,6 +256,8 @@ int FFmpegDemuxerSource::Start(OnErrorFun on_error_fun, void *user_data)
         source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_ERR);
         goto err_out2;
     }    
+    meta_time_ = MonotonicNow() - start_time_;
+    meta_cache_->Save(meta_);
     if(meta_.play_type == stream_switch::STREAM_PLAY_TYPE_REPLAY){
         STDERR_LOG(stream_switch::LOG_LEVEL_ERR, 
                    "Cannot support non-live input without native_frame_rate enabled now\n");   
@@ -213,6 +268,10 @@ int FFmpegDemuxerSource::Start(OnErrorFun on_error_fun, void *user_data)
     //configure the metadata of soruce
     source_->set_stream_meta(meta_);
     
+    //all sub streams are paced for native_frame_rate
+    pacer_->Init((int)meta_.sub_streams.size(), pacing_skew_mode_, 
+                 (int64_t)pacing_max_late_ * 1000);
+    
     //start the source
     ret = source_->Start(&err_info);
     if(ret){
@@ -230,6 +289,28 @@ int FFmpegDemuxerSource::Start(OnErrorFun on_error_fun, void *user_data)
     user_data_ = user_data;
     is_started_ = true;    
     
+    //create a thread to read ahead the packets for native_frame_rate, so 
+    //that a short IO stall of the input would not become an output gap
+    if(native_frame_rate_ && read_ahead_ > 0){
+        read_queue_->Init((int64_t)read_ahead_ * 1000);
+        ret = pthread_create(&read_thread_id_, NULL, 
+                             FFmpegDemuxerSource::StaticReadThreadRoutine, 
+                             this);
+        if(ret){
+            STDERR_LOG(stream_switch::LOG_LEVEL_ERR, 
+                       "pthread_create read-ahead thread failed: %s\n", 
+                       strerror(errno));         
+            
+            is_started_ = false;
+            read_thread_id_  = 0;
+            on_error_fun_ = NULL;
+            user_data_ = NULL;
+            source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_ERR);
+            ret = -1;
+            goto err_out3;
+        }
+    }
+    
     //create a thread to read packet
     ret = pthread_create(&live_thread_id_, NULL, 
                          FFmpegDemuxerSource::StaticLiveThreadRoutine, 
@@ -246,7 +327,7 @@ int FFmpegDemuxerSource::Start(OnErrorFun on_error_fun, void *user_data)
         user_data_ = NULL;
         source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_ERR);
         ret = -1;
-        goto err_out3;
+        goto err_out4;
     }    
     
     STDERR_LOG(stream_switch::LOG_LEVEL_INFO, 
@@ -255,6 +336,17 @@ int FFmpegDemuxerSource::Start(OnErrorFun on_error_fun, void *user_data)
     return 0;    
 
 
+err_out4:
+    if(read_thread_id_ != 0){
+        demuxer_->set_io_enabled(false);
+        read_queue_->Abort();
+        pthread_kill(read_thread_id_, SIGUSR1);
+        pthread_join(read_thread_id_, NULL);
+        read_thread_id_ = 0;
+        read_queue_->Flush();
+        demuxer_->set_io_enabled(true);
+    }
+
 err_out3:
     source_->Stop();
 
@@ -275,6 +367,21 @@ void FFmpegDemuxerSource::Stop()
     is_started_ = false;
     
     demuxer_->set_io_enabled(false); //this can interrupt the current IO and prevent future IO
+    read_queue_->Abort(); //wake up the threads blocked on the read-ahead queue
+    pacer_->Wakeup(); //wake up the live thread waiting for the pacing deadline
+    
+    // wait for the read-ahead thread terminate
+    if(read_thread_id_ != 0){
+        void * res;
+        int ret;
+        pthread_kill(read_thread_id_, SIGUSR1);
+        ret = pthread_join(read_thread_id_, &res);
+        if (ret != 0){
+            STDERR_LOG(stream_switch::LOG_LEVEL_ERR, 
+                   "join read-ahead thread failed: %s\n", strerror(errno));            
+        }
+        read_thread_id_ = 0;      
+    }
     
     // wait for the live working thread terminate
     if(live_thread_id_ != 0){
@@ -293,6 +400,9 @@ void FFmpegDemuxerSource::Stop()
     on_error_fun_ = NULL;
     user_data_ = NULL;    
     
+    // free the packets still in pacing
+    pacer_->Flush();
+    read_queue_->Flush();
         
     // stop the source
     source_->Stop();
@@ -315,7 +425,48 @@ void FFmpegDemuxerSource::OnKeyFrame(void)
 
 void FFmpegDemuxerSource::OnMediaStatistic(stream_switch::MediaStatisticInfo *statistic)
 {
-    // nothing to do 
+    int64_t open_time = open_time_;
+    int64_t meta_time = meta_time_;
+    int64_t first_frame_time = first_frame_time_;
+    
+    statistic->open_time = (open_time < 0) ? -1 : open_time / 1000;
+    statistic->meta_time = (meta_time < 0) ? -1 : meta_time / 1000;
+    statistic->first_frame_time = 
+        (first_frame_time < 0) ? -1 : first_frame_time / 1000;
+    
+    if(native_frame_rate_ && read_ahead_ > 0){
+        ReadAheadStatistic read_ahead;
+        read_queue_->GetStatistic(&read_ahead);
+        statistic->read_ahead_fill = read_ahead.fill_time;
+        statistic->read_ahead_packets = read_ahead.fill_packets;
+        statistic->read_ahead_capacity = read_ahead.capacity;
+        statistic->read_ahead_underruns = read_ahead.underruns;
+        statistic->read_packets = read_ahead.read_packets;
+    }
+    
+    if(native_frame_rate_){
+        PacingStatisticVector pacing;
+        pacer_->GetStatistic(&pacing, &(statistic->pacing_stretch));
+        
+        stream_switch::SubStreamMediaStatisticVector::iterator it;
+        for(it = statistic->sub_streams.begin(); 
+            it != statistic->sub_streams.end(); 
+            it++){
+            if(it->sub_stream_index < 0 || 
+               it->sub_stream_index >= (int)pacing.size()){
+                continue;
+            }
+            const PacingStatistic & sub_stream = pacing[it->sub_stream_index];
+            it->paced_frames = sub_stream.sent_packets;
+            it->pacing_dropped_frames = sub_stream.dropped_packets;
+            it->pacing_late_frames = sub_stream.late_packets;
+            it->pacing_mean_error = (uint32_t)(sub_stream.sent_packets ? 
+                sub_stream.sum_error / sub_stream.sent_packets : 0);
+            it->pacing_max_error = (uint32_t)sub_stream.max_error;
+            it->pacing_error_histogram.assign(sub_stream.histogram, 
+                sub_stream.histogram + PACER_HISTOGRAM_BUCKETS);
+        }
+    }
 }
 
 int FFmpegDemuxerSource::FindDefaultStreamIndex(const stream_switch::StreamMetadata &meta)
@@ -340,21 +491,26 @@ void * FFmpegDemuxerSource::StaticLiveThreadRoutine(void *arg)
 }
 
 
-void FFmpegDemuxerSource::InternalLiveRoutine()
+void * FFmpegDemuxerSource::StaticReadThreadRoutine(void *arg)
+{
+    FFmpegDemuxerSource * source = (FFmpegDemuxerSource * )arg;
+    source->InternalReadRoutine();
+    return NULL;    
+}
+
+
+void FFmpegDemuxerSource::InternalReadRoutine()
 {
-    //DemuxerPacket demuxer_packet; //holding media data;
     stream_switch::MediaFrameInfo frame_info;
+    stream_switch::StreamMetadata meta;
     AVPacket pkt;
     int ret = 0;
-    std::string err_info;
-    struct timeval now;  
     bool is_meta_changed = false;
   
     av_init_packet(&pkt);
     pkt.data = NULL;
     pkt.size = 0;      
-  
-  
+    
     while(is_started_){
         is_meta_changed = false;
         //read demuxer packet
@@ -368,22 +524,162 @@ void FFmpegDemuxerSource::InternalLiveRoutine()
                 continue;
             }
             STDERR_LOG(stream_switch::LOG_LEVEL_ERR, 
-                   "Demuxer Read packet error (%d)\n", ret);    
-            source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_ERR_MEIDA_STOP);
+                   "Demuxer Read packet error (%d)\n", ret);
+            read_queue_->PushError(ret, 
+                stream_switch::SOURCE_STREAM_STATE_ERR_MEIDA_STOP);
             break;
         }
         if(is_meta_changed){
-            //read metadata from the demuxer
-            ret = demuxer_->ReadMeta(&meta_, META_READ_TIMEOUT);
+            //read metadata from the demuxer, which is only accessed in this thread
+            ret = demuxer_->ReadMeta(&meta, META_READ_TIMEOUT);
             if(ret){
                 STDERR_LOG(stream_switch::LOG_LEVEL_ERR, 
                            "Demuxer ReadMeta failed (ret: %d) for intput:%s\n", 
                            ret, input_name_.c_str());   
-                source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_ERR);
+                read_queue_->PushError(ret, stream_switch::SOURCE_STREAM_STATE_ERR);
+                break;
+            }
+        }
+        
+        // block if the queue is full
+        if(!read_queue_->Push(frame_info, &pkt, is_meta_changed ? &meta : NULL)){
+            break; // aborted
+        }
+    }
+    
+    av_free_packet(&pkt);
+}
+
+
+int FFmpegDemuxerSource::ReadNextPacket(stream_switch::MediaFrameInfo *frame_info, 
+                                        AVPacket *pkt, 
+                                        stream_switch::StreamMetadata *meta, 
+                                        bool *is_meta_changed, 
+                                        stream_switch::SourceStreamState *err_state)
+{
+    int ret;
+    
+    (*is_meta_changed) = false;
+    if(read_thread_id_ != 0){
+        av_free_packet(pkt);
+        return read_queue_->Pop(frame_info, pkt, meta, is_meta_changed, err_state);
+    }
+    
+    //read demuxer packet
+    ret = demuxer_->ReadPacket(frame_info, pkt, is_meta_changed); 
+    if(ret){
+        if(ret == FFMPEG_SOURCE_ERR_IO && !is_started_){
+            //IO is interrupted by user because source has been stop, not a real error
+        }else if(ret != FFMPEG_SOURCE_ERR_DROP){
+            STDERR_LOG(stream_switch::LOG_LEVEL_ERR, 
+                   "Demuxer Read packet error (%d)\n", ret);
+            (*err_state) = stream_switch::SOURCE_STREAM_STATE_ERR_MEIDA_STOP;
+        }
+        return ret;
+    }
+    if(*is_meta_changed){
+        //read metadata from the demuxer
+        ret = demuxer_->ReadMeta(meta, META_READ_TIMEOUT);
+        if(ret){
+            STDERR_LOG(stream_switch::LOG_LEVEL_ERR, 
+                       "Demuxer ReadMeta failed (ret: %d) for intput:%s\n", 
+                       ret, input_name_.c_str());   
+            (*err_state) = stream_switch::SOURCE_STREAM_STATE_ERR;
+            av_free_packet(pkt);
+            return ret;
+        }                 
+    }
+    return 0;
+}
+
+
+void FFmpegDemuxerSource::UpdateMeta(const stream_switch::StreamMetadata &meta)
+{
+    //update the metadata of soruce
+    meta_ = meta;
+    source_->set_stream_meta(meta_);            
+    meta_cache_->Save(meta_);
+}
+
+
+void FFmpegDemuxerSource::InternalLiveRoutine()
+{
+    //DemuxerPacket demuxer_packet; //holding media data;
+    stream_switch::MediaFrameInfo frame_info;
+    stream_switch::StreamMetadata meta;
+    bool is_meta_changed = false;
+    AVPacket pkt;
+    int ret = 0;
+    int read_ret = 0; // the demuxer error pending until the pacer drains
+    stream_switch::SourceStreamState err_state = stream_switch::SOURCE_STREAM_STATE_ERR;
+    stream_switch::SourceStreamState read_err_state = stream_switch::SOURCE_STREAM_STATE_ERR;
+    std::string err_info;
+    struct timeval now;  
+  
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;      
+  
+  
+    while(is_started_){
+        
+        if(read_ret == 0 && (!native_frame_rate_ || !pacer_->IsReady())){
+            ret = ReadNextPacket(&frame_info, &pkt, &meta, &is_meta_changed, &err_state);
+            if(ret){
+                if(ret == FFMPEG_SOURCE_ERR_IO && !is_started_){
+                    //IO is interrupted by user because source has been stop, not a real error
+                    break;
+                }else if(ret == FFMPEG_SOURCE_ERR_DROP){
+                    // dexumer need read 
+                    ret = 0;
+                    continue;
+                }
+                if(native_frame_rate_ && !pacer_->IsEmpty()){
+                    // send the packets in pacing before stop
+                    read_ret = ret;
+                    read_err_state = err_state;
+                    ret = 0;
+                    continue;
+                }
+                source_->set_stream_state(err_state);
                 break;
-            }                 
-            //update the metadata of soruce
-            source_->set_stream_meta(meta_);            
+            }
+            
+            if(native_frame_rate_){
+                // queue it, all sub streams are merged and paced by the 
+                // pacer, the metadata change is carried with the packet
+                pacer_->Push(frame_info, &pkt, is_meta_changed ? &meta : NULL);
+                continue;
+            }
+            if(is_meta_changed){
+                UpdateMeta(meta);
+            }
+            
+        }else{
+            
+            if(pacer_->IsEmpty()){
+                // all the packets before the demuxer error have been sent
+                ret = read_ret;
+                source_->set_stream_state(read_err_state);
+                break;
+            }
+            
+            // wait for the deadline of the earliest packet
+            ret = pacer_->Pop(&frame_info, &pkt, &meta, &is_meta_changed, 
+                              &is_started_);
+            if(is_meta_changed){
+                // the metadata changes since this packet is released
+                UpdateMeta(meta);
+            }
+            if(ret == FFMPEG_SOURCE_ERR_DROP){
+                ret = 0;
+                continue;
+            }else if(ret){
+                break;
+            }
+            if(!is_started_){
+                break;
+            }
         }
         
         // check local time gap
@@ -404,43 +700,6 @@ void FFmpegDemuxerSource::InternalLiveRoutine()
             } 
         }
         
-        // check native_frame_rate
-        if(native_frame_rate_ && 
-           frame_info.sub_stream_index == default_stream_index_){
-
-            while(now.tv_sec < frame_info.timestamp.tv_sec ||
-                  (now.tv_sec == frame_info.timestamp.tv_sec &&
-                   now.tv_usec < frame_info.timestamp.tv_usec)){
-                
-                if(!is_started_){
-                    break;
-                }
-                
-#define MAX_WAIT_US 10000 // 10 ms
-                long long waittime = 
-                    (frame_info.timestamp.tv_sec - now.tv_sec) * 1000000 
-                    + (frame_info.timestamp.tv_usec - now.tv_usec);
-                if(waittime < 0) {
-                    waittime = 0;
-                }else if (waittime > MAX_WAIT_US){
-                    waittime = MAX_WAIT_US; //at most 10 ms
-                }
-                {
-                    struct timespec req;
-                    req.tv_sec = 0;
-                    req.tv_nsec = waittime * 1000;            
-                    nanosleep(&req, NULL);
-                }                 
-                
-                gettimeofday(&now, NULL);             
-            }
-            
-            if(!is_started_){
-                break;
-            }
-            
-        }        
-        
         //send the media packet to source
         ret = source_->SendLiveMediaFrame(frame_info,
                                           (const char * )pkt.data,
@@ -455,12 +714,28 @@ void FFmpegDemuxerSource::InternalLiveRoutine()
             break;            
         }
         av_free_packet(&pkt);
+        
+        if(first_frame_time_ < 0){
+            first_frame_time_ = MonotonicNow() - start_time_;
+            STDERR_LOG(stream_switch::LOG_LEVEL_INFO, 
+                       "The first frame is published %lld ms after start "
+                       "(input opened: %lld ms, metadata ready: %lld ms)\n", 
+                       (long long)(first_frame_time_ / 1000), 
+                       (long long)(open_time_ / 1000), 
+                       (long long)(meta_time_ / 1000));
+        }
 
     }
     
     //free the demuxer packet for error 
     av_free_packet(&pkt);
  
+    if(native_frame_rate_){
+        STDERR_LOG(stream_switch::LOG_LEVEL_INFO, 
+                   "Pacing statistic of native_frame_rate:\n%s", 
+                   (pacer_->FormatStatistic() + 
+                    read_queue_->FormatStatistic()).c_str());
+    }
     
     // callback for error condiction
     // note: if the source has alread stopped, don't invoke the user callback
@@ -471,4 +746,3 @@ void FFmpegDemuxerSource::InternalLiveRoutine()
     }
     
 }
-
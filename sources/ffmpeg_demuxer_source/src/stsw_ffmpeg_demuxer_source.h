@@ -56,7 +56,11 @@ typedef void (*OnErrorFun)(int error_code, void *user_data);
 ///////////////////////////////////////////////////////////////
 //Type
 
+struct AVPacket;
 class FFmpegDemuxer;
+class FramePacer;
+class ReadAheadQueue;
+class MetaCache;
 class FFmpegDemuxerSource:public stream_switch::SourceListener{
   
 public:
@@ -87,6 +91,11 @@ public:
              int local_gap_max_time, 
              unsigned long io_timeout,
              bool native_frame_rate, 
+             int pacing_skew_mode, 
+             int pacing_max_late, 
+             int read_ahead, 
+             bool fast_start, 
+             std::string meta_cache_dir, 
              int source_tcp_port, 
              int queue_size, 
              int debug_flags);    
@@ -104,6 +113,25 @@ protected:
     
     static void * StaticLiveThreadRoutine(void *arg);
     virtual void InternalLiveRoutine();  
+    
+    static void * StaticReadThreadRoutine(void *arg);
+    virtual void InternalReadRoutine();
+    
+    // ReadNextPacket()
+    // read the next packet from the demuxer, or from the read-ahead queue 
+    // if the reading thread is running. If the metadata changes since this 
+    // packet, (*is_meta_changed) is set to true and the new one is copied 
+    // to meta, which should be applied when the packet is published. 
+    // err_state is the state the source should turn into on error
+    virtual int ReadNextPacket(stream_switch::MediaFrameInfo *frame_info, 
+                               AVPacket *pkt, 
+                               stream_switch::StreamMetadata *meta, 
+                               bool *is_meta_changed, 
+                               stream_switch::SourceStreamState *err_state);
+
+    // UpdateMeta()
+    // update the metadata of the source, and save it into the cache
+    virtual void UpdateMeta(const stream_switch::StreamMetadata &meta);
 
     virtual void OnKeyFrame(void);
     virtual void OnMediaStatistic(stream_switch::MediaStatisticInfo *statistic);    
@@ -114,15 +142,27 @@ protected:
 
     stream_switch::StreamSource *source_; 
     FFmpegDemuxer * demuxer_; 
+    FramePacer * pacer_;
+    ReadAheadQueue * read_queue_;
+    MetaCache * meta_cache_;
     stream_switch::StreamMetadata meta_;
  
     pthread_t live_thread_id_;
+    pthread_t read_thread_id_;
     std::string input_name_;    
     unsigned long io_timeout_;
     std::string ffmpeg_options_str_;
  
     bool is_started_;
     bool native_frame_rate_; 
+    int pacing_skew_mode_;
+    int pacing_max_late_;      // in ms
+    int read_ahead_;           // in ms, 0 means reading in the live thread
+    bool fast_start_;
+    int64_t start_time_;       // monotonic time of Start(), in us
+    int64_t open_time_;        // from start_time_, in us
+    int64_t meta_time_;        // from start_time_, in us
+    int64_t first_frame_time_; // from start_time_, in us
     int local_gap_max_time_;
     OnErrorFun on_error_fun_; 
     void *user_data_;
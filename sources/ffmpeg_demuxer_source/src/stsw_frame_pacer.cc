@@ -0,0 +1,413 @@
+/**
+ * This file is part of libstreamswtich, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_frame_pacer.cc
+ *      FramePacer class implementation file, define its methods
+ *
+ * author: OpenSight Team
+ * date: 2016-4-12
+**/
+
+#include "stsw_frame_pacer.h"
+
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "stsw_ffmpeg_source_global.h"
+#include "stsw_log.h"
+
+
+static const int64_t histogram_bounds[PACER_HISTOGRAM_BUCKETS - 1] =
+    PACER_HISTOGRAM_BOUNDS;
+
+
+FramePacer::FramePacer()
+:queued_num_(0), skew_mode_(PACER_SKEW_CATCH_UP),
+max_late_(PACER_DEFAULT_MAX_LATE), is_anchored_(false),
+ts_base_(0), mono_base_(0), stretch_(0), statistic_stretch_(0)
+{
+    pthread_condattr_t cond_attr;
+
+    pthread_mutex_init(&lock_, NULL);
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&wakeup_cond_, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+}
+
+FramePacer::~FramePacer()
+{
+    Flush();
+    pthread_cond_destroy(&wakeup_cond_);
+    pthread_mutex_destroy(&lock_);
+}
+
+void FramePacer::Init(int stream_num, int skew_mode, int64_t max_late)
+{
+    Flush();
+    if(stream_num < 0){
+        stream_num = 0;
+    }
+    queues_.clear();
+    queues_.resize(stream_num);
+    waiting_key_.assign(stream_num, false);
+    last_deadline_.assign(stream_num, 0);
+    skew_mode_ = skew_mode;
+    max_late_ = (max_late > 0) ? max_late : 0;
+
+    is_anchored_ = false;
+    ts_base_ = mono_base_ = 0;
+    stretch_ = 0;
+
+    PacingStatistic zero_statistic;
+    memset(&zero_statistic, 0, sizeof(zero_statistic));
+    pthread_mutex_lock(&lock_);
+    statistic_.assign(stream_num, zero_statistic);
+    statistic_stretch_ = 0;
+    pthread_mutex_unlock(&lock_);
+}
+
+void FramePacer::Flush()
+{
+    PacerQueueVector::iterator queue_it;
+    for(queue_it = queues_.begin(); queue_it != queues_.end(); queue_it++){
+        PacerNodeList::iterator it;
+        for(it = queue_it->begin(); it != queue_it->end(); it++){
+            av_free_packet(&(it->pkt_node.pkt));
+            if(it->meta != NULL){
+                delete it->meta;
+            }
+        }
+        queue_it->clear();
+    }
+    queued_num_ = 0;
+}
+
+void FramePacer::Push(const stream_switch::MediaFrameInfo &frame_info,
+                      AVPacket *pkt,
+                      const stream_switch::StreamMetadata * meta)
+{
+    int index = frame_info.sub_stream_index;
+    if(index < 0 || index >= (int)queues_.size()){
+        // never happen, the sub stream number is fixed after Open()
+        av_free_packet(pkt);
+    }else if(av_dup_packet(pkt) < 0){
+        // the packet data of some demuxers is only valid until the next
+        // av_read_frame(), it must own its data to be queued
+        av_free_packet(pkt);
+    }else{
+        PacerNode node;
+        node.pkt_node.frame_info = frame_info;
+        node.pkt_node.pkt = *pkt;
+        node.meta = (meta != NULL) ? new stream_switch::StreamMetadata(*meta) : NULL;
+        queues_[index].push_back(node);
+        queued_num_++;
+    }
+
+    av_init_packet(pkt);
+    pkt->data = NULL;
+    pkt->size = 0;
+}
+
+bool FramePacer::IsReady()
+{
+    bool all_queued = true;
+    bool has_span = false;
+    int64_t min_head = 0, max_tail = 0;
+
+    if(queued_num_ == 0){
+        return false;
+    }
+    if(queued_num_ >= PACER_MAX_QUEUED_PACKETS){
+        return true;
+    }
+
+    PacerQueueVector::iterator it;
+    for(it = queues_.begin(); it != queues_.end(); it++){
+        if(it->empty()){
+            all_queued = false;
+            continue;
+        }
+        int64_t head = TimevalToUs(it->front().pkt_node.frame_info.timestamp);
+        int64_t tail = TimevalToUs(it->back().pkt_node.frame_info.timestamp);
+        if(!has_span){
+            min_head = head;
+            max_tail = tail;
+            has_span = true;
+        }else{
+            if(head < min_head){
+                min_head = head;
+            }
+            if(tail > max_tail){
+                max_tail = tail;
+            }
+        }
+    }
+
+    // the earliest packet is known for sure if every sub stream has one
+    // queued, otherwise wait for the missing sub streams in the merge
+    // window, beyond which they are regarded as sparse
+    return all_queued || (max_tail - min_head >= PACER_MERGE_WINDOW);
+}
+
+bool FramePacer::IsEmpty()
+{
+    return queued_num_ == 0;
+}
+
+int FramePacer::Pop(stream_switch::MediaFrameInfo *frame_info,
+                    AVPacket *pkt,
+                    stream_switch::StreamMetadata * meta,
+                    bool * is_meta_changed,
+                    const bool *running)
+{
+    int index;
+    int64_t ts, now, deadline, error;
+
+    (*is_meta_changed) = false;
+    index = EarliestQueue();
+    if(index < 0){
+        return FFMPEG_SOURCE_ERR_GENERAL;
+    }
+    PacerNodeList & queue = queues_[index];
+    PacerNode & head = queue.front();
+    PktNode & node = head.pkt_node;
+
+    // drop until the key frame after a packet of this sub stream has been
+    // dropped, otherwise the following frames cannot be decoded
+    if(waiting_key_[index]){
+        if(node.frame_info.frame_type != stream_switch::MEDIA_FRAME_TYPE_KEY_FRAME){
+            goto drop_out;
+        }
+        waiting_key_[index] = false;
+    }
+
+    ts = TimevalToUs(node.frame_info.timestamp);
+    now = MonotonicNow();
+    if(!is_anchored_){
+        ts_base_ = ts;
+        mono_base_ = now;
+        is_anchored_ = true;
+    }
+    deadline = mono_base_ + (ts - ts_base_) + stretch_;
+    if(deadline < last_deadline_[index]){
+        // the packets of one sub stream never go backward
+        deadline = last_deadline_[index];
+    }
+
+    if(deadline > now + PACER_MAX_EARLY){
+        STDERR_LOG(stream_switch::LOG_LEVEL_WARNING,
+                   "The frame time of sub stream %d jumps %lld ms ahead, "
+                   "re-anchor the pacing timeline\n",
+                   index, (long long)((deadline - now) / 1000));
+        ts_base_ = ts;
+        mono_base_ = now - stretch_;
+        deadline = now;
+    }else if(deadline < now - max_late_){
+        pthread_mutex_lock(&lock_);
+        statistic_[index].late_packets++;
+        pthread_mutex_unlock(&lock_);
+
+        if(skew_mode_ == PACER_SKEW_DROP){
+            waiting_key_[index] = true;
+            goto drop_out;
+        }else if(skew_mode_ == PACER_SKEW_STRETCH){
+            // shift the rest of the timeline, so that the following
+            // packets keep their native interval
+            stretch_ += now - deadline;
+            deadline = now;
+        }
+        // for PACER_SKEW_CATCH_UP, send it at once
+    }
+
+    // wait until the deadline, Wakeup() interrupts it for stopping.
+    // (*running) is checked under the lock, so that a Wakeup() between
+    // the check and the waiting is not lost
+    if(deadline > now){
+        struct timespec req;
+        bool is_stopped;
+        req.tv_sec = deadline / 1000000;
+        req.tv_nsec = (deadline % 1000000) * 1000;
+        pthread_mutex_lock(&lock_);
+        while(*running){
+            if(pthread_cond_timedwait(&wakeup_cond_, &lock_, &req) == ETIMEDOUT){
+                break;
+            }
+        }
+        is_stopped = !(*running);
+        pthread_mutex_unlock(&lock_);
+        if(is_stopped){
+            return FFMPEG_SOURCE_ERR_IO;
+        }
+        now = MonotonicNow();
+    }
+
+    error = now - deadline;
+    UpdateStatistic(index, error < 0 ? 0 : error);
+    last_deadline_[index] = deadline;
+
+    (*frame_info) = node.frame_info;
+    if(stretch_ != 0){
+        int64_t shifted = ts + stretch_;
+        frame_info->timestamp.tv_sec = shifted / 1000000;
+        frame_info->timestamp.tv_usec = shifted % 1000000;
+    }
+    (*pkt) = node.pkt;
+    if(head.meta != NULL){
+        (*meta) = *(head.meta);
+        (*is_meta_changed) = true;
+        delete head.meta;
+    }
+    queue.pop_front();
+    queued_num_--;
+    return 0;
+
+drop_out:
+    // the metadata change must not be lost with the packet
+    av_free_packet(&(node.pkt));
+    if(head.meta != NULL){
+        (*meta) = *(head.meta);
+        (*is_meta_changed) = true;
+        delete head.meta;
+    }
+    queue.pop_front();
+    queued_num_--;
+    pthread_mutex_lock(&lock_);
+    statistic_[index].dropped_packets++;
+    pthread_mutex_unlock(&lock_);
+    return FFMPEG_SOURCE_ERR_DROP;
+}
+
+void FramePacer::Wakeup()
+{
+    pthread_mutex_lock(&lock_);
+    pthread_cond_broadcast(&wakeup_cond_);
+    pthread_mutex_unlock(&lock_);
+}
+
+void FramePacer::GetStatistic(PacingStatisticVector *statistic,
+                              int64_t *stretch)
+{
+    pthread_mutex_lock(&lock_);
+    if(statistic != NULL){
+        (*statistic) = statistic_;
+    }
+    if(stretch != NULL){
+        (*stretch) = statistic_stretch_;
+    }
+    pthread_mutex_unlock(&lock_);
+}
+
+std::string FramePacer::FormatStatistic()
+{
+    PacingStatisticVector statistic;
+    int64_t stretch;
+    std::string text;
+    char tmp[256];
+    int i;
+
+    GetStatistic(&statistic, &stretch);
+    snprintf(tmp, sizeof(tmp), "stretch:%lld\n", (long long)stretch);
+    text.append(tmp);
+
+    for(size_t index = 0; index < statistic.size(); index++){
+        const PacingStatistic & sub_stream = statistic[index];
+        snprintf(tmp, sizeof(tmp),
+                 "sub_stream:%d sent_packets:%llu dropped_packets:%llu "
+                 "late_packets:%llu mean_error:%llu max_error:%llu\n",
+                 (int)index,
+                 (unsigned long long)sub_stream.sent_packets,
+                 (unsigned long long)sub_stream.dropped_packets,
+                 (unsigned long long)sub_stream.late_packets,
+                 (unsigned long long)(sub_stream.sent_packets ?
+                     sub_stream.sum_error / sub_stream.sent_packets : 0),
+                 (unsigned long long)sub_stream.max_error);
+        text.append(tmp);
+
+        text.append("error_histogram:");
+        for(i = 0; i < PACER_HISTOGRAM_BUCKETS; i++){
+            if(i < PACER_HISTOGRAM_BUCKETS - 1){
+                snprintf(tmp, sizeof(tmp), " le%lld:%llu",
+                         (long long)histogram_bounds[i],
+                         (unsigned long long)sub_stream.histogram[i]);
+            }else{
+                snprintf(tmp, sizeof(tmp), " gt%lld:%llu",
+                         (long long)histogram_bounds[i - 1],
+                         (unsigned long long)sub_stream.histogram[i]);
+            }
+            text.append(tmp);
+        }
+        text.append("\n");
+    }
+    return text;
+}
+
+int FramePacer::EarliestQueue()
+{
+    int earliest = -1;
+    int64_t earliest_ts = 0;
+    for(int i = 0; i < (int)queues_.size(); i++){
+        if(queues_[i].empty()){
+            continue;
+        }
+        int64_t ts = TimevalToUs(queues_[i].front().pkt_node.frame_info.timestamp);
+        if(earliest < 0 || ts < earliest_ts){
+            earliest = i;
+            earliest_ts = ts;
+        }
+    }
+    return earliest;
+}
+
+void FramePacer::UpdateStatistic(int index, int64_t error)
+{
+    int bucket = 0;
+    while(bucket < PACER_HISTOGRAM_BUCKETS - 1 &&
+          error > histogram_bounds[bucket]){
+        bucket++;
+    }
+
+    pthread_mutex_lock(&lock_);
+    PacingStatistic & sub_stream = statistic_[index];
+    sub_stream.sent_packets++;
+    sub_stream.sum_error += (uint64_t)error;
+    if((uint64_t)error > sub_stream.max_error){
+        sub_stream.max_error = (uint64_t)error;
+    }
+    sub_stream.histogram[bucket]++;
+    statistic_stretch_ = stretch_;
+    pthread_mutex_unlock(&lock_);
+}
+
+int64_t FramePacer::MonotonicNow()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int64_t FramePacer::TimevalToUs(const struct timeval &tv)
+{
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
@@ -0,0 +1,184 @@
+/**
+ * This file is part of libstreamswtich, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_frame_pacer.h
+ *      FramePacer class header file, define intefaces of the FramePacer
+ * class.
+ *      FramePacer releases the demuxed packets of all sub streams at their
+ * native rate for the native_frame_rate mode of FFmpegDemuxerSource
+ *
+ * author: OpenSight Team
+ * date: 2016-4-12
+**/
+
+#ifndef STSW_FRAME_PACER_H
+#define STSW_FRAME_PACER_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <list>
+#include <stream_switch.h>
+
+#include "stsw_ffmpeg_demuxer.h"
+
+
+// how to handle a packet whose deadline has passed over the max late time,
+// e.g. the input IO stalls for a while
+enum PacerSkewMode{
+    PACER_SKEW_CATCH_UP = 0,   // send the late packets at once until catch up
+    PACER_SKEW_DROP = 1,       // drop the late packets until the next key frame
+    PACER_SKEW_STRETCH = 2,    // shift the timeline (and the frame time) by the lateness
+};
+
+#define PACER_DEFAULT_MAX_LATE   100000     // 100 ms, in us
+
+// the max time span of the queued packets (in us), if a sub stream has no
+// packet queued in this window, it's regarded as sparse and not waited
+#define PACER_MERGE_WINDOW       1000000    // 1 sec
+
+#define PACER_MAX_QUEUED_PACKETS 512
+
+// the deadline over this time ahead of now means a timeline jump,
+// re-anchor the timeline instead of waiting for it
+#define PACER_MAX_EARLY          5000000    // 5 sec, in us
+
+// the upper bounds (in us) of the pacing error histogram buckets, the last
+// bucket has no upper bound
+#define PACER_HISTOGRAM_BUCKETS  8
+#define PACER_HISTOGRAM_BOUNDS   {100, 500, 1000, 2000, 5000, 10000, 50000}
+
+// the pacing statistic of one sub stream
+struct PacingStatistic{
+    uint64_t sent_packets;
+    uint64_t dropped_packets;
+    uint64_t late_packets;          // the packets over the max late time
+    uint64_t max_error;             // in us
+    uint64_t sum_error;             // in us
+    uint64_t histogram[PACER_HISTOGRAM_BUCKETS];
+};
+typedef std::vector<PacingStatistic> PacingStatisticVector;
+
+struct PacerNode{
+    PktNode pkt_node;
+    stream_switch::StreamMetadata * meta;   // the new metadata since this packet, or NULL
+};
+typedef std::list<PacerNode> PacerNodeList;
+typedef std::vector<PacerNodeList> PacerQueueVector;
+
+
+// FramePacer
+//    The packets pushed from the demuxer are queued per sub stream and
+// merged by their timestamp, which is their DTS for a live stream (that
+// has no B frame). Each packet is released at its own deadline by
+// waiting on a condition variable bound to CLOCK_MONOTONIC, so the audio
+// and the other sub streams are paced as well as the default one, a
+// wall-clock jump does not affect the pacing, and Wakeup() can interrupt
+// the waiting without any lost-wakeup window.
+//    The timeline is anchored at the first packet released. The pacing
+// error (the actual release time minus the deadline) of each packet is
+// collected into a histogram per sub stream
+class FramePacer{
+public:
+    FramePacer();
+    virtual ~FramePacer();
+
+    // Init()
+    // prepare the queues of the given number of sub streams, and reset
+    // the timeline and the statistic
+    virtual void Init(int stream_num, int skew_mode, int64_t max_late);
+
+    // Flush()
+    // free all the queued packets
+    virtual void Flush();
+
+    // Push()
+    // queue a packet from the demuxer, the pacer takes the ownership of
+    // the packet data, and pkt is reset to empty. meta is the new metadata
+    // since this packet, NULL if not changed, which is carried with the
+    // packet until it's released
+    virtual void Push(const stream_switch::MediaFrameInfo &frame_info,
+                      AVPacket *pkt,
+                      const stream_switch::StreamMetadata * meta);
+
+    // IsReady()
+    // return true if the earliest packet can be released without waiting
+    // for more packets from the demuxer
+    virtual bool IsReady();
+
+    virtual bool IsEmpty();
+
+    // Pop()
+    // Wait until the deadline of the earliest packet and output it, the
+    // caller takes the ownership of pkt. If the metadata changes since
+    // this packet, (*is_meta_changed) is set to true and the new one is
+    // copied to meta, even if the packet is dropped.
+    // Return FFMPEG_SOURCE_ERR_DROP if the packet is dropped for
+    // lateness, FFMPEG_SOURCE_ERR_IO if (*running) becomes false during
+    // waiting, the packet is kept in queue for this case
+    virtual int Pop(stream_switch::MediaFrameInfo *frame_info,
+                    AVPacket *pkt,
+                    stream_switch::StreamMetadata * meta,
+                    bool * is_meta_changed,
+                    const bool *running);
+
+    // Wakeup()
+    // interrupt the waiting of Pop(), the caller should clear (*running)
+    // before invoking it
+    virtual void Wakeup();
+
+    // GetStatistic()
+    // get the statistic of each sub stream, and the timeline shift (in
+    // us) of the stretch mode
+    virtual void GetStatistic(PacingStatisticVector *statistic,
+                              int64_t *stretch);
+    virtual std::string FormatStatistic();
+
+protected:
+    virtual int EarliestQueue();
+    virtual void UpdateStatistic(int index, int64_t error);
+
+    static int64_t MonotonicNow();   // in us
+    static int64_t TimevalToUs(const struct timeval &tv);
+
+    PacerQueueVector queues_;
+    std::vector<bool> waiting_key_;       // drop until the key frame
+    std::vector<int64_t> last_deadline_;
+    size_t queued_num_;
+    int skew_mode_;
+    int64_t max_late_;
+
+    bool is_anchored_;
+    int64_t ts_base_;          // the frame time mapped to mono_base_
+    int64_t mono_base_;        // monotonic time of ts_base_
+    int64_t stretch_;          // in us
+
+    pthread_mutex_t lock_;     // protect the statistic and the waiting
+    pthread_cond_t wakeup_cond_;
+    PacingStatisticVector statistic_;
+    int64_t statistic_stretch_;
+};
+
+#endif
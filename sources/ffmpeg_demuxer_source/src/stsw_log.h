@@ -50,7 +50,9 @@ void SetLogLevel(int log_level);
 #define STDERR_LOG(level, fmt, ...)  \
 do {         \
     if(global_logger != NULL){                  \
-        global_logger->Log(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__);   \
+        if(global_logger->IsLevelEnabled(level)){      \
+            global_logger->Log(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__);   \
+        }     \
     }else{   \
         if(level <= stderr_level) {\
             fprintf(stderr, fmt, ##__VA_ARGS__);    \
@@ -58,4 +60,9 @@ do {         \
     }                             \
 }while(0)
 
+// check it before preparing the arguments of an expensive log
+#define STDERR_LOG_ENABLED(level)  \
+    ((global_logger != NULL) ? global_logger->IsLevelEnabled(level) : \
+                               ((level) <= stderr_level))
+
 #endif    
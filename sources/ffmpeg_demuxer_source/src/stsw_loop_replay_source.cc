@@ -0,0 +1,549 @@
+/**
+ * This file is part of libstreamswtich, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_loop_replay_source.cc
+ *      LoopReplaySource class implementation file, define its methods
+ *
+ * author: OpenSight Team
+ * date: 2016-4-18
+**/
+#include "stsw_loop_replay_source.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <queue>
+#include <functional>
+#include <utility>
+
+#include "stsw_ffmpeg_source_global.h"
+#include "stsw_log.h"
+#include "stsw_ffmpeg_demuxer.h"
+
+
+#define LOOP_REPLAY_META_TIMEOUT 10
+
+// the frame interval assumed if it cannot be found from the input
+#define LOOP_REPLAY_DEFAULT_INTERVAL 40000    // 40 ms, in us
+
+
+static int64_t TimevalToUs(const struct timeval &tv)
+{
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+LoopReplaySource::LoopReplaySource()
+:loop_duration_(0), default_stream_index_(0), io_timeout_(0),
+phase_offset_(0), publish_thread_id_(0), is_started_(false),
+on_error_fun_(NULL), user_data_(NULL)
+{
+    pthread_condattr_t cond_attr;
+
+    pthread_mutex_init(&stop_lock_, NULL);
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&stop_cond_, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+
+    demuxer_ = new FFmpegDemuxer();
+}
+
+LoopReplaySource::~LoopReplaySource()
+{
+    if(demuxer_ != NULL){
+        delete demuxer_;
+        demuxer_ = NULL;
+    }
+    pthread_cond_destroy(&stop_cond_);
+    pthread_mutex_destroy(&stop_lock_);
+}
+
+int LoopReplaySource::Init(std::string input,
+                           std::string stream_name,
+                           std::string ffmpeg_options_str,
+                           unsigned long io_timeout,
+                           int stream_num,
+                           int phase_offset,
+                           int source_tcp_port,
+                           int queue_size,
+                           int debug_flags)
+{
+    std::string err_info;
+    int ret = 0;
+
+    if(stream_num <= 0 || stream_num > LOOP_REPLAY_MAX_STREAMS){
+        STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                   "The number of the loop streams must be 1 ~ %d\n",
+                   LOOP_REPLAY_MAX_STREAMS);
+        return FFMPEG_SOURCE_ERR_GENERAL;
+    }
+
+    for(int i = 0; i < stream_num; i++){
+        LoopStream stream;
+        std::string name = stream_name;
+        int port = 0;
+        if(stream_num > 1){
+            char index_str[16];
+            snprintf(index_str, sizeof(index_str), "_%d", i);
+            name.append(index_str);
+        }
+        if(source_tcp_port != 0){
+            // each source listens on 2 ports
+            port = source_tcp_port + i * 2;
+        }
+
+        stream.source = new stream_switch::StreamSource();
+        stream.ssrc = 0;
+        stream.cursor = 0;
+        stream.base = 0;
+        ret = stream.source->Init(name,
+                                  port,
+                                  queue_size,
+                                  this,
+                                  debug_flags,
+                                  &err_info);
+        if(ret){
+            STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                       "Init Source %s Failed (%d): %s\n",
+                       name.c_str(), ret, err_info.c_str());
+            delete stream.source;
+            ret = FFMPEG_SOURCE_ERR_GENERAL;
+            goto error_out;
+        }
+        streams_.push_back(stream);
+    }
+
+    input_name_ = input;
+    io_timeout_ = io_timeout;
+    ffmpeg_options_str_ = ffmpeg_options_str;
+    phase_offset_ = phase_offset;
+
+    return 0;
+
+error_out:
+    Uninit();
+    return ret;
+}
+
+void LoopReplaySource::Uninit()
+{
+    LoopStreamVector::iterator it;
+    for(it = streams_.begin(); it != streams_.end(); it++){
+        it->source->Uninit();
+        delete it->source;
+    }
+    streams_.clear();
+
+    input_name_.clear();
+    ffmpeg_options_str_.clear();
+    io_timeout_ = 0;
+    phase_offset_ = 0;
+}
+
+int LoopReplaySource::Start(OnErrorFun on_error_fun, void *user_data)
+{
+    int ret = 0;
+    std::string err_info;
+    uint32_t ssrc_base;
+    size_t started_num = 0;
+
+    if(is_started_){
+        return 0; //already start
+    }
+
+    // demux the whole input into memory, only once
+    if(packets_.size() == 0){
+        ret = LoadInput();
+        if(ret){
+            return ret;
+        }
+    }
+
+    ssrc_base = meta_.ssrc;
+    for(size_t i = 0; i < streams_.size(); i++){
+        LoopStream & stream = streams_[i];
+        stream_switch::StreamMetadata meta = meta_;
+        int64_t phase = 0;
+
+        if(loop_duration_ > 0){
+            phase = ((int64_t)phase_offset_ * 1000 * i) % loop_duration_;
+        }
+        stream.ssrc = ssrc_base + (uint32_t)i;
+        stream.cursor = StartPacket(phase);
+        stream.base = -packets_[stream.cursor].time;
+
+        meta.ssrc = stream.ssrc;
+        meta.play_type = stream_switch::STREAM_PLAY_TYPE_LIVE;
+        meta.stream_len = 0.0;
+        stream.source->set_stream_meta(meta);
+
+        ret = stream.source->Start(&err_info);
+        if(ret){
+            STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                       "Source Start failed (ret: %d):%s\n",
+                       ret, err_info.c_str());
+            stream.source->set_stream_state(stream_switch::SOURCE_STREAM_STATE_ERR);
+            ret = FFMPEG_SOURCE_ERR_GENERAL;
+            goto err_out;
+        }
+        stream.source->set_stream_state(stream_switch::SOURCE_STREAM_STATE_OK);
+        started_num++;
+    }
+
+    on_error_fun_ = on_error_fun;
+    user_data_ = user_data;
+    is_started_ = true;
+
+    ret = pthread_create(&publish_thread_id_, NULL,
+                         LoopReplaySource::StaticPublishThreadRoutine,
+                         this);
+    if(ret){
+        STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                   "pthread_create publishing thread failed: %s\n",
+                   strerror(errno));
+        is_started_ = false;
+        publish_thread_id_ = 0;
+        on_error_fun_ = NULL;
+        user_data_ = NULL;
+        ret = -1;
+        goto err_out;
+    }
+
+    STDERR_LOG(stream_switch::LOG_LEVEL_INFO,
+               "LoopReplaySource has started %d streams for input URL: %s "
+               "(%d packets, %d bytes, loop %lld ms)\n",
+               (int)streams_.size(), input_name_.c_str(),
+               (int)packets_.size(), (int)data_.size(),
+               (long long)(loop_duration_ / 1000));
+    return 0;
+
+err_out:
+    for(size_t i = 0; i < started_num; i++){
+        streams_[i].source->Stop();
+    }
+    return ret;
+}
+
+void LoopReplaySource::Stop()
+{
+    if(!is_started_){
+        return; //already stop
+    }
+
+    // clear the flag under the lock, so that the publishing thread cannot
+    // miss the wakeup between its check and its waiting
+    pthread_mutex_lock(&stop_lock_);
+    is_started_ = false;
+    pthread_cond_broadcast(&stop_cond_);
+    pthread_mutex_unlock(&stop_lock_);
+
+    // wait for the publishing thread terminate
+    if(publish_thread_id_ != 0){
+        void * res;
+        int ret;
+        ret = pthread_join(publish_thread_id_, &res);
+        if (ret != 0){
+            STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                   "join publishing thread failed: %s\n", strerror(errno));
+        }
+        publish_thread_id_ = 0;
+    }
+
+    on_error_fun_ = NULL;
+    user_data_ = NULL;
+
+    // stop the sources
+    LoopStreamVector::iterator it;
+    for(it = streams_.begin(); it != streams_.end(); it++){
+        it->source->Stop();
+    }
+
+    STDERR_LOG(stream_switch::LOG_LEVEL_INFO,
+               "LoopReplaySource has stopped for input URL: %s\n",
+                input_name_.c_str());
+}
+
+int LoopReplaySource::LoadInput()
+{
+    stream_switch::MediaFrameInfo frame_info;
+    AVPacket pkt;
+    bool is_meta_changed = false;
+    int ret;
+    int64_t min_time = 0, max_time = 0;
+    int64_t first_default_time = 0, last_default_time = 0;
+    int default_num = 0;
+
+    demuxer_->set_io_enabled(true);
+    ret = demuxer_->Open(input_name_,
+                         ffmpeg_options_str_,
+                         io_timeout_,
+                         PLAY_MODE_REPLAY,
+                         false,
+                         NULL);
+    if(ret){
+        STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                   "Demuxer open failed (ret: %d) for input: %s\n",
+                   ret, input_name_.c_str());
+        return ret;
+    }
+
+    ret = demuxer_->ReadMeta(&meta_, LOOP_REPLAY_META_TIMEOUT);
+    if(ret){
+        STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                   "Demuxer ReadMeta failed (ret: %d) for intput:%s\n",
+                   ret, input_name_.c_str());
+        demuxer_->Close();
+        return ret;
+    }
+    for(int i = 0; i < (int)meta_.sub_streams.size(); i++){
+        if(meta_.sub_streams[i].media_type ==
+               stream_switch::SUB_STREAM_MEIDA_TYPE_VIDEO){
+            default_stream_index_ = i; //first video stream if exist
+            break;
+        }
+    }
+
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+    packets_.clear();
+    data_.clear();
+
+    while(1){
+        LoopPacket packet;
+        is_meta_changed = false;
+        ret = demuxer_->ReadPacket(&frame_info, &pkt, &is_meta_changed);
+        if(ret == FFMPEG_SOURCE_ERR_DROP){
+            continue;
+        }else if(ret == FFMPEG_SOURCE_ERR_EOF){
+            ret = 0;
+            break;
+        }else if(ret){
+            STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                       "Demuxer Read packet error (%d)\n", ret);
+            break;
+        }
+        if(is_meta_changed){
+            // only the latest metadata is published
+            ret = demuxer_->ReadMeta(&meta_, LOOP_REPLAY_META_TIMEOUT);
+            if(ret){
+                STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                           "Demuxer ReadMeta failed (ret: %d) for intput:%s\n",
+                           ret, input_name_.c_str());
+                break;
+            }
+        }
+        if(data_.size() + (size_t)pkt.size > LOOP_REPLAY_MAX_DATA_SIZE){
+            STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                       "Input %s is too large to load into memory\n",
+                       input_name_.c_str());
+            ret = FFMPEG_SOURCE_ERR_GENERAL;
+            break;
+        }
+
+        packet.sub_stream_index = frame_info.sub_stream_index;
+        packet.frame_type = frame_info.frame_type;
+        packet.time = TimevalToUs(frame_info.timestamp);
+        packet.offset = data_.size();
+        packet.size = (size_t)pkt.size;
+        data_.insert(data_.end(), (const char *)pkt.data,
+                     (const char *)pkt.data + pkt.size);
+        packets_.push_back(packet);
+
+        if(packets_.size() == 1 || packet.time < min_time){
+            min_time = packet.time;
+        }
+        if(packets_.size() == 1 || packet.time > max_time){
+            max_time = packet.time;
+        }
+        if(packet.sub_stream_index == default_stream_index_){
+            if(default_num == 0){
+                first_default_time = packet.time;
+            }
+            last_default_time = packet.time;
+            default_num++;
+        }
+        av_free_packet(&pkt);
+    }
+    av_free_packet(&pkt);
+    demuxer_->Close();
+
+    if(ret == 0 && packets_.size() == 0){
+        STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                   "No packet is read from input:%s\n",
+                   input_name_.c_str());
+        ret = FFMPEG_SOURCE_ERR_GENERAL;
+    }
+    if(ret){
+        packets_.clear();
+        std::vector<char>().swap(data_);
+        return ret;
+    }
+
+    // time from the earliest packet, and the loop lasts one more frame
+    // interval after the latest one
+    for(LoopPacketVector::iterator it = packets_.begin(); it != packets_.end(); it++){
+        it->time -= min_time;
+    }
+    loop_duration_ = max_time - min_time;
+    if(default_num > 1 && last_default_time > first_default_time){
+        loop_duration_ += (last_default_time - first_default_time) / (default_num - 1);
+    }else{
+        loop_duration_ += LOOP_REPLAY_DEFAULT_INTERVAL;
+    }
+
+    return 0;
+}
+
+size_t LoopReplaySource::StartPacket(int64_t phase)
+{
+    size_t first_key = packets_.size();
+    for(size_t i = 0; i < packets_.size(); i++){
+        const LoopPacket & packet = packets_[i];
+        if(packet.sub_stream_index != default_stream_index_ ||
+           packet.frame_type != stream_switch::MEDIA_FRAME_TYPE_KEY_FRAME){
+            continue;
+        }
+        if(first_key == packets_.size()){
+            first_key = i;
+        }
+        if(packet.time >= phase){
+            return i;
+        }
+    }
+    // no key frame after the phase, wrap to the first one
+    return (first_key < packets_.size()) ? first_key : 0;
+}
+
+void * LoopReplaySource::StaticPublishThreadRoutine(void *arg)
+{
+    LoopReplaySource * source = (LoopReplaySource * )arg;
+    source->InternalPublishRoutine();
+    return NULL;
+}
+
+void LoopReplaySource::InternalPublishRoutine()
+{
+    // (deadline, stream index), the earliest on top
+    typedef std::pair<int64_t, size_t> StreamDeadline;
+    std::priority_queue<StreamDeadline, std::vector<StreamDeadline>,
+                        std::greater<StreamDeadline> > deadlines;
+    stream_switch::MediaFrameInfo frame_info;
+    struct timespec mono_now;
+    struct timeval wall_now;
+    int64_t mono_base, wall_base;
+    std::string err_info;
+    int ret = 0;
+
+    // the publishing time is in us since this point
+    clock_gettime(CLOCK_MONOTONIC, &mono_now);
+    gettimeofday(&wall_now, NULL);
+    mono_base = (int64_t)mono_now.tv_sec * 1000000 + mono_now.tv_nsec / 1000;
+    wall_base = TimevalToUs(wall_now);
+
+    for(size_t i = 0; i < streams_.size(); i++){
+        deadlines.push(StreamDeadline(
+            streams_[i].base + packets_[streams_[i].cursor].time, i));
+    }
+
+    while(is_started_){
+        StreamDeadline next = deadlines.top();
+        LoopStream & stream = streams_[next.second];
+        const LoopPacket & packet = packets_[stream.cursor];
+        int64_t frame_time = stream.base + packet.time;
+        int64_t deadline = mono_base + next.first;
+        struct timespec req;
+
+        deadlines.pop();
+
+        // wait until the deadline, Stop() interrupts it
+        req.tv_sec = deadline / 1000000;
+        req.tv_nsec = (deadline % 1000000) * 1000;
+        pthread_mutex_lock(&stop_lock_);
+        while(is_started_){
+            if(pthread_cond_timedwait(&stop_cond_, &stop_lock_, &req) == ETIMEDOUT){
+                break;
+            }
+        }
+        pthread_mutex_unlock(&stop_lock_);
+        if(!is_started_){
+            break;
+        }
+
+        frame_info.sub_stream_index = packet.sub_stream_index;
+        frame_info.frame_type = packet.frame_type;
+        frame_info.ssrc = stream.ssrc;
+        frame_info.timestamp.tv_sec = (wall_base + frame_time) / 1000000;
+        frame_info.timestamp.tv_usec = (wall_base + frame_time) % 1000000;
+        ret = stream.source->SendLiveMediaFrame(frame_info,
+                                                &(data_[packet.offset]),
+                                                packet.size,
+                                                &err_info);
+        if(ret){
+            STDERR_LOG(stream_switch::LOG_LEVEL_ERR,
+                "Send live media frame Failed (%d):%s\n",
+                 ret,  err_info.c_str());
+            stream.source->set_stream_state(stream_switch::SOURCE_STREAM_STATE_ERR);
+            ret = FFMPEG_SOURCE_ERR_GENERAL;
+            break;
+        }
+
+        // move to the next packet, the frame time keeps increasing on
+        // wrapping to the next loop
+        stream.cursor++;
+        if(stream.cursor >= packets_.size()){
+            stream.cursor = 0;
+            stream.base += loop_duration_;
+        }
+        frame_time = stream.base + packets_[stream.cursor].time;
+        if(frame_time < next.first){
+            // the packets are sent in decode order, even if the frame
+            // time of B frames goes backward
+            frame_time = next.first;
+        }
+        deadlines.push(StreamDeadline(frame_time, next.second));
+    }
+
+    // callback for error condiction
+    // note: if the source has alread stopped, don't invoke the user callback
+    if(is_started_ && ret != 0){
+        if(on_error_fun_){
+            on_error_fun_(ret, user_data_);
+        }
+    }
+}
+
+void LoopReplaySource::OnKeyFrame(void)
+{
+    // nothing to do
+}
+
+void LoopReplaySource::OnMediaStatistic(stream_switch::MediaStatisticInfo *statistic)
+{
+    // nothing to do
+}
@@ -0,0 +1,138 @@
+/**
+ * This file is part of libstreamswtich, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_loop_replay_source.h
+ *      LoopReplaySource class header file, define intefaces of the
+ * LoopReplaySource class.
+ *      LoopReplaySource demuxes a media file once into memory, and
+ * publishes it as several independent live streams looping forever,
+ * mainly used to load-test the ports and the senders
+ *
+ * author: OpenSight Team
+ * date: 2016-4-18
+**/
+
+#ifndef STSW_LOOP_REPLAY_SOURCE_H
+#define STSW_LOOP_REPLAY_SOURCE_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+#include <stream_switch.h>
+
+#include "stsw_ffmpeg_demuxer_source.h"
+
+// the max number of the streams published by one process
+#define LOOP_REPLAY_MAX_STREAMS  1024
+
+// the max size of the input loaded into memory
+#define LOOP_REPLAY_MAX_DATA_SIZE  (1024 * 1024 * 1024)   // 1 GB
+
+
+class FFmpegDemuxer;
+
+// LoopReplaySource
+//    The input is demuxed only once at Start(), into one contiguous data
+// buffer and a compact packet array of (sub stream, frame type, time,
+// offset, size). Then N StreamSource instances, with the stream names
+// "<name>_<i>" (or just "<name>" if N is 1) and distinct ssrcs, are
+// driven by a single publishing thread: each stream walks the packet
+// array with its own cursor, the stream with the earliest deadline is
+// picked from a heap and its packet is sent straight from the buffer.
+// Thus publishing a stream costs no IO, no demuxing and no copy but the
+// one into the outgoing message.
+//    The frame time is rebased on the local clock and keeps increasing
+// across the loops. The stream i starts at the first key frame after
+// i * phase_offset into the file, so that the key frames of the streams
+// are spread out rather than sent all at once.
+class LoopReplaySource:public stream_switch::SourceListener{
+public:
+    LoopReplaySource();
+    virtual ~LoopReplaySource();
+
+    int Init(std::string input,
+             std::string stream_name,
+             std::string ffmpeg_options_str,
+             unsigned long io_timeout,
+             int stream_num,
+             int phase_offset,
+             int source_tcp_port,
+             int queue_size,
+             int debug_flags);
+    void Uninit();
+    int Start(OnErrorFun on_error_fun, void *user_data);
+    void Stop();
+
+protected:
+    struct LoopPacket{
+        int32_t sub_stream_index;
+        stream_switch::MediaFrameType frame_type;
+        int64_t time;       // from the first packet, in us
+        size_t offset;      // in data_
+        size_t size;
+    };
+    typedef std::vector<LoopPacket> LoopPacketVector;
+
+    struct LoopStream{
+        stream_switch::StreamSource * source;
+        uint32_t ssrc;
+        size_t cursor;      // the next packet to send
+        int64_t base;       // the publishing time of the loop start, in us
+    };
+    typedef std::vector<LoopStream> LoopStreamVector;
+
+    // LoadInput()
+    // demux the whole input into packets_ and data_
+    virtual int LoadInput();
+    virtual size_t StartPacket(int64_t phase);
+
+    static void * StaticPublishThreadRoutine(void *arg);
+    virtual void InternalPublishRoutine();
+
+    virtual void OnKeyFrame(void);
+    virtual void OnMediaStatistic(stream_switch::MediaStatisticInfo *statistic);
+
+    FFmpegDemuxer * demuxer_;
+    stream_switch::StreamMetadata meta_;
+    LoopPacketVector packets_;
+    std::vector<char> data_;
+    int64_t loop_duration_;    // in us
+    int default_stream_index_;
+
+    LoopStreamVector streams_;
+    std::string input_name_;
+    std::string ffmpeg_options_str_;
+    unsigned long io_timeout_;
+    int phase_offset_;         // in ms
+
+    pthread_t publish_thread_id_;
+    bool is_started_;
+    OnErrorFun on_error_fun_;
+    void *user_data_;
+    pthread_mutex_t stop_lock_;     // protect is_started_ for the waiting
+    pthread_cond_t stop_cond_;
+};
+
+#endif
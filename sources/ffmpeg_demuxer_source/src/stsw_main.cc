@@ -45,6 +45,8 @@ extern "C"{
 #include "stsw_ffmpeg_arg_parser.h"
 #include "stsw_log.h"
 #include "stsw_ffmpeg_demuxer_source.h"
+#include "stsw_frame_pacer.h"
+#include "stsw_loop_replay_source.h"
 
 ///////////////////////////////////////////////////////////////
 //Type
@@ -64,6 +66,18 @@ volatile int exit_code = 0;
 
 ///////////////////////////////////////////////////////////////
 //functions
+
+static int PacingSkewMode(const std::string &mode)
+{
+    if(mode == "catchup"){
+        return PACER_SKEW_CATCH_UP;
+    }else if(mode == "drop"){
+        return PACER_SKEW_DROP;
+    }else if(mode == "stretch"){
+        return PACER_SKEW_STRETCH;
+    }
+    return -1;
+}
     
 void ParseArgv(int argc, char *argv[], 
                FFmpegArgParser *parser)
@@ -114,6 +128,13 @@ void ParseArgv(int argc, char *argv[],
             exit(-1);
         }     
     }
+    
+    if(parser->CheckOption("pacing-skew")){
+        if(PacingSkewMode(parser->OptionValue("pacing-skew", "")) < 0){
+            fprintf(stderr, "pacing-skew must be catchup, drop or stretch\n");
+            exit(-1);
+        }
+    }
 
 }
 static void OnSourceErrorFun(int error_code, void *user_data)
@@ -129,6 +150,7 @@ int main(int argc, char *argv[])
     using namespace stream_switch;        
     int ret = 0;
     FFmpegDemuxerSource * source = NULL;
+    LoopReplaySource * loop_source = NULL;
     int pub_queue_size = STSW_PUBLISH_SOCKET_HWM;
     int log_level = 6;
     
@@ -168,11 +190,37 @@ int main(int argc, char *argv[])
     //
     //init source
     
-    source = FFmpegDemuxerSource::Instance();   
-      
     if(parser.CheckOption("queue-size")){
         pub_queue_size = (int)strtol(parser.OptionValue("queue-size", "60").c_str(), NULL, 0);
     }
+    
+    if(parser.CheckOption("loop-streams")){
+        // load-test mode, publish the input from memory in loop
+        loop_source = new LoopReplaySource();
+        ret = loop_source->Init(
+            parser.OptionValue("url", ""), 
+            parser.OptionValue("stream-name", ""), 
+            parser.ffmpeg_options(), 
+            strtoul(parser.OptionValue("io-timeout", "10000").c_str(), NULL, 0), 
+            (int)strtol(parser.OptionValue("loop-streams", "1").c_str(), NULL, 0), 
+            (int)strtol(parser.OptionValue("loop-phase", "0").c_str(), NULL, 0), 
+            (int)strtol(parser.OptionValue("port", "0").c_str(), NULL, 0), 
+            pub_queue_size, 
+            (int)strtol(parser.OptionValue("debug-flags", "0").c_str(), NULL, 0));
+        if(ret){
+            STDERR_LOG(stream_switch::LOG_LEVEL_ERR, 
+                        "ffmpeg_demux_srouce init error, exit\n");   
+            goto exit_2;       
+        }
+        ret = loop_source->Start(OnSourceErrorFun, NULL);
+        if(ret){
+            goto exit_3;
+        }
+        goto run;
+    }
+    
+    source = FFmpegDemuxerSource::Instance();   
+      
     ret = source->Init(
         parser.OptionValue("url", ""), 
         parser.OptionValue("stream-name", ""), 
@@ -180,6 +228,11 @@ int main(int argc, char *argv[])
         (int)strtol(parser.OptionValue("local-max-gap", "20").c_str(), NULL, 0), 
         strtoul(parser.OptionValue("io-timeout", "10000").c_str(), NULL, 0), 
         parser.CheckOption("native-frame-rate"),
+        PacingSkewMode(parser.OptionValue("pacing-skew", "catchup")), 
+        (int)strtol(parser.OptionValue("pacing-max-late", "100").c_str(), NULL, 0), 
+        (int)strtol(parser.OptionValue("read-ahead", "1000").c_str(), NULL, 0), 
+        parser.CheckOption("fast-start"), 
+        parser.OptionValue("meta-cache-dir", ""), 
         (int)strtol(parser.OptionValue("port", "0").c_str(), NULL, 0), 
         pub_queue_size, 
         (int)strtol(parser.OptionValue("debug-flags", "0").c_str(), NULL, 0));
@@ -196,6 +249,8 @@ int main(int argc, char *argv[])
         goto exit_3;
     }
 
+run:
+
     //drive the proxy heartbeat    
     while(1){
         
@@ -232,16 +287,28 @@ int main(int argc, char *argv[])
     
 
     //stop ffmpeg_demux_srouce 
-    source->Stop();    
+    if(loop_source != NULL){
+        loop_source->Stop();
+    }else{
+        source->Stop();    
+    }
     
 exit_3:
 
     //uninit ffmpeg_demux_srouce
-    source->Uninit();
+    if(loop_source != NULL){
+        loop_source->Uninit();
+    }else{
+        source->Uninit();
+    }
     
 exit_2:  
 
     //uninstance
+    if(loop_source != NULL){
+        delete loop_source;
+        loop_source = NULL;
+    }
     FFmpegDemuxerSource::Uninstance();  
   
     //uninit logger
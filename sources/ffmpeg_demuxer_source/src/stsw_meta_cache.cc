@@ -0,0 +1,294 @@
+/**
+ * This file is part of libstreamswtich, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_meta_cache.cc
+ *      MetaCache class implementation file, define its methods
+ *
+ * author: OpenSight Team
+ * date: 2016-4-21
+**/
+
+#include "stsw_meta_cache.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sstream>
+
+#include "stsw_log.h"
+
+
+#define META_CACHE_MAGIC  "stsw_meta_cache"
+#define META_CACHE_VERSION  1
+
+// cache file never grows up to this size, unless it's not a cache file
+#define META_CACHE_MAX_FILE_SIZE  (1024 * 1024)
+
+
+// 64-bit FNV-1a hash of the input URL
+static uint64_t HashInput(const std::string &input)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for(size_t i = 0; i < input.size(); i++){
+        hash ^= (uint8_t)input[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static std::string HexEncode(const std::string &data)
+{
+    static const char hex_digits[] = "0123456789abcdef";
+    std::string hex;
+    if(data.empty()){
+        return std::string("-");
+    }
+    hex.reserve(data.size() * 2);
+    for(size_t i = 0; i < data.size(); i++){
+        hex.push_back(hex_digits[(uint8_t)data[i] >> 4]);
+        hex.push_back(hex_digits[(uint8_t)data[i] & 0x0f]);
+    }
+    return hex;
+}
+
+static int HexValue(char c)
+{
+    if(c >= '0' && c <= '9'){
+        return c - '0';
+    }else if(c >= 'a' && c <= 'f'){
+        return c - 'a' + 10;
+    }else if(c >= 'A' && c <= 'F'){
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static bool HexDecode(const std::string &hex, std::string *data)
+{
+    data->clear();
+    if(hex == "-"){
+        return true;
+    }
+    if(hex.size() % 2 != 0){
+        return false;
+    }
+    data->reserve(hex.size() / 2);
+    for(size_t i = 0; i < hex.size(); i += 2){
+        int high = HexValue(hex[i]);
+        int low = HexValue(hex[i + 1]);
+        if(high < 0 || low < 0){
+            return false;
+        }
+        data->push_back((char)((high << 4) | low));
+    }
+    return true;
+}
+
+
+MetaCache::MetaCache()
+{
+    
+}
+
+MetaCache::~MetaCache()
+{
+    
+}
+
+void MetaCache::Init(const std::string &cache_dir, const std::string &input)
+{
+    char file_name[64];
+    
+    file_path_.clear();
+    last_text_.clear();
+    if(cache_dir.empty()){
+        return;
+    }
+    
+    snprintf(file_name, sizeof(file_name), "%016llx" META_CACHE_FILE_SUFFIX, 
+             (unsigned long long)HashInput(input));
+    file_path_ = cache_dir;
+    if(file_path_[file_path_.size() - 1] != '/'){
+        file_path_.push_back('/');
+    }
+    file_path_.append(file_name);
+}
+
+bool MetaCache::enabled()
+{
+    return !file_path_.empty();
+}
+
+bool MetaCache::Load(stream_switch::StreamMetadata *meta)
+{
+    FILE * fp;
+    std::string text;
+    char buf[4096];
+    size_t len;
+    
+    if(!enabled() || meta == NULL){
+        return false;
+    }
+    
+    fp = fopen(file_path_.c_str(), "r");
+    if(fp == NULL){
+        if(errno != ENOENT){
+            STDERR_LOG(stream_switch::LOG_LEVEL_WARNING, 
+                       "Cannot open metadata cache %s: %s\n", 
+                       file_path_.c_str(), strerror(errno));
+        }
+        return false;
+    }
+    while((len = fread(buf, 1, sizeof(buf), fp)) > 0){
+        text.append(buf, len);
+        if(text.size() > META_CACHE_MAX_FILE_SIZE){
+            break;
+        }
+    }
+    fclose(fp);
+    
+    if(text.size() > META_CACHE_MAX_FILE_SIZE || !Unserialize(text, meta)){
+        STDERR_LOG(stream_switch::LOG_LEVEL_WARNING, 
+                   "Metadata cache %s is corrupt, ignored\n", 
+                   file_path_.c_str());
+        return false;
+    }
+    last_text_ = text;
+    return true;
+}
+
+void MetaCache::Save(const stream_switch::StreamMetadata &meta)
+{
+    std::string text;
+    std::string tmp_path;
+    FILE * fp;
+    char suffix[32];
+    
+    if(!enabled()){
+        return;
+    }
+    text = Serialize(meta);
+    if(text == last_text_){
+        return; // not changed
+    }
+    
+    // write into a temporary file then rename it, so that the cache file 
+    // is never partial even if the process is killed during writing
+    snprintf(suffix, sizeof(suffix), ".%d.tmp", (int)getpid());
+    tmp_path = file_path_ + suffix;
+    fp = fopen(tmp_path.c_str(), "w");
+    if(fp == NULL){
+        STDERR_LOG(stream_switch::LOG_LEVEL_WARNING, 
+                   "Cannot create metadata cache %s: %s\n", 
+                   tmp_path.c_str(), strerror(errno));
+        return;
+    }
+    if(fwrite(text.data(), 1, text.size(), fp) != text.size()){
+        STDERR_LOG(stream_switch::LOG_LEVEL_WARNING, 
+                   "Write metadata cache %s failed: %s\n", 
+                   tmp_path.c_str(), strerror(errno));
+        fclose(fp);
+        unlink(tmp_path.c_str());
+        return;
+    }
+    if(fclose(fp) != 0 || rename(tmp_path.c_str(), file_path_.c_str()) != 0){
+        STDERR_LOG(stream_switch::LOG_LEVEL_WARNING, 
+                   "Save metadata cache %s failed: %s\n", 
+                   file_path_.c_str(), strerror(errno));
+        unlink(tmp_path.c_str());
+        return;
+    }
+    last_text_ = text;
+}
+
+std::string MetaCache::Serialize(const stream_switch::StreamMetadata &meta)
+{
+    std::ostringstream out;
+    stream_switch::SubStreamMetadataVector::const_iterator it;
+    
+    out << META_CACHE_MAGIC << " " << META_CACHE_VERSION << "\n";
+    out << meta.sub_streams.size() << "\n";
+    for(it = meta.sub_streams.begin(); it != meta.sub_streams.end(); it++){
+        out << it->sub_stream_index << " "
+            << (int)it->media_type << " "
+            << it->codec_name << " "
+            << it->media_param.video.width << " "
+            << it->media_param.video.height << " "
+            << it->media_param.video.fps << " "
+            << it->media_param.audio.samples_per_second << " "
+            << it->media_param.audio.channels << " "
+            << it->media_param.audio.bits_per_sample << " "
+            << it->media_param.audio.sampele_per_frame << " "
+            << HexEncode(it->extra_data) << "\n";
+    }
+    return out.str();
+}
+
+bool MetaCache::Unserialize(const std::string &text, 
+                            stream_switch::StreamMetadata *meta)
+{
+    std::istringstream in(text);
+    std::string magic;
+    int version = 0;
+    size_t sub_stream_num = 0;
+    stream_switch::SubStreamMetadataVector sub_streams;
+    
+    in >> magic >> version >> sub_stream_num;
+    if(!in || magic != META_CACHE_MAGIC || version != META_CACHE_VERSION){
+        return false;
+    }
+    if(sub_stream_num == 0 || sub_stream_num > 64){
+        return false;
+    }
+    
+    for(size_t i = 0; i < sub_stream_num; i++){
+        stream_switch::SubStreamMetadata sub_stream;
+        int media_type;
+        std::string extra_hex;
+        
+        in >> sub_stream.sub_stream_index
+           >> media_type
+           >> sub_stream.codec_name
+           >> sub_stream.media_param.video.width
+           >> sub_stream.media_param.video.height
+           >> sub_stream.media_param.video.fps
+           >> sub_stream.media_param.audio.samples_per_second
+           >> sub_stream.media_param.audio.channels
+           >> sub_stream.media_param.audio.bits_per_sample
+           >> sub_stream.media_param.audio.sampele_per_frame
+           >> extra_hex;
+        if(!in || sub_stream.sub_stream_index != (int32_t)i){
+            return false;
+        }
+        if(!HexDecode(extra_hex, &sub_stream.extra_data)){
+            return false;
+        }
+        sub_stream.media_type = (stream_switch::SubStreamMediaType)media_type;
+        sub_streams.push_back(sub_stream);
+    }
+    
+    meta->sub_streams = sub_streams;
+    return true;
+}
@@ -0,0 +1,82 @@
+/**
+ * This file is part of libstreamswtich, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_meta_cache.h
+ *      MetaCache class header file, define intefaces of the MetaCache 
+ * class. 
+ *      MetaCache persists the stream metadata of an input in a file, so 
+ * that FFmpegDemuxerSource can publish at once after restart without 
+ * waiting for the codec config in the first key frame
+ *
+ * author: OpenSight Team
+ * date: 2016-4-21
+**/
+
+#ifndef STSW_META_CACHE_H
+#define STSW_META_CACHE_H
+
+#include <string>
+#include <stream_switch.h>
+
+
+#define META_CACHE_FILE_SUFFIX  ".meta"
+
+
+// MetaCache
+//    The metadata of an input is stored in the file named by the hash of 
+// the input URL under the cache directory. The URL itself is not stored, 
+// since it may contain the credentials. Only the fields which cannot be 
+// got without the media data are stored (codec, extra data, video and 
+// audio params of each sub stream), the ssrc, the play type and so on 
+// are always from the opened input. 
+//    The cache is best effort, all the IO errors are only logged.
+class MetaCache{
+public:
+    MetaCache();
+    virtual ~MetaCache();
+    
+    // Init()
+    // set the cache directory and the input, empty cache_dir disables 
+    // the cache
+    virtual void Init(const std::string &cache_dir, const std::string &input);
+    
+    virtual bool enabled();
+    
+    // Load()
+    // Return true if the cached metadata of the input is found
+    virtual bool Load(stream_switch::StreamMetadata *meta);
+    
+    // Save()
+    // store the metadata if it differs from the one loaded or saved last
+    virtual void Save(const stream_switch::StreamMetadata &meta);
+
+protected:
+    virtual std::string Serialize(const stream_switch::StreamMetadata &meta);
+    virtual bool Unserialize(const std::string &text, 
+                             stream_switch::StreamMetadata *meta);
+    
+    std::string file_path_;
+    std::string last_text_;
+};
+
+#endif
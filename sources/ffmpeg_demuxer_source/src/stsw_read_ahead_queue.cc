@@ -0,0 +1,239 @@
+/**
+ * This file is part of libstreamswtich, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_read_ahead_queue.cc
+ *      ReadAheadQueue class implementation file, define its methods
+ *
+ * author: OpenSight Team
+ * date: 2016-4-14
+**/
+
+#include "stsw_read_ahead_queue.h"
+
+#include <stdio.h>
+
+#include "stsw_ffmpeg_source_global.h"
+
+
+static int64_t TimevalToUs(const struct timeval &tv)
+{
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+ReadAheadQueue::ReadAheadQueue()
+:node_num_(0), capacity_(READ_AHEAD_DEFAULT_TIME * 1000), is_aborted_(false), error_(0),
+error_state_(stream_switch::SOURCE_STREAM_STATE_OK), has_popped_(false),
+underruns_(0), read_packets_(0)
+{
+    pthread_mutex_init(&lock_, NULL);
+    pthread_cond_init(&not_full_, NULL);
+    pthread_cond_init(&not_empty_, NULL);
+}
+
+ReadAheadQueue::~ReadAheadQueue()
+{
+    Flush();
+    pthread_cond_destroy(&not_empty_);
+    pthread_cond_destroy(&not_full_);
+    pthread_mutex_destroy(&lock_);
+}
+
+void ReadAheadQueue::Init(int64_t capacity)
+{
+    Flush();
+
+    pthread_mutex_lock(&lock_);
+    capacity_ = capacity;
+    is_aborted_ = false;
+    error_ = 0;
+    error_state_ = stream_switch::SOURCE_STREAM_STATE_OK;
+    has_popped_ = false;
+    underruns_ = 0;
+    read_packets_ = 0;
+    pthread_mutex_unlock(&lock_);
+}
+
+void ReadAheadQueue::Flush()
+{
+    pthread_mutex_lock(&lock_);
+    ReadAheadNodeList::iterator it;
+    for(it = nodes_.begin(); it != nodes_.end(); it++){
+        av_free_packet(&(it->pkt_node.pkt));
+        if(it->meta != NULL){
+            delete it->meta;
+        }
+    }
+    nodes_.clear();
+    node_num_ = 0;
+    pthread_cond_broadcast(&not_full_);
+    pthread_mutex_unlock(&lock_);
+}
+
+bool ReadAheadQueue::Push(const stream_switch::MediaFrameInfo &frame_info,
+                          AVPacket *pkt,
+                          const stream_switch::StreamMetadata * meta)
+{
+    ReadAheadNode node;
+
+    // the packet data of some demuxers is only valid until the next
+    // av_read_frame(), make it own its data before queued
+    if(av_dup_packet(pkt) < 0){
+        av_free_packet(pkt);
+        return true;
+    }
+
+    pthread_mutex_lock(&lock_);
+    while(!is_aborted_ && IsFull()){
+        pthread_cond_wait(&not_full_, &lock_);
+    }
+    if(is_aborted_){
+        pthread_mutex_unlock(&lock_);
+        av_free_packet(pkt);
+        return false;
+    }
+
+    node.pkt_node.frame_info = frame_info;
+    node.pkt_node.pkt = *pkt;
+    node.meta = (meta != NULL) ? new stream_switch::StreamMetadata(*meta) : NULL;
+    nodes_.push_back(node);
+    node_num_++;
+    read_packets_++;
+    pthread_cond_signal(&not_empty_);
+    pthread_mutex_unlock(&lock_);
+
+    av_init_packet(pkt);
+    pkt->data = NULL;
+    pkt->size = 0;
+    return true;
+}
+
+void ReadAheadQueue::PushError(int err, stream_switch::SourceStreamState state)
+{
+    pthread_mutex_lock(&lock_);
+    error_ = err;
+    error_state_ = state;
+    pthread_cond_signal(&not_empty_);
+    pthread_mutex_unlock(&lock_);
+}
+
+int ReadAheadQueue::Pop(stream_switch::MediaFrameInfo *frame_info,
+                        AVPacket *pkt,
+                        stream_switch::StreamMetadata * meta,
+                        bool * is_meta_changed,
+                        stream_switch::SourceStreamState * state)
+{
+    int ret = 0;
+
+    pthread_mutex_lock(&lock_);
+    if(nodes_.empty() && error_ == 0 && !is_aborted_ && has_popped_){
+        // the publisher has to wait for the input
+        underruns_++;
+    }
+    while(nodes_.empty() && error_ == 0 && !is_aborted_){
+        pthread_cond_wait(&not_empty_, &lock_);
+    }
+
+    if(is_aborted_){
+        ret = FFMPEG_SOURCE_ERR_IO;
+    }else if(!nodes_.empty()){
+        ReadAheadNode & node = nodes_.front();
+        (*frame_info) = node.pkt_node.frame_info;
+        (*pkt) = node.pkt_node.pkt;
+        (*is_meta_changed) = false;
+        if(node.meta != NULL){
+            (*meta) = *(node.meta);
+            (*is_meta_changed) = true;
+            delete node.meta;
+        }
+        nodes_.pop_front();
+        node_num_--;
+        has_popped_ = true;
+        pthread_cond_signal(&not_full_);
+    }else{
+        ret = error_;
+        (*state) = error_state_;
+    }
+    pthread_mutex_unlock(&lock_);
+
+    return ret;
+}
+
+void ReadAheadQueue::Abort()
+{
+    pthread_mutex_lock(&lock_);
+    is_aborted_ = true;
+    pthread_cond_broadcast(&not_full_);
+    pthread_cond_broadcast(&not_empty_);
+    pthread_mutex_unlock(&lock_);
+}
+
+void ReadAheadQueue::GetStatistic(ReadAheadStatistic *statistic)
+{
+    if(statistic == NULL){
+        return;
+    }
+    pthread_mutex_lock(&lock_);
+    statistic->fill_time = FillTime();
+    statistic->fill_packets = (uint32_t)node_num_;
+    statistic->capacity = capacity_;
+    statistic->underruns = underruns_;
+    statistic->read_packets = read_packets_;
+    pthread_mutex_unlock(&lock_);
+}
+
+std::string ReadAheadQueue::FormatStatistic()
+{
+    ReadAheadStatistic statistic;
+    char tmp[256];
+
+    GetStatistic(&statistic);
+    snprintf(tmp, sizeof(tmp),
+             "read_ahead_fill:%lld read_ahead_packets:%u read_ahead_capacity:%lld "
+             "read_packets:%llu underruns:%llu\n",
+             (long long)(statistic.fill_time / 1000),
+             (unsigned)statistic.fill_packets,
+             (long long)(statistic.capacity / 1000),
+             (unsigned long long)statistic.read_packets,
+             (unsigned long long)statistic.underruns);
+    return std::string(tmp);
+}
+
+bool ReadAheadQueue::IsFull()
+{
+    return node_num_ >= READ_AHEAD_MAX_PACKETS ||
+           FillTime() >= capacity_;
+}
+
+int64_t ReadAheadQueue::FillTime()
+{
+    int64_t fill_time;
+    if(node_num_ < 2){
+        return 0;
+    }
+    // the packets are read in the interleaved order of the input, whose
+    // frame time is roughly increasing
+    fill_time = TimevalToUs(nodes_.back().pkt_node.frame_info.timestamp) -
+                TimevalToUs(nodes_.front().pkt_node.frame_info.timestamp);
+    return (fill_time > 0) ? fill_time : 0;
+}
@@ -0,0 +1,141 @@
+/**
+ * This file is part of libstreamswtich, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_read_ahead_queue.h
+ *      ReadAheadQueue class header file, define intefaces of the
+ * ReadAheadQueue class.
+ *      ReadAheadQueue is the bounded packet queue between the reading
+ * thread and the publishing thread of FFmpegDemuxerSource
+ *
+ * author: OpenSight Team
+ * date: 2016-4-14
+**/
+
+#ifndef STSW_READ_AHEAD_QUEUE_H
+#define STSW_READ_AHEAD_QUEUE_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <string>
+#include <list>
+#include <stream_switch.h>
+
+#include "stsw_ffmpeg_demuxer.h"
+
+
+#define READ_AHEAD_DEFAULT_TIME    1000     // 1 sec, in ms
+
+// bound the queue by the packet number as well, in case the packets
+// have no valid timestamp
+#define READ_AHEAD_MAX_PACKETS     8192
+
+struct ReadAheadNode{
+    PktNode pkt_node;
+    stream_switch::StreamMetadata * meta;   // the new metadata since this packet, or NULL
+};
+typedef std::list<ReadAheadNode> ReadAheadNodeList;
+
+struct ReadAheadStatistic{
+    int64_t fill_time;          // the media time span in queue, in us
+    uint32_t fill_packets;
+    int64_t capacity;           // in us
+    uint64_t underruns;         // the times the publisher found the queue empty
+    uint64_t read_packets;
+};
+
+
+// ReadAheadQueue
+//    The reading thread pushes the packets from the demuxer into the
+// queue, and the publishing thread pops them. The queue is bounded by the
+// media time (the frame time span of the packets queued), the reading
+// thread is blocked when it's full, so a short IO stall of the input is
+// absorbed by the packets read ahead instead of becoming an output gap.
+//    The packets are moved into the queue by reference, not copied.
+class ReadAheadQueue{
+public:
+    ReadAheadQueue();
+    virtual ~ReadAheadQueue();
+
+    // Init()
+    // reset the queue with the given capacity (in us)
+    virtual void Init(int64_t capacity);
+
+    // Flush()
+    // free all the queued packets
+    virtual void Flush();
+
+    // Push()
+    // Queue a packet, block while the queue is full. The queue takes the
+    // ownership of the packet data, and pkt is reset to empty. meta is the
+    // new metadata since this packet, NULL if not changed.
+    // Return false if the queue is aborted, and the packet is freed
+    virtual bool Push(const stream_switch::MediaFrameInfo &frame_info,
+                      AVPacket *pkt,
+                      const stream_switch::StreamMetadata * meta);
+
+    // PushError()
+    // The reading thread stops for the error, which would be returned
+    // by Pop() after all the queued packets, along with the stream state
+    // the source should turn into
+    virtual void PushError(int err, stream_switch::SourceStreamState state);
+
+    // Pop()
+    // Get the earliest packet, block while the queue is empty. The caller
+    // takes the ownership of pkt. If the metadata changes since this
+    // packet, (*is_meta_changed) is set to true and the new one is copied
+    // to meta.
+    // Return the error of the reading thread if it has stopped, in which
+    // case state is set, or FFMPEG_SOURCE_ERR_IO if the queue is aborted
+    virtual int Pop(stream_switch::MediaFrameInfo *frame_info,
+                    AVPacket *pkt,
+                    stream_switch::StreamMetadata * meta,
+                    bool * is_meta_changed,
+                    stream_switch::SourceStreamState * state);
+
+    // Abort()
+    // wake up and fail both threads blocked in Push() / Pop()
+    virtual void Abort();
+
+    virtual void GetStatistic(ReadAheadStatistic *statistic);
+    virtual std::string FormatStatistic();
+
+protected:
+    virtual bool IsFull();
+    virtual int64_t FillTime();
+
+    pthread_mutex_t lock_;
+    pthread_cond_t not_full_;
+    pthread_cond_t not_empty_;
+
+    ReadAheadNodeList nodes_;
+    size_t node_num_;
+    int64_t capacity_;
+    bool is_aborted_;
+    int error_;
+    stream_switch::SourceStreamState error_state_;
+    bool has_popped_;
+    uint64_t underruns_;
+    uint64_t read_packets_;
+};
+
+#endif
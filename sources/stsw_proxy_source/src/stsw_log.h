@@ -45,7 +45,9 @@ extern int stderr_level;
 #define STDERR_LOG(level, fmt, ...)  \
 do {         \
     if(global_logger != NULL){                  \
-        global_logger->Log(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__);   \
+        if(global_logger->IsLevelEnabled(level)){      \
+            global_logger->Log(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__);   \
+        }     \
     }else{   \
         if(level <= stderr_level) {\
             fprintf(stderr, fmt, ##__VA_ARGS__);    \
@@ -0,0 +1,664 @@
+/*
+ * stsw_flv_media_publisher.cc
+ *
+ *  Created on: Apr 23, 2016
+ *      Author: OpenSight Team
+ */
+
+#include <string.h>
+#include <unistd.h>
+
+#include "stsw_flv_media_publisher.h"
+#include <librtmp/rtmp.h>
+#include <librtmp/amf.h>
+
+
+extern stream_switch::RotateLogger * logger;
+
+#define SAVC(x) static const AVal av_##x = AVC(#x)
+
+// FLV tag types, see E.4.1 of "Adobe Flash Video File Format Specification"
+#define FLV_TAG_TYPE_AUDIO  8
+#define FLV_TAG_TYPE_VIDEO  9
+#define FLV_TAG_HEADER_SIZE  11
+#define FLV_TAG_PREV_SIZE  4
+
+#define FLV_VIDEO_FRAME_KEY  1
+#define FLV_VIDEO_FRAME_INFO  5
+#define FLV_VIDEO_CODEC_AVC  7
+#define FLV_VIDEO_CODEC_HEVC  12    // not standard, but widely used
+
+#define FLV_AUDIO_CODEC_PCMA  7
+#define FLV_AUDIO_CODEC_PCMU  8
+#define FLV_AUDIO_CODEC_AAC  10
+
+#define FLV_PACKET_SEQUENCE_HEADER  0
+#define FLV_PACKET_NALU  1      // or the raw AAC frame for audio
+
+#define AAC_SAMPLES_PER_FRAME  1024
+
+static const char startCode[4] = {0, 0, 0, 1};
+
+static const uint32_t aacSampleRates[16] = {
+    96000, 88200, 64000, 48000, 44100, 32000,
+    24000, 22050, 16000, 12000, 11025, 8000, 7350, 0, 0, 0
+};
+
+
+FlvMediaPublisher::FlvMediaPublisher( )
+    :metaReady_(0),
+     source_(),
+     hasVideo_(0),
+     hasAudio_(0),
+     bps_(0),
+     videoConfigReady_(0),
+     audioConfigReady_(0),
+     videoIndex_(-1),
+     audioIndex_(-1),
+     nalLengthSize_(4),
+     ssrc_(0),
+     firstMediaTimestamp_(0),
+     hasFirstMedia_(0),
+     frames_(0),
+     bytes_(0),
+     droppedFrames_(0)
+{
+    baseTime_.tv_sec = baseTime_.tv_usec = 0;
+}
+
+
+FlvMediaPublisher::~FlvMediaPublisher() {
+
+}
+
+
+int FlvMediaPublisher::Init(
+        const std::string &stream_name,
+        int source_tcp_port,
+        int queue_size,
+        int debug_flags)
+{
+    int ret;
+    std::string err_info;
+    struct timeval now;
+    unsigned int seed;
+
+    //init source
+    ret = source_.Init(stream_name, source_tcp_port,
+                       queue_size,
+                       this, debug_flags, &err_info);
+    if (ret) {
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_ERR, "Failed to init stream source %s: %s",
+                   stream_name.c_str(), err_info.c_str());
+        return ret;
+    }
+    streamName_ = stream_name;
+
+    //calculate ssrc, rand_r() as there may be many publishers in threads
+    gettimeofday(&now, NULL);
+    seed = ((unsigned)getpid() << 20) + now.tv_usec + (unsigned)(uintptr_t)this;
+    ssrc_ = (uint32_t)(rand_r(&seed) % 0xffffffff);
+
+    return 0;
+}
+
+
+void FlvMediaPublisher::Uninit() {
+
+    source_.Uninit();
+}
+
+
+SAVC(onMetaData);
+SAVC(setDataFrame);
+SAVC(width);
+SAVC(height);
+SAVC(framerate);
+SAVC(videocodecid);
+SAVC(audiocodecid);
+SAVC(videodatarate);
+SAVC(audiodatarate);
+
+int FlvMediaPublisher::HandleonMetaData(char *body, unsigned int len) {
+
+    AMFObject obj;
+    AVal metastring;
+
+    int nRes = AMF_Decode(&obj, body, len, FALSE);
+    if (nRes < 0)
+    {
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_ERR, "error decoding meta data message");
+        return -1;
+    }
+
+    AMFProp_GetString(AMF_GetProp(&obj, NULL, 0), &metastring);
+    if (metastring.av_len == av_setDataFrame.av_len + 1 && metastring.av_val[0] == '@' &&
+        !memcmp(metastring.av_val + 1, av_setDataFrame.av_val, av_setDataFrame.av_len)) {
+        AMFProp_GetString(AMF_GetProp(&obj, NULL, 1), &metastring);
+    }
+
+    if (AVMATCH(&metastring, &av_onMetaData))
+    {
+        AMFObjectProperty prop;
+        double datarate = 0.0;
+
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_INFO, "onMetaData Message received for %s", streamName_.c_str());
+
+        /* the announced media, whose sequence headers would be waited for */
+        if (RTMP_FindFirstMatchingProperty(&obj, &av_videocodecid, &prop))
+            hasVideo_ = 1;
+        if (RTMP_FindFirstMatchingProperty(&obj, &av_audiocodecid, &prop))
+            hasAudio_ = 1;
+
+        if (RTMP_FindFirstMatchingProperty(&obj, &av_width, &prop))
+            videoParam_.width = (uint32_t)AMFProp_GetNumber(&prop);
+        if (RTMP_FindFirstMatchingProperty(&obj, &av_height, &prop))
+            videoParam_.height = (uint32_t)AMFProp_GetNumber(&prop);
+        if (RTMP_FindFirstMatchingProperty(&obj, &av_framerate, &prop))
+            videoParam_.fps = (uint32_t)AMFProp_GetNumber(&prop);
+
+        /* in kbps */
+        if (RTMP_FindFirstMatchingProperty(&obj, &av_videodatarate, &prop))
+            datarate += AMFProp_GetNumber(&prop);
+        if (RTMP_FindFirstMatchingProperty(&obj, &av_audiodatarate, &prop))
+            datarate += AMFProp_GetNumber(&prop);
+        bps_ = (uint32_t)(datarate * 1000);
+
+        if (videoConfigReady_) {
+            videoMeta_.media_param.video = videoParam_;
+        }
+    }
+    AMF_Reset(&obj);
+
+    return 0;
+}
+
+
+int FlvMediaPublisher::HandleVideoData(uint32_t timestamp, char *body, unsigned int len) {
+
+    uint8_t *p = (uint8_t *)body;
+    int frameType, codecId;
+    uint32_t ctsField;
+    int32_t cts;
+    uint8_t *data;
+    size_t size, pos = 0;
+    int ret;
+
+    if (len < 5) {
+        return 0;
+    }
+    frameType = p[0] >> 4;
+    codecId = p[0] & 0x0f;
+    if (codecId != FLV_VIDEO_CODEC_AVC && codecId != FLV_VIDEO_CODEC_HEVC) {
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_DEBUG, "Unsupported video codec %d", codecId);
+        return 0;
+    }
+    if (frameType == FLV_VIDEO_FRAME_INFO) {
+        return 0;
+    }
+
+    hasVideo_ = 1;
+    if (!hasFirstMedia_) {
+        firstMediaTimestamp_ = timestamp;
+        gettimeofday(&baseTime_, NULL);
+        hasFirstMedia_ = 1;
+    }
+
+    /* SI24 composition time offset */
+    ctsField = ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 8) | p[4];
+    if (ctsField & 0x800000) {
+        ctsField |= 0xff000000;
+    }
+    cts = (int32_t)ctsField;
+
+    data = p + 5;
+    size = len - 5;
+
+    if (p[1] == FLV_PACKET_SEQUENCE_HEADER) {
+        std::string extraData;
+        int nalLengthSize;
+        std::string codecName = (codecId == FLV_VIDEO_CODEC_AVC) ? "H264" : "H265";
+
+        ret = ParseVideoConfig(codecId == FLV_VIDEO_CODEC_HEVC, data, size,
+                               &extraData, &nalLengthSize);
+        if (ret) {
+            ROTATE_LOG(logger, stream_switch::LOG_LEVEL_ERR, "Invalid %s sequence header", codecName.c_str());
+            return ret;
+        }
+        if (videoConfigReady_ && nalLengthSize == nalLengthSize_ &&
+            videoMeta_.codec_name == codecName && videoMeta_.extra_data == extraData) {
+            return 0;   /* repeated */
+        }
+        if (metaReady_ && videoIndex_ < 0) {
+            return 0;   /* published without video */
+        }
+
+        videoMeta_.media_type = stream_switch::SUB_STREAM_MEIDA_TYPE_VIDEO;
+        videoMeta_.codec_name = codecName;
+        videoMeta_.direction = stream_switch::SUB_STREAM_DIRECTION_OUTBOUND;
+        videoMeta_.extra_data = extraData;
+        videoMeta_.media_param.video = videoParam_;
+        nalLengthSize_ = nalLengthSize;
+        videoConfigReady_ = 1;
+
+        return UpdateMetadata(timestamp, true);
+
+    } else if (p[1] != FLV_PACKET_NALU) {
+        return 0;   /* end of sequence */
+    }
+
+    ret = UpdateMetadata(timestamp, false);
+    if (ret) {
+        return ret;
+    }
+    if (!metaReady_ || videoIndex_ < 0) {
+        droppedFrames_++;
+        return 0;
+    }
+
+    if (nalLengthSize_ == 4) {
+        /* replace each length prefix by the start code in place */
+        stream_switch::MediaFrameSegment segment((const char *)data, size);
+
+        while (pos < size) {
+            uint32_t nalSize;
+            if (pos + 4 > size) {
+                goto invalid;
+            }
+            nalSize = ((uint32_t)data[pos] << 24) | ((uint32_t)data[pos + 1] << 16) |
+                      ((uint32_t)data[pos + 2] << 8) | data[pos + 3];
+            if (nalSize > size - pos - 4) {
+                goto invalid;
+            }
+            memcpy(data + pos, startCode, 4);
+            pos += 4 + nalSize;
+        }
+
+        return SendFrame(videoIndex_,
+                         frameType == FLV_VIDEO_FRAME_KEY ?
+                             stream_switch::MEDIA_FRAME_TYPE_KEY_FRAME :
+                             stream_switch::MEDIA_FRAME_TYPE_DATA_FRAME,
+                         timestamp, cts, &segment, 1);
+    } else {
+        /* the start codes cannot fit in, refer to the NALUs in the body */
+        segments_.clear();
+        while (pos < size) {
+            uint32_t nalSize = 0;
+            int i;
+            if (pos + nalLengthSize_ > size) {
+                goto invalid;
+            }
+            for (i = 0; i < nalLengthSize_; i++) {
+                nalSize = (nalSize << 8) | data[pos + i];
+            }
+            pos += nalLengthSize_;
+            if (nalSize > size - pos) {
+                goto invalid;
+            }
+            if (nalSize != 0) {
+                segments_.push_back(stream_switch::MediaFrameSegment(startCode, 4));
+                segments_.push_back(stream_switch::MediaFrameSegment((const char *)(data + pos), nalSize));
+            }
+            pos += nalSize;
+        }
+        if (segments_.empty()) {
+            return 0;
+        }
+
+        return SendFrame(videoIndex_,
+                         frameType == FLV_VIDEO_FRAME_KEY ?
+                             stream_switch::MEDIA_FRAME_TYPE_KEY_FRAME :
+                             stream_switch::MEDIA_FRAME_TYPE_DATA_FRAME,
+                         timestamp, cts, &segments_[0], (int)segments_.size());
+    }
+
+invalid:
+    ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING, "Invalid NALU length in video frame, dropped");
+    droppedFrames_++;
+    return -1;
+}
+
+
+int FlvMediaPublisher::HandleAudioData(uint32_t timestamp, char *body, unsigned int len) {
+
+    uint8_t *p = (uint8_t *)body;
+    int soundFormat;
+    stream_switch::MediaFrameSegment segment;
+    int ret;
+
+    if (len < 2) {
+        return 0;
+    }
+    soundFormat = p[0] >> 4;
+    if (soundFormat != FLV_AUDIO_CODEC_AAC &&
+        soundFormat != FLV_AUDIO_CODEC_PCMA &&
+        soundFormat != FLV_AUDIO_CODEC_PCMU) {
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_DEBUG, "Unsupported audio codec %d", soundFormat);
+        return 0;
+    }
+
+    hasAudio_ = 1;
+    if (!hasFirstMedia_) {
+        firstMediaTimestamp_ = timestamp;
+        gettimeofday(&baseTime_, NULL);
+        hasFirstMedia_ = 1;
+    }
+
+    if (soundFormat == FLV_AUDIO_CODEC_AAC) {
+        if (p[1] == FLV_PACKET_SEQUENCE_HEADER) {
+            stream_switch::AudioMediaParam param;
+            std::string extraData(body + 2, len - 2);
+
+            ret = ParseAacConfig(p + 2, len - 2, &param);
+            if (ret) {
+                ROTATE_LOG(logger, stream_switch::LOG_LEVEL_ERR, "Invalid AAC sequence header");
+                return ret;
+            }
+            if (audioConfigReady_ && audioMeta_.codec_name == "AAC" &&
+                audioMeta_.extra_data == extraData) {
+                return 0;   /* repeated */
+            }
+            if (metaReady_ && audioIndex_ < 0) {
+                return 0;   /* published without audio */
+            }
+
+            audioMeta_.media_type = stream_switch::SUB_STREAM_MEIDA_TYPE_AUDIO;
+            audioMeta_.codec_name = "AAC";
+            audioMeta_.direction = stream_switch::SUB_STREAM_DIRECTION_OUTBOUND;
+            audioMeta_.extra_data = extraData;
+            audioMeta_.media_param.audio = param;
+            audioConfigReady_ = 1;
+
+            return UpdateMetadata(timestamp, true);
+        }
+        segment.data = body + 2;
+        segment.size = len - 2;
+    } else {
+        /* G.711 has no sequence header, the first frame makes it ready */
+        if (!audioConfigReady_) {
+            audioMeta_.media_type = stream_switch::SUB_STREAM_MEIDA_TYPE_AUDIO;
+            audioMeta_.codec_name = (soundFormat == FLV_AUDIO_CODEC_PCMA) ? "PCMA" : "PCMU";
+            audioMeta_.direction = stream_switch::SUB_STREAM_DIRECTION_OUTBOUND;
+            audioMeta_.media_param.audio.samples_per_second = 8000;
+            audioMeta_.media_param.audio.channels = (p[0] & 0x01) + 1;
+            audioMeta_.media_param.audio.bits_per_sample = 8;
+            audioConfigReady_ = 1;
+        }
+        segment.data = body + 1;
+        segment.size = len - 1;
+    }
+
+    ret = UpdateMetadata(timestamp, false);
+    if (ret) {
+        return ret;
+    }
+    if (!metaReady_ || audioIndex_ < 0) {
+        droppedFrames_++;
+        return 0;
+    }
+
+    return SendFrame(audioIndex_, stream_switch::MEDIA_FRAME_TYPE_KEY_FRAME,
+                     timestamp, 0, &segment, 1);
+}
+
+
+int FlvMediaPublisher::HandleAggregate(uint32_t timestamp, char *body, unsigned int len) {
+
+    uint8_t *p = (uint8_t *)body;
+    unsigned int pos = 0;
+    uint32_t offset = 0;
+    char first = 1;
+
+    /* a sequence of FLV tags, whose timestamps are relative to the message */
+    while (pos + FLV_TAG_HEADER_SIZE <= len) {
+        int tagType = p[pos] & 0x1f;
+        uint32_t dataSize = ((uint32_t)p[pos + 1] << 16) |
+                            ((uint32_t)p[pos + 2] << 8) | p[pos + 3];
+        uint32_t tagTimestamp = ((uint32_t)p[pos + 7] << 24) |
+                                ((uint32_t)p[pos + 4] << 16) |
+                                ((uint32_t)p[pos + 5] << 8) | p[pos + 6];
+
+        if (dataSize > len - pos - FLV_TAG_HEADER_SIZE) {
+            ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING, "Truncated aggregate message");
+            return -1;
+        }
+        if (first) {
+            offset = timestamp - tagTimestamp;
+            first = 0;
+        }
+
+        if (tagType == FLV_TAG_TYPE_VIDEO) {
+            HandleVideoData(tagTimestamp + offset, body + pos + FLV_TAG_HEADER_SIZE, dataSize);
+        } else if (tagType == FLV_TAG_TYPE_AUDIO) {
+            HandleAudioData(tagTimestamp + offset, body + pos + FLV_TAG_HEADER_SIZE, dataSize);
+        }
+
+        pos += FLV_TAG_HEADER_SIZE + dataSize + FLV_TAG_PREV_SIZE;
+    }
+
+    return 0;
+}
+
+
+// append the NALU with a 2-byte length at data[*pos] to out in Annex-B
+static int AppendConfigNal(const uint8_t *data, unsigned int len,
+                           unsigned int *pos, std::string *out) {
+    unsigned int nalSize;
+
+    if (*pos + 2 > len) {
+        return -1;
+    }
+    nalSize = (data[*pos] << 8) | data[*pos + 1];
+    *pos += 2;
+    if (nalSize > len - *pos) {
+        return -1;
+    }
+    out->append(startCode, 4);
+    out->append((const char *)(data + *pos), nalSize);
+    *pos += nalSize;
+    return 0;
+}
+
+
+int FlvMediaPublisher::ParseVideoConfig(bool isHevc, const uint8_t *data, unsigned int len,
+                                       std::string *extraData, int *nalLengthSize) {
+    unsigned int pos;
+    int i, j;
+
+    extraData->clear();
+    if (len < 1 || data[0] != 1) {
+        return -1;  /* configurationVersion */
+    }
+
+    if (!isHevc) {
+        /* AVCDecoderConfigurationRecord, see 5.2.4.1 of ISO/IEC 14496-15 */
+        int spsNum, ppsNum;
+        if (len < 7) {
+            return -1;
+        }
+        *nalLengthSize = (data[4] & 0x03) + 1;
+        spsNum = data[5] & 0x1f;
+        pos = 6;
+        for (i = 0; i < spsNum; i++) {
+            if (AppendConfigNal(data, len, &pos, extraData)) {
+                return -1;
+            }
+        }
+        if (pos >= len) {
+            return -1;
+        }
+        ppsNum = data[pos++];
+        for (i = 0; i < ppsNum; i++) {
+            if (AppendConfigNal(data, len, &pos, extraData)) {
+                return -1;
+            }
+        }
+    } else {
+        /* HEVCDecoderConfigurationRecord, see 8.3.3.1 of ISO/IEC 14496-15:
+         * 22 bytes of general fields with lengthSizeMinusOne in the last
+         * one, then the arrays of (type, NALU number, NALUs) */
+        int arrayNum, nalNum;
+        if (len < 23) {
+            return -1;
+        }
+        *nalLengthSize = (data[21] & 0x03) + 1;
+        arrayNum = data[22];
+        pos = 23;
+        for (i = 0; i < arrayNum; i++) {
+            if (pos + 3 > len) {
+                return -1;
+            }
+            nalNum = (data[pos + 1] << 8) | data[pos + 2];
+            pos += 3;
+            for (j = 0; j < nalNum; j++) {
+                if (AppendConfigNal(data, len, &pos, extraData)) {
+                    return -1;
+                }
+            }
+        }
+    }
+
+    if (*nalLengthSize == 3) {
+        return -1;  /* reserved */
+    }
+    return 0;
+}
+
+
+int FlvMediaPublisher::ParseAacConfig(const uint8_t *data, unsigned int len,
+                                     stream_switch::AudioMediaParam *param) {
+    int sampleRateIndex, channelConfig;
+
+    /* audioObjectType(5) + samplingFrequencyIndex(4) +
+     * channelConfiguration(4), see 1.6.2.1 of ISO/IEC 14496-3 */
+    if (len < 2) {
+        return -1;
+    }
+    sampleRateIndex = ((data[0] & 0x07) << 1) | (data[1] >> 7);
+    channelConfig = (data[1] >> 3) & 0x0f;
+
+    if (sampleRateIndex == 0x0f) {
+        /* explicit 24-bit sampling frequency */
+        if (len < 5) {
+            return -1;
+        }
+        param->samples_per_second = ((uint32_t)(data[1] & 0x7f) << 17) |
+                                    ((uint32_t)data[2] << 9) |
+                                    ((uint32_t)data[3] << 1) | (data[4] >> 7);
+        channelConfig = (data[4] >> 3) & 0x0f;
+    } else {
+        param->samples_per_second = aacSampleRates[sampleRateIndex];
+    }
+    if (param->samples_per_second == 0) {
+        return -1;
+    }
+    param->channels = channelConfig;
+    param->sampele_per_frame = AAC_SAMPLES_PER_FRAME;
+    return 0;
+}
+
+
+int FlvMediaPublisher::UpdateMetadata(uint32_t timestamp, bool configChanged) {
+
+    stream_switch::StreamMetadata metadata;
+    std::string err_info;
+    int ret;
+
+    if (metaReady_ && !configChanged) {
+        return 0;
+    }
+
+    if (!metaReady_) {
+        if (!videoConfigReady_ && !audioConfigReady_) {
+            return 0;
+        }
+        if ((hasVideo_ && !videoConfigReady_) || (hasAudio_ && !audioConfigReady_)) {
+            if ((int32_t)(timestamp - firstMediaTimestamp_) < RTMP_META_WAIT_TIME) {
+                return 0;
+            }
+            ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING,
+                       "No %s sequence header received, published without it",
+                       videoConfigReady_ ? "audio" : "video");
+        }
+        if (videoConfigReady_) {
+            videoIndex_ = 0;
+        }
+        if (audioConfigReady_) {
+            audioIndex_ = videoConfigReady_ ? 1 : 0;
+        }
+    }
+
+    metadata.play_type = stream_switch::STREAM_PLAY_TYPE_LIVE;
+    metadata.source_proto = "RTMP";
+    metadata.ssrc = ssrc_;
+    metadata.bps = bps_;
+    if (videoIndex_ >= 0) {
+        videoMeta_.sub_stream_index = videoIndex_;
+        metadata.sub_streams.push_back(videoMeta_);
+    }
+    if (audioIndex_ >= 0) {
+        audioMeta_.sub_stream_index = audioIndex_;
+        metadata.sub_streams.push_back(audioMeta_);
+    }
+    source_.set_stream_meta(metadata);
+
+    if (!metaReady_) {
+        ret = source_.Start(&err_info);
+        if (ret) {
+            ROTATE_LOG(logger, stream_switch::LOG_LEVEL_ERR, "Failed to start stream source %s: %s",
+                       streamName_.c_str(), err_info.c_str());
+            return ret;
+        }
+        metaReady_ = 1;
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_INFO, "Stream source %s started with %d sub streams",
+                   streamName_.c_str(), (int)metadata.sub_streams.size());
+    } else {
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_INFO, "Codec config of %s changed, metadata updated",
+                   streamName_.c_str());
+    }
+
+    return 0;
+}
+
+
+void FlvMediaPublisher::FrameTimestamp(uint32_t timestamp, int32_t cts, struct timeval *tv) {
+
+    /* the rtmp timestamp may wrap around, so take the difference as signed */
+    int64_t pts = (int64_t)(int32_t)(timestamp - firstMediaTimestamp_) + cts;
+    int64_t usec = (int64_t)baseTime_.tv_sec * 1000000 + baseTime_.tv_usec + pts * 1000;
+
+    tv->tv_sec = usec / 1000000;
+    tv->tv_usec = usec % 1000000;
+}
+
+
+int FlvMediaPublisher::SendFrame(int subStreamIndex, stream_switch::MediaFrameType frameType,
+                                uint32_t timestamp, int32_t cts,
+                                const stream_switch::MediaFrameSegment *segments,
+                                int segmentNum) {
+
+    stream_switch::MediaFrameInfo frameInfo;
+    std::string err_info;
+    int ret;
+    int i;
+
+    frameInfo.sub_stream_index = subStreamIndex;
+    frameInfo.frame_type = frameType;
+    frameInfo.ssrc = ssrc_;
+    FrameTimestamp(timestamp, cts, &frameInfo.timestamp);
+
+    ret = source_.SendLiveMediaFrameV(frameInfo, segments, segmentNum, &err_info);
+    if (ret) {
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING, "Failed to send frame: %s", err_info.c_str());
+        droppedFrames_++;
+        return ret;
+    }
+
+    frames_++;
+    for (i = 0; i < segmentNum; i++) {
+        bytes_ += segments[i].size;
+    }
+    return 0;
+}
+
+
@@ -0,0 +1,113 @@
+/*
+ * stsw_flv_media_publisher.h
+ *
+ *  Created on: Apr 23, 2016
+ *      Author: OpenSight Team
+ *
+ *  FlvMediaPublisher publishes the FLV tag data of the RTMP audio/video
+ *  messages as a StreamSwitch stream, it's shared by the RTMP client
+ *  (pull) source and the RTMP ingest (push) server
+ */
+
+#ifndef STREAMSWITCH_SOURCES_STSW_RTMP_SOURCE_SRC_STSW_FLV_MEDIA_PUBLISHER_H_
+#define STREAMSWITCH_SOURCES_STSW_RTMP_SOURCE_SRC_STSW_FLV_MEDIA_PUBLISHER_H_
+
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <sys/time.h>
+
+#include <stream_switch.h>
+
+
+// how long (in rtmp timestamp) to wait for the sequence headers of all the
+// announced media since the first media packet, before publishing the
+// metadata with the ready sub streams only
+#define RTMP_META_WAIT_TIME 3000 // in ms
+
+
+class FlvMediaPublisher: public stream_switch::SourceListener
+{
+public:
+    FlvMediaPublisher();
+    virtual ~FlvMediaPublisher();
+
+    int Init(const std::string &stream_name, int source_tcp_port, int queue_size, int debug_flags);
+    void Uninit();
+
+    // the body of the data message carrying onMetaData, either sent by the
+    // server ("onMetaData", obj) or by the publisher ("@setDataFrame",
+    // "onMetaData", obj)
+    int HandleonMetaData(char *body, unsigned int len);
+
+    // the body of the audio/video/aggregate message (FLV tag data), they
+    // may modify the body in place
+    int HandleVideoData(uint32_t timestamp, char *body, unsigned int len);
+    int HandleAudioData(uint32_t timestamp, char *body, unsigned int len);
+    int HandleAggregate(uint32_t timestamp, char *body, unsigned int len);
+
+    void OnKeyFrame(void) {};
+    void OnMediaStatistic(stream_switch::MediaStatisticInfo *statistic) {};
+
+    uint64_t frames() { return frames_; }
+    uint64_t bytes() { return bytes_; }
+    uint64_t droppedFrames() { return droppedFrames_; }
+
+private:
+    // parse AVCDecoderConfigurationRecord/HEVCDecoderConfigurationRecord
+    // into the Annex-B extra data, and get the NALU length size
+    int ParseVideoConfig(bool isHevc, const uint8_t *data, unsigned int len,
+                         std::string *extraData, int *nalLengthSize);
+    // parse AudioSpecificConfig into the audio parameters
+    int ParseAacConfig(const uint8_t *data, unsigned int len,
+                       stream_switch::AudioMediaParam *param);
+
+    // publish the metadata and start the source once the sub streams are
+    // ready, or update the metadata if the codec config changed after that
+    int UpdateMetadata(uint32_t timestamp, bool configChanged);
+
+    void FrameTimestamp(uint32_t timestamp, int32_t cts, struct timeval *tv);
+    int SendFrame(int subStreamIndex, stream_switch::MediaFrameType frameType,
+                  uint32_t timestamp, int32_t cts,
+                  const stream_switch::MediaFrameSegment *segments,
+                  int segmentNum);
+
+    char metaReady_;
+    stream_switch::StreamSource source_;
+    std::string streamName_;
+
+    // media info announced by onMetaData
+    char hasVideo_;
+    char hasAudio_;
+    uint32_t bps_;
+    stream_switch::VideoMediaParam videoParam_;
+
+    // sub streams got from the media packets, the index is -1 until
+    // the metadata is published with it
+    stream_switch::SubStreamMetadata videoMeta_;
+    stream_switch::SubStreamMetadata audioMeta_;
+    char videoConfigReady_;
+    char audioConfigReady_;
+    int videoIndex_;
+    int audioIndex_;
+    int nalLengthSize_;
+    uint32_t ssrc_;
+
+    uint32_t firstMediaTimestamp_;
+    char hasFirstMedia_;
+    struct timeval baseTime_;
+
+    // reused for the frames whose NALU length is not 4 bytes, which are
+    // sent as (start code, NALU) segments without copying
+    std::vector<stream_switch::MediaFrameSegment> segments_;
+
+    // throughput counters
+    uint64_t frames_;
+    uint64_t bytes_;
+    uint64_t droppedFrames_;
+};
+
+
+
+#endif /* STREAMSWITCH_SOURCES_STSW_RTMP_SOURCE_SRC_STSW_FLV_MEDIA_PUBLISHER_H_ */
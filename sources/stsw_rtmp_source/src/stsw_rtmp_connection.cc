@@ -0,0 +1,775 @@
+/*
+ * stsw_rtmp_connection.cc
+ *
+ *  Created on: Apr 23, 2016
+ *      Author: OpenSight Team
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <stream_switch.h>
+
+#include "stsw_rtmp_connection.h"
+#include "stsw_rtmp_ingest_server.h"
+
+
+extern stream_switch::RotateLogger * logger;
+
+#define SAVC(x) static const AVal av_##x = AVC(#x)
+
+// message types, see 5.4 and 7.1 of "Adobe's Real Time Messaging Protocol"
+#define RTMP_MSG_SET_CHUNK_SIZE  1
+#define RTMP_MSG_ABORT  2
+#define RTMP_MSG_ACK  3
+#define RTMP_MSG_USER_CONTROL  4
+#define RTMP_MSG_WINDOW_ACK_SIZE  5
+#define RTMP_MSG_SET_PEER_BANDWIDTH  6
+#define RTMP_MSG_AUDIO  8
+#define RTMP_MSG_VIDEO  9
+#define RTMP_MSG_AMF3_DATA  15
+#define RTMP_MSG_AMF3_COMMAND  17
+#define RTMP_MSG_AMF0_DATA  18
+#define RTMP_MSG_AMF0_COMMAND  20
+#define RTMP_MSG_AGGREGATE  22
+
+#define RTMP_USER_STREAM_BEGIN  0
+#define RTMP_USER_PING_REQUEST  6
+#define RTMP_USER_PING_RESPONSE  7
+
+#define RTMP_CSID_CONTROL  2
+#define RTMP_CSID_COMMAND  3
+#define RTMP_CSID_STATUS  5
+
+SAVC(connect);
+SAVC(createStream);
+SAVC(publish);
+SAVC(releaseStream);
+SAVC(FCPublish);
+SAVC(FCUnpublish);
+SAVC(deleteStream);
+SAVC(closeStream);
+SAVC(app);
+SAVC(_result);
+SAVC(onStatus);
+SAVC(fmsVer);
+SAVC(capabilities);
+SAVC(level);
+SAVC(code);
+SAVC(description);
+SAVC(objectEncoding);
+static const AVal av_fmsVersion = AVC("FMS/3,0,1,123");
+
+
+static inline uint32_t ReadBe16(const uint8_t *p) {
+    return ((uint32_t)p[0] << 8) | p[1];
+}
+
+static inline uint32_t ReadBe24(const uint8_t *p) {
+    return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+}
+
+static inline uint32_t ReadBe32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline uint32_t ReadLe32(const uint8_t *p) {
+    return ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[1] << 8) | p[0];
+}
+
+static inline char *WriteBe32(char *p, uint32_t value) {
+    p[0] = (char)(value >> 24);
+    p[1] = (char)(value >> 16);
+    p[2] = (char)(value >> 8);
+    p[3] = (char)value;
+    return p + 4;
+}
+
+static inline char *EncodeObjectEnd(char *p) {
+    p[0] = 0;
+    p[1] = 0;
+    p[2] = AMF_OBJECT_END;
+    return p + 3;
+}
+
+static inline char *EncodeNamedCString(char *p, char *end, const AVal *name, const char *value) {
+    AVal av;
+    av.av_val = (char *)value;
+    av.av_len = (int)strlen(value);
+    return AMF_EncodeNamedString(p, end, name, &av);
+}
+
+
+RtmpConnection::RtmpConnection(RtmpIngestLoop *loop, int fd, const std::string &peer)
+    :loop_(loop),
+     fd_(fd),
+     peer_(peer),
+     state_(STATE_WAIT_C0C1),
+     lastActive_(time(NULL)),
+     inBuf_(RTMP_READ_SIZE * 2),
+     inStart_(0),
+     inEnd_(0),
+     outPos_(0),
+     writeWatched_(0),
+     inChunkSize_(RTMP_DEFAULT_CHUNK_SIZE),
+     outChunkSize_(RTMP_DEFAULT_CHUNK_SIZE),
+     ackWindow_(RTMP_WINDOW_ACK_SIZE),
+     inBytes_(0),
+     lastAckBytes_(0),
+     publisher_(NULL),
+     publishTime_(0)
+{
+}
+
+
+RtmpConnection::~RtmpConnection() {
+
+    ChunkStreamMap::iterator it;
+
+    Unpublish();
+
+    for (it = chunkStreams_.begin(); it != chunkStreams_.end(); it++) {
+        if (it->second.body) {
+            loop_->pool()->Put(it->second.body);
+            it->second.body = NULL;
+        }
+    }
+    chunkStreams_.clear();
+
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+    ROTATE_LOG(logger, stream_switch::LOG_LEVEL_INFO, "Connection from %s closed", peer_.c_str());
+}
+
+
+int RtmpConnection::OnReadable() {
+
+    ssize_t n;
+    int ret;
+
+    lastActive_ = time(NULL);
+
+    /* make room for a read, the unparsed data is moved to the front */
+    if (inBuf_.size() - inEnd_ < RTMP_READ_SIZE) {
+        if (inStart_ > 0) {
+            memmove(&inBuf_[0], &inBuf_[inStart_], inEnd_ - inStart_);
+            inEnd_ -= inStart_;
+            inStart_ = 0;
+        }
+        if (inBuf_.size() - inEnd_ < RTMP_READ_SIZE) {
+            inBuf_.resize(inEnd_ + RTMP_READ_SIZE);
+        }
+    }
+
+    n = recv(fd_, &inBuf_[inEnd_], inBuf_.size() - inEnd_, 0);
+    if (n == 0) {
+        return -1;  /* closed by the peer */
+    } else if (n < 0) {
+        if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING, "recv from %s failed: %s",
+                   peer_.c_str(), strerror(errno));
+        return -1;
+    }
+    inEnd_ += n;
+    inBytes_ += n;
+
+    while (state_ != STATE_CLOSING && inStart_ < inEnd_) {
+        uint8_t *data = (uint8_t *)&inBuf_[inStart_];
+        size_t size = inEnd_ - inStart_;
+
+        if (state_ == STATE_CONNECTED) {
+            ret = ParseChunk(data, size);
+        } else {
+            ret = ParseHandshake(data, size);
+        }
+        if (ret < 0) {
+            return -1;
+        } else if (ret == 0) {
+            break;      /* wait for more data */
+        }
+        inStart_ += ret;
+    }
+    if (inStart_ == inEnd_) {
+        inStart_ = inEnd_ = 0;
+    }
+
+    if (ackWindow_ != 0 && inBytes_ - lastAckBytes_ >= ackWindow_) {
+        SendControl(RTMP_MSG_ACK, (uint32_t)inBytes_);
+        lastAckBytes_ = inBytes_;
+    }
+
+    return Flush();
+}
+
+
+int RtmpConnection::OnWritable() {
+
+    return Flush();
+}
+
+
+int RtmpConnection::ParseHandshake(const uint8_t *data, size_t size) {
+
+    if (state_ == STATE_WAIT_C0C1) {
+        char s1[RTMP_HANDSHAKE_SIZE];
+        unsigned int seed = (unsigned int)lastActive_ + (unsigned int)fd_;
+        int i;
+
+        if (size < 1 + RTMP_HANDSHAKE_SIZE) {
+            return 0;
+        }
+        if (data[0] != 3) {
+            ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING,
+                       "Unsupported RTMP version %d from %s", (int)data[0], peer_.c_str());
+            return -1;
+        }
+
+        /* the simple handshake: S0, S1 (time, zero, random), S2 (echo of C1) */
+        memset(s1, 0, 8);
+        for (i = 8; i < RTMP_HANDSHAKE_SIZE; i++) {
+            s1[i] = (char)rand_r(&seed);
+        }
+        outBuf_.push_back(3);
+        outBuf_.append(s1, RTMP_HANDSHAKE_SIZE);
+        outBuf_.append((const char *)(data + 1), RTMP_HANDSHAKE_SIZE);
+
+        state_ = STATE_WAIT_C2;
+        return 1 + RTMP_HANDSHAKE_SIZE;
+    }
+
+    if (size < RTMP_HANDSHAKE_SIZE) {
+        return 0;
+    }
+    state_ = STATE_CONNECTED;
+    return RTMP_HANDSHAKE_SIZE;
+}
+
+
+int RtmpConnection::ParseChunk(uint8_t *data, size_t size) {
+
+    static const size_t headerSizes[4] = {11, 7, 3, 0};
+    ChunkStreamMap::iterator it;
+    ChunkStream *cs;
+    size_t pos = 1;
+    size_t chunkSize;
+    uint32_t csid, tsField = 0, extTimestamp = 0;
+    uint32_t length, streamId, bytesRead;
+    uint8_t fmt, type;
+    char extended;
+    int ret = 0;
+
+    /* basic header */
+    fmt = data[0] >> 6;
+    csid = data[0] & 0x3f;
+    if (csid == 0) {
+        if (size < 2) {
+            return 0;
+        }
+        csid = 64 + data[1];
+        pos = 2;
+    } else if (csid == 1) {
+        if (size < 3) {
+            return 0;
+        }
+        csid = 64 + data[1] + ((uint32_t)data[2] << 8);
+        pos = 3;
+    }
+    if (size < pos + headerSizes[fmt]) {
+        return 0;
+    }
+
+    it = chunkStreams_.find(csid);
+    if (it == chunkStreams_.end()) {
+        if (chunkStreams_.size() >= RTMP_MAX_CHUNK_STREAMS) {
+            ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING,
+                       "Too many chunk streams from %s", peer_.c_str());
+            return -1;
+        }
+        it = chunkStreams_.insert(std::make_pair(csid, ChunkStream())).first;
+    }
+    cs = &it->second;
+    if (fmt == 3 && !cs->hasHeader) {
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING,
+                   "Chunk stream %u from %s begins without header", csid, peer_.c_str());
+        return -1;
+    }
+
+    /* message header, the absent fields are the same as the last chunk */
+    length = cs->length;
+    type = cs->type;
+    streamId = cs->streamId;
+    if (fmt <= 2) {
+        tsField = ReadBe24(data + pos);
+    }
+    if (fmt <= 1) {
+        length = ReadBe24(data + pos + 3);
+        type = data[pos + 6];
+    }
+    if (fmt == 0) {
+        streamId = ReadLe32(data + pos + 7);
+    }
+    pos += headerSizes[fmt];
+
+    extended = (fmt <= 2) ? (tsField == 0xffffff) : cs->extended;
+    if (extended) {
+        if (size < pos + 4) {
+            return 0;
+        }
+        extTimestamp = ReadBe32(data + pos);
+        pos += 4;
+    }
+
+    if (length > RTMP_MAX_MESSAGE_SIZE) {
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING,
+                   "Message of %u bytes from %s is too large", length, peer_.c_str());
+        return -1;
+    }
+    bytesRead = (fmt == 3 && cs->body) ? (uint32_t)cs->body->size() : 0;
+    chunkSize = length - bytesRead;
+    if (chunkSize > inChunkSize_) {
+        chunkSize = inChunkSize_;
+    }
+    if (size < pos + chunkSize) {
+        return 0;
+    }
+
+    /* the whole chunk is available, commit the header */
+    if (fmt != 3 && cs->body) {
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING,
+                   "Incomplete message on chunk stream %u from %s dropped", csid, peer_.c_str());
+        loop_->pool()->Put(cs->body);
+        cs->body = NULL;
+    }
+    if (!cs->body) {
+        /* the first chunk of a message */
+        uint32_t timestamp = extended ? extTimestamp : tsField;
+        if (fmt == 0) {
+            cs->timestamp = timestamp;
+            cs->timestampDelta = 0;
+        } else if (fmt <= 2) {
+            cs->timestampDelta = timestamp;
+            cs->timestamp += timestamp;
+        } else {
+            cs->timestamp += cs->timestampDelta;
+        }
+    }
+    cs->length = length;
+    cs->type = type;
+    cs->streamId = streamId;
+    cs->extended = extended;
+    cs->hasHeader = 1;
+
+    if (!cs->body && chunkSize == length) {
+        /* the whole message in one chunk, no reassembly */
+        ret = HandleMessage(cs, (char *)(data + pos), length);
+    } else {
+        if (!cs->body) {
+            cs->body = loop_->pool()->Get(length);
+        }
+        cs->body->append((const char *)(data + pos), chunkSize);
+        if (cs->body->size() == length) {
+            std::string *body = cs->body;
+            cs->body = NULL;
+            ret = HandleMessage(cs, &(*body)[0], length);
+            loop_->pool()->Put(body);
+        }
+    }
+    if (ret) {
+        return -1;
+    }
+
+    return (int)(pos + chunkSize);
+}
+
+
+int RtmpConnection::HandleMessage(ChunkStream *cs, char *body, uint32_t len) {
+
+    const uint8_t *p = (const uint8_t *)body;
+
+    switch (cs->type) {
+    case RTMP_MSG_SET_CHUNK_SIZE:
+        if (len >= 4) {
+            uint32_t chunkSize = ReadBe32(p) & 0x7fffffff;
+            if (chunkSize == 0 || chunkSize > RTMP_MAX_IN_CHUNK_SIZE) {
+                ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING,
+                           "Invalid chunk size %u from %s", chunkSize, peer_.c_str());
+                return -1;
+            }
+            inChunkSize_ = chunkSize;
+        }
+        break;
+
+    case RTMP_MSG_ABORT:
+        if (len >= 4) {
+            ChunkStreamMap::iterator it = chunkStreams_.find(ReadBe32(p));
+            if (it != chunkStreams_.end() && it->second.body) {
+                loop_->pool()->Put(it->second.body);
+                it->second.body = NULL;
+            }
+        }
+        break;
+
+    case RTMP_MSG_USER_CONTROL:
+        if (len >= 6 && ReadBe16(p) == RTMP_USER_PING_REQUEST) {
+            SendUserControl(RTMP_USER_PING_RESPONSE, ReadBe32(p + 2));
+        }
+        break;
+
+    case RTMP_MSG_WINDOW_ACK_SIZE:
+        if (len >= 4) {
+            ackWindow_ = ReadBe32(p);
+        }
+        break;
+
+    case RTMP_MSG_AUDIO:
+        if (publisher_) {
+            publisher_->HandleAudioData(cs->timestamp, body, len);
+        }
+        break;
+
+    case RTMP_MSG_VIDEO:
+        if (publisher_) {
+            publisher_->HandleVideoData(cs->timestamp, body, len);
+        }
+        break;
+
+    case RTMP_MSG_AGGREGATE:
+        if (publisher_) {
+            publisher_->HandleAggregate(cs->timestamp, body, len);
+        }
+        break;
+
+    case RTMP_MSG_AMF3_DATA:
+    case RTMP_MSG_AMF0_DATA:
+        /* @setDataFrame, AMF3 one has a format byte ahead */
+        if (cs->type == RTMP_MSG_AMF3_DATA && len > 0) {
+            body++;
+            len--;
+        }
+        if (publisher_ && len > 0) {
+            publisher_->HandleonMetaData(body, len);
+        }
+        break;
+
+    case RTMP_MSG_AMF3_COMMAND:
+    case RTMP_MSG_AMF0_COMMAND:
+        if (cs->type == RTMP_MSG_AMF3_COMMAND && len > 0) {
+            body++;
+            len--;
+        }
+        if (len > 0) {
+            return HandleCommand(body, len);
+        }
+        break;
+
+    default:
+        /* ack, set peer bandwidth, etc. are not cared */
+        break;
+    }
+
+    return 0;
+}
+
+
+int RtmpConnection::HandleCommand(char *body, unsigned int len) {
+
+    AMFObject obj;
+    AVal method;
+    double txn;
+    int ret = 0;
+
+    if (AMF_Decode(&obj, body, len, FALSE) < 0) {
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING,
+                   "Invalid command from %s", peer_.c_str());
+        return -1;
+    }
+    AMFProp_GetString(AMF_GetProp(&obj, NULL, 0), &method);
+    txn = AMFProp_GetNumber(AMF_GetProp(&obj, NULL, 1));
+
+    ROTATE_LOG(logger, stream_switch::LOG_LEVEL_DEBUG, "Command %.*s from %s",
+               method.av_len, method.av_val, peer_.c_str());
+
+    if (AVMATCH(&method, &av_connect)) {
+        ret = OnConnect(txn, &obj);
+
+    } else if (AVMATCH(&method, &av_createStream)) {
+        char args[16];
+        char *p = args;
+        *p++ = AMF_NULL;
+        p = AMF_EncodeNumber(p, args + sizeof(args), RTMP_PUBLISH_STREAM_ID);
+        SendResult(txn, args, p - args);
+
+    } else if (AVMATCH(&method, &av_publish)) {
+        ret = OnPublish(txn, &obj);
+
+    } else if (AVMATCH(&method, &av_deleteStream) ||
+               AVMATCH(&method, &av_closeStream) ||
+               AVMATCH(&method, &av_FCUnpublish)) {
+        Unpublish();
+
+    } else if (AVMATCH(&method, &av_releaseStream) ||
+               AVMATCH(&method, &av_FCPublish)) {
+        if (txn != 0) {
+            char args[1] = {AMF_NULL};
+            SendResult(txn, args, 1);
+        }
+    }
+
+    AMF_Reset(&obj);
+    return ret;
+}
+
+
+int RtmpConnection::OnConnect(double txn, AMFObject *obj) {
+
+    AMFObjectProperty *prop = AMF_GetProp(obj, NULL, 2);
+    char args[512];
+    char *end = args + sizeof(args);
+    char *p = args;
+    char bandwidth[5];
+
+    if (AMFProp_GetType(prop) == AMF_OBJECT) {
+        AMFObject cmdObj;
+        AVal app;
+        AMFProp_GetObject(prop, &cmdObj);
+        AMFProp_GetString(AMF_GetProp(&cmdObj, &av_app, -1), &app);
+        if (app.av_len > 0) {
+            app_.assign(app.av_val, app.av_len);
+        }
+    }
+
+    SendControl(RTMP_MSG_WINDOW_ACK_SIZE, RTMP_WINDOW_ACK_SIZE);
+    WriteBe32(bandwidth, RTMP_WINDOW_ACK_SIZE);
+    bandwidth[4] = 2;   /* dynamic */
+    SendMessage(RTMP_CSID_CONTROL, RTMP_MSG_SET_PEER_BANDWIDTH, 0, 0, bandwidth, sizeof(bandwidth));
+    SendControl(RTMP_MSG_SET_CHUNK_SIZE, RTMP_OUT_CHUNK_SIZE);
+    outChunkSize_ = RTMP_OUT_CHUNK_SIZE;
+
+    /* properties, information */
+    *p++ = AMF_OBJECT;
+    p = AMF_EncodeNamedString(p, end, &av_fmsVer, &av_fmsVersion);
+    p = AMF_EncodeNamedNumber(p, end, &av_capabilities, 31.0);
+    p = EncodeObjectEnd(p);
+    *p++ = AMF_OBJECT;
+    p = EncodeNamedCString(p, end, &av_level, "status");
+    p = EncodeNamedCString(p, end, &av_code, "NetConnection.Connect.Success");
+    p = EncodeNamedCString(p, end, &av_description, "Connection succeeded.");
+    p = AMF_EncodeNamedNumber(p, end, &av_objectEncoding, 0.0);
+    p = EncodeObjectEnd(p);
+    SendResult(txn, args, p - args);
+
+    ROTATE_LOG(logger, stream_switch::LOG_LEVEL_DEBUG, "%s connected to app %s",
+               peer_.c_str(), app_.c_str());
+    return 0;
+}
+
+
+int RtmpConnection::OnPublish(double txn, AMFObject *obj) {
+
+    RtmpIngestServer *server = loop_->server();
+    AVal name;
+    std::string streamName;
+
+    if (publisher_) {
+        SendStatus("error", "NetStream.Publish.BadName", "Already publishing");
+        return 0;
+    }
+
+    AMFProp_GetString(AMF_GetProp(obj, NULL, 3), &name);
+    if (name.av_len > 0) {
+        streamName = server->StreamName(app_, std::string(name.av_val, name.av_len));
+    }
+    if (streamName.empty() || streamName.size() >= 64) {
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING,
+                   "Invalid stream name to publish from %s", peer_.c_str());
+        SendStatus("error", "NetStream.Publish.BadName", "Invalid stream name");
+        state_ = STATE_CLOSING;
+        return 0;
+    }
+
+    if (!server->AcquireStream(streamName)) {
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING,
+                   "Stream %s from %s is being published by another one",
+                   streamName.c_str(), peer_.c_str());
+        SendStatus("error", "NetStream.Publish.BadName", "Stream already publishing");
+        state_ = STATE_CLOSING;
+        return 0;
+    }
+
+    publisher_ = new FlvMediaPublisher();
+    if (publisher_->Init(streamName, 0, server->queueSize(), server->debugFlags())) {
+        delete publisher_;
+        publisher_ = NULL;
+        server->ReleaseStream(streamName);
+        SendStatus("error", "NetStream.Publish.BadName", "Failed to create the stream");
+        state_ = STATE_CLOSING;
+        return 0;
+    }
+    streamName_ = streamName;
+    publishTime_ = time(NULL);
+
+    SendUserControl(RTMP_USER_STREAM_BEGIN, RTMP_PUBLISH_STREAM_ID);
+    SendStatus("status", "NetStream.Publish.Start", "Start publishing");
+
+    ROTATE_LOG(logger, stream_switch::LOG_LEVEL_INFO, "%s starts publishing %s",
+               peer_.c_str(), streamName_.c_str());
+    return 0;
+}
+
+
+void RtmpConnection::Unpublish() {
+
+    time_t elapsed;
+
+    if (!publisher_) {
+        return;
+    }
+
+    elapsed = time(NULL) - publishTime_;
+    if (elapsed <= 0) {
+        elapsed = 1;
+    }
+    ROTATE_LOG(logger, stream_switch::LOG_LEVEL_INFO,
+               "%s stops publishing %s: %llu frames (%llu dropped), %llu bytes "
+               "in %d s, %.1f kbps",
+               peer_.c_str(), streamName_.c_str(),
+               (unsigned long long)publisher_->frames(),
+               (unsigned long long)publisher_->droppedFrames(),
+               (unsigned long long)publisher_->bytes(), (int)elapsed,
+               publisher_->bytes() * 8.0 / elapsed / 1000);
+
+    publisher_->Uninit();
+    delete publisher_;
+    publisher_ = NULL;
+    loop_->server()->ReleaseStream(streamName_);
+    streamName_.clear();
+}
+
+
+void RtmpConnection::SendMessage(uint32_t csid, uint8_t type, uint32_t streamId,
+                                 uint32_t timestamp, const char *payload, size_t len) {
+    char header[12];
+    size_t pos = 0;
+
+    /* type 0 header for the first chunk, type 3 for the others, the
+     * csid is always less than 64 here */
+    header[0] = (char)(csid & 0x3f);
+    header[1] = (char)(timestamp >> 16);
+    header[2] = (char)(timestamp >> 8);
+    header[3] = (char)timestamp;
+    header[4] = (char)(len >> 16);
+    header[5] = (char)(len >> 8);
+    header[6] = (char)len;
+    header[7] = (char)type;
+    header[8] = (char)streamId;
+    header[9] = (char)(streamId >> 8);
+    header[10] = (char)(streamId >> 16);
+    header[11] = (char)(streamId >> 24);
+    outBuf_.append(header, sizeof(header));
+
+    while (1) {
+        size_t n = len - pos;
+        if (n > outChunkSize_) {
+            n = outChunkSize_;
+        }
+        outBuf_.append(payload + pos, n);
+        pos += n;
+        if (pos >= len) {
+            break;
+        }
+        outBuf_.push_back((char)(0xc0 | (csid & 0x3f)));
+    }
+}
+
+
+void RtmpConnection::SendControl(uint8_t type, uint32_t value) {
+
+    char payload[4];
+
+    WriteBe32(payload, value);
+    SendMessage(RTMP_CSID_CONTROL, type, 0, 0, payload, sizeof(payload));
+}
+
+
+void RtmpConnection::SendUserControl(uint16_t event, uint32_t value) {
+
+    char payload[6];
+
+    payload[0] = (char)(event >> 8);
+    payload[1] = (char)event;
+    WriteBe32(payload + 2, value);
+    SendMessage(RTMP_CSID_CONTROL, RTMP_MSG_USER_CONTROL, 0, 0, payload, sizeof(payload));
+}
+
+
+void RtmpConnection::SendResult(double txn, const char *args, size_t argsLen) {
+
+    char buf[1024];
+    char *end = buf + sizeof(buf);
+    char *p = buf;
+
+    if (argsLen > sizeof(buf) - 16) {
+        return;
+    }
+    p = AMF_EncodeString(p, end, &av__result);
+    p = AMF_EncodeNumber(p, end, txn);
+    memcpy(p, args, argsLen);
+    p += argsLen;
+    SendMessage(RTMP_CSID_COMMAND, RTMP_MSG_AMF0_COMMAND, 0, 0, buf, p - buf);
+}
+
+
+void RtmpConnection::SendStatus(const char *level, const char *code, const char *description) {
+
+    char buf[512];
+    char *end = buf + sizeof(buf);
+    char *p = buf;
+
+    p = AMF_EncodeString(p, end, &av_onStatus);
+    p = AMF_EncodeNumber(p, end, 0.0);
+    *p++ = AMF_NULL;
+    *p++ = AMF_OBJECT;
+    p = EncodeNamedCString(p, end, &av_level, level);
+    p = EncodeNamedCString(p, end, &av_code, code);
+    p = EncodeNamedCString(p, end, &av_description, description);
+    p = EncodeObjectEnd(p);
+    SendMessage(RTMP_CSID_STATUS, RTMP_MSG_AMF0_COMMAND, RTMP_PUBLISH_STREAM_ID, 0, buf, p - buf);
+}
+
+
+int RtmpConnection::Flush() {
+
+    ssize_t n;
+
+    while (outPos_ < outBuf_.size()) {
+        n = send(fd_, outBuf_.data() + outPos_, outBuf_.size() - outPos_, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;   /* wait for writable */
+            }
+            ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING, "send to %s failed: %s",
+                       peer_.c_str(), strerror(errno));
+            return -1;
+        }
+        outPos_ += n;
+    }
+    outBuf_.clear();
+    outPos_ = 0;
+
+    if (state_ == STATE_CLOSING) {
+        return -1;  /* all the pending output sent */
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * stsw_rtmp_connection.h
+ *
+ *  Created on: Apr 23, 2016
+ *      Author: OpenSight Team
+ *
+ *  RtmpConnection is the server side of one RTMP publisher connection in
+ *  the ingest server. It's driven by the readiness events of its event
+ *  loop, so the handshake, the chunk stream demux and the commands never
+ *  block the other connections of the same loop
+ */
+
+#ifndef STREAMSWITCH_SOURCES_STSW_RTMP_SOURCE_SRC_STSW_RTMP_CONNECTION_H_
+#define STREAMSWITCH_SOURCES_STSW_RTMP_SOURCE_SRC_STSW_RTMP_CONNECTION_H_
+
+
+#include <stdint.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#include <librtmp/amf.h>
+
+#include "stsw_flv_media_publisher.h"
+
+
+#define RTMP_HANDSHAKE_SIZE  1536
+#define RTMP_DEFAULT_CHUNK_SIZE  128
+#define RTMP_OUT_CHUNK_SIZE  4096
+#define RTMP_WINDOW_ACK_SIZE  2500000
+#define RTMP_MAX_MESSAGE_SIZE  (8 * 1024 * 1024)
+#define RTMP_MAX_IN_CHUNK_SIZE  (1024 * 1024)
+#define RTMP_MAX_CHUNK_STREAMS  64
+#define RTMP_READ_SIZE  65536
+#define RTMP_PUBLISH_STREAM_ID  1
+
+
+class RtmpIngestLoop;
+
+class RtmpConnection
+{
+public:
+    RtmpConnection(RtmpIngestLoop *loop, int fd, const std::string &peer);
+    virtual ~RtmpConnection();
+
+    int fd() { return fd_; }
+    time_t lastActive() { return lastActive_; }
+    bool WantWrite() { return outPos_ < outBuf_.size(); }
+
+    // whether the writable event is being watched, maintained by the loop
+    bool writeWatched() { return writeWatched_ != 0; }
+    void set_writeWatched(bool watched) { writeWatched_ = watched ? 1 : 0; }
+
+    // read all the available data and process it, return -1 if the
+    // connection should be closed
+    int OnReadable();
+    // send the pending output, return -1 if the connection should be closed
+    int OnWritable();
+
+private:
+    enum State {
+        STATE_WAIT_C0C1 = 0,
+        STATE_WAIT_C2,
+        STATE_CONNECTED,
+        STATE_CLOSING,      // close once the pending output is sent
+    };
+
+    // state of an inbound chunk stream, body is the message being
+    // reassembled, which is taken from the buffer pool of the loop
+    struct ChunkStream {
+        uint32_t timestamp;
+        uint32_t timestampDelta;
+        uint32_t length;
+        uint8_t type;
+        uint32_t streamId;
+        char extended;
+        char hasHeader;
+        std::string *body;
+
+        ChunkStream()
+        :timestamp(0), timestampDelta(0), length(0), type(0),
+         streamId(0), extended(0), hasHeader(0), body(NULL)
+        {
+        }
+    };
+    typedef std::map<uint32_t, ChunkStream> ChunkStreamMap;
+
+    // parse the handshake or chunks in inBuf_, return the consumed size
+    // (0 if more data is needed), or -1 on error
+    int ParseHandshake(const uint8_t *data, size_t size);
+    int ParseChunk(uint8_t *data, size_t size);
+
+    // handle a complete message, whose body is either in the input
+    // buffer (the message in one chunk) or the reassembly buffer, the
+    // media data is converted in place there
+    int HandleMessage(ChunkStream *cs, char *body, uint32_t len);
+    int HandleCommand(char *body, unsigned int len);
+    int OnConnect(double txn, AMFObject *obj);
+    int OnPublish(double txn, AMFObject *obj);
+    void Unpublish();
+
+    void SendMessage(uint32_t csid, uint8_t type, uint32_t streamId,
+                     uint32_t timestamp, const char *payload, size_t len);
+    void SendControl(uint8_t type, uint32_t value);
+    void SendUserControl(uint16_t event, uint32_t value);
+    // _result of the command with the encoded values after the transaction id
+    void SendResult(double txn, const char *args, size_t argsLen);
+    void SendStatus(const char *level, const char *code, const char *description);
+    int Flush();
+
+    RtmpIngestLoop *loop_;
+    int fd_;
+    std::string peer_;
+    State state_;
+    time_t lastActive_;
+
+    std::vector<char> inBuf_;
+    size_t inStart_;
+    size_t inEnd_;
+    std::string outBuf_;
+    size_t outPos_;
+    char writeWatched_;
+
+    ChunkStreamMap chunkStreams_;
+    uint32_t inChunkSize_;
+    uint32_t outChunkSize_;
+    uint32_t ackWindow_;
+    uint64_t inBytes_;
+    uint64_t lastAckBytes_;
+
+    std::string app_;
+    std::string streamName_;
+    FlvMediaPublisher *publisher_;
+    time_t publishTime_;
+};
+
+
+
+#endif /* STREAMSWITCH_SOURCES_STSW_RTMP_SOURCE_SRC_STSW_RTMP_CONNECTION_H_ */
@@ -0,0 +1,208 @@
+/*
+ * stsw_rtmp_ingest_main.cc
+ *
+ *  Created on: Apr 23, 2016
+ *      Author: OpenSight Team
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <stream_switch.h>
+#include <librtmp/log.h>
+
+#include "stsw_rtmp_ingest_server.h"
+
+stream_switch::RotateLogger * logger = NULL;
+
+
+static int DefaultLoopNum()
+{
+    long cpu_num = sysconf(_SC_NPROCESSORS_ONLN);
+    if(cpu_num <= 0){
+        return 1;
+    }else if(cpu_num > RTMP_INGEST_MAX_LOOPS){
+        return RTMP_INGEST_MAX_LOOPS;
+    }
+    return (int)cpu_num;
+}
+
+
+void ParseArgv(int argc, char *argv[],
+               stream_switch::ArgParser *parser)
+{
+    int ret = 0;
+    std::string err_info;
+    parser->RegisterBasicOptions();
+    parser->RegisterSourceOptions();
+
+    // the streams are named by the publishers, and the port is for RTMP
+    parser->UnregisterOption("stream-name");
+    parser->UnregisterOption("url");
+    parser->UnregisterOption("port");
+    parser->RegisterOption("port", 'p', OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG,
+                    "PORT",
+                    "the RTMP port to listen on. Default is 1935", NULL, NULL);
+
+    parser->RegisterOption("loops", 'n', OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG,
+                    "NUM",
+                    "the number of the event loop threads serving the connections. "
+                    "Default is the number of CPUs", NULL, NULL);
+
+    parser->RegisterOption("pin-cpu", 0, 0, NULL,
+                    "pin each event loop thread on a CPU", NULL, NULL);
+
+    parser->RegisterOption("max-conns", 0, OPTION_FLAG_WITH_ARG | OPTION_FLAG_LONG,
+                    "NUM",
+                    "the max number of the RTMP connections, 0 means no limit. "
+                    "Default is 0", NULL, NULL);
+
+    parser->RegisterOption("name-with-app", 0, 0, NULL,
+                    "name the stream as <app>_<stream key> instead of <stream key>",
+                    NULL, NULL);
+
+    parser->RegisterOption("debug-flags", 'd',
+                    OPTION_FLAG_LONG | OPTION_FLAG_WITH_ARG,  "FLAG",
+                    "debug flag for stream_switch core library. "
+                    "Default is 0, means no debug dump" ,
+                    NULL, NULL);
+
+    ret = parser->Parse(argc, argv, &err_info);//parse the cmd args
+    if(ret){
+        fprintf(stderr, "Option Parsing Error:%s\n", err_info.c_str());
+        exit(-1);
+    }
+
+    //check options correct
+
+    if(parser->CheckOption("help")){
+        std::string option_help;
+        option_help = parser->GetOptionsHelp();
+        fprintf(stderr,
+        "A RTMP server which accepts the RTMP publishers (e.g. OBS, ffmpeg), and\n"
+        "publishes each pushed stream as a live stream named by its stream key\n"
+        "Usange: %s [options]\n"
+        "\n"
+        "Option list:\n"
+        "%s"
+        "\n"
+        "User can send SIGINT/SIGTERM signal to terminate this server\n"
+        "\n", "stsw_rtmp_ingest", option_help.c_str());
+        exit(0);
+    }else if(parser->CheckOption("version")){
+
+        fprintf(stderr, "v0.1.0\n");
+        exit(0);
+    }
+
+    if(parser->CheckOption("loops")){
+        int loops = (int)strtol(parser->OptionValue("loops", "0").c_str(), NULL, 0);
+        if(loops <= 0 || loops > RTMP_INGEST_MAX_LOOPS){
+            fprintf(stderr, "loops must be in 1 ~ %d\n", RTMP_INGEST_MAX_LOOPS);
+            exit(-1);
+        }
+    }
+
+    if(parser->CheckOption("log-file")){
+        if(!parser->CheckOption("log-size")){
+            fprintf(stderr, "log-size must be set if log-file is enabled\n");
+            exit(-1);
+        }
+    }
+
+
+}
+
+
+int main(int argc, char *argv[]) {
+
+    int ret = 0;
+    RtmpIngestServer server;
+    int log_level = stream_switch::LOG_LEVEL_INFO;
+    int loop_num;
+
+    stream_switch::GlobalInit();
+
+    //parse the cmd line
+    stream_switch::ArgParser parser;
+    ParseArgv(argc, argv, &parser); // parse the cmd line
+
+    //
+    // init global logger
+    if(parser.CheckOption(std::string("log-file"))){
+        //init the global logger
+        logger = new stream_switch::RotateLogger();
+        std::string log_file =
+            parser.OptionValue("log-file", "");
+        int log_size =
+            strtol(parser.OptionValue("log-size", "0").c_str(), NULL, 0);
+        int rotate_num =
+            strtol(parser.OptionValue("log-rotate", "0").c_str(), NULL, 0);
+        log_level =
+            strtol(parser.OptionValue("log-level", "6").c_str(), NULL, 0);
+
+        ret = logger->Init("rtmp_ingest",
+            log_file, log_size, rotate_num, log_level, true);
+        if(ret){
+            delete logger;
+            logger = NULL;
+            fprintf(stderr, "Init Logger faile\n");
+            ret = -1;
+            goto exit_1;
+        }
+    }
+
+    // AMF decoding of librtmp logs through its own logger
+    RTMP_LogSetLevel(log_level >= stream_switch::LOG_LEVEL_DEBUG ?
+                     RTMP_LOGDEBUG : RTMP_LOGWARNING);
+
+    loop_num = DefaultLoopNum();
+    if(parser.CheckOption("loops")){
+        loop_num = (int)strtol(parser.OptionValue("loops", "1").c_str(), NULL, 0);
+    }
+
+    ret = server.Init(
+            (int)strtol(parser.OptionValue("port", "1935").c_str(), NULL, 0),
+            loop_num,
+            parser.CheckOption("pin-cpu"),
+            (int)strtol(parser.OptionValue("max-conns", "0").c_str(), NULL, 0),
+            (int)strtol(parser.OptionValue("queue-size", "60").c_str(), NULL, 0),
+            (int)strtol(parser.OptionValue("debug-flags", "0").c_str(), NULL, 0),
+            parser.CheckOption("name-with-app"));
+    if (ret) {
+        fprintf(stderr, "Init RTMP ingest server failed\n");
+        goto exit_2;
+    }
+
+    ret = server.Start();
+    if (ret) {
+        fprintf(stderr, "Start RTMP ingest server failed\n");
+        goto exit_3;
+    }
+
+    // the connections are served by the loop threads, wait for the
+    // terminate signal here
+    while (!stream_switch::isGlobalInterrupt()) {
+        usleep(100000);
+    }
+    ROTATE_LOG(logger, stream_switch::LOG_LEVEL_INFO,
+               "Receive Terminate Signal, exit");
+
+    server.Stop();
+
+exit_3:
+    server.Uninit();
+
+exit_2:
+    if (logger) {
+        logger->Uninit();
+        delete logger;
+        logger = NULL;
+    }
+
+exit_1:
+    stream_switch::GlobalUninit();
+    return ret;
+
+}
@@ -0,0 +1,526 @@
+/*
+ * stsw_rtmp_ingest_server.cc
+ *
+ *  Created on: Apr 23, 2016
+ *      Author: OpenSight Team
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include <stream_switch.h>
+
+#include "stsw_rtmp_ingest_server.h"
+#include "stsw_rtmp_connection.h"
+
+
+extern stream_switch::RotateLogger * logger;
+
+#define RTMP_INGEST_MAX_EVENTS  256
+#define RTMP_INGEST_WAIT_TIME  1000     // in ms
+
+
+///////////////////////////////////////////////////////////
+// RtmpBufferPool
+
+RtmpBufferPool::RtmpBufferPool() {
+
+}
+
+RtmpBufferPool::~RtmpBufferPool() {
+
+    std::vector<std::string *>::iterator it;
+    for (it = freeBuffers_.begin(); it != freeBuffers_.end(); it++) {
+        delete (*it);
+    }
+    freeBuffers_.clear();
+}
+
+std::string *RtmpBufferPool::Get(size_t size) {
+
+    std::string *buf;
+
+    if (freeBuffers_.empty()) {
+        buf = new std::string();
+    } else {
+        buf = freeBuffers_.back();
+        freeBuffers_.pop_back();
+    }
+    buf->reserve(size);
+    return buf;
+}
+
+void RtmpBufferPool::Put(std::string *buf) {
+
+    /* a huge buffer is not kept, which is rare but would stay forever */
+    if (freeBuffers_.size() >= RTMP_POOL_MAX_BUFFERS ||
+        buf->capacity() > RTMP_POOL_MAX_BUFFER_SIZE) {
+        delete buf;
+        return;
+    }
+    buf->clear();
+    freeBuffers_.push_back(buf);
+}
+
+
+///////////////////////////////////////////////////////////
+// RtmpIngestLoop
+
+RtmpIngestLoop::RtmpIngestLoop(RtmpIngestServer *server, int index)
+    :server_(server),
+     index_(index),
+     listenFd_(-1),
+     epollFd_(-1),
+     eventFd_(-1),
+     threadId_(0),
+     started_(0),
+     stopping_(0)
+{
+}
+
+RtmpIngestLoop::~RtmpIngestLoop() {
+
+    Uninit();
+}
+
+int RtmpIngestLoop::Init(int port) {
+
+    struct sockaddr_in addr;
+    struct epoll_event ev;
+    int on = 1;
+
+    listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) {
+        perror("Create RTMP listening socket failed");
+        goto error_out;
+    }
+    /* every loop listens on the same port, the kernel balances the
+     * incoming connections between them */
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (setsockopt(listenFd_, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0) {
+        perror("setsockopt SO_REUSEPORT failed");
+        goto error_out;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(listenFd_, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("Bind RTMP listening socket failed");
+        goto error_out;
+    }
+    if (listen(listenFd_, RTMP_INGEST_LISTEN_BACKLOG) < 0) {
+        perror("Listen RTMP socket failed");
+        goto error_out;
+    }
+
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd_ < 0) {
+        perror("epoll_create1 failed");
+        goto error_out;
+    }
+    eventFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (eventFd_ < 0) {
+        perror("eventfd failed");
+        goto error_out;
+    }
+
+    /* the listening socket and the eventfd are marked by the pointers to
+     * their fd members, the connections by their own pointer */
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = &listenFd_;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &ev) < 0) {
+        perror("epoll_ctl failed");
+        goto error_out;
+    }
+    ev.data.ptr = &eventFd_;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, eventFd_, &ev) < 0) {
+        perror("epoll_ctl failed");
+        goto error_out;
+    }
+
+    return 0;
+
+error_out:
+    Uninit();
+    return -1;
+}
+
+void RtmpIngestLoop::Uninit() {
+
+    std::map<int, RtmpConnection *>::iterator it;
+
+    Stop();
+
+    for (it = conns_.begin(); it != conns_.end(); it++) {
+        delete it->second;
+        server_->ReleaseConnection();
+    }
+    conns_.clear();
+
+    if (eventFd_ >= 0) {
+        close(eventFd_);
+        eventFd_ = -1;
+    }
+    if (epollFd_ >= 0) {
+        close(epollFd_);
+        epollFd_ = -1;
+    }
+    if (listenFd_ >= 0) {
+        close(listenFd_);
+        listenFd_ = -1;
+    }
+}
+
+int RtmpIngestLoop::Start(int cpu) {
+
+    int ret;
+
+    if (started_) {
+        return 0;
+    }
+    stopping_ = 0;
+    ret = pthread_create(&threadId_, NULL, RtmpIngestLoop::StaticThreadRoutine, this);
+    if (ret) {
+        errno = ret;
+        perror("Create RTMP ingest loop thread failed");
+        return -1;
+    }
+    started_ = 1;
+
+    if (cpu >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpu, &cpuset);
+        ret = pthread_setaffinity_np(threadId_, sizeof(cpuset), &cpuset);
+        if (ret) {
+            ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING,
+                       "Failed to pin ingest loop %d on cpu %d", index_, cpu);
+        }
+    }
+
+    return 0;
+}
+
+void RtmpIngestLoop::Stop() {
+
+    uint64_t one = 1;
+    ssize_t ret;
+
+    if (!started_) {
+        return;
+    }
+    stopping_ = 1;
+    ret = write(eventFd_, &one, sizeof(one));
+    (void)ret;
+    pthread_join(threadId_, NULL);
+    threadId_ = 0;
+    started_ = 0;
+}
+
+void RtmpIngestLoop::UpdateEvents(RtmpConnection *conn) {
+
+    struct epoll_event ev;
+    bool wantWrite = conn->WantWrite();
+
+    if (wantWrite == conn->writeWatched()) {
+        return;
+    }
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP | (wantWrite ? EPOLLOUT : 0);
+    ev.data.ptr = conn;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_MOD, conn->fd(), &ev) == 0) {
+        conn->set_writeWatched(wantWrite);
+    }
+}
+
+void * RtmpIngestLoop::StaticThreadRoutine(void *arg) {
+
+    RtmpIngestLoop *loop = (RtmpIngestLoop *)arg;
+    loop->InternalThreadRoutine();
+    return NULL;
+}
+
+void RtmpIngestLoop::InternalThreadRoutine() {
+
+    struct epoll_event events[RTMP_INGEST_MAX_EVENTS];
+    time_t lastCheck = time(NULL);
+    int n, i;
+
+    while (!stopping_) {
+        n = epoll_wait(epollFd_, events, RTMP_INGEST_MAX_EVENTS, RTMP_INGEST_WAIT_TIME);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait failed");
+            break;
+        }
+
+        for (i = 0; i < n; i++) {
+            RtmpConnection *conn;
+            int ret = 0;
+
+            if (events[i].data.ptr == &listenFd_) {
+                Accept();
+                continue;
+            } else if (events[i].data.ptr == &eventFd_) {
+                continue;   /* woken up to stop */
+            }
+
+            conn = (RtmpConnection *)events[i].data.ptr;
+            if (events[i].events & EPOLLIN) {
+                ret = conn->OnReadable();
+            }
+            if (ret == 0 && (events[i].events & EPOLLOUT)) {
+                ret = conn->OnWritable();
+            }
+            if (ret == 0 && (events[i].events & (EPOLLERR | EPOLLHUP))) {
+                ret = -1;
+            }
+            if (ret) {
+                CloseConnection(conn);
+            } else {
+                UpdateEvents(conn);
+            }
+        }
+
+        time_t now = time(NULL);
+        if (now != lastCheck) {
+            CheckIdle(now);
+            lastCheck = now;
+        }
+    }
+}
+
+void RtmpIngestLoop::Accept() {
+
+    struct sockaddr_in addr;
+    socklen_t addrLen;
+    struct epoll_event ev;
+    char peer[64];
+    int fd;
+    int on = 1;
+
+    while (1) {
+        addrLen = sizeof(addr);
+        fd = accept4(listenFd_, (struct sockaddr *)&addr, &addrLen,
+                     SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING,
+                           "accept failed: %s", strerror(errno));
+            }
+            return;
+        }
+
+        snprintf(peer, sizeof(peer), "%s:%d",
+                 inet_ntoa(addr.sin_addr), (int)ntohs(addr.sin_port));
+        if (!server_->AcquireConnection()) {
+            ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING,
+                       "Too many connections, %s rejected", peer);
+            close(fd);
+            continue;
+        }
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        RtmpConnection *conn = new RtmpConnection(this, fd, peer);
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = conn;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING,
+                       "epoll_ctl failed: %s", strerror(errno));
+            delete conn;
+            server_->ReleaseConnection();
+            continue;
+        }
+        conns_[fd] = conn;
+
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_INFO,
+                   "Connection from %s accepted by loop %d", peer, index_);
+    }
+}
+
+void RtmpIngestLoop::CloseConnection(RtmpConnection *conn) {
+
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, conn->fd(), NULL);
+    conns_.erase(conn->fd());
+    delete conn;    /* it closes the socket */
+    server_->ReleaseConnection();
+}
+
+void RtmpIngestLoop::CheckIdle(time_t now) {
+
+    std::map<int, RtmpConnection *>::iterator it;
+    std::vector<RtmpConnection *> idleConns;
+    std::vector<RtmpConnection *>::iterator idleIt;
+
+    for (it = conns_.begin(); it != conns_.end(); it++) {
+        if (now - it->second->lastActive() > RTMP_INGEST_IDLE_TIMEOUT) {
+            idleConns.push_back(it->second);
+        }
+    }
+    for (idleIt = idleConns.begin(); idleIt != idleConns.end(); idleIt++) {
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_WARNING,
+                   "Connection %d idle for %d s, closed",
+                   (*idleIt)->fd(), RTMP_INGEST_IDLE_TIMEOUT);
+        CloseConnection(*idleIt);
+    }
+}
+
+
+///////////////////////////////////////////////////////////
+// RtmpIngestServer
+
+RtmpIngestServer::RtmpIngestServer()
+    :pinCpu_(0),
+     maxConns_(0),
+     queueSize_(0),
+     debugFlags_(0),
+     nameWithApp_(0),
+     connNum_(0)
+{
+    pthread_mutex_init(&lock_, NULL);
+}
+
+RtmpIngestServer::~RtmpIngestServer() {
+
+    Uninit();
+    pthread_mutex_destroy(&lock_);
+}
+
+int RtmpIngestServer::Init(int port, int loopNum, bool pinCpu, int maxConns,
+                           int queueSize, int debugFlags, bool nameWithApp) {
+    int i;
+
+    if (loopNum <= 0 || loopNum > RTMP_INGEST_MAX_LOOPS) {
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_ERR,
+                   "The loop number must be in 1 ~ %d", RTMP_INGEST_MAX_LOOPS);
+        return -1;
+    }
+    pinCpu_ = pinCpu ? 1 : 0;
+    maxConns_ = maxConns;
+    queueSize_ = queueSize;
+    debugFlags_ = debugFlags;
+    nameWithApp_ = nameWithApp ? 1 : 0;
+
+    for (i = 0; i < loopNum; i++) {
+        RtmpIngestLoop *loop = new RtmpIngestLoop(this, i);
+        if (loop->Init(port)) {
+            delete loop;
+            Uninit();
+            return -1;
+        }
+        loops_.push_back(loop);
+    }
+
+    return 0;
+}
+
+void RtmpIngestServer::Uninit() {
+
+    std::vector<RtmpIngestLoop *>::iterator it;
+
+    Stop();
+    for (it = loops_.begin(); it != loops_.end(); it++) {
+        delete (*it);
+    }
+    loops_.clear();
+}
+
+int RtmpIngestServer::Start() {
+
+    int cpuNum = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int i;
+
+    for (i = 0; i < (int)loops_.size(); i++) {
+        int cpu = (pinCpu_ && cpuNum > 0) ? (i % cpuNum) : -1;
+        if (loops_[i]->Start(cpu)) {
+            Stop();
+            return -1;
+        }
+    }
+
+    ROTATE_LOG(logger, stream_switch::LOG_LEVEL_INFO,
+               "RTMP ingest server started with %d loops", (int)loops_.size());
+    return 0;
+}
+
+void RtmpIngestServer::Stop() {
+
+    std::vector<RtmpIngestLoop *>::iterator it;
+
+    for (it = loops_.begin(); it != loops_.end(); it++) {
+        (*it)->Stop();
+    }
+}
+
+bool RtmpIngestServer::AcquireStream(const std::string &streamName) {
+
+    bool ret;
+
+    pthread_mutex_lock(&lock_);
+    ret = streams_.insert(streamName).second;
+    pthread_mutex_unlock(&lock_);
+    return ret;
+}
+
+void RtmpIngestServer::ReleaseStream(const std::string &streamName) {
+
+    pthread_mutex_lock(&lock_);
+    streams_.erase(streamName);
+    pthread_mutex_unlock(&lock_);
+}
+
+bool RtmpIngestServer::AcquireConnection() {
+
+    bool ret = true;
+
+    pthread_mutex_lock(&lock_);
+    if (maxConns_ > 0 && connNum_ >= maxConns_) {
+        ret = false;
+    } else {
+        connNum_++;
+    }
+    pthread_mutex_unlock(&lock_);
+    return ret;
+}
+
+void RtmpIngestServer::ReleaseConnection() {
+
+    pthread_mutex_lock(&lock_);
+    connNum_--;
+    pthread_mutex_unlock(&lock_);
+}
+
+std::string RtmpIngestServer::StreamName(const std::string &app, const std::string &key) {
+
+    std::string name;
+    size_t pos;
+
+    /* the query string is for the authentication of some servers */
+    name = key.substr(0, key.find('?'));
+    if (nameWithApp_ && !app.empty()) {
+        name = app.substr(0, app.find('?')) + "_" + name;
+    }
+    /* '/' is not allowed, e.g. in the app with instance name */
+    while ((pos = name.find('/')) != std::string::npos) {
+        name[pos] = '_';
+    }
+    return name;
+}
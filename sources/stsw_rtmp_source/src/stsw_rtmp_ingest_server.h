@@ -0,0 +1,153 @@
+/*
+ * stsw_rtmp_ingest_server.h
+ *
+ *  Created on: Apr 23, 2016
+ *      Author: OpenSight Team
+ *
+ *  RtmpIngestServer accepts the RTMP publishers (push mode), and publishes
+ *  each app/stream key as a StreamSwitch stream in the same process.
+ *
+ *  The connections are spread over a few RtmpIngestLoop, each of which is
+ *  one thread running an epoll loop with its own listening socket on the
+ *  same port (SO_REUSEPORT), so that the kernel balances the connections
+ *  between the loops, and the loops share nothing but the stream registry
+ */
+
+#ifndef STREAMSWITCH_SOURCES_STSW_RTMP_SOURCE_SRC_STSW_RTMP_INGEST_SERVER_H_
+#define STREAMSWITCH_SOURCES_STSW_RTMP_SOURCE_SRC_STSW_RTMP_INGEST_SERVER_H_
+
+
+#include <pthread.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+
+
+#define RTMP_INGEST_MAX_LOOPS  64
+#define RTMP_INGEST_LISTEN_BACKLOG  128
+#define RTMP_INGEST_IDLE_TIMEOUT  30     // in sec
+#define RTMP_POOL_MAX_BUFFERS  256
+#define RTMP_POOL_MAX_BUFFER_SIZE  (1024 * 1024)
+
+
+class RtmpConnection;
+class RtmpIngestServer;
+
+
+// RtmpBufferPool
+//    The free list of the message reassembly buffers of a loop, so that
+// the message bodies of all the connections of the loop reuse the same
+// few buffers instead of allocating one for each message. It's only used
+// by the loop thread, so no lock
+class RtmpBufferPool
+{
+public:
+    RtmpBufferPool();
+    virtual ~RtmpBufferPool();
+
+    // Get()
+    // get an empty buffer whose capacity is at least size
+    std::string *Get(size_t size);
+
+    // Put()
+    // give back the buffer got by Get()
+    void Put(std::string *buf);
+
+private:
+    std::vector<std::string *> freeBuffers_;
+};
+
+
+class RtmpIngestLoop
+{
+public:
+    RtmpIngestLoop(RtmpIngestServer *server, int index);
+    virtual ~RtmpIngestLoop();
+
+    int Init(int port);
+    void Uninit();
+
+    // Start()
+    // start the loop thread, pin it on the given cpu if cpu >= 0
+    int Start(int cpu);
+    void Stop();
+
+    // UpdateEvents()
+    // watch the writable event of the connection or not, according to
+    // whether it has pending output
+    void UpdateEvents(RtmpConnection *conn);
+
+    RtmpIngestServer *server() { return server_; }
+    RtmpBufferPool *pool() { return &pool_; }
+    int index() { return index_; }
+
+private:
+    static void * StaticThreadRoutine(void *arg);
+    void InternalThreadRoutine();
+
+    void Accept();
+    void CloseConnection(RtmpConnection *conn);
+    void CheckIdle(time_t now);
+
+    RtmpIngestServer *server_;
+    int index_;
+    int listenFd_;
+    int epollFd_;
+    int eventFd_;
+    pthread_t threadId_;
+    char started_;
+    volatile char stopping_;
+
+    RtmpBufferPool pool_;
+    std::map<int, RtmpConnection *> conns_;
+};
+
+
+class RtmpIngestServer
+{
+public:
+    RtmpIngestServer();
+    virtual ~RtmpIngestServer();
+
+    int Init(int port, int loopNum, bool pinCpu, int maxConns,
+             int queueSize, int debugFlags, bool nameWithApp);
+    void Uninit();
+    int Start();
+    void Stop();
+
+    // AcquireStream()
+    // reserve the stream name for a publisher, fail if it's being
+    // published by another one
+    bool AcquireStream(const std::string &streamName);
+    void ReleaseStream(const std::string &streamName);
+
+    // AcquireConnection()
+    // count a new connection, fail if the max connection number reached
+    bool AcquireConnection();
+    void ReleaseConnection();
+
+    // StreamName()
+    // the StreamSwitch stream name for the published app/stream key
+    std::string StreamName(const std::string &app, const std::string &key);
+
+    int queueSize() { return queueSize_; }
+    int debugFlags() { return debugFlags_; }
+
+private:
+    std::vector<RtmpIngestLoop *> loops_;
+    char pinCpu_;
+    int maxConns_;
+    int queueSize_;
+    int debugFlags_;
+    char nameWithApp_;
+
+    pthread_mutex_t lock_;
+    std::set<std::string> streams_;
+    int connNum_;
+};
+
+
+
+#endif /* STREAMSWITCH_SOURCES_STSW_RTMP_SOURCE_SRC_STSW_RTMP_INGEST_SERVER_H_ */
@@ -37,14 +37,14 @@ void ParseArgv(int argc, char *argv[],
         std::string option_help;
         option_help = parser->GetOptionsHelp();
         fprintf(stderr,
-        "A live stream source which reads the media frames from a specified file in cycl\n"
+        "A live stream source which pulls the live stream from a RTMP server\n"
         "Usange: %s [options]\n"
         "\n"
         "Option list:\n"
         "%s"
         "\n"
         "User can send SIGINT/SIGTERM signal to terminate this source\n"
-        "\n", "file_live_source", option_help.c_str());
+        "\n", "stsw_rtmp_source", option_help.c_str());
         exit(0);
     }else if(parser->CheckOption("version")){
 
@@ -81,6 +81,7 @@ int main(int argc, char *argv[]) {
 
     int ret = 0;
     RtmpClientSource* rtmpClient;
+    int log_level = stream_switch::LOG_LEVEL_INFO;
 
     stream_switch::GlobalInit();
 
@@ -99,7 +100,8 @@ int main(int argc, char *argv[]) {
             strtol(parser.OptionValue("log-size", "0").c_str(), NULL, 0);
         int rotate_num =
             strtol(parser.OptionValue("log-rotate", "0").c_str(), NULL, 0);
-        int log_level = stream_switch::LOG_LEVEL_DEBUG;
+        log_level =
+            strtol(parser.OptionValue("log-level", "6").c_str(), NULL, 0);
 
         ret = logger->Init("rtmp_source",
             log_file, log_size, rotate_num, log_level, true);
@@ -112,8 +114,9 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    // setup librtmp logger
-    RTMP_LogSetLevel(RTMP_LOGDEBUG);
+    // setup librtmp logger, its debug log of each packet costs much
+    RTMP_LogSetLevel(log_level >= stream_switch::LOG_LEVEL_DEBUG ?
+                     RTMP_LOGDEBUG : RTMP_LOGWARNING);
 
     // "rtmp://192.168.1.180:1935/vod/wow.flv"
     rtmpClient = RtmpClientSource::Instance();
@@ -129,12 +132,8 @@ int main(int argc, char *argv[]) {
 
     stream_switch::SetIntSigHandler(SignalHandler);
 
-    if (rtmpClient->Connect(std::string(parser.OptionValue("url", ""))) != 0) {
-        return -1;
-    }
-
-
-    return 0;
+    // the source is started once the metadata of the stream is ready
+    ret = rtmpClient->Connect(std::string(parser.OptionValue("url", "")));
 
 exit_4:
     rtmpClient->Uninit();
@@ -16,14 +16,10 @@ extern stream_switch::RotateLogger * logger;
 
 RtmpClientSource* RtmpClientSource::s_instance = NULL;
 
-#define SAVC(x) static const AVal av_##x = AVC(#x)
-
-
 RtmpClientSource::RtmpClientSource( )
     :quit_(0),
-     metaReady_(0),
-     source_(),
-     rtmp_()
+     rtmp_(),
+     publisher_()
 {
 }
 
@@ -34,27 +30,13 @@ int RtmpClientSource::Init(
         int queue_size,
         int debug_flags)
 {
-    int ret;
-    std::string err_info;
-
-    //init source
-    ret = source_.Init(stream_name, source_tcp_port,
-                       queue_size,
-                       this, debug_flags, &err_info);
-    if (ret) {
-        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_ERR, "Failed to init stream source");
-        return ret;
-    }
-
-
-
-
+    return publisher_.Init(stream_name, source_tcp_port, queue_size, debug_flags);
 }
 
 
 void RtmpClientSource::Uninit() {
 
-    source_.Uninit();
+    publisher_.Uninit();
 }
 
 
@@ -62,12 +44,14 @@ int RtmpClientSource::Connect(std::string rtmpUrl) {
 
     RTMPPacket packet = { 0 };
     char url[512];
+    struct timeval startTime, endTime;
+    double elapsed;
 
     int len;
 
     len = rtmpUrl.length();
-    if ((len > 512) || (len <= 7)) {
-        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_ERR, "Invalid RTMP URL %s, too long or too short", rtmpUrl);
+    if ((len >= 512) || (len <= 7)) {
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_ERR, "Invalid RTMP URL %s, too long or too short", rtmpUrl.c_str());
         return -1;
     }
     rtmpUrl_ = rtmpUrl;
@@ -98,18 +82,50 @@ int RtmpClientSource::Connect(std::string rtmpUrl) {
     }
     ROTATE_LOG(logger, stream_switch::LOG_LEVEL_INFO, "Connected to stream");
 
-    while(RTMP_ReadPacket(rtmp_, &packet) && not quit_) {
+    gettimeofday(&startTime, NULL);
+
+    // librtmp hands the body buffer of a partial message between the packet
+    // and its chunk stream state, so the body cannot be recycled here. What
+    // is avoided is any copy of it: the media data is converted in place and
+    // published directly from the body
+    while(!quit_ && RTMP_IsConnected(rtmp_) && RTMP_ReadPacket(rtmp_, &packet)) {
         if (RTMPPacket_IsReady(&packet))
         {
             if (!packet.m_nBodySize)
                 continue;
 
             ROTATE_LOG(logger, stream_switch::LOG_LEVEL_DEBUG, "Message type %x received", packet.m_packetType);
+
+            // protocol control messages, e.g. set chunk size, ping
+            if (RTMP_ClientPacket(rtmp_, &packet) == 2) {
+                ROTATE_LOG(logger, stream_switch::LOG_LEVEL_INFO, "Stream stopped by the server");
+                RTMPPacket_Free(&packet);
+                break;
+            }
             HandlePacket(packet);
             RTMPPacket_Free(&packet);
         }
     }
+    RTMPPacket_Free(&packet);
 
+    gettimeofday(&endTime, NULL);
+    elapsed = (endTime.tv_sec - startTime.tv_sec) +
+              (endTime.tv_usec - startTime.tv_usec) / 1000000.0;
+    if (elapsed <= 0.0) {
+        elapsed = 0.001;
+    }
+    ROTATE_LOG(logger, stream_switch::LOG_LEVEL_INFO,
+               "%llu frames (%llu dropped), %llu bytes received in %.3f s: "
+               "%.1f frames/s, %.1f kbps",
+               (unsigned long long)publisher_.frames(),
+               (unsigned long long)publisher_.droppedFrames(),
+               (unsigned long long)publisher_.bytes(), elapsed,
+               publisher_.frames() / elapsed, publisher_.bytes() * 8 / elapsed / 1000);
+
+    if (!quit_) {
+        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_ERR, "Connection to %s lost", rtmpUrl_.c_str());
+        return -1;
+    }
     return 0;
 }
 
@@ -130,64 +146,25 @@ int RtmpClientSource::HandlePacket(RTMPPacket& packet) {
     switch (packet.m_packetType) {
     case RTMP_PACKET_TYPE_INFO:
         /* metadata (notify) */
-        if (HandleonMetaData(packet.m_body, packet.m_nBodySize) != 0) {
+        if (publisher_.HandleonMetaData(packet.m_body, packet.m_nBodySize) != 0) {
             return -1;
         }
         break;
+    case RTMP_PACKET_TYPE_VIDEO:
+        return publisher_.HandleVideoData(packet.m_nTimeStamp, packet.m_body, packet.m_nBodySize);
+    case RTMP_PACKET_TYPE_AUDIO:
+        return publisher_.HandleAudioData(packet.m_nTimeStamp, packet.m_body, packet.m_nBodySize);
+    case RTMP_PACKET_TYPE_FLASH_VIDEO:
+        /* aggregate message */
+        return publisher_.HandleAggregate(packet.m_nTimeStamp, packet.m_body, packet.m_nBodySize);
     }
 
     return 0;
 }
 
-SAVC(onMetaData);
-SAVC(duration);
-
-int RtmpClientSource::HandleonMetaData(char *body, unsigned int len) {
-
-    AMFObject obj;
-    AVal metastring;
-    int ret = FALSE;
-
-    int nRes = AMF_Decode(&obj, body, len, FALSE);
-    if (nRes < 0)
-    {
-        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_ERR, "error decoding meta data message");
-        return -1;
-    }
-
-    AMF_Dump(&obj);
-    AMFProp_GetString(AMF_GetProp(&obj, NULL, 0), &metastring);
-
-    if (AVMATCH(&metastring, &av_onMetaData))
-    {
-        stream_switch::StreamMetadata metadata;
-        stream_switch::SubStreamMetadata sub_metadata;
-        AMFObjectProperty prop;
-
-        ROTATE_LOG(logger, stream_switch::LOG_LEVEL_INFO, "onMetaData Message received");
-        if (RTMP_FindFirstMatchingProperty(&obj, &av_duration, &prop))
-        {
-          r->m_fDuration = prop.p_vu.p_number;
-          /*RTMP_Log(RTMP_LOGDEBUG, "Set duration: %.2f", m_fDuration); */
-        }
-        /* Search for audio or video tags */
-        if (RTMP_FindPrefixProperty(&obj, &av_video, &prop))
-            r->m_read.dataType |= 1;
-        if (RTMP_FindPrefixProperty(&obj, &av_audio, &prop))
-            r->m_read.dataType |= 4;
-
-
-        source_.set_stream_meta(metadata);
-    }
-    AMF_Reset(&obj);
-
-
-    metaReady_ = 1;
-    return 0;
-}
-
 
 void RtmpClientSource::SetQuit() {
     quit_ = 1;
+    /* interrupt the blocking socket read of librtmp */
+    RTMP_ctrlC = TRUE;
 }
-
@@ -18,9 +18,10 @@
 #include <librtmp/log.h>
 #include <stream_switch.h>
 
+#include "stsw_flv_media_publisher.h"
 
 
-class RtmpClientSource: public stream_switch::SourceListener
+class RtmpClientSource
 {
 public:
     static RtmpClientSource* Instance()
@@ -47,10 +48,6 @@ public:
     void Uninit();
     int Connect(std::string rtmpUrl);
     int HandlePacket(RTMPPacket& packet);
-    int HandleonMetaData(char *body, unsigned int len);
-
-    void OnKeyFrame(void) {};
-    void OnMediaStatistic(stream_switch::MediaStatisticInfo *statistic) {};
 
 private:
     RtmpClientSource();
@@ -59,11 +56,11 @@ private:
     static RtmpClientSource * s_instance;
 
     char quit_;
-    char metaReady_;
-    stream_switch::StreamSource source_;
     std::string rtmpUrl_;
     RTMP*  rtmp_;
 
+    FlvMediaPublisher publisher_;
+
 };
 
 
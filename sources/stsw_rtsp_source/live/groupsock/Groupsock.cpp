@@ -343,6 +343,56 @@ Boolean Groupsock::handleRead(unsigned char* buffer, unsigned bufferMaxSize,
   return True;
 }
 
+int Groupsock::handleReadBatch(unsigned char** buffers, unsigned bufferMaxSize,
+			       unsigned numBuffers, unsigned* bytesRead,
+			       struct sockaddr_in* fromAddresses,
+			       struct timeval* timesReceived) {
+  // The same as "handleRead()", but for up to "numBuffers" datagrams at once
+  int maxBytesToRead = bufferMaxSize - TunnelEncapsulationTrailerMaxSize;
+  int numRead = readSocketBatch(env(), socketNum(), buffers, maxBytesToRead,
+				numBuffers, bytesRead, fromAddresses, timesReceived);
+  if (numRead < 0) {
+    if (DebugLevel >= 0) { // this is a fatal error
+      env().setResultMsg("Groupsock read failed: ",
+			 env().getResultMsg());
+    }
+    return -1;
+  }
+
+  int numKept = 0;
+  for (int i = 0; i < numRead; ++i) {
+    // If we're a SSM group, make sure the source address matches:
+    if (isSSM()
+	&& fromAddresses[i].sin_addr.s_addr != sourceFilterAddress().s_addr) {
+      continue; // drop it; its buffer is moved after the kept ones, as in "readSocketBatch()"
+    }
+    if (numKept != i) {
+      unsigned char* buffer = buffers[numKept];
+      buffers[numKept] = buffers[i];
+      buffers[i] = buffer;
+      bytesRead[numKept] = bytesRead[i];
+      fromAddresses[numKept] = fromAddresses[i];
+      timesReceived[numKept] = timesReceived[i];
+    }
+    int k = numKept++;
+
+    if (!wasLoopedBackFromUs(env(), fromAddresses[k])) {
+      statsIncoming.countPacket(bytesRead[k]);
+      statsGroupIncoming.countPacket(bytesRead[k]);
+      int numMembers =
+	outputToAllMembersExcept(NULL, ttl(),
+				 buffers[k], bytesRead[k],
+				 fromAddresses[k].sin_addr.s_addr);
+      if (numMembers > 0) {
+	statsRelayedIncoming.countPacket(bytesRead[k]);
+	statsGroupRelayedIncoming.countPacket(bytesRead[k]);
+      }
+    }
+  }
+
+  return numKept;
+}
+
 Boolean Groupsock::wasLoopedBackFromUs(UsageEnvironment& env,
 				       struct sockaddr_in& fromAddress) {
   if (fromAddress.sin_addr.s_addr
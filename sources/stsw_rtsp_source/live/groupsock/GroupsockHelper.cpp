@@ -312,6 +312,99 @@ int readSocket(UsageEnvironment& env,
   return bytesRead;
 }
 
+#if defined(__linux__)
+#define READ_SOCKET_BATCH_MAX 64
+#define READ_SOCKET_CMSG_SIZE 64
+
+int readSocketBatch(UsageEnvironment& env,
+		    int socket, unsigned char** buffers, unsigned bufferSize,
+		    unsigned numBuffers, unsigned* bytesRead,
+		    struct sockaddr_in* fromAddresses,
+		    struct timeval* timesReceived) {
+  struct mmsghdr msgs[READ_SOCKET_BATCH_MAX];
+  struct iovec iovs[READ_SOCKET_BATCH_MAX];
+  char controls[READ_SOCKET_BATCH_MAX][READ_SOCKET_CMSG_SIZE];
+
+  if (numBuffers > READ_SOCKET_BATCH_MAX) numBuffers = READ_SOCKET_BATCH_MAX;
+  for (unsigned i = 0; i < numBuffers; ++i) {
+    iovs[i].iov_base = buffers[i];
+    iovs[i].iov_len = bufferSize;
+    memset(&msgs[i], 0, sizeof msgs[i]);
+    msgs[i].msg_hdr.msg_name = &fromAddresses[i];
+    msgs[i].msg_hdr.msg_namelen = sizeof fromAddresses[i];
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_control = controls[i];
+    msgs[i].msg_hdr.msg_controllen = READ_SOCKET_CMSG_SIZE;
+  }
+
+  int numRead = recvmmsg(socket, msgs, numBuffers, MSG_DONTWAIT, NULL);
+  if (numRead < 0) {
+    int err = env.getErrno();
+    if (err == ECONNREFUSED || err == EAGAIN || err == EHOSTUNREACH) {
+      return 0; // the same as "readSocket()"
+    }
+    socketErr(env, "recvmmsg() error: ");
+    return -1;
+  }
+
+  struct timeval timeNow;
+  gettimeofday(&timeNow, NULL);
+  int numKept = 0;
+  for (int i = 0; i < numRead; ++i) {
+    if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+      // The datagram didn't fit in the buffer; drop it rather than passing on a partial packet:
+      env.setResultMsg("readSocketBatch(): dropped a truncated datagram");
+      continue;
+    }
+    if (numKept != i) {
+      // Keep the datagrams read so far contiguous; the buffer of a dropped one moves to the end:
+      unsigned char* buffer = buffers[numKept];
+      buffers[numKept] = buffers[i];
+      buffers[i] = buffer;
+      fromAddresses[numKept] = fromAddresses[i];
+    }
+    bytesRead[numKept] = msgs[i].msg_len;
+    timesReceived[numKept] = timeNow;
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg != NULL;
+	 cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+	struct timespec ts;
+	memcpy(&ts, CMSG_DATA(cmsg), sizeof ts);
+	timesReceived[numKept].tv_sec = ts.tv_sec;
+	timesReceived[numKept].tv_usec = ts.tv_nsec/1000;
+	break;
+      }
+    }
+    ++numKept;
+  }
+  return numKept;
+}
+
+Boolean setSocketTimestamping(int socket) {
+  int on = 1;
+  return setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof on) == 0;
+}
+#else
+int readSocketBatch(UsageEnvironment& env,
+		    int socket, unsigned char** buffers, unsigned bufferSize,
+		    unsigned numBuffers, unsigned* bytesRead,
+		    struct sockaddr_in* fromAddresses,
+		    struct timeval* timesReceived) {
+  // No "recvmmsg()"; just read one datagram:
+  if (numBuffers == 0) return 0;
+  int numBytes = readSocket(env, socket, buffers[0], bufferSize, fromAddresses[0]);
+  if (numBytes <= 0) return numBytes;
+  bytesRead[0] = numBytes;
+  gettimeofday(&timesReceived[0], NULL);
+  return 1;
+}
+
+Boolean setSocketTimestamping(int /*socket*/) {
+  return False;
+}
+#endif
+
 Boolean writeSocket(UsageEnvironment& env,
 		    int socket, struct in_addr address, Port port,
 		    u_int8_t ttlArg,
@@ -142,6 +142,15 @@ public: // redefined virtual functions
 			     unsigned& bytesRead,
 			     struct sockaddr_in& fromAddress);
 
+public:
+  int handleReadBatch(unsigned char** buffers, unsigned bufferMaxSize,
+		      unsigned numBuffers, unsigned* bytesRead,
+		      struct sockaddr_in* fromAddresses,
+		      struct timeval* timesReceived);
+      // Reads up to "numBuffers" datagrams at once; returns the number kept, or -1 on error.
+      // Datagrams that are filtered out (SSM source mismatch) are dropped and not counted;
+      // as in "readSocketBatch()", the kept ones are moved to the first entries of "buffers".
+
 private:
   int outputToAllMembersExcept(DirectedNetInterface* exceptInterface,
 			       u_int8_t ttlToFwd,
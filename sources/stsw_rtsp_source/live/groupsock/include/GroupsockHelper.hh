@@ -33,6 +33,22 @@ int readSocket(UsageEnvironment& env,
 	       int socket, unsigned char* buffer, unsigned bufferSize,
 	       struct sockaddr_in& fromAddress);
 
+int readSocketBatch(UsageEnvironment& env,
+		    int socket, unsigned char** buffers, unsigned bufferSize,
+		    unsigned numBuffers, unsigned* bytesRead,
+		    struct sockaddr_in* fromAddresses,
+		    struct timeval* timesReceived);
+    // Reads up to "numBuffers" datagrams with a single "recvmmsg()" call (where available),
+    // and returns the number of datagrams read (0 if none is pending), or -1 on error.
+    // "timesReceived" gets the kernel receive time of each datagram if "setSocketTimestamping()"
+    // has been called on the socket, or the current time otherwise.
+    // Truncated datagrams (larger than "bufferSize") are dropped.  To keep the returned datagrams
+    // in the first entries, the pointers in "buffers" may be reordered; the caller must use
+    // "buffers[i]" (not its own original buffer order) for the i'th datagram.
+
+Boolean setSocketTimestamping(int socket);
+    // Asks the kernel to timestamp the incoming datagrams of the socket ("SO_TIMESTAMPNS")
+
 Boolean writeSocket(UsageEnvironment& env,
 		    int socket, struct in_addr address, Port port,
 		    u_int8_t ttlArg,
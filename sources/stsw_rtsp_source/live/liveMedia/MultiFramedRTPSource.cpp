@@ -26,6 +26,14 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 
 ////////// ReorderingPacketBuffer definition //////////
 
+// The max number of UDP packets to read with a single system call:
+#define MAX_READ_BATCH_SIZE 32
+#define MIN_READ_BATCH_SIZE 4
+// The max number of free packets kept by "ReorderingPacketBuffer" for reuse:
+#define MAX_FREE_PACKETS MAX_READ_BATCH_SIZE
+// How often the adaptive reordering threshold is updated:
+#define REORDERING_ADAPT_INTERVAL 500000 /* uSeconds */
+
 class ReorderingPacketBuffer {
 public:
   ReorderingPacketBuffer(BufferedPacketFactory* packetFactory);
@@ -34,20 +42,38 @@ public:
 
   BufferedPacket* getFreePacket(MultiFramedRTPSource* ourSource);
   Boolean storePacket(BufferedPacket* bPacket);
-  BufferedPacket* getNextCompletedPacket(Boolean& packetLossPreceded);
+  BufferedPacket* getNextCompletedPacket(Boolean& packetLossPreceded,
+					 unsigned& numPacketsLost);
   void releaseUsedPacket(BufferedPacket* packet);
   void freePacket(BufferedPacket* packet) {
-    if (packet != fSavedPacket) {
-      delete packet;
-    } else {
+    if (packet == fSavedPacket) {
       fSavedPacketFree = True;
+    } else if (fNumFreePackets < MAX_FREE_PACKETS) {
+      // Keep it for reuse, to avoid calling new/free for each packet:
+      packet->nextPacket() = fFreePackets;
+      fFreePackets = packet;
+      ++fNumFreePackets;
+    } else {
+      delete packet;
     }
   }
   Boolean isEmpty() const { return fHeadPacket == NULL; }
 
   void setThresholdTime(unsigned uSeconds) { fThresholdTime = uSeconds; }
+  unsigned thresholdTime() const { return fThresholdTime; }
   void resetHaveSeenFirstPacket() { fHaveSeenFirstPacket = False; }
 
+  // Reordering measurements:
+  void takeReorderingSamples(unsigned& maxDelay, unsigned& maxDepth);
+      // returns the max reordering delay (uSeconds) and depth (packets) seen
+      // since the last call
+  unsigned long numReorderedPackets() const { return fNumReorderedPackets; }
+  unsigned long numLatePackets() const { return fNumLatePackets; }
+
+private:
+  void noteReordering(struct timeval const& timeReceived, struct timeval const& refTime,
+		      unsigned depth);
+
 private:
   BufferedPacketFactory* fPacketFactory;
   unsigned fThresholdTime; // uSeconds
@@ -58,6 +84,15 @@ private:
   BufferedPacket* fSavedPacket;
       // to avoid calling new/free in the common case
   Boolean fSavedPacketFree;
+  BufferedPacket* fFreePackets; // linked together by "nextPacket()"
+  unsigned fNumFreePackets;
+
+  unsigned fMaxReorderingDelay, fMaxReorderingDepth; // since the last "takeReorderingSamples()"
+  unsigned long fNumReorderedPackets, fNumLatePackets;
+  // The range of packets that we last gave up waiting for, and when:
+  Boolean fHaveSkippedPackets;
+  unsigned short fSkippedSeqNoBegin, fSkippedSeqNoEnd;
+  struct timeval fSkippedTime;
 };
 
 
@@ -68,12 +103,21 @@ MultiFramedRTPSource
 		       unsigned char rtpPayloadFormat,
 		       unsigned rtpTimestampFrequency,
 		       BufferedPacketFactory* packetFactory)
-  : RTPSource(env, RTPgs, rtpPayloadFormat, rtpTimestampFrequency) {
+  : RTPSource(env, RTPgs, rtpPayloadFormat, rtpTimestampFrequency),
+    fReadBatchSize(MIN_READ_BATCH_SIZE),
+    fMinReorderingThreshold(0), fMaxReorderingThreshold(0),
+    fReorderingDelay(0), fReorderingDepth(0), fJitterUSeconds(0),
+    fMarkerBitEndsFrame(False), fPacketsPerFrame(16),
+    fNumLostPackets(0), fNumLostFrames(0), fNumDamagedFrames(0) {
   reset();
   fReorderingBuffer = new ReorderingPacketBuffer(packetFactory);
+  fLastReorderingAdaptTime.tv_sec = fLastReorderingAdaptTime.tv_usec = 0;
 
   // Try to use a big receive buffer for RTP:
   increaseReceiveBufferTo(env, RTPgs->socketNum(), 50*1024);
+
+  // Get the kernel receive time of each packet, for accurate jitter:
+  setSocketTimestamping(RTPgs->socketNum());
 }
 
 void MultiFramedRTPSource::reset() {
@@ -83,6 +127,8 @@ void MultiFramedRTPSource::reset() {
   fPacketReadInProgress = NULL;
   fNeedDelivery = False;
   fPacketLossInFragmentedFrame = False;
+  fHaveCurFrame = False;
+  fCurFrameDamaged = False;
 }
 
 MultiFramedRTPSource::~MultiFramedRTPSource() {
@@ -131,8 +177,9 @@ void MultiFramedRTPSource::doGetNextFrame1() {
   while (fNeedDelivery) {
     // If we already have packet data available, then deliver it now.
     Boolean packetLossPrecededThis;
+    unsigned numPacketsLost;
     BufferedPacket* nextPacket
-      = fReorderingBuffer->getNextCompletedPacket(packetLossPrecededThis);
+      = fReorderingBuffer->getNextCompletedPacket(packetLossPrecededThis, numPacketsLost);
     if (nextPacket == NULL) break;
 
     fNeedDelivery = False;
@@ -148,6 +195,7 @@ void MultiFramedRTPSource::doGetNextFrame1() {
 	break;
       }
       nextPacket->skip(specialHeaderSize);
+      noteDeliveredPacket(nextPacket, numPacketsLost);
     }
 
     // Check whether we're part of a multi-packet frame, and whether
@@ -213,9 +261,131 @@ void MultiFramedRTPSource::doGetNextFrame1() {
 
 void MultiFramedRTPSource
 ::setPacketReorderingThresholdTime(unsigned uSeconds) {
+  fMinReorderingThreshold = fMaxReorderingThreshold = uSeconds; // i.e., not adaptive
   fReorderingBuffer->setThresholdTime(uSeconds);
 }
 
+void MultiFramedRTPSource
+::setPacketReorderingThresholdRange(unsigned minUSeconds, unsigned maxUSeconds) {
+  if (maxUSeconds < minUSeconds) maxUSeconds = minUSeconds;
+  fMinReorderingThreshold = minUSeconds;
+  fMaxReorderingThreshold = maxUSeconds;
+
+  // Start with the lowest latency; the threshold grows if reordering is seen:
+  fReorderingBuffer->setThresholdTime(minUSeconds);
+}
+
+unsigned MultiFramedRTPSource::packetReorderingThresholdTime() const {
+  return fReorderingBuffer->thresholdTime();
+}
+
+unsigned long MultiFramedRTPSource::numReorderedPackets() const {
+  return fReorderingBuffer->numReorderedPackets();
+}
+
+unsigned long MultiFramedRTPSource::numLatePackets() const {
+  return fReorderingBuffer->numLatePackets();
+}
+
+void MultiFramedRTPSource::adaptReorderingThreshold(struct timeval const& timeNow) {
+  if (fMaxReorderingThreshold == fMinReorderingThreshold) return; // the threshold is fixed
+
+  int uSecondsSinceLast
+    = (timeNow.tv_sec - fLastReorderingAdaptTime.tv_sec)*1000000
+    + (timeNow.tv_usec - fLastReorderingAdaptTime.tv_usec);
+  if (uSecondsSinceLast >= 0 && uSecondsSinceLast < REORDERING_ADAPT_INTERVAL) return;
+  fLastReorderingAdaptTime = timeNow;
+
+  // Track the reordering delay quickly when it grows, but only slowly when it shrinks,
+  // so that a single quiet interval doesn't drop the threshold on a bad link:
+  unsigned maxDelay, maxDepth;
+  fReorderingBuffer->takeReorderingSamples(maxDelay, maxDepth);
+  if (maxDelay >= fReorderingDelay) {
+    fReorderingDelay = maxDelay;
+  } else {
+    fReorderingDelay -= (fReorderingDelay - maxDelay + 7)/8;
+  }
+  if (maxDepth >= fReorderingDepth) {
+    fReorderingDepth = maxDepth;
+  } else {
+    fReorderingDepth -= (fReorderingDepth - maxDepth + 7)/8;
+  }
+
+  RTPReceptionStats* stats = receptionStatsDB().lookup(fLastReceivedSSRC);
+  if (stats != NULL && timestampFrequency() != 0) {
+    fJitterUSeconds = (unsigned)(((double)stats->jitter()*1000000)/timestampFrequency());
+  }
+
+  // Wait a bit more than the reordering delay seen, with the jitter as margin.
+  // Without any reordering, there's nothing worth waiting for:
+  unsigned threshold = 0;
+  if (fReorderingDelay > 0) {
+    threshold = fReorderingDelay + fReorderingDelay/4 + fJitterUSeconds;
+  }
+  if (threshold < fMinReorderingThreshold) threshold = fMinReorderingThreshold;
+  if (threshold > fMaxReorderingThreshold) threshold = fMaxReorderingThreshold;
+  fReorderingBuffer->setThresholdTime(threshold);
+}
+
+void MultiFramedRTPSource
+::noteDeliveredPacket(BufferedPacket* packet, unsigned numPacketsLost) {
+  unsigned rtpTimestamp = packet->rtpTimestamp();
+  if (!fHaveCurFrame || packet->isFirstPacket()) {
+    // (Re)start the accounting from this packet:
+    fHaveCurFrame = True;
+    fCurFrameRTPTimestamp = rtpTimestamp;
+    fCurFrameNumPackets = 1;
+    fCurFrameDamaged = False;
+    fCurFrameCompleted = packet->rtpMarkerBit();
+    return;
+  }
+
+  Boolean isNewFrame = rtpTimestamp != fCurFrameRTPTimestamp;
+  Boolean newFrameDamaged = False;
+  if (numPacketsLost > 0) {
+    fNumLostPackets += numPacketsLost;
+    if (!isNewFrame) {
+      // A hole inside the current frame:
+      fCurFrameDamaged = True;
+    } else {
+      // The lost packets may be the tail of the current frame, the head of
+      // the new one, and any whole frames in between:
+      Boolean tailLost = fMarkerBitEndsFrame && !fCurFrameCompleted;
+      Boolean headLost = !fCurrentPacketBeginsFrame;
+      if (tailLost) fCurFrameDamaged = True;
+      newFrameDamaged = headLost;
+
+      unsigned numAdjacent = (tailLost ? 1 : 0) + (headLost ? 1 : 0);
+      unsigned numWholeFrames = (numPacketsLost*16 + fPacketsPerFrame/2)/fPacketsPerFrame;
+      numWholeFrames = numWholeFrames > numAdjacent ? numWholeFrames - numAdjacent : 0;
+      if (numWholeFrames == 0 && numAdjacent == 0) {
+	numWholeFrames = 1; // the lost packets lie between two intact frames
+      }
+      if (numWholeFrames > numPacketsLost) numWholeFrames = numPacketsLost;
+      fNumLostFrames += numWholeFrames;
+    }
+  }
+
+  if (isNewFrame) {
+    // The current frame ends:
+    if (fCurFrameDamaged) {
+      ++fNumDamagedFrames;
+    } else {
+      fMarkerBitEndsFrame = fCurFrameCompleted;
+      // Update the average number of packets per frame, with a gain of 1/8:
+      int diff = (int)(fCurFrameNumPackets*16) - (int)fPacketsPerFrame;
+      fPacketsPerFrame += diff/8;
+      if (fPacketsPerFrame < 16) fPacketsPerFrame = 16;
+    }
+
+    fCurFrameRTPTimestamp = rtpTimestamp;
+    fCurFrameNumPackets = 0;
+    fCurFrameDamaged = newFrameDamaged;
+  }
+  ++fCurFrameNumPackets;
+  fCurFrameCompleted = packet->rtpMarkerBit();
+}
+
 #define ADVANCE(n) do { bPacket->skip(n); } while (0)
 
 void MultiFramedRTPSource::networkReadHandler(MultiFramedRTPSource* source, int /*mask*/) {
@@ -223,6 +393,12 @@ void MultiFramedRTPSource::networkReadHandler(MultiFramedRTPSource* source, int
 }
 
 void MultiFramedRTPSource::networkReadHandler1() {
+  if (fPacketReadInProgress == NULL && !fRTPInterface.nextReadIsFromTCP()) {
+    // Normal case for UDP: Read all pending packets at once:
+    networkReadBatch();
+    return;
+  }
+
   BufferedPacket* bPacket = fPacketReadInProgress;
   if (bPacket == NULL) {
     // Normal case: Get a free BufferedPacket descriptor to hold the new network packet:
@@ -248,93 +424,139 @@ void MultiFramedRTPSource::networkReadHandler1() {
     } else {
       fPacketReadInProgress = NULL;
     }
-#ifdef TEST_LOSS
-    setPacketReorderingThresholdTime(0);
-       // don't wait for 'lost' packets to arrive out-of-order later
-    if ((our_random()%10) == 0) break; // simulate 10% packet loss
-#endif
 
-    // Check for the 12-byte RTP header:
-    if (bPacket->dataSize() < 12) break;
-    unsigned rtpHdr = ntohl(*(u_int32_t*)(bPacket->data())); ADVANCE(4);
-    Boolean rtpMarkerBit = (rtpHdr&0x00800000) != 0;
-    unsigned rtpTimestamp = ntohl(*(u_int32_t*)(bPacket->data()));ADVANCE(4);
-    unsigned rtpSSRC = ntohl(*(u_int32_t*)(bPacket->data())); ADVANCE(4);
-
-    // Check the RTP version number (it should be 2):
-    if ((rtpHdr&0xC0000000) != 0x80000000) break;
-
-    // Check the Payload Type.
-    unsigned char rtpPayloadType = (unsigned char)((rtpHdr&0x007F0000)>>16);
-    if (rtpPayloadType != rtpPayloadFormat()) {
-      if (fRTCPInstanceForMultiplexedRTCPPackets != NULL
-	  && rtpPayloadType >= 64 && rtpPayloadType <= 95) {
-	// This is a multiplexed RTCP packet, and we've been asked to deliver such packets.
-	// Do so now:
-	fRTCPInstanceForMultiplexedRTCPPackets
-	  ->injectReport(bPacket->data()-12, bPacket->dataSize()+12, fromAddress);
-      }
-      break;
-    }
+    readSuccess = processIncomingPacket(bPacket, fromAddress, NULL);
+  } while (0);
+  if (!readSuccess) fReorderingBuffer->freePacket(bPacket);
 
-    // Skip over any CSRC identifiers in the header:
-    unsigned cc = (rtpHdr>>24)&0x0F;
-    if (bPacket->dataSize() < cc*4) break;
-    ADVANCE(cc*4);
-
-    // Check for (& ignore) any RTP header extension
-    if (rtpHdr&0x10000000) {
-      if (bPacket->dataSize() < 4) break;
-      unsigned extHdr = ntohl(*(u_int32_t*)(bPacket->data())); ADVANCE(4);
-      unsigned remExtSize = 4*(extHdr&0xFFFF);
-      if (bPacket->dataSize() < remExtSize) break;
-      ADVANCE(remExtSize);
-    }
+  doGetNextFrame1();
+  // If we didn't get proper data this time, we'll get another chance
+}
 
-    // Discard any padding bytes:
-    if (rtpHdr&0x20000000) {
-      if (bPacket->dataSize() == 0) break;
-      unsigned numPaddingBytes
-	= (unsigned)(bPacket->data())[bPacket->dataSize()-1];
-      if (bPacket->dataSize() < numPaddingBytes) break;
-      bPacket->removePadding(numPaddingBytes);
-    }
+void MultiFramedRTPSource::networkReadBatch() {
+  BufferedPacket* packets[MAX_READ_BATCH_SIZE];
+  struct sockaddr_in fromAddresses[MAX_READ_BATCH_SIZE];
+  struct timeval timesReceived[MAX_READ_BATCH_SIZE];
+  unsigned numPackets = fReadBatchSize;
 
-    // The rest of the packet is the usable data.  Record and save it:
-    if (rtpSSRC != fLastReceivedSSRC) {
-      // The SSRC of incoming packets has changed.  Unfortunately we don't yet handle streams that contain multiple SSRCs,
-      // but we can handle a single-SSRC stream where the SSRC changes occasionally:
-      fLastReceivedSSRC = rtpSSRC;
-      fReorderingBuffer->resetHaveSeenFirstPacket();
+  for (unsigned i = 0; i < numPackets; ++i) {
+    packets[i] = fReorderingBuffer->getFreePacket(this);
+  }
+
+  int numRead = BufferedPacket::fillInDataBatch(fRTPInterface, packets, numPackets,
+						fromAddresses, timesReceived);
+  for (int i = 0; i < numRead; ++i) {
+    if (!processIncomingPacket(packets[i], fromAddresses[i], &timesReceived[i])) {
+      fReorderingBuffer->freePacket(packets[i]);
     }
-    unsigned short rtpSeqNo = (unsigned short)(rtpHdr&0xFFFF);
-    Boolean usableInJitterCalculation
-      = packetIsUsableInJitterCalculation((bPacket->data()),
-						  bPacket->dataSize());
-    struct timeval presentationTime; // computed by:
-    Boolean hasBeenSyncedUsingRTCP; // computed by:
-    receptionStatsDB()
-      .noteIncomingPacket(rtpSSRC, rtpSeqNo, rtpTimestamp,
-			  timestampFrequency(),
-			  usableInJitterCalculation, presentationTime,
-			  hasBeenSyncedUsingRTCP, bPacket->dataSize());
-
-    // Fill in the rest of the packet descriptor, and store it:
-    struct timeval timeNow;
-    gettimeofday(&timeNow, NULL);
-    bPacket->assignMiscParams(rtpSeqNo, rtpTimestamp, presentationTime,
-			      hasBeenSyncedUsingRTCP, rtpMarkerBit,
-			      timeNow);
-    if (!fReorderingBuffer->storePacket(bPacket)) break;
+  }
+  for (unsigned i = (numRead > 0 ? numRead : 0); i < numPackets; ++i) {
+    fReorderingBuffer->freePacket(packets[i]);
+  }
 
-    readSuccess = True;
-  } while (0);
-  if (!readSuccess) fReorderingBuffer->freePacket(bPacket);
+  // Adapt the batch size to the incoming rate, so that a low rate stream
+  // doesn't hold many packet buffers:
+  if (numRead == (int)numPackets && fReadBatchSize < MAX_READ_BATCH_SIZE) {
+    fReadBatchSize *= 2;
+  } else if (numRead >= 0 && (unsigned)numRead < fReadBatchSize/4
+	     && fReadBatchSize > MIN_READ_BATCH_SIZE) {
+    fReadBatchSize /= 2;
+  }
 
   doGetNextFrame1();
   // If we didn't get proper data this time, we'll get another chance
 }
 
+Boolean MultiFramedRTPSource
+::processIncomingPacket(BufferedPacket* bPacket, struct sockaddr_in& fromAddress,
+			struct timeval const* timeReceived) {
+#ifdef TEST_LOSS
+  setPacketReorderingThresholdTime(0);
+     // don't wait for 'lost' packets to arrive out-of-order later
+  if ((our_random()%10) == 0) return False; // simulate 10% packet loss
+#endif
+
+  // Check for the 12-byte RTP header:
+  if (bPacket->dataSize() < 12) return False;
+  unsigned rtpHdr = ntohl(*(u_int32_t*)(bPacket->data())); ADVANCE(4);
+  Boolean rtpMarkerBit = (rtpHdr&0x00800000) != 0;
+  unsigned rtpTimestamp = ntohl(*(u_int32_t*)(bPacket->data()));ADVANCE(4);
+  unsigned rtpSSRC = ntohl(*(u_int32_t*)(bPacket->data())); ADVANCE(4);
+
+  // Check the RTP version number (it should be 2):
+  if ((rtpHdr&0xC0000000) != 0x80000000) return False;
+
+  // Check the Payload Type.
+  unsigned char rtpPayloadType = (unsigned char)((rtpHdr&0x007F0000)>>16);
+  if (rtpPayloadType != rtpPayloadFormat()) {
+    if (fRTCPInstanceForMultiplexedRTCPPackets != NULL
+	&& rtpPayloadType >= 64 && rtpPayloadType <= 95) {
+      // This is a multiplexed RTCP packet, and we've been asked to deliver such packets.
+      // Do so now:
+      fRTCPInstanceForMultiplexedRTCPPackets
+	->injectReport(bPacket->data()-12, bPacket->dataSize()+12, fromAddress);
+    }
+    return False;
+  }
+
+  // Skip over any CSRC identifiers in the header:
+  unsigned cc = (rtpHdr>>24)&0x0F;
+  if (bPacket->dataSize() < cc*4) return False;
+  ADVANCE(cc*4);
+
+  // Check for (& ignore) any RTP header extension
+  if (rtpHdr&0x10000000) {
+    if (bPacket->dataSize() < 4) return False;
+    unsigned extHdr = ntohl(*(u_int32_t*)(bPacket->data())); ADVANCE(4);
+    unsigned remExtSize = 4*(extHdr&0xFFFF);
+    if (bPacket->dataSize() < remExtSize) return False;
+    ADVANCE(remExtSize);
+  }
+
+  // Discard any padding bytes:
+  if (rtpHdr&0x20000000) {
+    if (bPacket->dataSize() == 0) return False;
+    unsigned numPaddingBytes
+      = (unsigned)(bPacket->data())[bPacket->dataSize()-1];
+    if (bPacket->dataSize() < numPaddingBytes) return False;
+    bPacket->removePadding(numPaddingBytes);
+  }
+
+  // The rest of the packet is the usable data.  Record and save it:
+  if (rtpSSRC != fLastReceivedSSRC) {
+    // The SSRC of incoming packets has changed.  Unfortunately we don't yet handle streams that contain multiple SSRCs,
+    // but we can handle a single-SSRC stream where the SSRC changes occasionally:
+    fLastReceivedSSRC = rtpSSRC;
+    fReorderingBuffer->resetHaveSeenFirstPacket();
+  }
+  unsigned short rtpSeqNo = (unsigned short)(rtpHdr&0xFFFF);
+  Boolean usableInJitterCalculation
+    = packetIsUsableInJitterCalculation((bPacket->data()),
+					bPacket->dataSize());
+  struct timeval presentationTime; // computed by:
+  Boolean hasBeenSyncedUsingRTCP; // computed by:
+  receptionStatsDB()
+    .noteIncomingPacket(rtpSSRC, rtpSeqNo, rtpTimestamp,
+			timestampFrequency(),
+			usableInJitterCalculation, presentationTime,
+			hasBeenSyncedUsingRTCP, bPacket->dataSize(),
+			timeReceived);
+
+  // Fill in the rest of the packet descriptor, and store it:
+  struct timeval timeNow;
+  if (timeReceived != NULL) {
+    timeNow = *timeReceived;
+  } else {
+    gettimeofday(&timeNow, NULL);
+  }
+  bPacket->assignMiscParams(rtpSeqNo, rtpTimestamp, presentationTime,
+			    hasBeenSyncedUsingRTCP, rtpMarkerBit,
+			    timeNow);
+  Boolean stored = fReorderingBuffer->storePacket(bPacket);
+  adaptReorderingThreshold(timeNow);
+  return stored;
+}
+
 
 ////////// BufferedPacket and BufferedPacketFactory implementation /////
 
@@ -401,6 +623,40 @@ Boolean BufferedPacket::fillInData(RTPInterface& rtpInterface, struct sockaddr_i
   return True;
 }
 
+int BufferedPacket::fillInDataBatch(RTPInterface& rtpInterface, BufferedPacket** packets,
+				    unsigned numPackets, struct sockaddr_in* fromAddresses,
+				    struct timeval* timesReceived) {
+  unsigned char* buffers[MAX_READ_BATCH_SIZE];
+  unsigned bytesRead[MAX_READ_BATCH_SIZE];
+  unsigned bufferSize = MAX_PACKET_SIZE;
+
+  if (numPackets > MAX_READ_BATCH_SIZE) numPackets = MAX_READ_BATCH_SIZE;
+  for (unsigned i = 0; i < numPackets; ++i) {
+    packets[i]->reset();
+    buffers[i] = packets[i]->fBuf;
+    if (packets[i]->fPacketSize < bufferSize) bufferSize = packets[i]->fPacketSize;
+  }
+
+  int numRead = rtpInterface.handleReadBatch(buffers, bufferSize, numPackets,
+					     bytesRead, fromAddresses, timesReceived);
+  for (int i = 0; i < numRead; ++i) {
+    // Datagrams may have been dropped (truncated, or filtered by SSM), reordering "buffers";
+    // put the packets in the same order, so that packets[i] holds the i'th datagram read:
+    if (packets[i]->fBuf != buffers[i]) {
+      for (unsigned j = i + 1; j < numPackets; ++j) {
+	if (packets[j]->fBuf == buffers[i]) {
+	  BufferedPacket* packet = packets[i];
+	  packets[i] = packets[j];
+	  packets[j] = packet;
+	  break;
+	}
+      }
+    }
+    packets[i]->fTail = bytesRead[i];
+  }
+  return numRead;
+}
+
 void BufferedPacket
 ::assignMiscParams(unsigned short rtpSeqNo, unsigned rtpTimestamp,
 		   struct timeval presentationTime,
@@ -484,7 +740,10 @@ BufferedPacket* BufferedPacketFactory
 ReorderingPacketBuffer
 ::ReorderingPacketBuffer(BufferedPacketFactory* packetFactory)
   : fThresholdTime(100000) /* default reordering threshold: 100 ms */,
-    fHaveSeenFirstPacket(False), fHeadPacket(NULL), fTailPacket(NULL), fSavedPacket(NULL), fSavedPacketFree(True) {
+    fHaveSeenFirstPacket(False), fHeadPacket(NULL), fTailPacket(NULL), fSavedPacket(NULL), fSavedPacketFree(True),
+    fFreePackets(NULL), fNumFreePackets(0),
+    fMaxReorderingDelay(0), fMaxReorderingDepth(0),
+    fNumReorderedPackets(0), fNumLatePackets(0), fHaveSkippedPackets(False) {
   fPacketFactory = (packetFactory == NULL)
     ? (new BufferedPacketFactory)
     : packetFactory;
@@ -492,6 +751,7 @@ ReorderingPacketBuffer
 
 ReorderingPacketBuffer::~ReorderingPacketBuffer() {
   reset();
+  delete fFreePackets; // will also delete the rest of the free packets
   delete fPacketFactory;
 }
 
@@ -500,6 +760,24 @@ void ReorderingPacketBuffer::reset() {
   delete fHeadPacket; // will also delete fSavedPacket if it's in the list
   resetHaveSeenFirstPacket();
   fHeadPacket = fTailPacket = fSavedPacket = NULL;
+  fHaveSkippedPackets = False;
+}
+
+void ReorderingPacketBuffer::takeReorderingSamples(unsigned& maxDelay, unsigned& maxDepth) {
+  maxDelay = fMaxReorderingDelay;
+  maxDepth = fMaxReorderingDepth;
+  fMaxReorderingDelay = fMaxReorderingDepth = 0;
+}
+
+void ReorderingPacketBuffer
+::noteReordering(struct timeval const& timeReceived, struct timeval const& refTime,
+		 unsigned depth) {
+  // "refTime" is when the first packet following this one (in sequence) arrived,
+  // so the difference is how long we'd have to wait for this packet:
+  int delay = (timeReceived.tv_sec - refTime.tv_sec)*1000000
+    + (timeReceived.tv_usec - refTime.tv_usec);
+  if (delay > 0 && (unsigned)delay > fMaxReorderingDelay) fMaxReorderingDelay = delay;
+  if (depth > fMaxReorderingDepth) fMaxReorderingDepth = depth;
 }
 
 BufferedPacket* ReorderingPacketBuffer::getFreePacket(MultiFramedRTPSource* ourSource) {
@@ -511,6 +789,12 @@ BufferedPacket* ReorderingPacketBuffer::getFreePacket(MultiFramedRTPSource* ourS
   if (fSavedPacketFree == True) {
     fSavedPacketFree = False;
     return fSavedPacket;
+  } else if (fFreePackets != NULL) {
+    BufferedPacket* packet = fFreePackets;
+    fFreePackets = packet->nextPacket();
+    packet->nextPacket() = NULL;
+    --fNumFreePackets;
+    return packet;
   } else {
     return fPacketFactory->createNewPacket(ourSource);
   }
@@ -527,7 +811,16 @@ Boolean ReorderingPacketBuffer::storePacket(BufferedPacket* bPacket) {
 
   // Ignore this packet if its sequence number is less than the one
   // that we're looking for (in this case, it's been excessively delayed).
-  if (seqNumLT(rtpSeqNo, fNextExpectedSeqNo)) return False;
+  if (seqNumLT(rtpSeqNo, fNextExpectedSeqNo)) {
+    if (fHaveSkippedPackets && !seqNumLT(rtpSeqNo, fSkippedSeqNoBegin)
+	&& seqNumLT(rtpSeqNo, fSkippedSeqNoEnd)) {
+      // We gave up waiting for this packet (rather than it being a duplicate):
+      ++fNumLatePackets;
+      noteReordering(bPacket->timeReceived(), fSkippedTime,
+		     (unsigned short)(fNextExpectedSeqNo - rtpSeqNo));
+    }
+    return False;
+  }
 
   if (fTailPacket == NULL) {
     // Common case: There are no packets in the queue; this will be the first one:
@@ -563,6 +856,11 @@ Boolean ReorderingPacketBuffer::storePacket(BufferedPacket* bPacket) {
     afterPtr = afterPtr->nextPacket();
   }
 
+  // ASSERT: afterPtr != NULL, because this packet comes before the tail packet
+  ++fNumReorderedPackets;
+  noteReordering(bPacket->timeReceived(), afterPtr->timeReceived(),
+		 (unsigned short)(fTailPacket->rtpSeqNo() - rtpSeqNo));
+
   // Link our new packet between "beforePtr" and "afterPtr":
   bPacket->nextPacket() = afterPtr;
   if (beforePtr == NULL) {
@@ -589,7 +887,8 @@ void ReorderingPacketBuffer::releaseUsedPacket(BufferedPacket* packet) {
 }
 
 BufferedPacket* ReorderingPacketBuffer
-::getNextCompletedPacket(Boolean& packetLossPreceded) {
+::getNextCompletedPacket(Boolean& packetLossPreceded, unsigned& numPacketsLost) {
+  numPacketsLost = 0;
   if (fHeadPacket == NULL) return NULL;
 
   // Check whether the next packet we want is already at the head
@@ -616,6 +915,13 @@ BufferedPacket* ReorderingPacketBuffer
     timeThresholdHasBeenExceeded = uSecondsSinceReceived > fThresholdTime;
   }
   if (timeThresholdHasBeenExceeded) {
+    // Remember the packets skipped, to detect them if they arrive late:
+    fHaveSkippedPackets = True;
+    fSkippedSeqNoBegin = fNextExpectedSeqNo;
+    fSkippedSeqNoEnd = fHeadPacket->rtpSeqNo();
+    fSkippedTime = fHeadPacket->timeReceived();
+    numPacketsLost = (unsigned short)(fSkippedSeqNoEnd - fSkippedSeqNoBegin);
+
     fNextExpectedSeqNo = fHeadPacket->rtpSeqNo();
         // we've given up on earlier packets now
     packetLossPreceded = True;
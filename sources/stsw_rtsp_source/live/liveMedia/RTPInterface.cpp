@@ -295,6 +295,20 @@ Boolean RTPInterface::handleRead(unsigned char* buffer, unsigned bufferMaxSize,
   return readSuccess;
 }
 
+int RTPInterface::handleReadBatch(unsigned char** buffers, unsigned bufferMaxSize, unsigned numBuffers,
+				  unsigned* bytesRead, struct sockaddr_in* fromAddresses,
+				  struct timeval* timesReceived) {
+  int numRead = fGS->handleReadBatch(buffers, bufferMaxSize, numBuffers,
+				     bytesRead, fromAddresses, timesReceived);
+  if (fAuxReadHandlerFunc != NULL) {
+    for (int i = 0; i < numRead; ++i) {
+      // Also pass the newly-read packet data to our auxilliary handler:
+      (*fAuxReadHandlerFunc)(fAuxReadHandlerClientData, buffers[i], bytesRead[i]);
+    }
+  }
+  return numRead;
+}
+
 void RTPInterface::stopNetworkReading() {
   // Normal case
   envir().taskScheduler().turnOffBackgroundReadHandling(fGS->socketNum());
@@ -103,7 +103,8 @@ void RTPReceptionStatsDB
 		     Boolean useForJitterCalculation,
 		     struct timeval& resultPresentationTime,
 		     Boolean& resultHasBeenSyncedUsingRTCP,
-		     unsigned packetSize) {
+		     unsigned packetSize,
+		     struct timeval const* timeReceived) {
   ++fTotNumPacketsReceived;
   RTPReceptionStats* stats = lookup(SSRC);
   if (stats == NULL) {
@@ -121,7 +122,7 @@ void RTPReceptionStatsDB
   stats->noteIncomingPacket(seqNum, rtpTimestamp, timestampFrequency,
 			    useForJitterCalculation,
 			    resultPresentationTime,
-			    resultHasBeenSyncedUsingRTCP, packetSize);
+			    resultHasBeenSyncedUsingRTCP, packetSize, timeReceived);
 }
 
 void RTPReceptionStatsDB
@@ -234,7 +235,8 @@ void RTPReceptionStats
 		     Boolean useForJitterCalculation,
 		     struct timeval& resultPresentationTime,
 		     Boolean& resultHasBeenSyncedUsingRTCP,
-		     unsigned packetSize) {
+		     unsigned packetSize,
+		     struct timeval const* timeReceived) {
   if (!fHaveSeenInitialSequenceNumber) initSeqNum(seqNum);
 
   ++fNumPacketsReceivedSinceLastReset;
@@ -278,7 +280,11 @@ void RTPReceptionStats
 
   // Record the inter-packet delay
   struct timeval timeNow;
-  gettimeofday(&timeNow, NULL);
+  if (timeReceived != NULL) {
+    timeNow = *timeReceived;
+  } else {
+    gettimeofday(&timeNow, NULL);
+  }
   if (fLastPacketReceptionTime.tv_sec != 0
       || fLastPacketReceptionTime.tv_usec != 0) {
     unsigned gap
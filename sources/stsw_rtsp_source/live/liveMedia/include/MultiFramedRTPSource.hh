@@ -30,6 +30,32 @@ class BufferedPacket; // forward
 class BufferedPacketFactory; // forward
 
 class MultiFramedRTPSource: public RTPSource {
+public:
+  // Adaptive packet reordering threshold.  Once a range is set, the reordering
+  // threshold time is chosen within [minUSeconds, maxUSeconds], from the
+  // measured reordering delay and interarrival jitter of the incoming packets.
+  // ("setPacketReorderingThresholdTime()" sets a fixed threshold again.)
+  void setPacketReorderingThresholdRange(unsigned minUSeconds, unsigned maxUSeconds);
+
+  unsigned packetReorderingThresholdTime() const; // in microseconds
+  unsigned packetReorderingDelay() const { return fReorderingDelay; } // estimated, in microseconds
+  unsigned packetReorderingDepth() const { return fReorderingDepth; } // in packets
+  unsigned packetJitter() const { return fJitterUSeconds; } // interarrival jitter, in microseconds
+  unsigned long numReorderedPackets() const;
+  unsigned long numLatePackets() const;
+      // packets that arrived after we'd given up waiting for them
+
+  // Loss accounting, from the RTP sequence numbers, timestamps and marker bits
+  // of the packets as they're delivered (a 'frame' here is the set of packets
+  // sharing a RTP timestamp):
+  unsigned long numLostPackets() const { return fNumLostPackets; }
+  unsigned long numLostFrames() const { return fNumLostFrames; }
+      // frames none of whose packets were received (estimated from the gaps)
+  unsigned long numDamagedFrames() const { return fNumDamagedFrames; }
+      // frames that were only partially received
+  Boolean curFrameIsDamaged() const { return fCurFrameDamaged; }
+      // whether packet loss has been seen in the frame being delivered
+
 protected:
   MultiFramedRTPSource(UsageEnvironment& env, Groupsock* RTPgs,
 		       unsigned char rtpPayloadFormat,
@@ -66,6 +92,11 @@ private:
 
   static void networkReadHandler(MultiFramedRTPSource* source, int /*mask*/);
   void networkReadHandler1();
+  void networkReadBatch();
+  Boolean processIncomingPacket(BufferedPacket* bPacket, struct sockaddr_in& fromAddress,
+				struct timeval const* timeReceived);
+  void adaptReorderingThreshold(struct timeval const& timeNow);
+  void noteDeliveredPacket(BufferedPacket* packet, unsigned numPacketsLost);
 
   Boolean fAreDoingNetworkReads;
   BufferedPacket* fPacketReadInProgress;
@@ -73,9 +104,27 @@ private:
   Boolean fPacketLossInFragmentedFrame;
   unsigned char* fSavedTo;
   unsigned fSavedMaxSize;
+  unsigned fReadBatchSize; // the number of UDP packets to read at once, adapted to the incoming rate
 
   // A buffer to (optionally) hold incoming pkts that have been reorderered
   class ReorderingPacketBuffer* fReorderingBuffer;
+
+  // State used for the adaptive reordering threshold:
+  unsigned fMinReorderingThreshold, fMaxReorderingThreshold; // uSeconds
+  unsigned fReorderingDelay; // uSeconds
+  unsigned fReorderingDepth;
+  unsigned fJitterUSeconds;
+  struct timeval fLastReorderingAdaptTime;
+
+  // State used for the loss accounting:
+  Boolean fHaveCurFrame;
+  unsigned fCurFrameRTPTimestamp;
+  unsigned fCurFrameNumPackets;
+  Boolean fCurFrameDamaged;
+  Boolean fCurFrameCompleted; // its last packet so far had the marker bit
+  Boolean fMarkerBitEndsFrame; // whether the marker bit ends frames in this stream
+  unsigned fPacketsPerFrame; // average of the intact frames, in 1/16 packets
+  unsigned long fNumLostPackets, fNumLostFrames, fNumDamagedFrames;
 };
 
 
@@ -92,6 +141,10 @@ public:
   unsigned useCount() const { return fUseCount; }
 
   Boolean fillInData(RTPInterface& rtpInterface, struct sockaddr_in& fromAddress, Boolean& packetReadWasIncomplete);
+  static int fillInDataBatch(RTPInterface& rtpInterface, BufferedPacket** packets, unsigned numPackets,
+			     struct sockaddr_in* fromAddresses, struct timeval* timesReceived);
+      // Reads up to "numPackets" UDP packets at once; returns the number read, or -1 on error.
+      // "packets" is reordered so that the first ones hold the packets read.
   void assignMiscParams(unsigned short rtpSeqNo, unsigned rtpTimestamp,
 			struct timeval presentationTime,
 			Boolean hasBeenSyncedUsingRTCP,
@@ -108,6 +161,7 @@ public:
   BufferedPacket*& nextPacket() { return fNextPacket; }
 
   unsigned short rtpSeqNo() const { return fRTPSeqNo; }
+  unsigned rtpTimestamp() const { return fRTPTimestamp; }
   struct timeval const& timeReceived() const { return fTimeReceived; }
 
   unsigned char* data() const { return &fBuf[fHead]; }
@@ -79,6 +79,14 @@ public:
   // Otherwise (if "tcpSocketNum" >= 0), the packet was received (interleaved) over TCP, and
   //   "tcpStreamChannelId" will return the channel id.
 
+  Boolean nextReadIsFromTCP() const { return fNextTCPReadStreamSocketNum >= 0; }
+  int handleReadBatch(unsigned char** buffers, unsigned bufferMaxSize, unsigned numBuffers,
+		      // out parameters:
+		      unsigned* bytesRead, struct sockaddr_in* fromAddresses,
+		      struct timeval* timesReceived);
+  // Reads up to "numBuffers" packets from the (datagram) 'groupsock' at once.  Must not be called
+  //   if "nextReadIsFromTCP()".  Returns the number of packets read, or -1 on error.
+
   void stopNetworkReading();
 
   UsageEnvironment& envir() const { return fOwner->envir(); }
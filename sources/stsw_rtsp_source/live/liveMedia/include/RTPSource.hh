@@ -151,7 +151,8 @@ public:
 			  Boolean useForJitterCalculation,
 			  struct timeval& resultPresentationTime,
 			  Boolean& resultHasBeenSyncedUsingRTCP,
-			  unsigned packetSize /* payload only */);
+			  unsigned packetSize /* payload only */,
+			  struct timeval const* timeReceived = NULL /* NULL means now */);
 
   // The following is called whenever a RTCP SR packet is received:
   void noteIncomingSR(u_int32_t SSRC,
@@ -228,7 +229,8 @@ private:
 			  Boolean useForJitterCalculation,
 			  struct timeval& resultPresentationTime,
 			  Boolean& resultHasBeenSyncedUsingRTCP,
-			  unsigned packetSize /* payload only */);
+			  unsigned packetSize /* payload only */,
+			  struct timeval const* timeReceived = NULL /* NULL means now */);
   void noteIncomingSR(u_int32_t ntpTimestampMSW, u_int32_t ntpTimestampLSW,
 		      u_int32_t rtpTimestamp);
   void init(u_int32_t SSRC);
@@ -0,0 +1,261 @@
+/**
+ * This file is part of stsw_rtsp_source, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * epoll_scheduler_bench.cc
+ *      a sample to measure the socket dispatch cost of EpollTaskScheduler
+ * against live555's select() based BasicTaskScheduler: N UDP sockets are
+ * registered on the scheduler, and in each round a few of them receive a
+ * datagram and the event loop runs until all of them are handled, like
+ * a scheduler thread serving N RTP sessions of which only some are
+ * active at a time.
+ *
+ * author: OpenSight Team
+ * date: 2016-4-23
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <vector>
+
+#include "BasicUsageEnvironment.hh"
+#include "stsw_epoll_task_scheduler.h"
+
+
+///////////////////////////////////////////////////////////////
+//macro
+
+#define BENCH_ACTIVE_SOCKETS 10     // readable sockets per round
+#define BENCH_DEFAULT_ROUNDS 20000
+
+
+///////////////////////////////////////////////////////////////
+//Type
+
+struct BenchContext{
+    TaskScheduler * scheduler;
+    int handled;
+    int expected;
+    char watch;
+};
+
+struct BenchSocket{
+    BenchContext * ctx;
+    int fd;
+    struct sockaddr_in addr;
+};
+
+
+///////////////////////////////////////////////////////////////
+//functions
+
+static long long MonotonicNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void ReadHandler(void * client_data, int mask)
+{
+    BenchSocket * sock = (BenchSocket *)client_data;
+    char buf[64];
+
+    if(recv(sock->fd, buf, sizeof(buf), 0) > 0){
+        sock->ctx->handled++;
+        if(sock->ctx->handled >= sock->ctx->expected){
+            sock->ctx->watch = 1;
+        }
+    }
+}
+
+static int OpenSockets(int num, std::vector<BenchSocket> *socks)
+{
+    socklen_t len;
+    int i;
+
+    socks->resize(num);
+    for(i = 0; i < num; i++){
+        BenchSocket &s = (*socks)[i];
+        s.fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if(s.fd < 0){
+            fprintf(stderr, "socket() failed at %d: %s\n", i, strerror(errno));
+            socks->resize(i);
+            return -1;
+        }
+        memset(&s.addr, 0, sizeof(s.addr));
+        s.addr.sin_family = AF_INET;
+        s.addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        s.addr.sin_port = 0;
+        len = sizeof(s.addr);
+        if(bind(s.fd, (struct sockaddr *)&s.addr, sizeof(s.addr)) ||
+           getsockname(s.fd, (struct sockaddr *)&s.addr, &len)){
+            fprintf(stderr, "bind() failed at %d: %s\n", i, strerror(errno));
+            close(s.fd);
+            socks->resize(i);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void CloseSockets(std::vector<BenchSocket> *socks)
+{
+    std::vector<BenchSocket>::iterator it;
+    for(it = socks->begin(); it != socks->end(); it++){
+        close(it->fd);
+    }
+    socks->clear();
+}
+
+// return the average ns per round, or -1 on error
+static double RunBench(TaskScheduler * scheduler, int sender,
+                       std::vector<BenchSocket> *socks, int rounds)
+{
+    BenchContext ctx;
+    int num = (int)socks->size();
+    int active = num < BENCH_ACTIVE_SOCKETS ? num : BENCH_ACTIVE_SOCKETS;
+    int stride = num / active;
+    long long start, elapsed;
+    int r, i;
+
+    ctx.scheduler = scheduler;
+    for(i = 0; i < num; i++){
+        (*socks)[i].ctx = &ctx;
+        scheduler->setBackgroundHandling((*socks)[i].fd, SOCKET_READABLE,
+                                         ReadHandler, &(*socks)[i]);
+    }
+
+    start = MonotonicNs();
+    for(r = 0; r < rounds; r++){
+        ctx.handled = 0;
+        ctx.expected = active;
+        ctx.watch = 0;
+        for(i = 0; i < active; i++){
+            BenchSocket &s = (*socks)[(i * stride + r) % num];
+            if(sendto(sender, "x", 1, 0,
+                      (struct sockaddr *)&s.addr, sizeof(s.addr)) != 1){
+                fprintf(stderr, "sendto() failed: %s\n", strerror(errno));
+                return -1;
+            }
+        }
+        scheduler->doEventLoop(&ctx.watch);
+    }
+    elapsed = MonotonicNs() - start;
+
+    for(i = 0; i < num; i++){
+        scheduler->disableBackgroundHandling((*socks)[i].fd);
+    }
+    return (double)elapsed / rounds;
+}
+
+static void RaiseFileLimit(int num)
+{
+    struct rlimit rl;
+    if(getrlimit(RLIMIT_NOFILE, &rl) == 0 &&
+       rl.rlim_cur < (rlim_t)num + 64){
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+}
+
+
+///////////////////////////////////////////////////////////////
+//main entry
+int main(int argc, char *argv[])
+{
+    static const int socket_nums[] = {10, 1000, 10000};
+    std::vector<BenchSocket> socks;
+    int rounds = BENCH_DEFAULT_ROUNDS;
+    int sender;
+    unsigned i;
+
+    if(argc > 1){
+        rounds = strtol(argv[1], NULL, 0);
+    }
+    if(rounds <= 0){
+        fprintf(stderr, "Usage: epoll_scheduler_bench [rounds]\n");
+        return 1;
+    }
+
+    RaiseFileLimit(socket_nums[2]);
+    sender = socket(AF_INET, SOCK_DGRAM, 0);
+    if(sender < 0){
+        fprintf(stderr, "socket() failed: %s\n", strerror(errno));
+        return 1;
+    }
+
+    fprintf(stderr, "%d rounds, %d readable sockets per round\n",
+            rounds, BENCH_ACTIVE_SOCKETS);
+    fprintf(stderr, "%8s %16s %16s\n", "sockets", "select us/round",
+            "epoll us/round");
+
+    for(i = 0; i < sizeof(socket_nums) / sizeof(socket_nums[0]); i++){
+        int num = socket_nums[i];
+        double basic_ns = -1.0, epoll_ns = -1.0;
+        TaskScheduler * scheduler;
+
+        if(OpenSockets(num, &socks)){
+            CloseSockets(&socks);
+            break;
+        }
+
+        // select() cannot watch a fd beyond FD_SETSIZE
+        if(socks.back().fd < FD_SETSIZE){
+            scheduler = BasicTaskScheduler::createNew();
+            basic_ns = RunBench(scheduler, sender, &socks, rounds);
+            delete scheduler;
+        }
+
+        scheduler = EpollTaskScheduler::createNew();
+        if(scheduler != NULL){
+            epoll_ns = RunBench(scheduler, sender, &socks, rounds);
+            delete scheduler;
+        }
+
+        fprintf(stderr, "%8d ", num);
+        if(basic_ns >= 0){
+            fprintf(stderr, "%16.2f ", basic_ns / 1000.0);
+        }else{
+            fprintf(stderr, "%16s ", "n/a");
+        }
+        if(epoll_ns >= 0){
+            fprintf(stderr, "%16.2f\n", epoll_ns / 1000.0);
+        }else{
+            fprintf(stderr, "%16s\n", "n/a");
+        }
+
+        CloseSockets(&socks);
+    }
+
+    close(sender);
+    return 0;
+}
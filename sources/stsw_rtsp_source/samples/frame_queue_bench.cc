@@ -0,0 +1,316 @@
+/**
+ * This file is part of stsw_rtsp_source, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * frame_queue_bench.cc
+ *      a sample to measure the allocation and copy cost of the frame queue
+ * of MediaOutputSink: bursts of frames are received into the sink's frame
+ * buffer, queued by PushOneFrame() and flushed by FlushQueue(), which
+ * recycles the buffers through GetFrameBuf() / PutFrameBuf(). The old
+ * queue, which copied each frame into a new char[], is measured alongside
+ * as the baseline.
+ *
+ * author: OpenSight Team
+ * date: 2016-4-23
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <new>
+#include <list>
+
+#include "BasicUsageEnvironment.hh"
+#include "stsw_output_sink.h"
+
+
+///////////////////////////////////////////////////////////////
+//macro
+
+#define BENCH_DEFAULT_BURST 4         // frames queued before each flush
+#define BENCH_DEFAULT_ROUNDS 20000
+#define BENCH_SINK_BUF_SIZE 8388608   // the same as the video sink
+#define BENCH_SINK_RECV_SIZE 1048576
+#define BENCH_SINK_CHUNK_SIZE 131072
+
+
+///////////////////////////////////////////////////////////////
+//allocation counters
+
+#if __cplusplus < 201103L
+#define BENCH_THROW_BAD_ALLOC throw(std::bad_alloc)
+#define BENCH_NOTHROW throw()
+#else
+#define BENCH_THROW_BAD_ALLOC
+#define BENCH_NOTHROW noexcept
+#endif
+
+static unsigned long long alloc_count = 0;
+static unsigned long long alloc_bytes = 0;
+
+void * operator new(size_t size) BENCH_THROW_BAD_ALLOC
+{
+    void * p = malloc(size != 0 ? size : 1);
+    if(p == NULL){
+        throw std::bad_alloc();
+    }
+    alloc_count++;
+    alloc_bytes += size;
+    return p;
+}
+
+void * operator new[](size_t size) BENCH_THROW_BAD_ALLOC
+{
+    return operator new(size);
+}
+
+void operator delete(void * p) BENCH_NOTHROW
+{
+    free(p);
+}
+
+void operator delete[](void * p) BENCH_NOTHROW
+{
+    free(p);
+}
+
+
+///////////////////////////////////////////////////////////////
+//Type
+
+// exposes the frame buffer of MediaOutputSink to fill it like the RTP
+// source does
+class BenchOutputSink: public MediaOutputSink {
+public:
+    BenchOutputSink(UsageEnvironment& env, size_t sink_buf_size,
+                    size_t sink_recv_size, size_t sink_chunk_size)
+    : MediaOutputSink(env, NULL, NULL, 0, sink_buf_size, sink_recv_size,
+                      sink_chunk_size)
+    {
+    }
+
+    bool ReceiveFrame(const uint8_t * data, unsigned size,
+                      struct timeval pts)
+    {
+        size_t free_size = 0;
+        uint8_t * pos = frame_buf_->GetWritePos(size, &free_size);
+        if(pos == NULL || free_size < size){
+            return false;
+        }
+        memcpy(pos, data, size);
+        PushOneFrame(stream_switch::MEDIA_FRAME_TYPE_DATA_FRAME, pts, size);
+        return true;
+    }
+};
+
+// the queue before the frames were queued by reference
+struct CopyFrameBuf{
+    stream_switch::MediaFrameType frame_type;
+    struct timeval presentation_time;
+    char * buf;
+    size_t frame_size;
+};
+typedef std::list<CopyFrameBuf> CopyFrameQueue;
+
+struct BenchResult{
+    double ns_per_frame;
+    double allocs_per_frame;
+    double alloc_bytes_per_frame;
+    double copy_bytes_per_frame;
+};
+
+
+///////////////////////////////////////////////////////////////
+//functions
+
+static long long MonotonicNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int RunRefQueue(UsageEnvironment * env, const uint8_t * data,
+                       unsigned frame_size, int burst, int rounds,
+                       BenchResult * result)
+{
+    BenchOutputSink * sink = new BenchOutputSink(*env, BENCH_SINK_BUF_SIZE,
+                                                 BENCH_SINK_RECV_SIZE,
+                                                 BENCH_SINK_CHUNK_SIZE);
+    unsigned long long count, bytes;
+    struct timeval pts = {0, 0};
+    long long start;
+    int r, i;
+
+    count = alloc_count;
+    bytes = alloc_bytes;
+    start = MonotonicNs();
+    for(r = 0; r < rounds; r++){
+        for(i = 0; i < burst; i++){
+            pts.tv_usec++;
+            if(!sink->ReceiveFrame(data, frame_size, pts)){
+                fprintf(stderr, "frame of %u bytes rejected\n", frame_size);
+                Medium::close(sink);
+                return -1;
+            }
+        }
+        sink->FlushQueue();
+    }
+    result->ns_per_frame =
+        (double)(MonotonicNs() - start) / rounds / burst;
+    result->allocs_per_frame =
+        (double)(alloc_count - count) / rounds / burst;
+    result->alloc_bytes_per_frame =
+        (double)(alloc_bytes - bytes) / rounds / burst;
+    result->copy_bytes_per_frame = 0;
+
+    Medium::close(sink);
+    return 0;
+}
+
+static int RunCopyQueue(const uint8_t * data, unsigned frame_size,
+                        int burst, int rounds, BenchResult * result)
+{
+    FrameChunkBuf frame_buf(BENCH_SINK_CHUNK_SIZE, BENCH_SINK_BUF_SIZE);
+    std::vector<stream_switch::MediaFrameSegment> segments;
+    CopyFrameQueue frame_queue;
+    CopyFrameQueue::iterator it;
+    unsigned long long count, bytes, copy_bytes = 0;
+    struct timeval pts = {0, 0};
+    long long start;
+    int r, i;
+
+    count = alloc_count;
+    bytes = alloc_bytes;
+    start = MonotonicNs();
+    for(r = 0; r < rounds; r++){
+        for(i = 0; i < burst; i++){
+            CopyFrameBuf temp_frame;
+            size_t free_size = 0;
+            uint8_t * pos = frame_buf.GetWritePos(frame_size, &free_size);
+            if(pos == NULL || free_size < frame_size){
+                fprintf(stderr, "frame of %u bytes rejected\n", frame_size);
+                return -1;
+            }
+            memcpy(pos, data, frame_size);
+            frame_buf.Commit(frame_size);
+            pts.tv_usec++;
+
+            // the frame is copied out of the receive buffer
+            temp_frame.frame_type = stream_switch::MEDIA_FRAME_TYPE_DATA_FRAME;
+            temp_frame.presentation_time = pts;
+            temp_frame.frame_size = frame_size;
+            temp_frame.buf = new char[frame_size];
+            memcpy(temp_frame.buf, pos, frame_size);
+            copy_bytes += frame_size;
+            frame_queue.push_back(temp_frame);
+            frame_buf.Clear();
+        }
+        for(it = frame_queue.begin(); it != frame_queue.end(); it++){
+            delete[] it->buf;
+        }
+        frame_queue.clear();
+    }
+    result->ns_per_frame =
+        (double)(MonotonicNs() - start) / rounds / burst;
+    result->allocs_per_frame =
+        (double)(alloc_count - count) / rounds / burst;
+    result->alloc_bytes_per_frame =
+        (double)(alloc_bytes - bytes) / rounds / burst;
+    result->copy_bytes_per_frame =
+        (double)copy_bytes / rounds / burst;
+    return 0;
+}
+
+static void PrintResult(const char * name, unsigned frame_size,
+                        const BenchResult * result)
+{
+    fprintf(stderr, "%8u %6s %12.1f %12.3f %14.1f %14.1f\n",
+            frame_size, name, result->ns_per_frame,
+            result->allocs_per_frame, result->alloc_bytes_per_frame,
+            result->copy_bytes_per_frame);
+}
+
+
+///////////////////////////////////////////////////////////////
+//main entry
+int main(int argc, char *argv[])
+{
+    static const unsigned frame_sizes[] = {200, 4096, 65536, 500000};
+    int burst = BENCH_DEFAULT_BURST;
+    int rounds = BENCH_DEFAULT_ROUNDS;
+    TaskScheduler * scheduler;
+    UsageEnvironment * env;
+    uint8_t * data;
+    BenchResult copy_result, ref_result;
+    unsigned i;
+    int ret = 0;
+
+    if(argc > 1){
+        burst = strtol(argv[1], NULL, 0);
+    }
+    if(argc > 2){
+        rounds = strtol(argv[2], NULL, 0);
+    }
+    if(burst <= 0 || rounds <= 0){
+        fprintf(stderr, "Usage: frame_queue_bench [burst] [rounds]\n");
+        return 1;
+    }
+
+    scheduler = BasicTaskScheduler::createNew();
+    env = BasicUsageEnvironment::createNew(*scheduler);
+
+    data = new uint8_t[frame_sizes[3]];
+    for(i = 0; i < frame_sizes[3]; i++){
+        data[i] = (uint8_t)(i * 7);
+    }
+
+    fprintf(stderr, "%d rounds, %d frames queued per flush\n",
+            rounds, burst);
+    if(burst > MAX_FREE_FRAME_BUF_NUM){
+        fprintf(stderr, "(longer than the free list of %d frame buffers "
+                "kept by the sink)\n", MAX_FREE_FRAME_BUF_NUM);
+    }
+    fprintf(stderr, "%8s %6s %12s %12s %14s %14s\n", "size", "queue",
+            "ns/frame", "allocs/frame", "alloc B/frame", "copy B/frame");
+
+    for(i = 0; i < sizeof(frame_sizes) / sizeof(frame_sizes[0]); i++){
+        // the larger frames need less rounds for a stable result
+        int frame_rounds = frame_sizes[i] > 65536 ? rounds / 10 + 1 : rounds;
+
+        if(RunCopyQueue(data, frame_sizes[i], burst, frame_rounds,
+                        &copy_result) ||
+           RunRefQueue(env, data, frame_sizes[i], burst, frame_rounds,
+                       &ref_result)){
+            ret = 1;
+            break;
+        }
+        PrintResult("copy", frame_sizes[i], &copy_result);
+        PrintResult("ref", frame_sizes[i], &ref_result);
+    }
+
+    delete[] data;
+    env->reclaim();
+    delete scheduler;
+    return ret;
+}
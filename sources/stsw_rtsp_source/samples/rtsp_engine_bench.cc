@@ -0,0 +1,705 @@
+/**
+ * This file is part of stsw_rtsp_source, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * rtsp_engine_bench.cc
+ *      a sample to measure the CPU cost of the RTSP client engines: a
+ * loopback RTSP server thread streams a H264 video over TCP-interleaved
+ * RTP in real time, which is received by LiveRtspClient (the live555
+ * chain) and then by LiteRtspClient. The CPU time of the event loop
+ * thread in the steady state is reported for each engine.
+ *      With the sessions and threads arguments, N streams are received
+ * at once by M event loop threads, each with its own TaskScheduler like
+ * RtspSchedulerThread, to measure how the engines scale on the cores.
+ *
+ * author: OpenSight Team
+ * date: 2016-4-23
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <string>
+
+#include "BasicUsageEnvironment.hh"
+#include "Base64.hh"
+#include "stsw_rtsp_client.h"
+#include "stsw_lite_rtsp_client.h"
+
+
+///////////////////////////////////////////////////////////////
+//macro
+
+#define BENCH_DEFAULT_BITRATE   8000    // kbps
+#define BENCH_DEFAULT_FPS       30
+#define BENCH_DEFAULT_DURATION  10      // sec, the measured period
+#define BENCH_MAX_SESSIONS      256     // 3-5 fds each, select() stops at FD_SETSIZE
+#define BENCH_WARMUP_TIME       2       // sec, not measured
+#define BENCH_RTP_MAX_PAYLOAD   1400
+#define BENCH_RTP_CLOCK         90000
+#define BENCH_KEY_FRAME_RATIO   4       // key frame size / average size
+
+
+///////////////////////////////////////////////////////////////
+//Type
+
+struct BenchConfig{
+    unsigned bitrate;       // kbps
+    unsigned fps;
+    unsigned duration;      // sec
+    unsigned sessions;      // the streams received at once
+    unsigned threads;       // the event loop threads they are spread on
+};
+
+struct BenchServer{
+    const BenchConfig * config;
+    int listen_fd;
+    int port;
+    int conn_fd;
+    volatile int stop;
+    pthread_t thread_id;
+
+    // RTP state
+    uint16_t seq;
+    uint8_t packet[4 + 12 + BENCH_RTP_MAX_PAYLOAD];
+    uint8_t payload[BENCH_RTP_MAX_PAYLOAD];
+};
+
+// count the frames of a stream, and stop the event loop on error
+class BenchListener: public LiveRtspClientListener{
+public:
+    BenchListener()
+    : frames(0), bytes(0), errors(0), watch(NULL)
+    {
+    }
+
+    virtual void OnMediaFrame(const stream_switch::MediaFrameInfo &frame_info,
+                              const stream_switch::MediaFrameSegment * segments,
+                              int segment_num)
+    {
+        int i;
+        frames++;
+        for(i = 0; i < segment_num; i++){
+            bytes += segments[i].size;
+        }
+    }
+    virtual void OnError(RtspClientErrCode err_code, const char * err_info)
+    {
+        fprintf(stderr, "RTSP client error (%d): %s\n", (int)err_code,
+                err_info != NULL ? err_info : "");
+        errors++;
+        *watch = 1;
+    }
+    virtual void OnMetaReady(const stream_switch::StreamMetadata &metadata)
+    {
+    }
+    virtual void OnRtspOK()
+    {
+    }
+    virtual void OnLostFrameUpdate(int32_t sub_stream_index, uint64_t lost_frame)
+    {
+    }
+    virtual void OnRtpStatisticUpdate(const RtpRecvStatistic &statistic)
+    {
+    }
+    virtual void OnReconnecting(RtspClientErrCode err_code, const char * err_info,
+                                unsigned retry_interval)
+    {
+        OnError(err_code, err_info);
+    }
+
+    uint64_t frames;
+    uint64_t bytes;
+    int errors;
+    char * watch;
+};
+
+// an event loop thread and the streams it receives, the CPU time of the
+// thread is taken at the begin and end of the measured period
+struct BenchLoop{
+    const BenchConfig * config;
+    bool lite;
+    unsigned session_num;
+    BenchServer * servers;
+    BenchListener * listeners;
+    char watch;
+    int ret;
+    pthread_t thread_id;
+
+    uint64_t start_frames;
+    uint64_t start_bytes;
+    long long start_cpu_ns;
+    long long start_wall_ns;
+    uint64_t end_frames;
+    uint64_t end_bytes;
+    long long end_cpu_ns;
+    long long end_wall_ns;
+};
+
+
+///////////////////////////////////////////////////////////////
+//global variables
+
+static const uint8_t bench_sps[] = {
+    0x67, 0x42, 0xc0, 0x1e, 0xda, 0x02, 0x80, 0xbf,
+    0xe5, 0x84, 0x00, 0x00, 0x03, 0x00, 0x04, 0x00,
+    0x00, 0x03, 0x00, 0xca, 0x3c, 0x58, 0xba, 0x80
+};
+static const uint8_t bench_pps[] = {
+    0x68, 0xce, 0x3c, 0x80
+};
+
+
+///////////////////////////////////////////////////////////////
+//functions
+
+static long long ClockNs(clockid_t clock_id)
+{
+    struct timespec ts;
+    clock_gettime(clock_id, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int SendAll(int fd, const void * buf, size_t size)
+{
+    const char * pos = (const char *)buf;
+    while(size > 0){
+        ssize_t ret = send(fd, pos, size, MSG_NOSIGNAL);
+        if(ret < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            return -1;
+        }
+        pos += ret;
+        size -= ret;
+    }
+    return 0;
+}
+
+// read and discard the data from the client (RTCP, keep-alive and
+// TEARDOWN) until the deadline, return -1 if the connection is closed
+static int DrainUntil(BenchServer * server, long long deadline_ns)
+{
+    char buf[4096];
+    for(;;){
+        long long now = ClockNs(CLOCK_MONOTONIC);
+        struct pollfd pfd;
+        int timeout_ms, ret;
+
+        if(now >= deadline_ns || server->stop){
+            return 0;
+        }
+        timeout_ms = (int)((deadline_ns - now + 999999) / 1000000);
+        pfd.fd = server->conn_fd;
+        pfd.events = POLLIN;
+        ret = poll(&pfd, 1, timeout_ms);
+        if(ret > 0){
+            if(recv(server->conn_fd, buf, sizeof(buf), 0) <= 0){
+                return -1;
+            }
+        }
+    }
+}
+
+static std::string GetField(const std::string &request, const char * name)
+{
+    std::string key = std::string("\r\n") + name + ":";
+    size_t pos = request.find(key);
+    size_t end;
+    if(pos == std::string::npos){
+        return "";
+    }
+    pos += key.size();
+    while(pos < request.size() && request[pos] == ' '){
+        pos++;
+    }
+    end = request.find("\r\n", pos);
+    return request.substr(pos, end - pos);
+}
+
+static std::string BuildSdp(BenchServer * server)
+{
+    char * sps = base64Encode((char const *)bench_sps, sizeof(bench_sps));
+    char * pps = base64Encode((char const *)bench_pps, sizeof(bench_pps));
+    char tmp[1024];
+
+    snprintf(tmp, sizeof(tmp),
+             "v=0\r\n"
+             "o=- 1 1 IN IP4 127.0.0.1\r\n"
+             "s=rtsp_engine_bench\r\n"
+             "t=0 0\r\n"
+             "a=control:*\r\n"
+             "m=video 0 RTP/AVP 96\r\n"
+             "c=IN IP4 0.0.0.0\r\n"
+             "b=AS:%u\r\n"
+             "a=rtpmap:96 H264/90000\r\n"
+             "a=fmtp:96 packetization-mode=1;profile-level-id=42c01e;"
+             "sprop-parameter-sets=%s,%s\r\n"
+             "a=control:track1\r\n",
+             server->config->bitrate, sps, pps);
+    delete[] sps;
+    delete[] pps;
+    return tmp;
+}
+
+// handle the RTSP requests until PLAY, return 0 if PLAY is replied
+static int HandleRequests(BenchServer * server)
+{
+    std::string buf;
+    char tmp[4096];
+    char url[64];
+
+    snprintf(url, sizeof(url), "rtsp://127.0.0.1:%d/bench/", server->port);
+    for(;;){
+        size_t end = buf.find("\r\n\r\n");
+        if(end == std::string::npos){
+            ssize_t ret = recv(server->conn_fd, tmp, sizeof(tmp), 0);
+            if(ret <= 0){
+                return -1;
+            }
+            buf.append(tmp, ret);
+            continue;
+        }
+
+        std::string request = buf.substr(0, end + 2);
+        std::string method = request.substr(0, request.find(' '));
+        std::string reply = "RTSP/1.0 200 OK\r\nCSeq: " +
+                            GetField(request, "CSeq") + "\r\n";
+        buf.erase(0, end + 4);
+
+        if(method == "OPTIONS"){
+            reply += "Public: OPTIONS, DESCRIBE, SETUP, TEARDOWN, PLAY\r\n\r\n";
+        }else if(method == "DESCRIBE"){
+            std::string sdp = BuildSdp(server);
+            snprintf(tmp, sizeof(tmp),
+                     "Content-Base: %s\r\n"
+                     "Content-Type: application/sdp\r\n"
+                     "Content-Length: %d\r\n\r\n", url, (int)sdp.size());
+            reply += tmp + sdp;
+        }else if(method == "SETUP"){
+            reply += "Transport: RTP/AVP/TCP;unicast;interleaved=0-1\r\n"
+                     "Session: 12345678;timeout=60\r\n\r\n";
+        }else if(method == "PLAY"){
+            reply += "Session: 12345678\r\nRange: npt=0.000-\r\n\r\n";
+        }else{
+            reply += "\r\n";
+        }
+        if(SendAll(server->conn_fd, reply.data(), reply.size())){
+            return -1;
+        }
+        if(method == "PLAY"){
+            return 0;
+        }
+    }
+}
+
+static int SendRtpPacket(BenchServer * server, uint32_t rtp_ts, bool marker,
+                         const uint8_t * header, size_t header_size,
+                         const uint8_t * data, size_t size)
+{
+    uint8_t * p = server->packet;
+    size_t rtp_size = 12 + header_size + size;
+
+    p[0] = '$';
+    p[1] = 0;
+    p[2] = (uint8_t)(rtp_size >> 8);
+    p[3] = (uint8_t)rtp_size;
+    p[4] = 0x80;
+    p[5] = (marker ? 0x80 : 0) | 96;
+    p[6] = (uint8_t)(server->seq >> 8);
+    p[7] = (uint8_t)server->seq;
+    p[8] = (uint8_t)(rtp_ts >> 24);
+    p[9] = (uint8_t)(rtp_ts >> 16);
+    p[10] = (uint8_t)(rtp_ts >> 8);
+    p[11] = (uint8_t)rtp_ts;
+    p[12] = 0x12;
+    p[13] = 0x34;
+    p[14] = 0x56;
+    p[15] = 0x78;
+    memcpy(p + 16, header, header_size);
+    memcpy(p + 16 + header_size, data, size);
+    server->seq++;
+    return SendAll(server->conn_fd, p, 4 + rtp_size);
+}
+
+// send a NAL unit of nal_size bytes (including the NAL header), as a
+// single NAL unit packet or FU-A packets
+static int SendNal(BenchServer * server, uint32_t rtp_ts, bool last_nal,
+                   uint8_t nal_header, const uint8_t * data, size_t nal_size)
+{
+    uint8_t fu[2];
+    size_t left = nal_size - 1;
+    bool first = true;
+
+    if(nal_size <= BENCH_RTP_MAX_PAYLOAD){
+        return SendRtpPacket(server, rtp_ts, last_nal, &nal_header, 1,
+                             data, left);
+    }
+    fu[0] = (nal_header & 0xe0) | 28;
+    while(left > 0){
+        size_t size = left < BENCH_RTP_MAX_PAYLOAD - 2 ?
+                      left : BENCH_RTP_MAX_PAYLOAD - 2;
+        fu[1] = nal_header & 0x1f;
+        if(first){
+            fu[1] |= 0x80;
+        }
+        if(size == left){
+            fu[1] |= 0x40;
+        }
+        if(SendRtpPacket(server, rtp_ts, last_nal && size == left,
+                         fu, 2, server->payload, size)){
+            return -1;
+        }
+        left -= size;
+        first = false;
+    }
+    return 0;
+}
+
+static void * ServerRoutine(void * arg)
+{
+    BenchServer * server = (BenchServer *)arg;
+    const BenchConfig * config = server->config;
+    size_t avg_size = (size_t)config->bitrate * 1000 / 8 / config->fps;
+    size_t key_size = avg_size * BENCH_KEY_FRAME_RATIO;
+    size_t data_size = (avg_size * config->fps - key_size) / (config->fps - 1);
+    long long start_ns;
+    uint64_t i;
+    int one = 1;
+
+    server->conn_fd = accept(server->listen_fd, NULL, NULL);
+    if(server->conn_fd < 0){
+        fprintf(stderr, "accept() failed: %s\n", strerror(errno));
+        return NULL;
+    }
+    setsockopt(server->conn_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if(HandleRequests(server)){
+        fprintf(stderr, "The RTSP negotiation failed\n");
+        return NULL;
+    }
+
+    // the slice data, without start code emulation
+    memset(server->payload, 0x5a, sizeof(server->payload));
+
+    start_ns = ClockNs(CLOCK_MONOTONIC);
+    for(i = 0; !server->stop; i++){
+        uint32_t rtp_ts = (uint32_t)(i * BENCH_RTP_CLOCK / config->fps);
+        int ret;
+
+        if(i % config->fps == 0){
+            ret = SendNal(server, rtp_ts, false, bench_sps[0],
+                          bench_sps + 1, sizeof(bench_sps)) ||
+                  SendNal(server, rtp_ts, false, bench_pps[0],
+                          bench_pps + 1, sizeof(bench_pps)) ||
+                  SendNal(server, rtp_ts, true, 0x65, server->payload,
+                          key_size);
+        }else{
+            ret = SendNal(server, rtp_ts, true, 0x41, server->payload,
+                          data_size);
+        }
+        if(ret ||
+           DrainUntil(server, start_ns +
+                      (long long)(i + 1) * 1000000000LL / config->fps)){
+            break;
+        }
+    }
+    return NULL;
+}
+
+static int StartServer(BenchServer * server, const BenchConfig * config)
+{
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+
+    server->config = config;
+    server->conn_fd = -1;
+    server->stop = 0;
+    server->seq = 0;
+    server->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if(server->listen_fd < 0){
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if(bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+       getsockname(server->listen_fd, (struct sockaddr *)&addr, &len) ||
+       listen(server->listen_fd, 1)){
+        close(server->listen_fd);
+        return -1;
+    }
+    server->port = ntohs(addr.sin_port);
+    if(pthread_create(&server->thread_id, NULL, ServerRoutine, server)){
+        close(server->listen_fd);
+        return -1;
+    }
+    return 0;
+}
+
+static void StopServer(BenchServer * server)
+{
+    server->stop = 1;
+    if(server->conn_fd >= 0){
+        shutdown(server->conn_fd, SHUT_RDWR);
+    }
+    shutdown(server->listen_fd, SHUT_RDWR);
+    pthread_join(server->thread_id, NULL);
+    if(server->conn_fd >= 0){
+        close(server->conn_fd);
+    }
+    close(server->listen_fd);
+}
+
+static void SumStreams(BenchLoop * loop, uint64_t * frames, uint64_t * bytes)
+{
+    unsigned i;
+    *frames = 0;
+    *bytes = 0;
+    for(i = 0; i < loop->session_num; i++){
+        *frames += loop->listeners[i].frames;
+        *bytes += loop->listeners[i].bytes;
+    }
+}
+
+static void MeasureStartHandler(void * client_data)
+{
+    BenchLoop * loop = (BenchLoop *)client_data;
+    SumStreams(loop, &loop->start_frames, &loop->start_bytes);
+    loop->start_cpu_ns = ClockNs(CLOCK_THREAD_CPUTIME_ID);
+    loop->start_wall_ns = ClockNs(CLOCK_MONOTONIC);
+}
+
+static void MeasureEndHandler(void * client_data)
+{
+    BenchLoop * loop = (BenchLoop *)client_data;
+    SumStreams(loop, &loop->end_frames, &loop->end_bytes);
+    loop->end_cpu_ns = ClockNs(CLOCK_THREAD_CPUTIME_ID);
+    loop->end_wall_ns = ClockNs(CLOCK_MONOTONIC);
+    loop->watch = 1;
+}
+
+// receive the streams of the loop until the measured period ends
+static void * LoopRoutine(void * arg)
+{
+    BenchLoop * loop = (BenchLoop *)arg;
+    TaskScheduler * scheduler = BasicTaskScheduler::createNew();
+    UsageEnvironment * env = BasicUsageEnvironment::createNew(*scheduler);
+    RtspClientEngine ** clients = new RtspClientEngine *[loop->session_num];
+    TaskToken start_task, end_task;
+    unsigned i;
+
+    loop->ret = 0;
+    loop->watch = 0;
+    for(i = 0; i < loop->session_num; i++){
+        char url[64];
+        BenchListener * listener = &loop->listeners[i];
+
+        listener->watch = &loop->watch;
+        snprintf(url, sizeof(url), "rtsp://127.0.0.1:%d/bench",
+                 loop->servers[i].port);
+        if(loop->lite){
+            clients[i] = LiteRtspClient::CreateNew(*env, url, False, NULL,
+                                                   NULL, NULL, listener);
+        }else{
+            clients[i] = LiveRtspClient::CreateNew(*env, url, True, False,
+                                                   NULL, NULL, NULL, False,
+                                                   listener);
+        }
+        if(clients[i] == NULL || clients[i]->Start()){
+            if(clients[i] != NULL){
+                clients[i]->Close();
+            }
+            loop->ret = -1;
+            break;
+        }
+    }
+    loop->session_num = i;   // only the started ones are closed
+
+    if(loop->ret == 0){
+        start_task = scheduler->scheduleDelayedTask(
+            BENCH_WARMUP_TIME * 1000000, MeasureStartHandler, loop);
+        end_task = scheduler->scheduleDelayedTask(
+            (BENCH_WARMUP_TIME + loop->config->duration) * 1000000,
+            MeasureEndHandler, loop);
+        env->taskScheduler().doEventLoop(&loop->watch);
+        scheduler->unscheduleDelayedTask(start_task);
+        scheduler->unscheduleDelayedTask(end_task);
+    }
+
+    for(i = 0; i < loop->session_num; i++){
+        if(loop->listeners[i].errors){
+            loop->ret = -1;
+        }
+        clients[i]->Shutdown();
+        clients[i]->Close();
+    }
+    delete[] clients;
+    env->reclaim();
+    delete scheduler;
+    return NULL;
+}
+
+// receive config->sessions streams on config->threads event loops,
+// return the CPU usage of the loop threads in percent of one core, or -1
+// on error
+static double RunEngine(const char * name, bool lite, const BenchConfig * config,
+                        double * cpu_us_per_frame)
+{
+    BenchServer * servers = new BenchServer[config->sessions];
+    BenchListener * listeners = new BenchListener[config->sessions];
+    BenchLoop * loops = new BenchLoop[config->threads];
+    unsigned started = 0, loop_num = 0, i, first = 0;
+    uint64_t frames = 0, bytes = 0;
+    long long cpu_ns = 0, wall_ns = 0;
+    double cpu_usage = -1.0, received;
+    int ret = 0;
+
+    for(started = 0; started < config->sessions; started++){
+        if(StartServer(&servers[started], config)){
+            fprintf(stderr, "Failed to start the RTSP server\n");
+            ret = -1;
+            goto out;
+        }
+    }
+
+    // spread the streams evenly, like the least loaded scheduler thread
+    for(loop_num = 0; loop_num < config->threads; loop_num++){
+        BenchLoop * loop = &loops[loop_num];
+        loop->config = config;
+        loop->lite = lite;
+        loop->session_num = config->sessions / config->threads +
+            (loop_num < config->sessions % config->threads ? 1 : 0);
+        loop->servers = servers + first;
+        loop->listeners = listeners + first;
+        first += loop->session_num;
+        if(pthread_create(&loop->thread_id, NULL, LoopRoutine, loop)){
+            fprintf(stderr, "Failed to start the event loop thread\n");
+            ret = -1;
+            break;
+        }
+    }
+    for(i = 0; i < loop_num; i++){
+        BenchLoop * loop = &loops[i];
+        pthread_join(loop->thread_id, NULL);
+        if(loop->ret){
+            ret = -1;
+            continue;
+        }
+        frames += loop->end_frames - loop->start_frames;
+        bytes += loop->end_bytes - loop->start_bytes;
+        cpu_ns += loop->end_cpu_ns - loop->start_cpu_ns;
+        if(loop->end_wall_ns - loop->start_wall_ns > wall_ns){
+            wall_ns = loop->end_wall_ns - loop->start_wall_ns;
+        }
+    }
+
+    if(ret == 0 && frames > 0){
+        // the frames received in the period against the frames sent in
+        // real time, it drops below 100% once the loops fall behind
+        received = 100.0 * frames * 1000000000.0 /
+                   ((double)config->fps * config->sessions * wall_ns);
+        cpu_usage = 100.0 * cpu_ns / wall_ns;
+        *cpu_us_per_frame = cpu_ns / 1000.0 / frames;
+        fprintf(stderr, "%8s %8u %7u %8llu %10.2f %10.3f %14.2f %9.1f\n",
+                name, config->sessions, config->threads,
+                (unsigned long long)frames,
+                bytes * 8.0 / wall_ns * 1000.0,
+                cpu_usage, *cpu_us_per_frame, received);
+    }else{
+        fprintf(stderr, "%8s failed, %llu frames received\n", name,
+                (unsigned long long)frames);
+    }
+
+out:
+    for(i = 0; i < started; i++){
+        StopServer(&servers[i]);
+    }
+    delete[] loops;
+    delete[] listeners;
+    delete[] servers;
+    return cpu_usage;
+}
+
+
+///////////////////////////////////////////////////////////////
+//main entry
+int main(int argc, char *argv[])
+{
+    BenchConfig config;
+    double live_cpu, lite_cpu;
+    double live_us = 0.0, lite_us = 0.0;
+
+    config.bitrate = BENCH_DEFAULT_BITRATE;
+    config.fps = BENCH_DEFAULT_FPS;
+    config.duration = BENCH_DEFAULT_DURATION;
+    config.sessions = 1;
+    config.threads = 1;
+    if(argc > 1){
+        config.bitrate = strtoul(argv[1], NULL, 0);
+    }
+    if(argc > 2){
+        config.fps = strtoul(argv[2], NULL, 0);
+    }
+    if(argc > 3){
+        config.duration = strtoul(argv[3], NULL, 0);
+    }
+    if(argc > 4){
+        config.sessions = strtoul(argv[4], NULL, 0);
+    }
+    if(argc > 5){
+        config.threads = strtoul(argv[5], NULL, 0);
+    }
+    if(config.bitrate == 0 || config.fps < 2 || config.duration == 0 ||
+       config.sessions == 0 || config.sessions > BENCH_MAX_SESSIONS ||
+       config.threads == 0 || config.threads > config.sessions){
+        fprintf(stderr,
+                "Usage: rtsp_engine_bench [bitrate_kbps] [fps] [duration_sec] "
+                "[sessions] [threads]\n");
+        return 1;
+    }
+
+    fprintf(stderr, "H264 %u kbps %u fps over TCP-interleaved RTP, "
+            "measured for %u sec, %u online CPUs\n", config.bitrate,
+            config.fps, config.duration,
+            (unsigned)sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(stderr, "%8s %8s %7s %8s %10s %10s %14s %9s\n", "engine",
+            "sessions", "threads", "frames", "Mbps", "CPU %",
+            "CPU us/frame", "recv %");
+
+    live_cpu = RunEngine("live555", false, &config, &live_us);
+    lite_cpu = RunEngine("lite", true, &config, &lite_us);
+    if(live_cpu <= 0 || lite_cpu <= 0){
+        return 1;
+    }
+    fprintf(stderr, "live555 / lite CPU ratio: %.2f\n", live_us / lite_us);
+    return 0;
+}
@@ -0,0 +1,312 @@
+/**
+ * This file is part of stsw_rtsp_source, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * udp_batch_read_bench.cc
+ *      a sample to measure the read cost of a RTP over UDP stream on the
+ * live555 event loop: a sender thread paces RTP sized datagrams to a
+ * loopback UDP socket, which is read by one readSocket() (recvfrom) per
+ * readiness event like the old MultiFramedRTPSource, and then by one
+ * readSocketBatch() (recvmmsg) per event like the batch path. The
+ * syscalls per second and the CPU time of the event loop thread are
+ * reported for both.
+ *
+ * author: OpenSight Team
+ * date: 2016-4-23
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "BasicUsageEnvironment.hh"
+#include "GroupsockHelper.hh"
+
+
+///////////////////////////////////////////////////////////////
+//macro
+
+#define BENCH_PACKET_SIZE       1400    // bytes, a typical RTP packet
+#define BENCH_BUFFER_SIZE       20000   // bytes, as MultiFramedRTPSource
+#define BENCH_MAX_BATCH         32
+#define BENCH_DEFAULT_DURATION  5       // sec
+#define BENCH_TICK_NS           1000000 // the sender paces per 1 ms
+#define BENCH_RECV_BUFFER       (2 * 1024 * 1024)
+
+
+///////////////////////////////////////////////////////////////
+//Type
+
+struct BenchSender{
+    int fd;
+    struct sockaddr_in addr;
+    unsigned rate;          // packets per second
+    unsigned duration;      // sec
+    uint64_t sent;
+    pthread_t thread_id;
+};
+
+struct BenchReceiver{
+    UsageEnvironment * env;
+    int fd;
+    unsigned batch;         // 0 means one readSocket() per event
+    unsigned char * buffers[BENCH_MAX_BATCH];
+    unsigned bytes_read[BENCH_MAX_BATCH];
+    struct sockaddr_in from[BENCH_MAX_BATCH];
+    struct timeval times[BENCH_MAX_BATCH];
+
+    uint64_t packets;
+    uint64_t events;        // one select() each
+    uint64_t reads;         // recvfrom() or recvmmsg() calls
+    char watch;
+};
+
+
+///////////////////////////////////////////////////////////////
+//functions
+
+static long long ClockNs(clockid_t clock_id)
+{
+    struct timespec ts;
+    clock_gettime(clock_id, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void * SenderRoutine(void * arg)
+{
+    BenchSender * sender = (BenchSender *)arg;
+    char packet[BENCH_PACKET_SIZE];
+    uint64_t total = (uint64_t)sender->rate * sender->duration;
+    long long start_ns = ClockNs(CLOCK_MONOTONIC);
+    long long tick;
+
+    memset(packet, 0x5a, sizeof(packet));
+    sender->sent = 0;
+    for(tick = 1; sender->sent < total; tick++){
+        // the packets due by the end of this tick
+        uint64_t due = (uint64_t)tick * BENCH_TICK_NS * sender->rate /
+                       1000000000LL;
+        long long deadline = start_ns + tick * BENCH_TICK_NS;
+        struct timespec ts;
+
+        if(due > total){
+            due = total;
+        }
+        while(sender->sent < due){
+            if(sendto(sender->fd, packet, sizeof(packet), 0,
+                      (struct sockaddr *)&sender->addr,
+                      sizeof(sender->addr)) < 0){
+                if(errno == ENOBUFS || errno == EAGAIN){
+                    break;  // counted as lost
+                }
+                fprintf(stderr, "sendto() failed: %s\n", strerror(errno));
+                return NULL;
+            }
+            sender->sent++;
+        }
+        sender->sent = due;
+
+        ts.tv_sec = deadline / 1000000000LL;
+        ts.tv_nsec = deadline % 1000000000LL;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+    }
+    return NULL;
+}
+
+static void ReadHandler(void * client_data, int mask)
+{
+    BenchReceiver * receiver = (BenchReceiver *)client_data;
+
+    receiver->events++;
+    receiver->reads++;
+    if(receiver->batch == 0){
+        // the old path: one datagram per readiness event
+        if(readSocket(*receiver->env, receiver->fd, receiver->buffers[0],
+                      BENCH_BUFFER_SIZE, receiver->from[0]) > 0){
+            receiver->packets++;
+        }
+    }else{
+        int num = readSocketBatch(*receiver->env, receiver->fd,
+                                  receiver->buffers, BENCH_BUFFER_SIZE,
+                                  receiver->batch, receiver->bytes_read,
+                                  receiver->from, receiver->times);
+        if(num > 0){
+            receiver->packets += num;
+        }
+    }
+}
+
+static void StopHandler(void * client_data)
+{
+    BenchReceiver * receiver = (BenchReceiver *)client_data;
+    receiver->watch = 1;
+}
+
+static int OpenSocket(struct sockaddr_in * addr)
+{
+    socklen_t len = sizeof(*addr);
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    if(fd < 0){
+        return -1;
+    }
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if(bind(fd, (struct sockaddr *)addr, sizeof(*addr)) ||
+       getsockname(fd, (struct sockaddr *)addr, &len) ||
+       fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK)){
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// return 0 on success, or -1 on error
+static int RunBench(const char * name, unsigned batch, unsigned rate,
+                    unsigned duration)
+{
+    TaskScheduler * scheduler = BasicTaskScheduler::createNew();
+    UsageEnvironment * env = BasicUsageEnvironment::createNew(*scheduler);
+    BenchReceiver * receiver = new BenchReceiver;
+    BenchSender sender;
+    long long start_cpu_ns, start_wall_ns, cpu_ns, wall_ns;
+    unsigned i;
+    int ret = -1;
+
+    memset(receiver, 0, sizeof(*receiver));
+    receiver->env = env;
+    receiver->batch = batch;
+    for(i = 0; i < BENCH_MAX_BATCH; i++){
+        receiver->buffers[i] = new unsigned char[BENCH_BUFFER_SIZE];
+    }
+    receiver->fd = OpenSocket(&sender.addr);
+    sender.fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if(receiver->fd < 0 || sender.fd < 0){
+        fprintf(stderr, "Failed to open the sockets: %s\n", strerror(errno));
+        goto out;
+    }
+    increaseReceiveBufferTo(*env, receiver->fd, BENCH_RECV_BUFFER);
+    if(batch > 0){
+        setSocketTimestamping(receiver->fd);
+    }
+    sender.rate = rate;
+    sender.duration = duration;
+
+    scheduler->setBackgroundHandling(receiver->fd, SOCKET_READABLE,
+                                     ReadHandler, receiver);
+    // a bit longer than the sender for the tail
+    scheduler->scheduleDelayedTask(duration * 1000000 + 100000,
+                                   StopHandler, receiver);
+
+    start_cpu_ns = ClockNs(CLOCK_THREAD_CPUTIME_ID);
+    start_wall_ns = ClockNs(CLOCK_MONOTONIC);
+    if(pthread_create(&sender.thread_id, NULL, SenderRoutine, &sender)){
+        fprintf(stderr, "Failed to start the sender thread\n");
+        scheduler->disableBackgroundHandling(receiver->fd);
+        goto out;
+    }
+    env->taskScheduler().doEventLoop(&receiver->watch);
+    cpu_ns = ClockNs(CLOCK_THREAD_CPUTIME_ID) - start_cpu_ns;
+    wall_ns = ClockNs(CLOCK_MONOTONIC) - start_wall_ns;
+    pthread_join(sender.thread_id, NULL);
+    scheduler->disableBackgroundHandling(receiver->fd);
+
+    fprintf(stderr, "%8u %9s %10.1f %10.1f %10.0f %10.0f %8.2f %10.3f\n",
+            rate, name,
+            100.0 - (sender.sent ? 100.0 * receiver->packets / sender.sent : 0),
+            receiver->packets ? (double)receiver->packets / receiver->reads : 0,
+            receiver->events * 1000000000.0 / wall_ns,
+            (receiver->events + receiver->reads) * 1000000000.0 / wall_ns,
+            100.0 * cpu_ns / wall_ns,
+            receiver->packets ? cpu_ns / 1000.0 / receiver->packets : 0);
+    ret = 0;
+
+out:
+    if(receiver->fd >= 0){
+        close(receiver->fd);
+    }
+    if(sender.fd >= 0){
+        close(sender.fd);
+    }
+    for(i = 0; i < BENCH_MAX_BATCH; i++){
+        delete[] receiver->buffers[i];
+    }
+    delete receiver;
+    env->reclaim();
+    delete scheduler;
+    return ret;
+}
+
+
+///////////////////////////////////////////////////////////////
+//main entry
+int main(int argc, char *argv[])
+{
+    // about a 20 Mbps camera, 10 of them, and 50 of them
+    static const unsigned rates[] = {2000, 20000, 100000};
+    unsigned duration = BENCH_DEFAULT_DURATION;
+    unsigned batch = BENCH_MAX_BATCH;
+    unsigned rate = 0;
+    unsigned i;
+
+    if(argc > 1){
+        rate = strtoul(argv[1], NULL, 0);
+    }
+    if(argc > 2){
+        duration = strtoul(argv[2], NULL, 0);
+    }
+    if(argc > 3){
+        batch = strtoul(argv[3], NULL, 0);
+    }
+    if(duration == 0 || batch == 0 || batch > BENCH_MAX_BATCH){
+        fprintf(stderr, "Usage: udp_batch_read_bench [packets_per_sec] "
+                "[duration_sec] [batch]\n");
+        return 1;
+    }
+
+    fprintf(stderr, "%d byte datagrams over loopback for %u sec, "
+            "batch of up to %u\n", BENCH_PACKET_SIZE, duration, batch);
+    fprintf(stderr, "%8s %9s %10s %10s %10s %10s %8s %10s\n", "pkt/s",
+            "read", "lost %", "pkt/read", "select/s", "syscall/s",
+            "CPU %", "us/packet");
+
+    for(i = 0; i < sizeof(rates) / sizeof(rates[0]); i++){
+        unsigned r = rate ? rate : rates[i];
+        if(RunBench("recvfrom", 0, r, duration) ||
+           RunBench("recvmmsg", batch, r, duration)){
+            return 1;
+        }
+        if(rate){
+            break;
+        }
+    }
+    return 0;
+}
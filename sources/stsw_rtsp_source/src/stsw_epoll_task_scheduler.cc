@@ -0,0 +1,390 @@
+/**
+ * This file is part of stsw_rtsp_source, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_epoll_task_scheduler.cc
+ *      EpollTaskScheduler class implementation file
+ *
+ * author: OpenSight Team
+ * date: 2016-3-12
+**/
+
+#include "stsw_epoll_task_scheduler.h"
+
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+
+
+#define EPOLL_MAX_EVENTS 256
+
+// Very large timeout is meaningless, limit it to 1 million seconds,
+// the same as BasicTaskScheduler
+#define MAX_TIMEOUT_MS (1000000LL * 1000)
+
+
+EpollTaskScheduler* EpollTaskScheduler::createNew()
+{
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if(epoll_fd < 0){
+        perror("EpollTaskScheduler::createNew(): epoll_create1 failed");
+        return NULL;
+    }
+    int event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(event_fd < 0){
+        perror("EpollTaskScheduler::createNew(): eventfd failed");
+        close(epoll_fd);
+        return NULL;
+    }
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = event_fd;
+    if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, event_fd, &ev) < 0){
+        perror("EpollTaskScheduler::createNew(): epoll_ctl failed");
+        close(event_fd);
+        close(epoll_fd);
+        return NULL;
+    }
+    return new EpollTaskScheduler(epoll_fd, event_fd);
+}
+
+EpollTaskScheduler::EpollTaskScheduler(int epoll_fd, int event_fd)
+: epoll_fd_(epoll_fd), event_fd_(event_fd), next_task_id_(1)
+{
+}
+
+EpollTaskScheduler::~EpollTaskScheduler()
+{
+    std::vector<SocketHandler *>::iterator it;
+    for(it = handlers_.begin(); it != handlers_.end(); it++){
+        delete (*it);
+    }
+    handlers_.clear();
+
+    close(event_fd_);
+    close(epoll_fd_);
+}
+
+uint64_t EpollTaskScheduler::MonotonicTimeNow()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+EpollTaskScheduler::SocketHandler *
+EpollTaskScheduler::LookupHandler(int socketNum)
+{
+    if(socketNum < 0 || socketNum >= (int)handlers_.size()){
+        return NULL;
+    }
+    return handlers_[socketNum];
+}
+
+int EpollTaskScheduler::EpollEvents(const SocketHandler *handler)
+{
+    int events = 0;
+    if(handler->condition_set & SOCKET_READABLE){
+        events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if(handler->condition_set & SOCKET_WRITABLE){
+        events |= EPOLLOUT;
+    }
+    if(handler->condition_set & SOCKET_EXCEPTION){
+        events |= EPOLLPRI;
+    }
+    if(handler->edge_triggered){
+        events |= EPOLLET;
+    }
+    return events;
+}
+
+void EpollTaskScheduler::AddReady(int socketNum, SocketHandler *handler,
+                                  int result_set)
+{
+    handler->result_set |= result_set;
+    if(!handler->is_ready){
+        handler->is_ready = true;
+        ready_list_.push_back(socketNum);
+    }
+}
+
+
+///////////////////////////////////////////////////////////
+// Redefined virtual functions
+
+void EpollTaskScheduler::setBackgroundHandling(int socketNum, int conditionSet,
+                                               BackgroundHandlerProc* handlerProc,
+                                               void* clientData)
+{
+    if(socketNum < 0) return;
+
+    SocketHandler * handler = LookupHandler(socketNum);
+
+    if(conditionSet == 0){
+        if(handler != NULL){
+            // the socket may be closed already, which is removed from
+            // epoll automatically, so ignore the error
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, socketNum, NULL);
+            delete handler;
+            handlers_[socketNum] = NULL;
+        }
+        return;
+    }
+
+    int op = EPOLL_CTL_MOD;
+    if(handler == NULL){
+        if(socketNum >= (int)handlers_.size()){
+            handlers_.resize(socketNum + 1, NULL);
+        }
+        handler = new SocketHandler;
+        handler->is_ready = false;
+        handlers_[socketNum] = handler;
+        op = EPOLL_CTL_ADD;
+    }
+    handler->condition_set = conditionSet;
+    handler->proc = handlerProc;
+    handler->client_data = clientData;
+    handler->result_set = 0;
+    handler->edge_triggered = ((conditionSet & SOCKET_WRITABLE) == 0);
+
+    struct epoll_event ev;
+    ev.events = EpollEvents(handler);
+    ev.data.fd = socketNum;
+    if(epoll_ctl(epoll_fd_, op, socketNum, &ev) < 0){
+        if(op == EPOLL_CTL_MOD && errno == ENOENT){
+            // the socket number was closed and reused without disabling
+            // its handling
+            op = EPOLL_CTL_ADD;
+            if(epoll_ctl(epoll_fd_, op, socketNum, &ev) == 0){
+                return;
+            }
+        }
+        perror("EpollTaskScheduler::setBackgroundHandling(): epoll_ctl failed");
+        delete handler;
+        handlers_[socketNum] = NULL;
+    }
+}
+
+void EpollTaskScheduler::moveSocketHandling(int oldSocketNum, int newSocketNum)
+{
+    if (oldSocketNum < 0 || newSocketNum < 0) return; // sanity check
+
+    SocketHandler * handler = LookupHandler(oldSocketNum);
+    if(handler == NULL){
+        return;
+    }
+    int condition_set = handler->condition_set;
+    BackgroundHandlerProc* proc = handler->proc;
+    void * client_data = handler->client_data;
+
+    setBackgroundHandling(oldSocketNum, 0, NULL, NULL);
+    setBackgroundHandling(newSocketNum, condition_set, proc, client_data);
+}
+
+TaskToken EpollTaskScheduler::scheduleDelayedTask(int64_t microseconds,
+                                                  TaskFunc* proc,
+                                                  void* clientData)
+{
+    if (microseconds < 0) microseconds = 0;
+
+    DelayedTask task;
+    task.due_time = MonotonicTimeNow() + microseconds;
+    task.proc = proc;
+    task.client_data = clientData;
+
+    uint64_t task_id = next_task_id_++;
+    tasks_[task_id] = task;
+    task_queue_.insert(std::make_pair(task.due_time, task_id));
+
+    return (TaskToken)(uintptr_t)task_id;
+}
+
+void EpollTaskScheduler::unscheduleDelayedTask(TaskToken& prevTask)
+{
+    uint64_t task_id = (uint64_t)(uintptr_t)prevTask;
+    prevTask = NULL;
+
+    TaskMap::iterator it = tasks_.find(task_id);
+    if(it == tasks_.end()){
+        return;
+    }
+    task_queue_.erase(std::make_pair(it->second.due_time, task_id));
+    tasks_.erase(it);
+}
+
+void EpollTaskScheduler::triggerEvent(EventTriggerId eventTriggerId, void* clientData)
+{
+    BasicTaskScheduler0::triggerEvent(eventTriggerId, clientData);
+
+    // wake up the event loop
+    uint64_t one = 1;
+    ssize_t ret = write(event_fd_, &one, sizeof(one));
+    (void)ret;
+}
+
+void EpollTaskScheduler::SingleStep(unsigned maxDelayTime)
+{
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    long long timeout_ms = -1;
+
+    if(!ready_list_.empty() || fTriggersAwaitingHandling != 0){
+        timeout_ms = 0;
+    }else{
+        long long timeout_us = -1;
+        if(!task_queue_.empty()){
+            uint64_t now = MonotonicTimeNow();
+            uint64_t due_time = task_queue_.begin()->first;
+            timeout_us = (due_time > now) ? (long long)(due_time - now) : 0;
+        }
+        if(maxDelayTime > 0 &&
+           (timeout_us < 0 || timeout_us > (long long)maxDelayTime)){
+            timeout_us = maxDelayTime;
+        }
+        if(timeout_us >= 0){
+            // round up, so that we don't wake up before the task is due
+            timeout_ms = (timeout_us + 999) / 1000;
+            if(timeout_ms > MAX_TIMEOUT_MS){
+                timeout_ms = MAX_TIMEOUT_MS;
+            }
+        }
+    }
+
+    int num = epoll_wait(epoll_fd_, events, EPOLL_MAX_EVENTS, (int)timeout_ms);
+    if(num < 0){
+        if(errno != EINTR){
+            // Unexpected error - treat this as fatal:
+            perror("EpollTaskScheduler::SingleStep(): epoll_wait fails");
+            internalError();
+        }
+        num = 0;
+    }
+
+    for(int i = 0; i < num; i++){
+        int sock = events[i].data.fd;
+        if(sock == event_fd_){
+            uint64_t count;
+            ssize_t ret = read(event_fd_, &count, sizeof(count));
+            (void)ret;
+            continue;
+        }
+        SocketHandler * handler = LookupHandler(sock);
+        if(handler == NULL){
+            continue;
+        }
+        int result_set = 0;
+        uint32_t ev = events[i].events;
+        // the same as select, error or hang-up is reported as readable
+        // and writable
+        if(ev & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)){
+            result_set |= SOCKET_READABLE;
+        }
+        if(ev & (EPOLLOUT | EPOLLHUP | EPOLLERR)){
+            result_set |= SOCKET_WRITABLE;
+        }
+        if(ev & EPOLLPRI){
+            result_set |= SOCKET_EXCEPTION;
+        }
+        AddReady(sock, handler, result_set);
+    }
+
+    // Call the handlers of all the ready sockets. The sockets are looked up
+    // again before each call, because the previous handlers may change them
+    std::vector<int> ready_list;
+    ready_list.swap(ready_list_);
+    std::vector<int>::iterator it;
+    for(it = ready_list.begin(); it != ready_list.end(); it++){
+        int sock = *it;
+        SocketHandler * handler = LookupHandler(sock);
+        if(handler == NULL || !handler->is_ready){
+            continue;
+        }
+        int result_set = handler->result_set & handler->condition_set;
+        handler->result_set = 0;
+        handler->is_ready = false;
+        if(result_set == 0 || handler->proc == NULL){
+            continue;
+        }
+
+        (*handler->proc)(handler->client_data, result_set);
+
+        // For an edge-triggered socket, no more event would come until
+        // new data arrives, so keep it ready if there is data left
+        handler = LookupHandler(sock);
+        if(handler != NULL && handler->edge_triggered &&
+           (handler->condition_set & SOCKET_READABLE)){
+            int pending = 0;
+            if(ioctl(sock, FIONREAD, &pending) == 0 && pending > 0){
+                AddReady(sock, handler, SOCKET_READABLE);
+            }
+        }
+    }
+
+    // Also handle any newly-triggered event (Note that we do this *after*
+    // calling the socket handlers, in case the triggered event handler
+    // modifies the set of readable sockets.)
+    HandleTriggers();
+
+    // Also handle any delayed event that may have come due.
+    HandleDelayedTasks();
+}
+
+void EpollTaskScheduler::HandleTriggers()
+{
+    if(fTriggersAwaitingHandling == 0){
+        return;
+    }
+    EventTriggerId mask = 0x80000000;
+    for(unsigned i = 0; i < MAX_NUM_EVENT_TRIGGERS; ++i, mask >>= 1){
+        if((fTriggersAwaitingHandling & mask) != 0){
+            fTriggersAwaitingHandling &= ~mask;
+            if(fTriggeredEventHandlers[i] != NULL){
+                (*fTriggeredEventHandlers[i])(fTriggeredEventClientDatas[i]);
+            }
+        }
+    }
+}
+
+void EpollTaskScheduler::HandleDelayedTasks()
+{
+    uint64_t now = MonotonicTimeNow();
+    // the tasks scheduled by the handlers here are left to the next step,
+    // so that a zero-delay task rescheduling itself cannot starve the loop
+    uint64_t last_task_id = next_task_id_;
+
+    while(!task_queue_.empty()){
+        TaskQueue::iterator head = task_queue_.begin();
+        if(head->first > now || head->second >= last_task_id){
+            break;
+        }
+        TaskMap::iterator it = tasks_.find(head->second);
+        DelayedTask task = it->second;
+        tasks_.erase(it);
+        task_queue_.erase(head);
+
+        (*task.proc)(task.client_data);
+    }
+}
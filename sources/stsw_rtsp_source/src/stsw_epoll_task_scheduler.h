@@ -0,0 +1,126 @@
+/**
+ * This file is part of stsw_rtsp_source, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_epoll_task_scheduler.h
+ *      EpollTaskScheduler class header file, a live555 task scheduler
+ *  based on epoll instead of select
+ *
+ * author: OpenSight Team
+ * date: 2016-3-12
+**/
+
+
+#ifndef STSW_EPOLL_TASK_SCHEDULER_H
+#define STSW_EPOLL_TASK_SCHEDULER_H
+
+#include <stdint.h>
+
+#include <vector>
+#include <map>
+#include <set>
+#include <utility>
+
+#include "BasicUsageEnvironment.hh"
+
+
+// the epoll based task scheduler
+//    Compared to BasicTaskScheduler, whose SingleStep() copies 3 fd_sets
+// and calls select() over all the sockets up to the max socket number, the
+// cost of this scheduler for each wakeup only depends on the number of the
+// ready sockets, and there is no FD_SETSIZE limit.
+//    The sockets only waiting for readable are registered edge-triggered.
+// Because a live555 handler may not read out all the data in one call,
+// such a socket is kept in a ready list and called again in the next step,
+// as long as there is still data in its receive buffer (FIONREAD). The
+// sockets waiting for writable are registered level-triggered, which is
+// the same semantics as select.
+//    Delayed tasks are kept in a tree sorted by their due time on the
+// monotonic clock, so that it's O(log n) to schedule/unschedule a task and
+// it's not affected by the system time jumping.
+//    The triggered events are signaled through an eventfd, so that the
+// event loop is woken up at once and no periodic tick is needed.
+class EpollTaskScheduler: public BasicTaskScheduler0
+{
+public:
+    // createNew()
+    // Return NULL if epoll/eventfd cannot be created
+    static EpollTaskScheduler* createNew();
+    virtual ~EpollTaskScheduler();
+
+    // Redefined virtual functions:
+    virtual void SingleStep(unsigned maxDelayTime = 0);
+
+    virtual TaskToken scheduleDelayedTask(int64_t microseconds, TaskFunc* proc,
+                                          void* clientData);
+    virtual void unscheduleDelayedTask(TaskToken& prevTask);
+
+    virtual void triggerEvent(EventTriggerId eventTriggerId, void* clientData = NULL);
+
+    virtual void setBackgroundHandling(int socketNum, int conditionSet,
+                                       BackgroundHandlerProc* handlerProc,
+                                       void* clientData);
+    virtual void moveSocketHandling(int oldSocketNum, int newSocketNum);
+
+protected:
+    EpollTaskScheduler(int epoll_fd, int event_fd);
+
+    struct SocketHandler{
+        int condition_set;
+        BackgroundHandlerProc* proc;
+        void* client_data;
+        int result_set;       // the conditions got from epoll, not handled yet
+        bool is_ready;        // in the ready list
+        bool edge_triggered;
+    };
+
+    struct DelayedTask{
+        uint64_t due_time;    // in microseconds, on the monotonic clock
+        TaskFunc* proc;
+        void* client_data;
+    };
+    // (due_time, task id), so that the tasks with the same due time are
+    // handled in the order they are scheduled
+    typedef std::set<std::pair<uint64_t, uint64_t> > TaskQueue;
+    typedef std::map<uint64_t, DelayedTask> TaskMap;
+
+    static uint64_t MonotonicTimeNow();
+
+    SocketHandler * LookupHandler(int socketNum);
+    int EpollEvents(const SocketHandler *handler);
+    void AddReady(int socketNum, SocketHandler *handler, int result_set);
+    void HandleTriggers();
+    void HandleDelayedTasks();
+
+    int epoll_fd_;
+    int event_fd_;
+
+    std::vector<SocketHandler *> handlers_;  // indexed by socket number
+    std::vector<int> ready_list_;
+
+    TaskQueue task_queue_;
+    TaskMap tasks_;
+    uint64_t next_task_id_;
+};
+
+
+#endif
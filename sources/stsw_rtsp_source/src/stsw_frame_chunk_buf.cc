@@ -0,0 +1,178 @@
+/**
+ * This file is part of stsw_rtsp_source, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_frame_chunk_buf.cc
+ *      FrameChunkBuf class implementation file
+ *
+ * author: OpenSight Team
+ * date: 2016-3-16
+**/
+
+#include "stsw_frame_chunk_buf.h"
+
+
+FrameChunkBuf::FrameChunkBuf(size_t chunk_size, size_t max_size)
+: chunk_size_(chunk_size), max_size_(max_size), size_(0)
+{
+    if(chunk_size_ == 0){
+        chunk_size_ = 1;
+    }
+    if(chunk_size_ > max_size_){
+        chunk_size_ = max_size_;
+    }
+}
+
+FrameChunkBuf::~FrameChunkBuf()
+{
+    ChunkList::iterator it;
+    for(it = chunks_.begin(); it != chunks_.end(); it++){
+        delete[] it->data;
+    }
+    chunks_.clear();
+    for(it = free_chunks_.begin(); it != free_chunks_.end(); it++){
+        delete[] it->data;
+    }
+    free_chunks_.clear();
+}
+
+uint8_t * FrameChunkBuf::GetWritePos(size_t want_size, size_t *free_size)
+{
+    size_t limit;
+    size_t chunk_free = 0;
+
+    if(size_ >= max_size_){
+        return NULL;
+    }
+    limit = max_size_ - size_;
+    if(want_size > limit){
+        want_size = limit;
+    }
+    if(want_size == 0){
+        want_size = 1;
+    }
+
+    if(!chunks_.empty()){
+        chunk_free = chunks_.back().capacity - chunks_.back().size;
+    }
+    if(chunk_free < want_size){
+        if(!NewChunk(want_size)){
+            return NULL;
+        }
+        chunk_free = chunks_.back().capacity;
+    }
+
+    if(free_size != NULL){
+        *free_size = (chunk_free < limit)? chunk_free : limit;
+    }
+    return chunks_.back().data + chunks_.back().size;
+}
+
+void FrameChunkBuf::Commit(size_t data_size)
+{
+    if(chunks_.empty()){
+        return;
+    }
+    Chunk & tail = chunks_.back();
+    if(data_size > tail.capacity - tail.size){
+        data_size = tail.capacity - tail.size;
+    }
+    tail.size += data_size;
+    size_ += data_size;
+}
+
+void FrameChunkBuf::Clear()
+{
+    ChunkList::iterator it;
+    for(it = chunks_.begin(); it != chunks_.end(); it++){
+        if(free_chunks_.size() < FRAME_CHUNK_MAX_FREE_NUM){
+            it->size = 0;
+            free_chunks_.push_back(*it);
+        }else{
+            delete[] it->data;
+        }
+    }
+    chunks_.clear();
+    size_ = 0;
+}
+
+void FrameChunkBuf::GetSegments(std::vector<stream_switch::MediaFrameSegment> *segments)
+{
+    if(segments == NULL){
+        return;
+    }
+    segments->clear();
+    ChunkList::iterator it;
+    for(it = chunks_.begin(); it != chunks_.end(); it++){
+        if(it->size != 0){
+            segments->push_back(
+                stream_switch::MediaFrameSegment((const char *)it->data, it->size));
+        }
+    }
+}
+
+bool FrameChunkBuf::NewChunk(size_t min_capacity)
+{
+    Chunk chunk;
+    ChunkList::iterator it;
+
+    // the last chunk has no data, replace it
+    if(!chunks_.empty() && chunks_.back().size == 0){
+        if(free_chunks_.size() < FRAME_CHUNK_MAX_FREE_NUM){
+            free_chunks_.push_back(chunks_.back());
+        }else{
+            delete[] chunks_.back().data;
+        }
+        chunks_.pop_back();
+    }
+
+    // reuse a free chunk large enough
+    for(it = free_chunks_.begin(); it != free_chunks_.end(); it++){
+        if(it->capacity >= min_capacity){
+            chunk = *it;
+            free_chunks_.erase(it);
+            chunks_.push_back(chunk);
+            return true;
+        }
+    }
+
+    // no free chunk is large enough after the receive space grows,
+    // release them instead of keeping the memory for nothing
+    for(it = free_chunks_.begin(); it != free_chunks_.end(); it++){
+        delete[] it->data;
+    }
+    free_chunks_.clear();
+
+    // allocate a new chunk, whose capacity is a multiple of the chunk size
+    chunk.capacity = ((min_capacity + chunk_size_ - 1) / chunk_size_) * chunk_size_;
+    if(chunk.capacity > max_size_){
+        chunk.capacity = max_size_;
+    }
+    if(chunk.capacity < min_capacity){
+        return false;
+    }
+    chunk.data = new uint8_t[chunk.capacity];
+    chunk.size = 0;
+
+    chunks_.push_back(chunk);
+    return true;
+}
@@ -0,0 +1,118 @@
+/**
+ * This file is part of stsw_rtsp_source, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_frame_chunk_buf.h
+ *      FrameChunkBuf class header file, a growable frame buffer made up of
+ *  a chain of chunks
+ *
+ * author: OpenSight Team
+ * date: 2016-3-16
+**/
+
+
+#ifndef STSW_FRAME_CHUNK_BUF_H
+#define STSW_FRAME_CHUNK_BUF_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <vector>
+
+#include "stream_switch.h"
+
+
+#define FRAME_CHUNK_MAX_FREE_NUM 4
+
+
+// the frame buffer made up of a chain of chunks
+//    The media frame is assembled by appending the data into the last chunk
+// of the chain. When the free space of the last chunk is not enough, a new
+// chunk is got from the free list (or allocated) and linked to the chain,
+// so that the buffer grows on demand until the hard limit of the frame size,
+// and the data in the previous chunks never moves.
+//    The completed frame is output as a segment list of the chunks, which
+// can be passed to StreamSource::SendLiveMediaFrameV() directly.
+//    When the buffer is cleared, the chunks are kept in the free list for
+// the next frame, at most FRAME_CHUNK_MAX_FREE_NUM chunks are kept. They are
+// released once none of them is large enough for the wanted space.
+//    Not thread-safe, should be used in one thread
+class FrameChunkBuf
+{
+public:
+    // chunk_size is the default capacity of a chunk, max_size is the hard
+    // limit of the frame size
+    FrameChunkBuf(size_t chunk_size, size_t max_size);
+    virtual ~FrameChunkBuf();
+
+    // GetWritePos()
+    // Get the position to append data, which has at least want_size bytes
+    // contiguous free space if it's not over the hard limit.
+    // Params:
+    //    want_size: the expected contiguous free space in bytes
+    //    free_size: output the contiguous free space in bytes at the returned
+    //               position, which never exceeds the hard limit
+    // return the position, or NULL if the buffer has reached the hard limit
+    virtual uint8_t * GetWritePos(size_t want_size, size_t *free_size);
+
+    // Commit()
+    // Commit the data_size bytes which has been written at the position
+    // returned by the last GetWritePos()
+    virtual void Commit(size_t data_size);
+
+    // Clear()
+    // Drop all the data and recycle the chunks
+    virtual void Clear();
+
+    // GetSegments()
+    // Output the segment list of the data in the buffer
+    virtual void GetSegments(std::vector<stream_switch::MediaFrameSegment> *segments);
+
+    size_t size()
+    {
+        return size_;
+    }
+    size_t max_size()
+    {
+        return max_size_;
+    }
+
+protected:
+    struct Chunk{
+        uint8_t * data;
+        size_t capacity;
+        size_t size;
+    };
+    typedef std::vector<Chunk> ChunkList;
+
+    virtual bool NewChunk(size_t min_capacity);
+
+    size_t chunk_size_;
+    size_t max_size_;
+    size_t size_;
+
+    ChunkList chunks_;       // the chunk chain of the current frame
+    ChunkList free_chunks_;  // the recycled chunks
+};
+
+
+#endif
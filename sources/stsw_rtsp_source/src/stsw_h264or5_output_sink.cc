@@ -44,18 +44,23 @@ H264or5OutputSink* H264or5OutputSink::createNew(UsageEnvironment& env,
                                             MediaSubsession* subsession,                                          
                                             int32_t sub_stream_index,    
                                             size_t sink_buf_size, 
+                                            size_t sink_recv_size, 
+                                            size_t sink_chunk_size, 
                                             int h_number)
 {
     //sanity check
     if(subsession == NULL ||
        sub_stream_index < 0 ||
        sink_buf_size < MAX_PARAMETER_NAL_SIZE ||
+       sink_recv_size < 100 ||
+       sink_chunk_size < 100 ||
        (h_number != 264 && h_number != 265)){
         return NULL;
     }
     
     return new H264or5OutputSink(env, rtsp_client, subsession, 
-                               sub_stream_index, sink_buf_size, h_number);
+                               sub_stream_index, sink_buf_size, 
+                               sink_recv_size, sink_chunk_size, h_number);
 }
 
 
@@ -63,9 +68,10 @@ H264or5OutputSink::H264or5OutputSink(UsageEnvironment& env,
                     LiveRtspClient *rtsp_client,
                     MediaSubsession* subsession, 
                     int32_t sub_stream_index, size_t sink_buf_size, 
-                    int h_number)
-: MediaOutputSink(env, rtsp_client, subsession, sub_stream_index, sink_buf_size), 
-h_number_(h_number), recv_buf_size_(0)
+                    size_t sink_recv_size, size_t sink_chunk_size, int h_number)
+: MediaOutputSink(env, rtsp_client, subsession, sub_stream_index, sink_buf_size, 
+                  sink_recv_size, sink_chunk_size), 
+h_number_(h_number)
 {
     
     
@@ -111,7 +117,14 @@ void H264or5OutputSink::DoAfterGettingFrame(unsigned frameSize, unsigned numTrun
                 << "Stream index:\"" << sub_stream_index_ << "\" ("
                 << subsession_->mediumName() << "/" << subsession_->codecName() 
                 <<"), Dropped\n";   
-        recv_buf_size_ = 0; //clear the recv_buf_;
+        frame_buf_->Clear(); //clear the frame_buf_;
+        return;
+    }
+    
+    if(IsDamagedFrame()){
+        // the parameter nals buffered may belong to the damaged frame, 
+        // drop them as well
+        frame_buf_->Clear();
         return;
     }
 
@@ -120,11 +133,11 @@ void H264or5OutputSink::DoAfterGettingFrame(unsigned frameSize, unsigned numTrun
         dynamic_cast<H264or5VideoStreamFramer *> (subsession_->readSource());
         
     if(source == NULL){
-        //not H264or5VideoStreamFramer, just use default method
-        memmove(recv_buf_, recv_buf_ + recv_buf_size_, frameSize); //recover recv_buf_ by removing the prepend start code 
-        recv_buf_size_ = 0;
+        //not H264or5VideoStreamFramer, just use default method, 
+        //recv_buf_ points to the frame without the prepend start code 
         MediaOutputSink::DoAfterGettingFrame(frameSize, numTruncatedBytes, 
             presentationTime, durationInMicroseconds);
+        frame_buf_->Clear();
         return;
     }
     
@@ -191,9 +204,9 @@ void H264or5OutputSink::DoAfterGettingFrame(unsigned frameSize, unsigned numTrun
     //analyze the frame's type
     u_int8_t nal_unit_type;
     if (h_number_ == 264 && frameSize >= 1) {
-        nal_unit_type = recv_buf_[recv_buf_size_]&0x1F;
+        nal_unit_type = recv_buf_[0]&0x1F;
     } else if (h_number_ == 265 && frameSize >= 2) {
-        nal_unit_type = (recv_buf_[recv_buf_size_]&0x7E)>>1;
+        nal_unit_type = (recv_buf_[0]&0x7E)>>1;
     } else {
         // This is too short to be a valid NAL unit, so just assume a bogus nal_unit_type
         nal_unit_type = 0xFF;
@@ -206,81 +219,61 @@ void H264or5OutputSink::DoAfterGettingFrame(unsigned frameSize, unsigned numTrun
             frame_type = MEDIA_FRAME_TYPE_DATA_FRAME;               
         }        
     }else{
-        int i;
+        const uint8_t *pos = recv_buf_;
+        const uint8_t *end = pos + frameSize;
+        StswNalUnit nal;
         frame_type = MEDIA_FRAME_TYPE_PARAM_FRAME;        
         
-        //check is there any data frame in the internal of the param frame
-  
-        for(i=4; i<frameSize; i++){
-            if(recv_buf_[recv_buf_size_ + i - 4] == 0 &&
-               recv_buf_[recv_buf_size_ + i - 3] == 0 &&
-               recv_buf_[recv_buf_size_ + i - 2] == 0 &&               
-               recv_buf_[recv_buf_size_ + i - 1] == 1){
-                if (h_number_ == 264) {
-                    nal_unit_type = recv_buf_[recv_buf_size_ + i]&0x1F;
-                } else if (h_number_ == 265) {
-                    nal_unit_type = (recv_buf_[recv_buf_size_ + i]&0x7E)>>1;
+        //check is there any data frame in the internal of the param frame,
+        //the first NAL is the param one just analyzed
+        stsw_next_nal_unit(&pos, end, h_number_, &nal);
+        while(stsw_next_nal_unit(&pos, end, h_number_, &nal)){
+            if(IsVCL(nal.type)){
+                if(IsIDR(nal.type)){
+                    frame_type = MEDIA_FRAME_TYPE_KEY_FRAME;   
                 }else{
-                    nal_unit_type = 0xFF;
-                }
-                if(IsVCL(nal_unit_type)){
-                    if(IsIDR(nal_unit_type)){
-                        frame_type = MEDIA_FRAME_TYPE_KEY_FRAME;   
-                    }else{
-                        frame_type = MEDIA_FRAME_TYPE_DATA_FRAME;               
-                    } 
-                    break;
-                } //if(IsVCL(nal_unit_type)){ 
-            }//if(recv_buf_[recv_buf_size_ + i - 4] == 0 &&
-        }//for(i=4; i<frameSize; i++){      
+                    frame_type = MEDIA_FRAME_TYPE_DATA_FRAME;               
+                } 
+                break;
+            } //if(IsVCL(nal.type)){ 
+        }//while(stsw_next_nal_unit(&pos, end, h_number_, &nal)){      
     }
     
     
-    //calculate the lost frames
-    CheckLostByTime(frame_type, presentationTime); 
-    
     
-    recv_buf_size_ += frameSize; // update current recv_buf size
+    frame_buf_->Commit(frameSize); // update current frame_buf size
     
     if(rtsp_client_ != NULL){        
         if(rtsp_client_->IsMetaReady()){   
             if(frame_type == MEDIA_FRAME_TYPE_PARAM_FRAME){
                 // just buffer this parameter nal   
                 
-                if(recv_buf_size_ > MAX_PARAMETER_NAL_SIZE){
+                if(frame_buf_->size() > MAX_PARAMETER_NAL_SIZE){
                     //Anormal case, may be results from packet lost
-                    rtsp_client_->AfterGettingFrame(sub_stream_index_, frame_type, 
-                                                    presentationTime, 
-                                                    recv_buf_size_, 
-                                                    (const char *)recv_buf_);    
-                    recv_buf_size_ = 0; // clear the buffer
+                    OutputFrameBuf(frame_type, presentationTime); 
                 }
                 
                 // buffer for the parameter frames
                 
             }else{
-                //send the whole recv_buf_
-                rtsp_client_->AfterGettingFrame(sub_stream_index_, frame_type, 
-                                                presentationTime, 
-                                                recv_buf_size_, 
-                                                (const char *)recv_buf_);   
-                recv_buf_size_ = 0; // clear the buffer
+                //send the whole frame_buf_ as segments, and clear it
+                OutputFrameBuf(frame_type, presentationTime);
             }                        
         }else{            
             if(frame_type == MEDIA_FRAME_TYPE_PARAM_FRAME){
                 // just buffer this parameter nal                   
-                if(recv_buf_size_ > MAX_PARAMETER_NAL_SIZE){
+                if(frame_buf_->size() > MAX_PARAMETER_NAL_SIZE){
                     //Anormal case, may be results from packet lost
-                    recv_buf_size_ = 0; // clear the buffer
+                    frame_buf_->Clear(); // clear the buffer
                 }
             }else{
                 //drop the frame, clear the buffer
-                recv_buf_size_ = 0; // clear the buffer
+                frame_buf_->Clear(); // clear the buffer
             }
         }        
     }else{
         //drop the whole frame
-        recv_buf_size_ = 0; // clear the buffer
+        frame_buf_->Clear(); // clear the buffer
     }
     
         
@@ -290,15 +283,7 @@ Boolean H264or5OutputSink::continuePlaying() {
     if (fSource == NULL) return False; // sanity check (should not happen)
     
     //h264/h265 need prepend the start code
-    memcpy(recv_buf_ + recv_buf_size_, start_code, 4);
-    recv_buf_size_ += 4;
-    
-    // Request the next frame of data from our input source.  
-    //"afterGettingFrame()" will get called later, when it arrives:
-    fSource->getNextFrame(recv_buf_ + recv_buf_size_, sink_buf_size_ - recv_buf_size_,
-                        afterGettingFrame, this,
-                        onSourceClosure, this);
-    return True; 
+    return GetNextFrame(start_code, 4);
 }
 
 
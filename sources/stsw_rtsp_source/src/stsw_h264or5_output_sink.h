@@ -61,7 +61,9 @@ public:
             MediaSubsession* subsession, // identifies the kind of data 
                                          //that's being received
             int32_t sub_stream_index,    // identifies the stream itself 
-            size_t sink_buf_size,        // receive buf size
+            size_t sink_buf_size,        // max frame size
+            size_t sink_recv_size,       // initial receive space
+            size_t sink_chunk_size,      // receive buf chunk size
             int h_number                 // 264 or 265
             );   
     
@@ -70,7 +72,7 @@ public:
     H264or5OutputSink(UsageEnvironment& env, LiveRtspClient *rtsp_client,
                     MediaSubsession* subsession, 
                     int32_t sub_stream_index, size_t sink_buf_size, 
-                    int h_number);
+                    size_t sink_recv_size, size_t sink_chunk_size, int h_number);
     // called only by "createNew()"
     virtual ~H264or5OutputSink();
 
@@ -89,7 +91,6 @@ protected:
 protected:
 
     int h_number_;
-    u_int32_t recv_buf_size_;
 
 
     
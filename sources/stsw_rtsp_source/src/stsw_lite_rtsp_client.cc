@@ -0,0 +1,1772 @@
+/**
+ * This file is part of stsw_rtsp_source, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_lite_rtsp_client.cc
+ *      LiteRtspClient class implementation file
+ *
+ * author: OpenSight Team
+ * date: 2016-4-8
+**/
+
+#include "stsw_lite_rtsp_client.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include "Base64.hh"
+
+
+static unsigned VideoFrameBufferSize = 8388608; /* 8M bytes, max video frame size */
+static unsigned AudioFrameBufferSize = 131072; /* 128K bytes, max audio frame size */
+static unsigned VideoFrameChunkSize = 131072; /* 128K bytes */
+static unsigned AudioFrameChunkSize = 16384; /* 16K bytes */
+static unsigned socketInputBufferSize = 1048576; /* 1M bytes */
+static int interPacketGapMaxTime = 10; //check for each 10 second
+
+static char const* userAgent = "StreamSwitch";
+
+#define RTSP_KEEPALIVE_INTERVAL 60 /*default is 60 sec*/
+
+#define METADATA_SUBSESSION_RESERVE_NUM 10
+
+// the max size of the parameter NALs buffered for the next frame
+#define MAX_PARAMETER_NAL_SIZE  1024
+
+// the RTP timestamp base is moved forward after this interval, so that
+// the 32-bit delta never overflows
+#define RTP_TS_BASE_UPDATE_INTERVAL 60   // 60 sec
+
+// the mapped timestamp is re-anchored to the local clock when it drifts
+// away more than this limit
+#define RTP_TS_MAX_DRIFT 3000000         // 3 sec
+
+#define AAC_SAMPLES_PER_FRAME 1024
+
+static const uint8_t start_code[4] = {0x00, 0x00, 0x00, 0x01};
+
+
+///////////////////////////////////////////////////////////
+//Text parsing utils
+
+static std::string TrimString(const std::string &str)
+{
+    size_t begin = str.find_first_not_of(" \t\r\n");
+    if(begin == std::string::npos){
+        return std::string();
+    }
+    size_t end = str.find_last_not_of(" \t\r\n");
+    return str.substr(begin, end - begin + 1);
+}
+
+// GetHeaderField()
+// Get the value of the first header field with the given name, or the
+// first one whose value begins with prefix if prefix is not NULL
+static bool GetHeaderField(const std::string &header, const char * name,
+                           const char * prefix, std::string *value)
+{
+    size_t name_len = strlen(name);
+    size_t pos = 0;
+    while(pos < header.size()){
+        size_t end = header.find("\r\n", pos);
+        if(end == std::string::npos){
+            end = header.size();
+        }
+        if(end - pos > name_len &&
+           strncasecmp(header.c_str() + pos, name, name_len) == 0 &&
+           header[pos + name_len] == ':'){
+            std::string field = TrimString(
+                header.substr(pos + name_len + 1, end - pos - name_len - 1));
+            if(prefix == NULL ||
+               strncasecmp(field.c_str(), prefix, strlen(prefix)) == 0){
+                if(value != NULL){
+                    *value = field;
+                }
+                return true;
+            }
+        }
+        pos = end + 2;
+    }
+    return false;
+}
+
+// GetParam()
+// Get the value of the parameter "name=value" in a parameter list which
+// is separated by sep, the quotes of the value are removed
+static std::string GetParam(const std::string &params, const char * name,
+                            char sep)
+{
+    size_t name_len = strlen(name);
+    size_t pos = 0;
+    while(pos < params.size()){
+        size_t end = params.find(sep, pos);
+        if(end == std::string::npos){
+            end = params.size();
+        }
+        std::string param = TrimString(params.substr(pos, end - pos));
+        if(param.size() > name_len &&
+           strncasecmp(param.c_str(), name, name_len) == 0 &&
+           param[name_len] == '='){
+            std::string value = TrimString(param.substr(name_len + 1));
+            if(value.size() >= 2 && value[0] == '"' &&
+               value[value.size() - 1] == '"'){
+                value = value.substr(1, value.size() - 2);
+            }
+            return value;
+        }
+        pos = end + 1;
+    }
+    return std::string();
+}
+
+// ParseRtspUrl()
+// Split rtsp://[user[:passwd]@]host[:port][/path] into parts, the url
+// without the user info is output in request_url
+static bool ParseRtspUrl(const std::string &url, std::string *host, int *port,
+                         std::string *user, std::string *passwd,
+                         std::string *request_url)
+{
+    const char prefix[] = "rtsp://";
+    if(strncasecmp(url.c_str(), prefix, sizeof(prefix) - 1) != 0){
+        return false;
+    }
+    size_t begin = sizeof(prefix) - 1;
+    size_t path_pos = url.find('/', begin);
+    if(path_pos == std::string::npos){
+        path_pos = url.size();
+    }
+    std::string authority = url.substr(begin, path_pos - begin);
+    size_t at_pos = authority.rfind('@');
+    if(at_pos != std::string::npos){
+        std::string user_info = authority.substr(0, at_pos);
+        size_t colon = user_info.find(':');
+        *user = user_info.substr(0, colon);
+        if(colon != std::string::npos){
+            *passwd = user_info.substr(colon + 1);
+        }
+        authority = authority.substr(at_pos + 1);
+    }
+    *request_url = std::string(prefix) + authority + url.substr(path_pos);
+
+    *port = 554;
+    size_t colon = authority.rfind(':');
+    if(colon != std::string::npos && authority.find(']', colon) == std::string::npos){
+        *port = atoi(authority.c_str() + colon + 1);
+        authority = authority.substr(0, colon);
+    }
+    if(authority.size() >= 2 && authority[0] == '['){
+        authority = authority.substr(1, authority.size() - 2);
+    }
+    *host = authority;
+    return host->size() != 0 && *port > 0 && *port < 65536;
+}
+
+// AppendData()
+// Append data to the frame buffer, return false if it's full
+static bool AppendData(FrameChunkBuf * frame_buf, const uint8_t * data, size_t size)
+{
+    while(size != 0){
+        size_t free_size = 0;
+        uint8_t * pos = frame_buf->GetWritePos(size, &free_size);
+        if(pos == NULL || free_size == 0){
+            return false;
+        }
+        if(free_size > size){
+            free_size = size;
+        }
+        memcpy(pos, data, free_size);
+        frame_buf->Commit(free_size);
+        data += free_size;
+        size -= free_size;
+    }
+    return true;
+}
+
+
+///////////////////////////////////////////////////////////
+//LiteStream
+
+LiteRtspClient::LiteStream::LiteStream()
+:payload_type(0), clock_rate(0), channels(0), bandwidth(0),
+sub_stream_index(-1), rtp_channel(-1),
+size_length(0), index_length(0), index_delta_length(0),
+has_seq(false), next_seq(0), has_ts_base(false), ts_base(0),
+frame_buf(NULL), frame_started(false), frame_ts(0),
+frame_damaged(false), frame_has_vcl(false), frame_is_key(false),
+in_fu(false), au_remaining(0),
+lost_packets(0), damaged_frames(0)
+{
+    local_base.tv_sec = 0;
+    local_base.tv_usec = 0;
+}
+
+
+///////////////////////////////////////////////////////////
+//Public interfaces
+
+LiteRtspClient * LiteRtspClient::CreateNew(UsageEnvironment& env, char const* rtspURL,
+                   Boolean enableRtspKeepAlive,
+                   char const* singleMedium,
+                   char const* userName, char const* passwd,
+                   LiveRtspClientListener * listener,
+                   int verbosityLevel,
+                   Boolean ignore_sdp_sps)
+{
+    std::string host, user, url_passwd, request_url;
+    int port;
+    if(rtspURL == NULL ||
+       !ParseRtspUrl(rtspURL, &host, &port, &user, &url_passwd, &request_url)){
+        return NULL;
+    }
+
+    return new LiteRtspClient(env, rtspURL, enableRtspKeepAlive,
+                              singleMedium, userName, passwd, listener,
+                              verbosityLevel, ignore_sdp_sps);
+}
+
+LiteRtspClient::LiteRtspClient(UsageEnvironment& env, char const* rtspURL,
+                   Boolean enableRtspKeepAlive,
+                   char const* singleMedium,
+                   char const* userName, char const* passwd,
+                   LiveRtspClientListener * listener,
+                   int verbosityLevel,
+                   Boolean ignore_sdp_sps)
+:env_(env), listener_(listener), are_already_shutting_down_(True),
+enable_rtsp_keep_alive_(enableRtspKeepAlive),
+rtsp_url_(rtspURL), verbosity_level_(verbosityLevel),
+ignore_sdp_sps_(ignore_sdp_sps), drop_damaged_frames_(False),
+our_authenticator(NULL), auth_tried_(false),
+socket_(-1), state_(STATE_IDLE), cseq_(0), session_timeout_(0),
+read_buf_(new uint8_t[LITE_RTSP_READ_BUF_SIZE]), read_size_(0),
+setup_index_(0), drift_ref_index_(0), is_metadata_ok_(False),
+rtsp_keep_alive_task_(NULL), rtsp_timeout_task_(NULL),
+inter_frame_gap_check_timer_task_(NULL),
+reconnect_min_interval_(RTSP_CLIENT_RECONNECT_MIN_INTERVAL),
+reconnect_max_interval_(0),
+reconnect_interval_(RTSP_CLIENT_RECONNECT_MIN_INTERVAL),
+reconnect_task_(NULL), has_played_(False), has_prev_metadata_(False)
+{
+    std::string host, user, url_passwd;
+    int port;
+    ParseRtspUrl(rtsp_url_, &host, &port, &user, &url_passwd, &base_url_);
+
+    if(singleMedium != NULL){
+        single_medium_ = singleMedium;
+    }
+    if(userName != NULL){
+        our_authenticator = new Authenticator(userName, passwd);
+    }else if(user.size() != 0){
+        // the user info embedded in the url
+        our_authenticator = new Authenticator(user.c_str(), url_passwd.c_str());
+    }
+
+    last_frame_time_.tv_sec = 0;
+    last_frame_time_.tv_usec = 0;
+
+    metadata_.source_proto = "RTSP";
+    metadata_.play_type = stream_switch::STREAM_PLAY_TYPE_LIVE;
+    metadata_.sub_streams.reserve(METADATA_SUBSESSION_RESERVE_NUM);
+    segments_.reserve(8);
+}
+
+LiteRtspClient::~LiteRtspClient()
+{
+    StopTimers();
+    if(reconnect_task_ != NULL) {
+        env_.taskScheduler().unscheduleDelayedTask(reconnect_task_);
+        reconnect_task_ = NULL;
+    }
+    CloseConnection();
+    ClearStreams();
+
+    delete[] read_buf_;
+    read_buf_ = NULL;
+
+    if(our_authenticator != NULL){
+        delete our_authenticator;
+        our_authenticator = NULL;
+    }
+}
+
+int LiteRtspClient::Start()
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    //select a random ssrc
+    srand(now.tv_sec + now.tv_usec);
+    do{
+        metadata_.ssrc = (uint32_t)(rand() % 0xffffffff);
+    }while(metadata_.ssrc == 0);
+
+    are_already_shutting_down_ = False;
+
+    // start the timeout check
+    rtsp_timeout_task_ = env_.taskScheduler().scheduleDelayedTask(
+        60000000 /* 1 minutes */, (TaskFunc*)RtspClientConnectTimeout,
+        (void*)this);
+
+    if(Connect()){
+        HandleError(RTSP_CLIENT_ERR_CONNECT_FAIL, "Failed to connect the server");
+    }
+    return 0;
+}
+
+void LiteRtspClient::Shutdown()
+{
+    //if not start or already shutdown, just return
+    if (are_already_shutting_down_) return;
+    are_already_shutting_down_ = True;
+
+    //cancel the delay task
+    StopTimers();
+    if(reconnect_task_ != NULL) {
+        env_.taskScheduler().unscheduleDelayedTask(reconnect_task_);
+        reconnect_task_ = NULL;
+    }
+
+    // Teardown, then shutdown immediately
+    if(socket_ >= 0 && session_id_.size() != 0){
+        SendRequest("TEARDOWN", base_url_, std::string());
+    }
+    CloseConnection();
+    ClearStreams();
+    state_ = STATE_IDLE;
+}
+
+void LiteRtspClient::SetReconnectInterval(unsigned min_interval, unsigned max_interval)
+{
+    if(min_interval == 0){
+        min_interval = RTSP_CLIENT_RECONNECT_MIN_INTERVAL;
+    }
+    if(max_interval != 0 && max_interval < min_interval){
+        max_interval = min_interval;
+    }
+    reconnect_min_interval_ = min_interval;
+    reconnect_max_interval_ = max_interval;
+    reconnect_interval_ = min_interval;
+}
+
+
+////////////////////////////////////////////////////////////
+//Socket handler
+
+void LiteRtspClient::ConnectionHandler(void* clientData, int mask)
+{
+    LiteRtspClient *my_client = (LiteRtspClient *)clientData;
+    int err = 0;
+    socklen_t len = sizeof(err);
+
+    if(getsockopt(my_client->socket_, SOL_SOCKET, SO_ERROR, &err, &len) < 0){
+        err = errno;
+    }
+    if(err != 0){
+        my_client->env_ << "Failed to connect \"" << my_client->base_url_.c_str()
+                        << "\": " << strerror(err) << "\n";
+        my_client->HandleError(RTSP_CLIENT_ERR_CONNECT_FAIL,
+            "Failed to connect the server");
+        return;
+    }
+
+    my_client->env_.taskScheduler().setBackgroundHandling(my_client->socket_,
+        SOCKET_READABLE|SOCKET_EXCEPTION,
+        (TaskScheduler::BackgroundHandlerProc*)IncomingDataHandler, my_client);
+    my_client->SendDescribe();
+}
+
+void LiteRtspClient::IncomingDataHandler(void* clientData, int mask)
+{
+    LiteRtspClient *my_client = (LiteRtspClient *)clientData;
+    my_client->ReadSocket();
+}
+
+
+////////////////////////////////////////////////////////////
+//RTSP protocol
+
+int LiteRtspClient::Connect()
+{
+    std::string host, user, passwd, request_url;
+    int port;
+    struct addrinfo hints, *res = NULL;
+    char port_str[16];
+    int ret;
+
+    if(!ParseRtspUrl(rtsp_url_, &host, &port, &user, &passwd, &request_url)){
+        return -1;
+    }
+    snprintf(port_str, sizeof(port_str), "%d", port);
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    ret = getaddrinfo(host.c_str(), port_str, &hints, &res);
+    if(ret != 0 || res == NULL){
+        env_ << "Failed to resolve \"" << host.c_str() << "\": "
+             << gai_strerror(ret) << "\n";
+        return -1;
+    }
+
+    socket_ = socket(res->ai_family, SOCK_STREAM, 0);
+    if(socket_ < 0){
+        freeaddrinfo(res);
+        return -1;
+    }
+    fcntl(socket_, F_SETFL, fcntl(socket_, F_GETFL, 0) | O_NONBLOCK);
+    setsockopt(socket_, SOL_SOCKET, SO_RCVBUF,
+               &socketInputBufferSize, sizeof(socketInputBufferSize));
+
+    state_ = STATE_CONNECTING;
+    read_size_ = 0;
+    ret = connect(socket_, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+    if(ret < 0 && errno != EINPROGRESS){
+        env_ << "Failed to connect \"" << base_url_.c_str() << "\": "
+             << strerror(errno) << "\n";
+        CloseConnection();
+        return -1;
+    }
+
+    // wait for the connection in the event loop, even if it's already
+    // connected, so that the error is always reported asynchronously
+    env_.taskScheduler().setBackgroundHandling(socket_,
+        SOCKET_WRITABLE|SOCKET_EXCEPTION,
+        (TaskScheduler::BackgroundHandlerProc*)ConnectionHandler, this);
+    return 0;
+}
+
+void LiteRtspClient::CloseConnection()
+{
+    if(socket_ >= 0){
+        env_.taskScheduler().disableBackgroundHandling(socket_);
+        close(socket_);
+        socket_ = -1;
+    }
+    read_size_ = 0;
+}
+
+void LiteRtspClient::ReadSocket()
+{
+    ssize_t n;
+    size_t pos = 0;
+
+    if(read_size_ >= LITE_RTSP_READ_BUF_SIZE){
+        HandleError(state_ == STATE_PLAYING ?
+                    RTSP_CLIENT_ERR_SUBSESSION_BYE : RTSP_CLIENT_ERR_CONNECT_FAIL,
+                    "Invalid data from the server");
+        return;
+    }
+    n = recv(socket_, read_buf_ + read_size_,
+             LITE_RTSP_READ_BUF_SIZE - read_size_, 0);
+    if(n <= 0){
+        if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)){
+            return;
+        }
+        env_ << "RTSP connection closed: "
+             << (n == 0 ? "closed by the server" : strerror(errno)) << "\n";
+        HandleError(state_ == STATE_PLAYING ?
+                    RTSP_CLIENT_ERR_SUBSESSION_BYE : RTSP_CLIENT_ERR_CONNECT_FAIL,
+                    "RTSP connection closed");
+        return;
+    }
+    read_size_ += n;
+
+    // parse the interleaved frames and the responses in place
+    while(pos < read_size_){
+        const uint8_t * data = read_buf_ + pos;
+        size_t data_size = read_size_ - pos;
+
+        if(data[0] == '$'){
+            if(data_size < 4){
+                break;
+            }
+            size_t packet_size = ((size_t)data[2] << 8) | data[3];
+            if(data_size < 4 + packet_size){
+                break;
+            }
+            HandleRtpPacket(data[1], data + 4, packet_size);
+            pos += 4 + packet_size;
+
+        }else if(data[0] >= 'A' && data[0] <= 'Z'){
+            // a response, or a request from the server
+            const char * header_end = (const char *)memmem(data, data_size, "\r\n\r\n", 4);
+            if(header_end == NULL){
+                if(data_size > LITE_RTSP_MAX_RESPONSE_SIZE){
+                    HandleError(state_ == STATE_PLAYING ?
+                                RTSP_CLIENT_ERR_SUBSESSION_BYE : RTSP_CLIENT_ERR_CONNECT_FAIL,
+                                "Invalid response from the server");
+                    return;
+                }
+                break;
+            }
+            size_t header_size = header_end + 4 - (const char *)data;
+            std::string header((const char *)data, header_size);
+            std::string length_str;
+            size_t body_size = 0;
+            if(GetHeaderField(header, "Content-Length", NULL, &length_str)){
+                body_size = strtoul(length_str.c_str(), NULL, 10);
+            }
+            if(header_size + body_size > LITE_RTSP_MAX_RESPONSE_SIZE){
+                HandleError(state_ == STATE_PLAYING ?
+                            RTSP_CLIENT_ERR_SUBSESSION_BYE : RTSP_CLIENT_ERR_CONNECT_FAIL,
+                            "Too large response from the server");
+                return;
+            }
+            if(data_size < header_size + body_size){
+                break;
+            }
+            pos += header_size + body_size;
+
+            if(verbosity_level_ > 0){
+                env_ << "Received a message:\n" << header.c_str() << "\n";
+            }
+            int status_code = 0;
+            if(strncmp(header.c_str(), "RTSP/", 5) == 0 &&
+               sscanf(header.c_str(), "RTSP/%*s %d", &status_code) == 1){
+                HandleResponse(status_code, header,
+                               (const char *)data + header_size, body_size);
+            }
+            // the requests from the server are ignored
+
+        }else{
+            // garbage, skip it to resync
+            pos++;
+        }
+
+        if(socket_ < 0){
+            // the connection is closed in the handler
+            return;
+        }
+    }
+
+    if(pos != 0){
+        if(pos < read_size_){
+            memmove(read_buf_, read_buf_ + pos, read_size_ - pos);
+        }
+        read_size_ -= pos;
+    }
+}
+
+int LiteRtspClient::SendRequest(const char * method, const std::string &url,
+                                const std::string &extra_headers)
+{
+    char line[64];
+    std::string request;
+
+    request.reserve(512);
+    request.append(method).append(" ").append(url).append(" RTSP/1.0\r\n");
+    snprintf(line, sizeof(line), "CSeq: %u\r\n", ++cseq_);
+    request.append(line);
+    request.append("User-Agent: ").append(userAgent).append("\r\n");
+
+    if(our_authenticator != NULL && our_authenticator->realm() != NULL){
+        if(our_authenticator->nonce() != NULL){
+            char const* response =
+                our_authenticator->computeDigestResponse(method, url.c_str());
+            request.append("Authorization: Digest username=\"")
+                   .append(our_authenticator->username())
+                   .append("\", realm=\"").append(our_authenticator->realm())
+                   .append("\", nonce=\"").append(our_authenticator->nonce())
+                   .append("\", uri=\"").append(url)
+                   .append("\", response=\"").append(response).append("\"\r\n");
+            our_authenticator->reclaimDigestResponse(response);
+        }else{
+            std::string user_pass = our_authenticator->username();
+            user_pass.append(":").append(our_authenticator->password());
+            char * encoded = base64Encode(user_pass.c_str(), user_pass.size());
+            request.append("Authorization: Basic ").append(encoded).append("\r\n");
+            delete[] encoded;
+        }
+    }
+    if(session_id_.size() != 0){
+        request.append("Session: ").append(session_id_).append("\r\n");
+    }
+    request.append(extra_headers);
+    request.append("\r\n");
+
+    if(verbosity_level_ > 0){
+        env_ << "Sending request:\n" << request.c_str();
+    }
+
+    // the request is tiny, the socket send buffer should always hold it
+    size_t sent = 0;
+    while(sent < request.size()){
+        ssize_t n = send(socket_, request.data() + sent, request.size() - sent,
+                         MSG_NOSIGNAL);
+        if(n < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            env_ << "Failed to send " << method << " request: "
+                 << strerror(errno) << "\n";
+            return -1;
+        }
+        sent += n;
+    }
+
+    last_method_ = method;
+    last_url_ = url;
+    last_headers_ = extra_headers;
+    return 0;
+}
+
+void LiteRtspClient::HandleResponse(int status_code, const std::string &header,
+                                    const char * body, size_t body_size)
+{
+    RtspClientErrCode err_code;
+    switch(state_){
+    case STATE_DESCRIBE:
+        err_code = RTSP_CLIENT_ERR_DESCRIBE_ERR;
+        break;
+    case STATE_SETUP:
+        err_code = RTSP_CLIENT_ERR_SETUP_ERR;
+        break;
+    case STATE_PLAY:
+        err_code = RTSP_CLIENT_ERR_PLAY_ERR;
+        break;
+    case STATE_PLAYING:
+        // the response of keep-alive, the server may not support it,
+        // which does not matter as long as the media keeps on
+        if(status_code < 200 || status_code >= 300){
+            env_ << "Keep-alive request failed with status "
+                 << status_code << "\n";
+        }
+        return;
+    default:
+        return;
+    }
+
+    if(status_code == 401 && HandleUnauthorized(header)){
+        // retry the request with the credential
+        if(SendRequest(last_method_.c_str(), last_url_, last_headers_)){
+            HandleError(RTSP_CLIENT_ERR_CONNECT_FAIL, "Failed to send the request");
+        }
+        return;
+    }
+    if(status_code < 200 || status_code >= 300){
+        env_ << last_method_.c_str() << " \"" << last_url_.c_str()
+             << "\" failed with status " << status_code << "\n";
+        HandleError(err_code, "RTSP request failed");
+        return;
+    }
+    auth_tried_ = false;
+
+    switch(state_){
+    case STATE_DESCRIBE:
+        AfterDescribe(header, body, body_size);
+        break;
+    case STATE_SETUP:
+        AfterSetup(header);
+        break;
+    case STATE_PLAY:
+        AfterPlay(header);
+        break;
+    default:
+        break;
+    }
+}
+
+bool LiteRtspClient::HandleUnauthorized(const std::string &header)
+{
+    std::string auth;
+    if(our_authenticator == NULL){
+        env_ << "The server requires authentication, but no user is given\n";
+        return false;
+    }
+
+    if(GetHeaderField(header, "WWW-Authenticate", "Digest", &auth)){
+        std::string realm = GetParam(auth.substr(6), "realm", ',');
+        std::string nonce = GetParam(auth.substr(6), "nonce", ',');
+        std::string stale = GetParam(auth.substr(6), "stale", ',');
+        if(auth_tried_ && strcasecmp(stale.c_str(), "true") != 0){
+            return false; // the credential is refused
+        }
+        our_authenticator->setRealmAndNonce(realm.c_str(), nonce.c_str());
+    }else if(GetHeaderField(header, "WWW-Authenticate", "Basic", &auth)){
+        if(auth_tried_){
+            return false;
+        }
+        std::string realm = GetParam(auth.substr(5), "realm", ',');
+        our_authenticator->setRealmAndNonce(realm.c_str(), NULL);
+    }else{
+        return false;
+    }
+    auth_tried_ = true;
+    return true;
+}
+
+void LiteRtspClient::SendDescribe()
+{
+    state_ = STATE_DESCRIBE;
+    if(SendRequest("DESCRIBE", base_url_, "Accept: application/sdp\r\n")){
+        HandleError(RTSP_CLIENT_ERR_CONNECT_FAIL, "Failed to send DESCRIBE");
+    }
+}
+
+void LiteRtspClient::SendNextSetup()
+{
+    LiteStream * stream = streams_[setup_index_];
+    char transport[128];
+
+    // the interleaved channels are assigned in the order of the streams
+    snprintf(transport, sizeof(transport),
+             "Transport: RTP/AVP/TCP;unicast;interleaved=%d-%d\r\n",
+             (int)setup_index_ * 2, (int)setup_index_ * 2 + 1);
+    stream->rtp_channel = (int)setup_index_ * 2;
+
+    state_ = STATE_SETUP;
+    if(SendRequest("SETUP", stream->control_url, transport)){
+        HandleError(RTSP_CLIENT_ERR_SETUP_ERR, "Failed to send SETUP");
+    }
+}
+
+void LiteRtspClient::SendPlay()
+{
+    state_ = STATE_PLAY;
+    if(SendRequest("PLAY", base_url_, "Range: npt=0.000-\r\n")){
+        HandleError(RTSP_CLIENT_ERR_PLAY_ERR, "Failed to send PLAY");
+    }
+}
+
+void LiteRtspClient::AfterDescribe(const std::string &header,
+                                   const char * body, size_t body_size)
+{
+    std::string value;
+    if(GetHeaderField(header, "Content-Base", NULL, &value) ||
+       GetHeaderField(header, "Content-Location", NULL, &value)){
+        base_url_ = value;
+    }
+
+    std::string sdp(body, body_size);
+    if(verbosity_level_ > 0){
+        env_ << "Got a SDP description:\n" << sdp.c_str() << "\n";
+    }
+    if(ParseSdp(sdp)){
+        HandleError(RTSP_CLIENT_ERR_MEDIASESSION_CREATE_FAIL,
+            "Failed to parse the SDP");
+        return;
+    }
+    if(streams_.size() == 0){
+        env_ << "This session has no H264/H265/AAC subsessions\n";
+        HandleError(RTSP_CLIENT_ERR_NO_SUBSESSION,
+            "This session has no supported media subsessions");
+        return;
+    }
+
+    // the drift of the server's clock is tracked on the video stream,
+    // whose frame rate is steady
+    drift_ref_index_ = streams_[0]->sub_stream_index;
+    for(LiteStreamList::iterator it = streams_.begin(); it != streams_.end(); it++){
+        if((*it)->medium == "video"){
+            drift_ref_index_ = (*it)->sub_stream_index;
+            break;
+        }
+    }
+
+    SetupMetadata();
+
+    setup_index_ = 0;
+    SendNextSetup();
+}
+
+void LiteRtspClient::AfterSetup(const std::string &header)
+{
+    std::string value;
+    LiteStream * stream = streams_[setup_index_];
+
+    if(GetHeaderField(header, "Session", NULL, &value)){
+        size_t semicolon = value.find(';');
+        session_id_ = TrimString(value.substr(0, semicolon));
+        if(semicolon != std::string::npos){
+            session_timeout_ = strtoul(
+                GetParam(value.substr(semicolon + 1), "timeout", ';').c_str(),
+                NULL, 10);
+        }
+    }
+    if(GetHeaderField(header, "Transport", NULL, &value)){
+        std::string channels = GetParam(value, "interleaved", ';');
+        if(channels.size() != 0){
+            // the server may choose other channels
+            stream->rtp_channel = atoi(channels.c_str());
+        }
+    }
+
+    env_ << "Setup \"" << stream->medium.c_str() << "/" << stream->codec.c_str()
+         << "\" subsession (interleaved channel " << stream->rtp_channel << ")\n";
+
+    setup_index_++;
+    if(setup_index_ < streams_.size()){
+        SendNextSetup();
+    }else{
+        SendPlay();
+    }
+}
+
+void LiteRtspClient::AfterPlay(const std::string &header)
+{
+    state_ = STATE_PLAYING;
+    has_played_ = True;
+    reconnect_interval_ = reconnect_min_interval_;
+
+    if(rtsp_timeout_task_ != NULL) {
+        env_.taskScheduler().unscheduleDelayedTask(rtsp_timeout_task_);
+        rtsp_timeout_task_ = NULL;
+    }
+
+    env_ << "Started playing session\n";
+
+    if(enable_rtsp_keep_alive_){
+        unsigned sessionTimeout = session_timeout_ == 0 ?
+            RTSP_KEEPALIVE_INTERVAL/*default*/ : session_timeout_;
+        unsigned secondsUntilNextKeepAlive = sessionTimeout <= 5 ? 1 : sessionTimeout - 5;
+        // Reduce the interval a little, to be on the safe side
+        rtsp_keep_alive_task_ = env_.taskScheduler().scheduleDelayedTask(
+            secondsUntilNextKeepAlive * 1000000,
+            (TaskFunc*)RtspKeepAliveHandler, this);
+    }
+
+    gettimeofday(&last_frame_time_, NULL);
+    inter_frame_gap_check_timer_task_ = env_.taskScheduler().scheduleDelayedTask(
+        1000000, (TaskFunc*)CheckInterFrameGaps, this);
+
+    if(listener_ != NULL){
+        listener_->OnRtspOK();
+    }
+}
+
+
+////////////////////////////////////////////////////////////
+//SDP and metadata
+
+int LiteRtspClient::ParseSdp(const std::string &sdp)
+{
+    LiteStreamList media;
+    LiteStream * cur = NULL;
+    std::string session_control;
+    bool single_medium_found = false;
+    size_t pos = 0;
+
+    // collect all the media sections
+    while(pos < sdp.size()){
+        size_t end = sdp.find('\n', pos);
+        if(end == std::string::npos){
+            end = sdp.size();
+        }
+        std::string line = TrimString(sdp.substr(pos, end - pos));
+        pos = end + 1;
+        if(line.size() < 2 || line[1] != '='){
+            continue;
+        }
+
+        if(line[0] == 'm'){
+            char medium[32], proto[32];
+            unsigned port, payload_type;
+            cur = new LiteStream;
+            media.push_back(cur);
+            if(sscanf(line.c_str() + 2, "%31s %u %31s %u",
+                      medium, &port, proto, &payload_type) == 4 &&
+               strstr(proto, "RTP/AVP") != NULL){
+                cur->medium = medium;
+                cur->payload_type = payload_type;
+            }
+        }else if(line.compare(0, 10, "a=control:") == 0){
+            if(cur == NULL){
+                session_control = line.substr(10);
+            }else{
+                cur->control_url = line.substr(10);
+            }
+        }else if(cur == NULL){
+            continue;
+        }else if(line.compare(0, 9, "a=rtpmap:") == 0){
+            char codec[32];
+            unsigned payload_type, clock_rate, channels = 0;
+            int num = sscanf(line.c_str() + 9, "%u %31[^/]/%u/%u",
+                             &payload_type, codec, &clock_rate, &channels);
+            if(num >= 3 && payload_type == cur->payload_type){
+                for(char *c = codec; *c != 0; c++){
+                    *c = toupper(*c);
+                }
+                cur->codec = codec;
+                cur->clock_rate = clock_rate;
+                cur->channels = channels;
+            }
+        }else if(line.compare(0, 7, "a=fmtp:") == 0){
+            size_t space = line.find(' ');
+            if(space != std::string::npos &&
+               strtoul(line.c_str() + 7, NULL, 10) == cur->payload_type){
+                cur->fmtp = line.substr(space + 1);
+            }
+        }else if(line.compare(0, 5, "b=AS:") == 0){
+            cur->bandwidth = strtoul(line.c_str() + 5, NULL, 10);
+        }
+    }
+
+    if(session_control.size() != 0 && session_control != "*" &&
+       strncasecmp(session_control.c_str(), "rtsp://", 7) == 0){
+        base_url_ = session_control;
+    }
+
+    // pick up the supported ones
+    ClearStreams();
+    for(LiteStreamList::iterator it = media.begin(); it != media.end(); it++){
+        LiteStream * stream = *it;
+        bool supported = false;
+        if(stream->medium == "video"){
+            supported = (stream->codec == "H264" || stream->codec == "H265");
+        }else if(stream->medium == "audio" && stream->codec == "MPEG4-GENERIC"){
+            stream->size_length = strtoul(
+                GetParam(stream->fmtp, "sizelength", ';').c_str(), NULL, 10);
+            stream->index_length = strtoul(
+                GetParam(stream->fmtp, "indexlength", ';').c_str(), NULL, 10);
+            stream->index_delta_length = strtoul(
+                GetParam(stream->fmtp, "indexdeltalength", ';').c_str(), NULL, 10);
+            supported = (stream->size_length != 0 && stream->clock_rate != 0);
+        }
+        if(!supported || streams_.size() >= LITE_RTSP_MAX_STREAMS){
+            if(stream->medium.size() != 0){
+                env_ << "Ignoring \"" << stream->medium.c_str() << "/"
+                     << stream->codec.c_str()
+                     << "\" subsession, which is not supported by the lite engine\n";
+            }
+            delete stream;
+            continue;
+        }
+        if(single_medium_.size() != 0){
+            if(stream->medium != single_medium_ || single_medium_found){
+                env_ << "Ignoring \"" << stream->medium.c_str() << "/"
+                     << stream->codec.c_str()
+                     << "\" subsession, because we've asked to receive a single "
+                     << single_medium_.c_str() << " session only\n";
+                delete stream;
+                continue;
+            }
+            single_medium_found = true;
+        }
+
+        // resolve the control url
+        if(stream->control_url.size() == 0 || stream->control_url == "*"){
+            stream->control_url = base_url_;
+        }else if(strncasecmp(stream->control_url.c_str(), "rtsp://", 7) != 0){
+            std::string control = base_url_;
+            if(control.size() == 0 || control[control.size() - 1] != '/'){
+                control.append("/");
+            }
+            stream->control_url = control + stream->control_url;
+        }
+
+        if(stream->clock_rate == 0){
+            stream->clock_rate = 90000;
+        }
+        stream->sub_stream_index = (int32_t)streams_.size();
+        if(stream->medium == "video"){
+            stream->frame_buf = new FrameChunkBuf(VideoFrameChunkSize, VideoFrameBufferSize);
+        }else{
+            stream->frame_buf = new FrameChunkBuf(AudioFrameChunkSize, AudioFrameBufferSize);
+        }
+        streams_.push_back(stream);
+    }
+    return 0;
+}
+
+void LiteRtspClient::SetupMetadata()
+{
+    using namespace stream_switch;
+    uint32_t bps = 0;
+
+    metadata_.sub_streams.clear();
+    is_metadata_ok_ = False;
+
+    for(LiteStreamList::iterator it = streams_.begin(); it != streams_.end(); it++){
+        LiteStream * stream = *it;
+        SubStreamMetadata sub_metadata;
+
+        sub_metadata.sub_stream_index = stream->sub_stream_index;
+        sub_metadata.codec_name = stream->codec;
+        sub_metadata.direction = SUB_STREAM_DIRECTION_OUTBOUND;
+
+        if(stream->medium == "video"){
+            sub_metadata.media_type = SUB_STREAM_MEIDA_TYPE_VIDEO;
+            if(!ignore_sdp_sps_){
+                const char * sprop_names[3] = {
+                    "sprop-parameter-sets", NULL, NULL};
+                if(stream->codec == "H265"){
+                    sprop_names[0] = "sprop-vps";
+                    sprop_names[1] = "sprop-sps";
+                    sprop_names[2] = "sprop-pps";
+                }
+                for(unsigned j = 0; j < 3 && sprop_names[j] != NULL; ++j) {
+                    std::string sprop = GetParam(stream->fmtp, sprop_names[j], ';');
+                    if(sprop.size() == 0){
+                        continue;
+                    }
+                    unsigned numSPropRecords;
+                    SPropRecord* sPropRecords =
+                        parseSPropParameterSets(sprop.c_str(), numSPropRecords);
+                    for (unsigned i = 0; i < numSPropRecords; ++i) {
+                        if(sPropRecords[i].sPropLength == 0){
+                            continue;
+                        }
+                        sub_metadata.extra_data.append((const char *)start_code, 4);
+                        sub_metadata.extra_data.append(
+                            (const char *)sPropRecords[i].sPropBytes,
+                            (size_t)sPropRecords[i].sPropLength);
+                    }
+                    delete[] sPropRecords;
+                }
+            }//if(!ignore_sdp_sps_)
+
+        }else{
+            sub_metadata.media_type = SUB_STREAM_MEIDA_TYPE_AUDIO;
+            sub_metadata.codec_name = "AAC";
+            sub_metadata.media_param.audio.channels =
+                stream->channels != 0 ? stream->channels : 1;
+            sub_metadata.media_param.audio.samples_per_second = stream->clock_rate;
+            std::string config_str = GetParam(stream->fmtp, "config", ';');
+            unsigned configSize = 0;
+            unsigned char* config = parseGeneralConfigStr(
+                config_str.size() ? config_str.c_str() : NULL, configSize);
+            if(configSize != 0 && config != NULL){
+                sub_metadata.extra_data.assign((const char *)config, (size_t)configSize);
+            }
+            delete[] config;
+        }
+
+        bps += stream->bandwidth * 1000;
+        metadata_.sub_streams.push_back(sub_metadata);
+    }
+    metadata_.bps = bps;
+
+    CheckMetadata();
+}
+
+bool LiteRtspClient::CheckMetadata()
+{
+    using namespace stream_switch;
+    if(is_metadata_ok_){
+        //if OK already, just ignore
+        return true;
+    }
+    if(metadata_.ssrc == 0 || metadata_.sub_streams.size() == 0){
+        return false;
+    }
+
+    //check each subsession
+    SubStreamMetadataVector::iterator it;
+    for(it = metadata_.sub_streams.begin();
+        it != metadata_.sub_streams.end();
+        it++)
+    {
+        if(it->media_type == SUB_STREAM_MEIDA_TYPE_VIDEO &&
+           it->extra_data.size() == 0){
+            //extra_data must present
+            return false;
+        }
+    }
+
+    //check successful
+    is_metadata_ok_ = True;
+
+    if(has_prev_metadata_){
+        // reconnected, keep on the ssrc if the codec configuration is
+        // unchanged, so that the subscribers only see a gap of frames
+        has_prev_metadata_ = False;
+        if(IsSameCodecConfig(prev_metadata_, metadata_)){
+            env_ << "Codec configuration unchanged after reconnect, "
+                 << "keep on the stream\n";
+            return true;
+        }
+        uint32_t prev_ssrc = metadata_.ssrc;
+        do{
+            metadata_.ssrc = (uint32_t)(rand() % 0xffffffff);
+        }while(metadata_.ssrc == 0 || metadata_.ssrc == prev_ssrc);
+        env_ << "Codec configuration changed after reconnect, "
+             << "select a new ssrc\n";
+    }
+
+    if(listener_ != NULL){
+        listener_->OnMetaReady(metadata_);
+    }
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////
+//RTP depacketization
+
+void LiteRtspClient::HandleRtpPacket(int channel, const uint8_t * packet, size_t size)
+{
+    LiteStream * stream = NULL;
+    for(LiteStreamList::iterator it = streams_.begin(); it != streams_.end(); it++){
+        if((*it)->rtp_channel == channel){
+            stream = *it;
+            break;
+        }
+    }
+    if(stream == NULL || state_ != STATE_PLAYING){
+        // RTCP or unknown channel
+        return;
+    }
+
+    // RTP header
+    if(size < 12 || (packet[0] >> 6) != 2 ||
+       (packet[1] & 0x7f) != stream->payload_type){
+        return;
+    }
+    size_t header_size = 12 + (packet[0] & 0x0f) * 4;
+    if(packet[0] & 0x10){
+        // header extension
+        if(size < header_size + 4){
+            return;
+        }
+        header_size += 4 + ((((size_t)packet[header_size + 2]) << 8) |
+                            packet[header_size + 3]) * 4;
+    }
+    if(packet[0] & 0x20){
+        // padding
+        size_t padding = packet[size - 1];
+        if(size < header_size + padding){
+            return;
+        }
+        size -= padding;
+    }
+    if(size < header_size){
+        return;
+    }
+    bool marker = (packet[1] & 0x80) != 0;
+    uint16_t seq = ((uint16_t)packet[2] << 8) | packet[3];
+    uint32_t rtp_ts = ((uint32_t)packet[4] << 24) | ((uint32_t)packet[5] << 16) |
+                      ((uint32_t)packet[6] << 8) | packet[7];
+
+    // sequence check, TCP never reorders, so a gap means loss upstream
+    if(stream->has_seq && seq != stream->next_seq){
+        uint16_t gap = seq - stream->next_seq;
+        if(gap >= 0x8000){
+            return; // duplicate or old packet
+        }
+        stream->lost_packets += gap;
+        if(stream->au_remaining != 0){
+            // the fragmented AU is broken, while the lost packets of
+            // whole AUs just lose frames
+            stream->au_remaining = 0;
+            stream->damaged_frames++;
+            stream->frame_buf->Clear();
+            stream->frame_damaged = false;
+        }else if(stream->medium == "video"){
+            stream->frame_damaged = true;
+            stream->in_fu = false;
+        }
+    }
+    stream->has_seq = true;
+    stream->next_seq = seq + 1;
+
+    const uint8_t * payload = packet + header_size;
+    size_t payload_size = size - header_size;
+
+    if(stream->medium == "audio"){
+        HandleAacPayload(stream, rtp_ts, payload, payload_size);
+        return;
+    }
+
+    // a new timestamp means a new access unit, even if the marker is lost
+    if(stream->frame_started && rtp_ts != stream->frame_ts){
+        FlushFrame(stream);
+    }
+    if(!stream->frame_started){
+        stream->frame_started = true;
+        stream->frame_ts = rtp_ts;
+    }
+    if(stream->codec == "H264"){
+        HandleH264Payload(stream, payload, payload_size, marker);
+    }else{
+        HandleH265Payload(stream, payload, payload_size, marker);
+    }
+}
+
+void LiteRtspClient::HandleH264Payload(LiteStream * stream, const uint8_t * payload,
+                                       size_t size, bool marker)
+{
+    if(size >= 1){
+        uint8_t nal_type = payload[0] & 0x1f;
+        if(nal_type >= 1 && nal_type <= 23){
+            // single NAL unit
+            AppendNal(stream, NULL, 0, payload, size, true);
+
+        }else if(nal_type == 24){
+            // STAP-A
+            size_t pos = 1;
+            while(pos + 2 <= size){
+                size_t nal_size = ((size_t)payload[pos] << 8) | payload[pos + 1];
+                pos += 2;
+                if(nal_size == 0 || pos + nal_size > size){
+                    stream->frame_damaged = true;
+                    break;
+                }
+                AppendNal(stream, NULL, 0, payload + pos, nal_size, true);
+                pos += nal_size;
+            }
+
+        }else if(nal_type == 28 && size >= 2){
+            // FU-A
+            uint8_t fu_header = payload[1];
+            if(fu_header & 0x80){
+                uint8_t nal_header = (payload[0] & 0xe0) | (fu_header & 0x1f);
+                if(stream->in_fu){
+                    stream->frame_damaged = true; // the end of last FU lost
+                }
+                AppendNal(stream, &nal_header, 1, payload + 2, size - 2, true);
+                stream->in_fu = !(fu_header & 0x40);
+            }else if(stream->in_fu){
+                AppendNal(stream, NULL, 0, payload + 2, size - 2, false);
+                if(fu_header & 0x40){
+                    stream->in_fu = false;
+                }
+            }else{
+                stream->frame_damaged = true; // the start of FU lost
+            }
+
+        }else{
+            // STAP-B, MTAP and FU-B are not used in the non-interleaved mode
+            stream->frame_damaged = true;
+        }
+    }
+
+    if(marker){
+        FlushFrame(stream);
+    }
+}
+
+void LiteRtspClient::HandleH265Payload(LiteStream * stream, const uint8_t * payload,
+                                       size_t size, bool marker)
+{
+    if(size >= 2){
+        uint8_t nal_type = (payload[0] & 0x7e) >> 1;
+        if(nal_type < 48){
+            // single NAL unit
+            AppendNal(stream, NULL, 0, payload, size, true);
+
+        }else if(nal_type == 48){
+            // AP, DONL is not present as sprop-max-don-diff is 0
+            size_t pos = 2;
+            while(pos + 2 <= size){
+                size_t nal_size = ((size_t)payload[pos] << 8) | payload[pos + 1];
+                pos += 2;
+                if(nal_size == 0 || pos + nal_size > size){
+                    stream->frame_damaged = true;
+                    break;
+                }
+                AppendNal(stream, NULL, 0, payload + pos, nal_size, true);
+                pos += nal_size;
+            }
+
+        }else if(nal_type == 49 && size >= 3){
+            // FU
+            uint8_t fu_header = payload[2];
+            if(fu_header & 0x80){
+                uint8_t nal_header[2];
+                nal_header[0] = (payload[0] & 0x81) | ((fu_header & 0x3f) << 1);
+                nal_header[1] = payload[1];
+                if(stream->in_fu){
+                    stream->frame_damaged = true; // the end of last FU lost
+                }
+                AppendNal(stream, nal_header, 2, payload + 3, size - 3, true);
+                stream->in_fu = !(fu_header & 0x40);
+            }else if(stream->in_fu){
+                AppendNal(stream, NULL, 0, payload + 3, size - 3, false);
+                if(fu_header & 0x40){
+                    stream->in_fu = false;
+                }
+            }else{
+                stream->frame_damaged = true; // the start of FU lost
+            }
+        }
+        // PACI is ignored
+    }
+
+    if(marker){
+        FlushFrame(stream);
+    }
+}
+
+void LiteRtspClient::HandleAacPayload(LiteStream * stream, uint32_t rtp_ts,
+                                      const uint8_t * payload, size_t size)
+{
+    if(size < 2){
+        return;
+    }
+    size_t header_bits = ((size_t)payload[0] << 8) | payload[1];
+    size_t header_size = (header_bits + 7) / 8;
+    if(2 + header_size > size){
+        stream->damaged_frames++;
+        return;
+    }
+    const uint8_t * data = payload + 2 + header_size;
+    size_t data_size = size - 2 - header_size;
+
+    if(stream->au_remaining != 0){
+        // the following fragment of an AU
+        size_t fragment = data_size < stream->au_remaining ? data_size : stream->au_remaining;
+        if(!AppendData(stream->frame_buf, data, fragment)){
+            stream->frame_damaged = true;
+        }
+        stream->au_remaining -= fragment;
+        if(stream->au_remaining == 0){
+            if(stream->frame_damaged){
+                stream->frame_damaged = false;
+                stream->damaged_frames++;
+                if(drop_damaged_frames_){
+                    stream->frame_buf->Clear();
+                    return;
+                }
+            }
+            stream->frame_buf->GetSegments(&segments_);
+            OutputFrame(stream, stream_switch::MEDIA_FRAME_TYPE_KEY_FRAME,
+                        stream->frame_ts);
+        }
+        return;
+    }
+
+    // walk the AU headers, each AU is a frame
+    size_t bit_pos = 0;
+    unsigned au_index = 0;
+    while(bit_pos + stream->size_length <= header_bits){
+        size_t au_size = 0;
+        for(unsigned i = 0; i < stream->size_length; i++, bit_pos++){
+            au_size = (au_size << 1) |
+                ((payload[2 + bit_pos / 8] >> (7 - bit_pos % 8)) & 0x01);
+        }
+        bit_pos += (au_index == 0) ? stream->index_length : stream->index_delta_length;
+        uint32_t au_ts = rtp_ts + au_index * AAC_SAMPLES_PER_FRAME;
+        au_index++;
+
+        if(au_size <= data_size){
+            // publish the AU straight from the read buffer
+            stream_switch::MediaFrameSegment segment((const char *)data, au_size);
+            segments_.clear();
+            segments_.push_back(segment);
+            OutputFrame(stream, stream_switch::MEDIA_FRAME_TYPE_KEY_FRAME, au_ts);
+            data += au_size;
+            data_size -= au_size;
+        }else{
+            // the AU is fragmented over packets
+            stream->frame_buf->Clear();
+            stream->frame_damaged = !AppendData(stream->frame_buf, data, data_size);
+            stream->au_remaining = au_size - data_size;
+            stream->frame_ts = au_ts;
+            break;
+        }
+    }
+}
+
+void LiteRtspClient::AppendNal(LiteStream * stream, const uint8_t * nal_header,
+                               size_t header_size, const uint8_t * data, size_t size,
+                               bool with_start_code)
+{
+    bool ok = true;
+    if(with_start_code){
+        ok = AppendData(stream->frame_buf, start_code, 4);
+        if(header_size != 0){
+            NoteNalType(stream, nal_header, header_size);
+            ok = ok && AppendData(stream->frame_buf, nal_header, header_size);
+        }else{
+            NoteNalType(stream, data, size);
+        }
+    }
+    ok = ok && AppendData(stream->frame_buf, data, size);
+    if(!ok){
+        // over the max frame size
+        stream->frame_damaged = true;
+    }
+}
+
+void LiteRtspClient::NoteNalType(LiteStream * stream, const uint8_t * nal, size_t size)
+{
+    uint8_t nal_type;
+    std::string * param_set = NULL;
+
+    if(stream->codec == "H264"){
+        nal_type = nal[0] & 0x1f;
+        if(nal_type >= 1 && nal_type <= 5){
+            stream->frame_has_vcl = true;
+            if(nal_type == 5){
+                stream->frame_is_key = true;
+            }
+        }else if(nal_type == 7){
+            param_set = &stream->sps;
+        }else if(nal_type == 8){
+            param_set = &stream->pps;
+        }
+    }else{
+        nal_type = (nal[0] & 0x7e) >> 1;
+        if(nal_type <= 31){
+            stream->frame_has_vcl = true;
+            if(nal_type == 19 || nal_type == 20){
+                stream->frame_is_key = true;
+            }
+        }else if(nal_type == 32){
+            param_set = &stream->vps;
+        }else if(nal_type == 33){
+            param_set = &stream->sps;
+        }else if(nal_type == 34){
+            param_set = &stream->pps;
+        }
+    }
+
+    // keep the in-band parameter sets until the metadata is ready, the
+    // fragmented ones are ignored as they are never seen in practice
+    if(param_set != NULL && !is_metadata_ok_ && size > 1){
+        param_set->assign((const char *)nal, size);
+    }
+}
+
+void LiteRtspClient::FlushFrame(LiteStream * stream)
+{
+    using namespace stream_switch;
+    MediaFrameType frame_type;
+
+    if(!stream->frame_started){
+        return;
+    }
+    stream->frame_started = false;
+    stream->in_fu = false;
+
+    if(!stream->frame_has_vcl){
+        // only parameter NALs, buffer them for the next frame, or all
+        // the VCL NALs are lost
+        if(stream->frame_damaged){
+            stream->damaged_frames++;
+        }
+        if(stream->frame_buf->size() > MAX_PARAMETER_NAL_SIZE){
+            //Anormal case, may be results from packet lost
+            stream->frame_buf->Clear();
+        }
+        stream->frame_damaged = false;
+        return;
+    }
+    frame_type = stream->frame_is_key ?
+        MEDIA_FRAME_TYPE_KEY_FRAME : MEDIA_FRAME_TYPE_DATA_FRAME;
+    stream->frame_has_vcl = false;
+    stream->frame_is_key = false;
+
+    // fill the metadata with the in-band parameter sets if absent in SDP
+    if(!is_metadata_ok_ && stream->sub_stream_index < (int32_t)metadata_.sub_streams.size()){
+        SubStreamMetadata &sub_metadata = metadata_.sub_streams[stream->sub_stream_index];
+        if(sub_metadata.extra_data.size() == 0 &&
+           stream->sps.size() != 0 && stream->pps.size() != 0 &&
+           (stream->codec == "H264" || stream->vps.size() != 0)){
+            if(stream->codec == "H265"){
+                sub_metadata.extra_data.append((const char *)start_code, 4);
+                sub_metadata.extra_data.append(stream->vps);
+            }
+            sub_metadata.extra_data.append((const char *)start_code, 4);
+            sub_metadata.extra_data.append(stream->sps);
+            sub_metadata.extra_data.append((const char *)start_code, 4);
+            sub_metadata.extra_data.append(stream->pps);
+            CheckMetadata();
+        }
+    }
+
+    if(stream->frame_damaged){
+        stream->frame_damaged = false;
+        stream->damaged_frames++;
+        if(drop_damaged_frames_){
+            stream->frame_buf->Clear();
+            return;
+        }
+    }
+
+    stream->frame_buf->GetSegments(&segments_);
+    OutputFrame(stream, frame_type, stream->frame_ts);
+}
+
+void LiteRtspClient::OutputFrame(LiteStream * stream,
+                                 stream_switch::MediaFrameType frame_type,
+                                 uint32_t rtp_ts)
+{
+    struct timeval timestamp;
+    struct timeval raw_timestamp = RtpTsToTime(stream, rtp_ts);
+    if(stream->sub_stream_index == drift_ref_index_){
+        pts_drift_tracker_.track(raw_timestamp);
+    }
+    pts_drift_tracker_.correct(raw_timestamp, &timestamp);
+    gettimeofday(&last_frame_time_, NULL);
+
+    if(is_metadata_ok_ && reconnect_task_ == NULL && listener_ != NULL &&
+       segments_.size() != 0){
+        stream_switch::MediaFrameInfo frame_info;
+        frame_info.frame_type = frame_type;
+        frame_info.timestamp.tv_sec = timestamp.tv_sec;
+        frame_info.timestamp.tv_usec = timestamp.tv_usec;
+        frame_info.sub_stream_index = stream->sub_stream_index;
+        frame_info.ssrc = metadata_.ssrc;
+        listener_->OnMediaFrame(frame_info, &segments_[0], (int)segments_.size());
+    }
+    segments_.clear();
+    stream->frame_buf->Clear();
+}
+
+struct timeval LiteRtspClient::RtpTsToTime(LiteStream * stream, uint32_t rtp_ts)
+{
+    struct timeval now, result;
+    gettimeofday(&now, NULL);
+
+    if(!stream->has_ts_base){
+        stream->has_ts_base = true;
+        stream->ts_base = rtp_ts;
+        stream->local_base = now;
+        return now;
+    }
+
+    int64_t delta = (int64_t)(int32_t)(rtp_ts - stream->ts_base) * 1000000 /
+                    stream->clock_rate;
+    int64_t usec = (int64_t)stream->local_base.tv_sec * 1000000 +
+                   stream->local_base.tv_usec + delta;
+    int64_t now_usec = (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+    int64_t offset = pts_drift_tracker_.offset();
+
+    if(usec + offset > now_usec + RTP_TS_MAX_DRIFT || 
+       usec + offset < now_usec - RTP_TS_MAX_DRIFT){
+        // lost sync with the local clock even after the drift correction, 
+        // e.g. the camera resets the timestamp, re-anchor it
+        env_ << "RTP timestamp of sub stream " << stream->sub_stream_index
+             << " drifts away from the local clock, re-anchor it\n";
+        usec = now_usec - offset;
+        stream->ts_base = rtp_ts;
+        stream->local_base.tv_sec = usec / 1000000;
+        stream->local_base.tv_usec = usec % 1000000;
+        return stream->local_base;
+    }
+
+    result.tv_sec = usec / 1000000;
+    result.tv_usec = usec % 1000000;
+    if(delta > (int64_t)RTP_TS_BASE_UPDATE_INTERVAL * 1000000 ||
+       delta < -(int64_t)RTP_TS_BASE_UPDATE_INTERVAL * 1000000){
+        // move the base forward, so that the delta never overflows
+        stream->ts_base = rtp_ts;
+        stream->local_base = result;
+    }
+    return result;
+}
+
+
+////////////////////////////////////////////////////////////
+//Timer task handler
+
+void LiteRtspClient::RtspKeepAliveHandler(void* clientData)
+{
+    LiteRtspClient *my_client = (LiteRtspClient *)clientData;
+    my_client->rtsp_keep_alive_task_ = NULL;
+
+    if(my_client->SendRequest("OPTIONS", my_client->base_url_, std::string())){
+        my_client->HandleError(RTSP_CLIENT_ERR_SUBSESSION_BYE,
+            "Failed to send the keep-alive request");
+        return;
+    }
+
+    unsigned sessionTimeout = my_client->session_timeout_ == 0 ?
+        RTSP_KEEPALIVE_INTERVAL/*default*/ : my_client->session_timeout_;
+    unsigned secondsUntilNextKeepAlive = sessionTimeout <= 5 ? 1 : sessionTimeout - 5;
+    my_client->rtsp_keep_alive_task_ =
+        my_client->env_.taskScheduler().scheduleDelayedTask(
+        secondsUntilNextKeepAlive * 1000000, (TaskFunc*)RtspKeepAliveHandler, my_client);
+}
+
+void LiteRtspClient::RtspClientConnectTimeout(void* clientData)
+{
+    LiteRtspClient *my_client = (LiteRtspClient *)clientData;
+    my_client->rtsp_timeout_task_ = NULL;
+
+    my_client->env_ << "Rtsp negotiation time out\n";
+
+    my_client->HandleError(RTSP_CLIENT_ERR_CONNECT_FAIL,
+        "Rtsp negotiation timeout");
+}
+
+void LiteRtspClient::CheckInterFrameGaps(void* clientData)
+{
+    LiteRtspClient *my_client = (LiteRtspClient *)clientData;
+    my_client->inter_frame_gap_check_timer_task_ = NULL;
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    if(now.tv_sec >= my_client->last_frame_time_.tv_sec &&
+       now.tv_sec - my_client->last_frame_time_.tv_sec >=
+       interPacketGapMaxTime){
+        //gap timeout
+        my_client->HandleError(RTSP_CLIENT_ERR_INTER_FRAME_GAP,
+            "Inter Frame Gap timeout");
+        return;
+    }
+    my_client->UpdateRtpStatistic();
+    my_client->inter_frame_gap_check_timer_task_ =
+        my_client->env_.taskScheduler().scheduleDelayedTask(1000000, //each second
+            (TaskFunc*)CheckInterFrameGaps, my_client);
+}
+
+void LiteRtspClient::ReconnectHandler(void* clientData)
+{
+    LiteRtspClient *my_client = (LiteRtspClient *)clientData;
+    my_client->reconnect_task_ = NULL;
+
+    my_client->Reconnect();
+}
+
+
+/////////////////////////////////////////////////////////
+//error and reconnect
+
+void LiteRtspClient::HandleError(RtspClientErrCode err_code, const char * err_info)
+{
+    if(are_already_shutting_down_){
+        return;
+    }
+
+    // the connection is useless anymore, the streams are kept until
+    // reconnect or shutdown, as the error may be raised in their context
+    StopTimers();
+    CloseConnection();
+    state_ = STATE_IDLE;
+
+    if(reconnect_max_interval_ != 0 && has_played_ &&
+       err_code != RTSP_CLIENT_ERR_USER_DEMAND &&
+       err_code != RTSP_CLIENT_ERR_SESSION_TIMER){
+        //the session has been played, reconnect in process
+        if(reconnect_task_ != NULL){
+            return; // already reconnecting
+        }
+        if(is_metadata_ok_){
+            prev_metadata_ = metadata_;
+            has_prev_metadata_ = True;
+        }
+
+        env_ << "Reconnect in " << reconnect_interval_ / 1000
+             << " ms because of error: " << err_info << "\n";
+        if(listener_ != NULL){
+            listener_->OnReconnecting(err_code, err_info, reconnect_interval_);
+        }
+
+        ScheduleReconnect(reconnect_interval_);
+
+        reconnect_interval_ *= 2;
+        if(reconnect_interval_ > reconnect_max_interval_){
+            reconnect_interval_ = reconnect_max_interval_;
+        }
+        return;
+    }
+
+    if(listener_ != NULL){
+        listener_->OnError(err_code, err_info);
+    }
+}
+
+void LiteRtspClient::ScheduleReconnect(unsigned interval)
+{
+    if(reconnect_task_ != NULL){
+        return;
+    }
+    reconnect_task_ = env_.taskScheduler().scheduleDelayedTask(
+        interval, (TaskFunc*)ReconnectHandler, (void*)this);
+}
+
+void LiteRtspClient::Reconnect()
+{
+    CloseConnection();
+    ClearStreams();
+    session_id_.clear();
+    session_timeout_ = 0;
+    auth_tried_ = false;
+    std::string host, user, passwd;
+    int port;
+    ParseRtspUrl(rtsp_url_, &host, &port, &user, &passwd, &base_url_);
+
+    metadata_.sub_streams.clear();
+    is_metadata_ok_ = False;
+
+    env_ << "Reconnect \"" << base_url_.c_str() << "\"\n";
+
+    rtsp_timeout_task_ = env_.taskScheduler().scheduleDelayedTask(
+        60000000 /* 1 minutes */, (TaskFunc*)RtspClientConnectTimeout,
+        (void*)this);
+
+    if(Connect()){
+        HandleError(RTSP_CLIENT_ERR_CONNECT_FAIL, "Failed to connect the server");
+    }
+}
+
+void LiteRtspClient::StopTimers()
+{
+    if(inter_frame_gap_check_timer_task_ != NULL) {
+        env_.taskScheduler().unscheduleDelayedTask(inter_frame_gap_check_timer_task_);
+        inter_frame_gap_check_timer_task_ = NULL;
+    }
+    if(rtsp_keep_alive_task_ != NULL) {
+        env_.taskScheduler().unscheduleDelayedTask(rtsp_keep_alive_task_);
+        rtsp_keep_alive_task_ = NULL;
+    }
+    if(rtsp_timeout_task_ != NULL) {
+        env_.taskScheduler().unscheduleDelayedTask(rtsp_timeout_task_);
+        rtsp_timeout_task_ = NULL;
+    }
+}
+
+void LiteRtspClient::ClearStreams()
+{
+    for(LiteStreamList::iterator it = streams_.begin(); it != streams_.end(); it++){
+        if((*it)->frame_buf != NULL){
+            delete (*it)->frame_buf;
+        }
+        delete *it;
+    }
+    streams_.clear();
+    segments_.clear();
+
+    // the new streams are anchored to the local clock again
+    pts_drift_tracker_.reset(False);
+}
+
+void LiteRtspClient::UpdateRtpStatistic()
+{
+    if(listener_ == NULL){
+        return;
+    }
+    for(LiteStreamList::iterator it = streams_.begin(); it != streams_.end(); it++){
+        LiteStream * stream = *it;
+        RtpRecvStatistic statistic;
+        statistic.sub_stream_index = stream->sub_stream_index;
+        statistic.lost_packets = stream->lost_packets;
+        statistic.damaged_frames = stream->damaged_frames;
+        statistic.pts_offset = (int32_t)pts_drift_tracker_.offset();
+        statistic.pts_drift = (int32_t)pts_drift_tracker_.driftRate();
+        listener_->OnRtpStatisticUpdate(statistic);
+
+        listener_->OnLostFrameUpdate(statistic.sub_stream_index,
+                                     statistic.damaged_frames);
+    }
+}
@@ -0,0 +1,281 @@
+/**
+ * This file is part of stsw_rtsp_source, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_lite_rtsp_client.h
+ *      LiteRtspClient class header file, a lightweight RTSP client engine
+ *  for the TCP-interleaved H264/H265/AAC streams
+ *
+ * author: OpenSight Team
+ * date: 2016-4-8
+**/
+
+
+#ifndef STSW_LITE_RTSP_CLIENT_H
+#define STSW_LITE_RTSP_CLIENT_H
+
+#include <stdint.h>
+#include <sys/time.h>
+
+#include <string>
+#include <vector>
+
+#include "stsw_rtsp_client.h"
+#include "stsw_frame_chunk_buf.h"
+#include "stsw_pts_normalizer.h"
+
+
+// the read buffer of the RTSP connection, which can hold at least one
+// interleaved RTP packet (4 bytes header + 64K payload) and a response
+#define LITE_RTSP_READ_BUF_SIZE     (256 * 1024)
+
+// the max size of a RTSP response (header + body)
+#define LITE_RTSP_MAX_RESPONSE_SIZE (64 * 1024)
+
+#define LITE_RTSP_MAX_STREAMS       8
+
+
+// the lightweight RTSP client engine
+//    For the dominant camera profile, i.e. H264/H265 video and AAC-hbr
+// audio over TCP-interleaved RTP, this engine takes place of the live555
+// RTSPClient / MediaSession / RTPSource / sink chain. It runs on the
+// same live555 TaskScheduler, but owns the RTSP connection itself:
+// the "$" frames are parsed straight out of the read buffer, and the
+// RTP payloads are depacketized (single NAL, STAP-A / AP, FU-A / FU,
+// AAC-hbr AU) into the pooled FrameChunkBuf of each stream, which is
+// published as segments once a frame is complete. There is no reordering
+// buffer (TCP never reorders) and no PTS normalizer filter: the RTP
+// timestamps of each stream are mapped to the local clock at its first
+// packet, the drift of the server's clock is corrected by a
+// PtsDriftTracker fed by the first video stream, and the mapping is
+// re-anchored if it still gets away from the local clock.
+//    The subsessions of other codecs are ignored, UDP transport is not
+// supported, use LiveRtspClient for them.
+//    The listener callbacks are the same as LiveRtspClient's, including
+// the RTP statistic and the in-process reconnect with backoff.
+class LiteRtspClient: public RtspClientEngine{
+public:
+    static LiteRtspClient * CreateNew(UsageEnvironment& env, char const* rtspURL,
+                   Boolean enableRtspKeepAlive = True,
+                   char const* singleMedium = NULL,
+                   char const* userName = NULL, char const* passwd = NULL,
+                   LiveRtspClientListener * listener = NULL,
+                   int verbosityLevel = 0,
+                   Boolean ignore_sdp_sps = False);
+
+    LiteRtspClient(UsageEnvironment& env, char const* rtspURL,
+                   Boolean enableRtspKeepAlive,
+                   char const* singleMedium,
+                   char const* userName, char const* passwd,
+                   LiveRtspClientListener * listener,
+                   int verbosityLevel,
+                   Boolean ignore_sdp_sps);
+    virtual ~LiteRtspClient();
+
+    ///////////////////////////////////////////////////////////
+    // RtspClientEngine implementation
+    virtual int Start();
+    virtual void Shutdown();
+    virtual void Close()
+    {
+        delete this;
+    }
+    virtual void SetListener(LiveRtspClientListener * listener)
+    {
+        listener_ = listener;
+    }
+    virtual void SetReconnectInterval(unsigned min_interval, unsigned max_interval);
+    virtual void SetDropDamagedFrames(Boolean drop)
+    {
+        drop_damaged_frames_ = drop;
+    }
+
+protected:
+    enum RtspState{
+        STATE_IDLE = 0,
+        STATE_CONNECTING = 1,
+        STATE_DESCRIBE = 2,
+        STATE_SETUP = 3,
+        STATE_PLAY = 4,
+        STATE_PLAYING = 5,
+    };
+
+    // the media stream set up from one "m=" line of the SDP
+    struct LiteStream{
+        std::string medium;            // "video" or "audio"
+        std::string codec;             // "H264", "H265" or "MPEG4-GENERIC"
+        std::string control_url;
+        std::string fmtp;
+        unsigned payload_type;
+        unsigned clock_rate;
+        unsigned channels;
+        unsigned bandwidth;            // in kbps, from "b=AS:"
+        int32_t sub_stream_index;
+        int rtp_channel;               // interleaved channel of RTP
+
+        // AAC-hbr parameters
+        unsigned size_length;
+        unsigned index_length;
+        unsigned index_delta_length;
+
+        // in-band parameter sets for the metadata
+        std::string vps;
+        std::string sps;
+        std::string pps;
+
+        // RTP state
+        bool has_seq;
+        uint16_t next_seq;
+        bool has_ts_base;
+        uint32_t ts_base;              // RTP timestamp mapped to local_base
+        struct timeval local_base;
+
+        // frame assembly
+        FrameChunkBuf * frame_buf;
+        bool frame_started;
+        uint32_t frame_ts;
+        bool frame_damaged;
+        bool frame_has_vcl;
+        bool frame_is_key;
+        bool in_fu;                    // a FU-A / FU NAL is being assembled
+        size_t au_remaining;           // a fragmented AAC AU is being assembled
+
+        // statistic
+        uint64_t lost_packets;
+        uint64_t damaged_frames;
+
+        LiteStream();
+    };
+    typedef std::vector<LiteStream *> LiteStreamList;
+
+    //////////////////////////////////////////////////
+    //socket / timer handler
+    static void IncomingDataHandler(void* clientData, int mask);
+    static void ConnectionHandler(void* clientData, int mask);
+    static void RtspKeepAliveHandler(void* clientData);
+    static void RtspClientConnectTimeout(void* clientData);
+    static void CheckInterFrameGaps(void* clientData);
+    static void ReconnectHandler(void* clientData);
+
+    ////////////////////////////////////////////////////////////
+    //RTSP protocol
+    virtual int Connect();
+    virtual void CloseConnection();
+    virtual void ReadSocket();
+    virtual int SendRequest(const char * method, const std::string &url,
+                            const std::string &extra_headers);
+    virtual void HandleResponse(int status_code, const std::string &header,
+                                const char * body, size_t body_size);
+    virtual void SendDescribe();
+    virtual void SendNextSetup();
+    virtual void SendPlay();
+    virtual void AfterDescribe(const std::string &header,
+                               const char * body, size_t body_size);
+    virtual void AfterSetup(const std::string &header);
+    virtual void AfterPlay(const std::string &header);
+    virtual bool HandleUnauthorized(const std::string &header);
+
+    ////////////////////////////////////////////////////////////
+    //SDP and metadata
+    virtual int ParseSdp(const std::string &sdp);
+    virtual void SetupMetadata();
+    virtual bool CheckMetadata();
+
+    ////////////////////////////////////////////////////////////
+    //RTP depacketization
+    virtual void HandleRtpPacket(int channel, const uint8_t * packet, size_t size);
+    virtual void HandleH264Payload(LiteStream * stream, const uint8_t * payload,
+                                   size_t size, bool marker);
+    virtual void HandleH265Payload(LiteStream * stream, const uint8_t * payload,
+                                   size_t size, bool marker);
+    virtual void HandleAacPayload(LiteStream * stream, uint32_t rtp_ts,
+                                  const uint8_t * payload, size_t size);
+    virtual void AppendNal(LiteStream * stream, const uint8_t * nal_header,
+                           size_t header_size, const uint8_t * data, size_t size,
+                           bool with_start_code);
+    virtual void NoteNalType(LiteStream * stream, const uint8_t * nal, size_t size);
+    virtual void FlushFrame(LiteStream * stream);
+    virtual void OutputFrame(LiteStream * stream, stream_switch::MediaFrameType frame_type,
+                             uint32_t rtp_ts);
+    virtual struct timeval RtpTsToTime(LiteStream * stream, uint32_t rtp_ts);
+
+    /////////////////////////////////////////////////////////
+    //error and reconnect
+    virtual void HandleError(RtspClientErrCode err_code, const char * err_info);
+    virtual void ScheduleReconnect(unsigned interval);
+    virtual void Reconnect();
+    virtual void StopTimers();
+    virtual void ClearStreams();
+    virtual void UpdateRtpStatistic();
+
+protected:
+    UsageEnvironment& env_;
+    LiveRtspClientListener * listener_;
+    Boolean are_already_shutting_down_;
+    Boolean enable_rtsp_keep_alive_;
+    std::string single_medium_;
+    std::string rtsp_url_;
+    std::string base_url_;
+    int verbosity_level_;
+    Boolean ignore_sdp_sps_;
+    Boolean drop_damaged_frames_;
+    Authenticator * our_authenticator;
+    bool auth_tried_;
+
+    // the RTSP connection
+    int socket_;
+    RtspState state_;
+    unsigned cseq_;
+    std::string session_id_;
+    unsigned session_timeout_;         // in sec
+    uint8_t * read_buf_;
+    size_t read_size_;
+    std::string last_method_;          // the method of the pending request
+    std::string last_url_;
+    std::string last_headers_;
+    size_t setup_index_;
+
+    LiteStreamList streams_;
+    std::vector<stream_switch::MediaFrameSegment> segments_;
+    int32_t drift_ref_index_;          // the sub stream feeding the drift tracker
+    PtsDriftTracker pts_drift_tracker_;
+
+    stream_switch::StreamMetadata metadata_;
+    Boolean is_metadata_ok_;
+
+    TaskToken rtsp_keep_alive_task_;
+    TaskToken rtsp_timeout_task_;
+    TaskToken inter_frame_gap_check_timer_task_;
+    struct timeval last_frame_time_;
+
+    // in-process reconnect
+    unsigned reconnect_min_interval_;   // in us
+    unsigned reconnect_max_interval_;   // in us, 0 means disabled
+    unsigned reconnect_interval_;       // in us, the next backoff interval
+    TaskToken reconnect_task_;
+    Boolean has_played_;
+    Boolean has_prev_metadata_;
+    stream_switch::StreamMetadata prev_metadata_;   // the metadata before reconnect
+};
+
+
+#endif
@@ -39,25 +39,32 @@ Mpeg4OutputSink* Mpeg4OutputSink::createNew(UsageEnvironment& env,
                                             LiveRtspClient *rtsp_client,
                                             MediaSubsession* subsession,                                          
                                             int32_t sub_stream_index,    
-                                            size_t sink_buf_size)
+                                            size_t sink_buf_size, 
+                                            size_t sink_recv_size, 
+                                            size_t sink_chunk_size)
 {
     //sanity check
     if(subsession == NULL ||
        sub_stream_index < 0 ||
-       sink_buf_size < 100 ){
+       sink_buf_size < 100 ||
+       sink_recv_size < 100 ||
+       sink_chunk_size < 100){
         return NULL;
     }
     
     return new Mpeg4OutputSink(env, rtsp_client, subsession, 
-                               sub_stream_index, sink_buf_size);
+                               sub_stream_index, sink_buf_size, 
+                               sink_recv_size, sink_chunk_size);
 }
 
 
 Mpeg4OutputSink::Mpeg4OutputSink(UsageEnvironment& env, 
                     LiveRtspClient *rtsp_client,
                     MediaSubsession* subsession, 
-                    int32_t sub_stream_index, size_t sink_buf_size)
-: MediaOutputSink(env, rtsp_client, subsession, sub_stream_index, sink_buf_size)
+                    int32_t sub_stream_index, size_t sink_buf_size, 
+                    size_t sink_recv_size, size_t sink_chunk_size)
+: MediaOutputSink(env, rtsp_client, subsession, sub_stream_index, sink_buf_size, 
+                  sink_recv_size, sink_chunk_size)
 {
 
 }
@@ -105,6 +112,10 @@ void Mpeg4OutputSink::DoAfterGettingFrame(unsigned frameSize, unsigned numTrunca
                 <<"), Dropped\n";   
         return;
     }
+    
+    if(IsDamagedFrame()){
+        return;
+    }
 
     
     MPEG4VideoStreamDiscreteFramer * source = 
@@ -177,9 +188,6 @@ void Mpeg4OutputSink::DoAfterGettingFrame(unsigned frameSize, unsigned numTrunca
         }
     }
     
-    //calculate the lost frames
-    CheckLostByTime(frame_type, presentationTime);    
-    
     if(rtsp_client_!= NULL){
         if(rtsp_client_->IsMetaReady()){
             //flush frame cache first
@@ -198,7 +206,7 @@ void Mpeg4OutputSink::DoAfterGettingFrame(unsigned frameSize, unsigned numTrunca
                 //only buffer the param frame
                 PushOneFrame(frame_type, 
                              presentationTime, 
-                             frameSize, (const char *)recv_buf_);
+                             frameSize);
             }
             //drop the frame; 
         }
@@ -61,14 +61,17 @@ public:
             MediaSubsession* subsession, // identifies the kind of data 
                                          //that's being received
             int32_t sub_stream_index,    // identifies the stream itself 
-            size_t sink_buf_size        // receive buf size
+            size_t sink_buf_size,        // max frame size
+            size_t sink_recv_size,       // initial receive space
+            size_t sink_chunk_size       // receive buf chunk size
             );   
     
 
 
     Mpeg4OutputSink(UsageEnvironment& env, LiveRtspClient *rtsp_client,
                     MediaSubsession* subsession, 
-                    int32_t sub_stream_index, size_t sink_buf_size);
+                    int32_t sub_stream_index, size_t sink_buf_size, 
+                    size_t sink_recv_size, size_t sink_chunk_size);
     // called only by "createNew()"
     virtual ~Mpeg4OutputSink();
 
@@ -36,39 +36,52 @@ MediaOutputSink* MediaOutputSink::createNew(UsageEnvironment& env,
                                             LiveRtspClient *rtsp_client,
                                             MediaSubsession* subsession,                                          
                                             int32_t sub_stream_index,    
-                                            size_t sink_buf_size)
+                                            size_t sink_buf_size, 
+                                            size_t sink_recv_size, 
+                                            size_t sink_chunk_size)
 {
     //sanity check
     if(subsession == NULL ||
        sub_stream_index < 0 ||
-       sink_buf_size < 100){
+       sink_buf_size < 100 || 
+       sink_recv_size < 100 ||
+       sink_chunk_size < 100){
         return NULL;
     }
     
     return new MediaOutputSink(env, rtsp_client, subsession, 
-                               sub_stream_index, sink_buf_size);
+                               sub_stream_index, sink_buf_size, 
+                               sink_recv_size, sink_chunk_size);
 }
 
 
 MediaOutputSink::MediaOutputSink(UsageEnvironment& env, 
                     LiveRtspClient *rtsp_client,
                     MediaSubsession* subsession, 
-                    int32_t sub_stream_index, size_t sink_buf_size)
-: MediaSink(env), sink_buf_size_(sink_buf_size), subsession_(subsession), 
-sub_stream_index_(sub_stream_index), rtsp_client_(rtsp_client), 
-last_gap_(0.0), lost_frames_(0)
+                    int32_t sub_stream_index, size_t sink_buf_size, 
+                    size_t sink_recv_size, size_t sink_chunk_size)
+: MediaSink(env), frame_buf_(NULL), recv_buf_(NULL), 
+recv_want_size_(sink_recv_size), sink_buf_size_(sink_buf_size), 
+sink_chunk_size_(sink_chunk_size), subsession_(subsession), 
+sub_stream_index_(sub_stream_index), rtsp_client_(rtsp_client)
 {
-    recv_buf_ = new u_int8_t[sink_buf_size];
+    if(recv_want_size_ > sink_buf_size_){
+        recv_want_size_ = sink_buf_size_;
+    }
+    frame_buf_ = new FrameChunkBuf(sink_chunk_size_, sink_buf_size_);
     last_pts_.tv_sec = 0;
     last_pts_.tv_usec = 0;
-    last_data_frame_pts_.tv_sec = 0;
-    last_data_frame_pts_.tv_usec = 0;
 }
 
 
 MediaOutputSink::~MediaOutputSink() {
-    delete[] recv_buf_;    
     ClearQueue();
+    delete frame_buf_;
+    std::vector<FrameChunkBuf *>::iterator it;
+    for(it = free_frame_bufs_.begin(); it != free_frame_bufs_.end(); it++){
+        delete *it;
+    }
+    free_frame_bufs_.clear();
 }
 
 void MediaOutputSink::afterGettingFrame(void* clientData, unsigned frameSize, unsigned numTruncatedBytes,
@@ -100,9 +113,21 @@ void MediaOutputSink::afterGettingFrame(unsigned frameSize, unsigned numTruncate
     envir() << "\n";
 #endif
 
-    
-
-    
+    if(numTruncatedBytes > 0){
+        // grow the receive space, so that the following frames of 
+        // this size would not be truncated any more
+        size_t want_size = frameSize + numTruncatedBytes;
+        want_size += want_size / 4;
+        if(want_size > sink_buf_size_){
+            want_size = sink_buf_size_;
+        }
+        if(want_size > recv_want_size_){
+            recv_want_size_ = want_size;
+            envir() << "Receive buffer of Stream index:\"" 
+                    << sub_stream_index_ << "\" grows to " 
+                    << (unsigned)recv_want_size_ << " bytes\n";
+        }
+    }
     
     DoAfterGettingFrame(frameSize, numTruncatedBytes, presentationTime, durationInMicroseconds);
 
@@ -153,6 +178,10 @@ void MediaOutputSink::DoAfterGettingFrame(unsigned frameSize, unsigned numTrunca
         return;
     }
     
+    if(IsDamagedFrame()){
+        return;
+    }
+    
     
     //update metadata if needed    
     
@@ -170,56 +199,36 @@ void MediaOutputSink::DoAfterGettingFrame(unsigned frameSize, unsigned numTrunca
 }
 
 
-void  MediaOutputSink::CheckLostByTime(stream_switch::MediaFrameType frame_type, 
-                                   struct timeval presentationTime)
+Boolean MediaOutputSink::IsDamagedFrame()
 {
-    if(frame_type == stream_switch::MEDIA_FRAME_TYPE_KEY_FRAME ||
-       frame_type == stream_switch::MEDIA_FRAME_TYPE_DATA_FRAME){
-        if(last_data_frame_pts_.tv_sec != 0 ||
-           last_data_frame_pts_.tv_usec != 0){
-            double last_pts_f = last_data_frame_pts_.tv_sec + 
-                last_data_frame_pts_.tv_usec/1000000.0;
-            double now_pts_f = presentationTime.tv_sec + 
-                presentationTime.tv_usec/1000000.0;
-            double cur_gap = now_pts_f - last_pts_f;
-            
-            //envir() << "cur_gap :" << cur_gap << "\n"; 
-            
-            if(last_gap_ > 0.001 && 
-               cur_gap >= last_gap_ * 1.7){
-               double lost = (int)((cur_gap - last_gap_) / last_gap_);
-               lost_frames_ += (int)(lost + 0.5);
-               //envir() << "lost_frames_ :" << (int)lost_frames_ << "\n"; 
-               if(rtsp_client_!= NULL){
-                   rtsp_client_->UpdateLostFrame(sub_stream_index_, lost_frames_);
-               }
-               
-            }else{
-               
-               last_gap_ = cur_gap; 
-               
-            }
-            
-        }        
-        
-        last_data_frame_pts_ = presentationTime;
+    if(rtsp_client_ == NULL || !rtsp_client_->drop_damaged_frames()){
+        return False;
     }
+    MultiFramedRTPSource * rtp_source = 
+        dynamic_cast<MultiFramedRTPSource *>(subsession_->rtpSource());
+    if(rtp_source == NULL){
+        return False;
+    }
+    return rtp_source->curFrameIsDamaged();
 }
 
 
 //framebuf queue operations
 void MediaOutputSink::PushOneFrame(stream_switch::MediaFrameType frame_type, 
                   struct timeval timestamp, 
-                  unsigned frame_size, 
-                  const char * frame_buf)
+                  unsigned frame_size)
 {
     FrameBuf temp_frame;
+    
+    // the queue takes over the current frame buffer, and the following 
+    // frames are received into another one
+    frame_buf_->Commit(frame_size);
     temp_frame.frame_type = frame_type;
     temp_frame.presentation_time = timestamp;
-    temp_frame.frame_size = frame_size;
-    temp_frame.buf = new char[frame_size];
-    memcpy(temp_frame.buf, frame_buf, frame_size);
+    temp_frame.buf = frame_buf_;
     frame_queue_.push_back(temp_frame);
+    
+    frame_buf_ = GetFrameBuf();
 }
 
 
@@ -230,16 +239,17 @@ void MediaOutputSink::FlushQueue()
     for(it= frame_queue_.begin(); it!= frame_queue_.end(); it++){
 
         //callback the parent rtsp client frame receive interface
-        if(rtsp_client_ != NULL){
-            rtsp_client_->AfterGettingFrame(
+        if(rtsp_client_ != NULL && it->buf->size() != 0){
+            it->buf->GetSegments(&segments_);
+            rtsp_client_->AfterGettingFrameV(
                 sub_stream_index_, 
                 it->frame_type, 
                 it->presentation_time, 
-                it->frame_size,
-                it->buf);
+                &segments_[0],
+                (int)segments_.size());
         }
         
-        delete[] it->buf;
+        PutFrameBuf(it->buf);
     }
     frame_queue_.clear();
         
@@ -248,10 +258,34 @@ void MediaOutputSink::ClearQueue()
 {
     FrameQueue::iterator it;
     for(it= frame_queue_.begin(); it!= frame_queue_.end(); it++){
-        delete[] it->buf;
+        PutFrameBuf(it->buf);
     }
     frame_queue_.clear();
 }
+
+FrameChunkBuf * MediaOutputSink::GetFrameBuf()
+{
+    FrameChunkBuf * frame_buf;
+    if(free_frame_bufs_.empty()){
+        return new FrameChunkBuf(sink_chunk_size_, sink_buf_size_);
+    }
+    frame_buf = free_frame_bufs_.back();
+    free_frame_bufs_.pop_back();
+    return frame_buf;
+}
+
+void MediaOutputSink::PutFrameBuf(FrameChunkBuf * frame_buf)
+{
+    if(frame_buf == NULL){
+        return;
+    }
+    if(free_frame_bufs_.size() < MAX_FREE_FRAME_BUF_NUM){
+        frame_buf->Clear();
+        free_frame_bufs_.push_back(frame_buf);
+    }else{
+        delete frame_buf;
+    }
+}
 void MediaOutputSink::GetQueueFirstPts(struct timeval *presentationTime)
 {
     if(presentationTime == NULL){
@@ -273,9 +307,44 @@ void MediaOutputSink::GetQueueFirstPts(struct timeval *presentationTime)
 Boolean MediaOutputSink::continuePlaying() {
     if (fSource == NULL) return False; // sanity check (should not happen)
 
+    return GetNextFrame(NULL, 0);
+}
+
+Boolean MediaOutputSink::GetNextFrame(const char * prefix, size_t prefix_size)
+{
+    size_t free_size = 0;
+    u_int8_t * pos;
+    
+    pos = frame_buf_->GetWritePos(prefix_size + recv_want_size_, &free_size);
+    if(pos == NULL || free_size <= prefix_size){
+        //reach the max frame size, drop the data buffered before
+        frame_buf_->Clear();
+        pos = frame_buf_->GetWritePos(prefix_size + recv_want_size_, &free_size);
+        if(pos == NULL || free_size <= prefix_size){
+            return False;
+        }
+    }
+    if(prefix_size != 0){
+        memcpy(pos, prefix, prefix_size);
+        frame_buf_->Commit(prefix_size);
+    }
+    recv_buf_ = pos + prefix_size;
+    
     // Request the next frame of data from our input source.  "afterGettingFrame()" will get called later, when it arrives:
-    fSource->getNextFrame(recv_buf_, sink_buf_size_,
+    fSource->getNextFrame(recv_buf_, free_size - prefix_size,
                         afterGettingFrame, this,
                         onSourceClosure, this);
     return True; 
+}
+
+void MediaOutputSink::OutputFrameBuf(stream_switch::MediaFrameType frame_type, 
+                                     struct timeval presentationTime)
+{
+    if(rtsp_client_ != NULL && frame_buf_->size() != 0){
+        frame_buf_->GetSegments(&segments_);
+        rtsp_client_->AfterGettingFrameV(sub_stream_index_, frame_type, 
+                                         presentationTime, 
+                                         &segments_[0], (int)segments_.size());
+    }
+    frame_buf_->Clear();
 }
\ No newline at end of file
@@ -38,14 +38,19 @@
 #endif
 #include "liveMedia.hh"
 #include "stream_switch.h"
+#include "stsw_frame_chunk_buf.h"
 
 #include<stdint.h>
+#include<vector>
 
+#define MAX_FREE_FRAME_BUF_NUM 4
+
+// the frame in the queue refers to the frame buffer it's received into, 
+// rather than a copy of the data
 struct FrameBuf{    
     stream_switch::MediaFrameType frame_type; 
     struct timeval presentation_time; 
-    char * buf;
-    size_t frame_size;
+    FrameChunkBuf * buf;
 };
 typedef std::list<FrameBuf> FrameQueue;
 
@@ -62,6 +67,13 @@ class LiveRtspClient;
 // 1) check the PTS is monotonic, otherwise drop the frame
 // 2) analyze the packet, and update the metadata of parent rtsp client. 
 // 3) analyze the frame's type
+// 4) drop the frame damaged by RTP packet loss, if the rtsp client asks to
+// The frame is received into a FrameChunkBuf, which is allocated in the 
+// multiple of the chunk size and grows on demand up to sink_buf_size. Each 
+// frame is given sink_recv_size contiguous space at first, so the frames 
+// fitting in the old fixed buffer are never truncated. If a frame is 
+// truncated by the underlayer source, it's dropped as before, but the 
+// receive space is grown to hold the following frames of that size.
 class MediaOutputSink: public MediaSink {
 
 public:
@@ -70,14 +82,17 @@ public:
             MediaSubsession* subsession, // identifies the kind of data 
                                          //that's being received
             int32_t sub_stream_index,    // identifies the stream itself 
-            size_t sink_buf_size        // receive buf size
+            size_t sink_buf_size,        // max frame size
+            size_t sink_recv_size,       // initial receive space
+            size_t sink_chunk_size       // receive buf chunk size
             );   
     
 
 
     MediaOutputSink(UsageEnvironment& env, LiveRtspClient *rtsp_client,
                     MediaSubsession* subsession, 
-                    int32_t sub_stream_index, size_t sink_buf_size);
+                    int32_t sub_stream_index, size_t sink_buf_size, 
+                    size_t sink_recv_size, size_t sink_chunk_size);
     // called only by "createNew()"
     virtual ~MediaOutputSink();
     
@@ -96,25 +111,55 @@ public:
                 struct timeval presentationTime, unsigned durationInMicroseconds);
                 
 
-    virtual void  CheckLostByTime(stream_switch::MediaFrameType frame_type, 
-                            struct timeval presentationTime);
+    // IsDamagedFrame()
+    // check whether the frame just received should be dropped, because 
+    // the RTP source has seen packet loss in it and the parent rtsp client 
+    // asks to drop the damaged frames
+    virtual Boolean IsDamagedFrame();
 
     //framebuf queue operations
+    // PushOneFrame()
+    // commit the frame_size bytes just received into the current frame 
+    // buffer, and push the whole buffer into the queue without copy
     void PushOneFrame(stream_switch::MediaFrameType frame_type, 
                       struct timeval timestamp, 
-                      unsigned frame_size, 
-                      const char * frame_buf);
+                      unsigned frame_size);
     void FlushQueue();
     void ClearQueue();
     void GetQueueFirstPts(struct timeval *presentationTime);
+    
+    int32_t sub_stream_index()
+    {
+        return sub_stream_index_;
+    }
 
 protected:
     // redefined virtual functions:
     virtual Boolean continuePlaying();
+    
+    // GetNextFrame()
+    // Request the next frame from the source into frame_buf_ after the 
+    // given prefix, which is committed into frame_buf_ first
+    virtual Boolean GetNextFrame(const char * prefix, size_t prefix_size);
+    
+    // OutputFrameBuf()
+    // output the whole frame_buf_ to the parent rtsp client as a segment 
+    // list, then clear it
+    virtual void OutputFrameBuf(stream_switch::MediaFrameType frame_type, 
+                                struct timeval presentationTime);
+    
+    // get / recycle a frame buffer from / to the free list
+    FrameChunkBuf * GetFrameBuf();
+    void PutFrameBuf(FrameChunkBuf * frame_buf);
 
 protected:
-    u_int8_t* recv_buf_;
+    FrameChunkBuf * frame_buf_;   // the frame buffer being received into
+    std::vector<FrameChunkBuf *> free_frame_bufs_;
+    u_int8_t* recv_buf_;      // the position the current frame received into
+    size_t recv_want_size_;   // the expected space for the next frame
     size_t sink_buf_size_;
+    size_t sink_chunk_size_;
+    std::vector<stream_switch::MediaFrameSegment> segments_;
     MediaSubsession* subsession_;
     int32_t sub_stream_index_;  
     struct timeval last_pts_; 
@@ -123,11 +168,6 @@ protected:
     
     
     FrameQueue frame_queue_;
-    
-    //used by CheckLostByTime()
-    double  last_gap_;    
-    uint64_t lost_frames_;
-    struct timeval last_data_frame_pts_; 
         
 };
 
@@ -33,19 +33,148 @@
 
 
 #include <sys/time.h>
+#include <time.h>
 
 #ifndef MILLION
 #define MILLION 1000000
 #endif
 
 
+////////// PtsDriftTracker implementation //////////
+
+static double elapsedSeconds(struct timespec const& from, struct timespec const& to) {
+    return (double)(to.tv_sec - from.tv_sec) + (to.tv_nsec - from.tv_nsec) / 1000000000.0;
+}
+
+PtsDriftTracker::PtsDriftTracker()
+  : fOffset(0.0) {
+    reset(False);
+}
+
+void PtsDriftTracker::reset(Boolean keepOffset) {
+    fStarted = False;
+    fHasBaseline = False;
+    fBaseline = 0.0;
+    if (!keepOffset) {
+        fOffset = 0.0;
+    }
+    fSlope = 0.0;
+    fIntercept = fOffset;
+    fNumWindows = 0;
+    fOrigin = 0.0;
+    fSw = fSx = fSy = fSxx = fSxy = 0.0;
+    fWindowStart = 0.0;
+    fWindowMin = 0.0;
+}
+
+void PtsDriftTracker::track(struct timeval const& rawPT) {
+    struct timeval wallNow;
+    struct timespec monoNow;
+    gettimeofday(&wallNow, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &monoNow);
+
+    // how long the local wall-clock is behind the presentation time
+    double delay = (double)(wallNow.tv_sec - rawPT.tv_sec) * MILLION 
+                   + (wallNow.tv_usec - rawPT.tv_usec);
+
+    if (!fStarted) {
+        fStarted = True;
+        fStartTime = monoNow;
+        fLastTime = monoNow;
+        fWindowStart = 0.0;
+        fWindowMin = delay;
+        return;
+    }
+    double x = elapsedSeconds(fStartTime, monoNow);
+
+    // slew the applied offset to the fitted line
+    if (fNumWindows >= DRIFT_TRACKER_MIN_WINDOWS) {
+        double target = fIntercept + fSlope * (x - fOrigin);
+        double maxStep = elapsedSeconds(fLastTime, monoNow) * DRIFT_TRACKER_MAX_SLEW;
+        double step = target - fOffset;
+        if (step > maxStep) {
+            step = maxStep;
+        } else if (step < -maxStep) {
+            step = -maxStep;
+        }
+        fOffset += step;
+    }
+    fLastTime = monoNow;
+
+    if (delay < fWindowMin) {
+        fWindowMin = delay;
+    }
+    if ((x - fWindowStart) * MILLION >= DRIFT_TRACKER_WINDOW) {
+        if (!fHasBaseline) {
+            // the offset applied now is the start point of the line
+            fHasBaseline = True;
+            fBaseline = fWindowMin - fOffset;
+        }
+        addWindow(x, fWindowMin - fBaseline);
+        fWindowStart = x;
+        fWindowMin = delay;
+    }
+}
+
+void PtsDriftTracker::addWindow(double x, double y) {
+    double predicted = (fNumWindows >= DRIFT_TRACKER_MIN_WINDOWS) ?
+        fIntercept + fSlope * (x - fOrigin) : fOffset;
+    if (y - predicted > DRIFT_TRACKER_STEP_LIMIT || 
+        predicted - y > DRIFT_TRACKER_STEP_LIMIT) {
+        // the presentation times step, follow it at once, and forget 
+        // the history before
+        fOffset = y;
+        fSw = fSx = fSy = fSxx = fSxy = 0.0;
+        fNumWindows = 0;
+        fSlope = 0.0;
+    }
+
+    // move the origin to x to keep the sums small, then forget the old 
+    // windows a little, and add the new one at x = 0
+    double d = x - fOrigin;
+    fSxx = fSxx - 2 * d * fSx + d * d * fSw;
+    fSxy = fSxy - d * fSy;
+    fSx = fSx - d * fSw;
+    fOrigin = x;
+
+    fSw = fSw * DRIFT_TRACKER_FORGET + 1.0;
+    fSx = fSx * DRIFT_TRACKER_FORGET;
+    fSy = fSy * DRIFT_TRACKER_FORGET + y;
+    fSxx = fSxx * DRIFT_TRACKER_FORGET;
+    fSxy = fSxy * DRIFT_TRACKER_FORGET;
+    fNumWindows++;
+
+    double den = fSw * fSxx - fSx * fSx;
+    if (fNumWindows >= 2 && den > 1e-9) {
+        fSlope = (fSw * fSxy - fSx * fSy) / den;
+        fIntercept = (fSy - fSlope * fSx) / fSw;
+    } else {
+        fSlope = 0.0;
+        fIntercept = fSy / fSw;
+    }
+}
+
+void PtsDriftTracker::correct(struct timeval const& rawPT, struct timeval* toPT) const {
+    long offset = (long)fOffset;
+    long long usec = (long long)rawPT.tv_usec + offset % MILLION;
+    toPT->tv_sec = rawPT.tv_sec + offset / MILLION;
+    while (usec < 0) {
+        --(toPT->tv_sec); usec += MILLION;
+    }
+    while (usec >= MILLION) {
+        ++(toPT->tv_sec); usec -= MILLION;
+    }
+    toPT->tv_usec = usec;
+}
+
+
 ////////// PtsSessionNormalizer and PtsSubsessionNormalizer implementations //////////
 
 // PtsSessionNormalizer:
 
 PtsSessionNormalizer::PtsSessionNormalizer(UsageEnvironment& env, Boolean usingLocalTs)
-  : Medium(env), fUsingLocalTs(usingLocalTs), 
-    fSubsessionNormalizers(NULL), fMasterSSNormalizer(NULL) {
+  : Medium(env), fSubsessionNormalizers(NULL), fMasterSSNormalizer(NULL), 
+    fUsingLocalTs(usingLocalTs), fDriftRefSSNormalizer(NULL) {
         
 }
 
@@ -76,9 +205,25 @@ void PtsSessionNormalizer::normalizePresentationTime(PtsSubsessionNormalizer* ss
     if (!hasBeenSynced) {
         // If "fromPT" has not yet been RTCP-synchronized, then it was generated 
         // by our own receiving code, and thus
-        // is already aligned with 'wall-clock' time.  
-        // Just copy it 'as is' to "toPT":
-        *toPT = fromPT;
+        // is already aligned with 'wall-clock' time at the first packet, 
+        // but drifts away with the RTP timestamps later. 
+        // Just correct the drift of it:
+        if (fDriftRefSSNormalizer == NULL) {
+            fDriftRefSSNormalizer = ssNormalizer;
+            fDriftTracker.reset(False);
+        } else if (fDriftRefSSNormalizer != ssNormalizer &&
+                   strcmp(fDriftRefSSNormalizer->mediumName(), "video") != 0 && 
+                   strcmp(ssNormalizer->mediumName(), "video") == 0) {
+            // prefer video as reference, the applied offset goes on
+            fDriftRefSSNormalizer = ssNormalizer;
+            fDriftTracker.reset(True);
+        }
+        if (ssNormalizer == fDriftRefSSNormalizer &&
+            ssNormalizer->fRTPSource->curPacketRTPTimestamp() != 
+            ssNormalizer->fLastRtpTimestamp) {
+            fDriftTracker.track(fromPT);
+        }
+        fDriftTracker.correct(fromPT, toPT);
     } else {
         
         // in two case ,we need to (re)set master
@@ -101,6 +246,7 @@ void PtsSessionNormalizer::normalizePresentationTime(PtsSubsessionNormalizer* ss
                 if(fMasterSSNormalizer == NULL){
                     //no master yet
                     gettimeofday(&timeNow, NULL);
+                    fDriftTracker.reset(False);
                     
                 }else{
                     // hack: in this case, we change the master from non-video 
@@ -108,6 +254,7 @@ void PtsSessionNormalizer::normalizePresentationTime(PtsSubsessionNormalizer* ss
                     // original master so that to avoid timestamp change
                     timeNow.tv_sec = fPTAdjustment.tv_sec + fromPT.tv_sec;
                     timeNow.tv_usec = fPTAdjustment.tv_usec + fromPT.tv_usec;
+                    fDriftTracker.reset(True);
                 }
             }else{
                 //there is some packets having seen
@@ -131,11 +278,14 @@ void PtsSessionNormalizer::normalizePresentationTime(PtsSubsessionNormalizer* ss
                     ++(timeNow.tv_sec); timeNow.tv_usec -= MILLION; 
                 }                   
          
-                
+                // the last PT has been corrected, so the new adjustment 
+                // includes the offset already
+                fDriftTracker.reset(False);
             }
             
 
             fMasterSSNormalizer = ssNormalizer; 
+            fDriftRefSSNormalizer = ssNormalizer;
             envir() << "Sync with subsession (media_name: "<< ssNormalizer->mediumName() 
                     << ", codec_name: "<< ssNormalizer->codecName()
                     << ")\n";
@@ -157,12 +307,19 @@ void PtsSessionNormalizer::normalizePresentationTime(PtsSubsessionNormalizer* ss
             
         }else{
             // Compute a normalized presentation time: toPT = fromPT + fPTAdjustment
-            toPT->tv_sec = fromPT.tv_sec + fPTAdjustment.tv_sec - 1;
-            toPT->tv_usec = fromPT.tv_usec + fPTAdjustment.tv_usec + MILLION;
-            while (toPT->tv_usec > MILLION) { 
-                ++(toPT->tv_sec); toPT->tv_usec -= MILLION; 
+            struct timeval rawPT;
+            rawPT.tv_sec = fromPT.tv_sec + fPTAdjustment.tv_sec - 1;
+            rawPT.tv_usec = fromPT.tv_usec + fPTAdjustment.tv_usec + MILLION;
+            while (rawPT.tv_usec > MILLION) { 
+                ++(rawPT.tv_sec); rawPT.tv_usec -= MILLION; 
             }
-        
+            
+            // then correct the drift of the server's clock, which is 
+            // tracked on the master
+            if (ssNormalizer == fMasterSSNormalizer) {
+                fDriftTracker.track(rawPT);
+            }
+            fDriftTracker.correct(rawPT, toPT);
         }
 
     }//if (!hasBeenSynced) {
@@ -181,6 +338,9 @@ void PtsSessionNormalizer
   if(fMasterSSNormalizer == ssNormalizer){
       fMasterSSNormalizer = NULL;
   }
+  if(fDriftRefSSNormalizer == ssNormalizer){
+      fDriftRefSSNormalizer = NULL;
+  }
 }
 
 // PtsSubsessionNormalizer:
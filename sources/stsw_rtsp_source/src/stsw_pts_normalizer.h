@@ -39,6 +39,70 @@
 
 #include "liveMedia.hh"
 
+#include <sys/time.h>
+
+
+////////// PtsDriftTracker definition //////////
+
+// The clock of the remote server always drifts against the local one, by
+// up to hundreds of milli-seconds per hour, so the presentation times 
+// aligned with wall-clock once drift away from it forever. This class 
+// estimates the drift continuously and corrects the presentation times:
+//    On the arrival of each frame of the reference stream, the delay of 
+// the local wall-clock behind its (uncorrected) presentation time is 
+// measured. The minimum delay of each window (DRIFT_TRACKER_WINDOW) 
+// filters out the network jitter, and is fitted by a least squares line 
+// against the monotonic clock, in which the old windows are forgotten 
+// exponentially. The line gives the offset to add to the presentation 
+// times, and its slope is the drift rate. The applied offset is slewed to 
+// the line within DRIFT_TRACKER_MAX_SLEW, so that the output never jumps, 
+// except the presentation times step over DRIFT_TRACKER_STEP_LIMIT, e.g. 
+// the server resets its clock, which is followed at once.
+#define DRIFT_TRACKER_WINDOW        10000000  // 10 sec
+#define DRIFT_TRACKER_MIN_WINDOWS   3         // windows before the line is used
+#define DRIFT_TRACKER_FORGET        0.95      // forgetting factor per window
+#define DRIFT_TRACKER_MAX_SLEW      1000      // in ppm, i.e. 1 ms per second
+#define DRIFT_TRACKER_STEP_LIMIT    1000000   // 1 sec
+
+class PtsDriftTracker {
+public:
+    PtsDriftTracker();
+
+    // Drop the history, the applied offset is kept if keepOffset is True, 
+    // which is needed if the uncorrected presentation times go on without 
+    // the offset
+    void reset(Boolean keepOffset);
+
+    // Feed the uncorrected presentation time of a frame of the reference 
+    // stream, on its arrival
+    void track(struct timeval const& rawPT);
+
+    // toPT = rawPT + the current offset
+    void correct(struct timeval const& rawPT, struct timeval* toPT) const;
+
+    long offset() const { return (long)fOffset; }        // in us
+    double driftRate() const { return fSlope; }          // in ppm
+
+private:
+    void addWindow(double x, double y);
+
+private:
+    Boolean fStarted;
+    Boolean fHasBaseline;
+    double fBaseline;        // the delay of the first window, in us
+    double fOffset;          // the applied offset, in us
+    double fSlope;           // in us per second, i.e. ppm
+    double fIntercept;       // in us
+    unsigned fNumWindows;
+    double fOrigin;          // the x origin of the sums, in sec since fStartTime
+    double fSw, fSx, fSy, fSxx, fSxy;  // the weighted sums of least squares
+    struct timespec fStartTime;        // monotonic
+    struct timespec fLastTime;         // monotonic, of the last frame
+    double fWindowStart;               // in sec since fStartTime
+    double fWindowMin;                 // the min delay of the window, in us
+};
+
+
 ////////// PtsSessionNormalizer and PtsSubsessionNormalizer definitions //////////
 
 // The following two classes are used by rtsp client to convert incoming streams' 
@@ -91,6 +155,10 @@ public:
         FramedSource* inputSource, RTPSource* rtpSource, 
         char const *mediumName, char const* codecName);
 
+    // the clock offset and drift rate estimated by the drift tracker
+    long ptsOffset() const { return fDriftTracker.offset(); }     // in us
+    double ptsDriftRate() const { return fDriftTracker.driftRate(); }  // in ppm
+
 private: // called only from within "~PtsSubsessionNormalizer":
     friend class PtsSubsessionNormalizer;
     void normalizePresentationTime(PtsSubsessionNormalizer* ssNormalizer,
@@ -106,6 +174,11 @@ private:
     Boolean fUsingLocalTs;
 
     struct timeval fPTAdjustment; // Added to (RTCP-synced) subsession presentation times to 'normalize' them with wall-clock time.
+    
+    // the subsession whose frames feed the drift tracker, the master if 
+    // RTCP-synced, prefer video as well
+    PtsSubsessionNormalizer* fDriftRefSSNormalizer;
+    PtsDriftTracker fDriftTracker;
 };
 
 #endif
@@ -53,15 +53,18 @@ static int simpleRTPoffsetArg = -1;
 static Boolean sendOptionsRequest = False;
 //static unsigned short desiredPortNum = 0;
 
-static unsigned VideoSinkBufferSize = 1048576; /* 1M bytes */
-static unsigned AudioSinkBufferSize = 131072; /* 128K bytes */
+static unsigned VideoSinkBufferSize = 8388608; /* 8M bytes, max video frame size */
+static unsigned AudioSinkBufferSize = 131072; /* 128K bytes, max audio frame size */
+static unsigned VideoSinkRecvSize = 1048576; /* 1M bytes, initial receive space */
+static unsigned AudioSinkRecvSize = 131072; /* 128K bytes, initial receive space */
+static unsigned VideoSinkChunkSize = 131072; /* 128K bytes */
+static unsigned AudioSinkChunkSize = 16384; /* 16K bytes */
 static unsigned socketVideoInputBufferSize = 2097152; /* 2M bytes */
 static unsigned socketAudioInputBufferSize = 131072; /* 128K bytes */
 
 
 static char const* clientProtocolName = "RTSP";
 
-static unsigned const rtpClientReorderWindowthresh = 20000; // 20 ms
 
 
 
@@ -82,15 +85,18 @@ LiveRtspClient * LiveRtspClient::CreateNew(UsageEnvironment& env, char const* rt
                    Boolean usingLocalTs, 
                    LiveRtspClientListener * listener, 
                    int verbosityLevel,
-                   Boolean ignore_sdp_sps)
+                   Boolean ignore_sdp_sps, 
+                   unsigned reorderMinTime, 
+                   unsigned reorderMaxTime)
 {
-    if(rtspURL == NULL){
+    if(rtspURL == NULL || reorderMaxTime < reorderMinTime){
         return NULL;
     }
 
     return new LiveRtspClient(env, rtspURL, streamUsingTCP, enableRtspKeepAlive, 
                              singleMedium, userName, passwd, usingLocalTs, listener,
-                             verbosityLevel, ignore_sdp_sps);
+                             verbosityLevel, ignore_sdp_sps, 
+                             reorderMinTime, reorderMaxTime);
 }
                               
 
@@ -101,7 +107,9 @@ LiveRtspClient::LiveRtspClient(UsageEnvironment& env, char const* rtspURL,
                    Boolean usingLocalTs, 
                    LiveRtspClientListener * listener,                    
                    int verbosityLevel,
-                   Boolean ignore_sdp_sps)
+                   Boolean ignore_sdp_sps, 
+                   unsigned reorderMinTime, 
+                   unsigned reorderMaxTime)
 :RTSPClient(env, rtspURL, verbosityLevel, "stsw_rtsp_client", 0, -1), 
 listener_(listener), 
 are_already_shutting_down_(True), stream_using_tcp_(streamUsingTCP), 
@@ -116,8 +124,14 @@ has_receive_keep_alive_response(False), duration_(0.0), endTime_(0.0),
 pts_session_normalizer_(new PtsSessionNormalizer(env, usingLocalTs)),
 made_progress_(False), setup_iter_(NULL), cur_setup_subsession_(NULL), 
 org_verbosity_level_(verbosityLevel),
-ignore_sdp_sps_(ignore_sdp_sps)
-
+ignore_sdp_sps_(ignore_sdp_sps), 
+reorder_min_time_(reorderMinTime), reorder_max_time_(reorderMaxTime), 
+reconnect_min_interval_(RTSP_CLIENT_RECONNECT_MIN_INTERVAL), 
+reconnect_max_interval_(0), 
+reconnect_interval_(RTSP_CLIENT_RECONNECT_MIN_INTERVAL), 
+reconnect_task_(NULL), has_played_(False), 
+using_cached_sdp_(False), has_prev_metadata_(False), 
+drop_damaged_frames_(False)
 {
     if(singleMedium != NULL){
         single_medium_ = strdup(singleMedium);
@@ -191,23 +205,11 @@ void LiveRtspClient::Shutdown()
     are_already_shutting_down_ = True;
     
     //cancel the delay task
-    if(session_timer_task_ != NULL) {
-        envir().taskScheduler().unscheduleDelayedTask(session_timer_task_);
-        session_timer_task_ = NULL;
+    StopTimers();
+    if(reconnect_task_ != NULL) {
+        envir().taskScheduler().unscheduleDelayedTask(reconnect_task_);
+        reconnect_task_ = NULL;
     }
-    if(inter_frame_gap_check_timer_task_ != NULL) {
-        envir().taskScheduler().unscheduleDelayedTask(inter_frame_gap_check_timer_task_);
-        inter_frame_gap_check_timer_task_ = NULL;
-    }
-
-    if(rtsp_keep_alive_task_ != NULL) {
-        envir().taskScheduler().unscheduleDelayedTask(rtsp_keep_alive_task_);
-        rtsp_keep_alive_task_ = NULL;
-    }    
-    if(rtsp_timeout_task_ != NULL) {
-        envir().taskScheduler().unscheduleDelayedTask(rtsp_timeout_task_);
-        rtsp_timeout_task_ = NULL;
-    }    
     
     // Teardown, then shutdown immediately
     if (session_ != NULL) {
@@ -219,6 +221,46 @@ void LiveRtspClient::Shutdown()
 }
 
 
+void LiveRtspClient::SetReconnectInterval(unsigned min_interval, unsigned max_interval)
+{
+    if(min_interval == 0){
+        min_interval = RTSP_CLIENT_RECONNECT_MIN_INTERVAL;
+    }
+    if(max_interval != 0 && max_interval < min_interval){
+        max_interval = min_interval;
+    }
+    reconnect_min_interval_ = min_interval;
+    reconnect_max_interval_ = max_interval;
+    reconnect_interval_ = min_interval;
+}
+
+
+bool IsSameCodecConfig(const stream_switch::StreamMetadata &a, 
+                       const stream_switch::StreamMetadata &b)
+{
+    using namespace stream_switch;
+    if(a.sub_streams.size() != b.sub_streams.size()){
+        return false;
+    }
+    for(size_t i = 0; i < a.sub_streams.size(); i++){
+        const SubStreamMetadata &sa = a.sub_streams[i];
+        const SubStreamMetadata &sb = b.sub_streams[i];
+        if(sa.media_type != sb.media_type || 
+           sa.codec_name != sb.codec_name || 
+           sa.extra_data != sb.extra_data){
+            return false;
+        }
+        if(sa.media_type == SUB_STREAM_MEIDA_TYPE_AUDIO && 
+           (sa.media_param.audio.samples_per_second != 
+            sb.media_param.audio.samples_per_second || 
+            sa.media_param.audio.channels != sb.media_param.audio.channels)){
+            return false;
+        }
+    }
+    return true;
+}
+
+
 bool LiveRtspClient::CheckMetadata()
 {
     using namespace stream_switch;
@@ -265,6 +307,24 @@ bool LiveRtspClient::CheckMetadata()
     
     //check successful
     is_metadata_ok_ = True;
+    
+    if(has_prev_metadata_){
+        // reconnected, keep on the ssrc if the codec configuration is 
+        // unchanged, so that the subscribers only see a gap of frames
+        has_prev_metadata_ = False;
+        if(IsSameCodecConfig(prev_metadata_, metadata_)){
+            envir() << "Codec configuration unchanged after reconnect, "
+                    << "keep on the stream\n";
+            return true;
+        }
+        uint32_t prev_ssrc = metadata_.ssrc;
+        do{
+            metadata_.ssrc = (uint32_t)(rand() % 0xffffffff);
+        }while(metadata_.ssrc == 0 || metadata_.ssrc == prev_ssrc);
+        envir() << "Codec configuration changed after reconnect, "
+                << "select a new ssrc\n";
+    }
+    
     if(listener_ != NULL){
         listener_->OnMetaReady(metadata_);
     }
@@ -281,8 +341,19 @@ void LiveRtspClient::AfterGettingFrame(int32_t sub_stream_index,
                            struct timeval timestamp, 
                            unsigned frame_size, 
                            const char * frame_buf)
+{
+    stream_switch::MediaFrameSegment segment(frame_buf, frame_size);
+    AfterGettingFrameV(sub_stream_index, frame_type, timestamp, &segment, 1);
+}
+
+void LiveRtspClient::AfterGettingFrameV(int32_t sub_stream_index, 
+                           stream_switch::MediaFrameType frame_type, 
+                           struct timeval timestamp, 
+                           const stream_switch::MediaFrameSegment * segments, 
+                           int segment_num)
 {
     if (are_already_shutting_down_) return; 
+    if (reconnect_task_ != NULL) return; // waiting for reconnect
     
     if(!IsMetaReady()){
         //metadata not ready, just drop the frame
@@ -315,7 +386,7 @@ void LiveRtspClient::AfterGettingFrame(int32_t sub_stream_index,
         frame_info.timestamp.tv_usec = timestamp.tv_usec;
         frame_info.sub_stream_index = sub_stream_index;
         frame_info.ssrc = metadata_.ssrc;
-        listener_->OnMediaFrame(frame_info, frame_buf, frame_size);
+        listener_->OnMediaFrame(frame_info, segments, segment_num);
     }
     
 }
@@ -328,6 +399,78 @@ void LiveRtspClient::UpdateLostFrame(int32_t sub_stream_index, uint64_t lost_fra
     }       
 }
 
+void LiveRtspClient::UpdateRtpStatistic()
+{
+    if(session_ == NULL || listener_ == NULL){
+        return;
+    }
+    
+    MediaSubsessionIterator iter(*session_);
+    MediaSubsession *subsession;
+    while ((subsession = iter.next()) != NULL) {
+        MediaOutputSink * sink = 
+            dynamic_cast<MediaOutputSink *>(subsession->sink);
+        MultiFramedRTPSource * rtp_source = 
+            dynamic_cast<MultiFramedRTPSource *>(subsession->rtpSource());
+        if(sink == NULL || rtp_source == NULL){
+            continue;
+        }
+        RtpRecvStatistic statistic;
+        statistic.sub_stream_index = sink->sub_stream_index();
+        statistic.reorder_threshold = rtp_source->packetReorderingThresholdTime();
+        statistic.reorder_delay = rtp_source->packetReorderingDelay();
+        statistic.reorder_depth = rtp_source->packetReorderingDepth();
+        statistic.jitter = rtp_source->packetJitter();
+        statistic.reordered_packets = rtp_source->numReorderedPackets();
+        statistic.late_packets = rtp_source->numLatePackets();
+        statistic.lost_packets = rtp_source->numLostPackets();
+        statistic.lost_frames = rtp_source->numLostFrames();
+        statistic.damaged_frames = rtp_source->numDamagedFrames();
+        statistic.pts_offset = (int32_t)pts_session_normalizer_->ptsOffset();
+        statistic.pts_drift = (int32_t)pts_session_normalizer_->ptsDriftRate();
+        listener_->OnRtpStatisticUpdate(statistic);
+        
+        // the damaged frames can't be played correctly as well
+        UpdateLostFrame(statistic.sub_stream_index, 
+            statistic.lost_frames + statistic.damaged_frames);
+    }
+}
+
+int RtspErrToStreamState(RtspClientErrCode err_code)
+{
+    switch(err_code){
+ 
+    case RTSP_CLIENT_ERR_CONNECT_FAIL: 
+    case RTSP_CLIENT_ERR_DESCRIBE_ERR:  
+        return stream_switch::SOURCE_STREAM_STATE_ERR_CONNECT_FAIL;
+
+    case RTSP_CLIENT_ERR_SUBSESSION_BYE:  
+    case RTSP_CLIENT_ERR_INTER_FRAME_GAP: 
+        return stream_switch::SOURCE_STREAM_STATE_ERR_MEIDA_STOP;
+
+    case RTSP_CLIENT_ERR_TIME_ERR:  
+        return stream_switch::SOURCE_STREAM_STATE_ERR_TIME;
+        
+    default:
+        return stream_switch::SOURCE_STREAM_STATE_ERR;
+    }
+}
+
+void FillRtpStatistic(const RtpRecvStatistic &rtp_statistic, 
+                      stream_switch::SubStreamMediaStatistic *statistic)
+{
+    statistic->lost_packets = rtp_statistic.lost_packets;
+    statistic->reordered_packets = rtp_statistic.reordered_packets;
+    statistic->late_packets = rtp_statistic.late_packets;
+    statistic->damaged_frames = rtp_statistic.damaged_frames;
+    statistic->jitter = rtp_statistic.jitter;
+    statistic->reorder_threshold = rtp_statistic.reorder_threshold;
+    statistic->reorder_delay = rtp_statistic.reorder_delay;
+    statistic->reorder_depth = rtp_statistic.reorder_depth;
+    statistic->pts_offset = rtp_statistic.pts_offset;
+    statistic->pts_drift = rtp_statistic.pts_drift;
+}
+
 
 ////////////////////////////////////////////////////////////
 //RTSP callback function
@@ -378,125 +521,12 @@ void LiveRtspClient::ContinueAfterDESCRIBE(RTSPClient* client, int resultCode, c
     my_client->envir() << "Opened URL \"" << my_client->rtsp_url_.c_str() 
         << "\", returning a SDP description:\n" << sdpDescription << "\n";
 
-    // Create a media session object from this SDP description:
-    my_client->session_ = MediaSession::createNew(my_client->envir(), sdpDescription);
+    // cache the SDP and its base url for the later reconnect
+    my_client->sdp_ = sdpDescription;
+    my_client->base_url_ = my_client->url();
     delete[] sdpDescription;
-    if (my_client->session_ == NULL) {
-        my_client->envir() << "Failed to create a MediaSession object from the SDP description: " 
-        << my_client->envir().getResultMsg() << "\n";
-        my_client->HandleError(RTSP_CLIENT_ERR_MEDIASESSION_CREATE_FAIL, 
-            "Failed to create a MediaSession from the SDP");  
-        return;
-    
-    } else if (!my_client->session_->hasSubsessions()) {
-        my_client->envir() << "This session has no media subsessions (i.e., no \"m=\" lines)\n";
-        my_client->HandleError(RTSP_CLIENT_ERR_NO_SUBSESSION, 
-            "This session has no media subsessions"); 
-        return;
-    }
-
-    // Then, setup the "RTPSource"s for the session:
-    MediaSubsessionIterator iter(*(my_client->session_));
-    MediaSubsession *subsession;
-    Boolean madeProgress = False;
-    char const* singleMediumToTest = my_client->single_medium_;
-    while ((subsession = iter.next()) != NULL) {
-        // If we've asked to receive only a single medium, then check this now:
-        if (singleMediumToTest != NULL) {
-            if (strcmp(subsession->mediumName(), singleMediumToTest) != 0) {
-                my_client->envir() << "Ignoring \"" << subsession->mediumName()
-                        << "/" << subsession->codecName()
-                    << "\" subsession, because we've asked to receive a single " << singleMediumToTest
-                    << " session only\n";
-                continue;
-            } else {
-                // Receive this subsession only
-                singleMediumToTest = "xxxxx";
-                // this hack ensures that we get only 1 subsession of this type
-            }
-        }
-        
-        //Jmkn:no desired port
-/*
-        if (desiredPortNum != 0) {
-            subsession->setClientPortNum(desiredPortNum);
-            desiredPortNum += 2;
-        }
-*/
-
-        if (!subsession->initiate(simpleRTPoffsetArg)) {
-            my_client->envir() << "Unable to create receiver for \"" << subsession->mediumName()
-                << "/" << subsession->codecName()
-                << "\" subsession: " << my_client->envir().getResultMsg() << "\n";
-                
-        } else {
-            my_client->envir() << "Created receiver for \"" << subsession->mediumName()
-                << "/" << subsession->codecName() << "\" subsession (";
-            if (subsession->rtcpIsMuxed()) {
-                my_client->envir() << "client port " << subsession->clientPortNum();
-            } else {
-                my_client->envir() << "client ports " << subsession->clientPortNum()
-                    << "-" << subsession->clientPortNum()+1;
-            }
-            my_client->envir() << ")\n";
-            madeProgress = True;
-	
-            if (subsession->rtpSource() != NULL) {
-                // Because we're relaying the incoming data lively, rather than saving, 
-                // should use an especially small time threshold, maybe 10ms is suitable?
-
-                subsession->rtpSource()->setPacketReorderingThresholdTime(rtpClientReorderWindowthresh);
-	  
-        // Set the RTP source's OS socket buffer size as appropriate - either if we were explicitly asked (using -B),
-        // or if the desired FileSink buffer size happens to be larger than the current OS socket buffer size.
-        // (The latter case is a heuristic, on the assumption that if the user asked for a large FileSink buffer size,
-        // then the input data rate may be large enough to justify increasing the OS socket buffer size also.)
-                int socketNum = subsession->rtpSource()->RTPgs()->socketNum();
-                unsigned curBufferSize = getReceiveBufferSize(my_client->envir(), socketNum);
-                unsigned socket_input_buf = 0;
-                unsigned sink_file_buf = 0;
-                if(strcmp(subsession->mediumName(), "video") == 0){
-                    socket_input_buf = socketVideoInputBufferSize;
-                    sink_file_buf = VideoSinkBufferSize; 
-                    if(my_client->stream_using_tcp_){
-                        //for tcp, no need to using to large buffer, because tcp can control the speed
-                        socket_input_buf /= 2;
-                    }
-                }else{
-                    socket_input_buf = socketAudioInputBufferSize;
-                    sink_file_buf = AudioSinkBufferSize;                    
-                }
-
-                
-                if (socket_input_buf > 0 || sink_file_buf > curBufferSize) {
-                    unsigned newBufferSize = socket_input_buf > 0 ? socket_input_buf : sink_file_buf;
-                    //my_client->envir() << " set new socket bufer size " << newBufferSize <<"\n";
-                    newBufferSize = setReceiveBufferTo(my_client->envir(), socketNum, newBufferSize);
-                    if (socket_input_buf > 0) { // The user explicitly asked for the new socket buffer size; announce it:
-                        my_client->envir() << "Changed socket receive buffer size for the \""
-                            << subsession->mediumName()
-                            << "/" << subsession->codecName()
-                            << "\" subsession from "
-                            << curBufferSize << " to "
-                            << newBufferSize << " bytes\n";
-                    }
-                } //if (socket_input_buf > 0 || sink_file_buf > curBufferSize)
-            }//if (subsession->rtpSource() != NULL)
-        }//if (!subsession->initiate(simpleRTPoffsetArg))
-
-    }//while ((subsession = iter.next()) != NULL)
-    
-    if (!madeProgress) {        
-        my_client->HandleError(RTSP_CLIENT_ERR_SUBSESSION_INIT_ERR, 
-            "Subsessions init error");     
-
-        return;
-    }
-
-    // Perform additional 'setup' on each subsession, before playing them:
-    my_client->made_progress_ = False;
-    my_client->SetupStreams();
 
+    my_client->StartSession(my_client->sdp_.c_str());
 }
 
 
@@ -520,6 +550,14 @@ void LiveRtspClient::ContinueAfterSETUP(RTSPClient* client, int resultCode, char
         my_client->envir()  << "Failed to setup \"" << my_client->cur_setup_subsession_->mediumName()
             << "/" << my_client->cur_setup_subsession_->codecName()
             << "\" subsession: " << resultString << "\n";
+        if(my_client->using_cached_sdp_){
+            // the cached SDP may be out of date
+            if(resultString != NULL) {
+                delete[] resultString;
+            }
+            my_client->FallbackToDescribe("SETUP failed");
+            return;
+        }
     }
     if(resultString != NULL) {
         delete[] resultString;
@@ -588,6 +626,8 @@ int LiveRtspClient::SetupSinks()
                                             this, 
                                             subsession, index, 
                                             VideoSinkBufferSize, 
+                                            VideoSinkRecvSize, 
+                                            VideoSinkChunkSize, 
                                             264);
 
             } else if (strcmp(subsession->codecName(), "H265") == 0) {
@@ -598,6 +638,8 @@ int LiveRtspClient::SetupSinks()
                                             this, 
                                             subsession, index, 
                                             VideoSinkBufferSize, 
+                                            VideoSinkRecvSize, 
+                                            VideoSinkChunkSize, 
                                             265);
 
             } else if (strcmp(subsession->codecName(), "MP4V-ES") == 0) {
@@ -605,26 +647,34 @@ int LiveRtspClient::SetupSinks()
                 output_sink = Mpeg4OutputSink::createNew(envir(), 
                                             this, 
                                             subsession, index, 
-                                            VideoSinkBufferSize);                          
+                                            VideoSinkBufferSize, 
+                                            VideoSinkRecvSize, 
+                                            VideoSinkChunkSize);                          
             
             }else{
                 output_sink = MediaOutputSink::createNew(envir(), 
                                             this, 
                                             subsession, index, 
-                                            VideoSinkBufferSize);                   
+                                            VideoSinkBufferSize, 
+                                            VideoSinkRecvSize, 
+                                            VideoSinkChunkSize);                   
             }
         } else if (strcmp(subsession->mediumName(), "audio") == 0) {
             output_sink = MediaOutputSink::createNew(envir(), 
                                           this, 
                                           subsession, index, 
-                                          AudioSinkBufferSize);            
+                                          AudioSinkBufferSize, 
+                                          AudioSinkRecvSize, 
+                                          AudioSinkChunkSize);            
         }
         if (output_sink == NULL) {
             // Normal case:
             output_sink = MediaOutputSink::createNew(envir(), 
                 this, 
                 subsession, index, 
-                AudioSinkBufferSize);
+                AudioSinkBufferSize, 
+                AudioSinkRecvSize, 
+                AudioSinkChunkSize);
 
         }
 
@@ -740,12 +790,18 @@ void LiveRtspClient::ContinueAfterPLAY(RTSPClient* client, int resultCode, char*
     }    
     if (resultCode != 0) {
         my_client->envir() << "Failed to start playing session: " << resultString << "\n";
+        if(my_client->using_cached_sdp_){
+            my_client->FallbackToDescribe("PLAY failed");
+            return;
+        }
         my_client->HandleError(RTSP_CLIENT_ERR_PLAY_ERR, 
             "RTSP Play error");  
         return;
     } else {
         my_client->envir() << "Started playing session\n";
     }
+    my_client->has_played_ = True;
+    my_client->reconnect_interval_ = my_client->reconnect_min_interval_;
 
 
     // Figure out how long to delay (if at all) before shutting down, or
@@ -1004,6 +1060,7 @@ void LiveRtspClient::CheckInterFrameGaps(void* clientData)
             "Inter Frame Gap timeout");        
         return;
     }else{
+        my_client->UpdateRtpStatistic();
         my_client->inter_frame_gap_check_timer_task_ =
             my_client->envir().taskScheduler().scheduleDelayedTask(1000000, //each second
 				 (TaskFunc*)CheckInterFrameGaps, my_client);
@@ -1013,6 +1070,14 @@ void LiveRtspClient::CheckInterFrameGaps(void* clientData)
     
 
     
+}
+
+void LiveRtspClient::ReconnectHandler(void* clientData)
+{
+    LiveRtspClient *my_client = (LiveRtspClient *)clientData;
+    my_client->reconnect_task_ = NULL;
+    
+    my_client->Reconnect();
 }
 
 ////////////////////////////////////////////////////////////
@@ -1024,6 +1089,27 @@ void LiveRtspClient::SetUserAgentString(char const* userAgentString)
     RTSPClient::setUserAgentString(userAgentString);
 }
 
+void LiveRtspClient::StopTimers()
+{
+    if(session_timer_task_ != NULL) {
+        envir().taskScheduler().unscheduleDelayedTask(session_timer_task_);
+        session_timer_task_ = NULL;
+    }
+    if(inter_frame_gap_check_timer_task_ != NULL) {
+        envir().taskScheduler().unscheduleDelayedTask(inter_frame_gap_check_timer_task_);
+        inter_frame_gap_check_timer_task_ = NULL;
+    }
+
+    if(rtsp_keep_alive_task_ != NULL) {
+        envir().taskScheduler().unscheduleDelayedTask(rtsp_keep_alive_task_);
+        rtsp_keep_alive_task_ = NULL;
+    }    
+    if(rtsp_timeout_task_ != NULL) {
+        envir().taskScheduler().unscheduleDelayedTask(rtsp_timeout_task_);
+        rtsp_timeout_task_ = NULL;
+    }    
+}
+
 void LiveRtspClient::CloseMediaSinks()
 {
   if (session_ == NULL) return;
@@ -1036,6 +1122,140 @@ void LiveRtspClient::CloseMediaSinks()
 }
 
 
+void LiveRtspClient::StartSession(char const* sdp_description)
+{
+    // Create a media session object from this SDP description:
+    session_ = MediaSession::createNew(envir(), sdp_description);
+    if (session_ == NULL) {
+        envir() << "Failed to create a MediaSession object from the SDP description: " 
+        << envir().getResultMsg() << "\n";
+        HandleError(RTSP_CLIENT_ERR_MEDIASESSION_CREATE_FAIL, 
+            "Failed to create a MediaSession from the SDP");  
+        return;
+    
+    } else if (!session_->hasSubsessions()) {
+        envir() << "This session has no media subsessions (i.e., no \"m=\" lines)\n";
+        HandleError(RTSP_CLIENT_ERR_NO_SUBSESSION, 
+            "This session has no media subsessions"); 
+        return;
+    }
+
+    // Then, setup the "RTPSource"s for the session:
+    MediaSubsessionIterator iter(*(session_));
+    MediaSubsession *subsession;
+    Boolean madeProgress = False;
+    char const* singleMediumToTest = single_medium_;
+    while ((subsession = iter.next()) != NULL) {
+        // If we've asked to receive only a single medium, then check this now:
+        if (singleMediumToTest != NULL) {
+            if (strcmp(subsession->mediumName(), singleMediumToTest) != 0) {
+                envir() << "Ignoring \"" << subsession->mediumName()
+                        << "/" << subsession->codecName()
+                    << "\" subsession, because we've asked to receive a single " << singleMediumToTest
+                    << " session only\n";
+                continue;
+            } else {
+                // Receive this subsession only
+                singleMediumToTest = "xxxxx";
+                // this hack ensures that we get only 1 subsession of this type
+            }
+        }
+        
+        //Jmkn:no desired port
+/*
+        if (desiredPortNum != 0) {
+            subsession->setClientPortNum(desiredPortNum);
+            desiredPortNum += 2;
+        }
+*/
+
+        if (!subsession->initiate(simpleRTPoffsetArg)) {
+            envir() << "Unable to create receiver for \"" << subsession->mediumName()
+                << "/" << subsession->codecName()
+                << "\" subsession: " << envir().getResultMsg() << "\n";
+                
+        } else {
+            envir() << "Created receiver for \"" << subsession->mediumName()
+                << "/" << subsession->codecName() << "\" subsession (";
+            if (subsession->rtcpIsMuxed()) {
+                envir() << "client port " << subsession->clientPortNum();
+            } else {
+                envir() << "client ports " << subsession->clientPortNum()
+                    << "-" << subsession->clientPortNum()+1;
+            }
+            envir() << ")\n";
+            madeProgress = True;
+	
+            if (subsession->rtpSource() != NULL) {
+                // Because we're relaying the incoming data lively, rather than saving, 
+                // should use an especially small time threshold, maybe 10ms is suitable?
+
+                // If a range is given, the threshold is adapted to the 
+                // reordering and jitter measured on this subsession, which 
+                // keeps it small on clean links
+                MultiFramedRTPSource * rtp_source = 
+                    dynamic_cast<MultiFramedRTPSource *>(subsession->rtpSource());
+                if(rtp_source != NULL && 
+                   reorder_max_time_ > reorder_min_time_){
+                    rtp_source->setPacketReorderingThresholdRange(
+                        reorder_min_time_, reorder_max_time_);
+                }else{
+                    subsession->rtpSource()->setPacketReorderingThresholdTime(
+                        reorder_min_time_);
+                }
+	  
+        // Set the RTP source's OS socket buffer size as appropriate - either if we were explicitly asked (using -B),
+        // or if the desired FileSink buffer size happens to be larger than the current OS socket buffer size.
+        // (The latter case is a heuristic, on the assumption that if the user asked for a large FileSink buffer size,
+        // then the input data rate may be large enough to justify increasing the OS socket buffer size also.)
+                int socketNum = subsession->rtpSource()->RTPgs()->socketNum();
+                unsigned curBufferSize = getReceiveBufferSize(envir(), socketNum);
+                unsigned socket_input_buf = 0;
+                unsigned sink_file_buf = 0;
+                if(strcmp(subsession->mediumName(), "video") == 0){
+                    socket_input_buf = socketVideoInputBufferSize;
+                    sink_file_buf = VideoSinkBufferSize; 
+                    if(stream_using_tcp_){
+                        //for tcp, no need to using to large buffer, because tcp can control the speed
+                        socket_input_buf /= 2;
+                    }
+                }else{
+                    socket_input_buf = socketAudioInputBufferSize;
+                    sink_file_buf = AudioSinkBufferSize;                    
+                }
+
+                
+                if (socket_input_buf > 0 || sink_file_buf > curBufferSize) {
+                    unsigned newBufferSize = socket_input_buf > 0 ? socket_input_buf : sink_file_buf;
+                    //envir() << " set new socket bufer size " << newBufferSize <<"\n";
+                    newBufferSize = setReceiveBufferTo(envir(), socketNum, newBufferSize);
+                    if (socket_input_buf > 0) { // The user explicitly asked for the new socket buffer size; announce it:
+                        envir() << "Changed socket receive buffer size for the \""
+                            << subsession->mediumName()
+                            << "/" << subsession->codecName()
+                            << "\" subsession from "
+                            << curBufferSize << " to "
+                            << newBufferSize << " bytes\n";
+                    }
+                } //if (socket_input_buf > 0 || sink_file_buf > curBufferSize)
+            }//if (subsession->rtpSource() != NULL)
+        }//if (!subsession->initiate(simpleRTPoffsetArg))
+
+    }//while ((subsession = iter.next()) != NULL)
+    
+    if (!madeProgress) {        
+        HandleError(RTSP_CLIENT_ERR_SUBSESSION_INIT_ERR, 
+            "Subsessions init error");     
+
+        return;
+    }
+
+    // Perform additional 'setup' on each subsession, before playing them:
+    made_progress_ = False;
+    SetupStreams();
+}
+
+
 void LiveRtspClient::SetupMetaFromSession()
 {
     using namespace stream_switch;
@@ -1180,6 +1400,35 @@ void LiveRtspClient::HandleError(RtspClientErrCode err_code,
     //jamken: not shutdown because of segment fault when handling frame
     //Shutdown();
     
+    if(reconnect_max_interval_ != 0 && has_played_ && 
+       err_code != RTSP_CLIENT_ERR_USER_DEMAND && 
+       err_code != RTSP_CLIENT_ERR_SESSION_TIMER){
+        //the session has been played, reconnect in process
+        if(are_already_shutting_down_ || reconnect_task_ != NULL){
+            return; // already reconnecting
+        }
+        
+        if(is_metadata_ok_){
+            prev_metadata_ = metadata_;
+            has_prev_metadata_ = True;
+        }
+        StopTimers();
+        
+        envir() << "Reconnect in " << reconnect_interval_ / 1000 
+                << " ms because of error: " << err_info << "\n";
+        if(listener_ != NULL){
+            listener_->OnReconnecting(err_code, err_info, reconnect_interval_);
+        }
+        
+        ScheduleReconnect(reconnect_interval_);
+        
+        reconnect_interval_ *= 2;
+        if(reconnect_interval_ > reconnect_max_interval_){
+            reconnect_interval_ = reconnect_max_interval_;
+        }
+        return;
+    }
+    
     if(listener_ != NULL){
         listener_->OnError(err_code, err_info);
     }
@@ -1188,4 +1437,74 @@ void LiveRtspClient::HandleError(RtspClientErrCode err_code,
 }
 
 
+/////////////////////////////////////////////////////////
+//reconnect
+
+void LiveRtspClient::ScheduleReconnect(unsigned interval)
+{
+    // The session cannot be closed in the error context, which may be a 
+    // callback of the session itself, so reconnect in a delayed task
+    if(reconnect_task_ != NULL){
+        return;
+    }
+    reconnect_task_ = envir().taskScheduler().scheduleDelayedTask(
+        interval, (TaskFunc*)ReconnectHandler, (void*)this);    
+}
+
+void LiveRtspClient::Reconnect()
+{
+    // close the previous session, and tear it down by the way in case 
+    // the server is still alive
+    if (session_ != NULL) {
+        TearDownSession(session_, NULL);
+        CloseMediaSinks();
+        Medium::close(session_);
+        session_ = NULL;
+    }
+    if(setup_iter_ != NULL){
+        delete setup_iter_;
+        setup_iter_ = NULL;
+    }
+    
+    // drop the previous connection along with the RTSP session id
+    reset();
+    
+    metadata_.sub_streams.clear();
+    is_metadata_ok_ = False;
+    
+    rtsp_timeout_task_ = envir().taskScheduler().scheduleDelayedTask(
+        60000000 /* 1 minutes */, (TaskFunc*)RtspClientConnectTimeout, 
+        (void*)this);
+    
+    if(sdp_.size() != 0){
+        // go directly to SETUP / PLAY with the cached SDP, if the server 
+        // refuses it, fall back to a full DESCRIBE
+        envir() << "Reconnect \"" << rtsp_url_.c_str() 
+                << "\" with the cached SDP\n";
+        setBaseURL(base_url_.c_str());
+        using_cached_sdp_ = True;
+        StartSession(sdp_.c_str());
+    }else{
+        envir() << "Reconnect \"" << rtsp_url_.c_str() << "\"\n";
+        setBaseURL(rtsp_url_.c_str());
+        using_cached_sdp_ = False;
+        GetSDPDescription(ContinueAfterDESCRIBE);
+    }
+}
+
+void LiveRtspClient::FallbackToDescribe(const char * reason)
+{
+    envir() << "Failed to reuse the cached SDP (" << reason 
+            << "), fall back to DESCRIBE\n";
+    sdp_.clear();
+    using_cached_sdp_ = False;
+    if(setup_iter_ != NULL){
+        delete setup_iter_;
+        setup_iter_ = NULL;
+    }
+    StopTimers();
+    ScheduleReconnect(0);
+}
+
+
 
@@ -37,6 +37,48 @@
 #include "FramedSource.hh"
 #include "stream_switch.h"
 
+#include <string>
+
+
+// the default bounds of the adaptive RTP reordering threshold
+#define RTSP_CLIENT_REORDER_MIN_TIME   5000     // 5 ms
+#define RTSP_CLIENT_REORDER_MAX_TIME   200000   // 200 ms
+
+// the first backoff interval of the in-process reconnect
+#define RTSP_CLIENT_RECONNECT_MIN_INTERVAL  500000   // 500 ms
+
+
+// the RTP receive statistic of a sub stream
+struct RtpRecvStatistic{
+    int32_t sub_stream_index;      // -1 means no statistic yet
+    uint32_t reorder_threshold;    // the reordering threshold in use, in us
+    uint32_t reorder_delay;        // the estimated reordering delay, in us
+    uint32_t reorder_depth;        // the reordering depth, in packets
+    uint32_t jitter;               // the interarrival jitter, in us
+    uint64_t reordered_packets;    // the packets arrived out of order
+    uint64_t late_packets;         // the packets arrived after the threshold
+    uint64_t lost_packets;         // the packets never received
+    uint64_t lost_frames;          // the frames none of whose packets received
+    uint64_t damaged_frames;       // the frames partially received
+    int32_t pts_offset;            // the correction for the server's clock drift, in us
+    int32_t pts_drift;             // the drift rate of the server's clock, in ppm
+    
+    RtpRecvStatistic()
+    :sub_stream_index(-1), reorder_threshold(0), reorder_delay(0), 
+     reorder_depth(0), jitter(0), reordered_packets(0), late_packets(0), 
+     lost_packets(0), lost_frames(0), damaged_frames(0), 
+     pts_offset(0), pts_drift(0)
+    {
+    }
+};
+
+// FillRtpStatistic()
+// Fill the transport fields of the media statistic of a sub stream from 
+// its RTP receive statistic
+void FillRtpStatistic(const RtpRecvStatistic &rtp_statistic, 
+                      stream_switch::SubStreamMediaStatistic *statistic);
+
+
 // the LIve Rtsp Client listener class
 //     An interface to handle live rtsp client's callback. 
 // When some event happens, the rtsp client would 
@@ -61,6 +103,11 @@ enum RtspClientErrCode{
     RTSP_CLIENT_ERR_TIME_ERR = -13,    
 };
 
+// RtspErrToStreamState()
+// map the error code of rtsp client to the stream state of stream_switch
+// source
+int RtspErrToStreamState(RtspClientErrCode err_code);
+
 class MediaOutputSink;   
 class PtsSessionNormalizer;
 typedef std::vector<MediaOutputSink *> MediaOutputSinkList;
@@ -68,11 +115,12 @@ typedef std::vector<MediaOutputSink *> MediaOutputSinkList;
 class LiveRtspClientListener{
 public:    
     // When the client get a frame from remote server successfully, 
-    // OnMediaFrame() would be invoke 
+    // OnMediaFrame() would be invoke. The frame data may be made up of 
+    // several segments, which can be passed to SendLiveMediaFrameV() 
     virtual void OnMediaFrame(
         const stream_switch::MediaFrameInfo &frame_info, 
-        const char * frame_data, 
-        size_t frame_size
+        const stream_switch::MediaFrameSegment * segments, 
+        int segment_num
     ) = 0;
     
     // When the client detect some error, 
@@ -94,13 +142,57 @@ public:
     virtual void OnRtspOK() = 0;  
     
     
+    // the frames lost or damaged, counted from the RTP sequence numbers 
+    // of each sub stream, are updated every second by OnLostFrameUpdate()
     virtual void OnLostFrameUpdate(int32_t sub_stream_index, uint64_t lost_frame ) = 0;
+    
+    // the RTP receive statistic of each sub stream is updated every second 
+    // by OnRtpStatisticUpdate()
+    virtual void OnRtpStatisticUpdate(const RtpRecvStatistic &statistic) = 0;
+    
+    // If the in-process reconnect is enabled, when the client detect some 
+    // error after the session has been played, OnReconnecting() would be 
+    // invoked instead of OnError(), and the client would reconnect the 
+    // server after retry_interval (in us). OnRtspOK() is invoked again 
+    // when the session is playing, and OnMetaReady() is invoked again 
+    // with a new ssrc only if the codec configuration has changed
+    virtual void OnReconnecting(RtspClientErrCode err_code, const char * err_info, 
+                                unsigned retry_interval) = 0;
 };
 
 
 
 
-class LiveRtspClient: public RTSPClient{
+// IsSameCodecConfig()
+// check whether the codec configuration of the two metadata is the same, 
+// which means the same stream can be kept on after reconnect
+bool IsSameCodecConfig(const stream_switch::StreamMetadata &a, 
+                       const stream_switch::StreamMetadata &b);
+
+
+// the RTSP client engine interface
+//     Both the live555 based LiveRtspClient and the lightweight 
+// LiteRtspClient implement it, so that the app and the sessions can 
+// drive either engine in the same way
+class RtspClientEngine{
+public:
+    virtual ~RtspClientEngine(){}
+    
+    virtual int Start() = 0;
+    virtual void Shutdown() = 0;
+    
+    // Close()
+    // destroy the client after shutdown, the pointer is invalid after it
+    virtual void Close() = 0;
+    
+    virtual void SetListener(LiveRtspClientListener * listener) = 0;
+    virtual void SetReconnectInterval(unsigned min_interval, unsigned max_interval) = 0;
+    virtual void SetDropDamagedFrames(Boolean drop) = 0;
+};
+
+
+
+class LiveRtspClient: public RTSPClient, public RtspClientEngine{
 public:
     static LiveRtspClient * CreateNew(UsageEnvironment& env, char const* rtspURL,                    
 			       Boolean streamUsingTCP = True, Boolean enableRtspKeepAlive = True, 
@@ -109,7 +201,9 @@ public:
                    Boolean usingLocalTs = False, 
                    LiveRtspClientListener * listener = NULL, 
                    int verbosityLevel = 0,
-                   Boolean ignore_sdp_sps = False);
+                   Boolean ignore_sdp_sps = False, 
+                   unsigned reorderMinTime = RTSP_CLIENT_REORDER_MIN_TIME, 
+                   unsigned reorderMaxTime = RTSP_CLIENT_REORDER_MAX_TIME);
 
     LiveRtspClient(UsageEnvironment& env, char const* rtspURL, 
 			       Boolean streamUsingTCP, Boolean enableRtspKeepAlive, 
@@ -118,13 +212,19 @@ public:
                    Boolean usingLocalTs, 
                    LiveRtspClientListener * listener, 
                    int verbosityLevel,
-                   Boolean ignore_sdp_sps);
+                   Boolean ignore_sdp_sps, 
+                   unsigned reorderMinTime, 
+                   unsigned reorderMaxTime);
                    
     virtual ~LiveRtspClient();
     
     
     virtual int Start();
     virtual void Shutdown();
+    virtual void Close()
+    {
+        Medium::close(this);
+    }
     
 
     virtual bool IsMetaReady()
@@ -143,14 +243,41 @@ public:
                            struct timeval timestamp, 
                            unsigned frame_size, 
                            const char * frame_buf);
+    virtual void AfterGettingFrameV(int32_t sub_stream_index, 
+                           stream_switch::MediaFrameType frame_type, 
+                           struct timeval timestamp, 
+                           const stream_switch::MediaFrameSegment * segments, 
+                           int segment_num);
                            
     virtual void SetListener(LiveRtspClientListener * listener)
     {
         listener_ = listener;
     }
     
+    // SetReconnectInterval()
+    // Enable the in-process reconnect, with an exponential backoff 
+    // interval from min_interval to max_interval (in us). 
+    // max_interval 0 disables it, which is the default
+    virtual void SetReconnectInterval(unsigned min_interval, unsigned max_interval);
+    
+    // SetDropDamagedFrames()
+    // Drop the frames which are known to lose some RTP packets, instead of 
+    // outputing them partially. Default is false
+    virtual void SetDropDamagedFrames(Boolean drop)
+    {
+        drop_damaged_frames_ = drop;
+    }
+    virtual Boolean drop_damaged_frames()
+    {
+        return drop_damaged_frames_;
+    }
+    
     
     virtual void UpdateLostFrame(int32_t sub_stream_index, uint64_t lost_frame );
+    
+    // collect the RTP receive statistic of all the sub streams, and 
+    // callback the listener
+    virtual void UpdateRtpStatistic();
 
     
 protected:
@@ -172,6 +299,7 @@ protected:
     static void SubsessionByeHandler(void* clientData);
     static void RtspClientConnectTimeout(void* clientData);
     static void CheckInterFrameGaps(void* clientData);    
+    static void ReconnectHandler(void* clientData);
     
     
     
@@ -210,13 +338,27 @@ protected:
         const char * err_info);  
         
     
+    /////////////////////////////////////////////////////////
+    //reconnect
+    virtual void ScheduleReconnect(unsigned interval);
+    virtual void Reconnect();
+    
+    // FallbackToDescribe()
+    // drop the cached SDP, and reconnect at once with a full DESCRIBE
+    virtual void FallbackToDescribe(const char * reason);
+        
+    
     ///////////////////////////////////////////////////////////
     //utils
     
     virtual void SetUserAgentString(char const* userAgentString);
     
+    virtual void StopTimers();
     virtual void CloseMediaSinks();
     
+    // create the media session from the SDP, and setup the streams
+    virtual void StartSession(char const* sdp_description);
+    
     virtual void SetupStreams();
     virtual int SetupSinks();
     
@@ -260,6 +402,22 @@ protected:
     
     Boolean ignore_sdp_sps_;
     
+    unsigned reorder_min_time_;   // in us
+    unsigned reorder_max_time_;   // in us
+    
+    // in-process reconnect
+    unsigned reconnect_min_interval_;   // in us
+    unsigned reconnect_max_interval_;   // in us, 0 means disabled
+    unsigned reconnect_interval_;       // in us, the next backoff interval
+    TaskToken reconnect_task_;
+    Boolean has_played_;
+    std::string sdp_;                  // the cached SDP of the last DESCRIBE
+    std::string base_url_;             // the base url along with sdp_
+    Boolean using_cached_sdp_;
+    Boolean has_prev_metadata_;
+    stream_switch::StreamMetadata prev_metadata_;   // the metadata before reconnect
+    
+    Boolean drop_damaged_frames_;
 };
 
 
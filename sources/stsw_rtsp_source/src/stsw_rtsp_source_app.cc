@@ -31,21 +31,19 @@
 
 #include "stsw_rtsp_source_app.h"
 
-#include "BasicUsageEnvironment.hh"
-
-#define LOGGER_CHECK_INTERVAL 600 //600 sec
+#include <unistd.h>
 
+#include <sstream>
 
+#include "BasicUsageEnvironment.hh"
+#include "stsw_epoll_task_scheduler.h"
+#include "stsw_lite_rtsp_client.h"
+#include "stsw_log.h"
+#include <pb_packet.pb.h>
 
+#define LOGGER_CHECK_INTERVAL 600 //600 sec
 
-#define STDERR_LOG(logger, level, fmt, ...)  \
-do {         \
-    if(logger != NULL){                  \
-        logger->Log(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__);   \
-    }else{                 \
-        fprintf(stderr, fmt, ##__VA_ARGS__);    \
-    }                             \
-}while(0)
+#define MAX_SESSION_THREADS 64
 
 
 RtspSourceApp * RtspSourceApp::s_instance = NULL;
@@ -53,22 +51,24 @@ RtspSourceApp * RtspSourceApp::s_instance = NULL;
 
 RtspSourceApp::RtspSourceApp()
 : rtsp_client_(NULL), scheduler_(NULL), env_(NULL), logger_(NULL), watch_variable_(0), 
-is_init_(false), exit_code_(0), logger_check_task_(NULL)
+is_init_(false), exit_code_(0), logger_check_task_(NULL), use_epoll_(false), multi_session_(false)
 {
     memset(lost_frames_, 0, sizeof(uint64_t) * MAX_SUBSTREAM_NUMBER);
+    pthread_mutex_init(&statistic_lock_, NULL);
+    pthread_mutex_init(&streams_lock_, NULL);
 }
 
 RtspSourceApp::~RtspSourceApp()
 {
     Uninit();
+    pthread_mutex_destroy(&streams_lock_);
+    pthread_mutex_destroy(&statistic_lock_);
 
 }
 
 int RtspSourceApp::Init(int argc, char ** argv)
 {
     int ret;
-    scheduler_ = BasicTaskScheduler::createNew();
-    env_ = BasicUsageEnvironment::createNew(*scheduler_); 
     prog_name_ = argv[0];
     std::string rtsp_url;
     Boolean streamUsingTCP = True;
@@ -80,6 +80,8 @@ int RtspSourceApp::Init(int argc, char ** argv)
     stream_switch::ArgParser parser;
     int verbosityLevel = 0;
     int queue_size = STSW_PUBLISH_SOCKET_HWM; 
+    unsigned reorder_min_time = RTSP_CLIENT_REORDER_MIN_TIME;
+    unsigned reorder_max_time = RTSP_CLIENT_REORDER_MAX_TIME;
     std::string err_info;
     
     //
@@ -87,6 +89,10 @@ int RtspSourceApp::Init(int argc, char ** argv)
     //parse the cmd line
     
     ParseArgv(argc, argv, &parser); // parse the cmd line
+    
+    use_epoll_ = parser.CheckOption("epoll-scheduler");
+    scheduler_ = CreateTaskScheduler(use_epoll_);
+    env_ = BasicUsageEnvironment::createNew(*scheduler_); 
 
 
     //Create logger
@@ -138,6 +144,26 @@ int RtspSourceApp::Init(int argc, char ** argv)
     }    
     
     
+    if(parser.CheckOption("multi-session")){
+        // in multi-session mode, this source is the control endpoint, 
+        // the streams are added / removed by its API at runtime
+        multi_session_ = true;
+        ret = InitSessionThreads(&parser);
+        if(ret){
+            ret = -1;
+            goto error_out3;
+        }
+        
+        STDERR_LOG(logger_, stream_switch::LOG_LEVEL_INFO, 
+                   "RTSP Source init successful in multi-session mode "
+                   "with %d threads\n", (int)session_threads_.size());
+        
+        LoggerCheckHandler(this);
+        is_init_ = true;
+        return 0;
+    }
+    
+    
     //Create Rtsp Client    
     rtsp_url = parser.OptionValue("url", "");
     if(parser.CheckOption("udp")){
@@ -169,22 +195,52 @@ int RtspSourceApp::Init(int argc, char ** argv)
     if(parser.CheckOption("ignore-sdp-sps")){
         ignore_sdp_sps = True;
     }      
+    
+    if(parser.CheckOption("reorder-min")){
+        reorder_min_time = (unsigned)strtoul(
+            parser.OptionValue("reorder-min", "5").c_str(), NULL, 0) * 1000;
+    }
+    if(parser.CheckOption("reorder-max")){
+        reorder_max_time = (unsigned)strtoul(
+            parser.OptionValue("reorder-max", "200").c_str(), NULL, 0) * 1000;
+    }
 /*    
     rtsp_client_ = LiveRtspClient::CreateNew(
         *env_, (char *)"rtsp://172.16.56.120:554/user=admin&password=123456&id=1&type=0",  True, True, 
         NULL,  NULL, NULL, (LiveRtspClientListener *)this, 1);
 */
-    rtsp_client_ = LiveRtspClient::CreateNew(
-        *env_, rtsp_url.c_str(),  streamUsingTCP, enableRtspKeepAlive, 
-        singleMedium,  userName, passwd, usingLocalTs, 
-        (LiveRtspClientListener *)this, 
-        verbosityLevel, ignore_sdp_sps);        
+    if(parser.CheckOption("lite-engine") && streamUsingTCP){
+        rtsp_client_ = LiteRtspClient::CreateNew(
+            *env_, rtsp_url.c_str(), enableRtspKeepAlive, 
+            singleMedium,  userName, passwd, 
+            (LiveRtspClientListener *)this, 
+            verbosityLevel, ignore_sdp_sps);
+    }else{
+        if(parser.CheckOption("lite-engine")){
+            STDERR_LOG(logger_, stream_switch::LOG_LEVEL_WARNING, 
+                       "The lite engine only supports TCP, use live555 instead\n");
+        }
+        rtsp_client_ = LiveRtspClient::CreateNew(
+            *env_, rtsp_url.c_str(),  streamUsingTCP, enableRtspKeepAlive, 
+            singleMedium,  userName, passwd, usingLocalTs, 
+            (LiveRtspClientListener *)this, 
+            verbosityLevel, ignore_sdp_sps, 
+            reorder_min_time, reorder_max_time);        
+    }
     if(rtsp_client_ == NULL){
         STDERR_LOG(logger_, stream_switch::LOG_LEVEL_ERR, 
-                    "LiveRtspClient::CreateNew() Failed: Maybe parameter error\n");        
+                    "Create RTSP client Failed: Maybe parameter error\n");        
         ret = -1;
         goto error_out3;
     }
+    if(parser.CheckOption("reconnect-max")){
+        rtsp_client_->SetReconnectInterval(RTSP_CLIENT_RECONNECT_MIN_INTERVAL, 
+            (unsigned)strtoul(
+                parser.OptionValue("reconnect-max", "0").c_str(), NULL, 0) * 1000000);
+    }
+    if(parser.CheckOption("drop-damaged")){
+        rtsp_client_->SetDropDamagedFrames(True);
+    }
     
     
     STDERR_LOG(logger_, stream_switch::LOG_LEVEL_INFO, 
@@ -251,7 +307,7 @@ void RtspSourceApp::Uninit()
     //shutdown delete rtsp Client
     if(rtsp_client_ != NULL){
         rtsp_client_->Shutdown();
-        Medium::close(rtsp_client_);
+        rtsp_client_->Close();
         rtsp_client_ = NULL;
     }
     
@@ -262,6 +318,10 @@ void RtspSourceApp::Uninit()
         delete source_;
         source_ = NULL;
     } 
+    
+    //stop all the sessions after the control source is gone, 
+    //so that no API handler is running
+    UninitSessionThreads();
 
     //delete logger
     if(logger_){
@@ -292,6 +352,25 @@ int RtspSourceApp::DoLoop()
     
     exit_code_ = 0;
     
+    if(multi_session_){
+        std::string err_info;
+        int ret;
+        //start the control source to accept the API requests
+        ret = source_->Start(&err_info);
+        if(ret){
+            STDERR_LOG(logger_, stream_switch::LOG_LEVEL_ERR, 
+                "Failed to start the control source (%d):%s\n",
+                 ret,  err_info.c_str());  
+            return ret;
+        }
+        source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_OK);
+        
+        env_->taskScheduler().doEventLoop(&watch_variable_);
+        
+        source_->Stop();
+        return exit_code_;
+    }
+    
     rtsp_client_->Start();
  
    
@@ -315,8 +394,71 @@ void RtspSourceApp::ParseArgv(int argc, char *argv[],
     std::string err_info;
     parser->RegisterBasicOptions();
     parser->RegisterSourceOptions();
+    RegisterRtspOptions(parser);
+    
+    parser->RegisterOption("epoll-scheduler", 0,  0, NULL, 
+                   "use the epoll based task scheduler instead of the select based one, "
+                   "which scales better with a large number of sockets", NULL, NULL);  
+                   
+    parser->RegisterOption("multi-session", 0,  0, NULL, 
+                   "multi-session mode, in which this source is a control endpoint "
+                   "named by --stream-name, and the RTSP streams are added / removed "
+                   "at runtime through its API, each stream is published by its own "
+                   "source with the options given in the API request", NULL, NULL);  
+                   
+    parser->RegisterOption("session-threads", 0, 
+                    OPTION_FLAG_LONG | OPTION_FLAG_WITH_ARG,  "NUM", 
+                    "the number of the scheduler threads which the streams are "
+                    "spread across in multi-session mode. "
+                    "Default is the number of the online CPUs" , 
+                    NULL, NULL);  
+
+    ret = parser->Parse(argc, argv, &err_info);//parse the cmd args
+    if(ret){
+        fprintf(stderr, "Option Parsing Error:%s\n", err_info.c_str());
+        exit(-1);
+    }
+
+    //check options correct
+    
+    if(parser->CheckOption("help")){
+        std::string option_help;
+        option_help = parser->GetOptionsHelp();
+        fprintf(stderr, 
+        "A RTSP live source which connect to a RTSP server and reads the media frames from it\n"
+        "Usange: %s [options]\n"
+        "\n"
+        "Option list:\n"
+        "%s"
+        "\n"
+        "User can send SIGINT/SIGTERM signal to terminate this source\n"
+        "\n", "stsw_rtsp_source", option_help.c_str());
+        exit(0);
+    }else if(parser->CheckOption("version")){
+        
+        fprintf(stderr, "0.1.0\n");
+        exit(0);
+    }
     
-    parser->RegisterOption("url", 'u', OPTION_FLAG_REQUIRED | OPTION_FLAG_WITH_ARG,
+    if(!parser->CheckOption("multi-session") && !parser->CheckOption("url")){
+        fprintf(stderr, "url must be set if not in multi-session mode\n");
+        exit(-1);
+    }
+  
+    if(parser->CheckOption("log-file")){
+        if(!parser->CheckOption("log-size")){
+            fprintf(stderr, "log-size must be set if log-file is enabled\n");
+            exit(-1);
+        }     
+    }
+   
+
+}
+
+
+void RtspSourceApp::RegisterRtspOptions(stream_switch::ArgParser *parser)
+{
+    parser->RegisterOption("url", 'u', OPTION_FLAG_WITH_ARG,
                    "RTSP_URL", 
                    "RTSP url this source connect to, must leading with \"rtsp://\"", NULL, NULL);  
 /*                   
@@ -362,43 +504,33 @@ void RtspSourceApp::ParseArgv(int argc, char *argv[],
                    "ignore the vps/sps/pps from SDP which is returned in the DESCRIBE response for H264/H265."
                    "Because the vps/sps/pps from SDP may be wrong for some immature RTSP server", NULL, NULL);  
 
-  
-    ret = parser->Parse(argc, argv, &err_info);//parse the cmd args
-    if(ret){
-        fprintf(stderr, "Option Parsing Error:%s\n", err_info.c_str());
-        exit(-1);
-    }
-
-    //check options correct
-    
-    if(parser->CheckOption("help")){
-        std::string option_help;
-        option_help = parser->GetOptionsHelp();
-        fprintf(stderr, 
-        "A RTSP live source which connect to a RTSP server and reads the media frames from it\n"
-        "Usange: %s [options]\n"
-        "\n"
-        "Option list:\n"
-        "%s"
-        "\n"
-        "User can send SIGINT/SIGTERM signal to terminate this source\n"
-        "\n", "stsw_rtsp_source", option_help.c_str());
-        exit(0);
-    }else if(parser->CheckOption("version")){
-        
-        fprintf(stderr, "0.1.0\n");
-        exit(0);
-    }
-    
-  
-    if(parser->CheckOption("log-file")){
-        if(!parser->CheckOption("log-size")){
-            fprintf(stderr, "log-size must be set if log-file is enabled\n");
-            exit(-1);
-        }     
-    }
-   
-
+    parser->RegisterOption("reorder-min", 0, 
+                    OPTION_FLAG_LONG | OPTION_FLAG_WITH_ARG,  "MSEC", 
+                    "the lower bound of the RTP packet reordering threshold in milli-seconds. "
+                    "Default is 5", NULL, NULL);  
+
+    parser->RegisterOption("reorder-max", 0, 
+                    OPTION_FLAG_LONG | OPTION_FLAG_WITH_ARG,  "MSEC", 
+                    "the upper bound of the RTP packet reordering threshold in milli-seconds, "
+                    "the threshold adapts to the measured reordering and jitter within the bounds. "
+                    "Default is 200. If it's equal to reorder-min, the threshold is fixed", NULL, NULL);  
+
+    parser->RegisterOption("reconnect-max", 0, 
+                    OPTION_FLAG_LONG | OPTION_FLAG_WITH_ARG,  "SEC", 
+                    "enable the in-process reconnect when the playing RTSP session drops, "
+                    "with an exponential backoff interval up to SEC seconds. "
+                    "The cached SDP is reused to skip DESCRIBE, and the ssrc is kept "
+                    "if the codec configuration is unchanged. "
+                    "Default is 0, means no reconnect, the source exits on error", NULL, NULL);  
+
+    parser->RegisterOption("drop-damaged", 0,  0, NULL, 
+                   "drop the frames which are known to lose some RTP packets, "
+                   "instead of publishing them partially", NULL, NULL);  
+
+    parser->RegisterOption("lite-engine", 0,  0, NULL, 
+                   "use the lightweight RTSP engine instead of live555, which "
+                   "only receives the H264/H265/AAC subsessions over TCP-interleaved RTP "
+                   "with less CPU. Ignored if udp is given", NULL, NULL);  
 }
 
 
@@ -428,8 +560,8 @@ void RtspSourceApp::LoggerCheckHandler(void* clientData)
 // LiveRtspClientListener implementation
 void RtspSourceApp::OnMediaFrame(
         const stream_switch::MediaFrameInfo &frame_info, 
-        const char * frame_data, 
-        size_t frame_size
+        const stream_switch::MediaFrameSegment * segments, 
+        int segment_num
 )
 {
     std::string err_info;
@@ -437,15 +569,15 @@ void RtspSourceApp::OnMediaFrame(
 #if 0    
     fprintf(stderr, "RtspSourceApp::OnMediaFrame() is called with the below frame:\n");
     fprintf(stderr, 
-                "index:%d, type:%d, time:%lld.%03d, ssrc:0x%x, size: %d\n", 
+                "index:%d, type:%d, time:%lld.%03d, ssrc:0x%x, segments: %d\n", 
                 (int)frame_info.sub_stream_index, 
                 frame_info.frame_type, 
                 (long long)frame_info.timestamp.tv_sec, 
                 (int)(frame_info.timestamp.tv_usec/1000), 
                 (unsigned)frame_info.ssrc, 
-                (int)(frame_size));
+                segment_num);
 #endif    
-    ret = source_->SendLiveMediaFrame(frame_info, frame_data, frame_size, &err_info);
+    ret = source_->SendLiveMediaFrameV(frame_info, segments, segment_num, &err_info);
     if(ret){
         STDERR_LOG(logger_, stream_switch::LOG_LEVEL_ERR, 
                 "Send live media frame Failed (%d):%s\n",
@@ -461,32 +593,23 @@ void RtspSourceApp::OnError(RtspClientErrCode err_code, const char * err_info)
     STDERR_LOG(logger_, stream_switch::LOG_LEVEL_ERR, 
             "RtspSourceApp::OnError() is called with RtspClientErrCode err_code(%d):%s\n",
             err_code, (err_info!=NULL)? err_info:"");
-    int state;
     //change source stream state
-    switch(err_code){
- 
-    case RTSP_CLIENT_ERR_CONNECT_FAIL: 
-    case RTSP_CLIENT_ERR_DESCRIBE_ERR:  
-        state = stream_switch::SOURCE_STREAM_STATE_ERR_CONNECT_FAIL;
-        break;
-
-    case RTSP_CLIENT_ERR_SUBSESSION_BYE:  
-    case RTSP_CLIENT_ERR_INTER_FRAME_GAP: 
-        state = stream_switch::SOURCE_STREAM_STATE_ERR_MEIDA_STOP;
-        break;
-
-    case RTSP_CLIENT_ERR_TIME_ERR:  
-        state = stream_switch::SOURCE_STREAM_STATE_ERR_TIME;
-        break;
-    default:
-        state = stream_switch::SOURCE_STREAM_STATE_ERR;
-        break;
-    }
-    source_->set_stream_state(state);
+    source_->set_stream_state(RtspErrToStreamState(err_code));
     exit_code_ = stream_switch::ERROR_CODE_GENERAL;
     SetWatch();
 }
 
+void RtspSourceApp::OnReconnecting(RtspClientErrCode err_code, const char * err_info, 
+                                   unsigned retry_interval)
+{
+    STDERR_LOG(logger_, stream_switch::LOG_LEVEL_WARNING, 
+            "RTSP session dropped with err_code(%d):%s, reconnect in %u ms\n",
+            err_code, (err_info!=NULL)? err_info:"", retry_interval / 1000);
+    
+    //change source stream state until the session is played again
+    source_->set_stream_state(RtspErrToStreamState(err_code));
+}
+
 void RtspSourceApp::OnMetaReady(const stream_switch::StreamMetadata &metadata)
 {
     int ret;
@@ -516,7 +639,12 @@ void RtspSourceApp::OnMetaReady(const stream_switch::StreamMetadata &metadata)
     }
     fprintf(stderr, "\n");
     
+    pthread_mutex_lock(&statistic_lock_);
     memset(lost_frames_, 0, sizeof(uint64_t) * MAX_SUBSTREAM_NUMBER);
+    for(int i = 0; i < MAX_SUBSTREAM_NUMBER; i++){
+        rtp_statistics_[i] = RtpRecvStatistic();
+    }
+    pthread_mutex_unlock(&statistic_lock_);
     
     //start the source
     source_->set_stream_meta(metadata);
@@ -547,10 +675,22 @@ void RtspSourceApp::OnLostFrameUpdate(int32_t sub_stream_index,
                                        uint64_t lost_frame )
 {
     if(sub_stream_index < MAX_SUBSTREAM_NUMBER){
+        pthread_mutex_lock(&statistic_lock_);
         lost_frames_[sub_stream_index] = lost_frame;
+        pthread_mutex_unlock(&statistic_lock_);
     }
 } 
 
+void RtspSourceApp::OnRtpStatisticUpdate(const RtpRecvStatistic &statistic)
+{
+    if(statistic.sub_stream_index >= 0 && 
+       statistic.sub_stream_index < MAX_SUBSTREAM_NUMBER){
+        pthread_mutex_lock(&statistic_lock_);
+        rtp_statistics_[statistic.sub_stream_index] = statistic;
+        pthread_mutex_unlock(&statistic_lock_);
+    }
+}
+
 ///////////////////////////////////////////////////////////
 // SourceListener implementation    
 
@@ -563,14 +703,291 @@ void RtspSourceApp::OnKeyFrame(void)
 void RtspSourceApp::OnMediaStatistic(stream_switch::MediaStatisticInfo *statistic)
 {
     stream_switch::SubStreamMediaStatisticVector::iterator it;
+    pthread_mutex_lock(&statistic_lock_);
     for(it = statistic->sub_streams.begin(); 
         it != statistic->sub_streams.end();
         it++){
         if(it->sub_stream_index < MAX_SUBSTREAM_NUMBER){
             it->lost_frames = lost_frames_[it->sub_stream_index];            
+            if(rtp_statistics_[it->sub_stream_index].sub_stream_index >= 0){
+                FillRtpStatistic(rtp_statistics_[it->sub_stream_index], &(*it));
+            }
         }else{
             break;
         }
     }
+    pthread_mutex_unlock(&statistic_lock_);
+
+}
+
+
+///////////////////////////////////////////////////////////
+// multi-session mode
+
+int RtspSourceApp::InitSessionThreads(stream_switch::ArgParser *parser)
+{
+    int ret;
+    std::string err_info;
+    int thread_num = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    
+    if(parser->CheckOption("session-threads")){
+        thread_num = (int)strtol(
+            parser->OptionValue("session-threads", "1").c_str(), NULL, 0);
+    }
+    if(thread_num <= 0){
+        thread_num = 1;
+    }else if(thread_num > MAX_SESSION_THREADS){
+        thread_num = MAX_SESSION_THREADS;
+    }
+    
+    for(int i = 0; i < thread_num; i++){
+        RtspSchedulerThread * thread = 
+            new RtspSchedulerThread(i, logger_, use_epoll_);
+        ret = thread->Start(&err_info);
+        if(ret){
+            STDERR_LOG(logger_, stream_switch::LOG_LEVEL_ERR, 
+                       "Start session thread %d Failed: %s\n", 
+                       i, err_info.c_str());
+            delete thread;
+            UninitSessionThreads();
+            return ret;
+        }
+        session_threads_.push_back(thread);
+    }
+    
+    source_->RegisterApiHandler(RTSP_SOURCE_API_CODE_ADD_STREAM, 
+        (stream_switch::SourceApiHandler)StaticAddStreamHandler, this);
+    source_->RegisterApiHandler(RTSP_SOURCE_API_CODE_REMOVE_STREAM, 
+        (stream_switch::SourceApiHandler)StaticRemoveStreamHandler, this);
+    source_->RegisterApiHandler(RTSP_SOURCE_API_CODE_LIST_STREAM, 
+        (stream_switch::SourceApiHandler)StaticListStreamHandler, this);
+    
+    return 0;
+}
+
+void RtspSourceApp::UninitSessionThreads()
+{
+    std::vector<RtspSchedulerThread *>::iterator it;
+    for(it = session_threads_.begin(); it != session_threads_.end(); it++){
+        (*it)->Stop();
+        delete (*it);
+    }
+    session_threads_.clear();
+    
+    pthread_mutex_lock(&streams_lock_);
+    stream_threads_.clear();
+    pthread_mutex_unlock(&streams_lock_);
+}
 
+int RtspSourceApp::AddStream(const std::string &options, std::string *err_info)
+{
+    int ret;
+    stream_switch::ArgParser parser;
+    RtspSessionParam param;
+    std::vector<std::string> args;
+    std::vector<char *> argv;
+    
+    // split the options string into argv, the options are the same as 
+    // the ones of the single-session mode
+    std::istringstream iss(options);
+    std::string arg;
+    args.push_back("stsw_rtsp_source");
+    while(iss >> arg){
+        args.push_back(arg);
+    }
+    for(size_t i = 0; i < args.size(); i++){
+        argv.push_back((char *)args[i].c_str());
+    }
+    argv.push_back(NULL);
+    
+    // Parse() is only called by the API thread of the control source 
+    // at runtime, so it's safe even though getopt is not thread-safe
+    parser.RegisterSourceOptions();
+    RegisterRtspOptions(&parser);
+    ret = parser.Parse((int)args.size(), &(argv[0]), err_info);
+    if(ret){
+        return stream_switch::ERROR_CODE_OPTIONS;
+    }
+    
+    param.stream_name = parser.OptionValue("stream-name", "");
+    param.port = (int)strtol(parser.OptionValue("port", "0").c_str(), NULL, 0);
+    param.url = parser.OptionValue("url", "");
+    if(parser.CheckOption("queue-size")){
+        param.queue_size = 
+            (int)strtol(parser.OptionValue("queue-size", "60").c_str(), NULL, 0);
+    }
+    param.debug_flags = 
+        (int)strtol(parser.OptionValue("debug-flags", "0").c_str(), NULL, 0);
+    param.stream_using_tcp = !parser.CheckOption("udp");
+    param.enable_keep_alive = !parser.CheckOption("no-keep-alive");
+    if(parser.CheckOption("single-medium")){
+        param.single_medium = parser.OptionValue("single-medium", "video");
+    }
+    param.user = parser.OptionValue("user", "");
+    param.passwd = parser.OptionValue("password", "");
+    param.verbosity_level = parser.CheckOption("rtsp-verbose") ? 1 : 0;
+    param.using_local_ts = parser.CheckOption("use-local-ts");
+    param.ignore_sdp_sps = parser.CheckOption("ignore-sdp-sps");
+    if(parser.CheckOption("reorder-min")){
+        param.reorder_min_time = (unsigned)strtoul(
+            parser.OptionValue("reorder-min", "5").c_str(), NULL, 0) * 1000;
+    }
+    if(parser.CheckOption("reorder-max")){
+        param.reorder_max_time = (unsigned)strtoul(
+            parser.OptionValue("reorder-max", "200").c_str(), NULL, 0) * 1000;
+    }
+    param.reconnect_max_interval = (unsigned)strtoul(
+        parser.OptionValue("reconnect-max", "0").c_str(), NULL, 0);
+    param.drop_damaged_frames = parser.CheckOption("drop-damaged");
+    param.lite_engine = parser.CheckOption("lite-engine");
+    if(param.reorder_max_time < param.reorder_min_time){
+        if(err_info){
+            *err_info = "reorder-max is less than reorder-min";
+        }
+        return stream_switch::ERROR_CODE_PARAM;
+    }
+    
+    pthread_mutex_lock(&streams_lock_);
+    
+    if(stream_threads_.find(param.stream_name) != stream_threads_.end()){
+        pthread_mutex_unlock(&streams_lock_);
+        if(err_info){
+            *err_info = "stream already exists";
+        }
+        return stream_switch::ERROR_CODE_PARAM;
+    }
+    
+    RtspSourceSession * session = new RtspSourceSession(param, logger_);
+    ret = session->Init(err_info);
+    if(ret){
+        pthread_mutex_unlock(&streams_lock_);
+        delete session;
+        return ret;
+    }
+    
+    // attach to the least loaded thread
+    RtspSchedulerThread * thread = NULL;
+    int min_num = 0;
+    std::vector<RtspSchedulerThread *>::iterator it;
+    for(it = session_threads_.begin(); it != session_threads_.end(); it++){
+        int num = (*it)->session_num();
+        if(thread == NULL || num < min_num){
+            thread = *it;
+            min_num = num;
+        }
+    }
+    stream_threads_[param.stream_name] = thread;
+    thread->AddSession(session);
+    
+    pthread_mutex_unlock(&streams_lock_);
+    
+    STDERR_LOG(logger_, stream_switch::LOG_LEVEL_INFO, 
+               "Stream %s (%s) is added\n", 
+               param.stream_name.c_str(), param.url.c_str());
+    
+    return 0;
+}
+
+int RtspSourceApp::RemoveStream(const std::string &stream_name, std::string *err_info)
+{
+    pthread_mutex_lock(&streams_lock_);
+    
+    SessionThreadMap::iterator it = stream_threads_.find(stream_name);
+    if(it == stream_threads_.end()){
+        pthread_mutex_unlock(&streams_lock_);
+        if(err_info){
+            *err_info = "stream not found";
+        }
+        return stream_switch::ERROR_CODE_PARAM;
+    }
+    it->second->RemoveSession(stream_name);
+    stream_threads_.erase(it);
+    
+    pthread_mutex_unlock(&streams_lock_);
+    
+    STDERR_LOG(logger_, stream_switch::LOG_LEVEL_INFO, 
+               "Stream %s is removed\n", stream_name.c_str());
+    
+    return 0;
+}
+
+std::string RtspSourceApp::ListStream()
+{
+    std::string list;
+    
+    pthread_mutex_lock(&streams_lock_);
+    SessionThreadMap::iterator it;
+    for(it = stream_threads_.begin(); it != stream_threads_.end(); it++){
+        list += it->first;
+        list += "\n";
+    }
+    pthread_mutex_unlock(&streams_lock_);
+    
+    return list;
+}
+
+void RtspSourceApp::SendApiReply(const stream_switch::ProtoCommonPacket &request, 
+                                 int status, const std::string &info, 
+                                 const std::string &body)
+{
+    stream_switch::ProtoCommonPacket reply;
+    reply.mutable_header()->set_type(stream_switch::PROTO_PACKET_TYPE_REPLY);
+    reply.mutable_header()->set_status(status);
+    reply.mutable_header()->set_info(info); 
+    reply.mutable_header()->set_code(request.header().code());   
+    reply.mutable_header()->set_seq(request.header().seq());  
+    reply.set_body(body);
+    
+    source_->SendRpcReply(reply, NULL, 0, NULL);
+}
+
+int RtspSourceApp::StaticAddStreamHandler(void * user_data, 
+                                          const stream_switch::ProtoCommonPacket &request,
+                                          const char * extra_blob, size_t blob_size)
+{
+    RtspSourceApp * app = (RtspSourceApp *)user_data;
+    std::string err_info;
+    int ret;
+    
+    ret = app->AddStream(request.body(), &err_info);
+    if(ret == stream_switch::ERROR_CODE_PARAM || 
+       ret == stream_switch::ERROR_CODE_OPTIONS){
+        app->SendApiReply(request, stream_switch::PROTO_PACKET_STATUS_BAD_REQUEST, 
+                          err_info, "");
+    }else if(ret){
+        app->SendApiReply(request, stream_switch::PROTO_PACKET_STATUS_INTERNAL_ERR, 
+                          err_info, "");
+    }else{
+        app->SendApiReply(request, stream_switch::PROTO_PACKET_STATUS_OK, "", "");
+    }
+    return 0;
+}
+
+int RtspSourceApp::StaticRemoveStreamHandler(void * user_data, 
+                                             const stream_switch::ProtoCommonPacket &request,
+                                             const char * extra_blob, size_t blob_size)
+{
+    RtspSourceApp * app = (RtspSourceApp *)user_data;
+    std::string err_info;
+    int ret;
+    
+    ret = app->RemoveStream(request.body(), &err_info);
+    if(ret){
+        app->SendApiReply(request, stream_switch::PROTO_PACKET_STATUS_NOT_FOUND, 
+                          err_info, "");
+    }else{
+        app->SendApiReply(request, stream_switch::PROTO_PACKET_STATUS_OK, "", "");
+    }
+    return 0;
+}
+
+int RtspSourceApp::StaticListStreamHandler(void * user_data, 
+                                           const stream_switch::ProtoCommonPacket &request,
+                                           const char * extra_blob, size_t blob_size)
+{
+    RtspSourceApp * app = (RtspSourceApp *)user_data;
+    
+    app->SendApiReply(request, stream_switch::PROTO_PACKET_STATUS_OK, "", 
+                      app->ListStream());
+    return 0;
 }
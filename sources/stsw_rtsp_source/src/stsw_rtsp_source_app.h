@@ -34,11 +34,18 @@
 #define STSW_RTSP_SOURCE_APP_H
 
 
+#include <vector>
+#include <map>
+
 #include "stream_switch.h"
 #include "stsw_rtsp_client.h"
+#include "stsw_rtsp_source_session.h"
 
 
-#define MAX_SUBSTREAM_NUMBER 64
+// user extension API codes of the control source in multi-session mode
+#define RTSP_SOURCE_API_CODE_ADD_STREAM     256  // body is the options string
+#define RTSP_SOURCE_API_CODE_REMOVE_STREAM  257  // body is the stream name
+#define RTSP_SOURCE_API_CODE_LIST_STREAM    258  // reply body lists all streams
 ////////////////////
 
 // the RTSP Source Application class
@@ -85,6 +92,8 @@ public:
     void ParseArgv(int argc, char *argv[], 
                    stream_switch::ArgParser *parser);
                    
+    static void RegisterRtspOptions(stream_switch::ArgParser *parser);
+                   
              
    
     ///////////////////////////////////////////////////////////
@@ -95,12 +104,15 @@ public:
     virtual void OnRtspOK();  
     virtual void OnMediaFrame(
         const stream_switch::MediaFrameInfo &frame_info, 
-        const char * frame_data, 
-        size_t frame_size
+        const stream_switch::MediaFrameSegment * segments, 
+        int segment_num
     );    
     
     virtual void OnLostFrameUpdate(int32_t sub_stream_index, 
                                    uint64_t lost_frame );
+    virtual void OnRtpStatisticUpdate(const RtpRecvStatistic &statistic);
+    virtual void OnReconnecting(RtspClientErrCode err_code, const char * err_info, 
+                                unsigned retry_interval);
     
     
     ///////////////////////////////////////////////////////////
@@ -120,6 +132,20 @@ public:
     //////////////////////////////////////////////////////////
     //Timer task handler
     static void LoggerCheckHandler(void* clientData);
+    
+    
+    //////////////////////////////////////////////////////////
+    //API handler of the control source in multi-session mode
+    static int StaticAddStreamHandler(void * user_data, 
+                                      const stream_switch::ProtoCommonPacket &request,
+                                      const char * extra_blob, size_t blob_size);
+    static int StaticRemoveStreamHandler(void * user_data, 
+                                         const stream_switch::ProtoCommonPacket &request,
+                                         const char * extra_blob, size_t blob_size);
+    static int StaticListStreamHandler(void * user_data, 
+                                       const stream_switch::ProtoCommonPacket &request,
+                                       const char * extra_blob, size_t blob_size);
+    
 
 
 
@@ -127,9 +153,20 @@ private:
     RtspSourceApp();
     virtual ~RtspSourceApp();   
     
+    int InitSessionThreads(stream_switch::ArgParser *parser);
+    void UninitSessionThreads();
+    
+    int AddStream(const std::string &options, std::string *err_info);
+    int RemoveStream(const std::string &stream_name, std::string *err_info);
+    std::string ListStream();
+    
+    void SendApiReply(const stream_switch::ProtoCommonPacket &request, 
+                      int status, const std::string &info, 
+                      const std::string &body);
+    
     static RtspSourceApp * s_instance;
 
-    LiveRtspClient * rtsp_client_;
+    RtspClientEngine * rtsp_client_;
     TaskScheduler * scheduler_;
     UsageEnvironment* env_;
     stream_switch::RotateLogger * logger_;
@@ -140,9 +177,20 @@ private:
     bool is_init_;
     int exit_code_;
     TaskToken logger_check_task_;
+    bool use_epoll_;
     
     
+    // updated in the RTSP client thread, read in the API thread of source_
+    pthread_mutex_t statistic_lock_;
     uint64_t lost_frames_[MAX_SUBSTREAM_NUMBER];
+    RtpRecvStatistic rtp_statistics_[MAX_SUBSTREAM_NUMBER];
+    
+    // multi-session mode
+    typedef std::map<std::string, RtspSchedulerThread *> SessionThreadMap;
+    bool multi_session_;
+    std::vector<RtspSchedulerThread *> session_threads_;
+    SessionThreadMap stream_threads_;   // stream name -> its thread
+    pthread_mutex_t streams_lock_;
     
 };
 
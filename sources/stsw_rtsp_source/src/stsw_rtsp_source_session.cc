@@ -0,0 +1,610 @@
+/**
+ * This file is part of stsw_rtsp_source, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_rtsp_source_session.cc
+ *      RtspSourceSession and RtspSchedulerThread class implementation file
+ *
+ * author: OpenSight Team
+ * date: 2016-3-10
+**/
+
+#include "stsw_rtsp_source_session.h"
+
+#include <string.h>
+#include <errno.h>
+
+#include "BasicUsageEnvironment.hh"
+#include "stsw_epoll_task_scheduler.h"
+#include "stsw_lite_rtsp_client.h"
+#include "stsw_log.h"
+
+
+TaskScheduler * CreateTaskScheduler(bool use_epoll)
+{
+    if(use_epoll){
+        TaskScheduler * scheduler = EpollTaskScheduler::createNew();
+        if(scheduler != NULL){
+            return scheduler;
+        }
+        fprintf(stderr, "EpollTaskScheduler is not available, "
+                "fall back to BasicTaskScheduler\n");
+    }
+    return BasicTaskScheduler::createNew();
+}
+
+
+///////////////////////////////////////////////////////////
+// RtspSourceSession
+
+RtspSourceSession::RtspSourceSession(const RtspSessionParam &param,
+                                     stream_switch::RotateLogger * logger)
+: param_(param), logger_(logger), source_(NULL), rtsp_client_(NULL),
+env_(NULL), reconnect_task_(NULL),
+reconnect_interval_(RTSP_SESSION_RECONNECT_MIN_INTERVAL)
+{
+    pthread_mutex_init(&statistic_lock_, NULL);
+    memset(lost_frames_, 0, sizeof(uint64_t) * MAX_SUBSTREAM_NUMBER);
+}
+
+RtspSourceSession::~RtspSourceSession()
+{
+    Uninit();
+    pthread_mutex_destroy(&statistic_lock_);
+}
+
+int RtspSourceSession::Init(std::string *err_info)
+{
+    int ret;
+    if(param_.url.size() == 0){
+        if(err_info){
+            *err_info = "url cannot be empty";
+        }
+        return stream_switch::ERROR_CODE_PARAM;
+    }
+
+    source_ = new stream_switch::StreamSource();
+    ret = source_->Init(param_.stream_name, param_.port,
+                        param_.queue_size, this,
+                        param_.debug_flags, err_info);
+    if(ret){
+        delete source_;
+        source_ = NULL;
+        return ret;
+    }
+    return 0;
+}
+
+void RtspSourceSession::Uninit()
+{
+    if(source_){
+        source_->Uninit();
+        delete source_;
+        source_ = NULL;
+    }
+}
+
+void RtspSourceSession::Start(UsageEnvironment* env)
+{
+    env_ = env;
+    if(CreateClient()){
+        ScheduleReconnect();
+        return;
+    }
+    rtsp_client_->Start();
+}
+
+void RtspSourceSession::Stop()
+{
+    if(env_ == NULL){
+        return;
+    }
+    if(reconnect_task_ != NULL){
+        env_->taskScheduler().unscheduleDelayedTask(reconnect_task_);
+        reconnect_task_ = NULL;
+    }
+    CloseClient();
+
+    if(source_){
+        source_->Stop();
+    }
+    env_ = NULL;
+}
+
+int RtspSourceSession::CreateClient()
+{
+    if(param_.lite_engine && param_.stream_using_tcp){
+        rtsp_client_ = LiteRtspClient::CreateNew(
+            *env_, param_.url.c_str(),
+            param_.enable_keep_alive ? True : False,
+            param_.single_medium.size() ? param_.single_medium.c_str() : NULL,
+            param_.user.size() ? param_.user.c_str() : NULL,
+            param_.passwd.size() ? param_.passwd.c_str() : NULL,
+            (LiveRtspClientListener *)this,
+            param_.verbosity_level,
+            param_.ignore_sdp_sps ? True : False);
+    }else{
+        rtsp_client_ = LiveRtspClient::CreateNew(
+            *env_, param_.url.c_str(),
+            param_.stream_using_tcp ? True : False,
+            param_.enable_keep_alive ? True : False,
+            param_.single_medium.size() ? param_.single_medium.c_str() : NULL,
+            param_.user.size() ? param_.user.c_str() : NULL,
+            param_.passwd.size() ? param_.passwd.c_str() : NULL,
+            param_.using_local_ts ? True : False,
+            (LiveRtspClientListener *)this,
+            param_.verbosity_level,
+            param_.ignore_sdp_sps ? True : False,
+            param_.reorder_min_time,
+            param_.reorder_max_time);
+    }
+    if(rtsp_client_ == NULL){
+        STDERR_LOG(logger_, stream_switch::LOG_LEVEL_ERR,
+                   "Session %s: Create RTSP client Failed: "
+                   "Maybe parameter error\n",
+                   param_.stream_name.c_str());
+        return -1;
+    }
+    if(param_.reconnect_max_interval != 0){
+        rtsp_client_->SetReconnectInterval(RTSP_CLIENT_RECONNECT_MIN_INTERVAL,
+            param_.reconnect_max_interval * 1000000);
+    }
+    if(param_.drop_damaged_frames){
+        rtsp_client_->SetDropDamagedFrames(True);
+    }
+    return 0;
+}
+
+void RtspSourceSession::CloseClient()
+{
+    if(rtsp_client_ != NULL){
+        rtsp_client_->SetListener(NULL);
+        rtsp_client_->Shutdown();
+        rtsp_client_->Close();
+        rtsp_client_ = NULL;
+    }
+}
+
+void RtspSourceSession::ScheduleReconnect()
+{
+    if(reconnect_task_ != NULL){
+        //already scheduled
+        return;
+    }
+
+    // The client cannot be shut down in its own callback, so just detach
+    // from it here, and close it in the reconnect task
+    if(rtsp_client_ != NULL){
+        rtsp_client_->SetListener(NULL);
+    }
+
+    STDERR_LOG(logger_, stream_switch::LOG_LEVEL_INFO,
+               "Session %s: reconnect in %d sec\n",
+               param_.stream_name.c_str(), reconnect_interval_);
+
+    reconnect_task_ =
+        env_->taskScheduler().scheduleDelayedTask(
+            reconnect_interval_ * 1000000,
+            (TaskFunc*)ReconnectHandler, this);
+
+    reconnect_interval_ *= 2;
+    if(reconnect_interval_ > RTSP_SESSION_RECONNECT_MAX_INTERVAL){
+        reconnect_interval_ = RTSP_SESSION_RECONNECT_MAX_INTERVAL;
+    }
+}
+
+void RtspSourceSession::ReconnectHandler(void* clientData)
+{
+    RtspSourceSession * session = (RtspSourceSession *)clientData;
+    session->reconnect_task_ = NULL;
+
+    session->CloseClient();
+    if(session->CreateClient()){
+        session->ScheduleReconnect();
+        return;
+    }
+    session->rtsp_client_->Start();
+}
+
+
+///////////////////////////////////////////////////////////
+// LiveRtspClientListener implementation
+void RtspSourceSession::OnMediaFrame(
+        const stream_switch::MediaFrameInfo &frame_info,
+        const stream_switch::MediaFrameSegment * segments,
+        int segment_num
+)
+{
+    std::string err_info;
+    int ret;
+
+    ret = source_->SendLiveMediaFrameV(frame_info, segments, segment_num, &err_info);
+    if(ret){
+        STDERR_LOG(logger_, stream_switch::LOG_LEVEL_ERR,
+                "Session %s: Send live media frame Failed (%d):%s\n",
+                param_.stream_name.c_str(), ret,  err_info.c_str());
+        source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_ERR);
+        ScheduleReconnect();
+    }
+}
+
+void RtspSourceSession::OnError(RtspClientErrCode err_code, const char * err_info)
+{
+    STDERR_LOG(logger_, stream_switch::LOG_LEVEL_ERR,
+            "Session %s: RTSP client error(%d):%s\n",
+            param_.stream_name.c_str(),
+            err_code, (err_info!=NULL)? err_info:"");
+    //change source stream state
+    source_->set_stream_state(RtspErrToStreamState(err_code));
+    ScheduleReconnect();
+}
+
+void RtspSourceSession::OnReconnecting(RtspClientErrCode err_code, const char * err_info,
+                                       unsigned retry_interval)
+{
+    STDERR_LOG(logger_, stream_switch::LOG_LEVEL_WARNING,
+            "Session %s: RTSP session dropped(%d):%s, reconnect in %u ms\n",
+            param_.stream_name.c_str(),
+            err_code, (err_info!=NULL)? err_info:"", retry_interval / 1000);
+
+    //the client reconnects by itself, just change source stream state
+    source_->set_stream_state(RtspErrToStreamState(err_code));
+}
+
+void RtspSourceSession::OnMetaReady(const stream_switch::StreamMetadata &metadata)
+{
+    int ret;
+    std::string err_info;
+
+    STDERR_LOG(logger_, stream_switch::LOG_LEVEL_INFO,
+               "Session %s: metadata ready, substream number: %d\n",
+               param_.stream_name.c_str(),
+               (int)(metadata.sub_streams.size()));
+
+    pthread_mutex_lock(&statistic_lock_);
+    memset(lost_frames_, 0, sizeof(uint64_t) * MAX_SUBSTREAM_NUMBER);
+    for(int i = 0; i < MAX_SUBSTREAM_NUMBER; i++){
+        rtp_statistics_[i] = RtpRecvStatistic();
+    }
+    pthread_mutex_unlock(&statistic_lock_);
+
+    //start the source, which is no-op if already started by the
+    //previous connection
+    source_->set_stream_meta(metadata);
+    ret = source_->Start(&err_info);
+    if(ret){
+        STDERR_LOG(logger_, stream_switch::LOG_LEVEL_ERR,
+                "Session %s: Failed to start the stream_switch source (%d):%s\n",
+                param_.stream_name.c_str(), ret,  err_info.c_str());
+        source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_ERR);
+        ScheduleReconnect();
+    }
+}
+
+void RtspSourceSession::OnRtspOK()
+{
+    STDERR_LOG(logger_, stream_switch::LOG_LEVEL_INFO,
+               "Session %s: RTSP Negotiation is successful\n",
+               param_.stream_name.c_str());
+
+    reconnect_interval_ = RTSP_SESSION_RECONNECT_MIN_INTERVAL;
+
+    //change source state
+    source_->set_stream_state(stream_switch::SOURCE_STREAM_STATE_OK);
+}
+
+void RtspSourceSession::OnLostFrameUpdate(int32_t sub_stream_index,
+                                          uint64_t lost_frame )
+{
+    if(sub_stream_index < MAX_SUBSTREAM_NUMBER){
+        pthread_mutex_lock(&statistic_lock_);
+        lost_frames_[sub_stream_index] = lost_frame;
+        pthread_mutex_unlock(&statistic_lock_);
+    }
+}
+
+void RtspSourceSession::OnRtpStatisticUpdate(const RtpRecvStatistic &statistic)
+{
+    if(statistic.sub_stream_index >= 0 &&
+       statistic.sub_stream_index < MAX_SUBSTREAM_NUMBER){
+        pthread_mutex_lock(&statistic_lock_);
+        rtp_statistics_[statistic.sub_stream_index] = statistic;
+        pthread_mutex_unlock(&statistic_lock_);
+    }
+}
+
+///////////////////////////////////////////////////////////
+// SourceListener implementation
+
+void RtspSourceSession::OnKeyFrame(void)
+{
+    //No method to request a key frame for RTSP protcol
+}
+
+void RtspSourceSession::OnMediaStatistic(stream_switch::MediaStatisticInfo *statistic)
+{
+    stream_switch::SubStreamMediaStatisticVector::iterator it;
+    pthread_mutex_lock(&statistic_lock_);
+    for(it = statistic->sub_streams.begin();
+        it != statistic->sub_streams.end();
+        it++){
+        if(it->sub_stream_index < MAX_SUBSTREAM_NUMBER){
+            it->lost_frames = lost_frames_[it->sub_stream_index];
+            if(rtp_statistics_[it->sub_stream_index].sub_stream_index >= 0){
+                FillRtpStatistic(rtp_statistics_[it->sub_stream_index], &(*it));
+            }
+        }else{
+            break;
+        }
+    }
+    pthread_mutex_unlock(&statistic_lock_);
+}
+
+
+///////////////////////////////////////////////////////////
+// RtspSchedulerThread
+
+RtspSchedulerThread::RtspSchedulerThread(int thread_index,
+                                         stream_switch::RotateLogger * logger,
+                                         bool use_epoll)
+: thread_index_(thread_index), logger_(logger), use_epoll_(use_epoll), scheduler_(NULL), env_(NULL),
+command_trigger_(0), watch_variable_(0), thread_id_(0), is_started_(false),
+session_num_(0), post_seq_(0), done_seq_(0)
+{
+    pthread_mutex_init(&lock_, NULL);
+    pthread_cond_init(&command_done_, NULL);
+}
+
+RtspSchedulerThread::~RtspSchedulerThread()
+{
+    Stop();
+    pthread_cond_destroy(&command_done_);
+    pthread_mutex_destroy(&lock_);
+}
+
+int RtspSchedulerThread::Start(std::string *err_info)
+{
+    int ret;
+    if(is_started_){
+        return 0;
+    }
+
+    scheduler_ = CreateTaskScheduler(use_epoll_);
+    env_ = BasicUsageEnvironment::createNew(*scheduler_);
+    command_trigger_ = scheduler_->createEventTrigger(
+        (TaskFunc*)CommandHandler);
+    watch_variable_ = 0;
+
+    ret = pthread_create(&thread_id_, NULL,
+                         RtspSchedulerThread::StaticThreadRoutine, this);
+    if(ret){
+        if(err_info){
+            *err_info = "pthread_create failed:";
+            *err_info += strerror(ret);
+        }
+        scheduler_->deleteEventTrigger(command_trigger_);
+        env_->reclaim();
+        env_ = NULL;
+        delete scheduler_;
+        scheduler_ = NULL;
+        thread_id_ = 0;
+        return stream_switch::ERROR_CODE_SYSTEM;
+    }
+    is_started_ = true;
+    return 0;
+}
+
+void RtspSchedulerThread::Stop()
+{
+    if(!is_started_){
+        return;
+    }
+
+    Command cmd;
+    cmd.type = COMMAND_STOP;
+    cmd.session = NULL;
+    PostCommand(cmd);
+
+    pthread_join(thread_id_, NULL);
+    thread_id_ = 0;
+    is_started_ = false;
+
+    // the commands posted after the loop exits
+    CommandList::iterator it;
+    pthread_mutex_lock(&lock_);
+    for(it = commands_.begin(); it != commands_.end(); it++){
+        if(it->type == COMMAND_ADD && it->session != NULL){
+            delete it->session;
+        }
+    }
+    commands_.clear();
+    session_num_ = 0;
+    done_seq_ = post_seq_;
+    pthread_cond_broadcast(&command_done_);
+    pthread_mutex_unlock(&lock_);
+
+    scheduler_->deleteEventTrigger(command_trigger_);
+    env_->reclaim();
+    env_ = NULL;
+    delete scheduler_;
+    scheduler_ = NULL;
+}
+
+void RtspSchedulerThread::AddSession(RtspSourceSession * session)
+{
+    Command cmd;
+    cmd.type = COMMAND_ADD;
+    cmd.session = session;
+    cmd.stream_name = session->param().stream_name;
+    PostCommand(cmd);
+}
+
+void RtspSchedulerThread::RemoveSession(const std::string &stream_name)
+{
+    Command cmd;
+    uint64_t seq;
+    cmd.type = COMMAND_REMOVE;
+    cmd.session = NULL;
+    cmd.stream_name = stream_name;
+    seq = PostCommand(cmd);
+
+    // the source of the session is uninitialized when it's deleted, after
+    // that the stream name can be initialized again by a new session
+    WaitCommand(seq);
+}
+
+int RtspSchedulerThread::session_num()
+{
+    int num;
+    pthread_mutex_lock(&lock_);
+    num = session_num_;
+    pthread_mutex_unlock(&lock_);
+    return num;
+}
+
+uint64_t RtspSchedulerThread::PostCommand(Command &cmd)
+{
+    uint64_t seq;
+    pthread_mutex_lock(&lock_);
+    seq = cmd.seq = ++post_seq_;
+    commands_.push_back(cmd);
+    if(cmd.type == COMMAND_ADD){
+        session_num_++;
+    }else if(cmd.type == COMMAND_REMOVE){
+        session_num_--;
+    }
+    pthread_mutex_unlock(&lock_);
+
+    scheduler_->triggerEvent(command_trigger_, this);
+    return seq;
+}
+
+void RtspSchedulerThread::WaitCommand(uint64_t seq)
+{
+    if(pthread_equal(pthread_self(), thread_id_)){
+        // called in the scheduler thread, cannot wait for itself
+        return;
+    }
+    pthread_mutex_lock(&lock_);
+    while(done_seq_ < seq){
+        pthread_cond_wait(&command_done_, &lock_);
+    }
+    pthread_mutex_unlock(&lock_);
+}
+
+void RtspSchedulerThread::CommandHandler(void* clientData)
+{
+    RtspSchedulerThread * thread = (RtspSchedulerThread *)clientData;
+    thread->HandleCommands();
+}
+
+void RtspSchedulerThread::HandleCommands()
+{
+    CommandList commands;
+
+    pthread_mutex_lock(&lock_);
+    commands.swap(commands_);
+    pthread_mutex_unlock(&lock_);
+
+    // the commands are handled in the posted order, so the remove and the
+    // add of the same stream name take effect in the same order
+    CommandList::iterator it;
+    for(it = commands.begin(); it != commands.end(); it++){
+        switch(it->type){
+        case COMMAND_ADD:
+            {
+                SessionMap::iterator session_it =
+                    sessions_.find(it->stream_name);
+                if(session_it != sessions_.end()){
+                    // the stream name is still used by a running session,
+                    // reject the new one rather than leak the old one
+                    STDERR_LOG(logger_, stream_switch::LOG_LEVEL_ERR,
+                               "Session %s already exists in thread %d, "
+                               "the new session is dropped\n",
+                               it->stream_name.c_str(), thread_index_);
+                    delete it->session;
+                    pthread_mutex_lock(&lock_);
+                    session_num_--;
+                    pthread_mutex_unlock(&lock_);
+                    break;
+                }
+                sessions_[it->stream_name] = it->session;
+                it->session->Start(env_);
+                STDERR_LOG(logger_, stream_switch::LOG_LEVEL_INFO,
+                           "Session %s is started in thread %d\n",
+                           it->stream_name.c_str(), thread_index_);
+            }
+            break;
+        case COMMAND_REMOVE:
+            {
+                SessionMap::iterator session_it =
+                    sessions_.find(it->stream_name);
+                if(session_it != sessions_.end()){
+                    session_it->second->Stop();
+                    delete session_it->second;
+                    sessions_.erase(session_it);
+                    STDERR_LOG(logger_, stream_switch::LOG_LEVEL_INFO,
+                               "Session %s is removed from thread %d\n",
+                               it->stream_name.c_str(), thread_index_);
+                }else{
+                    STDERR_LOG(logger_, stream_switch::LOG_LEVEL_WARNING,
+                               "Session %s to remove is not found in thread %d\n",
+                               it->stream_name.c_str(), thread_index_);
+                    pthread_mutex_lock(&lock_);
+                    session_num_++;
+                    pthread_mutex_unlock(&lock_);
+                }
+            }
+            break;
+        case COMMAND_STOP:
+            watch_variable_ = 1;
+            break;
+        default:
+            break;
+        }
+
+        pthread_mutex_lock(&lock_);
+        done_seq_ = it->seq;
+        pthread_cond_broadcast(&command_done_);
+        pthread_mutex_unlock(&lock_);
+    }
+}
+
+void RtspSchedulerThread::ThreadRoutine()
+{
+    env_->taskScheduler().doEventLoop(&watch_variable_);
+
+    //stop all the sessions attached
+    SessionMap::iterator it;
+    for(it = sessions_.begin(); it != sessions_.end(); it++){
+        it->second->Stop();
+        delete it->second;
+    }
+    sessions_.clear();
+}
+
+void * RtspSchedulerThread::StaticThreadRoutine(void *arg)
+{
+    RtspSchedulerThread * thread = (RtspSchedulerThread *)arg;
+    thread->ThreadRoutine();
+    return NULL;
+}
@@ -0,0 +1,254 @@
+/**
+ * This file is part of stsw_rtsp_source, which belongs to StreamSwitch
+ * project.
+ *
+ * Copyright (C) 2014  OpenSight (www.opensight.cn)
+ *
+ * StreamSwitch is an extensible and scalable media stream server for
+ * multi-protocol environment.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+/**
+ * stsw_rtsp_source_session.h
+ *      RtspSourceSession and RtspSchedulerThread class header file, used by
+ *  the multi-session mode of stsw_rtsp_source
+ *
+ * author: OpenSight Team
+ * date: 2016-3-10
+**/
+
+
+#ifndef STSW_RTSP_SOURCE_SESSION_H
+#define STSW_RTSP_SOURCE_SESSION_H
+
+#include <pthread.h>
+
+#include <string>
+#include <list>
+#include <map>
+
+#include "stream_switch.h"
+#include "stsw_rtsp_client.h"
+
+
+#define MAX_SUBSTREAM_NUMBER 64
+
+#define RTSP_SESSION_RECONNECT_MIN_INTERVAL 1   // 1 sec
+#define RTSP_SESSION_RECONNECT_MAX_INTERVAL 30  // 30 sec
+
+
+// the parameters of one RTSP session, which are the same as the
+// command line options of the single-session mode
+struct RtspSessionParam{
+    std::string stream_name;
+    int port;
+    std::string url;
+    std::string user;
+    std::string passwd;
+    std::string single_medium;
+    bool stream_using_tcp;
+    bool enable_keep_alive;
+    bool using_local_ts;
+    bool ignore_sdp_sps;
+    int queue_size;
+    int debug_flags;
+    int verbosity_level;
+    unsigned reorder_min_time;   // in us
+    unsigned reorder_max_time;   // in us
+    unsigned reconnect_max_interval;   // in sec, 0 means no in-process reconnect
+    bool drop_damaged_frames;
+    bool lite_engine;
+
+    RtspSessionParam()
+    : port(0), stream_using_tcp(true), enable_keep_alive(true),
+      using_local_ts(false), ignore_sdp_sps(false),
+      queue_size(STSW_PUBLISH_SOCKET_HWM), debug_flags(0),
+      verbosity_level(0), reorder_min_time(RTSP_CLIENT_REORDER_MIN_TIME),
+      reorder_max_time(RTSP_CLIENT_REORDER_MAX_TIME),
+      reconnect_max_interval(0), drop_damaged_frames(false),
+      lite_engine(false)
+    {
+    }
+};
+
+
+// CreateTaskScheduler()
+// Create an EpollTaskScheduler if use_epoll is true and it's available, 
+// otherwise a BasicTaskScheduler
+TaskScheduler * CreateTaskScheduler(bool use_epoll);
+
+
+// One RTSP session of the multi-session mode
+//    This class is composed of a RTSP client and a stream switch source
+// object, just like RtspSourceApp in single-session mode. But it never
+// exits the process on error, instead, it reconnects the RTSP server
+// after a backoff interval, which is independent of other sessions.
+//    The source is initialized in the caller's thread by Init(), so that
+// the error can be reported to the caller at once, while the RTSP client
+// lives in the scheduler thread which Start() is invoked in.
+class RtspSourceSession: public LiveRtspClientListener,  public stream_switch::SourceListener
+{
+public:
+    RtspSourceSession(const RtspSessionParam &param,
+                      stream_switch::RotateLogger * logger);
+    virtual ~RtspSourceSession();
+
+    virtual int Init(std::string *err_info);
+    virtual void Uninit();
+
+    // Start()
+    // Start the RTSP client on the given environment, must be invoked in
+    // the thread running the event loop of env
+    virtual void Start(UsageEnvironment* env);
+
+    // Stop()
+    // Stop the RTSP client and the source, must be invoked in the same
+    // thread as Start()
+    virtual void Stop();
+
+    const RtspSessionParam & param()
+    {
+        return param_;
+    }
+
+    ///////////////////////////////////////////////////////////
+    // LiveRtspClientListener implementation
+
+    virtual void OnError(RtspClientErrCode err_code, const char * err_info);
+    virtual void OnMetaReady(const stream_switch::StreamMetadata &metadata);
+    virtual void OnRtspOK();
+    virtual void OnMediaFrame(
+        const stream_switch::MediaFrameInfo &frame_info,
+        const stream_switch::MediaFrameSegment * segments,
+        int segment_num
+    );
+
+    virtual void OnLostFrameUpdate(int32_t sub_stream_index,
+                                   uint64_t lost_frame );
+    virtual void OnRtpStatisticUpdate(const RtpRecvStatistic &statistic);
+    virtual void OnReconnecting(RtspClientErrCode err_code, const char * err_info,
+                                unsigned retry_interval);
+
+    ///////////////////////////////////////////////////////////
+    // SourceListener implementation
+    virtual void OnKeyFrame(void);
+    virtual void OnMediaStatistic(stream_switch::MediaStatisticInfo *statistic);
+
+    //////////////////////////////////////////////////////////
+    //Timer task handler
+    static void ReconnectHandler(void* clientData);
+
+protected:
+    virtual int CreateClient();
+    virtual void CloseClient();
+    virtual void ScheduleReconnect();
+
+    RtspSessionParam param_;
+    stream_switch::RotateLogger * logger_;
+    stream_switch::StreamSource * source_;
+    RtspClientEngine * rtsp_client_;
+    UsageEnvironment* env_;
+
+    TaskToken reconnect_task_;
+    int reconnect_interval_;     // in sec
+
+    // updated in the scheduler thread, read in the API thread of source_
+    pthread_mutex_t statistic_lock_;
+    uint64_t lost_frames_[MAX_SUBSTREAM_NUMBER];
+    RtpRecvStatistic rtp_statistics_[MAX_SUBSTREAM_NUMBER];
+};
+
+
+// One scheduler thread of the multi-session mode
+//    Each thread owns a live555 TaskScheduler / UsageEnvironment pair and
+// runs its event loop, all the sessions attached to it are driven by this
+// loop.
+//    Sessions are added / removed from other threads through a command
+// queue, which is signaled by a live555 event trigger, the only way to
+// wake up an event loop from another thread
+class RtspSchedulerThread
+{
+public:
+    RtspSchedulerThread(int thread_index, stream_switch::RotateLogger * logger, 
+                        bool use_epoll);
+    virtual ~RtspSchedulerThread();
+
+    virtual int Start(std::string *err_info);
+
+    // Stop()
+    // Stop the event loop and wait for the thread exit, all the sessions
+    // still attached are stopped and deleted
+    virtual void Stop();
+
+    // AddSession()
+    // Attach a session to this thread, whose source should be initialized.
+    // The thread takes the ownership of the session
+    virtual void AddSession(RtspSourceSession * session);
+
+    // RemoveSession()
+    // Stop and delete the session with the given stream name, and wait
+    // for that in the scheduler thread, so that the stream name can be
+    // used by a new session once it returns
+    virtual void RemoveSession(const std::string &stream_name);
+
+    // the number of the sessions attached (or being attached) to this thread
+    virtual int session_num();
+
+protected:
+    enum CommandType{
+        COMMAND_ADD = 0,
+        COMMAND_REMOVE = 1,
+        COMMAND_STOP = 2,
+    };
+    struct Command{
+        CommandType type;
+        RtspSourceSession * session;
+        std::string stream_name;
+        uint64_t seq;
+    };
+    typedef std::list<Command> CommandList;
+    typedef std::map<std::string, RtspSourceSession *> SessionMap;
+
+    // return the sequence number of the posted command
+    virtual uint64_t PostCommand(Command &cmd);
+    virtual void WaitCommand(uint64_t seq);
+    virtual void HandleCommands();
+    virtual void ThreadRoutine();
+
+    static void CommandHandler(void* clientData);
+    static void * StaticThreadRoutine(void *arg);
+
+    int thread_index_;
+    stream_switch::RotateLogger * logger_;
+    bool use_epoll_;
+    TaskScheduler * scheduler_;
+    UsageEnvironment* env_;
+    EventTriggerId command_trigger_;
+    char watch_variable_;
+    pthread_t thread_id_;
+    bool is_started_;
+
+    pthread_mutex_t lock_;
+    pthread_cond_t command_done_;
+    CommandList commands_;
+    int session_num_;
+    uint64_t post_seq_;     // the last command posted
+    uint64_t done_seq_;     // the last command handled
+
+    SessionMap sessions_;  // only accessed in the scheduler thread
+};
+
+
+#endif